@@ -9,6 +9,20 @@ OnFail() {
     echo "App Info Test Failed!"
 }
 
+function CheckUsageHistory
+{
+    appName=$1
+    expectedText=$2
+
+    numMatches=$(ssh root@$targetAddr "$BIN_PATH/app usage $appName | grep -c \"$expectedText\"")
+
+    if [ $numMatches -eq 0 ]
+    then
+        echo -e $COLOR_ERROR "Usage history of app $appName should show '$expectedText'." $COLOR_RESET
+        exit 1
+    fi
+}
+
 function CheckAppIsRunning
 {
     appName=$1
@@ -58,6 +72,16 @@ sleep 1
 
 CheckAppIsRunning testAppInfo
 
+echo "Check the usage history of testAppInfo (sampled every 10 s)."
+CheckUsageHistory testAppInfo "no usage samples"
+sleep 11
+CheckUsageHistory testAppInfo "over the last"
+
+ssh root@$targetAddr  "$BIN_PATH/app stop testAppInfo"
+CheckRet
+
+CheckUsageHistory testAppInfo "no usage samples"
+
 ssh root@$targetAddr  "$BIN_PATH/app remove testAppInfo"
 CheckRet
 
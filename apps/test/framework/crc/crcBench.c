@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * CRC32 throughput benchmark.
+ *
+ * Computes the CRC32 of buffers of increasing size (doubling from minMBytes to maxMBytes) with
+ * le_crc_Crc32() and with a byte-at-a-time reference implementation, and reports the throughput
+ * of both.
+ *
+ * Usage: crcBench [minMBytes [maxMBytes]]
+ *
+ *      minMBytes       Size of the smallest buffer, in MiB (default 1).
+ *      maxMBytes       Size of the largest buffer, in MiB (default 64).
+ *
+ * The test passes if, for every buffer, le_crc_Crc32() gives the same CRC as the reference, both
+ * for the whole buffer at once and when it is computed incrementally over blocks of odd sizes at
+ * odd offsets.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Minimum amount of data to compute the CRC of for each measurement (bytes).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN_MEASURED_BYTES  (64 * 1024 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Byte-at-a-time lookup table of the reference implementation.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t RefTable[256];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the reference lookup table (bit-reflected polynomial 0x04C11DB7).
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitRefTable
+(
+    void
+)
+{
+    uint32_t i;
+    int bit;
+
+    for (i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320U) : (crc >> 1);
+        }
+        RefTable[i] = crc;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference implementation: compute a CRC32 one byte at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t RefCrc32
+(
+    const uint8_t* bufPtr,
+    size_t size,
+    uint32_t crc
+)
+{
+    for (; size > 0; size--)
+    {
+        crc = (crc >> 8) ^ RefTable[(crc ^ *bufPtr++) & 0xFF];
+    }
+
+    return crc;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute a CRC32 with le_crc_Crc32(), over blocks of varying odd sizes.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t IncrementalCrc32
+(
+    uint8_t* bufPtr,
+    size_t size
+)
+{
+    uint32_t crc = LE_CRC_START_CRC32;
+    size_t blockSize = 1;
+
+    while (size > 0)
+    {
+        if (blockSize > size)
+        {
+            blockSize = size;
+        }
+
+        crc = le_crc_Crc32(bufPtr, blockSize, crc);
+        bufPtr += blockSize;
+        size -= blockSize;
+        blockSize = (blockSize * 3) + 2;
+    }
+
+    return crc;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNow
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return now.sec + (now.usec / 1000000.0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetArg
+(
+    size_t index,
+    size_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoul(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure the throughput of le_crc_Crc32() and of the reference on a buffer, and check results.
+ *
+ * @return true if le_crc_Crc32() gave the right CRC.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RunSize
+(
+    uint8_t* bufPtr,
+    size_t size
+)
+{
+    size_t repeat = (MIN_MEASURED_BYTES + size - 1) / size;
+    uint32_t refCrc = 0;
+    uint32_t crc = 0;
+    double start;
+    size_t i;
+
+    start = GetNow();
+    for (i = 0; i < repeat; i++)
+    {
+        refCrc = RefCrc32(bufPtr, size, LE_CRC_START_CRC32);
+    }
+    double refSec = GetNow() - start;
+
+    start = GetNow();
+    for (i = 0; i < repeat; i++)
+    {
+        crc = le_crc_Crc32(bufPtr, size, LE_CRC_START_CRC32);
+    }
+    double sec = GetNow() - start;
+
+    double mBytes = ((double)size * repeat) / (1024 * 1024);
+
+    LE_INFO("%4zu MiB: le_crc_Crc32 %8.1f MiB/s, reference %8.1f MiB/s (x%.1f)",
+            size / (1024 * 1024), mBytes / sec, mBytes / refSec, refSec / sec);
+
+    if (crc != refCrc)
+    {
+        LE_ERROR("CRC of %zu bytes is %08x, expected %08x.", size, crc, refCrc);
+        return false;
+    }
+
+    // Check unaligned and incremental computation too.
+    refCrc = RefCrc32(bufPtr + 3, size - 3, LE_CRC_START_CRC32);
+    crc = IncrementalCrc32(bufPtr + 3, size - 3);
+    if (crc != refCrc)
+    {
+        LE_ERROR("Incremental CRC of %zu bytes is %08x, expected %08x.", size - 3, crc, refCrc);
+        return false;
+    }
+
+    return true;
+}
+
+
+COMPONENT_INIT
+{
+    size_t minMBytes = GetArg(0, 1);
+    size_t maxMBytes = GetArg(1, 64);
+    size_t mBytes;
+    size_t i;
+    int failures = 0;
+
+    LE_ASSERT((minMBytes > 0) && (maxMBytes >= minMBytes));
+
+    InitRefTable();
+
+    uint8_t* bufPtr = malloc(maxMBytes * 1024 * 1024);
+    LE_ASSERT(bufPtr != NULL);
+
+    // Standard check value: the CRC32 of "123456789", inverted, is 0xCBF43926.
+    LE_ASSERT(~le_crc_Crc32((uint8_t*)"123456789", 9, LE_CRC_START_CRC32) == 0xCBF43926U);
+
+    srand(1);
+    for (i = 0; i < maxMBytes * 1024 * 1024; i++)
+    {
+        bufPtr[i] = (uint8_t)rand();
+    }
+
+    for (mBytes = minMBytes; mBytes <= maxMBytes; mBytes *= 2)
+    {
+        if (!RunSize(bufPtr, mBytes * 1024 * 1024))
+        {
+            failures++;
+        }
+    }
+
+    free(bufPtr);
+
+    if (failures != 0)
+    {
+        LE_ERROR("FAIL: %d sizes gave a wrong CRC.", failures);
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
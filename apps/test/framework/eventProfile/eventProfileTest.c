@@ -0,0 +1,172 @@
+ /**
+  * This module is for unit testing the event handler profiler in the legato runtime library
+  * (liblegato.so).
+  *
+  * The profiler is turned on through the LE_LOG_KEYWORDS environment variable (see
+  * CMakeLists.txt).  The test calls one of each kind of handler (queued function, publish-subscribe
+  * event handler, FD Monitor handler and timer expiry handler) and then checks that each of them
+  * got its own execution time histogram in the process's metrics segment, and that the time spent
+  * waiting on the Event Queue was recorded too.
+  *
+  * Copyright (C) Sierra Wireless Inc.
+  */
+
+#include "legato.h"
+#include "metrics.h"
+
+
+static le_event_Id_t EventId;
+static int PipeFds[2];
+static le_fdMonitor_Ref_t FdMonitorRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a histogram in a mapped segment by the start of its name.
+ */
+//--------------------------------------------------------------------------------------------------
+static const metrics_Histogram_t* FindHistogram
+(
+    const metrics_Segment_t* segPtr,
+    const char* prefixPtr
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < segPtr->numHistograms; i++)
+    {
+        if (strncmp(segPtr->histograms[i].name, prefixPtr, strlen(prefixPtr)) == 0)
+        {
+            return &segPtr->histograms[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued function that checks the profiles once all the other handlers have run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckProfiles
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    const metrics_Segment_t* segPtr = metrics_MapProcessSegment(getpid());
+    const metrics_Histogram_t* histPtr;
+
+    LE_TEST(segPtr != NULL);
+    if (segPtr == NULL)
+    {
+        LE_TEST_EXIT;
+    }
+
+    histPtr = FindHistogram(segPtr, "handler.event.TestEventHandler");
+    LE_TEST((histPtr != NULL) && (histPtr->count == 1));
+
+    histPtr = FindHistogram(segPtr, "handler.fd.TestPipe");
+    LE_TEST((histPtr != NULL) && (histPtr->count == 1));
+
+    histPtr = FindHistogram(segPtr, "handler.timer.TestTimer");
+    LE_TEST((histPtr != NULL) && (histPtr->count == 1));
+
+    // Queued functions are named after their symbol or their address, depending on whether the
+    // symbol is exported.
+    histPtr = FindHistogram(segPtr, "handler.func.");
+    LE_TEST((histPtr != NULL) && (histPtr->count >= 1));
+
+    histPtr = FindHistogram(segPtr, "event.main.queueTime");
+    LE_TEST((histPtr != NULL) && (histPtr->count >= 4));
+
+    metrics_UnmapSegment(segPtr);
+
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer expiry handler.  Runs last, so it queues the checks.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    le_event_QueueFunction(CheckProfiles, NULL, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish-subscribe event handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EventHandler
+(
+    void* reportPtr
+)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * FD Monitor handler for the read end of the pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PipeHandler
+(
+    int fd,
+    short events
+)
+{
+    char c;
+
+    LE_ASSERT(read(fd, &c, 1) == 1);
+
+    // Don't get called again.
+    le_fdMonitor_Delete(FdMonitorRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueuedFunc
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+}
+
+
+COMPONENT_INIT
+{
+    LE_TEST_INIT;
+
+    LE_INFO("======== Event Profiler Test ========");
+
+    le_event_QueueFunction(QueuedFunc, NULL, NULL);
+
+    EventId = le_event_CreateId("TestEvent", 0);
+    le_event_AddHandler("TestEventHandler", EventId, EventHandler);
+    le_event_Report(EventId, NULL, 0);
+
+    LE_ASSERT(pipe(PipeFds) == 0);
+    FdMonitorRef = le_fdMonitor_Create("TestPipe", PipeFds[0], PipeHandler, POLLIN);
+    LE_ASSERT(write(PipeFds[1], "x", 1) == 1);
+
+    le_timer_Ref_t timerRef = le_timer_Create("TestTimer");
+    LE_ASSERT(le_timer_SetMsInterval(timerRef, 100) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(timerRef, TimerHandler) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+}
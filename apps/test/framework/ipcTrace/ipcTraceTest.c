@@ -0,0 +1,95 @@
+ /**
+  * This module is for unit testing the IPC message trace ring in the legato runtime library
+  * (liblegato.so).
+  *
+  * The following is a list of the test cases:
+  *
+  *  - Records written for a traced message show up, with all their fields, in the process's own
+  *    ring when it is mapped the way the ipcTrace tool maps it.
+  *  - Messages are no longer traced once their record has been written.
+  *  - When the ring wraps around, the oldest records are overwritten and each slot holds the
+  *    record with the expected sequence number.
+  *
+  * Copyright (C) Sierra Wireless Inc.
+  */
+
+#include "legato.h"
+#include "ipcTrace.h"
+
+
+COMPONENT_INIT
+{
+    ipcTrace_MsgState_t state;
+    ipcTrace_Record_t record;
+    int i;
+
+    LE_TEST_INIT;
+
+    LE_INFO("====  Unit test for the IPC message trace ring. ====");
+
+    // Nothing has been traced yet, so the ring doesn't exist.
+    LE_TEST(ipcTrace_MapProcessRing(getpid()) == NULL);
+
+    // Client side of a request-response transaction.
+    memset(&state, 0, sizeof(state));
+    ipcTrace_Stamp(&state, IPCTRACE_SEND);
+    LE_TEST(state.stamps[IPCTRACE_SEND] == 0);
+
+    ipcTrace_Begin(&state, IPCTRACE_ENQUEUE, 7, (void*)0x1234);
+    ipcTrace_Stamp(&state, IPCTRACE_SEND);
+    ipcTrace_Stamp(&state, IPCTRACE_RECEIVE);
+    ipcTrace_Stamp(&state, IPCTRACE_HANDLER_START);
+    ipcTrace_Stamp(&state, IPCTRACE_HANDLER_END);
+    LE_TEST(state.isActive);
+    LE_TEST(state.stamps[IPCTRACE_ENQUEUE] <= state.stamps[IPCTRACE_SEND]);
+    LE_TEST(state.stamps[IPCTRACE_SEND] <= state.stamps[IPCTRACE_RECEIVE]);
+
+    ipcTrace_Write(&state, IPCTRACE_ROLE_CLIENT, "testInterface", 100, 0);
+    LE_TEST(!state.isActive);
+
+    // Server side of the same transaction.
+    ipcTrace_Begin(&state, IPCTRACE_RECEIVE, 7, (void*)0x1234);
+    ipcTrace_Stamp(&state, IPCTRACE_HANDLER_START);
+    ipcTrace_Stamp(&state, IPCTRACE_ENQUEUE);
+    ipcTrace_Write(&state, IPCTRACE_ROLE_SERVER, "testInterface", 100, getpid());
+
+    // The ring, as seen by the tool.
+    const ipcTrace_Ring_t* ringPtr = ipcTrace_MapProcessRing(getpid());
+    LE_TEST(ringPtr != NULL);
+
+    if (ringPtr != NULL)
+    {
+        LE_TEST(ringPtr->head == 2);
+
+        LE_TEST(ipcTrace_ReadRecord(ringPtr, 0, &record));
+        LE_TEST(record.seq == 1);
+        LE_TEST(record.role == IPCTRACE_ROLE_CLIENT);
+        LE_TEST((record.msgId == 7) && (record.txnId == 0x1234) && (record.size == 100));
+        LE_TEST(strcmp(record.interfaceName, "testInterface") == 0);
+        LE_TEST(record.stamps[IPCTRACE_HANDLER_END] >= record.stamps[IPCTRACE_ENQUEUE]);
+
+        LE_TEST(ipcTrace_ReadRecord(ringPtr, 1, &record));
+        LE_TEST((record.role == IPCTRACE_ROLE_SERVER) && (record.peerPid == getpid()));
+        LE_TEST((record.stamps[IPCTRACE_RECEIVE] != 0) && (record.stamps[IPCTRACE_SEND] == 0));
+
+        LE_TEST(!ipcTrace_ReadRecord(ringPtr, 2, &record));
+
+        // Wrap around.
+        for (i = 0; i < IPCTRACE_NUM_RECORDS; i++)
+        {
+            ipcTrace_Begin(&state, IPCTRACE_ENQUEUE, i, NULL);
+            ipcTrace_Write(&state, IPCTRACE_ROLE_CLIENT, "testInterface", 100, 0);
+        }
+
+        LE_TEST(ringPtr->head == IPCTRACE_NUM_RECORDS + 2);
+        LE_TEST(ipcTrace_ReadRecord(ringPtr, 0, &record));
+        LE_TEST((record.seq == IPCTRACE_NUM_RECORDS + 1) &&
+                (record.msgId == IPCTRACE_NUM_RECORDS - 2));
+        LE_TEST(ipcTrace_ReadRecord(ringPtr, 2, &record));
+        LE_TEST((record.seq == 3) && (record.msgId == 0));
+
+        ipcTrace_UnmapRing(ringPtr);
+    }
+
+    LE_TEST_EXIT;
+}
@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * JSON writer benchmark.
+ *
+ * Writes a listing like the Service Directory's "sdir list --json" output (bindings, services and
+ * waiting clients of made-up apps) to a file descriptor, first with a dprintf() call per entry
+ * (as the Service Directory used to), then with an fd writer (see le_json_InitFdWriter()), and
+ * reports the time and the number of write calls each one took.
+ *
+ * Usage: jsonWriterBench [entries [rounds [output]]]
+ *
+ *      entries     Number of bindings, of services and of waiting clients (default 1000).
+ *      rounds      Number of times the listing is written, for each method (default 100).
+ *      output      File to write to (default /dev/null).
+ *
+ * The test passes if both methods produce the same listing.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+#include <sys/resource.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the fd writer's buffer (bytes), the same as the Service Directory's.
+ */
+//--------------------------------------------------------------------------------------------------
+#define WRITER_BUFFER_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of write calls made by the current method.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t WriteCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of the made-up app of an entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* AppName
+(
+    size_t index
+)
+{
+    static char name[32];
+
+    snprintf(name, sizeof(name), "sampleApp%zu", index);
+
+    return name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the listing with a dprintf() call per entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListWithDprintf
+(
+    int fd,
+    size_t entries
+)
+{
+    size_t i;
+
+    dprintf(fd, "{\"bindings\":[");
+    WriteCount++;
+    for (i = 0; i < entries; i++)
+    {
+        dprintf(fd, "%s{\"client\":{\"app\":\"%s\",\"interface\":\"le_data\"},"
+                    "\"service\":{\"app\":\"dataConnectionService\",\"interface\":\"le_data\"}}",
+                (i == 0) ? "" : ",", AppName(i));
+        WriteCount++;
+    }
+    dprintf(fd, "],\"services\":[");
+    WriteCount++;
+    for (i = 0; i < entries; i++)
+    {
+        dprintf(fd, "%s{\"service\":{\"app\":\"%s\",\"interface\":\"le_sampleService\"},"
+                    "\"pid\":%zu,\"maxMessageSize\":%d,"
+                    "\"protocolId\":\"0123456789abcdef0123456789abcdef\"}",
+                (i == 0) ? "" : ",", AppName(i), 1000 + i, 1100);
+        WriteCount++;
+    }
+    dprintf(fd, "],\"waiting\":[");
+    WriteCount++;
+    for (i = 0; i < entries; i++)
+    {
+        dprintf(fd, "%s{\"client\":{\"user\":\"%s\",\"interface\":\"le_sampleService\"},"
+                    "\"pid\":%zu,\"protocolId\":\"0123456789abcdef0123456789abcdef\"}",
+                (i == 0) ? "" : ",", AppName(i), 2000 + i);
+        WriteCount++;
+    }
+    dprintf(fd, "]}\n");
+    WriteCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write an interface member of an entry with the JSON writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteInterface
+(
+    le_json_Writer_t* writerPtr,
+    const char* memberPtr,
+    const char* typePtr,
+    const char* namePtr,
+    const char* interfacePtr
+)
+{
+    le_json_WriteMember(writerPtr, memberPtr);
+    le_json_StartObject(writerPtr);
+    le_json_WriteMember(writerPtr, typePtr);
+    le_json_WriteString(writerPtr, namePtr);
+    le_json_WriteMember(writerPtr, "interface");
+    le_json_WriteString(writerPtr, interfacePtr);
+    le_json_EndObject(writerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the listing with the JSON writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListWithWriter
+(
+    int fd,
+    size_t entries
+)
+{
+    char buffer[WRITER_BUFFER_BYTES];
+    le_json_Writer_t writer;
+    size_t i;
+
+    le_json_InitFdWriter(&writer, fd, buffer, sizeof(buffer));
+
+    le_json_StartObject(&writer);
+    le_json_WriteMember(&writer, "bindings");
+    le_json_StartArray(&writer);
+    for (i = 0; i < entries; i++)
+    {
+        le_json_StartObject(&writer);
+        WriteInterface(&writer, "client", "app", AppName(i), "le_data");
+        WriteInterface(&writer, "service", "app", "dataConnectionService", "le_data");
+        le_json_EndObject(&writer);
+    }
+    le_json_EndArray(&writer);
+    le_json_WriteMember(&writer, "services");
+    le_json_StartArray(&writer);
+    for (i = 0; i < entries; i++)
+    {
+        le_json_StartObject(&writer);
+        WriteInterface(&writer, "service", "app", AppName(i), "le_sampleService");
+        le_json_WriteMember(&writer, "pid");
+        le_json_WriteInt(&writer, 1000 + i);
+        le_json_WriteMember(&writer, "maxMessageSize");
+        le_json_WriteUint(&writer, 1100);
+        le_json_WriteMember(&writer, "protocolId");
+        le_json_WriteString(&writer, "0123456789abcdef0123456789abcdef");
+        le_json_EndObject(&writer);
+    }
+    le_json_EndArray(&writer);
+    le_json_WriteMember(&writer, "waiting");
+    le_json_StartArray(&writer);
+    for (i = 0; i < entries; i++)
+    {
+        le_json_StartObject(&writer);
+        WriteInterface(&writer, "client", "user", AppName(i), "le_sampleService");
+        le_json_WriteMember(&writer, "pid");
+        le_json_WriteInt(&writer, 2000 + i);
+        le_json_WriteMember(&writer, "protocolId");
+        le_json_WriteString(&writer, "0123456789abcdef0123456789abcdef");
+        le_json_EndObject(&writer);
+    }
+    le_json_EndArray(&writer);
+    le_json_EndObject(&writer);
+
+    // About one write call per buffer full (the file descriptor is blocking).
+    WriteCount += (le_json_GetBytesWritten(&writer) + sizeof(buffer) - 1) / sizeof(buffer);
+    LE_ASSERT(le_json_Flush(&writer) == LE_OK);
+    LE_ASSERT(write(fd, "\n", 1) == 1);
+    WriteCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time used by this process so far (user and system), in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetCpuUs
+(
+    uint64_t* userUsPtr,
+    uint64_t* systemUsPtr
+)
+{
+    struct rusage usage;
+
+    LE_ASSERT(getrusage(RUSAGE_SELF, &usage) == 0);
+
+    *userUsPtr = ((uint64_t)usage.ru_utime.tv_sec * 1000000) + usage.ru_utime.tv_usec;
+    *systemUsPtr = ((uint64_t)usage.ru_stime.tv_sec * 1000000) + usage.ru_stime.tv_usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the listing a number of times with one method, and report the time it took.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Measure
+(
+    const char* namePtr,
+    void (*listFunc)(int, size_t),
+    int fd,
+    size_t entries,
+    size_t rounds
+)
+{
+    uint64_t startUserUs, startSystemUs, endUserUs, endSystemUs;
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    size_t i;
+
+    WriteCount = 0;
+    GetCpuUs(&startUserUs, &startSystemUs);
+
+    for (i = 0; i < rounds; i++)
+    {
+        listFunc(fd, entries);
+    }
+
+    GetCpuUs(&endUserUs, &endSystemUs);
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_INFO("%-8s: %zu listings of %zu entries: %.1f us/listing (user %.1f, system %.1f),"
+            " %zu write calls/listing",
+            namePtr, rounds, entries * 3,
+            ((elapsed.sec * 1000000.0) + elapsed.usec) / rounds,
+            (double)(endUserUs - startUserUs) / rounds,
+            (double)(endSystemUs - startSystemUs) / rounds,
+            WriteCount / rounds);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the listing once with one method into a temporary file, and read it back.
+ *
+ * @return The listing (to be freed with free()).
+ */
+//--------------------------------------------------------------------------------------------------
+static char* GetListing
+(
+    void (*listFunc)(int, size_t),
+    size_t entries
+)
+{
+    FILE* filePtr = tmpfile();
+    LE_ASSERT(filePtr != NULL);
+
+    listFunc(fileno(filePtr), entries);
+
+    long size = ftell(filePtr);
+    LE_ASSERT(size > 0);
+    char* listingPtr = calloc(size + 1, 1);
+    LE_ASSERT(listingPtr != NULL);
+    rewind(filePtr);
+    LE_ASSERT(fread(listingPtr, 1, size, filePtr) == (size_t)size);
+    fclose(filePtr);
+
+    return listingPtr;
+}
+
+
+COMPONENT_INIT
+{
+    size_t entries = GetArg(0, 1000);
+    size_t rounds = GetArg(1, 100);
+    const char* outputPtr = (le_arg_NumArgs() > 2) ? le_arg_GetArg(2) : "/dev/null";
+
+    LE_ASSERT((entries > 0) && (rounds > 0));
+
+    char* dprintfListingPtr = GetListing(ListWithDprintf, entries);
+    char* writerListingPtr = GetListing(ListWithWriter, entries);
+    bool isSame = (strcmp(dprintfListingPtr, writerListingPtr) == 0);
+    free(dprintfListingPtr);
+    free(writerListingPtr);
+
+    int fd = open(outputPtr, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    LE_FATAL_IF(fd < 0, "Can't open '%s' (%m).", outputPtr);
+
+    Measure("dprintf", ListWithDprintf, fd, entries, rounds);
+    Measure("writer", ListWithWriter, fd, entries, rounds);
+
+    close(fd);
+
+    if (!isSame)
+    {
+        LE_ERROR("FAIL: the listings are different.");
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
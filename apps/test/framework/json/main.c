@@ -0,0 +1,300 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the JSON writer (le_json_InitBufferWriter(), le_json_InitFdWriter(), etc.).
+ *
+ * Checks:
+ *  - nesting of objects and arrays, and the commas and colons between their contents,
+ *  - every kind of value,
+ *  - escaping of strings,
+ *  - rejection of strings that are not valid UTF-8,
+ *  - running out of space in a buffer writer (and writing whole tokens or nothing),
+ *  - an fd writer's batching, and its backpressure on a full non-blocking pipe.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a buffer writer's buffer holds the expected document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckDocument
+(
+    le_json_Writer_t* writerPtr,
+    const char* bufferPtr,
+    const char* expectedPtr
+)
+{
+    LE_INFO("Got '%s'", bufferPtr);
+    LE_ASSERT(strcmp(bufferPtr, expectedPtr) == 0);
+    LE_ASSERT(le_json_GetBytesWritten(writerPtr) == strlen(expectedPtr));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test nesting and values.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStructure
+(
+    void
+)
+{
+    char buffer[256];
+    le_json_Writer_t writer;
+
+    LE_INFO("Testing structure and values.");
+
+    le_json_InitBufferWriter(&writer, buffer, sizeof(buffer));
+    CheckDocument(&writer, buffer, "");
+
+    LE_ASSERT(le_json_StartObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "empty") == LE_OK);
+    LE_ASSERT(le_json_StartObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_EndObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "list") == LE_OK);
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteInt(&writer, INT64_MIN) == LE_OK);
+    LE_ASSERT(le_json_WriteUint(&writer, UINT64_MAX) == LE_OK);
+    LE_ASSERT(le_json_WriteNumber(&writer, 0.5) == LE_OK);
+    LE_ASSERT(le_json_WriteNumber(&writer, NAN) == LE_OK);
+    LE_ASSERT(le_json_WriteBool(&writer, true) == LE_OK);
+    LE_ASSERT(le_json_WriteBool(&writer, false) == LE_OK);
+    LE_ASSERT(le_json_WriteNull(&writer) == LE_OK);
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_StartObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "a") == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "b") == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "c") == LE_OK);
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "") == LE_OK);
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_EndObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "last") == LE_OK);
+    LE_ASSERT(le_json_WriteInt(&writer, 0) == LE_OK);
+    LE_ASSERT(le_json_EndObject(&writer) == LE_OK);
+
+    CheckDocument(&writer, buffer,
+                  "{\"empty\":{},\"list\":[-9223372036854775808,18446744073709551615,0.5,null,"
+                  "true,false,null,[],{\"a\":\"b\",\"c\":[\"\"]}],\"last\":0}");
+
+    // Flushing a buffer writer does nothing.
+    LE_ASSERT(le_json_Flush(&writer) == LE_OK);
+    LE_ASSERT(le_json_GetBytesWritten(&writer) == strlen(buffer));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the escaping of strings, and the rejection of strings that are not valid UTF-8.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStrings
+(
+    void
+)
+{
+    char buffer[256];
+    le_json_Writer_t writer;
+
+    LE_INFO("Testing strings.");
+
+    le_json_InitBufferWriter(&writer, buffer, sizeof(buffer));
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "quote\" backslash\\ slash/") == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "\b\f\n\r\t\x01\x1f\x7f") == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80") == LE_OK);
+
+    // Invalid strings are not written, and don't get in the way of what follows.
+    LE_ASSERT(le_json_WriteString(&writer, "lead \x80 byte") == LE_FORMAT_ERROR);
+    LE_ASSERT(le_json_WriteString(&writer, "truncated \xe2\x82") == LE_FORMAT_ERROR);
+    LE_ASSERT(le_json_WriteString(&writer, "\xff") == LE_FORMAT_ERROR);
+    LE_ASSERT(le_json_WriteString(&writer, "end") == LE_OK);
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OK);
+
+    CheckDocument(&writer, buffer,
+                  "[\"quote\\\" backslash\\\\ slash/\","
+                  "\"\\b\\f\\n\\r\\t\\u0001\\u001f\x7f\","
+                  "\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\","
+                  "\"end\"]");
+
+    // Member names are escaped too.
+    le_json_InitBufferWriter(&writer, buffer, sizeof(buffer));
+    LE_ASSERT(le_json_StartObject(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteMember(&writer, "\xc0") == LE_FORMAT_ERROR);
+    LE_ASSERT(le_json_WriteMember(&writer, "a\"b") == LE_OK);
+    LE_ASSERT(le_json_WriteNull(&writer) == LE_OK);
+    LE_ASSERT(le_json_EndObject(&writer) == LE_OK);
+    CheckDocument(&writer, buffer, "{\"a\\\"b\":null}");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test running out of space in a buffer writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestBufferOverflow
+(
+    void
+)
+{
+    char buffer[20];
+    le_json_Writer_t writer;
+
+    LE_INFO("Testing buffer overflow.");
+
+    // The buffer can hold 19 characters and the null-terminator.
+    le_json_InitBufferWriter(&writer, buffer, sizeof(buffer));
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "abcdefghij") == LE_OK);
+    LE_ASSERT(le_json_WriteString(&writer, "abcd") == LE_OVERFLOW);
+    CheckDocument(&writer, buffer, "[\"abcdefghij\"");
+    LE_ASSERT(le_json_WriteString(&writer, "abc") == LE_OK);
+    CheckDocument(&writer, buffer, "[\"abcdefghij\",\"abc\"");
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OVERFLOW);
+    CheckDocument(&writer, buffer, "[\"abcdefghij\",\"abc\"");
+
+    // An escape sequence that doesn't fit.
+    le_json_InitBufferWriter(&writer, buffer, sizeof(buffer));
+    LE_ASSERT(le_json_WriteString(&writer, "\x01\x01\x01") == LE_OVERFLOW);
+    CheckDocument(&writer, buffer, "");
+    LE_ASSERT(le_json_WriteString(&writer, "\x01\x01") == LE_OK);
+    CheckDocument(&writer, buffer, "\"\\u0001\\u0001\"");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read everything from a non-blocking file descriptor, appending it to a buffer.
+ *
+ * @return The total number of bytes in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Drain
+(
+    int fd,
+    char* bufferPtr,
+    size_t usedBytes,
+    size_t bufferSize
+)
+{
+    ssize_t count;
+
+    while ((count = read(fd, bufferPtr + usedBytes, bufferSize - usedBytes)) > 0)
+    {
+        usedBytes += count;
+    }
+    LE_ASSERT((count < 0) && (errno == EAGAIN));
+
+    return usedBytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test an fd writer, including backpressure from a full non-blocking pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestFdWriter
+(
+    void
+)
+{
+    static char expected[256 * 1024];
+    static char received[sizeof(expected)];
+    char buffer[100];
+    char value[64];
+    le_json_Writer_t writer;
+    int fds[2];
+    size_t expectedBytes = 0;
+    size_t receivedBytes = 0;
+    int blockCount = 0;
+    int i;
+
+    LE_INFO("Testing fd writer.");
+
+    LE_ASSERT(pipe2(fds, O_NONBLOCK) == 0);
+
+    le_json_InitFdWriter(&writer, fds[1], buffer, sizeof(buffer));
+
+    // Nothing reaches the pipe until the buffer is full.
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_WriteInt(&writer, 1) == LE_OK);
+    LE_ASSERT(Drain(fds[0], received, 0, sizeof(received)) == 0);
+    LE_ASSERT(le_json_GetBytesWritten(&writer) == 2);
+    LE_ASSERT(le_json_Flush(&writer) == LE_OK);
+    LE_ASSERT(Drain(fds[0], received, 0, sizeof(received)) == 2);
+    LE_ASSERT(memcmp(received, "[1", 2) == 0);
+    expectedBytes = snprintf(expected, sizeof(expected), "[1");
+    receivedBytes = 2;
+
+    // A token larger than the buffer can't be written.
+    memset(value, 'x', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    LE_ASSERT(le_json_WriteString(&writer, "\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01"
+                                           "\x01\x01\x01\x01\x01") == LE_OVERFLOW);
+
+    // Fill the pipe, without reading it, until the writer pushes back; then read it and retry.
+    for (i = 0; expectedBytes < sizeof(expected) - 100; i++)
+    {
+        snprintf(value, sizeof(value), "value %d \"%c\"", i, 'a' + (i % 26));
+
+        le_result_t result;
+        while ((result = le_json_WriteString(&writer, value)) == LE_WOULD_BLOCK)
+        {
+            blockCount++;
+            receivedBytes = Drain(fds[0], received, receivedBytes, sizeof(received));
+        }
+        LE_ASSERT(result == LE_OK);
+
+        expectedBytes += snprintf(expected + expectedBytes, sizeof(expected) - expectedBytes,
+                                  ",\"value %d \\\"%c\\\"\"", i, 'a' + (i % 26));
+    }
+    LE_ASSERT(le_json_EndArray(&writer) == LE_OK);
+    expectedBytes += snprintf(expected + expectedBytes, sizeof(expected) - expectedBytes, "]");
+
+    le_result_t result;
+    while ((result = le_json_Flush(&writer)) == LE_WOULD_BLOCK)
+    {
+        receivedBytes = Drain(fds[0], received, receivedBytes, sizeof(received));
+    }
+    LE_ASSERT(result == LE_OK);
+    receivedBytes = Drain(fds[0], received, receivedBytes, sizeof(received));
+
+    LE_INFO("%d values written, %d pushbacks, %zu bytes", i, blockCount, receivedBytes);
+    LE_ASSERT(blockCount > 0);
+    LE_ASSERT(receivedBytes == expectedBytes);
+    LE_ASSERT(le_json_GetBytesWritten(&writer) == expectedBytes);
+    LE_ASSERT(memcmp(received, expected, expectedBytes) == 0);
+
+    // Once the file descriptor fails, everything fails.
+    LE_ASSERT(close(fds[0]) == 0);
+    signal(SIGPIPE, SIG_IGN);
+    LE_ASSERT(le_json_StartArray(&writer) == LE_OK);
+    LE_ASSERT(le_json_Flush(&writer) == LE_FAULT);
+    LE_ASSERT(le_json_WriteNull(&writer) == LE_FAULT);
+    LE_ASSERT(le_json_EndObject(&writer) == LE_FAULT);
+    LE_ASSERT(le_json_Flush(&writer) == LE_FAULT);
+
+    LE_ASSERT(close(fds[1]) == 0);
+}
+
+
+COMPONENT_INIT
+{
+    TestStructure();
+    TestStrings();
+    TestBufferOverflow();
+    TestFdWriter();
+
+    LE_INFO("======== JSON writer tests passed ========");
+    exit(EXIT_SUCCESS);
+}
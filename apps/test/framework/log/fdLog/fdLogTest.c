@@ -0,0 +1,525 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the Log Control Daemon's logging of the standard out and standard error of apps
+ * (fdLog.c).
+ *
+ * Writes to pipes handed to fdLog_Add(), runs the event loop, and checks the messages logged in
+ * the log store (built in a temporary directory with the app log files, see Component.cdef):
+ *  - that the data is split into lines, also across writes, and that the lines too long for one
+ *    message are split (without an empty message when the newline comes right after),
+ *  - that an incomplete line is logged when the pipe is closed,
+ *  - that an app's rate limit drops lines, and that the lines dropped are reported when lines are
+ *    logged again, or after a while if none are,
+ *  - that an app's output goes to its log file instead when it has one, which is rotated when
+ *    full, and goes back to the log when the app's log file is turned off.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fdLog.h"
+#include "logStore.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the log store (KiB).
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_KBYTES        64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest message logged (the rest of a longer line is logged as another message).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LINE_LEN        1023
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages read back from the store.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LINES           32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A message read back from the store.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char procName[LIMIT_MAX_PROCESS_NAME_BYTES];    ///< Process name.
+    int32_t pid;                                    ///< PID.
+    le_log_Level_t level;                           ///< Level.
+    char msg[MAX_LINE_LEN + 1];                     ///< Message.
+}
+Line_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages read back by the last call to ReadStore(), oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+static Line_t Lines[MAX_LINES];
+static size_t LineCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetTimeMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process the events of this thread (the fd monitors and timers) for a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessEvents
+(
+    uint32_t timeout        ///< [IN] Time to process the events, in milliseconds.
+)
+{
+    struct pollfd pollFd = { .fd = le_event_GetFd(), .events = POLLIN };
+    uint64_t endTime = GetTimeMs() + timeout;
+    uint64_t now;
+
+    while ((now = GetTimeMs()) < endTime)
+    {
+        if (poll(&pollFd, 1, endTime - now) > 0)
+        {
+            while (LE_OK == le_event_ServiceLoop())
+            {
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace the log store with an empty one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetStore
+(
+    void
+)
+{
+    LE_ASSERT(logStore_SetSize(0) == LE_OK);
+    LE_ASSERT(logStore_SetSize(STORE_KBYTES) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read all the messages of the log store into Lines.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadStore
+(
+    void
+)
+{
+    int fd = open(LOGSTORE_PATH, O_RDONLY);
+    LE_ASSERT(fd >= 0);
+
+    struct stat st;
+    LE_ASSERT(fstat(fd, &st) == 0);
+
+    const uint8_t* storePtr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    LE_ASSERT(storePtr != MAP_FAILED);
+    close(fd);
+
+    const logStore_Header_t* headerPtr = (const logStore_Header_t*)storePtr;
+    const logStore_IndexEntry_t* indexPtr =
+        (const logStore_IndexEntry_t*)(storePtr + LOGSTORE_INDEX_OFFSET);
+    uint32_t newestBlock = logStore_GetNewestBlock(indexPtr, headerPtr->blockCount);
+    uint32_t i;
+
+    LineCount = 0;
+
+    for (i = 1; i <= headerPtr->blockCount; i++)
+    {
+        uint32_t block = (newestBlock + i) % headerPtr->blockCount;
+        const uint8_t* blockPtr = storePtr + headerPtr->dataOffset +
+                                  ((size_t)block * LOGSTORE_BLOCK_BYTES);
+        logStore_RecordBuffer_t buf;
+        size_t offset = 0;
+        size_t length;
+
+        if (indexPtr[block].generation == 0)
+        {
+            continue;
+        }
+
+        while ((length = logStore_CopyRecord(blockPtr, offset, indexPtr[block].generation, &buf))
+               != 0)
+        {
+            const char* textPtr = (const char*)(&buf.record + 1);
+            Line_t* linePtr = &Lines[LineCount++];
+
+            LE_ASSERT(LineCount <= MAX_LINES);
+            LE_ASSERT(buf.record.nameLen < sizeof(linePtr->procName));
+            LE_ASSERT(buf.record.msgLen < sizeof(linePtr->msg));
+            LE_ASSERT(buf.record.compLen == 0);
+
+            memcpy(linePtr->procName, textPtr, buf.record.nameLen);
+            linePtr->procName[buf.record.nameLen] = '\0';
+            memcpy(linePtr->msg, textPtr + buf.record.nameLen, buf.record.msgLen);
+            linePtr->msg[buf.record.msgLen] = '\0';
+            linePtr->pid = buf.record.pid;
+            linePtr->level = buf.record.level;
+
+            offset += length;
+        }
+    }
+
+    LE_ASSERT(munmap((void*)storePtr, st.st_size) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a message read back from the store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckLine
+(
+    size_t index,               ///< [IN] Index of the message in Lines.
+    const char* procNamePtr,    ///< [IN] Expected process name.
+    le_log_Level_t level,       ///< [IN] Expected level.
+    const char* msgPtr          ///< [IN] Expected message.
+)
+{
+    LE_ASSERT(index < LineCount);
+
+    if (   (strcmp(Lines[index].procName, procNamePtr) != 0)
+        || (Lines[index].level != level)
+        || (strcmp(Lines[index].msg, msgPtr) != 0))
+    {
+        LE_FATAL("Line %zu is '%s' (%d) from %s, expected '%s' (%d) from %s.",
+                 index, Lines[index].msg, Lines[index].level, Lines[index].procName,
+                 msgPtr, level, procNamePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a pipe, and hand its read end to fdLog_Add().
+ *
+ * @return The write end of the pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static int AddPipe
+(
+    const char* appNamePtr,     ///< [IN] App name.
+    const char* procNamePtr,    ///< [IN] Process name.
+    pid_t pid,                  ///< [IN] PID.
+    le_log_Level_t level        ///< [IN] Level of the messages.
+)
+{
+    int fds[2];
+
+    LE_ASSERT(pipe(fds) == 0);
+    LE_ASSERT(fdLog_Add(fds[0], appNamePtr, procNamePtr, pid, level, "fdLogTest") == LE_OK);
+
+    return fds[1];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string to a pipe, and let the event loop read it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WritePipe
+(
+    int fd,                     ///< [IN] Write end of the pipe.
+    const char* dataPtr         ///< [IN] Data.
+)
+{
+    size_t len = strlen(dataPtr);
+
+    LE_ASSERT(write(fd, dataPtr, len) == (ssize_t)len);
+    ProcessEvents(50);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a buffer with a character, and terminate it.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* FillString
+(
+    char* bufferPtr,            ///< [OUT] Buffer.
+    char c,                     ///< [IN] Character.
+    size_t len                  ///< [IN] Length of the string.
+)
+{
+    memset(bufferPtr, c, len);
+    bufferPtr[len] = '\0';
+
+    return bufferPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the data written is logged line by line.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestLines
+(
+    void
+)
+{
+    static char data[3000];
+    static char line[MAX_LINE_LEN + 1];
+    size_t index = 0;
+
+    LE_INFO("======== Lines ========");
+
+    ResetStore();
+    int fd = AddPipe("lineApp", "lineProc", 100, LE_LOG_INFO);
+
+    // Lines written in several parts.
+    WritePipe(fd, "hel");
+    WritePipe(fd, "lo\nwor");
+    ReadStore();
+    LE_ASSERT(LineCount == 1);
+    WritePipe(fd, "ld\n");
+
+    // A line too long for one message.
+    FillString(data, 'a', 2500);
+    strcat(data, "\n");
+    WritePipe(fd, data);
+
+    // Lines as long as a message, with the newline in the same write, or in the next one.
+    FillString(data, 'b', MAX_LINE_LEN);
+    strcat(data, "\n");
+    WritePipe(fd, data);
+    WritePipe(fd, FillString(data, 'c', MAX_LINE_LEN));
+    WritePipe(fd, "\nnext\n");
+
+    // An incomplete line, logged when the pipe is closed.
+    WritePipe(fd, "tail");
+    ReadStore();
+    LE_ASSERT(LineCount == 8);
+    LE_ASSERT(close(fd) == 0);
+    ProcessEvents(50);
+
+    // Standard error.
+    fd = AddPipe("lineApp", "errProc", 101, LE_LOG_ERR);
+    WritePipe(fd, "oops\n");
+    LE_ASSERT(close(fd) == 0);
+    ProcessEvents(50);
+
+    ReadStore();
+    LE_ASSERT(LineCount == 10);
+    CheckLine(index++, "lineProc", LE_LOG_INFO, "hello");
+    CheckLine(index++, "lineProc", LE_LOG_INFO, "world");
+    CheckLine(index++, "lineProc", LE_LOG_INFO, FillString(line, 'a', MAX_LINE_LEN));
+    CheckLine(index++, "lineProc", LE_LOG_INFO, FillString(line, 'a', MAX_LINE_LEN));
+    CheckLine(index++, "lineProc", LE_LOG_INFO, FillString(line, 'a', 2500 - (2 * MAX_LINE_LEN)));
+    CheckLine(index++, "lineProc", LE_LOG_INFO, FillString(line, 'b', MAX_LINE_LEN));
+    CheckLine(index++, "lineProc", LE_LOG_INFO, FillString(line, 'c', MAX_LINE_LEN));
+    CheckLine(index++, "lineProc", LE_LOG_INFO, "next");
+    CheckLine(index++, "lineProc", LE_LOG_INFO, "tail");
+    CheckLine(index++, "errProc", LE_LOG_ERR, "oops");
+    LE_ASSERT((Lines[0].pid == 100) && (Lines[9].pid == 101));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that an app's rate limit drops lines, and that the lines dropped are reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRateLimit
+(
+    void
+)
+{
+    char data[1500] = "";
+    char line[32];
+    size_t index = 0;
+    int i;
+
+    LE_INFO("======== Rate limit ========");
+
+    ResetStore();
+    LE_ASSERT(fdLog_SetAppLimits("noisyApp", 5, 5, 0) == LE_OK);
+    int fd = AddPipe("noisyApp", "noisyProc", 200, LE_LOG_INFO);
+
+    // Only a burst of 5 lines is logged.  The others are reported after a while, as no other line
+    // is logged.
+    for (i = 0; i < 100; i++)
+    {
+        snprintf(line, sizeof(line), "line %d\n", i);
+        strcat(data, line);
+    }
+    WritePipe(fd, data);
+    ReadStore();
+    LE_ASSERT(LineCount == 5);
+    ProcessEvents(1100);
+    ReadStore();
+    LE_ASSERT(LineCount == 6);
+
+    // Another burst (the bucket is full again), whose lines dropped are reported when a line is
+    // logged again.
+    data[0] = '\0';
+    for (i = 0; i < 10; i++)
+    {
+        snprintf(line, sizeof(line), "more %d\n", i);
+        strcat(data, line);
+    }
+    WritePipe(fd, data);
+    ProcessEvents(450);
+    WritePipe(fd, "resumed\n");
+
+    // Nothing else to report.
+    ProcessEvents(1100);
+    LE_ASSERT(close(fd) == 0);
+    ProcessEvents(50);
+
+    ReadStore();
+    LE_ASSERT(LineCount == 13);
+    for (i = 0; i < 5; i++)
+    {
+        snprintf(line, sizeof(line), "line %d", i);
+        CheckLine(index++, "noisyProc", LE_LOG_INFO, line);
+    }
+    CheckLine(index++, "noisyProc", LE_LOG_WARN,
+              "95 lines from app 'noisyApp' dropped (over 5 lines/s).");
+    for (i = 0; i < 5; i++)
+    {
+        snprintf(line, sizeof(line), "more %d", i);
+        CheckLine(index++, "noisyProc", LE_LOG_INFO, line);
+    }
+    CheckLine(index++, "noisyProc", LE_LOG_WARN,
+              "5 lines from app 'noisyApp' dropped (over 5 lines/s).");
+    CheckLine(index++, "noisyProc", LE_LOG_INFO, "resumed");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the contents of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFile
+(
+    const char* pathPtr,        ///< [IN] Path of the file.
+    const char* dataPtr         ///< [IN] Expected contents.
+)
+{
+    static char buffer[2048];
+    size_t len = strlen(dataPtr);
+    int fd = open(pathPtr, O_RDONLY);
+
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(read(fd, buffer, sizeof(buffer)) == (ssize_t)len);
+    LE_ASSERT(memcmp(buffer, dataPtr, len) == 0);
+    close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that an app's output goes to its log file when it has one, and that the file is rotated.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestLogFile
+(
+    void
+)
+{
+    static char data[3][2048];
+    static char both[2048];
+    int i;
+
+    LE_INFO("======== Log file ========");
+
+    for (i = 0; i < 3; i++)
+    {
+        // Lines of 100 bytes: 6 of them, then 6 more, then 1.
+        size_t len = (i < 2) ? 600 : 100;
+        size_t j;
+
+        FillString(data[i], 'x' + i, len);
+        for (j = 99; j < len; j += 100)
+        {
+            data[i][j] = '\n';
+        }
+    }
+    strcpy(both, data[0]);
+    strcat(both, data[1]);
+
+    ResetStore();
+    LE_ASSERT(fdLog_SetAppLimits("fileApp", 0, 0, 1000) == LE_OK);
+    int fd = AddPipe("fileApp", "fileProc", 300, LE_LOG_INFO);
+
+    WritePipe(fd, data[0]);
+    CheckFile(APP_LOG_DIR "/fileApp.log", data[0]);
+
+    WritePipe(fd, data[1]);
+    CheckFile(APP_LOG_DIR "/fileApp.log", both);
+
+    // Full: the file is rotated before more is written.
+    WritePipe(fd, data[2]);
+    CheckFile(APP_LOG_DIR "/fileApp.log.1", both);
+    CheckFile(APP_LOG_DIR "/fileApp.log", data[2]);
+
+    ReadStore();
+    LE_ASSERT(LineCount == 0);
+
+    // Back to the log.
+    LE_ASSERT(fdLog_SetAppLimits("fileApp", 0, 0, 0) == LE_OK);
+    WritePipe(fd, "back to the log\n");
+    LE_ASSERT(close(fd) == 0);
+    ProcessEvents(50);
+
+    CheckFile(APP_LOG_DIR "/fileApp.log", data[2]);
+    ReadStore();
+    LE_ASSERT(LineCount == 1);
+    CheckLine(0, "fileProc", LE_LOG_INFO, "back to the log");
+}
+
+
+COMPONENT_INIT
+{
+    LE_ASSERT(le_dir_RemoveRecursive(APP_LOG_DIR) == LE_OK);
+    LE_ASSERT(le_dir_MakePath(APP_LOG_DIR, S_IRWXU) == LE_OK);
+
+    fdLog_Init();
+
+    TestLines();
+    TestRateLimit();
+    TestLogFile();
+
+    LE_ASSERT(logStore_SetSize(0) == LE_OK);
+    LE_ASSERT(le_dir_RemoveRecursive(APP_LOG_DIR) == LE_OK);
+
+    LE_INFO("======== App output logging tests passed ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,680 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the Log Control Daemon's log store (logStore.c), and of the queries of the log
+ * control tool's "show" command (logStore.h).
+ *
+ * Each writer runs in a child process that exits without closing the store, like a log daemon that
+ * was killed, and the store (built in LOGSTORE_PATH, see Component.cdef) is then read the way the
+ * log control tool reads it.  Checks:
+ *  - that a record that was only partly written (a torn write) is ignored, and that the messages
+ *    added after a restart are kept after the last valid record,
+ *  - that the blocks are shown and reused in the right order when the generations wrap around,
+ *    including after a restart,
+ *  - that the messages can be selected by time, level, PID, process name and component name.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "logStore.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the store (KiB): the smallest, which has 4 blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STORE_KBYTES        LOGSTORE_MIN_KBYTES
+#define BLOCK_COUNT         ((STORE_KBYTES * 1024) / LOGSTORE_BLOCK_BYTES)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Length of the messages added (an ID, padded).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_BYTES           100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages read back from the store.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_MSGS            (LOGSTORE_BLOCK_BYTES * BLOCK_COUNT / sizeof(logStore_Record_t))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process and component the messages are added for, when it doesn't matter.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PROC_NAME           "proc"
+#define PROC_PID            100
+#define COMP_NAME           "comp"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A message read back from the store.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t id;                ///< ID of the message.
+    uint32_t block;             ///< Block it was read from.
+    uint64_t timeUs;            ///< Time it was logged.
+}
+Msg_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages read back by the last call to ReadStore(), oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+static Msg_t Msgs[MAX_MSGS];
+static size_t MsgCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages added by AddMsgs(): ID of the first one, and number of messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FirstId;
+static uint32_t IdCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The store's memory mapping (see MapStore()), and its size.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* StorePtr;
+static size_t StoreBytes;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the length of the records of the messages added for PROC_NAME and COMP_NAME.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetRecordBytes
+(
+    void
+)
+{
+    return (sizeof(logStore_Record_t) + strlen(PROC_NAME) + strlen(COMP_NAME) + MSG_BYTES + 7) &
+           ~(size_t)7;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a message with a given ID to the store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddMsg
+(
+    uint32_t id,                ///< [IN] ID of the message.
+    le_log_Level_t level,       ///< [IN] Message level.
+    const char* procNamePtr,    ///< [IN] Process name.
+    pid_t pid,                  ///< [IN] PID.
+    const char* compNamePtr     ///< [IN] Component name.
+)
+{
+    char msg[MSG_BYTES + 1];
+
+    memset(msg, '.', MSG_BYTES);
+    msg[snprintf(msg, sizeof(msg), "%06" PRIu32, id)] = ' ';
+    msg[MSG_BYTES] = '\0';
+
+    logStore_Add(level, procNamePtr, pid, compNamePtr, msg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a function in a child process, which then exits without closing the store (as if the log
+ * daemon was killed), and wait for it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunInChild
+(
+    void (*funcPtr)(void)       ///< [IN] Function.
+)
+{
+    pid_t pid = fork();
+    LE_ASSERT(pid >= 0);
+
+    if (pid == 0)
+    {
+        funcPtr();
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    LE_ASSERT(waitpid(pid, &status, 0) == pid);
+    LE_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the store (in a child process).
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateStore
+(
+    void
+)
+{
+    LE_ASSERT(logStore_SetSize(STORE_KBYTES) == LE_OK);
+    LE_ASSERT(logStore_IsEnabled());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the store and add the messages FirstId to FirstId + IdCount - 1 to it (in a child process).
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddMsgs
+(
+    void
+)
+{
+    uint32_t id;
+
+    logStore_Init();
+    LE_ASSERT(logStore_IsEnabled());
+
+    for (id = FirstId; id < FirstId + IdCount; id++)
+    {
+        AddMsg(id, LE_LOG_INFO, PROC_NAME, PROC_PID, COMP_NAME);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the store, and create an empty one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetStore
+(
+    void
+)
+{
+    LE_ASSERT((unlink(LOGSTORE_PATH) == 0) || (errno == ENOENT));
+    RunInChild(CreateStore);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the store file in memory, like the log control tool does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MapStore
+(
+    void
+)
+{
+    int fd = open(LOGSTORE_PATH, O_RDWR);
+    LE_ASSERT(fd >= 0);
+
+    struct stat st;
+    LE_ASSERT(fstat(fd, &st) == 0);
+
+    StorePtr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    LE_ASSERT(StorePtr != MAP_FAILED);
+    StoreBytes = st.st_size;
+    close(fd);
+
+    const logStore_Header_t* headerPtr = (const logStore_Header_t*)StorePtr;
+
+    LE_ASSERT(headerPtr->magic == LOGSTORE_MAGIC);
+    LE_ASSERT(headerPtr->blockCount == BLOCK_COUNT);
+    LE_ASSERT(StoreBytes == headerPtr->dataOffset + (BLOCK_COUNT * LOGSTORE_BLOCK_BYTES));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap the store file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnmapStore
+(
+    void
+)
+{
+    LE_ASSERT(munmap(StorePtr, StoreBytes) == 0);
+    StorePtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index entry of a block of the mapped store.
+ */
+//--------------------------------------------------------------------------------------------------
+static logStore_IndexEntry_t* GetEntry
+(
+    uint32_t block              ///< [IN] Block index.
+)
+{
+    return (logStore_IndexEntry_t*)(StorePtr + LOGSTORE_INDEX_OFFSET) + block;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a block of the mapped store.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* GetBlock
+(
+    uint32_t block              ///< [IN] Block index.
+)
+{
+    const logStore_Header_t* headerPtr = (const logStore_Header_t*)StorePtr;
+
+    return StorePtr + headerPtr->dataOffset + ((size_t)block * LOGSTORE_BLOCK_BYTES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the messages of the store that match a filter into Msgs, oldest first, like the log
+ * control tool's "show" command does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadStore
+(
+    const logStore_Filter_t* filterPtr  ///< [IN] Filter.
+)
+{
+    MapStore();
+
+    uint32_t newestBlock = logStore_GetNewestBlock(GetEntry(0), BLOCK_COUNT);
+    uint32_t i;
+
+    MsgCount = 0;
+
+    for (i = 1; i <= BLOCK_COUNT; i++)
+    {
+        uint32_t block = (newestBlock + i) % BLOCK_COUNT;
+        logStore_IndexEntry_t entry = *GetEntry(block);
+        logStore_RecordBuffer_t buf;
+        size_t offset = 0;
+        size_t length;
+
+        if (!logStore_IsBlockMatching(&entry, filterPtr))
+        {
+            continue;
+        }
+
+        while ((length = logStore_CopyRecord(GetBlock(block), offset, entry.generation, &buf)) != 0)
+        {
+            if (logStore_IsRecordMatching(&buf.record, filterPtr))
+            {
+                const char* msgPtr = (const char*)(&buf.record + 1) + buf.record.nameLen +
+                                     buf.record.compLen;
+
+                LE_ASSERT(MsgCount < MAX_MSGS);
+                LE_ASSERT(buf.record.msgLen == MSG_BYTES);
+                Msgs[MsgCount].id = strtoul(msgPtr, NULL, 10);
+                Msgs[MsgCount].block = block;
+                Msgs[MsgCount].timeUs = buf.record.timeUs;
+                MsgCount++;
+            }
+
+            offset += length;
+        }
+    }
+
+    UnmapStore();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a filter that matches all messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitFilter
+(
+    logStore_Filter_t* filterPtr        ///< [OUT] Filter.
+)
+{
+    memset(filterPtr, 0, sizeof(*filterPtr));
+    filterPtr->maxTimeUs = UINT64_MAX;
+    filterPtr->levelMask = UINT32_MAX;
+    filterPtr->pid = -1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read all the messages of the store, and check that they are the messages with consecutive IDs.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMsgs
+(
+    uint32_t firstId,           ///< [IN] ID of the oldest message.
+    uint32_t count              ///< [IN] Number of messages.
+)
+{
+    logStore_Filter_t filter;
+    uint32_t i;
+
+    InitFilter(&filter);
+    ReadStore(&filter);
+
+    LE_INFO("Read %zu messages from %" PRIu32 ".", MsgCount, (MsgCount > 0) ? Msgs[0].id : 0);
+    LE_ASSERT(MsgCount == count);
+
+    for (i = 0; i < count; i++)
+    {
+        LE_ASSERT(Msgs[i].id == firstId + i);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add messages to the store after a restart of the log daemon.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RestartAndAdd
+(
+    uint32_t firstId,           ///< [IN] ID of the first message.
+    uint32_t count              ///< [IN] Number of messages.
+)
+{
+    FirstId = firstId;
+    IdCount = count;
+    RunInChild(AddMsgs);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the records that were not completely written are ignored, and that the messages
+ * added after a restart are kept after the valid ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestTornWrite
+(
+    void
+)
+{
+    size_t recordBytes = GetRecordBytes();
+
+    LE_INFO("======== Torn write ========");
+
+    ResetStore();
+    RestartAndAdd(0, 5);
+    CheckMsgs(0, 5);
+
+    // The last record never reached the disk: the next restart writes over it.
+    MapStore();
+    memset(GetBlock(0) + (4 * recordBytes), 0, recordBytes);
+    UnmapStore();
+    CheckMsgs(0, 4);
+
+    RestartAndAdd(4, 2);
+    CheckMsgs(0, 6);
+    LE_ASSERT(Msgs[5].block == 0);
+
+    // Only part of the last record reached the disk: it and the rest of its block are skipped.
+    MapStore();
+    GetBlock(0)[(5 * recordBytes) + sizeof(logStore_Record_t) + 20] ^= 0xff;
+    UnmapStore();
+    CheckMsgs(0, 5);
+
+    MapStore();
+    uint32_t generation = GetEntry(0)->generation;
+    UnmapStore();
+
+    RestartAndAdd(6, 2);
+
+    logStore_Filter_t filter;
+    InitFilter(&filter);
+    ReadStore(&filter);
+    LE_ASSERT(MsgCount == 7);
+    LE_ASSERT((Msgs[4].id == 4) && (Msgs[4].block == 0));
+    LE_ASSERT((Msgs[5].id == 6) && (Msgs[5].block == 1));
+    LE_ASSERT((Msgs[6].id == 7) && (Msgs[6].block == 1));
+
+    MapStore();
+    LE_ASSERT(GetEntry(0)->generation == generation);
+    LE_ASSERT(GetEntry(1)->generation == generation + 1);
+    UnmapStore();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the blocks are shown and reused oldest first when the generations wrap around.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestGenerationWrap
+(
+    void
+)
+{
+    uint32_t perBlock = LOGSTORE_BLOCK_BYTES / GetRecordBytes();
+    uint32_t i;
+
+    LE_INFO("======== Generation wrap ========");
+
+    // Make the last block look like the current one, two generations before the wrap.
+    ResetStore();
+    MapStore();
+    GetEntry(BLOCK_COUNT - 1)->generation = UINT32_MAX - 1;
+    UnmapStore();
+
+    // Fill the last block, then all the others (the generation wraps after block 0), and part of
+    // the last block again.
+    RestartAndAdd(0, (BLOCK_COUNT * perBlock) + 10);
+    CheckMsgs(perBlock, ((BLOCK_COUNT - 1) * perBlock) + 10);
+
+    MapStore();
+    LE_ASSERT(GetEntry(0)->generation == UINT32_MAX);
+    for (i = 1; i < BLOCK_COUNT; i++)
+    {
+        LE_ASSERT(GetEntry(i)->generation == i);
+    }
+    LE_ASSERT(logStore_GetNewestBlock(GetEntry(0), BLOCK_COUNT) == BLOCK_COUNT - 1);
+    UnmapStore();
+
+    // After a restart, the messages are added to the last block, then replace block 0.
+    RestartAndAdd((BLOCK_COUNT * perBlock) + 10, perBlock);
+    CheckMsgs(2 * perBlock, ((BLOCK_COUNT - 1) * perBlock) + 10);
+
+    MapStore();
+    LE_ASSERT(GetEntry(0)->generation == BLOCK_COUNT);
+    LE_ASSERT(logStore_GetNewestBlock(GetEntry(0), BLOCK_COUNT) == 0);
+    UnmapStore();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages added by the filter test: how their attributes depend on their IDs.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILTER_BATCH_MSGS   25
+#define FILTER_BATCHES      3
+
+static const le_log_Level_t Levels[] = { LE_LOG_DEBUG, LE_LOG_INFO, LE_LOG_WARN, LE_LOG_ERR };
+static const char* const ProcNames[] = { "proc", "process" };
+static const pid_t Pids[] = { 100, 101, 102 };
+static const char* const CompNames[] = { "", "compA", "compB", "compC", "compAB" };
+
+#define LEVEL_OF(id)        Levels[(id) % NUM_ARRAY_MEMBERS(Levels)]
+#define PROC_NAME_OF(id)    ProcNames[(id) % NUM_ARRAY_MEMBERS(ProcNames)]
+#define PID_OF(id)          Pids[(id) % NUM_ARRAY_MEMBERS(Pids)]
+#define COMP_NAME_OF(id)    CompNames[(id) % NUM_ARRAY_MEMBERS(CompNames)]
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Times the messages of the filter test were logged at.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t TimesUs[FILTER_BATCH_MSGS * FILTER_BATCHES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the store and add the messages of the filter test, in batches logged some time apart (in
+ * a child process).
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddFilterMsgs
+(
+    void
+)
+{
+    uint32_t id;
+
+    logStore_Init();
+    LE_ASSERT(logStore_IsEnabled());
+
+    for (id = 0; id < NUM_ARRAY_MEMBERS(TimesUs); id++)
+    {
+        if ((id > 0) && ((id % FILTER_BATCH_MSGS) == 0))
+        {
+            usleep(20000);
+        }
+
+        AddMsg(id, LEVEL_OF(id), PROC_NAME_OF(id), PID_OF(id), COMP_NAME_OF(id));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the messages read with a filter are those of the filter test that match it.
+ *
+ * @return The number of messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CheckFilter
+(
+    const logStore_Filter_t* filterPtr  ///< [IN] Filter.
+)
+{
+    size_t count = 0;
+    uint32_t id;
+
+    ReadStore(filterPtr);
+
+    for (id = 0; id < NUM_ARRAY_MEMBERS(TimesUs); id++)
+    {
+        if (   (TimesUs[id] >= filterPtr->minTimeUs)
+            && (TimesUs[id] <= filterPtr->maxTimeUs)
+            && ((filterPtr->levelMask & ((uint32_t)1 << LEVEL_OF(id))) != 0)
+            && ((filterPtr->pid < 0) || (filterPtr->pid == PID_OF(id)))
+            && (   (filterPtr->namePtr == NULL)
+                || (strcmp(filterPtr->namePtr, PROC_NAME_OF(id)) == 0))
+            && (   (filterPtr->compPtr == NULL)
+                || (strcmp(filterPtr->compPtr, COMP_NAME_OF(id)) == 0)))
+        {
+            LE_ASSERT(count < MsgCount);
+            LE_ASSERT(Msgs[count].id == id);
+            count++;
+        }
+    }
+
+    LE_ASSERT(count == MsgCount);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the messages can be selected by time, level, PID, process name and component name.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestFilters
+(
+    void
+)
+{
+    logStore_Filter_t filter;
+    uint32_t id;
+
+    LE_INFO("======== Filters ========");
+
+    ResetStore();
+    RunInChild(AddFilterMsgs);
+
+    InitFilter(&filter);
+    ReadStore(&filter);
+    LE_ASSERT(MsgCount == NUM_ARRAY_MEMBERS(TimesUs));
+    for (id = 0; id < MsgCount; id++)
+    {
+        LE_ASSERT(Msgs[id].id == id);
+        TimesUs[id] = Msgs[id].timeUs;
+    }
+
+    // The second batch.
+    filter.minTimeUs = TimesUs[FILTER_BATCH_MSGS];
+    filter.maxTimeUs = TimesUs[(2 * FILTER_BATCH_MSGS) - 1];
+    LE_ASSERT(CheckFilter(&filter) == FILTER_BATCH_MSGS);
+
+    // Warnings and above ("log show --level=WARN").
+    InitFilter(&filter);
+    filter.levelMask = ~(((uint32_t)1 << LE_LOG_WARN) - 1);
+    LE_ASSERT(CheckFilter(&filter) > 0);
+
+    InitFilter(&filter);
+    filter.pid = Pids[1];
+    LE_ASSERT(CheckFilter(&filter) > 0);
+
+    // Names are not matched by prefix.
+    InitFilter(&filter);
+    filter.namePtr = "proc";
+    filter.nameLen = strlen(filter.namePtr);
+    LE_ASSERT(CheckFilter(&filter) > 0);
+
+    InitFilter(&filter);
+    filter.compPtr = "compA";
+    filter.compLen = strlen(filter.compPtr);
+    LE_ASSERT(CheckFilter(&filter) > 0);
+
+    // All of them.
+    filter.minTimeUs = TimesUs[FILTER_BATCH_MSGS];
+    filter.levelMask = ~(((uint32_t)1 << LE_LOG_INFO) - 1);
+    filter.pid = Pids[2];
+    filter.namePtr = "process";
+    filter.nameLen = strlen(filter.namePtr);
+    LE_ASSERT(CheckFilter(&filter) > 0);
+
+    InitFilter(&filter);
+    filter.namePtr = "other";
+    filter.nameLen = strlen(filter.namePtr);
+    LE_ASSERT(CheckFilter(&filter) == 0);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("Log store: %s (%u blocks)", LOGSTORE_PATH, BLOCK_COUNT);
+
+    TestTornWrite();
+    TestGenerationWrap();
+    TestFilters();
+
+    LE_ASSERT(unlink(LOGSTORE_PATH) == 0);
+
+    LE_INFO("======== Log store tests passed ========");
+    exit(EXIT_SUCCESS);
+}
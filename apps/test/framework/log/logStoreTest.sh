@@ -0,0 +1,110 @@
+#!/bin/bash
+
+# On-target test of the log store's hand-off to running processes:
+#  - a process that was running before the store was enabled is handed a socket, and the messages
+#    its component logs are then kept in the store, with their level and component name,
+#  - after the store is disabled and enabled again, the same process is handed a new socket,
+#  - a process started while the store is enabled is handed a socket when it registers,
+#  - "log show" selects these messages by time, level, PID, process and component.
+
+LoadTestLib
+
+targetAddr=$1
+targetType=${2:-ar7}
+
+app=logStoreApp
+proc=ticker
+comp=logStoreTicker
+
+OnFail() {
+    echo "Log Store Test Failed!"
+}
+
+OnExit() {
+    ssh root@$targetAddr "$BIN_PATH/app remove $app; $BIN_PATH/log store 0" > /dev/null 2>&1
+}
+
+# Run a command on the target, and print its output.
+OnTarget() {
+    ssh root@$targetAddr "$1"
+}
+
+# Count the stored messages selected by "log show" options that contain a string.
+CountStored() {
+    OnTarget "$BIN_PATH/log show $1" | grep -c "$2"
+}
+
+# Check that a number of stored messages is as expected ("0" or "some").
+CheckStored() {
+    count=$(CountStored "$2" "$3")
+    if { [ "$1" == "0" ] && [ "$count" != "0" ]; } || { [ "$1" != "0" ] && [ "$count" == "0" ]; }
+    then
+        echo "log show $2: $count messages with '$3', expected $1"
+        exit 1
+    fi
+}
+
+# Get the PID of the app's process.
+GetPid() {
+    OnTarget "pidof $proc"
+}
+
+echo "******** Log Store Test Starting ***********"
+
+echo "Make sure Legato is running, without a log store."
+OnTarget "$BIN_PATH/legato start"
+CheckRet
+OnTarget "$BIN_PATH/log store 0"
+CheckRet
+
+echo "Install and start $app."
+appDir="$LEGATO_ROOT/build/$targetType/tests/apps"
+cat "$appDir/$app.$targetType.update" | OnTarget "$BIN_PATH/update"
+CheckRet
+OnTarget "$BIN_PATH/app start $app"
+CheckRet
+sleep 1
+pid=$(GetPid)
+if [ -z "$pid" ]
+then
+    echo "$proc is not running"
+    exit 1
+fi
+
+echo "Enable the store: the running process is handed a socket."
+OnTarget "$BIN_PATH/log store 64"
+CheckRet
+sleep 2
+CheckStored some "--proc=$proc" "$proc\[$pid\]/$comp | .* | tick "
+CheckStored some "--pid=$pid --comp=$comp" "tick "
+CheckStored some "--last=2 --proc=$proc" "tick "
+CheckStored 0 "--until=$(( $(OnTarget "date +%s") - 60 )) --proc=$proc" "tick "
+CheckStored some "--level=ERR --proc=$proc" "tock "
+CheckStored 0 "--level=ERR --proc=$proc" "tick "
+CheckStored 0 "--pid=1 --comp=$comp" "tick "
+CheckStored 0 "--proc=$proc --comp=other" "tick "
+
+echo "Disable the store, then enable it again: the process is handed a new socket."
+OnTarget "$BIN_PATH/log store 0"
+CheckRet
+OnTarget "test ! -e /legato/logStore"
+CheckRet
+OnTarget "$BIN_PATH/log store 64"
+CheckRet
+sleep 2
+CheckStored some "--pid=$pid --comp=$comp" "tick "
+
+echo "Restart the app: the new process is handed a socket when it registers."
+OnTarget "$BIN_PATH/app restart $app"
+CheckRet
+sleep 2
+newPid=$(GetPid)
+if [ -z "$newPid" ] || [ "$newPid" == "$pid" ]
+then
+    echo "$proc was not restarted"
+    exit 1
+fi
+CheckStored some "--pid=$newPid --comp=$comp" "tick "
+
+echo "Log Store Test Passed!"
+exit 0
@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process used by logStoreTest.sh: it logs an info message ("tick N") every 100 ms, and an error
+ * message ("tock N") every 10 ticks, so that the test can check which of them reach the log store.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs the next tick.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TickHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    static unsigned int tick = 0;
+
+    tick++;
+
+    LE_INFO("tick %u", tick);
+
+    if ((tick % 10) == 0)
+    {
+        LE_ERROR("tock %u", tick);
+    }
+}
+
+
+COMPONENT_INIT
+{
+    le_timer_Ref_t timerRef = le_timer_Create("Tick");
+
+    LE_ASSERT(le_timer_SetMsInterval(timerRef, 100) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(timerRef, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(timerRef, TickHandler) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+}
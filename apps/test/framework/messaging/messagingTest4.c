@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the Low-Level Messaging APIs.
+ *
+ * Test 4:
+ * - Create a server thread and a client thread in the same process.
+ * - Use a protocol with per-message sizes (le_msg_SetProtocolMsgSizes()), small messages
+ *   (le_msg_CreateSizedMsg()) and partial payloads (le_msg_SetPayloadSize()).
+ * - Check that the server gets a buffer big enough for its response, and that the parts of the
+ *   payload that were not sent are received as zeros.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+#define SERVICE_INSTANCE_NAME "messagingTest4"
+
+#define PROTOCOL_ID_STR "messagingTest4"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest payload of the protocol, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PAYLOAD_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message IDs (first word of the payload).
+ *
+ * - MSGID_SMALL: the server responds with one word.
+ * - MSGID_LARGE: the server responds with LARGE_RESPONSE_WORDS words.
+ * - MSGID_UNKNOWN: not in the size table, so the server responds with a full payload.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGID_SMALL     0
+#define MSGID_LARGE     1
+#define MSGID_UNKNOWN   2
+
+#define LARGE_RESPONSE_WORDS 750
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest payload size of each message ID (request or response).
+ */
+//--------------------------------------------------------------------------------------------------
+static const size_t MsgSizes[] =
+{
+    2 * sizeof(uint32_t),
+    (LARGE_RESPONSE_WORDS + 1) * sizeof(uint32_t),
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the protocol reference.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_msg_ProtocolRef_t GetProtocolRef
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, MAX_PAYLOAD_BYTES);
+
+    le_msg_SetProtocolMsgSizes(protocolRef, MsgSizes, NUM_ARRAY_MEMBERS(MsgSizes));
+
+    return protocolRef;
+}
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive handler for the server.  Responds in place, in the request message.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ServerRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+    size_t payloadSize = le_msg_GetMaxPayloadSize(msgRef);
+
+    LE_INFO("Request %u received in a %zu byte buffer.", payloadPtr[0], payloadSize);
+
+    // The client only sent the message ID and one word.
+    LE_TEST(payloadPtr[1] == 0xDEADBEEF);
+    LE_TEST(payloadPtr[2] == 0);
+
+    switch (payloadPtr[0])
+    {
+        case MSGID_SMALL:
+            LE_TEST((payloadSize >= MsgSizes[MSGID_SMALL]) && (payloadSize < MAX_PAYLOAD_BYTES));
+            payloadPtr[1] = 0xBEEFDEAD;
+            le_msg_SetPayloadSize(msgRef, 2 * sizeof(uint32_t));
+            break;
+
+        case MSGID_LARGE:
+            LE_TEST(payloadSize >= MsgSizes[MSGID_LARGE]);
+            memset(payloadPtr + 1, 0x5A, LARGE_RESPONSE_WORDS * sizeof(uint32_t));
+            le_msg_SetPayloadSize(msgRef, MsgSizes[MSGID_LARGE]);
+            break;
+
+        default:
+            // Whole payload is sent.
+            LE_TEST(payloadSize == MAX_PAYLOAD_BYTES);
+            memset(payloadPtr + 1, 0x33, MAX_PAYLOAD_BYTES - sizeof(uint32_t));
+            break;
+    }
+
+    le_msg_Respond(msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function for the server thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* opaqueContextPtr  ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(GetProtocolRef(), SERVICE_INSTANCE_NAME);
+
+    le_msg_SetServiceRecvHandler(serviceRef, ServerRecvHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+
+    le_event_RunLoop();
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send one request, using a small message with only two words in use, and get the response.
+ **/
+//--------------------------------------------------------------------------------------------------
+static uint32_t* SendRequest
+(
+    le_msg_SessionRef_t sessionRef,
+    uint32_t msgId,
+    le_msg_MessageRef_t* responseRefPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateSizedMsg(sessionRef, 3 * sizeof(uint32_t));
+
+    // The smallest size class is used, and the message is zeroed.
+    LE_TEST(le_msg_GetMaxPayloadSize(msgRef) < MAX_PAYLOAD_BYTES);
+
+    uint32_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+    LE_TEST(payloadPtr[2] == 0);
+    payloadPtr[0] = msgId;
+    payloadPtr[1] = 0xDEADBEEF;
+    payloadPtr[2] = 0xFFFFFFFF;     // Not sent.
+    le_msg_SetPayloadSize(msgRef, 2 * sizeof(uint32_t));
+
+    *responseRefPtr = le_msg_RequestSyncResponse(msgRef);
+    LE_FATAL_IF(*responseRefPtr == NULL, "Transaction failed!");
+
+    return le_msg_GetPayloadPtr(*responseRefPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function for the client thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* ClientThreadMain
+(
+    void* opaqueContextPtr  ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(GetProtocolRef(), SERVICE_INSTANCE_NAME);
+    le_msg_MessageRef_t responseRef;
+    uint32_t* payloadPtr;
+
+    le_msg_OpenSessionSync(sessionRef);
+
+    payloadPtr = SendRequest(sessionRef, MSGID_SMALL, &responseRef);
+    LE_TEST(payloadPtr[1] == 0xBEEFDEAD);
+    LE_TEST(payloadPtr[2] == 0);
+    le_msg_ReleaseMsg(responseRef);
+
+    payloadPtr = SendRequest(sessionRef, MSGID_LARGE, &responseRef);
+    LE_TEST(le_msg_GetMaxPayloadSize(responseRef) >= MsgSizes[MSGID_LARGE]);
+    LE_TEST(payloadPtr[LARGE_RESPONSE_WORDS] == 0x5A5A5A5A);
+    if (le_msg_GetMaxPayloadSize(responseRef) > MsgSizes[MSGID_LARGE])
+    {
+        LE_TEST(payloadPtr[LARGE_RESPONSE_WORDS + 1] == 0);
+    }
+    le_msg_ReleaseMsg(responseRef);
+
+    payloadPtr = SendRequest(sessionRef, MSGID_UNKNOWN, &responseRef);
+    LE_TEST(le_msg_GetMaxPayloadSize(responseRef) == MAX_PAYLOAD_BYTES);
+    LE_TEST(payloadPtr[(MAX_PAYLOAD_BYTES / sizeof(uint32_t)) - 1] == 0x33333333);
+    le_msg_ReleaseMsg(responseRef);
+
+    le_msg_CloseSession(sessionRef);
+
+    LE_TEST_SUMMARY
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Test 4: Message sizes ========");
+
+    system("testFwMessaging-Setup");
+
+    le_thread_Start(le_thread_Create("MsgTest4Server", ServerThreadMain, NULL));
+    le_thread_Start(le_thread_Create("MsgTest4Client", ClientThreadMain, NULL));
+}
@@ -0,0 +1,140 @@
+ /**
+  * This module is for unit testing the runtime metrics registry in the legato runtime library
+  * (liblegato.so).
+  *
+  * The following is a list of the test cases:
+  *
+  *  - Looking up a counter by name returns the same slot every time.
+  *  - Gauges keep their high-water mark.
+  *  - Histogram samples land in the right power-of-two bucket.
+  *  - The process's own segment can be mapped the way the metrics tool maps it, and shows the
+  *    values written through the registry, including the framework's own metrics (memory pool
+  *    high-water marks and event loop statistics).
+  *
+  * Copyright (C) Sierra Wireless Inc.
+  */
+
+#include "legato.h"
+#include "metrics.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a counter by name in a mapped segment.
+ */
+//--------------------------------------------------------------------------------------------------
+static const metrics_Counter_t* FindCounter
+(
+    const metrics_Segment_t* segPtr,
+    const char* namePtr
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < segPtr->numCounters; i++)
+    {
+        if (strcmp(segPtr->counters[i].name, namePtr) == 0)
+        {
+            return &segPtr->counters[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued function used to generate event loop statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueuedFunc
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+}
+
+
+COMPONENT_INIT
+{
+    int i;
+
+    LE_TEST_INIT;
+
+    LE_INFO("====  Unit test for the runtime metrics registry. ====");
+
+    // Counters.
+    metrics_CounterRef_t counterRef = metrics_GetCounter(METRICS_COUNTER, "test.%s", "counter");
+    LE_TEST(counterRef == metrics_GetCounter(METRICS_COUNTER, "test.counter"));
+    metrics_Inc(counterRef);
+    metrics_Add(counterRef, 41);
+    LE_TEST(counterRef->value == 42);
+
+    // Gauges.
+    metrics_CounterRef_t gaugeRef = metrics_GetCounter(METRICS_GAUGE, "test.gauge");
+    metrics_Inc(gaugeRef);
+    metrics_Inc(gaugeRef);
+    metrics_Dec(gaugeRef);
+    LE_TEST((gaugeRef->value == 1) && (gaugeRef->max == 2));
+    metrics_Set(gaugeRef, 10);
+    metrics_Set(gaugeRef, 3);
+    LE_TEST((gaugeRef->value == 3) && (gaugeRef->max == 10));
+
+    // Histograms.
+    metrics_HistogramRef_t histRef = metrics_GetHistogram("test.histogram");
+    LE_TEST(histRef == metrics_GetHistogram("test.histogram"));
+    metrics_Record(histRef, 0);
+    metrics_Record(histRef, 1);
+    metrics_Record(histRef, 1000);
+    metrics_Record(histRef, UINT64_MAX / 2);
+    LE_TEST(histRef->count == 4);
+    LE_TEST(histRef->buckets[0] == 1);
+    LE_TEST(histRef->buckets[1] == 1);
+    LE_TEST(histRef->buckets[10] == 1);
+    LE_TEST(histRef->buckets[METRICS_HISTOGRAM_BUCKETS - 1] == 1);
+    LE_TEST(histRef->max == UINT64_MAX / 2);
+
+    // Framework metrics.
+    le_mem_PoolRef_t poolRef = le_mem_CreatePool("MetricsTestPool", 16);
+    void* objPtrs[5];
+    for (i = 0; i < 5; i++)
+    {
+        objPtrs[i] = le_mem_ForceAlloc(poolRef);
+    }
+    for (i = 0; i < 5; i++)
+    {
+        le_mem_Release(objPtrs[i]);
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        le_event_QueueFunction(QueuedFunc, NULL, NULL);
+    }
+
+    // The shared segment, as seen by the tools.
+    const metrics_Segment_t* segPtr = metrics_MapProcessSegment(getpid());
+    LE_TEST(segPtr != NULL);
+
+    if (segPtr != NULL)
+    {
+        const metrics_Counter_t* sharedPtr = FindCounter(segPtr, "test.counter");
+        LE_TEST((sharedPtr != NULL) && (sharedPtr->value == 42));
+
+        char poolMetricName[LIMIT_MAX_METRIC_NAME_BYTES];
+        snprintf(poolMetricName, sizeof(poolMetricName), "pool.%s.MetricsTestPool",
+                 STRINGIZE(LE_COMPONENT_NAME));
+        sharedPtr = FindCounter(segPtr, poolMetricName);
+        LE_TEST((sharedPtr != NULL) && (sharedPtr->max == 5));
+
+        // The component initializer itself is running from the main thread's Event Queue, and
+        // three more functions have been queued behind it.
+        sharedPtr = FindCounter(segPtr, "event.main.queueDepth");
+        LE_TEST((sharedPtr != NULL) && (sharedPtr->max >= 3));
+
+        metrics_UnmapSegment(segPtr);
+    }
+
+    LE_TEST_EXIT;
+}
@@ -121,6 +121,41 @@ static void TestString(void)
     char notNullTerm[5];
     memset(notNullTerm, 'a', NUM_ARRAY_MEMBERS(notNullTerm));
     CheckString(notNullTerm, 512, NUM_ARRAY_MEMBERS(notNullTerm), false);
+
+    CheckString("multi\xC3\xA9" "byte", 512, 32, true);
+}
+
+static bool UnpackRawString(const char* rawPtr, uint32_t rawSize, size_t outputSz)
+{
+    uint8_t buffer[BUFFER_SZ];
+    uint8_t* bufferPtr = buffer;
+    size_t bufferSz = sizeof(buffer);
+    char valueOut[BUFFER_SZ];
+
+    ResetBuffer(bufferPtr, bufferSz);
+    LE_ASSERT(le_pack_PackUint32(&bufferPtr, &bufferSz, rawSize));
+    memcpy(bufferPtr, rawPtr, rawSize);
+
+    bufferPtr = buffer;
+    bufferSz = sizeof(buffer);
+    if (!le_pack_UnpackString(&bufferPtr, &bufferSz, valueOut, outputSz, 64))
+    {
+        return false;
+    }
+
+    // The bytes are unpacked as they are, whatever their encoding.
+    return (0 == memcmp(valueOut, rawPtr, rawSize)) && ('\0' == valueOut[rawSize]);
+}
+
+static void TestRawString(void)
+{
+    printf("=> raw string\n");
+
+    LE_TEST(UnpackRawString("valid", 5, 6));
+    LE_TEST(!UnpackRawString("valid", 5, 5));           // No room for the null-terminator
+    LE_TEST(UnpackRawString("M\xFCller", 6, 64));       // ISO-8859-1 text, as in SMS messages
+    LE_TEST(UnpackRawString("bad\xC3", 4, 64));         // Cut multi-byte character
+    LE_TEST(UnpackRawString("bad\x80lead", 8, 64));     // Continuation byte without lead byte
 }
 
 COMPONENT_INIT
@@ -132,6 +167,7 @@ COMPONENT_INIT
 
     TestUint8();
     TestString();
+    TestRawString();
 
     printf("======== le_pack Test Complete ========\n");
     printf("\n");
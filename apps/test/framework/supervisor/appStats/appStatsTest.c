@@ -0,0 +1,554 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the Supervisor's sampling of the resource usage of apps (appStats.c).
+ *
+ * The cgroup statistics are stubbed (see cgroupsStub.h): each app's CPU time and memory usage are
+ * given as a function of the sample, and the sample timer runs with a short period (see
+ * Component.cdef).  The test checks:
+ *  - that an app has no history until it is sampled, or once it is stopped,
+ *  - the CPU time used during each period, truncated to milliseconds, zero when the CPU time goes
+ *    down, and clamped when too large,
+ *  - that the ring keeps the last samples, oldest first, and that only the most recent ones are
+ *    returned (with LE_OVERFLOW) when the arrays are too small,
+ *  - that a memory usage growing steadily during a whole ring is reported once, and again only
+ *    after it went down, and that a slow growth, or one that goes down, is not reported,
+ *  - that the statistics files are closed and the sample timer stopped when the apps stop.
+ *
+ * The leak reports are read from the standard error, which is redirected to a pipe while the
+ * samples are taken.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "appStats.h"
+#include "cgroupsStub.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampled apps.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CPU_APP             "cpuApp"        ///< CPU time going down, and jumping.
+#define LEAK_APP            "leakApp"       ///< Memory growing steadily, except once.
+#define SLOW_APP            "slowApp"       ///< Memory growing too slowly to be reported.
+#define SAW_APP             "sawApp"        ///< Memory growing fast, but going down regularly.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample at which the memory used by LEAK_APP goes down.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LEAK_DROP_SAMPLE    100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of samples after which SAW_APP's memory goes down.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SAW_SAMPLES         30
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Margin when waiting for samples (ms).
+ */
+//--------------------------------------------------------------------------------------------------
+#define WAIT_MARGIN_MS      5000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer of the standard error output.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_BUFFER_BYTES    (256 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Standard error output: pipe it is redirected to, original standard error, and what was read so
+ * far.
+ */
+//--------------------------------------------------------------------------------------------------
+static int LogPipeFds[2];
+static int StderrFd;
+static char LogBuffer[LOG_BUFFER_BYTES];
+static size_t LogLen;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetTimeMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the pipe the standard error is redirected to.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateLogPipe
+(
+    void
+)
+{
+    LE_ASSERT(pipe2(LogPipeFds, O_NONBLOCK) == 0);
+
+    StderrFd = dup(STDERR_FILENO);
+    LE_ASSERT(StderrFd >= 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the standard error output written to the pipe so far, and copy it to the standard error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadLog
+(
+    void
+)
+{
+    ssize_t len;
+
+    while ((len = read(LogPipeFds[0], LogBuffer + LogLen, sizeof(LogBuffer) - 1 - LogLen)) > 0)
+    {
+        LE_ASSERT(write(STDERR_FILENO, LogBuffer + LogLen, len) == len);
+        LogLen += len;
+        LogBuffer[LogLen] = '\0';
+    }
+
+    // The buffer must not be full, or some output would be missed.
+    LE_ASSERT((len < 0) && (errno == EAGAIN));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the occurrences of a string in the standard error output.
+ *
+ * @return The number of occurrences.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountInLog
+(
+    const char* strPtr      ///< [IN] String.
+)
+{
+    size_t count = 0;
+    const char* posPtr = LogBuffer;
+
+    while ((posPtr = strstr(posPtr, strPtr)) != NULL)
+    {
+        count++;
+        posPtr += strlen(strPtr);
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a read of a statistic (see cgrpStub_ValueFunc_t).  The CPU time is read once
+ * when an app starts, and then once per sample, before the memory usage.
+ *
+ * @return The value of the statistic.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetStatValue
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat,               ///< [IN] Statistic.
+    size_t readIndex                ///< [IN] Number of previous reads of the statistic's file.
+)
+{
+    if (stat == CGRP_STAT_CPU_USAGE)
+    {
+        if (strcmp(cgroupNamePtr, CPU_APP) != 0)
+        {
+            return readIndex * 1000000;
+        }
+
+        // 3.5 ms per period, then the CPU time goes down, jumps, and grows by 7 ms per period.
+        if (readIndex < 10)
+        {
+            return readIndex * 3500000;
+        }
+        if (readIndex == 10)
+        {
+            return 0;
+        }
+        return (1ULL << 62) + ((readIndex - 11) * 7000000);
+    }
+
+    LE_ASSERT(stat == CGRP_STAT_MEM_USAGE);
+
+    if (strcmp(cgroupNamePtr, LEAK_APP) == 0)
+    {
+        return (readIndex < LEAK_DROP_SAMPLE) ?
+               (4096 + (8 * readIndex)) * 1024 :
+               (2048 + (8 * (readIndex - LEAK_DROP_SAMPLE))) * 1024;
+    }
+    if (strcmp(cgroupNamePtr, SLOW_APP) == 0)
+    {
+        return (1024 + readIndex) * 1024;
+    }
+    if (strcmp(cgroupNamePtr, SAW_APP) == 0)
+    {
+        return (8192 + (16 * (readIndex % SAW_SAMPLES))) * 1024;
+    }
+    return 1024 * 1024 + 100;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time an app is expected to have used during a sample period.
+ *
+ * @return The CPU time (ms).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetExpectedCpuMs
+(
+    const char* appNamePtr,         ///< [IN] Name of the app.
+    size_t sample                   ///< [IN] Sample.
+)
+{
+    if (strcmp(appNamePtr, CPU_APP) != 0)
+    {
+        return 1;
+    }
+
+    if (sample < 9)
+    {
+        return 3;
+    }
+    if (sample == 9)
+    {
+        return 0;
+    }
+    if (sample == 10)
+    {
+        return UINT32_MAX;
+    }
+    return 7;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples taken so far (all the apps are sampled together).
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetSampleCount
+(
+    void
+)
+{
+    return cgrpStub_GetReadCount(LEAK_APP, CGRP_STAT_MEM_USAGE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process the events of this thread until a number of samples were taken.  A few more may be
+ * taken.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaitForSamples
+(
+    size_t sampleCount      ///< [IN] Number of samples.
+)
+{
+    struct pollfd pollFd = { .fd = le_event_GetFd(), .events = POLLIN };
+    uint64_t endTime = GetTimeMs() + (sampleCount * SAMPLE_PERIOD_MS) + WAIT_MARGIN_MS;
+
+    while (GetSampleCount() < sampleCount)
+    {
+        uint64_t now = GetTimeMs();
+
+        LE_ASSERT(now < endTime);
+
+        if (poll(&pollFd, 1, endTime - now) > 0)
+        {
+            LE_ASSERT(dup2(LogPipeFds[1], STDERR_FILENO) == STDERR_FILENO);
+            le_event_ServiceLoop();
+            LE_ASSERT(dup2(StderrFd, STDERR_FILENO) == STDERR_FILENO);
+
+            ReadLog();
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process the events of this thread for a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessEvents
+(
+    uint32_t timeout        ///< [IN] Time to process the events, in milliseconds.
+)
+{
+    struct pollfd pollFd = { .fd = le_event_GetFd(), .events = POLLIN };
+    uint64_t endTime = GetTimeMs() + timeout;
+    uint64_t now;
+
+    while ((now = GetTimeMs()) < endTime)
+    {
+        if (poll(&pollFd, 1, endTime - now) > 0)
+        {
+            while (LE_OK == le_event_ServiceLoop())
+            {
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the history of an app: the last samples taken, oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckHistory
+(
+    const char* appNamePtr,     ///< [IN] Name of the app.
+    size_t cpuMsSize,           ///< [IN] Size of the CPU time array.
+    size_t memKBytesSize        ///< [IN] Size of the memory array.
+)
+{
+    uint32_t cpuMs[LE_APPINFO_MAX_USAGE_SAMPLES];
+    uint32_t memKBytes[LE_APPINFO_MAX_USAGE_SAMPLES];
+    size_t cpuMsCount = cpuMsSize;
+    size_t memKBytesCount = memKBytesSize;
+    uint32_t samplePeriodMs = 0;
+    size_t sampleCount = GetSampleCount();
+    size_t count = (sampleCount < LE_APPINFO_MAX_USAGE_SAMPLES) ?
+                   sampleCount : LE_APPINFO_MAX_USAGE_SAMPLES;
+    le_result_t expectedResult = LE_OK;
+    size_t i;
+
+    if ((cpuMsSize < count) || (memKBytesSize < count))
+    {
+        count = (cpuMsSize < memKBytesSize) ? cpuMsSize : memKBytesSize;
+        expectedResult = LE_OVERFLOW;
+    }
+
+    LE_ASSERT(appStats_GetHistory(appNamePtr,
+                                  cpuMs,
+                                  &cpuMsCount,
+                                  memKBytes,
+                                  &memKBytesCount,
+                                  &samplePeriodMs) == expectedResult);
+    LE_ASSERT(samplePeriodMs == SAMPLE_PERIOD_MS);
+    LE_ASSERT(cpuMsCount == count);
+    LE_ASSERT(memKBytesCount == count);
+
+    for (i = 0; i < count; i++)
+    {
+        size_t sample = sampleCount - count + i;
+
+        LE_ASSERT(cpuMs[i] == GetExpectedCpuMs(appNamePtr, sample));
+        LE_ASSERT(memKBytes[i] == GetStatValue(appNamePtr, CGRP_STAT_MEM_USAGE, sample) / 1024);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that an app has no history.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckNoHistory
+(
+    const char* appNamePtr      ///< [IN] Name of the app.
+)
+{
+    uint32_t cpuMs[LE_APPINFO_MAX_USAGE_SAMPLES];
+    uint32_t memKBytes[LE_APPINFO_MAX_USAGE_SAMPLES];
+    size_t cpuMsCount = NUM_ARRAY_MEMBERS(cpuMs);
+    size_t memKBytesCount = NUM_ARRAY_MEMBERS(memKBytes);
+    uint32_t samplePeriodMs = 0;
+
+    LE_ASSERT(appStats_GetHistory(appNamePtr,
+                                  cpuMs,
+                                  &cpuMsCount,
+                                  memKBytes,
+                                  &memKBytesCount,
+                                  &samplePeriodMs) == LE_NOT_FOUND);
+    LE_ASSERT(samplePeriodMs == SAMPLE_PERIOD_MS);
+    LE_ASSERT(cpuMsCount == 0);
+    LE_ASSERT(memKBytesCount == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the start of the sampling: no history before the first sample, and the CPU time read when
+ * an app starts.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStart
+(
+    void
+)
+{
+    LE_INFO("======== Start ========");
+
+    CheckNoHistory(CPU_APP);
+
+    appStats_Start(CPU_APP);
+    appStats_Start(LEAK_APP);
+    appStats_Start(SLOW_APP);
+    appStats_Start(SAW_APP);
+
+    // Starting an app already sampled does nothing.
+    appStats_Start(CPU_APP);
+
+    LE_ASSERT(cgrpStub_GetReadCount(CPU_APP, CGRP_STAT_CPU_USAGE) == 1);
+    LE_ASSERT(cgrpStub_GetReadCount(CPU_APP, CGRP_STAT_MEM_USAGE) == 0);
+    CheckNoHistory(CPU_APP);
+    CheckNoHistory("otherApp");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the samples before the ring is full: the CPU time used during each period, and the arrays
+ * too small for all the samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestSamples
+(
+    void
+)
+{
+    LE_INFO("======== Samples ========");
+
+    WaitForSamples(20);
+
+    CheckHistory(CPU_APP, LE_APPINFO_MAX_USAGE_SAMPLES, LE_APPINFO_MAX_USAGE_SAMPLES);
+    CheckHistory(LEAK_APP, LE_APPINFO_MAX_USAGE_SAMPLES, LE_APPINFO_MAX_USAGE_SAMPLES);
+
+    CheckHistory(CPU_APP, 5, 8);
+    CheckHistory(CPU_APP, LE_APPINFO_MAX_USAGE_SAMPLES, 3);
+    CheckHistory(CPU_APP, 0, LE_APPINFO_MAX_USAGE_SAMPLES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the ring, once it wrapped, and the leak reports.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestLeak
+(
+    void
+)
+{
+    LE_INFO("======== Leak ========");
+
+    // The first full ring of LEAK_APP is reported, and the next ones are not.
+    WaitForSamples(LEAK_DROP_SAMPLE + 20);
+
+    CheckHistory(LEAK_APP, LE_APPINFO_MAX_USAGE_SAMPLES, LE_APPINFO_MAX_USAGE_SAMPLES);
+    CheckHistory(CPU_APP, LE_APPINFO_MAX_USAGE_SAMPLES, LE_APPINFO_MAX_USAGE_SAMPLES);
+    CheckHistory(SAW_APP, 10, 10);
+
+    LE_ASSERT(CountInLog("Possible memory leak") == 1);
+    LE_ASSERT(CountInLog("app '" LEAK_APP "' grew steadily from 4096 to 4568 KiB") == 1);
+
+    // Once its memory went down, the first full ring of LEAK_APP that grows again is reported.
+    WaitForSamples(LEAK_DROP_SAMPLE + LE_APPINFO_MAX_USAGE_SAMPLES + 10);
+
+    CheckHistory(LEAK_APP, LE_APPINFO_MAX_USAGE_SAMPLES, LE_APPINFO_MAX_USAGE_SAMPLES);
+
+    LE_ASSERT(CountInLog("Possible memory leak") == 2);
+    LE_ASSERT(CountInLog("app '" LEAK_APP "' grew steadily from 2048 to 2520 KiB") == 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the end of the sampling: the history is forgotten, the statistics files are closed, and the
+ * sample timer stops with the last app.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStop
+(
+    void
+)
+{
+    LE_INFO("======== Stop ========");
+
+    appStats_Stop(CPU_APP);
+
+    CheckNoHistory(CPU_APP);
+    LE_ASSERT(!cgrpStub_IsOpen(CPU_APP, CGRP_STAT_CPU_USAGE));
+    LE_ASSERT(!cgrpStub_IsOpen(CPU_APP, CGRP_STAT_MEM_USAGE));
+    LE_ASSERT(cgrpStub_IsOpen(LEAK_APP, CGRP_STAT_CPU_USAGE));
+
+    // Stopping an app not sampled does nothing.
+    appStats_Stop(CPU_APP);
+    appStats_Stop("otherApp");
+
+    // The other apps are still sampled.
+    size_t cpuAppReadCount = cgrpStub_GetReadCount(CPU_APP, CGRP_STAT_MEM_USAGE);
+    WaitForSamples(GetSampleCount() + 2);
+    LE_ASSERT(cgrpStub_GetReadCount(CPU_APP, CGRP_STAT_MEM_USAGE) == cpuAppReadCount);
+
+    appStats_Stop(LEAK_APP);
+    appStats_Stop(SLOW_APP);
+    appStats_Stop(SAW_APP);
+
+    LE_ASSERT(!cgrpStub_IsOpen(SAW_APP, CGRP_STAT_MEM_USAGE));
+
+    size_t sampleCount = GetSampleCount();
+    ProcessEvents(10 * SAMPLE_PERIOD_MS);
+    LE_ASSERT(GetSampleCount() == sampleCount);
+
+    // A restarted app starts with no history.
+    appStats_Start(CPU_APP);
+    CheckNoHistory(CPU_APP);
+    appStats_Stop(CPU_APP);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main of the test.
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    CreateLogPipe();
+
+    cgrpStub_SetValueFunc(GetStatValue);
+    appStats_Init();
+
+    TestStart();
+    TestSamples();
+    TestLeak();
+    TestStop();
+
+    // No other app was reported.
+    LE_ASSERT(CountInLog("Possible memory leak") == 2);
+
+    LE_INFO("======== App resource usage sampling tests passed ========");
+    exit(EXIT_SUCCESS);
+}
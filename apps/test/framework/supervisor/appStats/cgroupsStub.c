@@ -0,0 +1,178 @@
+/**
+ * Stub of the cgroup statistics (see cgroupsStub.h).
+ *
+ * Each statistics file is simulated with a file descriptor of /dev/null, so that it can be closed
+ * like a real one.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "cgroupsStub.h"
+#include "limit.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulated statistics file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char cgroupName[LIMIT_MAX_APP_NAME_BYTES];  ///< Name of the cgroup.
+    cgrp_Stat_t stat;                           ///< Statistic.
+    int fd;                                     ///< File descriptor.
+    size_t readCount;                           ///< Number of reads.
+}
+StatFile_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics files opened during the test, in the order they were opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static StatFile_t StatFiles[CGRP_STUB_MAX_STATS];
+static size_t StatFileCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function giving the values of the statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static cgrpStub_ValueFunc_t ValueFunc;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the last file opened for a statistic of a cgroup.
+ *
+ * @return The file, or NULL if it was never opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static StatFile_t* FindStatFile
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat                ///< [IN] Statistic.
+)
+{
+    size_t i = StatFileCount;
+
+    while (i-- > 0)
+    {
+        if ((StatFiles[i].stat == stat) && (strcmp(StatFiles[i].cgroupName, cgroupNamePtr) == 0))
+        {
+            return &StatFiles[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the function giving the values of the statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrpStub_SetValueFunc
+(
+    cgrpStub_ValueFunc_t valueFunc      ///< [IN] Value function.
+)
+{
+    ValueFunc = valueFunc;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of reads of the last file opened for a statistic of a cgroup.
+ *
+ * @return The number of reads (0 if the file was never opened).
+ */
+//--------------------------------------------------------------------------------------------------
+size_t cgrpStub_GetReadCount
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat                ///< [IN] Statistic.
+)
+{
+    StatFile_t* statFilePtr = FindStatFile(cgroupNamePtr, stat);
+
+    return (statFilePtr == NULL) ? 0 : statFilePtr->readCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the last file opened for a statistic of a cgroup is still open.
+ *
+ * @return true if the file is open.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cgrpStub_IsOpen
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat                ///< [IN] Statistic.
+)
+{
+    StatFile_t* statFilePtr = FindStatFile(cgroupNamePtr, stat);
+
+    return (statFilePtr != NULL) && (fcntl(statFilePtr->fd, F_GETFD) != -1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the file of a cgroup statistic. (STUBBED FUNCTION)
+ *
+ * @return
+ *      The file descriptor of the statistic's file if successful.
+ *      A negative value if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+int cgrp_OpenStat
+(
+    cgrp_Stat_t stat,               ///< [IN] Statistic.
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
+)
+{
+    LE_ASSERT(StatFileCount < CGRP_STUB_MAX_STATS);
+
+    StatFile_t* statFilePtr = &StatFiles[StatFileCount++];
+
+    LE_ASSERT(le_utf8_Copy(statFilePtr->cgroupName, cgroupNamePtr,
+                           sizeof(statFilePtr->cgroupName), NULL) == LE_OK);
+    statFilePtr->stat = stat;
+    statFilePtr->readCount = 0;
+    statFilePtr->fd = open("/dev/null", O_RDONLY);
+    LE_ASSERT(statFilePtr->fd >= 0);
+
+    return statFilePtr->fd;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the current value of a cgroup statistic. (STUBBED FUNCTION)
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_ReadStat
+(
+    int fd,                         ///< [IN] File descriptor returned by cgrp_OpenStat().
+    uint64_t* valuePtr              ///< [OUT] Value.
+)
+{
+    size_t i = StatFileCount;
+
+    // File descriptors are reused once closed: the last file opened is the right one.
+    while (i-- > 0)
+    {
+        if (StatFiles[i].fd == fd)
+        {
+            LE_ASSERT(ValueFunc != NULL);
+            *valuePtr = ValueFunc(StatFiles[i].cgroupName, StatFiles[i].stat,
+                                  StatFiles[i].readCount++);
+            return LE_OK;
+        }
+    }
+
+    LE_ERROR("Unknown statistic file %d", fd);
+    return LE_FAULT;
+}
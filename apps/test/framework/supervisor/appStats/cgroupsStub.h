@@ -0,0 +1,73 @@
+/**
+ * @file cgroupsStub.h
+ *
+ * Stub of the cgroup statistics for the app resource usage unit tests: the statistics files are
+ * simulated, and the value of each read is given by the test.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef CGROUPS_STUB_H_INCLUDE_GUARD
+#define CGROUPS_STUB_H_INCLUDE_GUARD
+
+#include "legato.h"
+#include "cgroups.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of statistics files opened during a test.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CGRP_STUB_MAX_STATS     16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function giving the value of a read of a statistic.
+ *
+ * @return The value of the statistic.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint64_t (*cgrpStub_ValueFunc_t)
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat,               ///< [IN] Statistic.
+    size_t readIndex                ///< [IN] Number of previous reads of the statistic's file.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the function giving the values of the statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrpStub_SetValueFunc
+(
+    cgrpStub_ValueFunc_t valueFunc      ///< [IN] Value function.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of reads of the last file opened for a statistic of a cgroup.
+ *
+ * @return The number of reads (0 if the file was never opened).
+ */
+//--------------------------------------------------------------------------------------------------
+size_t cgrpStub_GetReadCount
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat                ///< [IN] Statistic.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the last file opened for a statistic of a cgroup is still open.
+ *
+ * @return true if the file is open.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cgrpStub_IsOpen
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    cgrp_Stat_t stat                ///< [IN] Statistic.
+);
+
+#endif // CGROUPS_STUB_H_INCLUDE_GUARD
@@ -0,0 +1,562 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the Update Daemon's app delta module (appDelta_Apply()).
+ *
+ * Builds base apps and unpacked deltas in a temporary directory, and checks:
+ *  - that files are rebuilt from copies and patches, with the base files' permissions,
+ *  - rejection of malformed manifests, and of unsafe paths in them,
+ *  - rejection of corrupt, truncated and oversized patches,
+ *  - rejection of a missing base app, base file, or a base file that isn't the one the delta was
+ *    made against (CRC mismatch).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "appDelta.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Files of the base app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BASE_BIN        "hello world"
+#define BASE_LIB        "abcdefgh"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What the patch of BASE_LIB turns it into.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NEW_LIB         "abcXefghYZ"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Temporary directory holding everything, and the base app and unpack directories in it.
+ */
+//--------------------------------------------------------------------------------------------------
+static char TestDir[] = "/tmp/appDeltaTestXXXXXX";
+static char BaseDir[LIMIT_MAX_PATH_BYTES];
+static char UnpackDir[LIMIT_MAX_PATH_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CRC of some data, formatted the way it is in manifests.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* Crc
+(
+    const char* dataPtr,
+    size_t size,
+    char* bufPtr        ///< At least 9 bytes.
+)
+{
+    sprintf(bufPtr, "%08" PRIx32, le_crc_Crc32((uint8_t*)dataPtr, size, LE_CRC_START_CRC32));
+    return bufPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file (and its directory) holding some data.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFile
+(
+    const char* dirPtr,
+    const char* pathPtr,
+    const void* dataPtr,
+    size_t size,
+    mode_t mode
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+
+    LE_ASSERT(le_path_Concat("/", path, sizeof(path), dirPtr, pathPtr, NULL) == LE_OK);
+    *strrchr(path, '/') = '\0';
+    LE_ASSERT(le_dir_MakePath(path, S_IRWXU) == LE_OK);
+    path[strlen(path)] = '/';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, dataPtr, size) == (ssize_t)size);
+    LE_ASSERT(fchmod(fd, mode) == 0);
+    LE_ASSERT(close(fd) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a file of the unpack directory holds some data.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFile
+(
+    const char* pathPtr,
+    const char* expectedPtr,
+    mode_t expectedMode
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+    char buffer[64];
+    struct stat fileStat;
+
+    LE_ASSERT(le_path_Concat("/", path, sizeof(path), UnpackDir, pathPtr, NULL) == LE_OK);
+
+    int fd = open(path, O_RDONLY);
+    LE_ASSERT(fd >= 0);
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    LE_ASSERT(fstat(fd, &fileStat) == 0);
+    close(fd);
+
+    LE_ASSERT((count == (ssize_t)strlen(expectedPtr)) && (memcmp(buffer, expectedPtr, count) == 0));
+    LE_ASSERT((fileStat.st_mode & 07777) == expectedMode);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a 64-bit signed integer the way bsdiff does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EncodeInt
+(
+    int64_t value,
+    uint8_t* bufPtr
+)
+{
+    uint64_t magnitude = (value < 0) ? -(uint64_t)value : (uint64_t)value;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        bufPtr[i] = magnitude >> (8 * i);
+    }
+
+    if (value < 0)
+    {
+        bufPtr[7] |= 0x80;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A patch under construction.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t data[512];
+    size_t size;
+}
+Patch_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a patch with its header.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPatch
+(
+    Patch_t* patchPtr,
+    int64_t ctrlLen,
+    int64_t diffLen,
+    int64_t newSize
+)
+{
+    memcpy(patchPtr->data, APPDELTA_PATCH_MAGIC, 8);
+    EncodeInt(ctrlLen, patchPtr->data + 8);
+    EncodeInt(diffLen, patchPtr->data + 16);
+    EncodeInt(newSize, patchPtr->data + 24);
+    patchPtr->size = 32;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a control triple to a patch.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddControl
+(
+    Patch_t* patchPtr,
+    int64_t addLen,
+    int64_t copyLen,
+    int64_t seekLen
+)
+{
+    EncodeInt(addLen, patchPtr->data + patchPtr->size);
+    EncodeInt(copyLen, patchPtr->data + patchPtr->size + 8);
+    EncodeInt(seekLen, patchPtr->data + patchPtr->size + 16);
+    patchPtr->size += 24;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add bytes to a patch.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddBytes
+(
+    Patch_t* patchPtr,
+    const void* dataPtr,
+    size_t size
+)
+{
+    memcpy(patchPtr->data + patchPtr->size, dataPtr, size);
+    patchPtr->size += size;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the patch that turns BASE_LIB into NEW_LIB: add 8 bytes (changing the 4th), then copy the
+ * 2 extra bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeLibPatch
+(
+    Patch_t* patchPtr
+)
+{
+    static const uint8_t diff[8] = { 0, 0, 0, 'X' - 'd', 0, 0, 0, 0 };
+
+    StartPatch(patchPtr, 24, sizeof(diff), strlen(NEW_LIB));
+    AddControl(patchPtr, sizeof(diff), 2, 0);
+    AddBytes(patchPtr, diff, sizeof(diff));
+    AddBytes(patchPtr, "YZ", 2);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a fresh base app and an empty unpack directory (with an empty APPDELTA_DIR).
+ */
+//--------------------------------------------------------------------------------------------------
+static void Reset
+(
+    void
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+
+    LE_ASSERT(le_dir_RemoveRecursive(BaseDir) == LE_OK);
+    LE_ASSERT(le_dir_RemoveRecursive(UnpackDir) == LE_OK);
+
+    WriteFile(BaseDir, "read-only/bin/hello", BASE_BIN, strlen(BASE_BIN), 0755);
+    WriteFile(BaseDir, "read-only/lib/libHello.so", BASE_LIB, strlen(BASE_LIB), 0640);
+
+    LE_ASSERT(le_path_Concat("/", path, sizeof(path), UnpackDir, APPDELTA_DIR, NULL) == LE_OK);
+    LE_ASSERT(le_dir_MakePath(path, S_IRWXU) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the manifest and a patch named "0", then apply the delta.
+ *
+ * @return appDelta_Apply()'s result.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Apply
+(
+    const char* manifestPtr,    ///< Manifest lines after the header (NULL for no manifest).
+    const Patch_t* patchPtr     ///< Patch (NULL for none).
+)
+{
+    if (manifestPtr != NULL)
+    {
+        char manifest[1024];
+
+        snprintf(manifest, sizeof(manifest), "%s\n%s", APPDELTA_MANIFEST_HEADER, manifestPtr);
+        WriteFile(UnpackDir, APPDELTA_DIR "/" APPDELTA_MANIFEST, manifest, strlen(manifest), 0644);
+    }
+
+    if (patchPtr != NULL)
+    {
+        WriteFile(UnpackDir, APPDELTA_DIR "/0", patchPtr->data, patchPtr->size, 0644);
+    }
+
+    return appDelta_Apply(UnpackDir, BaseDir);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset, and apply a delta that is expected to be rejected as malformed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckRejected
+(
+    const char* manifestPtr,
+    const Patch_t* patchPtr
+)
+{
+    Reset();
+    LE_ASSERT(Apply(manifestPtr, patchPtr) == LE_FORMAT_ERROR);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test a valid delta.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestValid
+(
+    void
+)
+{
+    char manifest[256];
+    char binCrc[9];
+    char libCrc[9];
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+    Patch_t patch;
+
+    LE_INFO("Testing a valid delta.");
+
+    Reset();
+    MakeLibPatch(&patch);
+    snprintf(manifest, sizeof(manifest),
+             "copy %s read-only/bin/hello\n"
+             "patch %s 0 read-only/lib/libHello.so\n",
+             Crc(BASE_BIN, strlen(BASE_BIN), binCrc),
+             Crc(NEW_LIB, strlen(NEW_LIB), libCrc));
+
+    LE_ASSERT(Apply(manifest, &patch) == LE_OK);
+
+    CheckFile("read-only/bin/hello", BASE_BIN, 0755);
+    CheckFile("read-only/lib/libHello.so", NEW_LIB, 0640);
+
+    LE_ASSERT(le_path_Concat("/", path, sizeof(path), UnpackDir, APPDELTA_DIR, NULL) == LE_OK);
+    LE_ASSERT(!le_dir_IsDir(path));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test malformed manifests and unsafe paths.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestManifest
+(
+    void
+)
+{
+    char manifest[256];
+    char binCrc[9];
+    Patch_t patch;
+
+    LE_INFO("Testing malformed manifests.");
+
+    Crc(BASE_BIN, strlen(BASE_BIN), binCrc);
+    MakeLibPatch(&patch);
+
+    // No manifest, wrong header, unterminated line.
+    CheckRejected(NULL, NULL);
+    Reset();
+    WriteFile(UnpackDir, APPDELTA_DIR "/" APPDELTA_MANIFEST, "legato-app-delta 1\n", 19, 0644);
+    LE_ASSERT(appDelta_Apply(UnpackDir, BaseDir) == LE_FORMAT_ERROR);
+    snprintf(manifest, sizeof(manifest), "copy %s read-only/bin/hello", binCrc);
+    CheckRejected(manifest, NULL);
+
+    // Unknown operation, and missing or malformed CRCs.
+    CheckRejected("move read-only/bin/hello\n", NULL);
+    CheckRejected("copy read-only/bin/hello\n", NULL);
+    CheckRejected("copy 1234 read-only/bin/hello\n", NULL);
+    CheckRejected("copy 1234567g read-only/bin/hello\n", NULL);
+    CheckRejected("patch 0 read-only/lib/libHello.so\n", &patch);
+
+    // Paths that leave the app or the delta directory.
+    const char* unsafePaths[] = { "../hello", "/etc/passwd", "read-only/../../hello", "", ".." };
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(unsafePaths); i++)
+    {
+        snprintf(manifest, sizeof(manifest), "copy %s %s\n", binCrc, unsafePaths[i]);
+        CheckRejected(manifest, NULL);
+        snprintf(manifest, sizeof(manifest), "patch %s %s read-only/lib/libHello.so\n",
+                 binCrc, unsafePaths[i]);
+        CheckRejected(manifest, &patch);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test a missing or different base app.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestBase
+(
+    void
+)
+{
+    char manifest[256];
+    char binCrc[9];
+    char libCrc[9];
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+    Patch_t patch;
+
+    LE_INFO("Testing missing and mismatched base apps.");
+
+    Crc(BASE_BIN, strlen(BASE_BIN), binCrc);
+    Crc(NEW_LIB, strlen(NEW_LIB), libCrc);
+    MakeLibPatch(&patch);
+
+    // Missing base app.
+    snprintf(manifest, sizeof(manifest), "copy %s read-only/bin/hello\n", binCrc);
+    Reset();
+    LE_ASSERT(le_dir_RemoveRecursive(BaseDir) == LE_OK);
+    LE_ASSERT(Apply(manifest, NULL) == LE_FORMAT_ERROR);
+
+    // Missing base files.
+    CheckRejected("copy 00000000 read-only/bin/goodbye\n", NULL);
+    snprintf(manifest, sizeof(manifest), "patch %s 0 read-only/lib/libGoodbye.so\n", libCrc);
+    CheckRejected(manifest, &patch);
+
+    // Base file that is a symlink.
+    snprintf(manifest, sizeof(manifest), "copy %s read-only/bin/link\n", binCrc);
+    Reset();
+    LE_ASSERT(le_path_Concat("/", path, sizeof(path), BaseDir, "read-only/bin/link", NULL)
+              == LE_OK);
+    LE_ASSERT(symlink("hello", path) == 0);
+    LE_ASSERT(Apply(manifest, NULL) == LE_FORMAT_ERROR);
+
+    // Base files that aren't the ones the delta was made against.
+    snprintf(manifest, sizeof(manifest), "copy %s read-only/bin/hello\n", libCrc);
+    CheckRejected(manifest, NULL);
+    snprintf(manifest, sizeof(manifest), "patch %s 0 read-only/lib/libHello.so\n", binCrc);
+    CheckRejected(manifest, &patch);
+    snprintf(manifest, sizeof(manifest), "patch %s 0 read-only/lib/libHello.so\n", libCrc);
+    Reset();
+    WriteFile(BaseDir, "read-only/lib/libHello.so", "ABCDEFGH", 8, 0640);
+    LE_ASSERT(Apply(manifest, &patch) == LE_FORMAT_ERROR);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test corrupt, truncated and oversized patches.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestPatch
+(
+    void
+)
+{
+    static const uint8_t diff[8] = { 0, 0, 0, 'X' - 'd', 0, 0, 0, 0 };
+    char manifest[256];
+    char libCrc[9];
+    Patch_t patch;
+
+    LE_INFO("Testing corrupt patches.");
+
+    snprintf(manifest, sizeof(manifest), "patch %s 0 read-only/lib/libHello.so\n",
+             Crc(NEW_LIB, strlen(NEW_LIB), libCrc));
+
+    // Missing patch, bad magic, header too short.
+    CheckRejected(manifest, NULL);
+    MakeLibPatch(&patch);
+    patch.data[0] = 'X';
+    CheckRejected(manifest, &patch);
+    MakeLibPatch(&patch);
+    patch.size = 31;
+    CheckRejected(manifest, &patch);
+
+    // Truncated extra block, diff block and control block.
+    MakeLibPatch(&patch);
+    patch.size--;
+    CheckRejected(manifest, &patch);
+    MakeLibPatch(&patch);
+    patch.size = 32 + 24 + 4;
+    CheckRejected(manifest, &patch);
+    MakeLibPatch(&patch);
+    patch.size = 32 + 12;
+    CheckRejected(manifest, &patch);
+
+    // Negative and oversized lengths in the header.
+    const int64_t badHeaders[][3] =
+    {
+        { -24, 8, 10 },
+        { 24, -8, 10 },
+        { 24, 8, -10 },
+        { INT64_MAX, 8, 10 },
+        { 24, INT64_MAX, 10 },
+        { 24, 8, INT64_MAX },
+        { 24, 8, 11 },          // More than the diff and extra blocks hold.
+    };
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(badHeaders); i++)
+    {
+        StartPatch(&patch, badHeaders[i][0], badHeaders[i][1], badHeaders[i][2]);
+        AddControl(&patch, 8, 2, 0);
+        AddBytes(&patch, diff, sizeof(diff));
+        AddBytes(&patch, "YZ", 2);
+        CheckRejected(manifest, &patch);
+    }
+
+    // Control triples that are negative, or go past the end of the new file or their blocks.
+    const int64_t badControls[][3] =
+    {
+        { -1, 2, 0 },
+        { 8, -1, 0 },
+        { 11, 0, 0 },
+        { 8, 3, 0 },
+        { 9, 1, 0 },            // Only 8 diff bytes.
+        { 7, 3, 0 },            // Only 2 extra bytes.
+    };
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(badControls); i++)
+    {
+        StartPatch(&patch, 24, sizeof(diff), strlen(NEW_LIB));
+        AddControl(&patch, badControls[i][0], badControls[i][1], badControls[i][2]);
+        AddBytes(&patch, diff, sizeof(diff));
+        AddBytes(&patch, "YZ", 2);
+        CheckRejected(manifest, &patch);
+    }
+
+    // Control block that runs out before the new file is complete (the next triple would have to
+    // be read from the diff block).
+    StartPatch(&patch, 24, 32, strlen(NEW_LIB));
+    AddControl(&patch, 4, 0, 0);
+    AddControl(&patch, 4, 2, 0);
+    AddBytes(&patch, diff, sizeof(diff));
+    AddBytes(&patch, "YZ", 2);
+    CheckRejected(manifest, &patch);
+
+    // Seeking so far through the base file that the position overflows.
+    StartPatch(&patch, 48, sizeof(diff), strlen(NEW_LIB));
+    AddControl(&patch, 0, 1, INT64_MAX);
+    AddControl(&patch, 8, 1, 0);
+    AddBytes(&patch, diff, sizeof(diff));
+    AddBytes(&patch, "YZ", 2);
+    CheckRejected(manifest, &patch);
+}
+
+
+COMPONENT_INIT
+{
+    LE_ASSERT(mkdtemp(TestDir) != NULL);
+    LE_ASSERT(le_path_Concat("/", BaseDir, sizeof(BaseDir), TestDir, "base", NULL) == LE_OK);
+    LE_ASSERT(le_path_Concat("/", UnpackDir, sizeof(UnpackDir), TestDir, "unpack", NULL) == LE_OK);
+
+    TestValid();
+    TestManifest();
+    TestBase();
+    TestPatch();
+
+    LE_ASSERT(le_dir_RemoveRecursive(TestDir) == LE_OK);
+
+    LE_INFO("======== App delta tests passed ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,505 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test of the Update Daemon's file store (fileStore_AddTree() and fileStore_RemoveUnused()).
+ *
+ * Builds app directories in a temporary directory (the store itself is built in FILESTORE_PATH,
+ * see Component.cdef), and checks:
+ *  - that identical files are replaced by links to one stored file, and that small files aren't,
+ *  - that files differing by their contents (even with the same CRC and size), permissions, owner
+ *    or namespace are not linked together,
+ *  - that different files with the same key are stored with the .N suffixes, and found there,
+ *  - that only the stored files no app links to any more are removed, with empty namespaces.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fileStore.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the shared files (the store ignores files smaller than 1 KiB).
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILE_BYTES      4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a file too small to be shared.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMALL_BYTES     100
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Temporary directory holding the apps.
+ */
+//--------------------------------------------------------------------------------------------------
+static char TestDir[] = "/tmp/fileStoreTestXXXXXX";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contents of the files: a library, an executable, and a file with the same CRC32 and size as
+ * the library.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t LibData[FILE_BYTES];
+static uint8_t ExeData[FILE_BYTES];
+static uint8_t CollidingData[FILE_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill the contents of the files.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeData
+(
+    void
+)
+{
+    // The CRC32 generator polynomial, in the bit order of the CRC.  XORing it into data of a given
+    // size doesn't change the CRC32 of the data.
+    static const uint8_t polynomial[] = { 0x41, 0x06, 0x71, 0xDB, 0x01 };
+    size_t i;
+
+    for (i = 0; i < FILE_BYTES; i++)
+    {
+        LibData[i] = (uint8_t)(i * 7 + (i >> 8));
+        ExeData[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    memcpy(CollidingData, LibData, FILE_BYTES);
+    for (i = 0; i < sizeof(polynomial); i++)
+    {
+        CollidingData[100 + i] ^= polynomial[i];
+    }
+
+    LE_ASSERT(memcmp(CollidingData, LibData, FILE_BYTES) != 0);
+    LE_ASSERT(le_crc_Crc32(CollidingData, FILE_BYTES, LE_CRC_START_CRC32) ==
+              le_crc_Crc32(LibData, FILE_BYTES, LE_CRC_START_CRC32));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of a file of an app.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* AppPath
+(
+    const char* appPtr,
+    const char* pathPtr,    ///< NULL for the app's directory.
+    char* bufPtr            ///< LIMIT_MAX_PATH_BYTES bytes.
+)
+{
+    bufPtr[0] = '\0';
+    LE_ASSERT(le_path_Concat("/", bufPtr, LIMIT_MAX_PATH_BYTES, TestDir, appPtr, pathPtr, NULL)
+              == LE_OK);
+    return bufPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file (and its directory) in an app.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFile
+(
+    const char* appPtr,
+    const char* pathPtr,
+    const void* dataPtr,
+    size_t size,
+    mode_t mode
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    AppPath(appPtr, pathPtr, path);
+    *strrchr(path, '/') = '\0';
+    LE_ASSERT(le_dir_MakePath(path, S_IRWXU) == LE_OK);
+    path[strlen(path)] = '/';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, dataPtr, size) == (ssize_t)size);
+    LE_ASSERT(fchmod(fd, mode) == 0);
+    LE_ASSERT(close(fd) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the status of a file of an app.
+ */
+//--------------------------------------------------------------------------------------------------
+static struct stat StatFile
+(
+    const char* appPtr,
+    const char* pathPtr
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    struct stat fileStat;
+
+    LE_ASSERT(lstat(AppPath(appPtr, pathPtr, path), &fileStat) == 0);
+    return fileStat;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether two files of apps are the same file (hard links to the same inode).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSameFile
+(
+    const char* app1Ptr,
+    const char* path1Ptr,
+    const char* app2Ptr,
+    const char* path2Ptr
+)
+{
+    struct stat stat1 = StatFile(app1Ptr, path1Ptr);
+    struct stat stat2 = StatFile(app2Ptr, path2Ptr);
+
+    return (stat1.st_dev == stat2.st_dev) && (stat1.st_ino == stat2.st_ino);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a file of an app still holds its data, with its permissions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFile
+(
+    const char* appPtr,
+    const char* pathPtr,
+    const void* expectedPtr,
+    mode_t expectedMode
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    uint8_t buffer[FILE_BYTES + 1];
+    struct stat fileStat;
+
+    int fd = open(AppPath(appPtr, pathPtr, path), O_RDONLY);
+    LE_ASSERT(fd >= 0);
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    LE_ASSERT(fstat(fd, &fileStat) == 0);
+    close(fd);
+
+    LE_ASSERT((count == FILE_BYTES) && (memcmp(buffer, expectedPtr, FILE_BYTES) == 0));
+    LE_ASSERT((fileStat.st_mode & 07777) == expectedMode);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the stored file of a namespace that a file of an app is linked to.
+ *
+ * @return The name of the stored file, or NULL if the app's file isn't in the store.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* FindStored
+(
+    const char* namespacePtr,
+    const char* appPtr,
+    const char* pathPtr,
+    char* nameBufPtr        ///< NAME_MAX + 1 bytes.
+)
+{
+    char storeDir[LIMIT_MAX_PATH_BYTES] = "";
+    struct stat fileStat = StatFile(appPtr, pathPtr);
+    const char* foundPtr = NULL;
+    struct dirent* entryPtr;
+
+    LE_ASSERT(le_path_Concat("/", storeDir, sizeof(storeDir), FILESTORE_PATH, namespacePtr, NULL)
+              == LE_OK);
+
+    DIR* dirPtr = opendir(storeDir);
+    if (dirPtr == NULL)
+    {
+        return NULL;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        struct stat storedStat;
+
+        if (   (fstatat(dirfd(dirPtr), entryPtr->d_name, &storedStat, AT_SYMLINK_NOFOLLOW) == 0)
+            && S_ISREG(storedStat.st_mode)
+            && (storedStat.st_dev == fileStat.st_dev)
+            && (storedStat.st_ino == fileStat.st_ino))
+        {
+            LE_ASSERT(foundPtr == NULL);
+            LE_ASSERT(le_utf8_Copy(nameBufPtr, entryPtr->d_name, NAME_MAX + 1, NULL) == LE_OK);
+            foundPtr = nameBufPtr;
+        }
+    }
+
+    closedir(dirPtr);
+
+    return foundPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the files in a namespace of the store.
+ *
+ * @return The number of files, or -1 if the namespace doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CountStored
+(
+    const char* namespacePtr
+)
+{
+    char storeDir[LIMIT_MAX_PATH_BYTES] = "";
+    struct dirent* entryPtr;
+    int count = 0;
+
+    LE_ASSERT(le_path_Concat("/", storeDir, sizeof(storeDir), FILESTORE_PATH, namespacePtr, NULL)
+              == LE_OK);
+
+    DIR* dirPtr = opendir(storeDir);
+    if (dirPtr == NULL)
+    {
+        return -1;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if (entryPtr->d_name[0] != '.')
+        {
+            count++;
+        }
+    }
+
+    closedir(dirPtr);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the files of an app to the store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddApp
+(
+    const char* appPtr,
+    const char* namespacePtr
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    fileStore_AddTree(AppPath(appPtr, NULL, path), namespacePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove an app, as the Update Daemon does when no system uses it any more.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveApp
+(
+    const char* appPtr
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    LE_ASSERT(le_dir_RemoveRecursive(AppPath(appPtr, NULL, path)) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that identical files are linked together, and that small files are left alone.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestIdentical
+(
+    void
+)
+{
+    char name[NAME_MAX + 1];
+
+    LE_INFO("======== Identical files ========");
+
+    // The first app's files are added to the store.
+    WriteFile("app1", "lib/libfoo.so", LibData, FILE_BYTES, 0644);
+    WriteFile("app1", "bin/foo", ExeData, FILE_BYTES, 0755);
+    WriteFile("app1", "bin/small", ExeData, SMALL_BYTES, 0644);
+    AddApp("app1", "_");
+
+    LE_ASSERT(CountStored("_") == 2);
+    LE_ASSERT(FindStored("_", "app1", "lib/libfoo.so", name) != NULL);
+    LE_ASSERT(FindStored("_", "app1", "bin/foo", name) != NULL);
+    LE_ASSERT(FindStored("_", "app1", "bin/small", name) == NULL);
+    LE_ASSERT(StatFile("app1", "lib/libfoo.so").st_nlink == 2);
+
+    // The second app's identical files are replaced by links to them, wherever they are.
+    WriteFile("app2", "lib/libfoo.so", LibData, FILE_BYTES, 0644);
+    WriteFile("app2", "bin/bar", ExeData, FILE_BYTES, 0755);
+    WriteFile("app2", "bin/small", ExeData, SMALL_BYTES, 0644);
+    AddApp("app2", "_");
+
+    LE_ASSERT(CountStored("_") == 2);
+    LE_ASSERT(IsSameFile("app1", "lib/libfoo.so", "app2", "lib/libfoo.so"));
+    LE_ASSERT(IsSameFile("app1", "bin/foo", "app2", "bin/bar"));
+    LE_ASSERT(!IsSameFile("app1", "bin/small", "app2", "bin/small"));
+    LE_ASSERT(StatFile("app1", "lib/libfoo.so").st_nlink == 3);
+    CheckFile("app2", "lib/libfoo.so", LibData, 0644);
+    CheckFile("app2", "bin/bar", ExeData, 0755);
+
+    // Adding the same files again changes nothing.
+    AddApp("app2", "_");
+    LE_ASSERT(CountStored("_") == 2);
+    LE_ASSERT(StatFile("app1", "lib/libfoo.so").st_nlink == 3);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that different files are not linked together, and that files with the same key are stored
+ * with suffixes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestDifferent
+(
+    void
+)
+{
+    char name[NAME_MAX + 1];
+    char collidingName[NAME_MAX + 1];
+
+    LE_INFO("======== Different files ========");
+
+    // Same contents, different permissions.
+    WriteFile("app3", "lib/libfoo.so", LibData, FILE_BYTES, 0755);
+
+    // Same CRC32 and size (so same key) as app1's library, but different contents.
+    WriteFile("app3", "lib/libcrc.so", CollidingData, FILE_BYTES, 0644);
+    AddApp("app3", "_");
+
+    LE_ASSERT(CountStored("_") == 4);
+    LE_ASSERT(!IsSameFile("app1", "lib/libfoo.so", "app3", "lib/libfoo.so"));
+    LE_ASSERT(!IsSameFile("app1", "lib/libfoo.so", "app3", "lib/libcrc.so"));
+    CheckFile("app3", "lib/libfoo.so", LibData, 0755);
+    CheckFile("app3", "lib/libcrc.so", CollidingData, 0644);
+
+    // The colliding file is stored under the library's key, with a suffix.
+    LE_ASSERT(FindStored("_", "app1", "lib/libfoo.so", name) != NULL);
+    LE_ASSERT(FindStored("_", "app3", "lib/libcrc.so", collidingName) != NULL);
+    LE_ASSERT(strncmp(collidingName, name, strlen(name)) == 0);
+    LE_ASSERT(strcmp(collidingName + strlen(name), ".1") == 0);
+
+    // Both files with that key are found: the one with the suffix too.
+    WriteFile("app4", "lib/libfoo.so", LibData, FILE_BYTES, 0644);
+    WriteFile("app4", "lib/libcrc.so", CollidingData, FILE_BYTES, 0644);
+    AddApp("app4", "_");
+
+    LE_ASSERT(CountStored("_") == 4);
+    LE_ASSERT(IsSameFile("app1", "lib/libfoo.so", "app4", "lib/libfoo.so"));
+    LE_ASSERT(IsSameFile("app3", "lib/libcrc.so", "app4", "lib/libcrc.so"));
+    CheckFile("app4", "lib/libcrc.so", CollidingData, 0644);
+
+    // Another namespace (another SMACK label) gets its own copy.
+    WriteFile("app5", "lib/libfoo.so", LibData, FILE_BYTES, 0644);
+    AddApp("app5", "app.app5");
+
+    LE_ASSERT(CountStored("app.app5") == 1);
+    LE_ASSERT(!IsSameFile("app1", "lib/libfoo.so", "app5", "lib/libfoo.so"));
+
+    // Same contents and permissions, different owner (only root can give files away).
+    if (geteuid() == 0)
+    {
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        WriteFile("app6", "lib/libuid.so", LibData, FILE_BYTES, 0644);
+        LE_ASSERT(chown(AppPath("app6", "lib/libuid.so", path), 1, -1) == 0);
+        WriteFile("app6", "lib/libgid.so", LibData, FILE_BYTES, 0644);
+        LE_ASSERT(chown(AppPath("app6", "lib/libgid.so", path), -1, 1) == 0);
+        AddApp("app6", "_");
+
+        LE_ASSERT(CountStored("_") == 6);
+        LE_ASSERT(!IsSameFile("app1", "lib/libfoo.so", "app6", "lib/libuid.so"));
+        LE_ASSERT(!IsSameFile("app1", "lib/libfoo.so", "app6", "lib/libgid.so"));
+        LE_ASSERT(!IsSameFile("app6", "lib/libuid.so", "app6", "lib/libgid.so"));
+        RemoveApp("app6");
+    }
+    else
+    {
+        LE_INFO("Not root: files of other owners not tested.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that only the stored files that are not used any more are removed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRemoveUnused
+(
+    void
+)
+{
+    char name[NAME_MAX + 1];
+
+    LE_INFO("======== Unused files ========");
+
+    // app6's files (if any) are only linked from the store.
+    fileStore_RemoveUnused();
+    LE_ASSERT(CountStored("_") == 4);
+
+    // The executable was only used by app1 and app2, the library is still used by app4.
+    RemoveApp("app1");
+    fileStore_RemoveUnused();
+    LE_ASSERT(CountStored("_") == 4);
+    RemoveApp("app2");
+    fileStore_RemoveUnused();
+    LE_ASSERT(CountStored("_") == 3);
+    LE_ASSERT(FindStored("_", "app4", "lib/libfoo.so", name) != NULL);
+    LE_ASSERT(FindStored("_", "app4", "lib/libcrc.so", name) != NULL);
+    CheckFile("app4", "lib/libfoo.so", LibData, 0644);
+
+    // The namespaces are removed with their last files.
+    RemoveApp("app3");
+    RemoveApp("app4");
+    RemoveApp("app5");
+    fileStore_RemoveUnused();
+    LE_ASSERT(CountStored("_") == -1);
+    LE_ASSERT(CountStored("app.app5") == -1);
+    LE_ASSERT(le_dir_IsDir(FILESTORE_PATH));
+}
+
+
+COMPONENT_INIT
+{
+    LE_ASSERT(mkdtemp(TestDir) != NULL);
+    (void)le_dir_RemoveRecursive(FILESTORE_PATH);
+
+    MakeData();
+
+    TestIdentical();
+    TestDifferent();
+    TestRemoveUnused();
+
+    LE_ASSERT(le_dir_RemoveRecursive(FILESTORE_PATH) == LE_OK);
+    LE_ASSERT(le_dir_RemoveRecursive(TestDir) == LE_OK);
+
+    LE_INFO("======== File store tests passed ========");
+    exit(EXIT_SUCCESS);
+}
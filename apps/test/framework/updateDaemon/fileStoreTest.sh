@@ -0,0 +1,101 @@
+#!/bin/bash
+
+# On-target test of the Update Daemon's file store:
+#  - two versions of an app bundling the same file share it while both are installed,
+#  - the file is kept in the store while one of them is installed, and removed from it by
+#    system_RemoveUnusedApps() once no app uses it any more.
+
+LoadTestLib
+
+targetAddr=$1
+targetType=${2:-ar7}
+
+app=fileStoreApp
+dataFile=read-only/fileStoreData.bin
+
+OnFail() {
+    echo "File Store Test Failed!"
+}
+
+OnExit() {
+    ssh root@$targetAddr "$BIN_PATH/app remove $app" > /dev/null 2>&1
+    rm -rf "$buildDir"
+}
+
+# Run a command on the target, and print its output.
+OnTarget() {
+    ssh root@$targetAddr "$1"
+}
+
+# Mark the current system good, which removes the other systems and the apps they used.
+MarkGood() {
+    OnTarget "$BIN_PATH/update --force --mark-good"
+    CheckRet
+}
+
+# Check that a number is as expected.
+CheckEqual() {
+    if [ "$2" != "$3" ]
+    then
+        echo "$1: '$2', expected '$3'"
+        exit 1
+    fi
+}
+
+scriptDir=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+buildDir=$(mktemp -d)
+
+echo "******** File Store Test Starting ***********"
+
+echo "Build two versions of $app, bundling the same file."
+cd "$buildDir"
+CheckRet
+cp "$scriptDir/$app.adef" .
+head -c 16384 /dev/urandom > fileStoreData.bin
+for version in 1 2
+do
+    mkapp $app.adef -t $targetType -a .$version
+    CheckRet
+    mv $app.$targetType.update ${app}${version}.$targetType.update
+done
+
+echo "Make sure Legato is running."
+OnTarget "$BIN_PATH/legato start"
+CheckRet
+
+echo "Install the first version."
+cat ${app}1.$targetType.update | OnTarget "$BIN_PATH/update"
+CheckRet
+MarkGood
+v1Dir=$(OnTarget "readlink -f /legato/systems/current/apps/$app")
+storedFile=$(OnTarget "find /legato/fileStore -samefile $v1Dir/$dataFile")
+CheckEqual "Stored file" "$(echo "$storedFile" | wc -w)" 1
+
+echo "Install the second version: its file is linked to the first version's."
+cat ${app}2.$targetType.update | OnTarget "$BIN_PATH/update"
+CheckRet
+v2Dir=$(OnTarget "readlink -f /legato/systems/current/apps/$app")
+if [ "$v1Dir" == "$v2Dir" ]
+then
+    echo "Both versions are installed in $v1Dir"
+    exit 1
+fi
+CheckEqual "Links" "$(OnTarget "stat -c %h $v2Dir/$dataFile")" 3
+CheckEqual "Stored file" "$(OnTarget "find /legato/fileStore -samefile $v2Dir/$dataFile")" \
+           "$storedFile"
+
+echo "Remove the previous system: the stored file is still used by the second version."
+MarkGood
+OnTarget "test ! -e $v1Dir"
+CheckRet
+CheckEqual "Links" "$(OnTarget "stat -c %h $v2Dir/$dataFile")" 2
+
+echo "Remove the app: the stored file isn't used any more."
+OnTarget "$BIN_PATH/app remove $app"
+CheckRet
+MarkGood
+OnTarget "test ! -e $v2Dir && test ! -e $storedFile"
+CheckRet
+
+echo "File Store Test Passed!"
+exit 0
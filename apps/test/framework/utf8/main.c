@@ -311,6 +311,101 @@ static void TestEncodeDecodeCodePoint(void)
 }
 
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the word-at-a-time handling of ASCII characters, with a multi-byte or an invalid character
+ * at every position of strings of various lengths and alignments.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestAsciiRuns(void)
+{
+    char buffer[64];
+    char destBuffer[64];
+    size_t offset;
+    size_t len;
+    size_t pos;
+    size_t destSize;
+    size_t numBytes;
+
+    for (offset = 0; offset < 8; offset++)
+    {
+        char* str = buffer + offset;
+
+        for (len = 0; len < 40; len++)
+        {
+            // All ASCII.
+            memset(str, 'x', len);
+            str[len] = '\0';
+            LE_ASSERT(le_utf8_NumChars(str) == (ssize_t)len);
+            LE_ASSERT(le_utf8_IsFormatCorrect(str));
+
+            for (destSize = 1; destSize < len + 3; destSize++)
+            {
+                size_t expected = (len < destSize) ? len : destSize - 1;
+
+                memset(destBuffer, '#', sizeof(destBuffer));
+                LE_ASSERT(le_utf8_Copy(destBuffer, str, destSize, &numBytes) ==
+                          ((len < destSize) ? LE_OK : LE_OVERFLOW));
+                LE_ASSERT(numBytes == expected);
+                LE_ASSERT(memcmp(destBuffer, str, expected) == 0);
+                LE_ASSERT(destBuffer[expected] == '\0');
+                LE_ASSERT(destBuffer[expected + 1] == '#');
+            }
+
+            for (pos = 0; pos + 3 <= len; pos++)
+            {
+                // A three-byte character at pos.
+                memset(str, 'x', len);
+                str[pos] = (char)THREE_CHAR_BYTE;
+                str[pos + 1] = (char)CONT_BYTE;
+                str[pos + 2] = (char)CONT_BYTE;
+                LE_ASSERT(le_utf8_NumChars(str) == (ssize_t)len - 2);
+                LE_ASSERT(le_utf8_IsFormatCorrect(str));
+                LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, str, len, sizeof(destBuffer))
+                          == LE_OK);
+                LE_ASSERT(strcmp(destBuffer, str) == 0);
+
+                // Copy must not split the character.
+                destSize = pos + 3;
+                LE_ASSERT(le_utf8_Copy(destBuffer, str, destSize, &numBytes) == LE_OVERFLOW);
+                LE_ASSERT(numBytes == pos);
+
+                // A missing continuation byte.
+                str[pos + 2] = 'x';
+                LE_ASSERT(le_utf8_NumChars(str) == LE_FORMAT_ERROR);
+                LE_ASSERT(!le_utf8_IsFormatCorrect(str));
+                LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, str, len, sizeof(destBuffer))
+                          == LE_FORMAT_ERROR);
+                LE_ASSERT(destBuffer[0] == '\0');
+
+                // An invalid lead byte.
+                str[pos] = (char)INVALID_BYTE;
+                LE_ASSERT(le_utf8_NumChars(str) == LE_FORMAT_ERROR);
+                LE_ASSERT(!le_utf8_IsFormatCorrect(str));
+                LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, str, len, sizeof(destBuffer))
+                          == LE_FORMAT_ERROR);
+
+                // A null-character, which only le_utf8_ValidateAndCopy() sees.
+                memset(str, 'x', len);
+                str[pos] = '\0';
+                LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, str, len, sizeof(destBuffer))
+                          == LE_FORMAT_ERROR);
+            }
+        }
+    }
+
+    // A character cut at the end of the source, and a destination that is too small.
+    LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, "ab\xE0\x80", 4, sizeof(destBuffer))
+              == LE_FORMAT_ERROR);
+    LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, "abcd", 4, 4) == LE_OVERFLOW);
+    LE_ASSERT(destBuffer[0] == '\0');
+    LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, "abcd", 4, 5) == LE_OK);
+    LE_ASSERT(strcmp(destBuffer, "abcd") == 0);
+    LE_ASSERT(le_utf8_ValidateAndCopy(destBuffer, NULL, 0, 1) == LE_OK);
+    LE_ASSERT(destBuffer[0] == '\0');
+}
+
 COMPONENT_INIT
 {
     size_t numBytesCopied;
@@ -632,6 +727,10 @@ COMPONENT_INIT
 
     printf("Copy Up To Substring correct.\n");
 
+    TestAsciiRuns();
+
+    printf("ASCII runs and validated copy correct.\n");
+
     TestIntParsing();
 
     printf("Int parsing correct.\n");
@@ -0,0 +1,282 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * UTF-8 string handling benchmark.
+ *
+ * Measures le_utf8_NumChars(), le_utf8_IsFormatCorrect(), le_utf8_Copy() and
+ * le_utf8_ValidateAndCopy() on typical payloads (short names, paths, AT responses, SMS text in
+ * English, French and Chinese) and compares them with a byte-at-a-time check followed by a copy,
+ * which is what these functions used to do.
+ *
+ * Usage: utf8Bench [iterations]
+ *
+ *      iterations      Number of times each payload is processed by each function
+ *                      (default 200000).
+ *
+ * The test passes if all the functions give the same results as the byte-at-a-time reference.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the destination buffers.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEST_BYTES  1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Payload.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;
+    char text[DEST_BYTES];
+}
+Payload_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Payloads, filled by InitPayloads().
+ */
+//--------------------------------------------------------------------------------------------------
+static Payload_t Payloads[] =
+{
+    { "name", "" },
+    { "path", "" },
+    { "AT response", "" },
+    { "SMS English", "" },
+    { "SMS French", "" },
+    { "SMS Chinese", "" },
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destination buffer.  Global so that the copies are not optimized out.
+ */
+//--------------------------------------------------------------------------------------------------
+char DestBuffer[DEST_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Repeat a string to fill a payload up to a given length (in bytes, without cutting a character).
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillPayload
+(
+    Payload_t* payloadPtr,
+    const char* patternPtr,
+    size_t maxBytes
+)
+{
+    payloadPtr->text[0] = '\0';
+
+    while (strlen(payloadPtr->text) + strlen(patternPtr) <= maxBytes)
+    {
+        strcat(payloadPtr->text, patternPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill the payloads.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitPayloads
+(
+    void
+)
+{
+    FillPayload(&Payloads[0], "modemService", 32);
+    FillPayload(&Payloads[1], "/legato/systems/current/apps/", 100);
+    FillPayload(&Payloads[2], "+CREG: 2,1,\"0A1B\",\"01C2D3E4\",7\r\n", 160);
+    FillPayload(&Payloads[3], "Your verification code is 123456. ", 160);
+    FillPayload(&Payloads[4], "D\xC3\xA9j\xC3\xA0 re\xC3\xA7u, merci! ", 160);
+    FillPayload(&Payloads[5], "\xE4\xBD\xA0\xE5\xA5\xBD\xEF\xBC\x8C\xE4\xB8\x96\xE7\x95\x8C", 210);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference: check a string's format one byte at a time.
+ *
+ * @return Number of characters, or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t RefNumChars
+(
+    const char* strPtr
+)
+{
+    size_t numChars = 0;
+    size_t i = 0;
+
+    while (strPtr[i] != '\0')
+    {
+        size_t numBytes = le_utf8_NumBytesInChar(strPtr[i]);
+        size_t j;
+
+        if (numBytes == 0)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        for (j = 1; j < numBytes; j++)
+        {
+            if (!le_utf8_IsContinuationByte(strPtr[++i]))
+            {
+                return LE_FORMAT_ERROR;
+            }
+        }
+
+        numChars++;
+        i++;
+    }
+
+    return numChars;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowNs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000000) + ((uint64_t)now.usec * 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the time taken by one function on one payload.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const char* functionPtr,
+    uint64_t startNs,
+    size_t iterations,
+    size_t bytes
+)
+{
+    uint64_t elapsedNs = GetNowNs() - startNs;
+
+    LE_INFO("    %-24s %7.1f ns/call %8.1f MiB/s", functionPtr,
+            (double)elapsedNs / iterations,
+            ((double)bytes * iterations * 1000000000.0) / (elapsedNs * 1024.0 * 1024.0));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure all the functions on one payload, and check their results.
+ *
+ * @return true if all the results were correct.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RunPayload
+(
+    const Payload_t* payloadPtr,
+    size_t iterations
+)
+{
+    const char* textPtr = payloadPtr->text;
+    size_t bytes = strlen(textPtr);
+    ssize_t refChars = RefNumChars(textPtr);
+    bool isOk = true;
+    uint64_t start;
+    size_t i;
+
+    LE_INFO("%s: %zu bytes, %zd characters", payloadPtr->name, bytes, refChars);
+
+    start = GetNowNs();
+    for (i = 0; i < iterations; i++)
+    {
+        if (RefNumChars(textPtr) >= 0)
+        {
+            memcpy(DestBuffer, textPtr, bytes + 1);
+        }
+    }
+    Report("reference check + copy", start, iterations, bytes);
+
+    start = GetNowNs();
+    for (i = 0; i < iterations; i++)
+    {
+        isOk = (le_utf8_NumChars(textPtr) == refChars) && isOk;
+    }
+    Report("le_utf8_NumChars", start, iterations, bytes);
+
+    start = GetNowNs();
+    for (i = 0; i < iterations; i++)
+    {
+        isOk = le_utf8_IsFormatCorrect(textPtr) && isOk;
+    }
+    Report("le_utf8_IsFormatCorrect", start, iterations, bytes);
+
+    start = GetNowNs();
+    for (i = 0; i < iterations; i++)
+    {
+        isOk = (le_utf8_Copy(DestBuffer, textPtr, sizeof(DestBuffer), NULL) == LE_OK) && isOk;
+    }
+    Report("le_utf8_Copy", start, iterations, bytes);
+    isOk = (strcmp(DestBuffer, textPtr) == 0) && isOk;
+
+    start = GetNowNs();
+    for (i = 0; i < iterations; i++)
+    {
+        isOk = (le_utf8_ValidateAndCopy(DestBuffer, textPtr, bytes, sizeof(DestBuffer)) == LE_OK)
+               && isOk;
+    }
+    Report("le_utf8_ValidateAndCopy", start, iterations, bytes);
+    isOk = (strcmp(DestBuffer, textPtr) == 0) && isOk;
+
+    if (!isOk)
+    {
+        LE_ERROR("Wrong result for payload '%s'.", payloadPtr->name);
+    }
+
+    return isOk;
+}
+
+
+COMPONENT_INIT
+{
+    const char* argPtr = le_arg_GetArg(0);
+    size_t iterations = (argPtr != NULL) ? strtoul(argPtr, NULL, 10) : 200000;
+    int failures = 0;
+    size_t i;
+
+    LE_ASSERT(iterations > 0);
+
+    InitPayloads();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Payloads); i++)
+    {
+        if (!RunPayload(&Payloads[i], iterations))
+        {
+            failures++;
+        }
+    }
+
+    if (failures != 0)
+    {
+        LE_ERROR("FAIL: %d payloads gave wrong results.", failures);
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
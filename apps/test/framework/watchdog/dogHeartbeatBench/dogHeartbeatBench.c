@@ -0,0 +1,343 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Watchdog heartbeat benchmark.
+ *
+ * Starts a number of watched client processes that all kick their watchdog at the same interval,
+ * first with le_wdog_Kick(), then through their heartbeat page (see le_wdog_GetHeartbeat()), and
+ * compares the CPU time used by the watchdog daemon and by the clients in both cases.
+ *
+ * Usage: dogHeartbeatBench [clients [seconds [kickInterval]]]
+ *
+ *      clients         Number of watched client processes (default 500).
+ *      seconds         How long the clients kick for, in each mode (default 10).
+ *      kickInterval    Milliseconds between kicks (default 100).
+ *
+ * The clients are copies of this program, started with "--client <mode> <start> <seconds>
+ * <kickInterval>".  They all start kicking at the same time, so only the steady state is measured
+ * (not the cost of connecting to the watchdog service).
+ *
+ * The test passes if no client's watchdog expired.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "wdogHeartbeat.h"
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <dirent.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time allowed for each client process to start (ms).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CLIENT_START_TIME   20
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sleep until a given relative time (ms).
+ */
+//--------------------------------------------------------------------------------------------------
+static void SleepUntil
+(
+    uint64_t timeMs
+)
+{
+    uint64_t now;
+
+    while ((now = GetNowMs()) < timeMs)
+    {
+        usleep((timeMs - now) * 1000);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run as a watched client.  Exits with EXIT_FAILURE if the watchdog stopped watching the client.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunClient
+(
+    void
+)
+{
+    bool useHeartbeat = (strcmp(le_arg_GetArg(1), "heartbeat") == 0);
+    uint64_t start = GetArg(2, 0);
+    uint64_t end = start + (GetArg(3, 0) * 1000);
+    uint64_t kickInterval = GetArg(4, 100);
+    wdogHeartbeat_Page_t* heartbeatPtr = NULL;
+
+    if (useHeartbeat)
+    {
+        int fd;
+
+        LE_ASSERT(le_wdog_GetHeartbeat(&fd) == LE_OK);
+        heartbeatPtr = mmap(NULL, LE_WDOG_HEARTBEAT_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            fd, 0);
+        LE_ASSERT(heartbeatPtr != MAP_FAILED);
+        close(fd);
+    }
+
+    if (GetNowMs() > start)
+    {
+        LE_WARN("Client started late; increase CLIENT_START_TIME.");
+    }
+    SleepUntil(start);
+
+    uint64_t next;
+    for (next = start; next < end; next += kickInterval)
+    {
+        if (useHeartbeat)
+        {
+            if (!__atomic_load_n(&heartbeatPtr->isWatched, __ATOMIC_ACQUIRE))
+            {
+                LE_ERROR("Heartbeat page no longer watched.");
+                exit(EXIT_FAILURE);
+            }
+            __atomic_store_n(&heartbeatPtr->kickTime, GetNowMs(), __ATOMIC_RELEASE);
+        }
+        else
+        {
+            le_wdog_Kick();
+        }
+
+        SleepUntil(next + kickInterval);
+    }
+
+    le_wdog_Timeout(LE_WDOG_TIMEOUT_NEVER);
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the watchdog daemon's PID.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t FindWatchdogDaemon
+(
+    void
+)
+{
+    DIR* dirPtr = opendir("/proc");
+    struct dirent* entPtr;
+    pid_t pid = -1;
+
+    LE_ASSERT(dirPtr != NULL);
+
+    while ((pid < 0) && ((entPtr = readdir(dirPtr)) != NULL))
+    {
+        char path[64];
+        char comm[32] = "";
+        FILE* filePtr;
+
+        snprintf(path, sizeof(path), "/proc/%s/comm", entPtr->d_name);
+        filePtr = fopen(path, "r");
+        if (filePtr != NULL)
+        {
+            if ((fgets(comm, sizeof(comm), filePtr) != NULL) && (strcmp(comm, "watchdog\n") == 0))
+            {
+                pid = atoi(entPtr->d_name);
+            }
+            fclose(filePtr);
+        }
+    }
+
+    closedir(dirPtr);
+
+    return pid;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time (user + system) used by a process so far, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetProcessCpuMs
+(
+    pid_t pid
+)
+{
+    char path[64];
+    char buf[512];
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    FILE* filePtr;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    filePtr = fopen(path, "r");
+    LE_ASSERT(filePtr != NULL);
+    LE_ASSERT(fgets(buf, sizeof(buf), filePtr) != NULL);
+    fclose(filePtr);
+
+    // Skip the command name, which may contain spaces, then fields 3 to 13.
+    char* fieldPtr = strrchr(buf, ')');
+    LE_ASSERT(fieldPtr != NULL);
+    LE_ASSERT(sscanf(fieldPtr + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                     &utime, &stime) == 2);
+
+    return ((uint64_t)(utime + stime) * 1000) / sysconf(_SC_CLK_TCK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time used by the terminated children of this process so far, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetChildrenCpuMs
+(
+    void
+)
+{
+    struct rusage usage;
+
+    LE_ASSERT(getrusage(RUSAGE_CHILDREN, &usage) == 0);
+
+    return ((uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000) +
+           ((usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the clients in one mode and report the CPU time used.
+ *
+ * @return Number of clients that failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static int RunMode
+(
+    const char* modePtr,
+    pid_t daemonPid,
+    size_t clientCount,
+    uint64_t seconds,
+    uint64_t kickInterval
+)
+{
+    uint64_t start = GetNowMs() + 1000 + (clientCount * CLIENT_START_TIME);
+    char startStr[32];
+    char secondsStr[32];
+    char intervalStr[32];
+    size_t i;
+
+    snprintf(startStr, sizeof(startStr), "%" PRIu64, start);
+    snprintf(secondsStr, sizeof(secondsStr), "%" PRIu64, seconds);
+    snprintf(intervalStr, sizeof(intervalStr), "%" PRIu64, kickInterval);
+
+    for (i = 0; i < clientCount; i++)
+    {
+        pid_t pid = fork();
+
+        LE_ASSERT(pid >= 0);
+        if (pid == 0)
+        {
+            execl("/proc/self/exe", le_arg_GetProgramName(), "--client", modePtr, startStr,
+                  secondsStr, intervalStr, (char*)NULL);
+            _exit(EXIT_FAILURE);
+        }
+    }
+
+    SleepUntil(start);
+    uint64_t daemonCpu = GetProcessCpuMs(daemonPid);
+    uint64_t childrenCpu = GetChildrenCpuMs();
+
+    SleepUntil(start + (seconds * 1000));
+    daemonCpu = GetProcessCpuMs(daemonPid) - daemonCpu;
+
+    int failures = 0;
+    int status;
+    for (i = 0; i < clientCount; i++)
+    {
+        LE_ASSERT(wait(&status) > 0);
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+        {
+            failures++;
+        }
+    }
+    childrenCpu = GetChildrenCpuMs() - childrenCpu;
+
+    uint64_t kicks = clientCount * ((seconds * 1000) / kickInterval);
+
+    LE_INFO("%-9s: %zu clients, %" PRIu64 " kicks, watchdog daemon CPU %" PRIu64 " ms"
+            " (%.2f us/kick), clients CPU %" PRIu64 " ms (includes start up), %d failed",
+            modePtr, clientCount, kicks, daemonCpu, (daemonCpu * 1000.0) / kicks, childrenCpu,
+            failures);
+
+    return failures;
+}
+
+
+COMPONENT_INIT
+{
+    if ((le_arg_NumArgs() > 0) && (strcmp(le_arg_GetArg(0), "--client") == 0))
+    {
+        RunClient();
+    }
+
+    size_t clientCount = GetArg(0, 500);
+    uint64_t seconds = GetArg(1, 10);
+    uint64_t kickInterval = GetArg(2, 100);
+
+    LE_ASSERT((clientCount > 0) && (seconds > 0) && (kickInterval > 0));
+
+    pid_t daemonPid = FindWatchdogDaemon();
+    LE_FATAL_IF(daemonPid < 0, "Watchdog daemon not found.");
+
+    // Don't let this process's own watchdog get in the way.
+    le_wdog_Timeout(LE_WDOG_TIMEOUT_NEVER);
+
+    int failures = RunMode("kick", daemonPid, clientCount, seconds, kickInterval);
+    failures += RunMode("heartbeat", daemonPid, clientCount, seconds, kickInterval);
+
+    if (failures != 0)
+    {
+        LE_ERROR("FAIL: %d clients failed.", failures);
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
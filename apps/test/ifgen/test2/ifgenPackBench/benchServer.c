@@ -0,0 +1,324 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file benchServer.c
+ *
+ * Servers of example.api and packBench.api used by ifgenPackBench.  Both servers do the same
+ * thing; only the generated stubs they are built with differ.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "exNewSrv_server.h"
+#include "exOldSrv_server.h"
+#include "pbNewSrv_server.h"
+#include "pbOldSrv_server.h"
+#include "benchServer.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback called by TestCallback(), the same for both servers.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*CallbackFunc_t)
+(
+    uint32_t data,
+    const char* name,
+    const uint8_t* arrayPtr,
+    size_t arraySize,
+    int dataFile,
+    void* contextPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of allParameters().
+ */
+//--------------------------------------------------------------------------------------------------
+static void AllParameters
+(
+    common_EnumExample_t a,
+    uint32_t* bPtr,
+    const uint32_t* dataPtr,
+    size_t dataSize,
+    uint32_t* outputPtr,
+    size_t* outputSizePtr,
+    const char* label,
+    char* response,
+    size_t responseSize,
+    char* more,
+    size_t moreSize
+)
+{
+    uint32_t sum = a;
+    size_t i;
+
+    for (i = 0; i < dataSize; i++)
+    {
+        sum += dataPtr[i];
+    }
+    *bPtr = sum;
+
+    if (*outputSizePtr > dataSize)
+    {
+        *outputSizePtr = dataSize;
+    }
+    for (i = 0; i < *outputSizePtr; i++)
+    {
+        outputPtr[i] = (dataPtr[i] * 3) + a;
+    }
+
+    snprintf(response, responseSize, "%s: %" PRIu32, label, sum);
+    snprintf(more, moreSize, "%zu values", dataSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of TestCallback(): the callback is called right away.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t TestCallback
+(
+    uint32_t someParm,
+    const uint8_t* dataArrayPtr,
+    size_t dataArraySize,
+    CallbackFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    uint8_t array[16];
+    char name[50];
+    size_t i;
+
+    for (i = 0; i < sizeof(array); i++)
+    {
+        array[i] = dataArrayPtr[i % dataArraySize] + i;
+    }
+    snprintf(name, sizeof(name), "callback %" PRIu32, someParm);
+
+    handlerPtr(someParm ^ 0x5a5a5a5a, name, array, 1 + (someParm % sizeof(array)), -1, contextPtr);
+
+    return (int32_t)(someParm + dataArraySize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of SetFixed().
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t SetFixed
+(
+    common_OpaqueReferenceRef_t ref,
+    uint64_t u64,
+    uint32_t u32,
+    int16_t i16,
+    bool flag,
+    double real
+)
+{
+    return (uint32_t)(size_t)ref + (uint32_t)u64 + (uint32_t)(u64 >> 32) + u32 + i16 + flag +
+           (uint32_t)real;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of GetSamples().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetSamples
+(
+    uint32_t first,
+    int32_t* samplesPtr,
+    size_t* samplesSizePtr,
+    uint16_t* scalePtr
+)
+{
+    size_t i;
+
+    if (first == 0)
+    {
+        *samplesSizePtr = 0;
+        *scalePtr = 0;
+        return LE_OUT_OF_RANGE;
+    }
+
+    if (*samplesSizePtr > first)
+    {
+        *samplesSizePtr = first;
+    }
+    for (i = 0; i < *samplesSizePtr; i++)
+    {
+        samplesPtr[i] = (int32_t)(first * (i + 1)) * ((i & 1) ? -1 : 1);
+    }
+    *scalePtr = (uint16_t)first;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Define the server functions of both APIs, for the stubs generated with the name prefixes exNewSrv
+ * and pbNewSrv (layout New) or exOldSrv and pbOldSrv (layout Old).  The functions not used by the
+ * benchmark do nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFINE_SERVER(layout)                                                                      \
+    ex##layout##Srv_TestAHandlerRef_t ex##layout##Srv_AddTestAHandler                              \
+    (                                                                                              \
+        ex##layout##Srv_TestAHandlerFunc_t handlerPtr,                                             \
+        void* contextPtr                                                                           \
+    )                                                                                              \
+    {                                                                                              \
+        return NULL;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_RemoveTestAHandler                                                        \
+    (                                                                                              \
+        ex##layout##Srv_TestAHandlerRef_t handlerRef                                               \
+    )                                                                                              \
+    {                                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_allParameters                                                             \
+    (                                                                                              \
+        common_EnumExample_t a,                                                                    \
+        uint32_t* bPtr,                                                                            \
+        const uint32_t* dataPtr,                                                                   \
+        size_t dataSize,                                                                           \
+        uint32_t* outputPtr,                                                                       \
+        size_t* outputSizePtr,                                                                     \
+        const char* label,                                                                         \
+        char* response,                                                                            \
+        size_t responseSize,                                                                       \
+        char* more,                                                                                \
+        size_t moreSize                                                                            \
+    )                                                                                              \
+    {                                                                                              \
+        AllParameters(a, bPtr, dataPtr, dataSize, outputPtr, outputSizePtr, label,                 \
+                      response, responseSize, more, moreSize);                                     \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_FileTest                                                                  \
+    (                                                                                              \
+        int dataFile,                                                                              \
+        int* dataOutPtr                                                                            \
+    )                                                                                              \
+    {                                                                                              \
+        *dataOutPtr = dataFile;                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_TriggerTestA                                                              \
+    (                                                                                              \
+        void                                                                                       \
+    )                                                                                              \
+    {                                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    ex##layout##Srv_BugTestHandlerRef_t ex##layout##Srv_AddBugTestHandler                          \
+    (                                                                                              \
+        const char* newPathPtr,                                                                    \
+        ex##layout##Srv_BugTestHandlerFunc_t handlerPtr,                                           \
+        void* contextPtr                                                                           \
+    )                                                                                              \
+    {                                                                                              \
+        return NULL;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_RemoveBugTestHandler                                                      \
+    (                                                                                              \
+        ex##layout##Srv_BugTestHandlerRef_t handlerRef                                             \
+    )                                                                                              \
+    {                                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    int32_t ex##layout##Srv_TestCallback                                                           \
+    (                                                                                              \
+        uint32_t someParm,                                                                         \
+        const uint8_t* dataArrayPtr,                                                               \
+        size_t dataArraySize,                                                                      \
+        ex##layout##Srv_CallbackTestHandlerFunc_t handlerPtr,                                      \
+        void* contextPtr                                                                           \
+    )                                                                                              \
+    {                                                                                              \
+        return TestCallback(someParm, dataArrayPtr, dataArraySize, handlerPtr, contextPtr);        \
+    }                                                                                              \
+                                                                                                   \
+    void ex##layout##Srv_TriggerCallbackTest                                                       \
+    (                                                                                              \
+        uint32_t data                                                                              \
+    )                                                                                              \
+    {                                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    uint32_t pb##layout##Srv_SetFixed                                                              \
+    (                                                                                              \
+        common_OpaqueReferenceRef_t ref,                                                           \
+        uint64_t u64,                                                                              \
+        uint32_t u32,                                                                              \
+        int16_t i16,                                                                               \
+        bool flag,                                                                                 \
+        double real                                                                                \
+    )                                                                                              \
+    {                                                                                              \
+        return SetFixed(ref, u64, u32, i16, flag, real);                                           \
+    }                                                                                              \
+                                                                                                   \
+    le_result_t pb##layout##Srv_GetSamples                                                         \
+    (                                                                                              \
+        uint32_t first,                                                                            \
+        int32_t* samplesPtr,                                                                       \
+        size_t* samplesSizePtr,                                                                    \
+        uint16_t* scalePtr                                                                         \
+    )                                                                                              \
+    {                                                                                              \
+        return GetSamples(first, samplesPtr, samplesSizePtr, scalePtr);                            \
+    }
+
+DEFINE_SERVER(New)
+DEFINE_SERVER(Old)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Advertise the services of both servers.
+ */
+//--------------------------------------------------------------------------------------------------
+void benchServer_Start
+(
+    void
+)
+{
+    exNewSrv_AdvertiseService();
+    exOldSrv_AdvertiseService();
+    pbNewSrv_AdvertiseService();
+    pbOldSrv_AdvertiseService();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the server that gets the requests.
+ */
+//--------------------------------------------------------------------------------------------------
+void benchServer_Select
+(
+    bool isPerValue
+)
+{
+    if (isPerValue)
+    {
+        loopback_SelectService(exOldSrv_GetServiceRef());
+        loopback_SelectService(pbOldSrv_GetServiceRef());
+    }
+    else
+    {
+        loopback_SelectService(exNewSrv_GetServiceRef());
+        loopback_SelectService(pbNewSrv_GetServiceRef());
+    }
+}
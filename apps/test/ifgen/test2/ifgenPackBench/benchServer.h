@@ -0,0 +1,36 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file benchServer.h
+ *
+ * Servers of example.api and packBench.api used by ifgenPackBench: one built with the stubs that
+ * pack every value with its own le_pack call ("per-value" stubs) and one built with the stubs that
+ * pack fixed-size parameters at fixed offsets.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef BENCH_SERVER_H_INCLUDE_GUARD
+#define BENCH_SERVER_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Advertise the services of both servers.
+ */
+//--------------------------------------------------------------------------------------------------
+void benchServer_Start
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the server that gets the requests.
+ */
+//--------------------------------------------------------------------------------------------------
+void benchServer_Select
+(
+    bool isPerValue     ///< [IN] true for the server built with the per-value stubs.
+);
+
+#endif // BENCH_SERVER_H_INCLUDE_GUARD
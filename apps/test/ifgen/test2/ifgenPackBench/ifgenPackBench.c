@@ -0,0 +1,488 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Marshalling micro-benchmark for the code generated by ifgen.
+ *
+ * Calls functions of example.api and packBench.api through the client and server stubs generated
+ * by ifgen, both the way they used to be generated (one le_pack_Pack/Unpack call per value or
+ * array element, each checking the remaining buffer size, see ifgen's --pack-per-value option)
+ * and the way they are now (fixed offsets with one size check for each run of fixed-size
+ * parameters, and one copy for arrays of integers), and reports the time taken by each.
+ *
+ * The le_msg functions are replaced by an in-process loopback (see loopback.h), so the time
+ * reported is mostly that of the stubs.
+ *
+ * Both kinds of stubs must send the same bytes for every request, response and event (the wire
+ * format must not change), and each kind must understand the other's messages, otherwise the
+ * benchmark fails.
+ *
+ * Usage: ifgenPackBench [iterations]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "exNew_interface.h"
+#include "exOld_interface.h"
+#include "pbNew_interface.h"
+#include "pbOld_interface.h"
+#include "benchServer.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the message buffers (bigger than any message of example.api or packBench.api).
+ */
+//--------------------------------------------------------------------------------------------------
+#define BUFFER_BYTES    1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default number of times each function is called.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_ITERATIONS  100000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parameter values, generated from a seed so that the compiler can't optimize the loops away.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t value;
+    uint32_t enumValue;
+    uint32_t data[COMMON_TEN];
+    size_t dataSize;
+    uint8_t bytes[5];
+    size_t bytesSize;
+    char label[21];
+    void* refPtr;
+}
+Params_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function calling an API function through one kind of stubs, and returning a checksum of its
+ * results (or 0 if the call failed).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint32_t (*CallFunc_t)(const Params_t* paramsPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checksum of the values passed to the last TestCallback() callback, 0 if it wasn't called.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CallbackSum;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of times each function is called.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Iterations = DEFAULT_ITERATIONS;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill in parameter values from a seed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeParams
+(
+    uint32_t seed,
+    Params_t* paramsPtr
+)
+{
+    size_t i;
+
+    memset(paramsPtr, 0, sizeof(*paramsPtr));
+    paramsPtr->value = seed * 2654435761u;
+    paramsPtr->enumValue = (seed % 2) ? COMMON_ONE : COMMON_TWO;
+    paramsPtr->dataSize = 1 + (seed % COMMON_TEN);
+    for (i = 0; i < paramsPtr->dataSize; i++)
+    {
+        paramsPtr->data[i] = seed + i;
+    }
+    paramsPtr->bytesSize = 1 + (seed % sizeof(paramsPtr->bytes));
+    for (i = 0; i < paramsPtr->bytesSize; i++)
+    {
+        paramsPtr->bytes[i] = (uint8_t)(seed + i);
+    }
+    snprintf(paramsPtr->label, sizeof(paramsPtr->label), "label %" PRIu32, seed % 1000);
+    paramsPtr->refPtr = (void*)(size_t)((seed << 1) | 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a value to a checksum.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t Mix
+(
+    uint32_t sum,
+    uint32_t value
+)
+{
+    return (sum * 31) + value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a string to a checksum.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t MixString
+(
+    uint32_t sum,
+    const char* string
+)
+{
+    while (*string != '\0')
+    {
+        sum = Mix(sum, (uint8_t)*string++);
+    }
+
+    return sum;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback passed to TestCallback() (the same for both kinds of stubs).
+ */
+//--------------------------------------------------------------------------------------------------
+static void Callback
+(
+    uint32_t data,
+    const char* name,
+    const uint8_t* arrayPtr,
+    size_t arraySize,
+    int dataFile,
+    void* contextPtr
+)
+{
+    uint32_t sum = Mix(MixString(Mix((uint32_t)(size_t)contextPtr, data), name), dataFile);
+    size_t i;
+
+    for (i = 0; i < arraySize; i++)
+    {
+        sum = Mix(sum, arrayPtr[i]);
+    }
+
+    CallbackSum = sum | 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the functions queued to this thread (by the client stubs, to call callbacks).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServiceEvents
+(
+    void
+)
+{
+    while (le_event_ServiceLoop() == LE_OK)
+    {
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Define the functions calling the API functions through the stubs generated with the name
+ * prefixes exNew and pbNew (layout New) or exOld and pbOld (layout Old, per-value).
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFINE_CALLS(layout)                                                                       \
+    static uint32_t CallAllParameters##layout                                                      \
+    (                                                                                              \
+        const Params_t* paramsPtr                                                                  \
+    )                                                                                              \
+    {                                                                                              \
+        uint32_t b = 0;                                                                            \
+        uint32_t output[COMMON_TEN];                                                               \
+        size_t outputSize = NUM_ARRAY_MEMBERS(output);                                             \
+        char response[21];                                                                         \
+        char more[21];                                                                             \
+        size_t i;                                                                                  \
+                                                                                                   \
+        ex##layout##_allParameters(paramsPtr->enumValue, &b,                                       \
+                                        paramsPtr->data, paramsPtr->dataSize,                      \
+                                        output, &outputSize, paramsPtr->label,                     \
+                                        response, sizeof(response), more, sizeof(more));           \
+                                                                                                   \
+        uint32_t sum = MixString(MixString(Mix(b, outputSize), response), more);                   \
+        for (i = 0; i < outputSize; i++)                                                           \
+        {                                                                                          \
+            sum = Mix(sum, output[i]);                                                             \
+        }                                                                                          \
+        return sum;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static uint32_t CallTestCallback##layout                                                       \
+    (                                                                                              \
+        const Params_t* paramsPtr                                                                  \
+    )                                                                                              \
+    {                                                                                              \
+        CallbackSum = 0;                                                                           \
+                                                                                                   \
+        int32_t result = ex##layout##_TestCallback(paramsPtr->value,                               \
+                                                        paramsPtr->bytes, paramsPtr->bytesSize,    \
+                                                        Callback, paramsPtr->refPtr);              \
+        ServiceEvents();                                                                           \
+                                                                                                   \
+        return (CallbackSum != 0) ? Mix(CallbackSum, result) : 0;                                  \
+    }                                                                                              \
+                                                                                                   \
+    static uint32_t CallSetFixed##layout                                                           \
+    (                                                                                              \
+        const Params_t* paramsPtr                                                                  \
+    )                                                                                              \
+    {                                                                                              \
+        return pb##layout##_SetFixed(paramsPtr->refPtr, paramsPtr->value,                          \
+                                            paramsPtr->enumValue, -(int16_t)paramsPtr->dataSize,   \
+                                            paramsPtr->value & 1, paramsPtr->value / 3.0) | 1;     \
+    }                                                                                              \
+                                                                                                   \
+    static uint32_t CallGetSamples##layout                                                         \
+    (                                                                                              \
+        const Params_t* paramsPtr                                                                  \
+    )                                                                                              \
+    {                                                                                              \
+        int32_t samples[PBNEW_NUM_SAMPLES];                                                        \
+        size_t samplesSize = NUM_ARRAY_MEMBERS(samples);                                           \
+        uint16_t scale = 0;                                                                        \
+        size_t i;                                                                                  \
+                                                                                                   \
+        le_result_t result = pb##layout##_GetSamples(paramsPtr->value % 40,                        \
+                                                            samples, &samplesSize, &scale);        \
+                                                                                                   \
+        uint32_t sum = Mix(Mix(Mix(1, result), samplesSize), scale);                               \
+        for (i = 0; (result == LE_OK) && (i < samplesSize); i++)                                   \
+        {                                                                                          \
+            sum = Mix(sum, samples[i]);                                                            \
+        }                                                                                          \
+        return sum;                                                                                \
+    }
+
+DEFINE_CALLS(New)
+DEFINE_CALLS(Old)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Functions benchmarked.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    const char* namePtr;
+    CallFunc_t callOld;
+    CallFunc_t callNew;
+}
+Calls[] =
+{
+    { "allParameters", CallAllParametersOld, CallAllParametersNew },
+    { "TestCallback", CallTestCallbackOld, CallTestCallbackNew },
+    { "SetFixed", CallSetFixedOld, CallSetFixedNew },
+    { "GetSamples", CallGetSamplesOld, CallGetSamplesNew },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowNs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000000) + ((uint64_t)now.usec * 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that both kinds of stubs send the same bytes for a call, get the same results, and
+ * understand each other.
+ *
+ * @return true if they do.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckCall
+(
+    size_t index,
+    uint32_t seed
+)
+{
+    static const char* const KindNames[LOOPBACK_NUM_KINDS] = { "request", "response", "event" };
+    static uint8_t oldBytes[LOOPBACK_NUM_KINDS][BUFFER_BYTES];
+    static uint8_t newBytes[BUFFER_BYTES];
+    size_t oldSizes[LOOPBACK_NUM_KINDS];
+    Params_t params;
+    loopback_Kind_t kind;
+    bool isOk = true;
+
+    MakeParams(seed, &params);
+
+    loopback_KeepMessages(true);
+
+    benchServer_Select(true);
+    uint32_t oldSum = Calls[index].callOld(&params);
+    for (kind = 0; kind < LOOPBACK_NUM_KINDS; kind++)
+    {
+        oldSizes[kind] = loopback_TakeMessage(kind, oldBytes[kind], BUFFER_BYTES);
+    }
+
+    benchServer_Select(false);
+    uint32_t newSum = Calls[index].callNew(&params);
+    for (kind = 0; kind < LOOPBACK_NUM_KINDS; kind++)
+    {
+        size_t newSize = loopback_TakeMessage(kind, newBytes, BUFFER_BYTES);
+
+        if ((newSize != oldSizes[kind]) || (memcmp(newBytes, oldBytes[kind], newSize) != 0))
+        {
+            LE_ERROR("%s: %s messages differ (seed %" PRIu32 ").",
+                     Calls[index].namePtr, KindNames[kind], seed);
+            isOk = false;
+        }
+    }
+
+    loopback_KeepMessages(false);
+
+    if ((oldSizes[LOOPBACK_REQUEST] == 0) || (oldSizes[LOOPBACK_RESPONSE] == 0))
+    {
+        LE_ERROR("%s: no messages passed.", Calls[index].namePtr);
+        isOk = false;
+    }
+
+    if ((oldSum == 0) || (oldSum != newSum))
+    {
+        LE_ERROR("%s: results differ (seed %" PRIu32 ").", Calls[index].namePtr, seed);
+        isOk = false;
+    }
+
+    // Each kind of client stub must work with the other kind of server stub.
+    if (Calls[index].callOld(&params) != oldSum)
+    {
+        LE_ERROR("%s: per-value client doesn't work with the new server (seed %" PRIu32 ").",
+                 Calls[index].namePtr, seed);
+        isOk = false;
+    }
+    benchServer_Select(true);
+    if (Calls[index].callNew(&params) != oldSum)
+    {
+        LE_ERROR("%s: new client doesn't work with the per-value server (seed %" PRIu32 ").",
+                 Calls[index].namePtr, seed);
+        isOk = false;
+    }
+
+    return isOk;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time calls through one kind of stubs.
+ *
+ * @return The time taken, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t TimeCalls
+(
+    CallFunc_t callFunc,
+    bool isPerValue,
+    uint32_t* sumPtr
+)
+{
+    Params_t params;
+    uint32_t sum = 0;
+    size_t i;
+
+    MakeParams(1234, &params);
+    benchServer_Select(isPerValue);
+
+    uint64_t start = GetNowNs();
+    for (i = 0; i < Iterations; i++)
+    {
+        params.value = i;
+        sum += callFunc(&params);
+    }
+
+    *sumPtr += sum;
+
+    return GetNowNs() - start;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread running the benchmark.  The servers and the clients run in this thread, which doesn't run
+ * its event loop (it is serviced by ServiceEvents() instead).
+ */
+//--------------------------------------------------------------------------------------------------
+static void* BenchThread
+(
+    void* contextPtr
+)
+{
+    uint32_t sum = 0;
+    size_t i;
+    uint32_t seed;
+
+    benchServer_Start();
+    exNew_ConnectService();
+    exOld_ConnectService();
+    pbNew_ConnectService();
+    pbOld_ConnectService();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Calls); i++)
+    {
+        for (seed = 1; seed <= 1000; seed++)
+        {
+            if (!CheckCall(i, seed))
+            {
+                LE_ERROR("FAIL");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Calls); i++)
+    {
+        uint64_t oldNs = TimeCalls(Calls[i].callOld, true, &sum);
+        uint64_t newNs = TimeCalls(Calls[i].callNew, false, &sum);
+
+        LE_INFO("%-14s: %6.1f -> %6.1f ns per call",
+                Calls[i].namePtr, (double)oldNs / Iterations, (double)newNs / Iterations);
+    }
+
+    LE_DEBUG("Checksum %" PRIu32, sum);
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+
+    return NULL;
+}
+
+
+COMPONENT_INIT
+{
+    const char* argPtr = le_arg_GetArg(0);
+
+    if (argPtr != NULL)
+    {
+        Iterations = strtoul(argPtr, NULL, 10);
+    }
+    LE_ASSERT(Iterations > 0);
+
+    le_thread_Start(le_thread_Create("PackBench", BenchThread, NULL));
+}
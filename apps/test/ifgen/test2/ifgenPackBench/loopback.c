@@ -0,0 +1,718 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file loopback.c
+ *
+ * In-process replacement for the le_msg functions used by the code generated by ifgen.  See
+ * loopback.h.
+ *
+ * Messages are passed the way the messaging sockets pass them: only the bytes in use are sent, and
+ * the receiver gets a new message whose buffer is as big as the largest message with the same ID
+ * (the rest of it being zeroed).  Everything runs in the calling thread.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "loopback.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum numbers of protocols and services.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PROTOCOLS   4
+#define MAX_SERVICES    8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum sizes of protocol IDs and service names (including the null terminators).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ID_BYTES    128
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest message payload supported.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PAYLOAD_BYTES   1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Protocol.
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_msg_Protocol
+{
+    char id[MAX_ID_BYTES];              ///< Protocol ID.
+    size_t largestMsgSize;              ///< Size of the largest message in the protocol.
+    const size_t* msgSizesPtr;          ///< Largest payload size for each message ID, or NULL.
+    size_t msgCount;                    ///< Number of message IDs in msgSizesPtr.
+    le_msg_ServiceRef_t serviceRef;     ///< Service getting the requests, or NULL.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Service.
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_msg_Service
+{
+    le_msg_ProtocolRef_t protocolRef;   ///< Protocol used.
+    char name[MAX_ID_BYTES];            ///< Service name.
+    le_msg_ReceiveHandler_t recvHandler;///< Handler of the requests.
+    void* recvContextPtr;               ///< Context pointer passed to recvHandler.
+    bool isAdvertised;                  ///< true once le_msg_AdvertiseService() has been called.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Session (shared by the client and the server).
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_msg_Session
+{
+    le_msg_ProtocolRef_t protocolRef;   ///< Protocol used.
+    char name[MAX_ID_BYTES];            ///< Name of the service used.
+    le_msg_ReceiveHandler_t recvHandler;///< Handler of the events sent to the client.
+    void* recvContextPtr;               ///< Context pointer passed to recvHandler.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message.
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_msg_Message
+{
+    le_msg_SessionRef_t sessionRef;     ///< Session the message belongs to.
+    size_t payloadSize;                 ///< Size of the payload buffer.
+    size_t usedSize;                    ///< Number of bytes of the payload to send.
+    int fd;                             ///< File descriptor sent with the message, or -1.
+    uint8_t payload[MAX_PAYLOAD_BYTES]; ///< Payload buffer.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Bytes of the last message of each kind passed, if they are kept.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t size;                        ///< Number of bytes, 0 if none.
+    uint8_t bytes[MAX_PAYLOAD_BYTES];   ///< The bytes.
+}
+KeptMessage_t;
+
+static KeptMessage_t KeptMessages[LOOPBACK_NUM_KINDS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if the bytes of the messages passed are kept.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsKeeping;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Protocols and services.
+ */
+//--------------------------------------------------------------------------------------------------
+static struct le_msg_Protocol Protocols[MAX_PROTOCOLS];
+static size_t ProtocolCount;
+static struct le_msg_Service Services[MAX_SERVICES];
+static size_t ServiceCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pools of sessions and messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SessionPool;
+static le_mem_PoolRef_t MessagePool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Response to the request being served, once the server has sent it.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_MessageRef_t ResponseRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a message, with its payload zeroed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_MessageRef_t AllocMessage
+(
+    le_msg_SessionRef_t sessionRef,
+    size_t payloadSize
+)
+{
+    LE_FATAL_IF(payloadSize > MAX_PAYLOAD_BYTES,
+                "Message payload of %zu bytes is too big.", payloadSize);
+
+    le_msg_MessageRef_t msgRef = le_mem_ForceAlloc(MessagePool);
+
+    msgRef->sessionRef = sessionRef;
+    msgRef->payloadSize = payloadSize;
+    msgRef->usedSize = payloadSize;
+    msgRef->fd = -1;
+    memset(msgRef->payload, 0, payloadSize);
+
+    return msgRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pass a message to the other end of its session: the message is released, and a new message,
+ * sized like the receiver's would be, is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_MessageRef_t Pass
+(
+    le_msg_MessageRef_t msgRef,
+    loopback_Kind_t kind
+)
+{
+    le_msg_ProtocolRef_t protocolRef = msgRef->sessionRef->protocolRef;
+    size_t payloadSize = protocolRef->largestMsgSize;
+    uint32_t msgId;
+
+    memcpy(&msgId, msgRef->payload, sizeof(msgId));
+    if ((protocolRef->msgSizesPtr != NULL) && (msgId < protocolRef->msgCount))
+    {
+        payloadSize = protocolRef->msgSizesPtr[msgId];
+    }
+    if (payloadSize < msgRef->usedSize)
+    {
+        payloadSize = msgRef->usedSize;
+    }
+
+    le_msg_MessageRef_t newMsgRef = AllocMessage(msgRef->sessionRef, payloadSize);
+
+    memcpy(newMsgRef->payload, msgRef->payload, msgRef->usedSize);
+    newMsgRef->fd = msgRef->fd;
+    msgRef->fd = -1;
+
+    if (IsKeeping)
+    {
+        KeptMessages[kind].size = msgRef->usedSize;
+        memcpy(KeptMessages[kind].bytes, msgRef->payload, msgRef->usedSize);
+    }
+
+    le_mem_Release(msgRef);
+
+    return newMsgRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a reference to a protocol, creating it if needed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ProtocolRef_t loopback_GetProtocolRef
+(
+    const char* protocolId,
+    size_t largestMsgSize
+)
+{
+    size_t i;
+
+    if (MessagePool == NULL)
+    {
+        SessionPool = le_mem_CreatePool("Loopback sessions", sizeof(struct le_msg_Session));
+        MessagePool = le_mem_CreatePool("Loopback messages", sizeof(struct le_msg_Message));
+    }
+
+    for (i = 0; i < ProtocolCount; i++)
+    {
+        if (strcmp(Protocols[i].id, protocolId) == 0)
+        {
+            LE_FATAL_IF(Protocols[i].largestMsgSize != largestMsgSize,
+                        "Protocol '%s' used with different message sizes (%zu and %zu).",
+                        protocolId, Protocols[i].largestMsgSize, largestMsgSize);
+            return &Protocols[i];
+        }
+    }
+
+    LE_ASSERT(ProtocolCount < MAX_PROTOCOLS);
+    le_msg_ProtocolRef_t protocolRef = &Protocols[ProtocolCount++];
+
+    LE_ASSERT(le_utf8_Copy(protocolRef->id, protocolId, sizeof(protocolRef->id), NULL) == LE_OK);
+    protocolRef->largestMsgSize = largestMsgSize;
+
+    return protocolRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the largest payload size of each message of a protocol.  All the stubs using the protocol
+ * must agree.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetProtocolMsgSizes
+(
+    le_msg_ProtocolRef_t protocolRef,
+    const size_t* msgSizesPtr,
+    size_t msgCount
+)
+{
+    if (protocolRef->msgSizesPtr == NULL)
+    {
+        protocolRef->msgSizesPtr = msgSizesPtr;
+        protocolRef->msgCount = msgCount;
+    }
+    else
+    {
+        LE_FATAL_IF((protocolRef->msgCount != msgCount) ||
+                    (memcmp(protocolRef->msgSizesPtr, msgSizesPtr,
+                            msgCount * sizeof(*msgSizesPtr)) != 0),
+                    "Protocol '%s' used with different message sizes.", protocolRef->id);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a client session.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t loopback_CreateSession
+(
+    le_msg_ProtocolRef_t protocolRef,
+    const char* interfaceName
+)
+{
+    le_msg_SessionRef_t sessionRef = le_mem_ForceAlloc(SessionPool);
+
+    memset(sessionRef, 0, sizeof(*sessionRef));
+    sessionRef->protocolRef = protocolRef;
+    LE_ASSERT(le_utf8_Copy(sessionRef->name, interfaceName, sizeof(sessionRef->name), NULL)
+              == LE_OK);
+
+    return sessionRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the handler of the events sent to a client session.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetSessionRecvHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    le_msg_ReceiveHandler_t handlerFunc,
+    void* contextPtr
+)
+{
+    sessionRef->recvHandler = handlerFunc;
+    sessionRef->recvContextPtr = contextPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the close handler of a session (sessions are never closed by the other end here).
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetSessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    le_msg_SessionEventHandler_t handlerFunc,
+    void* contextPtr
+)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a session.
+ *
+ * @return LE_OK, or LE_UNAVAILABLE if no service with the session's protocol and name has been
+ *         advertised.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t loopback_TryOpenSessionSync
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    size_t i;
+
+    for (i = 0; i < ServiceCount; i++)
+    {
+        if (Services[i].isAdvertised &&
+            (Services[i].protocolRef == sessionRef->protocolRef) &&
+            (strcmp(Services[i].name, sessionRef->name) == 0))
+        {
+            return LE_OK;
+        }
+    }
+
+    return LE_UNAVAILABLE;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a session (the service must have been advertised already).
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_OpenSessionSync
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    LE_FATAL_IF(loopback_TryOpenSessionSync(sessionRef) != LE_OK,
+                "Service '%s' not advertised.", sessionRef->name);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a session.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_DeleteSession
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    le_mem_Release(sessionRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a service.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t loopback_CreateService
+(
+    le_msg_ProtocolRef_t protocolRef,
+    const char* interfaceName
+)
+{
+    LE_ASSERT(ServiceCount < MAX_SERVICES);
+    le_msg_ServiceRef_t serviceRef = &Services[ServiceCount++];
+
+    serviceRef->protocolRef = protocolRef;
+    LE_ASSERT(le_utf8_Copy(serviceRef->name, interfaceName, sizeof(serviceRef->name), NULL)
+              == LE_OK);
+
+    return serviceRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the handler of the requests sent to a service.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetServiceRecvHandler
+(
+    le_msg_ServiceRef_t serviceRef,
+    le_msg_ReceiveHandler_t handlerFunc,
+    void* contextPtr
+)
+{
+    serviceRef->recvHandler = handlerFunc;
+    serviceRef->recvContextPtr = contextPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a close handler to a service (sessions are never closed by the other end here).
+ *
+ * @return NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t loopback_AddServiceCloseHandler
+(
+    le_msg_ServiceRef_t serviceRef,
+    le_msg_SessionEventHandler_t handlerFunc,
+    void* contextPtr
+)
+{
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Advertise a service.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_AdvertiseService
+(
+    le_msg_ServiceRef_t serviceRef
+)
+{
+    serviceRef->isAdvertised = true;
+
+    if (serviceRef->protocolRef->serviceRef == NULL)
+    {
+        serviceRef->protocolRef->serviceRef = serviceRef;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a message.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t loopback_CreateSizedMsg
+(
+    le_msg_SessionRef_t sessionRef,
+    size_t payloadSize
+)
+{
+    return AllocMessage(sessionRef, payloadSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to the payload of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+void* loopback_GetPayloadPtr
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    return msgRef->payload;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the size of the payload buffer of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t loopback_GetMaxPayloadSize
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    return msgRef->payloadSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how many bytes at the start of the payload buffer are to be sent.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetPayloadSize
+(
+    le_msg_MessageRef_t msgRef,
+    size_t payloadSize
+)
+{
+    LE_FATAL_IF(payloadSize > msgRef->payloadSize,
+                "Payload size (%zu) is larger than the message's buffer (%zu).",
+                payloadSize, msgRef->payloadSize);
+
+    msgRef->usedSize = payloadSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the file descriptor sent with a message.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SetFd
+(
+    le_msg_MessageRef_t msgRef,
+    int fd
+)
+{
+    if (msgRef->fd >= 0)
+    {
+        close(msgRef->fd);
+    }
+
+    msgRef->fd = fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take the file descriptor received with a message.
+ *
+ * @return The file descriptor, or -1 if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+int loopback_GetFd
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    int fd = msgRef->fd;
+
+    msgRef->fd = -1;
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the session a message belongs to.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t loopback_GetSession
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    return msgRef->sessionRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a message.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_ReleaseMsg
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    if (msgRef->fd >= 0)
+    {
+        close(msgRef->fd);
+    }
+
+    le_mem_Release(msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pass a request to the service selected for its protocol, and wait for the response.
+ *
+ * @return The response.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t loopback_RequestSyncResponse
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    le_msg_ServiceRef_t serviceRef = msgRef->sessionRef->protocolRef->serviceRef;
+
+    LE_FATAL_IF(serviceRef == NULL, "No service for protocol '%s'.",
+                msgRef->sessionRef->protocolRef->id);
+    LE_ASSERT(ResponseRef == NULL);
+
+    serviceRef->recvHandler(Pass(msgRef, LOOPBACK_REQUEST), serviceRef->recvContextPtr);
+
+    le_msg_MessageRef_t responseRef = ResponseRef;
+
+    LE_FATAL_IF(responseRef == NULL, "Service '%s' didn't respond.", serviceRef->name);
+    ResponseRef = NULL;
+
+    return responseRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the response to a request.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_Respond
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    LE_ASSERT(ResponseRef == NULL);
+
+    ResponseRef = Pass(msgRef, LOOPBACK_RESPONSE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send an event to a client.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_Send
+(
+    le_msg_MessageRef_t msgRef
+)
+{
+    le_msg_SessionRef_t sessionRef = msgRef->sessionRef;
+
+    LE_ASSERT(sessionRef->recvHandler != NULL);
+
+    sessionRef->recvHandler(Pass(msgRef, LOOPBACK_EVENT), sessionRef->recvContextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the service that gets the requests of all sessions using the service's protocol.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SelectService
+(
+    le_msg_ServiceRef_t serviceRef
+)
+{
+    LE_ASSERT(serviceRef->isAdvertised);
+
+    serviceRef->protocolRef->serviceRef = serviceRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start or stop keeping the bytes of the messages passed.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_KeepMessages
+(
+    bool keep
+)
+{
+    IsKeeping = keep;
+    memset(KeptMessages, 0, sizeof(KeptMessages));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bytes of the last message of a given kind passed, and forget them.
+ *
+ * @return The number of bytes copied, or 0 if no message of this kind has been passed.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t loopback_TakeMessage
+(
+    loopback_Kind_t kind,
+    uint8_t* bufferPtr,
+    size_t bufferSize
+)
+{
+    size_t size = KeptMessages[kind].size;
+
+    LE_ASSERT(size <= bufferSize);
+    memcpy(bufferPtr, KeptMessages[kind].bytes, size);
+    KeptMessages[kind].size = 0;
+
+    return size;
+}
@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file loopback.h
+ *
+ * In-process replacement for the le_msg functions used by the code generated by ifgen, so that
+ * ifgenPackBench can call generated client stubs that are served by generated server stubs in the
+ * same thread, without the Service Directory or sockets in the way.
+ *
+ * This file is force-included (-include) before anything else by the benchmark's sources and by
+ * the generated stubs it is built with, which renames the le_msg functions they call (including
+ * their declarations in le_messaging.h) to the loopback_ functions implemented in loopback.c.
+ *
+ * A request is passed to the recv handler of the service selected for its protocol (see
+ * loopback_SelectService()), and the response or event is passed back to the client the same way.
+ * The bytes of the last request, response and event can be kept, to compare them.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LOOPBACK_H_INCLUDE_GUARD
+#define LOOPBACK_H_INCLUDE_GUARD
+
+#define le_msg_GetProtocolRef           loopback_GetProtocolRef
+#define le_msg_SetProtocolMsgSizes      loopback_SetProtocolMsgSizes
+#define le_msg_CreateSession            loopback_CreateSession
+#define le_msg_SetSessionRecvHandler    loopback_SetSessionRecvHandler
+#define le_msg_SetSessionCloseHandler   loopback_SetSessionCloseHandler
+#define le_msg_OpenSessionSync          loopback_OpenSessionSync
+#define le_msg_TryOpenSessionSync       loopback_TryOpenSessionSync
+#define le_msg_DeleteSession            loopback_DeleteSession
+#define le_msg_CreateService            loopback_CreateService
+#define le_msg_SetServiceRecvHandler    loopback_SetServiceRecvHandler
+#define le_msg_AddServiceCloseHandler   loopback_AddServiceCloseHandler
+#define le_msg_AdvertiseService         loopback_AdvertiseService
+#define le_msg_CreateSizedMsg           loopback_CreateSizedMsg
+#define le_msg_GetPayloadPtr            loopback_GetPayloadPtr
+#define le_msg_GetMaxPayloadSize        loopback_GetMaxPayloadSize
+#define le_msg_SetPayloadSize           loopback_SetPayloadSize
+#define le_msg_SetFd                    loopback_SetFd
+#define le_msg_GetFd                    loopback_GetFd
+#define le_msg_GetSession               loopback_GetSession
+#define le_msg_RequestSyncResponse      loopback_RequestSyncResponse
+#define le_msg_Respond                  loopback_Respond
+#define le_msg_Send                     loopback_Send
+#define le_msg_ReleaseMsg               loopback_ReleaseMsg
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of messages whose bytes can be kept.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LOOPBACK_REQUEST,
+    LOOPBACK_RESPONSE,
+    LOOPBACK_EVENT,
+    LOOPBACK_NUM_KINDS
+}
+loopback_Kind_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the service that gets the requests of all sessions using the service's protocol.
+ * (By default, it is the first service advertised with that protocol.)
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_SelectService
+(
+    le_msg_ServiceRef_t serviceRef  ///< [IN] Service (must have been advertised).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start or stop keeping the bytes of the messages passed.
+ */
+//--------------------------------------------------------------------------------------------------
+void loopback_KeepMessages
+(
+    bool keep   ///< [IN] true to keep them.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bytes of the last message of a given kind passed since loopback_KeepMessages(true) was
+ * called, and forget them.
+ *
+ * @return The number of bytes copied, or 0 if no message of this kind has been passed.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t loopback_TakeMessage
+(
+    loopback_Kind_t kind,   ///< [IN] Kind of message.
+    uint8_t* bufferPtr,     ///< [OUT] Buffer the bytes are copied to.
+    size_t bufferSize       ///< [IN] Size of the buffer (must be big enough for the message).
+);
+
+
+#endif // LOOPBACK_H_INCLUDE_GUARD
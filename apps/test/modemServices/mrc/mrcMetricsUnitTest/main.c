@@ -0,0 +1,779 @@
+/**
+ * This module implements the unit tests of the snapshots of le_mrc, over a stub of the platform
+ * adaptor (see paStub.h):
+ *  - snapshot of the serving cell and of its signal metrics, for several RATs,
+ *  - neighboring cells of a snapshot,
+ *  - snapshot when the platform adaptor fails,
+ *  - periodic snapshots, and the rate limitation of the measures,
+ *  - coalesced signal strength changes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_mrc.h"
+#include "le_mrc_local.h"
+#include "paStub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serving cell of the tests.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CELL_ID         0x772279
+#define LAC             0xB1C2
+#define TAC             0xABCD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Duration of the periodic snapshots test, and time waited after the handlers are removed, in
+ * milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PERIODIC_TEST_DURATION      3500
+#define PERIODIC_TEST_IDLE_TIME     1500
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of snapshot handlers of the periodic snapshots test.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HANDLER_COUNT   4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time between two steps of the coalesced signal strength changes test, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SS_STEP_TIME    300
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot, as returned by le_mrc_GetSnapshot().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_mrc_Rat_t   rat;
+    uint32_t       cellId;
+    uint32_t       lac;
+    uint16_t       tac;
+    le_mrc_Rat_t   metricsRat;
+    int32_t        ss;
+    uint32_t       er;
+    int32_t        ecio;
+    int32_t        rscp;
+    int32_t        sinr;
+    int32_t        rsrq;
+    int32_t        rsrp;
+    int32_t        snr;
+    int32_t        io;
+    size_t         ngbrCount;
+    uint32_t       ngbrCellId[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    uint32_t       ngbrLac[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrRxLevel[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    le_mrc_Rat_t   ngbrRat[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrUmtsEcIo[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrLteIntraRsrp[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrLteIntraRsrq[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrLteInterRsrp[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+    int32_t        ngbrLteInterRsrq[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];
+}
+Snapshot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot handler of the periodic snapshots test.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t                    period;         ///< Period requested, in seconds.
+    uint32_t                    expectedCount;  ///< Number of reports expected during the test.
+    uint32_t                    count;          ///< Number of reports received.
+    le_mrc_SnapshotHandlerRef_t handlerRef;     ///< Handler reference.
+}
+Handler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot handlers of the periodic snapshots test: a period of 0 is raised to
+ * LE_MRC_SNAPSHOT_MIN_PERIOD.
+ */
+//--------------------------------------------------------------------------------------------------
+static Handler_t Handlers[HANDLER_COUNT] =
+{
+    { .period = 1, .expectedCount = 3 },
+    { .period = 1, .expectedCount = 3 },
+    { .period = 0, .expectedCount = 3 },
+    { .period = 2, .expectedCount = 1 },
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Signal strength change handler of the coalesced signal strength changes test.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_mrc_Rat_t    rat;            ///< Radio Access Technology.
+    uint16_t        hysteresis;     ///< Hysteresis in dBm.
+    uint32_t        minInterval;    ///< Minimum interval between two notifications, in ms.
+    uint32_t        count;          ///< Number of notifications received.
+    int32_t         ss;             ///< Last signal strength received.
+    le_mrc_CoalescedSignalStrengthChangeHandlerRef_t handlerRef;   ///< Handler reference.
+}
+SsHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Coalesced signal strength change handlers of the coalesced signal strength changes test.
+ */
+//--------------------------------------------------------------------------------------------------
+static SsHandler_t SsHandlers[] =
+{
+    { .rat = LE_MRC_RAT_LTE, .hysteresis = 3, .minInterval = 0 },
+    { .rat = LE_MRC_RAT_LTE, .hysteresis = 0, .minInterval = SS_STEP_TIME + SS_STEP_TIME / 2 },
+    { .rat = LE_MRC_RAT_LTE, .hysteresis = 5, .minInterval = SS_STEP_TIME + SS_STEP_TIME / 2 },
+    { .rat = LE_MRC_RAT_GSM, .hysteresis = 0, .minInterval = 0 },
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Signal strength change handler notified of every change, for comparison.
+ */
+//--------------------------------------------------------------------------------------------------
+static SsHandler_t PlainSsHandler = { .rat = LE_MRC_RAT_LTE };
+static le_mrc_SignalStrengthChangeHandlerRef_t PlainSsHandlerRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Current step of the coalesced signal strength changes test.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SsStep;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a snapshot.
+ *
+ * @return The result of le_mrc_GetSnapshot().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetSnapshot
+(
+    Snapshot_t* snapshotPtr,    ///< [OUT] The snapshot.
+    size_t maxNgbrCount         ///< [IN] Size of the arrays of the neighboring cells.
+)
+{
+    size_t sizes[9];
+    le_result_t result;
+    int i;
+
+    memset(snapshotPtr, 0, sizeof(Snapshot_t));
+    for (i = 0; i < NUM_ARRAY_MEMBERS(sizes); i++)
+    {
+        sizes[i] = maxNgbrCount;
+    }
+
+    result = le_mrc_GetSnapshot(&snapshotPtr->rat, &snapshotPtr->cellId, &snapshotPtr->lac,
+                                &snapshotPtr->tac, &snapshotPtr->metricsRat, &snapshotPtr->ss,
+                                &snapshotPtr->er, &snapshotPtr->ecio, &snapshotPtr->rscp,
+                                &snapshotPtr->sinr, &snapshotPtr->rsrq, &snapshotPtr->rsrp,
+                                &snapshotPtr->snr, &snapshotPtr->io,
+                                snapshotPtr->ngbrCellId, &sizes[0],
+                                snapshotPtr->ngbrLac, &sizes[1],
+                                snapshotPtr->ngbrRxLevel, &sizes[2],
+                                snapshotPtr->ngbrRat, &sizes[3],
+                                snapshotPtr->ngbrUmtsEcIo, &sizes[4],
+                                snapshotPtr->ngbrLteIntraRsrp, &sizes[5],
+                                snapshotPtr->ngbrLteIntraRsrq, &sizes[6],
+                                snapshotPtr->ngbrLteInterRsrp, &sizes[7],
+                                snapshotPtr->ngbrLteInterRsrq, &sizes[8]);
+
+    // Every array holds the same cells.
+    for (i = 1; i < NUM_ARRAY_MEMBERS(sizes); i++)
+    {
+        LE_ASSERT(sizes[i] == sizes[0]);
+    }
+    snapshotPtr->ngbrCount = sizes[0];
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the signal metrics of a snapshot, other than the signal strength and the error rate.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMetrics
+(
+    const Snapshot_t* snapshotPtr,  ///< [IN] The snapshot.
+    int32_t ecio,                   ///< [IN] Expected Ec/Io.
+    int32_t rscp,                   ///< [IN] Expected RSCP.
+    int32_t sinr,                   ///< [IN] Expected SINR.
+    int32_t rsrq,                   ///< [IN] Expected RSRQ.
+    int32_t rsrp,                   ///< [IN] Expected RSRP.
+    int32_t snr,                    ///< [IN] Expected SNR.
+    int32_t io                      ///< [IN] Expected received IO.
+)
+{
+    LE_ASSERT(snapshotPtr->ecio == ecio);
+    LE_ASSERT(snapshotPtr->rscp == rscp);
+    LE_ASSERT(snapshotPtr->sinr == sinr);
+    LE_ASSERT(snapshotPtr->rsrq == rsrq);
+    LE_ASSERT(snapshotPtr->rsrp == rsrp);
+    LE_ASSERT(snapshotPtr->snr == snr);
+    LE_ASSERT(snapshotPtr->io == io);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a snapshot measured the signal metrics and the neighboring cells once.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMeasuredOnce
+(
+    void
+)
+{
+    uint32_t metricsCount, neighborsCount;
+
+    paStub_GetMeasureCounters(&metricsCount, &neighborsCount);
+    LE_ASSERT((1 == metricsCount) && (1 == neighborsCount));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: snapshot of the serving cell and of its signal metrics, for several RATs.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestServingCell
+(
+    void
+)
+{
+    pa_mrc_SignalMetrics_t metrics;
+    Snapshot_t snapshot;
+
+    // GSM: no tracking area code, and only the signal strength and the bit error rate.
+    paStub_SetServingCell(LE_MRC_RAT_GSM, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_GSM;
+    metrics.ss = -75;
+    metrics.er = 3;
+    paStub_SetSignalMetrics(&metrics);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    CheckMeasuredOnce();
+    LE_ASSERT(LE_MRC_RAT_GSM == snapshot.rat);
+    LE_ASSERT(CELL_ID == snapshot.cellId);
+    LE_ASSERT(LAC == snapshot.lac);
+    LE_ASSERT(UINT16_MAX == snapshot.tac);
+    LE_ASSERT(LE_MRC_RAT_GSM == snapshot.metricsRat);
+    LE_ASSERT((-75 == snapshot.ss) && (3 == snapshot.er));
+    CheckMetrics(&snapshot, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX,
+                 INT32_MAX);
+    LE_ASSERT(0 == snapshot.ngbrCount);
+
+    // UMTS.
+    paStub_SetServingCell(LE_MRC_RAT_UMTS, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_UMTS;
+    metrics.ss = -80;
+    metrics.er = 4;
+    metrics.umtsMetrics.ecio = -15;
+    metrics.umtsMetrics.rscp = -90;
+    paStub_SetSignalMetrics(&metrics);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    CheckMeasuredOnce();
+    LE_ASSERT(LE_MRC_RAT_UMTS == snapshot.metricsRat);
+    LE_ASSERT((-80 == snapshot.ss) && (4 == snapshot.er));
+    CheckMetrics(&snapshot, -15, -90, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX);
+
+    // LTE, with a tracking area code.
+    paStub_SetServingCell(LE_MRC_RAT_LTE, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_LTE;
+    metrics.ss = -85;
+    metrics.er = 5;
+    metrics.lteMetrics.rsrq = -11;
+    metrics.lteMetrics.rsrp = -950;
+    metrics.lteMetrics.snr = 125;
+    paStub_SetSignalMetrics(&metrics);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    CheckMeasuredOnce();
+    LE_ASSERT(LE_MRC_RAT_LTE == snapshot.rat);
+    LE_ASSERT(TAC == snapshot.tac);
+    LE_ASSERT(LE_MRC_RAT_LTE == snapshot.metricsRat);
+    LE_ASSERT((-85 == snapshot.ss) && (5 == snapshot.er));
+    CheckMetrics(&snapshot, INT32_MAX, INT32_MAX, INT32_MAX, -11, -950, 125, INT32_MAX);
+
+    // CDMA.
+    paStub_SetServingCell(LE_MRC_RAT_CDMA, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_CDMA;
+    metrics.ss = -90;
+    metrics.er = 6;
+    metrics.cdmaMetrics.ecio = -20;
+    metrics.cdmaMetrics.sinr = 30;
+    metrics.cdmaMetrics.io = -100;
+    paStub_SetSignalMetrics(&metrics);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    CheckMeasuredOnce();
+    LE_ASSERT(LE_MRC_RAT_CDMA == snapshot.metricsRat);
+    LE_ASSERT((-90 == snapshot.ss) && (6 == snapshot.er));
+    CheckMetrics(&snapshot, -20, INT32_MAX, 30, INT32_MAX, INT32_MAX, INT32_MAX, -100);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: neighboring cells of a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestNeighborCells
+(
+    void
+)
+{
+    pa_mrc_CellInfo_t cells[LE_MRC_SNAPSHOT_MAX_NEIGHBORS + 4];
+    Snapshot_t snapshot;
+    size_t i;
+
+    memset(cells, 0, sizeof(cells));
+    for (i = 0; i < NUM_ARRAY_MEMBERS(cells); i++)
+    {
+        cells[i].index = i;
+        cells[i].id = 1000 + i;
+        cells[i].lac = 2000 + i;
+        cells[i].rxLevel = -60 - i;
+        cells[i].rat = (i % 2) ? LE_MRC_RAT_UMTS : LE_MRC_RAT_LTE;
+        cells[i].umtsEcIo = (i % 2) ? -10 - (int32_t)i : INT32_MAX;
+        cells[i].lteIntraRsrp = (i % 2) ? INT32_MAX : -900 - (int32_t)i;
+        cells[i].lteIntraRsrq = (i % 2) ? INT32_MAX : -100 - (int32_t)i;
+        cells[i].lteInterRsrp = (i % 2) ? INT32_MAX : -910 - (int32_t)i;
+        cells[i].lteInterRsrq = (i % 2) ? INT32_MAX : -110 - (int32_t)i;
+    }
+    paStub_SetNeighborCells(cells, NUM_ARRAY_MEMBERS(cells));
+
+    // The snapshot keeps the first LE_MRC_SNAPSHOT_MAX_NEIGHBORS cells.
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    CheckMeasuredOnce();
+    LE_ASSERT(LE_MRC_SNAPSHOT_MAX_NEIGHBORS == snapshot.ngbrCount);
+    for (i = 0; i < snapshot.ngbrCount; i++)
+    {
+        LE_ASSERT(snapshot.ngbrCellId[i] == cells[i].id);
+        LE_ASSERT(snapshot.ngbrLac[i] == cells[i].lac);
+        LE_ASSERT(snapshot.ngbrRxLevel[i] == cells[i].rxLevel);
+        LE_ASSERT(snapshot.ngbrRat[i] == cells[i].rat);
+        LE_ASSERT(snapshot.ngbrUmtsEcIo[i] == cells[i].umtsEcIo);
+        LE_ASSERT(snapshot.ngbrLteIntraRsrp[i] == cells[i].lteIntraRsrp);
+        LE_ASSERT(snapshot.ngbrLteIntraRsrq[i] == cells[i].lteIntraRsrq);
+        LE_ASSERT(snapshot.ngbrLteInterRsrp[i] == cells[i].lteInterRsrp);
+        LE_ASSERT(snapshot.ngbrLteInterRsrq[i] == cells[i].lteInterRsrq);
+    }
+
+    // Smaller arrays get the first cells.
+    LE_ASSERT_OK(GetSnapshot(&snapshot, 4));
+    CheckMeasuredOnce();
+    LE_ASSERT(4 == snapshot.ngbrCount);
+    LE_ASSERT(snapshot.ngbrCellId[3] == cells[3].id);
+    LE_ASSERT(snapshot.ngbrUmtsEcIo[3] == cells[3].umtsEcIo);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: snapshot when the platform adaptor fails.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestFailures
+(
+    void
+)
+{
+    pa_mrc_SignalMetrics_t metrics;
+    Snapshot_t snapshot;
+
+    // Not registered, but the signal metrics are measured.
+    paStub_SetServingCell(LE_MRC_RAT_UNKNOWN, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_GSM;
+    metrics.ss = -100;
+    metrics.er = 7;
+    paStub_SetSignalMetrics(&metrics);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    LE_ASSERT(LE_MRC_RAT_UNKNOWN == snapshot.rat);
+    LE_ASSERT(UINT16_MAX == snapshot.tac);
+    LE_ASSERT(LE_MRC_RAT_GSM == snapshot.metricsRat);
+    LE_ASSERT(-100 == snapshot.ss);
+
+    // Registered, but the signal metrics can't be measured.
+    paStub_SetServingCell(LE_MRC_RAT_LTE, CELL_ID, LAC, TAC);
+    paStub_SetSignalMetrics(NULL);
+
+    LE_ASSERT_OK(GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+    LE_ASSERT(LE_MRC_RAT_LTE == snapshot.rat);
+    LE_ASSERT(TAC == snapshot.tac);
+    LE_ASSERT(LE_MRC_RAT_UNKNOWN == snapshot.metricsRat);
+    LE_ASSERT((INT32_MAX == snapshot.ss) && (UINT32_MAX == snapshot.er));
+    CheckMetrics(&snapshot, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX,
+                 INT32_MAX);
+    LE_ASSERT(LE_MRC_SNAPSHOT_MAX_NEIGHBORS == snapshot.ngbrCount);
+
+    // Neither.
+    paStub_SetServingCell(LE_MRC_RAT_UNKNOWN, CELL_ID, LAC, TAC);
+    LE_ASSERT(LE_FAULT == GetSnapshot(&snapshot, LE_MRC_SNAPSHOT_MAX_NEIGHBORS));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler of the periodic snapshots test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotHandler
+(
+    le_mrc_Rat_t rat,
+    uint32_t cellId,
+    uint32_t locAreaCode,
+    uint16_t tracAreaCode,
+    le_mrc_Rat_t metricsRat,
+    int32_t ss,
+    uint32_t er,
+    int32_t ecio,
+    int32_t rscp,
+    int32_t sinr,
+    int32_t rsrq,
+    int32_t rsrp,
+    int32_t snr,
+    int32_t io,
+    const uint32_t* ngbrCellIdPtr,
+    size_t ngbrCellIdSize,
+    const uint32_t* ngbrLocAreaCodePtr,
+    size_t ngbrLocAreaCodeSize,
+    const int32_t* ngbrRxLevelPtr,
+    size_t ngbrRxLevelSize,
+    const le_mrc_Rat_t* ngbrRatPtr,
+    size_t ngbrRatSize,
+    const int32_t* ngbrUmtsEcIoPtr,
+    size_t ngbrUmtsEcIoSize,
+    const int32_t* ngbrLteIntraRsrpPtr,
+    size_t ngbrLteIntraRsrpSize,
+    const int32_t* ngbrLteIntraRsrqPtr,
+    size_t ngbrLteIntraRsrqSize,
+    const int32_t* ngbrLteInterRsrpPtr,
+    size_t ngbrLteInterRsrpSize,
+    const int32_t* ngbrLteInterRsrqPtr,
+    size_t ngbrLteInterRsrqSize,
+    void* contextPtr
+)
+{
+    Handler_t* handlerPtr = contextPtr;
+
+    LE_ASSERT(LE_MRC_RAT_LTE == rat);
+    LE_ASSERT((CELL_ID == cellId) && (LAC == locAreaCode) && (TAC == tracAreaCode));
+    LE_ASSERT(LE_MRC_RAT_LTE == metricsRat);
+    LE_ASSERT((-85 == ss) && (5 == er));
+    LE_ASSERT((-11 == rsrq) && (-950 == rsrp) && (125 == snr));
+    LE_ASSERT((INT32_MAX == ecio) && (INT32_MAX == rscp) && (INT32_MAX == sinr) &&
+              (INT32_MAX == io));
+    LE_ASSERT(2 == ngbrCellIdSize);
+    LE_ASSERT((ngbrLocAreaCodeSize == ngbrCellIdSize) && (ngbrRxLevelSize == ngbrCellIdSize) &&
+              (ngbrRatSize == ngbrCellIdSize) && (ngbrUmtsEcIoSize == ngbrCellIdSize) &&
+              (ngbrLteIntraRsrpSize == ngbrCellIdSize) &&
+              (ngbrLteIntraRsrqSize == ngbrCellIdSize) &&
+              (ngbrLteInterRsrpSize == ngbrCellIdSize) &&
+              (ngbrLteInterRsrqSize == ngbrCellIdSize));
+    LE_ASSERT((1000 == ngbrCellIdPtr[0]) && (1001 == ngbrCellIdPtr[1]));
+    LE_ASSERT((LE_MRC_RAT_LTE == ngbrRatPtr[0]) && (LE_MRC_RAT_UMTS == ngbrRatPtr[1]));
+
+    handlerPtr->count++;
+    LE_INFO("Snapshot handler %d: report %u",
+            (int)(handlerPtr - Handlers), handlerPtr->count);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler of the coalesced signal strength changes test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SsChangeHandler
+(
+    int32_t ss,
+    void* contextPtr
+)
+{
+    SsHandler_t* handlerPtr = contextPtr;
+
+    handlerPtr->count++;
+    handlerPtr->ss = ss;
+    LE_INFO("Signal strength handler %p: %d dBm", handlerPtr, ss);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the notifications received by a signal strength change handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckSsHandler
+(
+    const SsHandler_t* handlerPtr,  ///< [IN] The handler.
+    uint32_t count,                 ///< [IN] Expected number of notifications.
+    int32_t ss                      ///< [IN] Expected last signal strength.
+)
+{
+    LE_ASSERT(handlerPtr->count == count);
+    LE_ASSERT((0 == count) || (handlerPtr->ss == ss));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Steps of the coalesced signal strength changes test, one per timer expiry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SsTestTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    int i;
+
+    switch (SsStep++)
+    {
+        case 0:
+            // The burst is notified in full to the plain handler. The first change is notified to
+            // every coalesced handler, then only the changes beyond the hysteresis of the first
+            // one, or the latest change once the minimum interval elapses.
+            CheckSsHandler(&PlainSsHandler, 6, -79);
+            CheckSsHandler(&SsHandlers[0], 3, -79);
+            CheckSsHandler(&SsHandlers[1], 1, -80);
+            CheckSsHandler(&SsHandlers[2], 1, -80);
+            CheckSsHandler(&SsHandlers[3], 0, 0);
+            break;
+
+        case 1:
+            // The minimum interval elapsed: the latest change is notified, and the pending change
+            // that came back within the hysteresis was dropped.
+            CheckSsHandler(&SsHandlers[1], 2, -79);
+            CheckSsHandler(&SsHandlers[2], 1, -80);
+
+            paStub_ReportSignalStrength(LE_MRC_RAT_GSM, -90);
+            break;
+
+        case 2:
+            // Only the handlers of the RAT are notified.
+            CheckSsHandler(&PlainSsHandler, 6, -79);
+            CheckSsHandler(&SsHandlers[3], 1, -90);
+
+            // No more notifications once the handlers are removed.
+            le_mrc_RemoveSignalStrengthChangeHandler(PlainSsHandlerRef);
+            for (i = 0; i < NUM_ARRAY_MEMBERS(SsHandlers); i++)
+            {
+                le_mrc_RemoveCoalescedSignalStrengthChangeHandler(SsHandlers[i].handlerRef);
+            }
+            paStub_ReportSignalStrength(LE_MRC_RAT_LTE, -60);
+            paStub_ReportSignalStrength(LE_MRC_RAT_GSM, -60);
+            break;
+
+        default:
+            CheckSsHandler(&PlainSsHandler, 6, -79);
+            CheckSsHandler(&SsHandlers[0], 3, -79);
+            CheckSsHandler(&SsHandlers[1], 2, -79);
+            CheckSsHandler(&SsHandlers[2], 1, -80);
+            CheckSsHandler(&SsHandlers[3], 1, -90);
+
+            le_timer_Delete(timerRef);
+
+            LE_INFO("======== UnitTest of MRC metrics ends with SUCCESS ========");
+            exit(EXIT_SUCCESS);
+    }
+
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: coalesced signal strength changes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestCoalescedSignalStrength
+(
+    void
+)
+{
+    static const int32_t burst[] = { -80, -81, -82, -85, -86, -79 };
+    le_timer_Ref_t timerRef;
+    int i;
+
+    LE_ASSERT(NULL == le_mrc_AddCoalescedSignalStrengthChangeHandler(LE_MRC_RAT_LTE, -100, -50,
+                                                                     0, 0, NULL, NULL));
+    LE_ASSERT(NULL == le_mrc_AddCoalescedSignalStrengthChangeHandler(LE_MRC_RAT_UNKNOWN, -100,
+                                                                     -50, 0, 0, SsChangeHandler,
+                                                                     NULL));
+    LE_ASSERT(NULL == le_mrc_AddCoalescedSignalStrengthChangeHandler(LE_MRC_RAT_LTE, -50, -100,
+                                                                     0, 0, SsChangeHandler,
+                                                                     NULL));
+
+    PlainSsHandlerRef = le_mrc_AddSignalStrengthChangeHandler(PlainSsHandler.rat, -100, -50,
+                                                              SsChangeHandler, &PlainSsHandler);
+    LE_ASSERT(PlainSsHandlerRef != NULL);
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(SsHandlers); i++)
+    {
+        SsHandlers[i].handlerRef =
+                        le_mrc_AddCoalescedSignalStrengthChangeHandler(SsHandlers[i].rat,
+                                                                       -100,
+                                                                       -50,
+                                                                       SsHandlers[i].hysteresis,
+                                                                       SsHandlers[i].minInterval,
+                                                                       SsChangeHandler,
+                                                                       &SsHandlers[i]);
+        LE_ASSERT(SsHandlers[i].handlerRef != NULL);
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(burst); i++)
+    {
+        paStub_ReportSignalStrength(LE_MRC_RAT_LTE, burst[i]);
+    }
+
+    timerRef = le_timer_Create("SsTestTimer");
+    LE_ASSERT_OK(le_timer_SetMsInterval(timerRef, SS_STEP_TIME));
+    LE_ASSERT_OK(le_timer_SetHandler(timerRef, SsTestTimerHandler));
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End of the periodic snapshots test: no more reports after the handlers are removed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IdleTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    uint32_t metricsCount, neighborsCount;
+    int i;
+
+    for (i = 0; i < HANDLER_COUNT; i++)
+    {
+        LE_ASSERT(Handlers[i].count == Handlers[i].expectedCount);
+    }
+    paStub_GetMeasureCounters(&metricsCount, &neighborsCount);
+    LE_ASSERT((0 == metricsCount) && (0 == neighborsCount));
+
+    le_timer_Delete(timerRef);
+
+    LE_INFO("======== Coalesced Signal Strength Test ========");
+    TestCoalescedSignalStrength();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the reports and the measures of the periodic snapshots test, and remove the handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    uint32_t metricsCount, neighborsCount;
+    uint32_t reportCount = 0;
+    int i;
+
+    for (i = 0; i < HANDLER_COUNT; i++)
+    {
+        LE_ASSERT(Handlers[i].count == Handlers[i].expectedCount);
+        reportCount += Handlers[i].count;
+        le_mrc_RemoveSnapshotHandler(Handlers[i].handlerRef);
+    }
+
+    // The handlers whose period elapses at once share the same measure.
+    paStub_GetMeasureCounters(&metricsCount, &neighborsCount);
+    LE_INFO("%u reports, %u measures", reportCount, metricsCount);
+    LE_ASSERT((metricsCount >= 3) && (metricsCount <= 4) && (neighborsCount == metricsCount));
+
+    le_timer_Delete(timerRef);
+    timerRef = le_timer_Create("IdleTimer");
+    LE_ASSERT_OK(le_timer_SetMsInterval(timerRef, PERIODIC_TEST_IDLE_TIME));
+    LE_ASSERT_OK(le_timer_SetHandler(timerRef, IdleTimerHandler));
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: periodic snapshots, and the rate limitation of the measures.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestPeriodicSnapshots
+(
+    void
+)
+{
+    pa_mrc_CellInfo_t cells[2];
+    pa_mrc_SignalMetrics_t metrics;
+    le_timer_Ref_t timerRef;
+    uint32_t metricsCount, neighborsCount;
+    int i;
+
+    paStub_SetServingCell(LE_MRC_RAT_LTE, CELL_ID, LAC, TAC);
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.rat = LE_MRC_RAT_LTE;
+    metrics.ss = -85;
+    metrics.er = 5;
+    metrics.lteMetrics.rsrq = -11;
+    metrics.lteMetrics.rsrp = -950;
+    metrics.lteMetrics.snr = 125;
+    paStub_SetSignalMetrics(&metrics);
+
+    memset(cells, 0, sizeof(cells));
+    cells[0].id = 1000;
+    cells[0].rat = LE_MRC_RAT_LTE;
+    cells[1].id = 1001;
+    cells[1].rat = LE_MRC_RAT_UMTS;
+    paStub_SetNeighborCells(cells, NUM_ARRAY_MEMBERS(cells));
+    paStub_GetMeasureCounters(&metricsCount, &neighborsCount);
+
+    LE_ASSERT(NULL == le_mrc_AddSnapshotHandler(1, NULL, NULL));
+
+    for (i = 0; i < HANDLER_COUNT; i++)
+    {
+        Handlers[i].handlerRef = le_mrc_AddSnapshotHandler(Handlers[i].period, SnapshotHandler,
+                                                           &Handlers[i]);
+        LE_ASSERT(Handlers[i].handlerRef != NULL);
+    }
+
+    timerRef = le_timer_Create("TestTimer");
+    LE_ASSERT_OK(le_timer_SetMsInterval(timerRef, PERIODIC_TEST_DURATION));
+    LE_ASSERT_OK(le_timer_SetHandler(timerRef, TestTimerHandler));
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    le_mrc_Init();
+
+    LE_INFO("======== Serving Cell Test ========");
+    TestServingCell();
+
+    LE_INFO("======== Neighbor Cells Test ========");
+    TestNeighborCells();
+
+    LE_INFO("======== Failures Test ========");
+    TestFailures();
+
+    // The test ends in the event loop.
+    LE_INFO("======== Periodic Snapshots Test ========");
+    TestPeriodicSnapshots();
+}
@@ -0,0 +1,607 @@
+/**
+ * @file paStub.c
+ *
+ * Stub of the MRC platform adaptor, and of the other functions of the modem services used by
+ * le_mrc, for the MRC metrics unit tests.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_mrc.h"
+#include "paStub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stub state. The stub is only called by the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mrc_Rat_t Rat = LE_MRC_RAT_UNKNOWN;
+static uint32_t CellId;
+static uint32_t Lac;
+static uint16_t Tac;
+static bool IsMetricsAvailable;
+static pa_mrc_SignalMetrics_t Metrics;
+static pa_mrc_CellInfo_t Neighbors[PA_STUB_MAX_NEIGHBORS];
+static size_t NeighborCount;
+static uint32_t MetricsCount;
+static uint32_t NeighborsCount;
+static pa_mrc_SignalStrengthIndHdlrFunc_t SsIndHandler;
+static le_mem_PoolRef_t SsIndPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the serving cell.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetServingCell
+(
+    le_mrc_Rat_t rat,       ///< [IN] Radio access technology in use, LE_MRC_RAT_UNKNOWN if the
+                            ///<      device is not registered.
+    uint32_t cellId,        ///< [IN] Cell identifier.
+    uint32_t lac,           ///< [IN] Location area code.
+    uint16_t tac            ///< [IN] Tracking area code.
+)
+{
+    Rat = rat;
+    CellId = cellId;
+    Lac = lac;
+    Tac = tac;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the signal metrics.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetSignalMetrics
+(
+    const pa_mrc_SignalMetrics_t* metricsPtr    ///< [IN] Signal metrics, NULL if they can't be
+                                                ///<      measured.
+)
+{
+    IsMetricsAvailable = (metricsPtr != NULL);
+    if (IsMetricsAvailable)
+    {
+        Metrics = *metricsPtr;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the neighboring cells.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetNeighborCells
+(
+    const pa_mrc_CellInfo_t* cellsPtr,  ///< [IN] Cells information.
+    size_t count                        ///< [IN] Number of cells.
+)
+{
+    LE_ASSERT(count <= PA_STUB_MAX_NEIGHBORS);
+    memcpy(Neighbors, cellsPtr, count * sizeof(pa_mrc_CellInfo_t));
+    NeighborCount = count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of signal metrics measures and of neighboring cells queries since the last call.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetMeasureCounters
+(
+    uint32_t* metricsCountPtr,      ///< [OUT] Number of signal metrics measures.
+    uint32_t* neighborsCountPtr     ///< [OUT] Number of neighboring cells queries.
+)
+{
+    *metricsCountPtr = MetricsCount;
+    *neighborsCountPtr = NeighborsCount;
+    MetricsCount = 0;
+    NeighborsCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a signal strength indication to le_mrc.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReportSignalStrength
+(
+    le_mrc_Rat_t rat,       ///< [IN] Radio access technology of the measured signal.
+    int32_t ss              ///< [IN] Signal strength in dBm.
+)
+{
+    LE_ASSERT(SsIndHandler != NULL);
+
+    if (NULL == SsIndPool)
+    {
+        SsIndPool = le_mem_CreatePool("SsIndPool", sizeof(pa_mrc_SignalStrengthIndication_t));
+    }
+
+    // The indication is a reference counted object, released by the handlers.
+    pa_mrc_SignalStrengthIndication_t* ssIndPtr = le_mem_ForceAlloc(SsIndPool);
+    ssIndPtr->rat = rat;
+    ssIndPtr->ss = ss;
+    SsIndHandler(ssIndPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stubbed platform adaptor functions.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pa_mrc_SetRadioPower
+(
+    le_onoff_t power
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetRadioPower
+(
+    le_onoff_t* powerPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_event_HandlerRef_t pa_mrc_SetRatChangeHandler
+(
+    pa_mrc_RatChangeHdlrFunc_t handlerFuncPtr
+)
+{
+    return (le_event_HandlerRef_t)1;
+}
+
+le_event_HandlerRef_t pa_mrc_SetPSChangeHandler
+(
+    pa_mrc_ServiceChangeHdlrFunc_t handlerFuncPtr
+)
+{
+    return (le_event_HandlerRef_t)1;
+}
+
+le_event_HandlerRef_t pa_mrc_AddNetworkRegHandler
+(
+    pa_mrc_NetworkRegHdlrFunc_t regStateHandler
+)
+{
+    return (le_event_HandlerRef_t)1;
+}
+
+le_result_t pa_mrc_ConfigureNetworkReg
+(
+    pa_mrc_NetworkRegSetting_t setting
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_mrc_GetNetworkRegConfig
+(
+    pa_mrc_NetworkRegSetting_t* settingPtr
+)
+{
+    return LE_FAULT;
+}
+
+int32_t pa_mrc_GetPlatformSpecificRegistrationErrorCode
+(
+    void
+)
+{
+    return 0;
+}
+
+le_result_t pa_mrc_GetNetworkRegState
+(
+    le_mrc_NetRegState_t* statePtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetSignalStrength
+(
+    int32_t* rssiPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetCurrentNetwork
+(
+    char *nameStr,
+    size_t nameStrSize,
+    char *mccStr,
+    size_t mccStrNumElements,
+    char *mncStr,
+    size_t mncStrNumElements
+)
+{
+    return LE_FAULT;
+}
+
+void pa_mrc_DeleteScanInformation
+(
+    le_dls_List_t *scanInformationListPtr
+)
+{
+}
+
+le_result_t pa_mrc_PerformNetworkScan
+(
+    le_mrc_RatBitMask_t ratMask,
+    pa_mrc_ScanType_t scanType,
+    le_dls_List_t *scanInformationListPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetScanInformationName
+(
+    pa_mrc_ScanInformation_t *scanInformationPtr,
+    char *namePtr,
+    size_t nameSize
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_CountPreferredOperators
+(
+    bool plmnStatic,
+    bool plmnUser,
+    int32_t* nbItemPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetPreferredOperators
+(
+    pa_mrc_PreferredNetworkOperator_t* preferredOperatorPtr,
+    bool plmnStatic,
+    bool plmnUser,
+    int32_t* nbItemPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SavePreferredOperators
+(
+    le_dls_List_t *preferredOperatorsListPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_RegisterNetwork
+(
+    const char *mccPtr,
+    const char *mncPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SetAutomaticNetworkRegistration
+(
+    void
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetRadioAccessTechInUse
+(
+    le_mrc_Rat_t* ratPtr
+)
+{
+    if (LE_MRC_RAT_UNKNOWN == Rat)
+    {
+        return LE_FAULT;
+    }
+
+    *ratPtr = Rat;
+    return LE_OK;
+}
+
+le_result_t pa_mrc_SetRatPreferences
+(
+    le_mrc_RatBitMask_t ratMask
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SetAutomaticRatPreference
+(
+    void
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetRatPreferences
+(
+    le_mrc_RatBitMask_t* ratMaskPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SetBandPreferences
+(
+    le_mrc_BandBitMask_t bands
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetBandPreferences
+(
+    le_mrc_BandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SetLteBandPreferences
+(
+    le_mrc_LteBandBitMask_t bands
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetLteBandPreferences
+(
+    le_mrc_LteBandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_SetTdScdmaBandPreferences
+(
+    le_mrc_TdScdmaBandBitMask_t bands
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetTdScdmaBandPreferences
+(
+    le_mrc_TdScdmaBandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+int32_t pa_mrc_GetNeighborCellsInfo
+(
+    le_dls_List_t* cellInfoListPtr
+)
+{
+    size_t i;
+
+    NeighborsCount++;
+    if (0 == NeighborCount)
+    {
+        return LE_FAULT;
+    }
+
+    for (i = 0; i < NeighborCount; i++)
+    {
+        pa_mrc_CellInfo_t* cellInfoPtr = malloc(sizeof(pa_mrc_CellInfo_t));
+
+        LE_ASSERT(cellInfoPtr != NULL);
+        *cellInfoPtr = Neighbors[i];
+        cellInfoPtr->link = LE_DLS_LINK_INIT;
+        le_dls_Queue(cellInfoListPtr, &cellInfoPtr->link);
+    }
+
+    return NeighborCount;
+}
+
+void pa_mrc_DeleteNeighborCellsInfo
+(
+    le_dls_List_t *cellInfoListPtr
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    while ((linkPtr = le_dls_Pop(cellInfoListPtr)) != NULL)
+    {
+        free(CONTAINER_OF(linkPtr, pa_mrc_CellInfo_t, link));
+    }
+}
+
+le_result_t pa_mrc_GetNetworkRegistrationMode
+(
+    bool* isManualPtr,
+    char* mccPtr,
+    size_t mccPtrSize,
+    char* mncPtr,
+    size_t mncPtrSize
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_MeasureSignalMetrics
+(
+    pa_mrc_SignalMetrics_t* metricsPtr
+)
+{
+    MetricsCount++;
+    if (!IsMetricsAvailable)
+    {
+        return LE_FAULT;
+    }
+
+    *metricsPtr = Metrics;
+    return LE_OK;
+}
+
+le_event_HandlerRef_t pa_mrc_AddSignalStrengthIndHandler
+(
+    pa_mrc_SignalStrengthIndHdlrFunc_t ssIndHandler,
+    void* contextPtr
+)
+{
+    SsIndHandler = ssIndHandler;
+    return (le_event_HandlerRef_t)1;
+}
+
+le_result_t pa_mrc_SetSignalStrengthIndThresholds
+(
+    le_mrc_Rat_t rat,
+    int32_t lowerRangeThreshold,
+    int32_t upperRangeThreshold
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_mrc_SetSignalStrengthIndDelta
+(
+    le_mrc_Rat_t rat,
+    uint16_t delta
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_mrc_GetServingCellId
+(
+    uint32_t* cellIdPtr
+)
+{
+    *cellIdPtr = CellId;
+    return LE_OK;
+}
+
+le_result_t pa_mrc_GetServingCellLteTracAreaCode
+(
+    uint16_t* tacPtr
+)
+{
+    if (LE_MRC_RAT_LTE != Rat)
+    {
+        return LE_FAULT;
+    }
+
+    *tacPtr = Tac;
+    return LE_OK;
+}
+
+le_result_t pa_mrc_GetServingCellLocAreaCode
+(
+    uint32_t* lacPtr
+)
+{
+    *lacPtr = Lac;
+    return LE_OK;
+}
+
+le_result_t pa_mrc_GetBandCapabilities
+(
+    le_mrc_BandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetLteBandCapabilities
+(
+    le_mrc_LteBandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetTdScdmaBandCapabilities
+(
+    le_mrc_TdScdmaBandBitMask_t* bandsPtr
+)
+{
+    return LE_FAULT;
+}
+
+le_result_t pa_mrc_GetPacketSwitchedState
+(
+    le_mrc_NetRegState_t* statePtr
+)
+{
+    return LE_FAULT;
+}
+
+le_event_HandlerRef_t pa_mrc_AddNetworkRejectIndHandler
+(
+    pa_mrc_NetworkRejectIndHdlrFunc_t networkRejectIndHandler,
+    void* contextPtr
+)
+{
+    return (le_event_HandlerRef_t)1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client session reference for the current message (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_mrc_GetClientSessionRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_mrc_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registers a function to be called whenever one of this service's sessions is closed by
+ * the client.  (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t MyAddServiceCloseHandler
+(
+    le_msg_ServiceRef_t             serviceRef, ///< [in] Reference to the service.
+    le_msg_SessionEventHandler_t    handlerFunc,///< [in] Handler function.
+    void*                           contextPtr  ///< [in] Opaque pointer value to pass to handler.
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Begin monitoring the event loop on the current thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_wdogChain_MonitorEventLoop
+(
+    uint32_t watchdog,          ///< Watchdog to use for monitoring
+    le_clk_Time_t watchdogInterval ///< Interval at which to check event loop is functioning
+)
+{
+}
@@ -0,0 +1,83 @@
+/**
+ * @file paStub.h
+ *
+ * Stub of the MRC platform adaptor for the MRC metrics unit tests: the serving cell, the signal
+ * metrics and the neighboring cells are set by the test, and the measures are counted. The signal
+ * strength indications are reported by the test.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef PA_STUB_H_INCLUDE_GUARD
+#define PA_STUB_H_INCLUDE_GUARD
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_mrc.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of neighboring cells of the stub.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PA_STUB_MAX_NEIGHBORS   32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the serving cell.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetServingCell
+(
+    le_mrc_Rat_t rat,       ///< [IN] Radio access technology in use, LE_MRC_RAT_UNKNOWN if the
+                            ///<      device is not registered.
+    uint32_t cellId,        ///< [IN] Cell identifier.
+    uint32_t lac,           ///< [IN] Location area code.
+    uint16_t tac            ///< [IN] Tracking area code.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the signal metrics.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetSignalMetrics
+(
+    const pa_mrc_SignalMetrics_t* metricsPtr    ///< [IN] Signal metrics, NULL if they can't be
+                                                ///<      measured.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the neighboring cells.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetNeighborCells
+(
+    const pa_mrc_CellInfo_t* cellsPtr,  ///< [IN] Cells information.
+    size_t count                        ///< [IN] Number of cells.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of signal metrics measures and of neighboring cells queries since the last call.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetMeasureCounters
+(
+    uint32_t* metricsCountPtr,      ///< [OUT] Number of signal metrics measures.
+    uint32_t* neighborsCountPtr     ///< [OUT] Number of neighboring cells queries.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a signal strength indication to le_mrc.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReportSignalStrength
+(
+    le_mrc_Rat_t rat,       ///< [IN] Radio access technology of the measured signal.
+    int32_t ss              ///< [IN] Signal strength in dBm.
+);
+
+#endif // PA_STUB_H_INCLUDE_GUARD
@@ -0,0 +1,603 @@
+/**
+ * This module implements the unit tests of the batches of messages of le_sms, over a stub of the
+ * platform adaptor whose PDU submissions take a given time (see paStub.h):
+ *  - encoding of the parts of a concatenated message,
+ *  - throughput of a batch with several submissions in flight (the platform setting is simulated),
+ *  - submissions in flight when several batches are sent at once,
+ *  - statuses of the messages of a batch, when their submissions fail,
+ *  - error cases,
+ *  - access to the platform adaptor by other requests while a batch is being sent,
+ *  - deletion of a batch being sent.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_sms.h"
+#include "smsPdu.h"
+#include "le_sms_local.h"
+#include "paStub.h"
+#include "le_cfg_simu.h"
+#include "mdmCfgEntries.h"
+
+#include <poll.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destinations of the messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEST                "+33612345678"
+#define FAILED_DEST         "+33600000001"
+#define TIMED_OUT_DEST      "+33600000002"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time a PDU submission takes, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LATENCY             50
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages of the throughput test, and number of submissions in flight (set in the
+ * simulated config tree).
+ */
+//--------------------------------------------------------------------------------------------------
+#define THROUGHPUT_MSGS     32
+#define THROUGHPUT_IN_FLIGHT    4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum time to wait for the result of a batch, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RESULT_TIMEOUT      10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Short text message.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHORT_TEXT          "Your parcel is on its way"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Result of the last batch sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsResultReported;
+static le_sms_BatchRef_t ResultBatchRef;
+static uint32_t ResultSentCount;
+static uint32_t ResultFailedCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetTimeMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (uint64_t)now.sec * 1000 + now.usec / 1000;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of GSM 7-bit characters a character is encoded into.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetSeptetCount
+(
+    uint8_t c
+)
+{
+    // Characters of the extension table are escaped.
+    return ((c != '\0') && (strchr("\f^{}\\[~]|", c) != NULL)) ? 2 : 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the sending result of a batch.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchResultHandler
+(
+    le_sms_BatchRef_t batchRef,
+    uint32_t sentCount,
+    uint32_t failedCount,
+    void* contextPtr
+)
+{
+    LE_INFO("Batch %p: %u sent, %u failed", batchRef, sentCount, failedCount);
+
+    // Called once per batch.
+    LE_ASSERT(!IsResultReported);
+    IsResultReported = true;
+    ResultBatchRef = batchRef;
+    ResultSentCount = sentCount;
+    ResultFailedCount = failedCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process the events of this thread for a given time, or until the result of a batch is reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessEvents
+(
+    uint32_t timeout,       ///< [IN] Maximum time to process the events, in milliseconds.
+    bool untilResult        ///< [IN] true to stop once the result of a batch is reported.
+)
+{
+    struct pollfd pollFd = { .fd = le_event_GetFd(), .events = POLLIN };
+    uint64_t endTime = GetTimeMs() + timeout;
+    uint64_t now;
+
+    while (!(untilResult && IsResultReported) && ((now = GetTimeMs()) < endTime))
+    {
+        if (poll(&pollFd, 1, endTime - now) > 0)
+        {
+            while (LE_OK == le_event_ServiceLoop())
+            {
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch, and wait for its result.
+ *
+ * @return The sending time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t SendAndWait
+(
+    le_sms_BatchRef_t batchRef
+)
+{
+    uint64_t startTime = GetTimeMs();
+
+    paStub_Reset();
+    IsResultReported = false;
+    LE_ASSERT_OK(le_sms_SendBatch(batchRef, BatchResultHandler, NULL));
+
+    ProcessEvents(RESULT_TIMEOUT, true);
+    LE_ASSERT(IsResultReported);
+    LE_ASSERT(ResultBatchRef == batchRef);
+
+    return GetTimeMs() - startTime;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a batch of short messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_BatchRef_t CreateBatch
+(
+    uint32_t msgCount
+)
+{
+    le_sms_BatchRef_t batchRef = le_sms_CreateBatch();
+    uint32_t i;
+
+    LE_ASSERT(batchRef != NULL);
+    for (i = 0; i < msgCount; i++)
+    {
+        LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    }
+
+    return batchRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the encoding of the parts of a concatenated message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestConcatenation
+(
+    void
+)
+{
+    // SMSC, first byte (with TP-UDHI), TP-MR, TP-DA, TP-PID, TP-DCS, TP-VP, TP-UDL, TP-UDH, then
+    // the two characters after a fill bit.
+    static const uint8_t expectedPdu[] =
+    {
+        0x00, 0x51, 0x00, 0x0B, 0x91, 0x33, 0x16, 0x32, 0x54, 0x76, 0xF8, 0x00, 0x00, 0xAD,
+        0x09, 0x05, 0x00, 0x03, 0x42, 0x02, 0x01, 0x90, 0x69
+    };
+    smsPdu_DataToEncode_t data;
+    pa_sms_Pdu_t pdu;
+
+    memset(&data, 0, sizeof(data));
+    data.protocol = PA_SMS_PROTOCOL_GSM;
+    data.messagePtr = (const uint8_t*)"Hi";
+    data.length = 2;
+    data.addressPtr = DEST;
+    data.encoding = SMSPDU_7_BITS;
+    data.messageType = PA_SMS_SUBMIT;
+    data.concatRef = 0x42;
+    data.concatCount = 2;
+    data.concatIndex = 1;
+    LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+    LE_ASSERT(pdu.dataLen == sizeof(expectedPdu));
+    LE_ASSERT(0 == memcmp(pdu.data, expectedPdu, sizeof(expectedPdu)));
+
+    // A part of 153 characters fits, not one more.
+    static uint8_t text[SMSPDU_CONCAT_7BITS_MAX_LENGTH + 1];
+    memset(text, 'a', sizeof(text));
+    data.messagePtr = text;
+    data.length = SMSPDU_CONCAT_7BITS_MAX_LENGTH;
+    LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+    LE_ASSERT(pdu.dataLen == 15 + LE_SMS_PDU_MAX_PAYLOAD);
+    LE_ASSERT(pdu.data[14] == 7 + SMSPDU_CONCAT_7BITS_MAX_LENGTH);
+    data.length = SMSPDU_CONCAT_7BITS_MAX_LENGTH + 1;
+    LE_ASSERT(LE_OK != smsPdu_Encode(&data, &pdu));
+
+    // A long text with escaped characters, sent in a batch.
+    char longText[LE_SMS_LONG_TEXT_MAX_BYTES];
+    size_t length = 0;
+    while (length < 700)
+    {
+        length += snprintf(&longText[length], sizeof(longText) - length,
+                           "Order {%zu} shipped [ok] ", length);
+    }
+
+    le_sms_BatchRef_t batchRef = le_sms_CreateBatch();
+    LE_ASSERT(batchRef != NULL);
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, longText));
+    SendAndWait(batchRef);
+    LE_ASSERT((2 == ResultSentCount) && (0 == ResultFailedCount));
+
+    // The short message is not concatenated.
+    const pa_sms_Pdu_t* pduPtr = paStub_GetPdu(0);
+    LE_ASSERT(pduPtr != NULL);
+    LE_ASSERT(0 == (pduPtr->data[1] & 0x40));
+    LE_ASSERT(pduPtr->data[14] == strlen(SHORT_TEXT));
+
+    // The parts of the long one have the same reference, and hold the text in order.
+    uint32_t partCount = 0;
+    size_t offset = 0;
+    while (offset < length)
+    {
+        size_t septetCount = 0;
+        while ((offset < length) &&
+               (septetCount + GetSeptetCount(longText[offset]) <= SMSPDU_CONCAT_7BITS_MAX_LENGTH))
+        {
+            septetCount += GetSeptetCount(longText[offset++]);
+        }
+        partCount++;
+
+        pduPtr = paStub_GetPdu(partCount);
+        LE_ASSERT(pduPtr != NULL);
+        LE_ASSERT(pduPtr->data[1] & 0x40);
+        LE_ASSERT(pduPtr->data[14] == 7 + septetCount);
+        LE_ASSERT(pduPtr->dataLen == 21 + (1 + 7 * septetCount + 7) / 8);
+        LE_ASSERT((0x05 == pduPtr->data[15]) && (0x00 == pduPtr->data[16]) &&
+                  (0x03 == pduPtr->data[17]));
+        LE_ASSERT(pduPtr->data[18] == paStub_GetPdu(1)->data[18]);
+        LE_ASSERT(pduPtr->data[20] == partCount);
+    }
+    LE_ASSERT(partCount >= 5);
+    for (offset = 1; offset <= partCount; offset++)
+    {
+        LE_ASSERT(paStub_GetPdu(offset)->data[19] == partCount);
+    }
+    LE_ASSERT(NULL == paStub_GetPdu(partCount + 1));
+
+    le_sms_DeleteBatch(batchRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the throughput of a batch with several submissions in flight.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestThroughput
+(
+    void
+)
+{
+    uint32_t submittedCount, inFlightCount, maxInFlightCount;
+    int32_t txCount, newTxCount;
+    le_sms_Status_t status;
+
+    le_sms_BatchRef_t batchRef = CreateBatch(THROUGHPUT_MSGS);
+
+    LE_ASSERT_OK(le_sms_GetCount(LE_SMS_TYPE_TX, &txCount));
+    uint64_t time = SendAndWait(batchRef);
+    LE_ASSERT_OK(le_sms_GetCount(LE_SMS_TYPE_TX, &newTxCount));
+
+    paStub_GetCounters(&submittedCount, &inFlightCount, &maxInFlightCount);
+    LE_INFO("%u in flight: %u messages in %" PRIu64 " ms (%.1f messages/s)",
+            THROUGHPUT_IN_FLIGHT, THROUGHPUT_MSGS, time, THROUGHPUT_MSGS * 1000.0 / time);
+
+    LE_ASSERT((THROUGHPUT_MSGS == ResultSentCount) && (0 == ResultFailedCount));
+    LE_ASSERT(THROUGHPUT_MSGS == submittedCount);
+    LE_ASSERT(0 == inFlightCount);
+    LE_ASSERT(THROUGHPUT_IN_FLIGHT == maxInFlightCount);
+    LE_ASSERT(newTxCount == txCount + THROUGHPUT_MSGS);
+    LE_ASSERT_OK(le_sms_GetBatchStatus(batchRef, THROUGHPUT_MSGS - 1, &status));
+    LE_ASSERT(LE_SMS_SENT == status);
+
+    // Sequential submissions would take the latency each.
+    LE_ASSERT(time * 2 < THROUGHPUT_MSGS * LATENCY);
+
+    le_sms_DeleteBatch(batchRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the sending results of several batches, counting them.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountingResultHandler
+(
+    le_sms_BatchRef_t batchRef,
+    uint32_t sentCount,
+    uint32_t failedCount,
+    void* contextPtr
+)
+{
+    uint32_t* countPtr = contextPtr;
+
+    LE_INFO("Batch %p: %u sent, %u failed", batchRef, sentCount, failedCount);
+    LE_ASSERT((THROUGHPUT_MSGS == sentCount) && (0 == failedCount));
+
+    (*countPtr)++;
+    IsResultReported = (2 == *countPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the batches sent at once share the submissions in flight.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestConcurrentBatches
+(
+    void
+)
+{
+    uint32_t submittedCount, inFlightCount, maxInFlightCount;
+    uint32_t resultCount = 0;
+
+    le_sms_BatchRef_t batchRef = CreateBatch(THROUGHPUT_MSGS);
+    le_sms_BatchRef_t otherBatchRef = CreateBatch(THROUGHPUT_MSGS);
+
+    paStub_Reset();
+    IsResultReported = false;
+    LE_ASSERT_OK(le_sms_SendBatch(batchRef, CountingResultHandler, &resultCount));
+    LE_ASSERT_OK(le_sms_SendBatch(otherBatchRef, CountingResultHandler, &resultCount));
+
+    ProcessEvents(RESULT_TIMEOUT, true);
+    LE_ASSERT(2 == resultCount);
+
+    paStub_GetCounters(&submittedCount, &inFlightCount, &maxInFlightCount);
+    LE_ASSERT(2 * THROUGHPUT_MSGS == submittedCount);
+    LE_ASSERT(THROUGHPUT_IN_FLIGHT == maxInFlightCount);
+
+    le_sms_DeleteBatch(batchRef);
+    le_sms_DeleteBatch(otherBatchRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the statuses of the messages of a batch, when their submissions fail.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStatuses
+(
+    void
+)
+{
+    static const le_sms_Status_t expectedStatuses[] =
+    {
+        LE_SMS_SENT, LE_SMS_SENDING_FAILED, LE_SMS_SENDING_TIMEOUT, LE_SMS_SENDING_FAILED,
+        LE_SMS_SENT
+    };
+    char longText[LE_SMS_TEXT_MAX_LEN * 2 + 1];
+    le_sms_Status_t status;
+    uint32_t i;
+
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+
+    le_sms_BatchRef_t batchRef = le_sms_CreateBatch();
+    LE_ASSERT(batchRef != NULL);
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, FAILED_DEST, SHORT_TEXT));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, TIMED_OUT_DEST, SHORT_TEXT));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, FAILED_DEST, longText));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, longText));
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(expectedStatuses); i++)
+    {
+        LE_ASSERT_OK(le_sms_GetBatchStatus(batchRef, i, &status));
+        LE_ASSERT(LE_SMS_UNSENT == status);
+    }
+
+    paStub_SetFailingDestinations(FAILED_DEST, TIMED_OUT_DEST);
+    SendAndWait(batchRef);
+    paStub_SetFailingDestinations(NULL, NULL);
+
+    LE_ASSERT((2 == ResultSentCount) && (3 == ResultFailedCount));
+    for (i = 0; i < NUM_ARRAY_MEMBERS(expectedStatuses); i++)
+    {
+        LE_ASSERT_OK(le_sms_GetBatchStatus(batchRef, i, &status));
+        LE_ASSERT(expectedStatuses[i] == status);
+    }
+    LE_ASSERT(LE_OUT_OF_RANGE == le_sms_GetBatchStatus(batchRef, i, &status));
+
+    le_sms_DeleteBatch(batchRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the error cases.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestErrors
+(
+    void
+)
+{
+    char longText[LE_SMS_TEXT_MAX_LEN + 2];
+    uint32_t i;
+
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+
+    // Empty batch, message or destination.
+    le_sms_BatchRef_t batchRef = le_sms_CreateBatch();
+    LE_ASSERT(batchRef != NULL);
+    LE_ASSERT(LE_BAD_PARAMETER == le_sms_SendBatch(batchRef, BatchResultHandler, NULL));
+    LE_ASSERT(LE_BAD_PARAMETER == le_sms_AddToBatch(batchRef, DEST, ""));
+    LE_ASSERT(LE_BAD_PARAMETER == le_sms_AddToBatch(batchRef, "", SHORT_TEXT));
+
+    // Full batch.
+    for (i = 0; i < LE_SMS_BATCH_MAX_MSGS; i++)
+    {
+        LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    }
+    LE_ASSERT(LE_OUT_OF_RANGE == le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    le_sms_DeleteBatch(batchRef);
+
+    // Batch already sent.
+    batchRef = CreateBatch(2);
+    SendAndWait(batchRef);
+    LE_ASSERT(LE_BUSY == le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    LE_ASSERT(LE_BUSY == le_sms_SendBatch(batchRef, BatchResultHandler, NULL));
+    le_sms_DeleteBatch(batchRef);
+
+    // No concatenated message over CDMA.
+    paStub_SetRat(LE_MRC_RAT_CDMA);
+    batchRef = le_sms_CreateBatch();
+    LE_ASSERT(batchRef != NULL);
+    LE_ASSERT(LE_UNSUPPORTED == le_sms_AddToBatch(batchRef, DEST, longText));
+    LE_ASSERT_OK(le_sms_AddToBatch(batchRef, DEST, SHORT_TEXT));
+    le_sms_DeleteBatch(batchRef);
+    paStub_SetRat(LE_MRC_RAT_GSM);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that a request using the platform adaptor alone is served while a batch is being sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestExclusiveAccess
+(
+    void
+)
+{
+    uint32_t submittedCount, inFlightCount, maxInFlightCount;
+    char smsc[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+
+    le_sms_BatchRef_t batchRef = CreateBatch(THROUGHPUT_MSGS);
+
+    paStub_Reset();
+    IsResultReported = false;
+    LE_ASSERT_OK(le_sms_SendBatch(batchRef, BatchResultHandler, NULL));
+    usleep(2 * LATENCY * 1000);
+
+    // Served once the submissions in flight are over, before the end of the batch.
+    LE_ASSERT_OK(le_sms_GetSmsCenterAddress(smsc, sizeof(smsc)));
+    paStub_GetCounters(&submittedCount, &inFlightCount, &maxInFlightCount);
+    LE_INFO("SMSC read after %u submissions", submittedCount);
+    LE_ASSERT(submittedCount < THROUGHPUT_MSGS);
+
+    ProcessEvents(RESULT_TIMEOUT, true);
+    LE_ASSERT(IsResultReported);
+    LE_ASSERT((THROUGHPUT_MSGS == ResultSentCount) && (0 == ResultFailedCount));
+
+    le_sms_DeleteBatch(batchRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the deletion of a batch being sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestDeletion
+(
+    void
+)
+{
+    uint32_t submittedCount, inFlightCount, maxInFlightCount;
+
+    le_sms_BatchRef_t batchRef = CreateBatch(THROUGHPUT_MSGS);
+
+    paStub_Reset();
+    IsResultReported = false;
+    LE_ASSERT_OK(le_sms_SendBatch(batchRef, BatchResultHandler, NULL));
+    usleep(LATENCY * 1000 + LATENCY * 1000 / 2);
+    le_sms_DeleteBatch(batchRef);
+
+    // The submissions in flight complete, and no result is reported.
+    ProcessEvents(4 * LATENCY, false);
+    paStub_GetCounters(&submittedCount, &inFlightCount, &maxInFlightCount);
+    LE_ASSERT(!IsResultReported);
+    LE_ASSERT(0 == inFlightCount);
+    LE_ASSERT(submittedCount <= 3 * THROUGHPUT_IN_FLIGHT);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread running the tests.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* TestThread
+(
+    void* contextPtr
+)
+{
+    paStub_SetLatency(0);
+
+    LE_INFO("======== Concatenation Test ========");
+    TestConcatenation();
+
+    paStub_SetLatency(LATENCY);
+
+    LE_INFO("======== Throughput Test ========");
+    TestThroughput();
+
+    LE_INFO("======== Concurrent Batches Test ========");
+    TestConcurrentBatches();
+
+    LE_INFO("======== Statuses Test ========");
+    TestStatuses();
+
+    LE_INFO("======== Errors Test ========");
+    TestErrors();
+
+    LE_INFO("======== Exclusive Access Test ========");
+    TestExclusiveAccess();
+
+    LE_INFO("======== Deletion Test ========");
+    TestDeletion();
+
+    LE_INFO("======== UnitTest of SMS batches ends with SUCCESS ========");
+    exit(EXIT_SUCCESS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    le_cfgSimu_SetIntNodeValue(NULL, CFG_NODE_BATCH_MAX_IN_FLIGHT, THROUGHPUT_IN_FLIGHT);
+    LE_ASSERT_OK(le_sms_Init());
+
+    le_thread_Start(le_thread_Create("SmsBatchTest", TestThread, NULL));
+}
@@ -0,0 +1,761 @@
+/**
+ * @file paStub.c
+ *
+ * Stub of the SMS platform adaptor, and of the other functions of the modem services used by
+ * le_sms, for the SMS unit tests.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_sms.h"
+#include "pa_sim.h"
+#include "paStub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type of address of an international number (cf. 3GPP TS 24.008 section 10.5.4.7).
+ */
+//--------------------------------------------------------------------------------------------------
+#define TYPE_OF_ADDRESS_INTERNATIONAL   0x91
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stub state, protected by Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t Latency;
+static char FailedDest[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+static char TimedOutDest[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+static le_mrc_Rat_t Rat = LE_MRC_RAT_GSM;
+static uint32_t SubmittedCount;
+static uint32_t InFlightCount;
+static uint32_t MaxInFlightCount;
+static pa_sms_Pdu_t Pdus[PA_STUB_MAX_PDUS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message of the simulated message storage.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool             isUsed;        ///< Is a message stored?
+    pa_sms_Storage_t storage;       ///< Storage.
+    uint32_t         index;         ///< Index in the storage.
+    pa_sms_Pdu_t     pdu;           ///< PDU, with its protocol and status.
+}
+StoredMsg_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulated message storage, and its handlers. Also protected by Mutex, which is not held while
+ * the handlers are called.
+ */
+//--------------------------------------------------------------------------------------------------
+static StoredMsg_t StoredMsgs[PA_STUB_MAX_STORED_MSGS];
+static uint32_t ListCount;
+static uint32_t ReadCount;
+static le_sim_States_t SimState = LE_SIM_READY;
+static pa_sms_NewMsgHdlrFunc_t NewMsgHandler;
+static pa_sms_StorageMsgHdlrFunc_t StorageHandler;
+static pa_sim_NewStateHdlrFunc_t SimStateHandler;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of the reported SIM states, which are reference-counted like those of a real platform
+ * adaptor: the handler gets its own reference, and must release it.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SimEventPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination of a SMS-SUBMIT PDU, starting with SMSC information.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetDestination
+(
+    const uint8_t* dataPtr,     ///< [IN] PDU.
+    char* destPtr,              ///< [OUT] Destination.
+    size_t destSize             ///< [IN] Size of the destination buffer.
+)
+{
+    // SMSC information, first byte, message reference, then the destination address.
+    uint8_t digitCount = dataPtr[3];
+    size_t pos = 0;
+    uint8_t i;
+
+    if ((TYPE_OF_ADDRESS_INTERNATIONAL == dataPtr[4]) && (pos + 1 < destSize))
+    {
+        destPtr[pos++] = '+';
+    }
+    for (i = 0; (i < digitCount) && (pos + 1 < destSize); i++)
+    {
+        uint8_t byte = dataPtr[5 + i / 2];
+        destPtr[pos++] = '0' + ((i % 2) ? (byte >> 4) : (byte & 0x0F));
+    }
+    destPtr[pos] = '\0';
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a stored message. Mutex must be held.
+ *
+ * @return The message, or NULL if there is no such message.
+ */
+//--------------------------------------------------------------------------------------------------
+static StoredMsg_t* FindStoredMsg
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    pa_sms_Protocol_t protocol, ///< [IN] Protocol.
+    uint32_t index              ///< [IN] Index in the storage.
+)
+{
+    size_t i;
+
+    for (i = 0; i < PA_STUB_MAX_STORED_MSGS; i++)
+    {
+        StoredMsg_t* msgPtr = &StoredMsgs[i];
+
+        if (msgPtr->isUsed && (msgPtr->storage == storage) && (msgPtr->index == index) &&
+            (msgPtr->pdu.protocol == protocol))
+        {
+            return msgPtr;
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the time a PDU submission takes, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetLatency
+(
+    uint32_t latency        ///< [IN] Submission time.
+)
+{
+    pthread_mutex_lock(&Mutex);
+    Latency = latency;
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the destinations whose submissions fail, and time out.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetFailingDestinations
+(
+    const char* failedDestPtr,      ///< [IN] Destination whose submissions fail (or NULL).
+    const char* timedOutDestPtr     ///< [IN] Destination whose submissions time out (or NULL).
+)
+{
+    pthread_mutex_lock(&Mutex);
+    le_utf8_Copy(FailedDest, failedDestPtr ? failedDestPtr : "", sizeof(FailedDest), NULL);
+    le_utf8_Copy(TimedOutDest, timedOutDestPtr ? timedOutDestPtr : "", sizeof(TimedOutDest), NULL);
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the radio access technology in use.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetRat
+(
+    le_mrc_Rat_t rat        ///< [IN] Radio access technology.
+)
+{
+    Rat = rat;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the submission counters, and forget the submitted PDUs.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_Reset
+(
+    void
+)
+{
+    pthread_mutex_lock(&Mutex);
+    SubmittedCount = 0;
+    MaxInFlightCount = InFlightCount;
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the submission counters.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetCounters
+(
+    uint32_t* submittedCountPtr,    ///< [OUT] Number of submissions started.
+    uint32_t* inFlightCountPtr,     ///< [OUT] Number of submissions in flight.
+    uint32_t* maxInFlightCountPtr   ///< [OUT] Maximum number of submissions in flight at once.
+)
+{
+    pthread_mutex_lock(&Mutex);
+    *submittedCountPtr = SubmittedCount;
+    *inFlightCountPtr = InFlightCount;
+    *maxInFlightCountPtr = MaxInFlightCount;
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a submitted PDU, in submission order.
+ *
+ * @return The PDU, or NULL if there is none of this index.
+ */
+//--------------------------------------------------------------------------------------------------
+const pa_sms_Pdu_t* paStub_GetPdu
+(
+    uint32_t index          ///< [IN] Index of the PDU.
+)
+{
+    const pa_sms_Pdu_t* pduPtr = NULL;
+
+    pthread_mutex_lock(&Mutex);
+    if ((index < SubmittedCount) && (index < PA_STUB_MAX_PDUS))
+    {
+        pduPtr = &Pdus[index];
+    }
+    pthread_mutex_unlock(&Mutex);
+
+    return pduPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the SIM state, and report it with a new SIM state notification.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetSimState
+(
+    le_sim_States_t state   ///< [IN] SIM state.
+)
+{
+    pa_sim_Event_t* eventPtr;
+    le_mem_PoolStats_t stats;
+
+    pthread_mutex_lock(&Mutex);
+    SimState = state;
+    pthread_mutex_unlock(&Mutex);
+
+    if (SimStateHandler != NULL)
+    {
+        // Report the state as the event loop does: the handler gets a new reference, and the
+        // reporter releases its own once the handler returns.
+        eventPtr = le_mem_ForceAlloc(SimEventPool);
+        eventPtr->simId = LE_SIM_EMBEDDED;
+        eventPtr->state = state;
+        le_mem_AddRef(eventPtr);
+        SimStateHandler(eventPtr);
+        le_mem_Release(eventPtr);
+
+        // The handler must have released its reference.
+        le_mem_GetStats(SimEventPool, &stats);
+        LE_ASSERT(0 == stats.numBlocksInUse);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a message, without a new message indication.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_StoreMessage
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    uint32_t index,             ///< [IN] Index in the storage.
+    const pa_sms_Pdu_t* pduPtr  ///< [IN] PDU, with its protocol and status.
+)
+{
+    size_t i;
+
+    pthread_mutex_lock(&Mutex);
+    StoredMsg_t* msgPtr = FindStoredMsg(storage, pduPtr->protocol, index);
+    for (i = 0; (NULL == msgPtr) && (i < PA_STUB_MAX_STORED_MSGS); i++)
+    {
+        if (!StoredMsgs[i].isUsed)
+        {
+            msgPtr = &StoredMsgs[i];
+        }
+    }
+    LE_ASSERT(msgPtr != NULL);
+
+    msgPtr->isUsed = true;
+    msgPtr->storage = storage;
+    msgPtr->index = index;
+    msgPtr->pdu = *pduPtr;
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a message, and report it with a new message indication.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReceiveMessage
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    uint32_t index,             ///< [IN] Index in the storage.
+    const pa_sms_Pdu_t* pduPtr  ///< [IN] PDU, with its protocol and status.
+)
+{
+    pa_sms_NewMessageIndication_t indication;
+
+    paStub_StoreMessage(storage, index, pduPtr);
+
+    memset(&indication, 0, sizeof(indication));
+    indication.msgIndex = index;
+    indication.protocol = pduPtr->protocol;
+    indication.storage = storage;
+
+    LE_ASSERT(NewMsgHandler != NULL);
+    NewMsgHandler(&indication);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a storage status indication (full storage).
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReportFullStorage
+(
+    pa_sms_Storage_t storage    ///< [IN] Storage.
+)
+{
+    pa_sms_StorageStatusInd_t indication = { .storage = storage };
+
+    LE_ASSERT(StorageHandler != NULL);
+    StorageHandler(&indication);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a stored message.
+ *
+ * @return The PDU, or NULL if there is no such message.
+ */
+//--------------------------------------------------------------------------------------------------
+const pa_sms_Pdu_t* paStub_GetStoredPdu
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    pa_sms_Protocol_t protocol, ///< [IN] Protocol.
+    uint32_t index              ///< [IN] Index in the storage.
+)
+{
+    pthread_mutex_lock(&Mutex);
+    StoredMsg_t* msgPtr = FindStoredMsg(storage, protocol, index);
+    pthread_mutex_unlock(&Mutex);
+
+    return msgPtr ? &msgPtr->pdu : NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the storage access counters.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetStorageCounters
+(
+    uint32_t* listCountPtr,     ///< [OUT] Number of listings of the storage.
+    uint32_t* readCountPtr      ///< [OUT] Number of messages read from the storage.
+)
+{
+    pthread_mutex_lock(&Mutex);
+    *listCountPtr = ListCount;
+    *readCountPtr = ReadCount;
+    pthread_mutex_unlock(&Mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a PDU: takes the stub's latency, and fails for the failing destinations.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t pa_sms_SendPduMsg
+(
+    pa_sms_Protocol_t        protocol,   ///< [IN] protocol to use
+    uint32_t                 length,     ///< [IN] The length of the TP data unit in bytes.
+    const uint8_t           *dataPtr,    ///< [IN] The message.
+    uint32_t                 timeout,    ///< [IN] Timeout in seconds.
+    pa_sms_SendingErrCode_t *errorCode   ///< [OUT] The error code.
+)
+{
+    char dest[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+    le_result_t result = LE_OK;
+    uint32_t latency;
+
+    LE_ASSERT(length <= LE_SMS_PDU_MAX_BYTES);
+    GetDestination(dataPtr, dest, sizeof(dest));
+
+    pthread_mutex_lock(&Mutex);
+    if (SubmittedCount < PA_STUB_MAX_PDUS)
+    {
+        Pdus[SubmittedCount].protocol = protocol;
+        Pdus[SubmittedCount].dataLen = length;
+        memcpy(Pdus[SubmittedCount].data, dataPtr, length);
+    }
+    SubmittedCount++;
+    if (++InFlightCount > MaxInFlightCount)
+    {
+        MaxInFlightCount = InFlightCount;
+    }
+    latency = Latency;
+    if (0 == strcmp(dest, FailedDest))
+    {
+        result = LE_FAULT;
+    }
+    else if (0 == strcmp(dest, TimedOutDest))
+    {
+        result = LE_TIMEOUT;
+    }
+    pthread_mutex_unlock(&Mutex);
+
+    usleep(latency * 1000);
+
+    pthread_mutex_lock(&Mutex);
+    InFlightCount--;
+    pthread_mutex_unlock(&Mutex);
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stubbed platform adaptor functions.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pa_sms_SetNewMsgHandler
+(
+    pa_sms_NewMsgHdlrFunc_t msgHandler
+)
+{
+    NewMsgHandler = msgHandler;
+    return LE_OK;
+}
+
+le_event_HandlerRef_t pa_sms_AddStorageStatusHandler
+(
+    pa_sms_StorageMsgHdlrFunc_t statusHandler
+)
+{
+    StorageHandler = statusHandler;
+    return (le_event_HandlerRef_t)1;
+}
+
+le_result_t pa_sms_SetPreferredStorage
+(
+    le_sms_Storage_t prefStorage
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_GetPreferredStorage
+(
+    le_sms_Storage_t* prefStoragePtr
+)
+{
+    *prefStoragePtr = LE_SMS_STORAGE_NV;
+    return LE_OK;
+}
+
+le_result_t pa_sms_RdPDUMsgFromMem
+(
+    uint32_t            index,
+    pa_sms_Protocol_t   protocol,
+    pa_sms_Storage_t    storage,
+    pa_sms_Pdu_t*       msgPtr
+)
+{
+    le_result_t result = LE_FAULT;
+
+    pthread_mutex_lock(&Mutex);
+    StoredMsg_t* storedMsgPtr = FindStoredMsg(storage, protocol, index);
+    if (storedMsgPtr)
+    {
+        *msgPtr = storedMsgPtr->pdu;
+        result = LE_OK;
+    }
+    ReadCount++;
+    pthread_mutex_unlock(&Mutex);
+
+    return result;
+}
+
+le_result_t pa_sms_ListMsgFromMem
+(
+    le_sms_Status_t     status,
+    pa_sms_Protocol_t   protocol,
+    uint32_t           *numPtr,
+    uint32_t           *idxPtr,
+    pa_sms_Storage_t    storage
+)
+{
+    size_t i;
+
+    *numPtr = 0;
+
+    pthread_mutex_lock(&Mutex);
+    for (i = 0; i < PA_STUB_MAX_STORED_MSGS; i++)
+    {
+        StoredMsg_t* storedMsgPtr = &StoredMsgs[i];
+
+        if (storedMsgPtr->isUsed && (storedMsgPtr->storage == storage) &&
+            (storedMsgPtr->pdu.protocol == protocol) && (storedMsgPtr->pdu.status == status))
+        {
+            idxPtr[(*numPtr)++] = storedMsgPtr->index;
+        }
+    }
+    ListCount++;
+    pthread_mutex_unlock(&Mutex);
+
+    return LE_OK;
+}
+
+le_result_t pa_sms_DelMsgFromMem
+(
+    uint32_t            index,
+    pa_sms_Protocol_t   protocol,
+    pa_sms_Storage_t    storage
+)
+{
+    le_result_t result = LE_FAULT;
+
+    pthread_mutex_lock(&Mutex);
+    StoredMsg_t* storedMsgPtr = FindStoredMsg(storage, protocol, index);
+    if (storedMsgPtr)
+    {
+        storedMsgPtr->isUsed = false;
+        result = LE_OK;
+    }
+    pthread_mutex_unlock(&Mutex);
+
+    return result;
+}
+
+le_result_t pa_sms_ChangeMessageStatus
+(
+    uint32_t            index,
+    pa_sms_Protocol_t   protocol,
+    le_sms_Status_t     status,
+    pa_sms_Storage_t    storage
+)
+{
+    le_result_t result = LE_FAULT;
+
+    pthread_mutex_lock(&Mutex);
+    StoredMsg_t* storedMsgPtr = FindStoredMsg(storage, protocol, index);
+    if (storedMsgPtr)
+    {
+        storedMsgPtr->pdu.status = status;
+        result = LE_OK;
+    }
+    pthread_mutex_unlock(&Mutex);
+
+    return result;
+}
+
+le_result_t pa_sms_GetSmsc
+(
+    char*        smscPtr,
+    size_t       len
+)
+{
+    return le_utf8_Copy(smscPtr, "+33123456789", len, NULL);
+}
+
+le_result_t pa_sms_SetSmsc
+(
+    const char*    smscPtr
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_ActivateCellBroadcast
+(
+    pa_sms_Protocol_t protocol
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_DeactivateCellBroadcast
+(
+    pa_sms_Protocol_t protocol
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_AddCellBroadcastIds
+(
+    uint16_t fromId,
+    uint16_t toId
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_RemoveCellBroadcastIds
+(
+    uint16_t fromId,
+    uint16_t toId
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_ClearCellBroadcastIds
+(
+    void
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_AddCdmaCellBroadcastServices
+(
+    le_sms_CdmaServiceCat_t serviceCat,
+    le_sms_Languages_t language
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_RemoveCdmaCellBroadcastServices
+(
+    le_sms_CdmaServiceCat_t serviceCat,
+    le_sms_Languages_t language
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sms_ClearCdmaCellBroadcastServices
+(
+    void
+)
+{
+    return LE_OK;
+}
+
+le_result_t pa_sim_GetState
+(
+    le_sim_States_t* statePtr
+)
+{
+    pthread_mutex_lock(&Mutex);
+    *statePtr = SimState;
+    pthread_mutex_unlock(&Mutex);
+    return LE_OK;
+}
+
+le_event_HandlerRef_t pa_sim_AddNewStateHandler
+(
+    pa_sim_NewStateHdlrFunc_t handler
+)
+{
+    if (SimEventPool == NULL)
+    {
+        SimEventPool = le_mem_CreatePool("PaStubSimEventPool", sizeof(pa_sim_Event_t));
+    }
+    SimStateHandler = handler;
+    return (le_event_HandlerRef_t)1;
+}
+
+le_result_t pa_sim_GetHomeNetworkMccMnc
+(
+    char     *mccPtr,
+    size_t    mccPtrSize,
+    char     *mncPtr,
+    size_t    mncPtrSize
+)
+{
+    le_utf8_Copy(mccPtr, "208", mccPtrSize, NULL);
+    le_utf8_Copy(mncPtr, "01", mncPtrSize, NULL);
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the radio access technology in use.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_mrc_GetRadioAccessTechInUse
+(
+    le_mrc_Rat_t*   ratPtr
+)
+{
+    *ratPtr = Rat;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client session reference for the current message
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_sms_GetClientSessionRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_sms_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registers a function to be called whenever one of this service's sessions is closed by
+ * the client.  (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t MyAddServiceCloseHandler
+(
+    le_msg_ServiceRef_t             serviceRef, ///< [in] Reference to the service.
+    le_msg_SessionEventHandler_t    handlerFunc,///< [in] Handler function.
+    void*                           contextPtr  ///< [in] Opaque pointer value to pass to handler.
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Begin monitoring the event loop on the current thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_wdogChain_MonitorEventLoop
+(
+    uint32_t watchdog,          ///< Watchdog to use for monitoring
+    le_clk_Time_t watchdogInterval ///< Interval at which to check event loop is functioning
+)
+{
+}
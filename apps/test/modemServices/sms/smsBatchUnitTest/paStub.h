@@ -0,0 +1,166 @@
+/**
+ * @file paStub.h
+ *
+ * Stub of the SMS platform adaptor for the SMS unit tests:
+ *  - the PDU submissions take a given time, and can be submitted concurrently,
+ *  - the message storage is simulated, and counts its accesses.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef PA_STUB_H_INCLUDE_GUARD
+#define PA_STUB_H_INCLUDE_GUARD
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_sms.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of submitted PDUs kept by the stub.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PA_STUB_MAX_PDUS    64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages of the simulated message storage.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PA_STUB_MAX_STORED_MSGS     512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the time a PDU submission takes, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetLatency
+(
+    uint32_t latency        ///< [IN] Submission time.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the destinations whose submissions fail, and time out.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetFailingDestinations
+(
+    const char* failedDestPtr,      ///< [IN] Destination whose submissions fail (or NULL).
+    const char* timedOutDestPtr     ///< [IN] Destination whose submissions time out (or NULL).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the radio access technology in use.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetRat
+(
+    le_mrc_Rat_t rat        ///< [IN] Radio access technology.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the submission counters, and forget the submitted PDUs.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_Reset
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the submission counters.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetCounters
+(
+    uint32_t* submittedCountPtr,    ///< [OUT] Number of submissions started.
+    uint32_t* inFlightCountPtr,     ///< [OUT] Number of submissions in flight.
+    uint32_t* maxInFlightCountPtr   ///< [OUT] Maximum number of submissions in flight at once.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a submitted PDU, in submission order.
+ *
+ * @return The PDU, or NULL if there is none of this index.
+ */
+//--------------------------------------------------------------------------------------------------
+const pa_sms_Pdu_t* paStub_GetPdu
+(
+    uint32_t index          ///< [IN] Index of the PDU.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the SIM state, and report it with a new SIM state notification.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_SetSimState
+(
+    le_sim_States_t state   ///< [IN] SIM state.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a message, without a new message indication.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_StoreMessage
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    uint32_t index,             ///< [IN] Index in the storage.
+    const pa_sms_Pdu_t* pduPtr  ///< [IN] PDU, with its protocol and status.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a message, and report it with a new message indication.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReceiveMessage
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    uint32_t index,             ///< [IN] Index in the storage.
+    const pa_sms_Pdu_t* pduPtr  ///< [IN] PDU, with its protocol and status.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a storage status indication (full storage).
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_ReportFullStorage
+(
+    pa_sms_Storage_t storage    ///< [IN] Storage.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a stored message.
+ *
+ * @return The PDU, or NULL if there is no such message.
+ */
+//--------------------------------------------------------------------------------------------------
+const pa_sms_Pdu_t* paStub_GetStoredPdu
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    pa_sms_Protocol_t protocol, ///< [IN] Protocol.
+    uint32_t index              ///< [IN] Index in the storage.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the storage access counters.
+ */
+//--------------------------------------------------------------------------------------------------
+void paStub_GetStorageCounters
+(
+    uint32_t* listCountPtr,     ///< [OUT] Number of listings of the storage.
+    uint32_t* readCountPtr      ///< [OUT] Number of messages read from the storage.
+);
+
+#endif // PA_STUB_H_INCLUDE_GUARD
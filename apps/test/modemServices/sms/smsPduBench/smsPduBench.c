@@ -0,0 +1,264 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * SMS PDU benchmark.
+ *
+ * Splits long text messages into parts of one PDU each, as a bulk SMS gateway does, then encodes
+ * each part into a SMS-SUBMIT PDU and decodes it back, in GSM 7-bit and in CDMA 7-bit:
+ *  - the GSM text mixes plain characters, characters of the GSM extension table (escaped) and
+ *    ISO-8859-1 accented characters,
+ *  - the CDMA text is its ASCII part.
+ *
+ * Each decoded part is checked against the original one. Each protocol reports the time it takes
+ * to encode and to decode a part.
+ *
+ * Usage: smsPduBench [messages] [parts]
+ *
+ *      messages    Number of messages encoded and decoded (default 10000).
+ *      parts       Number of parts of a message (default 8).
+ *
+ * The test passes if every part is decoded as it was encoded.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_sms.h"
+#include "smsPdu.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of characters of a part (7-bit characters of a PDU).
+ */
+//--------------------------------------------------------------------------------------------------
+#define PART_MAX_CHARS      160
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destination of the messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DESTINATION         "+33612345678"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentences of the messages, in turn (ISO-8859-1).
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* Sentences[] =
+{
+    "Your parcel {ref 4711} is on its way, track it at example.com/t?id=[4711]. ",
+    "Caf\xE9 cr\xE8me \xE0 2\xA3 ou 3\xA5, \xA7 4 | ~50% off ^^ \\o/ ",
+    "Se\xF1or M\xFCller, \xC4rger \xFC" "ber Gr\xFC\xDF" "e: O\xF9 est l'\xE9t\xE9? ",
+    "Reply STOP to unsubscribe, HELP for help. Msg&data rates may apply. ",
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Part of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t text[PART_MAX_CHARS];   ///< Characters of the part.
+    size_t  length;                 ///< Number of characters.
+}
+Part_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of GSM 7-bit characters a character is encoded into.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetSeptetCount
+(
+    uint8_t c
+)
+{
+    // Characters of the extension table are escaped.
+    return ((c != '\0') && (strchr("\f^{}\\[~]|", c) != NULL)) ? 2 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a message from the sentences, and split it into parts of one PDU each.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeParts
+(
+    Part_t* partsPtr,       ///< Parts.
+    size_t partCount,       ///< Number of parts.
+    bool isAscii            ///< true to keep the ASCII characters only.
+)
+{
+    size_t sentenceIndex = 0;
+    size_t charIndex = 0;
+    size_t i;
+
+    for (i = 0; i < partCount; i++)
+    {
+        Part_t* partPtr = &partsPtr[i];
+        size_t septetCount = 0;
+
+        partPtr->length = 0;
+        while (partPtr->length < PART_MAX_CHARS)
+        {
+            const char* sentencePtr = Sentences[sentenceIndex];
+            uint8_t c = sentencePtr[charIndex];
+
+            if (c == '\0')
+            {
+                sentenceIndex = (sentenceIndex + 1) % NUM_ARRAY_MEMBERS(Sentences);
+                charIndex = 0;
+                continue;
+            }
+            if (isAscii && (c >= 128))
+            {
+                charIndex++;
+                continue;
+            }
+
+            size_t count = isAscii ? 1 : GetSeptetCount(c);
+            if (septetCount + count > PART_MAX_CHARS)
+            {
+                break;
+            }
+
+            partPtr->text[partPtr->length++] = c;
+            septetCount += count;
+            charIndex++;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode and decode messages, and check the decoded parts.
+ *
+ * @return true if every part is decoded as it was encoded.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool Run
+(
+    const char* namePtr,            ///< Name of the protocol.
+    pa_sms_Protocol_t protocol,     ///< Protocol.
+    const Part_t* partsPtr,         ///< Parts of a message.
+    size_t partCount,               ///< Number of parts.
+    uint64_t messageCount           ///< Number of messages.
+)
+{
+    static pa_sms_Message_t message;
+    pa_sms_Pdu_t pdu;
+    smsPdu_DataToEncode_t data;
+    struct timespec start, end;
+    uint64_t encodeNs = 0;
+    uint64_t decodeNs = 0;
+    uint64_t errorCount = 0;
+    uint64_t m;
+    size_t i;
+
+    for (m = 0; m < messageCount; m++)
+    {
+        for (i = 0; i < partCount; i++)
+        {
+            memset(&data, 0, sizeof(data));
+            data.protocol = protocol;
+            data.messagePtr = partsPtr[i].text;
+            data.length = partsPtr[i].length;
+            data.addressPtr = DESTINATION;
+            data.encoding = SMSPDU_7_BITS;
+            data.messageType = PA_SMS_SUBMIT;
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            le_result_t result = smsPdu_Encode(&data, &pdu);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            encodeNs += (end.tv_sec - start.tv_sec) * 1000000000LL +
+                        (end.tv_nsec - start.tv_nsec);
+
+            if (LE_OK == result)
+            {
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                result = smsPdu_Decode(protocol, pdu.data, pdu.dataLen, true, &message);
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                decodeNs += (end.tv_sec - start.tv_sec) * 1000000000LL +
+                            (end.tv_nsec - start.tv_nsec);
+            }
+
+            if ((LE_OK != result) ||
+                (PA_SMS_SUBMIT != message.type) ||
+                (LE_SMS_FORMAT_TEXT != message.smsSubmit.format) ||
+                (message.smsSubmit.dataLen != partsPtr[i].length) ||
+                (memcmp(message.smsSubmit.data, partsPtr[i].text, partsPtr[i].length) != 0))
+            {
+                if (errorCount == 0)
+                {
+                    LE_ERROR("%s: part %zu: result %d, length %u/%zu", namePtr, i, result,
+                             message.smsSubmit.dataLen, partsPtr[i].length);
+                }
+                errorCount++;
+            }
+        }
+    }
+
+    uint64_t count = messageCount * partCount;
+    LE_INFO("%s: %" PRIu64 " parts: encode %.1f ns/part, decode %.1f ns/part",
+            namePtr, count, (double)encodeNs / count, (double)decodeNs / count);
+
+    if (errorCount != 0)
+    {
+        LE_ERROR("FAIL: %s: %" PRIu64 " bad parts", namePtr, errorCount);
+        return false;
+    }
+
+    return true;
+}
+
+
+COMPONENT_INIT
+{
+    uint64_t messageCount = GetArg(0, 10000);
+    size_t partCount = GetArg(1, 8);
+    Part_t* partsPtr = calloc(partCount, sizeof(Part_t));
+    bool isPassed;
+
+    LE_ASSERT(partsPtr != NULL);
+    smsPdu_Initialize();
+
+    MakeParts(partsPtr, partCount, false);
+    isPassed = Run("GSM", PA_SMS_PROTOCOL_GSM, partsPtr, partCount, messageCount);
+
+    MakeParts(partsPtr, partCount, true);
+    isPassed = Run("CDMA", PA_SMS_PROTOCOL_CDMA, partsPtr, partCount, messageCount) && isPassed;
+
+    free(partsPtr);
+
+    if (!isPassed)
+    {
+        LE_ERROR("FAIL");
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
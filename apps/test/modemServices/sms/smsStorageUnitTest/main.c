@@ -0,0 +1,511 @@
+/**
+ * This module implements the unit tests of the index of the stored messages of le_sms, over a stub
+ * of the platform adaptor simulating the message storage (see paStub.h):
+ *  - the first listing reads the storage, the next ones don't,
+ *  - the index follows the new message indications, the status changes and the deletions,
+ *  - the index is built again after a storage indication, and when the SIM state changes,
+ *  - time of a listing, with and without the index,
+ *  - the ISO-8859-1 text of a received message goes through the packing of the IPC stubs.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pa_sms.h"
+#include "smsPdu.h"
+#include "le_sms_local.h"
+#include "paStub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sender of the messages.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SENDER              "+33612345678"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages stored for the listing time test, and number of listings.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIMING_MSGS         200
+#define TIMING_LISTINGS     100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type of address of an international number (cf. 3GPP TS 24.008 section 10.5.4.7).
+ */
+//--------------------------------------------------------------------------------------------------
+#define TYPE_OF_ADDRESS_INTERNATIONAL   0x91
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetTimeUs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (uint64_t)now.sec * 1000000 + now.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make the SMS-DELIVER PDU of a text message in GSM 7-bit, without SMSC address.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeDeliverPdu
+(
+    pa_sms_Pdu_t* pduPtr,       ///< [OUT] PDU.
+    const char* text,           ///< [IN] Text, in the GSM 7-bit default alphabet.
+    le_sms_Status_t status      ///< [IN] Status of the message.
+)
+{
+    // Service center time stamp: 18/10/26 12:34:56 GMT.
+    static const uint8_t scts[] = { 0x81, 0x01, 0x62, 0x21, 0x43, 0x65, 0x00 };
+    const char* senderPtr = SENDER + 1;
+    size_t senderLen = strlen(senderPtr);
+    size_t textLen = strlen(text);
+    size_t pos = 0;
+    size_t i;
+
+    memset(pduPtr, 0, sizeof(pa_sms_Pdu_t));
+    pduPtr->protocol = PA_SMS_PROTOCOL_GSM;
+    pduPtr->status = status;
+
+    pduPtr->data[pos++] = 0x00;                             // No SMSC address.
+    pduPtr->data[pos++] = 0x04;                             // SMS-DELIVER, no more messages.
+    pduPtr->data[pos++] = senderLen;                        // TP-OA.
+    pduPtr->data[pos++] = TYPE_OF_ADDRESS_INTERNATIONAL;
+    for (i = 0; i < senderLen; i += 2)
+    {
+        uint8_t high = (i + 1 < senderLen) ? (senderPtr[i + 1] - '0') : 0x0F;
+        pduPtr->data[pos++] = (high << 4) | (senderPtr[i] - '0');
+    }
+    pduPtr->data[pos++] = 0x00;                             // TP-PID.
+    pduPtr->data[pos++] = 0x00;                             // TP-DCS: GSM 7-bit.
+    memcpy(&pduPtr->data[pos], scts, sizeof(scts));         // TP-SCTS.
+    pos += sizeof(scts);
+    pduPtr->data[pos++] = textLen;                          // TP-UDL, in characters.
+
+    // Letters, digits and space have the same code in ASCII and in the GSM 7-bit alphabet.
+    for (i = 0; i < textLen; i++)
+    {
+        size_t bit = i * 7;
+        pduPtr->data[pos + bit / 8] |= (uint8_t)(text[i] << (bit % 8));
+        if (bit % 8 > 1)
+        {
+            pduPtr->data[pos + bit / 8 + 1] |= (uint8_t)(text[i] >> (8 - bit % 8));
+        }
+    }
+    pduPtr->dataLen = pos + (textLen * 7 + 7) / 8;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a SMS-DELIVER message "Message <number>", without a new message indication.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StoreMessage
+(
+    pa_sms_Storage_t storage,   ///< [IN] Storage.
+    uint32_t index,             ///< [IN] Index in the storage.
+    uint32_t number,            ///< [IN] Number of the message.
+    le_sms_Status_t status      ///< [IN] Status of the message.
+)
+{
+    pa_sms_Pdu_t pdu;
+    char text[32];
+
+    snprintf(text, sizeof(text), "Message %" PRIu32, number);
+    MakeDeliverPdu(&pdu, text, status);
+    paStub_StoreMessage(storage, index, &pdu);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of storage listings and of messages read since the last call.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetStorageAccesses
+(
+    uint32_t* listCountPtr,     ///< [OUT] Number of listings.
+    uint32_t* readCountPtr      ///< [OUT] Number of messages read.
+)
+{
+    static uint32_t LastListCount;
+    static uint32_t LastReadCount;
+    uint32_t listCount, readCount;
+
+    paStub_GetStorageCounters(&listCount, &readCount);
+    *listCountPtr = listCount - LastListCount;
+    *readCountPtr = readCount - LastReadCount;
+    LastListCount = listCount;
+    LastReadCount = readCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a message in a list, and check its content.
+ *
+ * @return The message, or NULL if it is not in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_MsgRef_t FindMessage
+(
+    le_sms_MsgListRef_t listRef,    ///< [IN] The list.
+    uint32_t number                 ///< [IN] Number of the message.
+)
+{
+    char expectedText[32];
+    char text[LE_SMS_TEXT_MAX_BYTES];
+    char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
+    char timestamp[LE_SMS_TIMESTAMP_MAX_BYTES];
+    le_sms_MsgRef_t msgRef;
+
+    snprintf(expectedText, sizeof(expectedText), "Message %" PRIu32, number);
+
+    for (msgRef = le_sms_GetFirst(listRef); msgRef != NULL; msgRef = le_sms_GetNext(listRef))
+    {
+        LE_ASSERT(LE_SMS_TYPE_RX == le_sms_GetType(msgRef));
+        LE_ASSERT(LE_SMS_FORMAT_TEXT == le_sms_GetFormat(msgRef));
+        LE_ASSERT_OK(le_sms_GetText(msgRef, text, sizeof(text)));
+        if (0 == strcmp(text, expectedText))
+        {
+            LE_ASSERT(strlen(expectedText) == le_sms_GetUserdataLen(msgRef));
+            LE_ASSERT_OK(le_sms_GetSenderTel(msgRef, tel, sizeof(tel)));
+            LE_ASSERT(0 == strcmp(tel, SENDER));
+            LE_ASSERT_OK(le_sms_GetTimeStamp(msgRef, timestamp, sizeof(timestamp)));
+            return msgRef;
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of messages of a list.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetMessageCount
+(
+    le_sms_MsgListRef_t listRef     ///< [IN] The list.
+)
+{
+    uint32_t count = 0;
+    le_sms_MsgRef_t msgRef;
+
+    for (msgRef = le_sms_GetFirst(listRef); msgRef != NULL; msgRef = le_sms_GetNext(listRef))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the first listing reads the storage, and the next ones don't.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestIndex
+(
+    void
+)
+{
+    uint32_t listCount, readCount;
+    smsPdu_DataToEncode_t data;
+    pa_sms_Pdu_t pdu;
+    uint32_t i;
+    int pass;
+
+    // Received messages in the SIM and in the memory, and a SMS-SUBMIT which is not listed.
+    for (i = 0; i < 3; i++)
+    {
+        StoreMessage(PA_SMS_STORAGE_SIM, i, i, LE_SMS_RX_UNREAD);
+    }
+    StoreMessage(PA_SMS_STORAGE_NV, 0, 3, LE_SMS_RX_READ);
+    StoreMessage(PA_SMS_STORAGE_NV, 1, 4, LE_SMS_RX_READ);
+
+    memset(&data, 0, sizeof(data));
+    data.protocol = PA_SMS_PROTOCOL_GSM;
+    data.messagePtr = (const uint8_t*)"Sent";
+    data.length = 4;
+    data.addressPtr = SENDER;
+    data.encoding = SMSPDU_7_BITS;
+    data.messageType = PA_SMS_SUBMIT;
+    LE_ASSERT_OK(smsPdu_Encode(&data, &pdu));
+    pdu.status = LE_SMS_RX_READ;
+    paStub_StoreMessage(PA_SMS_STORAGE_SIM, 3, &pdu);
+
+    GetStorageAccesses(&listCount, &readCount);
+    for (pass = 0; pass < 2; pass++)
+    {
+        le_sms_MsgListRef_t listRef = le_sms_CreateRxMsgList();
+        LE_ASSERT(listRef != NULL);
+
+        // The first listing reads each stored message once.
+        GetStorageAccesses(&listCount, &readCount);
+        LE_INFO("Listing %d: %u storage listings, %u messages read", pass, listCount, readCount);
+        LE_ASSERT(((0 == pass) && (listCount > 0) && (6 == readCount)) ||
+                  ((1 == pass) && (0 == listCount) && (0 == readCount)));
+
+        LE_ASSERT(5 == GetMessageCount(listRef));
+        for (i = 0; i < 5; i++)
+        {
+            le_sms_MsgRef_t msgRef = FindMessage(listRef, i);
+            LE_ASSERT(msgRef != NULL);
+            LE_ASSERT(le_sms_GetStatus(msgRef) == ((i < 3) ? LE_SMS_RX_UNREAD : LE_SMS_RX_READ));
+        }
+
+        le_sms_DeleteList(listRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the index follows the new message indications, the status changes and the deletions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestUpdates
+(
+    void
+)
+{
+    uint32_t listCount, readCount;
+    le_sms_MsgListRef_t listRef;
+    le_sms_MsgRef_t msgRef;
+    pa_sms_Pdu_t pdu;
+
+    // New message: read once by the indication handler.
+    MakeDeliverPdu(&pdu, "Message 10", LE_SMS_RX_UNREAD);
+    paStub_ReceiveMessage(PA_SMS_STORAGE_SIM, 10, &pdu);
+
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((0 == listCount) && (1 == readCount));
+    LE_ASSERT(6 == GetMessageCount(listRef));
+
+    // Status change.
+    msgRef = FindMessage(listRef, 10);
+    LE_ASSERT(msgRef != NULL);
+    LE_ASSERT(LE_SMS_RX_UNREAD == le_sms_GetStatus(msgRef));
+    le_sms_MarkRead(msgRef);
+    LE_ASSERT(LE_SMS_RX_READ == paStub_GetStoredPdu(PA_SMS_STORAGE_SIM,
+                                                    PA_SMS_PROTOCOL_GSM, 10)->status);
+
+    // Deletion.
+    msgRef = FindMessage(listRef, 0);
+    LE_ASSERT(msgRef != NULL);
+    LE_ASSERT_OK(le_sms_DeleteFromStorage(msgRef));
+    LE_ASSERT(NULL == paStub_GetStoredPdu(PA_SMS_STORAGE_SIM, PA_SMS_PROTOCOL_GSM, 0));
+    le_sms_DeleteList(listRef);
+
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    LE_ASSERT(5 == GetMessageCount(listRef));
+    LE_ASSERT(NULL == FindMessage(listRef, 0));
+    msgRef = FindMessage(listRef, 10);
+    LE_ASSERT(msgRef != NULL);
+    LE_ASSERT(LE_SMS_RX_READ == le_sms_GetStatus(msgRef));
+    le_sms_DeleteList(listRef);
+
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((0 == listCount) && (0 == readCount));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the index is built again after a storage indication, and when the SIM state changes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestInvalidation
+(
+    void
+)
+{
+    uint32_t listCount, readCount;
+    le_sms_MsgListRef_t listRef;
+
+    // A message stored without indication is listed after a storage indication. The storage is
+    // read again: 6 received messages and the SMS-SUBMIT.
+    StoreMessage(PA_SMS_STORAGE_NV, 20, 20, LE_SMS_RX_UNREAD);
+    paStub_ReportFullStorage(PA_SMS_STORAGE_NV);
+
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((listCount > 0) && (7 == readCount));
+    LE_ASSERT(6 == GetMessageCount(listRef));
+    LE_ASSERT(NULL != FindMessage(listRef, 20));
+    le_sms_DeleteList(listRef);
+
+    // Without a SIM, the GSM messages are not listed.
+    paStub_SetSimState(LE_SIM_ABSENT);
+    LE_ASSERT(NULL == le_sms_CreateRxMsgList());
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((listCount > 0) && (0 == readCount));
+
+    paStub_SetSimState(LE_SIM_READY);
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((listCount > 0) && (7 == readCount));
+    LE_ASSERT(6 == GetMessageCount(listRef));
+    le_sms_DeleteList(listRef);
+
+    // A SIM swapped between two listings, without indication of its messages: the SIM state
+    // changes and is ready again at the next listing, which reads the storage again. The new SIM
+    // holds another message at the index of message 10.
+    paStub_SetSimState(LE_SIM_ABSENT);
+    StoreMessage(PA_SMS_STORAGE_SIM, 10, 30, LE_SMS_RX_UNREAD);
+    paStub_SetSimState(LE_SIM_READY);
+
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((listCount > 0) && (7 == readCount));
+    LE_ASSERT(6 == GetMessageCount(listRef));
+    LE_ASSERT(NULL == FindMessage(listRef, 10));
+    LE_ASSERT(NULL != FindMessage(listRef, 30));
+    le_sms_DeleteList(listRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure the time of a listing, with and without the index.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestListingTime
+(
+    void
+)
+{
+    uint32_t listCount, readCount;
+    le_sms_MsgListRef_t listRef;
+    uint64_t startTime, buildTime, listTime;
+    uint32_t i;
+
+    for (i = 0; i < TIMING_MSGS; i++)
+    {
+        StoreMessage(PA_SMS_STORAGE_NV, 100 + i, 100 + i, LE_SMS_RX_READ);
+    }
+    paStub_ReportFullStorage(PA_SMS_STORAGE_NV);
+    GetStorageAccesses(&listCount, &readCount);
+
+    // First listing, which builds the index.
+    startTime = GetTimeUs();
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    LE_ASSERT(TIMING_MSGS + 6 == GetMessageCount(listRef));
+    le_sms_DeleteList(listRef);
+    buildTime = GetTimeUs() - startTime;
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT(TIMING_MSGS + 7 == readCount);
+
+    // Next listings.
+    startTime = GetTimeUs();
+    for (i = 0; i < TIMING_LISTINGS; i++)
+    {
+        listRef = le_sms_CreateRxMsgList();
+        LE_ASSERT(listRef != NULL);
+        LE_ASSERT(TIMING_MSGS + 6 == GetMessageCount(listRef));
+        le_sms_DeleteList(listRef);
+    }
+    listTime = (GetTimeUs() - startTime) / TIMING_LISTINGS;
+    GetStorageAccesses(&listCount, &readCount);
+    LE_ASSERT((0 == listCount) && (0 == readCount));
+
+    LE_INFO("Listing of %u messages: %" PRIu64 " us to build the index, then %" PRIu64 " us",
+            TIMING_MSGS + 6, buildTime, listTime);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test that the text of a received message with accented letters, which le_sms_GetText() returns
+ * in ISO-8859-1 and not in UTF-8, gets through the packing and unpacking of the text parameter by
+ * the server and client stubs of le_sms.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestLatin1Text
+(
+    void
+)
+{
+    // "M\u00FCller: \u00F6l \u00E0 5" in the GSM 7-bit default alphabet, and in ISO-8859-1.
+    static const char gsmText[] = "M\x7Eller: \x7Cl \x7F 5";
+    static const char latin1Text[] = "M\xFCller: \xF6l \xE0 5";
+    char text[LE_SMS_TEXT_MAX_BYTES];
+    char unpackedText[LE_SMS_TEXT_MAX_BYTES];
+    uint8_t buffer[sizeof(uint32_t) + LE_SMS_TEXT_MAX_LEN];
+    uint8_t* bufferPtr = buffer;
+    size_t bufferSize = sizeof(buffer);
+    le_sms_MsgListRef_t listRef;
+    le_sms_MsgRef_t msgRef;
+    pa_sms_Pdu_t pdu;
+
+    MakeDeliverPdu(&pdu, gsmText, LE_SMS_RX_UNREAD);
+    paStub_StoreMessage(PA_SMS_STORAGE_NV, 400, &pdu);
+    paStub_ReportFullStorage(PA_SMS_STORAGE_NV);
+
+    listRef = le_sms_CreateRxMsgList();
+    LE_ASSERT(listRef != NULL);
+    for (msgRef = le_sms_GetFirst(listRef); msgRef != NULL; msgRef = le_sms_GetNext(listRef))
+    {
+        LE_ASSERT_OK(le_sms_GetText(msgRef, text, sizeof(text)));
+        if (0 == strcmp(text, latin1Text))
+        {
+            break;
+        }
+    }
+    LE_ASSERT(msgRef != NULL);
+    LE_ASSERT(!le_utf8_IsFormatCorrect(text));
+
+    // Server side: text is packed in the response of le_sms_GetText().
+    LE_ASSERT(le_pack_PackString(&bufferPtr, &bufferSize, text, LE_SMS_TEXT_MAX_LEN));
+
+    // Client side: text is unpacked from the response, unchanged.
+    bufferPtr = buffer;
+    bufferSize = sizeof(buffer);
+    LE_ASSERT(le_pack_UnpackString(&bufferPtr, &bufferSize, unpackedText, sizeof(unpackedText),
+                                   LE_SMS_TEXT_MAX_LEN));
+    LE_ASSERT(0 == strcmp(unpackedText, latin1Text));
+
+    le_sms_DeleteList(listRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    LE_ASSERT_OK(le_sms_Init());
+
+    LE_INFO("======== Index Test ========");
+    TestIndex();
+
+    LE_INFO("======== Updates Test ========");
+    TestUpdates();
+
+    LE_INFO("======== Invalidation Test ========");
+    TestInvalidation();
+
+    LE_INFO("======== Listing Time Test ========");
+    TestListingTime();
+
+    LE_INFO("======== ISO-8859-1 Text Test ========");
+    TestLatin1Text();
+
+    LE_INFO("======== UnitTest of SMS storage index ends with SUCCESS ========");
+    exit(EXIT_SUCCESS);
+}
@@ -26,6 +26,7 @@ static int32_t RxMessageCount = 0;
 static int32_t TxMessageCount = 0;
 static int32_t RxCbMessageCount = 0;
 static bool StatusReportActivation = false;
+static int32_t BatchMaxInFlight = 1;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -160,6 +161,10 @@ void le_cfgSimu_SetIntNodeValue
     {
         RxCbMessageCount = value;
     }
+    else if (0 == strcmp(path, CFG_NODE_BATCH_MAX_IN_FLIGHT))
+    {
+        BatchMaxInFlight = value;
+    }
     else
     {
         LE_ERROR("Unsupported path '%s'", path);
@@ -234,6 +239,19 @@ int32_t le_cfg_GetInt
     {
         value = RxCbMessageCount;
     }
+    else if (0 == strcmp(path, CFG_NODE_STATS_FLUSH_PERIOD))
+    {
+        // No timed save of the message counters, so that the test knows when they are saved.
+        value = 0;
+    }
+    else if (0 == strcmp(path, CFG_NODE_STATS_FLUSH_THRESHOLD))
+    {
+        value = defaultValue;
+    }
+    else if (0 == strcmp(path, CFG_NODE_BATCH_MAX_IN_FLIGHT))
+    {
+        value = BatchMaxInFlight;
+    }
     else
     {
         value = defaultValue;
@@ -13,6 +13,8 @@
 #include "time.h"
 #include "le_sms_local.h"
 #include "pa_sms_simu.h"
+#include "mdmCfgEntries.h"
+#include "persistentCounter.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -1294,6 +1296,16 @@ static void Testle_sms_Statistics
     expected.tx++;
     GetAndCheckSmsCounters(&count, &expected);
 
+    // The counters are saved in batches: the last reset is the only save so far
+    LE_ASSERT(0 == le_cfg_GetInt(NULL, CFG_NODE_TX_COUNT, -1));
+    LE_ASSERT(0 == le_cfg_GetInt(NULL, CFG_NODE_RX_COUNT, -1));
+
+    // Saving all the groups, as the SIGTERM handler of modemDaemon does, saves the last changes
+    persistentCounter_FlushAll();
+    LE_ASSERT(expected.tx == le_cfg_GetInt(NULL, CFG_NODE_TX_COUNT, -1));
+    LE_ASSERT(expected.rx == le_cfg_GetInt(NULL, CFG_NODE_RX_COUNT, -1));
+    LE_ASSERT(expected.rxCb == le_cfg_GetInt(NULL, CFG_NODE_RX_CB_COUNT, -1));
+
     // Reset counters
     le_sms_ResetCount();
 
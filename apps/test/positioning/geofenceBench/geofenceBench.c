@@ -0,0 +1,417 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence engine benchmark.
+ *
+ * Replays the $GPRMC fixes of an NMEA file (e.g. posDaemonTest/gnss_nmea.txt), with intermediate
+ * positions interpolated between them, against made-up circular and polygonal fences (a few along
+ * the track, the others scattered around it), first with geofence_Update() then by testing every
+ * fence with geofence_Contains() for each position, and reports the time each one took.
+ *
+ * Usage: geofenceBench nmeaFile [fences [rounds]]
+ *
+ *      nmeaFile    NMEA file to read the track from.
+ *      fences      Number of fences (default 1000).
+ *      rounds      Number of times the track is replayed, for each method (default 20).
+ *
+ * The test passes if both methods find the same transitions.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "geofence.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of fixes read from the NMEA file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_FIXES               1000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of positions interpolated from each fix to the next one.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STEPS_PER_FIX           100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One fence in this many is placed along the track, the others are scattered around it.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_FENCE_RATIO       10
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Distance from the track of the scattered fences, and of the track fences (1e-6 degree).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SCATTER_SPAN            500000
+#define TRACK_SPAN              1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Track positions (1e-6 degree).
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t* Latitudes;
+static int32_t* Longitudes;
+static size_t PositionCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fences, and whether the current position is inside each one, for the brute force method.
+ */
+//--------------------------------------------------------------------------------------------------
+static geofence_Fence_t** Fences;
+static bool* IsInside;
+static size_t FenceCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of transitions found by the current method, and a checksum of them which does not depend
+ * on the order they are found for a given position.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t TransitionCount;
+static uint64_t TransitionSum;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index of the current position.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t PositionIndex;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert an NMEA coordinate ([d]ddmm.mmmm and hemisphere) to 1e-6 degree.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t ParseCoordinate
+(
+    const char* valuePtr,
+    const char* hemispherePtr
+)
+{
+    double value = strtod(valuePtr, NULL);
+    double degrees = (double)(int32_t)(value / 100);
+    double coordinate = (degrees + ((value - (degrees * 100)) / 60)) * 1000000.0;
+
+    if ((hemispherePtr[0] == 'S') || (hemispherePtr[0] == 'W'))
+    {
+        coordinate = -coordinate;
+    }
+
+    return (int32_t)lround(coordinate);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the track from the $GPRMC sentences of an NMEA file, and interpolate it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadTrack
+(
+    const char* pathPtr
+)
+{
+    static int32_t fixLatitudes[MAX_FIXES];
+    static int32_t fixLongitudes[MAX_FIXES];
+    size_t fixCount = 0;
+    char line[256];
+    size_t i, step;
+
+    FILE* filePtr = fopen(pathPtr, "r");
+    LE_FATAL_IF(filePtr == NULL, "Can't open '%s' (%m).", pathPtr);
+
+    while ((fixCount < MAX_FIXES) && (fgets(line, sizeof(line), filePtr) != NULL))
+    {
+        // $GPRMC,time,status,latitude,N/S,longitude,E/W,...
+        char* fields[7];
+        char* savePtr = NULL;
+        char* fieldPtr = strtok_r(line, ",", &savePtr);
+        size_t count = 0;
+
+        while ((fieldPtr != NULL) && (count < NUM_ARRAY_MEMBERS(fields)))
+        {
+            fields[count++] = fieldPtr;
+            fieldPtr = strtok_r(NULL, ",", &savePtr);
+        }
+
+        if ((count == NUM_ARRAY_MEMBERS(fields)) && (strcmp(fields[0], "$GPRMC") == 0) &&
+            (fields[2][0] == 'A'))
+        {
+            fixLatitudes[fixCount] = ParseCoordinate(fields[3], fields[4]);
+            fixLongitudes[fixCount] = ParseCoordinate(fields[5], fields[6]);
+            fixCount++;
+        }
+    }
+    fclose(filePtr);
+
+    LE_FATAL_IF(fixCount < 2, "Less than 2 fixes in '%s'.", pathPtr);
+
+    PositionCount = (fixCount - 1) * STEPS_PER_FIX;
+    Latitudes = calloc(PositionCount, sizeof(int32_t));
+    Longitudes = calloc(PositionCount, sizeof(int32_t));
+    LE_ASSERT((Latitudes != NULL) && (Longitudes != NULL));
+
+    for (i = 0; i < fixCount - 1; i++)
+    {
+        for (step = 0; step < STEPS_PER_FIX; step++)
+        {
+            size_t index = (i * STEPS_PER_FIX) + step;
+
+            Latitudes[index] = fixLatitudes[i] +
+                               (int32_t)(((int64_t)(fixLatitudes[i + 1] - fixLatitudes[i]) *
+                                          (int64_t)step) / STEPS_PER_FIX);
+            Longitudes[index] = fixLongitudes[i] +
+                                (int32_t)(((int64_t)(fixLongitudes[i + 1] - fixLongitudes[i]) *
+                                           (int64_t)step) / STEPS_PER_FIX);
+        }
+    }
+
+    LE_INFO("%zu fixes, %zu positions", fixCount, PositionCount);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pseudo-random offset in [-span, span].
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t RandomOffset
+(
+    int32_t span
+)
+{
+    return (int32_t)(rand() % ((2 * span) + 1)) - span;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the fences: circles and polygons (with 3 to GEOFENCE_MAX_VERTICES vertices), around
+ * positions of the track.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateFences
+(
+    size_t count
+)
+{
+    size_t i, j;
+
+    Fences = calloc(count, sizeof(geofence_Fence_t*));
+    IsInside = calloc(count, sizeof(bool));
+    LE_ASSERT((Fences != NULL) && (IsInside != NULL));
+    FenceCount = count;
+
+    srand(1);
+
+    for (i = 0; i < count; i++)
+    {
+        size_t position = (size_t)rand() % PositionCount;
+        int32_t span = ((i % TRACK_FENCE_RATIO) == 0) ? TRACK_SPAN : SCATTER_SPAN;
+        int32_t latitude = Latitudes[position] + RandomOffset(span);
+        int32_t longitude = Longitudes[position] + RandomOffset(span);
+
+        if ((i % 2) == 0)
+        {
+            // Radius from 10 m to 2 km.
+            Fences[i] = geofence_CreateCircle(latitude, longitude, 10 + (rand() % 2000), 0,
+                                              (void*)i);
+        }
+        else
+        {
+            // Star-shaped polygon, with vertices from 10 m to 1 km away from its centre.
+            int32_t latitudes[GEOFENCE_MAX_VERTICES];
+            int32_t longitudes[GEOFENCE_MAX_VERTICES];
+            size_t vertexCount = 3 + ((size_t)rand() % (GEOFENCE_MAX_VERTICES - 2));
+
+            for (j = 0; j < vertexCount; j++)
+            {
+                double angle = (2 * M_PI * j) / vertexCount;
+                int32_t distance = 100 + (rand() % 10000);
+
+                latitudes[j] = latitude + (int32_t)(distance * sin(angle));
+                longitudes[j] = longitude + (int32_t)(distance * cos(angle));
+            }
+
+            Fences[i] = geofence_CreatePolygon(latitudes, longitudes, vertexCount, 0, (void*)i);
+        }
+
+        LE_ASSERT(Fences[i] != NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account for a transition.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountTransition
+(
+    size_t fenceIndex,
+    geofence_Transition_t transition
+)
+{
+    uint64_t value = (PositionIndex * 0x9E3779B97F4A7C15ULL) ^
+                     ((fenceIndex * 4) + transition + 1);
+
+    TransitionCount++;
+    TransitionSum += value * (value | 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Transition function of the indexed method.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TransitionFunc
+(
+    geofence_Fence_t* fencePtr,
+    geofence_Transition_t transition,
+    void* contextPtr
+)
+{
+    CountTransition((size_t)geofence_GetContext(fencePtr), transition);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replay the track with geofence_Update().
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReplayIndexed
+(
+    void
+)
+{
+    size_t i;
+
+    for (i = 0; i < PositionCount; i++, PositionIndex++)
+    {
+        geofence_Update(Latitudes[i], Longitudes[i], PositionIndex * 100, TransitionFunc, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replay the track testing every fence with geofence_Contains().
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReplayBruteForce
+(
+    void
+)
+{
+    size_t i, j;
+
+    for (i = 0; i < PositionCount; i++, PositionIndex++)
+    {
+        for (j = 0; j < FenceCount; j++)
+        {
+            bool isInside = geofence_Contains(Fences[j], Latitudes[i], Longitudes[i]);
+
+            if (isInside != IsInside[j])
+            {
+                IsInside[j] = isInside;
+                CountTransition(j, isInside ? GEOFENCE_ENTER : GEOFENCE_EXIT);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replay the track a number of times with one method, and report the time it took.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Measure
+(
+    const char* namePtr,
+    void (*replayFunc)(void),
+    size_t rounds,
+    size_t* transitionCountPtr,
+    uint64_t* transitionSumPtr
+)
+{
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    size_t i;
+
+    TransitionCount = 0;
+    TransitionSum = 0;
+    PositionIndex = 0;
+
+    for (i = 0; i < rounds; i++)
+    {
+        replayFunc();
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_INFO("%-11s: %zu positions, %zu fences: %.3f us/position, %zu transitions",
+            namePtr, rounds * PositionCount, FenceCount,
+            ((elapsed.sec * 1000000.0) + elapsed.usec) / (rounds * PositionCount),
+            TransitionCount);
+
+    *transitionCountPtr = TransitionCount;
+    *transitionSumPtr = TransitionSum;
+}
+
+
+COMPONENT_INIT
+{
+    const char* nmeaPathPtr = le_arg_GetArg(0);
+    size_t fences = GetArg(1, 1000);
+    size_t rounds = GetArg(2, 20);
+    size_t indexedCount, bruteForceCount;
+    uint64_t indexedSum, bruteForceSum;
+
+    LE_FATAL_IF(nmeaPathPtr == NULL, "Usage: geofenceBench nmeaFile [fences [rounds]]");
+    LE_ASSERT((fences > 0) && (rounds > 0));
+
+    geofence_Init();
+    ReadTrack(nmeaPathPtr);
+    CreateFences(fences);
+
+    Measure("indexed", ReplayIndexed, rounds, &indexedCount, &indexedSum);
+    Measure("brute force", ReplayBruteForce, rounds, &bruteForceCount, &bruteForceSum);
+
+    if ((indexedCount != bruteForceCount) || (indexedSum != bruteForceSum))
+    {
+        LE_ERROR("FAIL: the transitions are different.");
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
@@ -10,6 +10,7 @@
 #include "pa_gnss.h"
 #include "pa_gnss_simu.h"
 #include "le_gnss_local.h"
+#include "nmeaRing.h"
 #include "le_log.h"
 
 //--------------------------------------------------------------------------------------------------
@@ -70,6 +71,17 @@ static le_gnss_SampleRef_t GnssPositionSampleRef;
 //--------------------------------------------------------------------------------------------------
 static le_gnss_PositionHandlerRef_t GnssPositionHandlerRef = NULL;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position snapshot handler's reference, and the last snapshot it received.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_gnss_PositionSnapshotHandlerRef_t GnssPositionSnapshotHandlerRef = NULL;
+static le_gnss_SnapshotBitMask_t            SnapshotValidMask;
+static int32_t                              SnapshotLatitude;
+static uint64_t                             SnapshotEpochTime;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Thread and semaphore reference.
@@ -80,6 +92,49 @@ static le_sem_Ref_t                 ThreadSemaphore;
 static le_thread_Ref_t              AppThreadRef;
 static le_clk_Time_t                TimeToWait = { 5, 0 };
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function for Position Snapshot Notifications.
+ *
+ * It is called before the position handler for the same position, which checks the snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GnssPositionSnapshotHandlerFunction
+(
+    le_gnss_SnapshotBitMask_t validMask,
+    le_gnss_FixState_t state,
+    int32_t latitude,
+    int32_t longitude,
+    int32_t hAccuracy,
+    int32_t altitude,
+    int32_t vAccuracy,
+    int32_t altitudeOnWgs84,
+    uint32_t hSpeed,
+    uint32_t hSpeedAccuracy,
+    int32_t vSpeed,
+    int32_t vSpeedAccuracy,
+    uint32_t direction,
+    uint32_t directionAccuracy,
+    int32_t magneticDeviation,
+    uint64_t epochTime,
+    uint32_t timeAccuracy,
+    uint32_t gpsWeek,
+    uint32_t gpsTimeOfWeek,
+    uint8_t leapSeconds,
+    uint16_t hdop,
+    uint16_t vdop,
+    uint16_t pdop,
+    uint8_t satsInViewCount,
+    uint8_t satsTrackingCount,
+    uint8_t satsUsedCount,
+    void* contextPtr
+)
+{
+    SnapshotValidMask = validMask;
+    SnapshotLatitude = latitude;
+    SnapshotEpochTime = epochTime;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handler function for Position Notifications.
@@ -299,6 +354,87 @@ static void GnssPositionHandlerFunction
                                         &satElevNumElements);
     LE_ASSERT((LE_OK == result)||(LE_OUT_OF_RANGE == result));
 
+    // Get the position snapshot, and check it against the getters and the pushed snapshot
+    {
+        le_gnss_SnapshotBitMask_t validMask;
+        le_gnss_FixState_t snapState;
+        int32_t snapLatitude, snapLongitude, snapHAccuracy, snapAltitude, snapVAccuracy;
+        int32_t snapAltitudeOnWgs84, snapVSpeed, snapVSpeedAccuracy, snapMagneticDeviation;
+        uint32_t snapHSpeed, snapHSpeedAccuracy, snapDirection, snapDirectionAccuracy;
+        uint32_t snapTimeAccuracy, snapGpsWeek, snapGpsTimeOfWeek;
+        uint64_t snapEpochTime;
+        uint8_t snapLeapSeconds, snapSatsInView, snapSatsTracking, snapSatsUsed;
+        uint16_t snapHdop, snapVdop, snapPdop;
+
+        LE_ASSERT_OK(le_gnss_GetPositionSnapshot(positionSampleRef, &validMask, &snapState,
+                                                 &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                                 &snapAltitude, &snapVAccuracy,
+                                                 &snapAltitudeOnWgs84,
+                                                 &snapHSpeed, &snapHSpeedAccuracy,
+                                                 &snapVSpeed, &snapVSpeedAccuracy,
+                                                 &snapDirection, &snapDirectionAccuracy,
+                                                 &snapMagneticDeviation,
+                                                 &snapEpochTime, &snapTimeAccuracy,
+                                                 &snapGpsWeek, &snapGpsTimeOfWeek,
+                                                 &snapLeapSeconds,
+                                                 &snapHdop, &snapVdop, &snapPdop,
+                                                 &snapSatsInView, &snapSatsTracking,
+                                                 &snapSatsUsed));
+
+        LE_ASSERT_OK(le_gnss_GetPositionState(positionSampleRef, &state));
+        LE_ASSERT(snapState == state);
+
+        result = le_gnss_GetLocation(positionSampleRef, &latitude, &longitude, &hAccuracy);
+        LE_ASSERT(snapLatitude == latitude);
+        LE_ASSERT(snapLongitude == longitude);
+        LE_ASSERT(snapHAccuracy == hAccuracy);
+        LE_ASSERT(((LE_OK == result) && (validMask & LE_GNSS_SNAPSHOT_LATITUDE)
+                                     && (validMask & LE_GNSS_SNAPSHOT_LONGITUDE)
+                                     && (validMask & LE_GNSS_SNAPSHOT_H_ACCURACY))
+                  || (LE_OUT_OF_RANGE == result));
+
+        result = le_gnss_GetAltitude(positionSampleRef, &altitude, &vAccuracy);
+        LE_ASSERT((snapAltitude == altitude) && (snapVAccuracy == vAccuracy));
+
+        result = le_gnss_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
+        LE_ASSERT((snapHSpeed == hSpeed) && (snapHSpeedAccuracy == hSpeedAccuracy));
+
+        result = le_gnss_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
+        LE_ASSERT((snapVSpeed == vSpeed) && (snapVSpeedAccuracy == vSpeedAccuracy));
+
+        result = le_gnss_GetDirection(positionSampleRef, &direction, &directionAccuracy);
+        LE_ASSERT((snapDirection == direction) && (snapDirectionAccuracy == directionAccuracy));
+
+        result = le_gnss_GetDop(positionSampleRef, &hdopPtr, &vdopPtr, &pdopPtr);
+        LE_ASSERT((snapHdop == hdopPtr) && (snapVdop == vdopPtr) && (snapPdop == pdopPtr));
+
+        result = le_gnss_GetEpochTime(positionSampleRef, &EpochTime);
+        LE_ASSERT(snapEpochTime == EpochTime);
+
+        // The snapshot handler has been called first with the same position
+        LE_ASSERT(NULL != GnssPositionSnapshotHandlerRef);
+        LE_ASSERT(SnapshotValidMask == validMask);
+        LE_ASSERT(SnapshotLatitude == snapLatitude);
+        LE_ASSERT(SnapshotEpochTime == snapEpochTime);
+
+        // Pass invalid sample reference
+        LE_ASSERT(LE_FAULT == le_gnss_GetPositionSnapshot(GnssPositionSampleRef, &validMask,
+                                                 &snapState,
+                                                 &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                                 &snapAltitude, &snapVAccuracy,
+                                                 &snapAltitudeOnWgs84,
+                                                 &snapHSpeed, &snapHSpeedAccuracy,
+                                                 &snapVSpeed, &snapVSpeedAccuracy,
+                                                 &snapDirection, &snapDirectionAccuracy,
+                                                 &snapMagneticDeviation,
+                                                 &snapEpochTime, &snapTimeAccuracy,
+                                                 &snapGpsWeek, &snapGpsTimeOfWeek,
+                                                 &snapLeapSeconds,
+                                                 &snapHdop, &snapVdop, &snapPdop,
+                                                 &snapSatsInView, &snapSatsTracking,
+                                                 &snapSatsUsed));
+    }
+
     le_gnss_ReleaseSampleRef(positionSampleRef);
     le_sem_Post(ThreadSemaphore);
 }
@@ -337,6 +473,10 @@ static void* AppHandler
     // Subscribe position handler
     GnssPositionHandlerRef = le_gnss_AddPositionHandler(GnssPositionHandlerFunction, NULL);
     LE_ASSERT(NULL != GnssPositionHandlerRef);
+    // Subscribe position snapshot handler
+    GnssPositionSnapshotHandlerRef =
+                    le_gnss_AddPositionSnapshotHandler(GnssPositionSnapshotHandlerFunction, NULL);
+    LE_ASSERT(NULL != GnssPositionSnapshotHandlerRef);
     UNLOCK
     // Semaphore is used to synchronize the task execution with the core test
     le_sem_Post(ThreadSemaphore);
@@ -400,6 +540,8 @@ static void RemoveHandler
     LOCK
     le_gnss_RemovePositionHandler(GnssPositionHandlerRef);
     GnssPositionHandlerRef = NULL;
+    le_gnss_RemovePositionSnapshotHandler(GnssPositionSnapshotHandlerRef);
+    GnssPositionSnapshotHandlerRef = NULL;
     UNLOCK
     // Semaphore is used to synchronize the task execution with the core test
     le_sem_Post(ThreadSemaphore);
@@ -586,6 +728,48 @@ static void Testle_gnss_SetSuplAssistedMode
     LE_ASSERT(LE_FAULT == (le_gnss_SetSuplAssistedMode(LE_GNSS_STANDALONE_MODE)));
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tested API: le_gnss_GetNmeaRing()
+ *
+ * Verify that behaves as expected
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_gnss_GetNmeaRing
+(
+    void
+)
+{
+    nmeaRing_Reader_t reader1;
+    nmeaRing_Reader_t reader2;
+    char sentence[NMEA_RING_MAX_SENTENCE_BYTES + 1];
+    int fd;
+
+    LE_ASSERT(LE_FAULT == (le_gnss_GetNmeaRing(NULL)));
+
+    le_result_t result = le_gnss_GetNmeaRing(&fd);
+    if (LE_UNSUPPORTED == result)
+    {
+        // NMEA frames are not handled by this PA.
+        LE_ASSERT(-1 == fd);
+        return;
+    }
+    LE_ASSERT_OK(result);
+    LE_ASSERT_OK(nmeaRing_OpenReader(&reader1, fd, NMEA_RING_MASK_ALL));
+
+    // Each client gets its own file descriptor of the same ring.
+    LE_ASSERT_OK(le_gnss_GetNmeaRing(&fd));
+    LE_ASSERT_OK(nmeaRing_OpenReader(&reader2, fd, NMEA_RING_MASK(NMEA_RING_TYPE_GGA)));
+    LE_ASSERT(reader1.ringPtr != reader2.ringPtr);
+
+    LE_ASSERT(LE_WOULD_BLOCK == nmeaRing_Read(&reader1, sentence, sizeof(sentence), NULL));
+    LE_ASSERT(LE_WOULD_BLOCK == nmeaRing_Read(&reader2, sentence, sizeof(sentence), NULL));
+    LE_ASSERT(0 == nmeaRing_GetLostCount(&reader1));
+
+    nmeaRing_CloseReader(&reader1);
+    nmeaRing_CloseReader(&reader2);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Tested API: Test Uninitialized state of - le_gnss_Enable(), le_gnss_Stop(), le_gnss_Start()
@@ -818,6 +1002,9 @@ COMPONENT_INIT
     LE_INFO("======== GNSS SetSuplAssistedMode========");
     Testle_gnss_SetSuplAssistedMode();
 
+    LE_INFO("======== GNSS GetNmeaRing========");
+    Testle_gnss_GetNmeaRing();
+
     LE_INFO("======== GNSS Remove Position Handler========");
     Testle_gnss_RemoveHandlers();
 
@@ -0,0 +1,274 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shared NMEA ring benchmark.
+ *
+ * Writes made-up NMEA sentences to a ring while reader processes read it:
+ *  - a reader of all the sentences, polling as fast as it can,
+ *  - a reader of the GGA and RMC sentences only,
+ *  - a reader of all the sentences, polling every 10 ms, which can't keep up and loses some.
+ *
+ * Each reader checks that the sentences it reads are intact (checksum), in order, of the selected
+ * types, and that with the lost ones they add up to the sentences written. The writer reports the
+ * time it takes to write a sentence, and each reader the sentences it read and lost.
+ *
+ * Usage: nmeaRingBench [sentences]
+ *
+ *      sentences   Number of sentences written (default 1000000).
+ *
+ * The test passes if every reader passes its checks.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "nmeaRing.h"
+
+#include <sys/wait.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentence types written, in turn.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* Formatters[] = { "GPGGA", "GNRMC", "GPGSV", "GLGSV", "GPGSA", "GNVTG", "PQXFI" };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Last sentence written, telling the readers to stop.
+ */
+//--------------------------------------------------------------------------------------------------
+#define END_SENTENCE    "$PEND*00"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the checksum of a sentence, between '$' and '*'.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int GetChecksum
+(
+    const char* sentencePtr
+)
+{
+    unsigned int checksum = 0;
+
+    for (sentencePtr++; (*sentencePtr != '\0') && (*sentencePtr != '*'); sentencePtr++)
+    {
+        checksum ^= (unsigned char)*sentencePtr;
+    }
+
+    return checksum;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make the sentence of an index.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeSentence
+(
+    uint64_t index,
+    char* bufferPtr,
+    size_t bufferSize
+)
+{
+    // Sentences of varying lengths, so that the records wrap at various places.
+    static const char fields[] = "4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,,,,,";
+    int length = snprintf(bufferPtr, bufferSize, "$%s,%" PRIu64 ",%.*s",
+                          Formatters[index % NUM_ARRAY_MEMBERS(Formatters)], index,
+                          (int)(index % sizeof(fields)), fields);
+    snprintf(bufferPtr + length, bufferSize - length, "*%02X\r\n", GetChecksum(bufferPtr));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the ring until the end sentence, and check the sentences read.
+ *
+ * @return EXIT_SUCCESS if the sentences are the expected ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static int Read
+(
+    const char* namePtr,        ///< Name of the reader.
+    int fd,                     ///< File descriptor of the ring.
+    uint32_t typeMask,          ///< Types of the sentences to read.
+    uint64_t sentenceCount,     ///< Number of sentences written.
+    useconds_t pollInterval     ///< Interval between two polls when there is no new sentence.
+)
+{
+    nmeaRing_Reader_t reader;
+    char sentence[NMEA_RING_MAX_SENTENCE_BYTES + 1];
+    nmeaRing_Type_t type;
+    uint64_t readCount = 0;
+    uint64_t errorCount = 0;
+    uint64_t index = 0;
+    bool isFirst = true;
+
+    // The end sentence is proprietary.
+    typeMask |= NMEA_RING_MASK(NMEA_RING_TYPE_PROPRIETARY);
+    LE_ASSERT_OK(nmeaRing_OpenReader(&reader, fd, typeMask));
+
+    for (;;)
+    {
+        le_result_t result = nmeaRing_Read(&reader, sentence, sizeof(sentence), &type);
+
+        if (LE_WOULD_BLOCK == result)
+        {
+            usleep(pollInterval);
+            continue;
+        }
+        LE_ASSERT_OK(result);
+
+        if (strcmp(sentence, END_SENTENCE) == 0)
+        {
+            break;
+        }
+
+        // Intact and in order.
+        char* checksumPtr = strrchr(sentence, '*');
+        uint64_t sentenceIndex = strtoull(sentence + 7, NULL, 10);
+        if ((NULL == checksumPtr) ||
+            (strtoul(checksumPtr + 1, NULL, 16) != GetChecksum(sentence)) ||
+            (!isFirst && (sentenceIndex <= index)) ||
+            (nmeaRing_GetType(sentence) != type) ||
+            !(typeMask & NMEA_RING_MASK(type)))
+        {
+            if (errorCount == 0)
+            {
+                LE_ERROR("%s: bad sentence '%s' after %" PRIu64, namePtr, sentence, index);
+            }
+            errorCount++;
+        }
+
+        isFirst = false;
+        index = sentenceIndex;
+        readCount++;
+    }
+
+    uint64_t lostCount = nmeaRing_GetLostCount(&reader);
+    nmeaRing_CloseReader(&reader);
+
+    LE_INFO("%s: read %" PRIu64 ", lost %" PRIu64 " sentences", namePtr, readCount, lostCount);
+
+    // The readers start before the first sentence, so each sentence is either read or lost, or,
+    // if not selected, skipped.
+    if ((errorCount != 0) ||
+        ((typeMask == NMEA_RING_MASK_ALL) && (index + 1 != sentenceCount)) ||
+        ((typeMask == NMEA_RING_MASK_ALL) && (readCount + lostCount != sentenceCount)) ||
+        (readCount + lostCount > sentenceCount))
+    {
+        LE_ERROR("FAIL: %s: %" PRIu64 " bad sentences, last one %" PRIu64,
+                 namePtr, errorCount, index);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a reader process.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t StartReader
+(
+    const char* namePtr,
+    int fd,
+    uint32_t typeMask,
+    uint64_t sentenceCount,
+    useconds_t pollInterval
+)
+{
+    pid_t pid = fork();
+
+    LE_ASSERT(pid >= 0);
+    if (0 == pid)
+    {
+        _exit(Read(namePtr, dup(fd), typeMask, sentenceCount, pollInterval));
+    }
+
+    return pid;
+}
+
+
+COMPONENT_INIT
+{
+    uint64_t sentenceCount = GetArg(0, 1000000);
+    char sentence[NMEA_RING_MAX_SENTENCE_BYTES + 1];
+    pid_t pids[3];
+    int status;
+    int fd;
+    size_t i;
+
+    nmeaRing_Ring_t* ringPtr = nmeaRing_Create(&fd);
+    LE_ASSERT(ringPtr != NULL);
+
+    pids[0] = StartReader("fast", fd, NMEA_RING_MASK_ALL, sentenceCount, 10);
+    pids[1] = StartReader("GGA+RMC", fd,
+                          NMEA_RING_MASK(NMEA_RING_TYPE_GGA) | NMEA_RING_MASK(NMEA_RING_TYPE_RMC),
+                          sentenceCount, 10);
+    pids[2] = StartReader("slow", fd, NMEA_RING_MASK_ALL, sentenceCount, 10000);
+    close(fd);
+
+    // Let the readers start.
+    sleep(1);
+
+    struct timespec start, end;
+    uint64_t writeNs = 0;
+    for (i = 0; i < sentenceCount; i++)
+    {
+        MakeSentence(i, sentence, sizeof(sentence));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        nmeaRing_Write(ringPtr, sentence);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        writeNs += (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+
+        // Bursts of sentences, as from a GNSS receiver.
+        if ((i % 1000) == 999)
+        {
+            usleep(1000);
+        }
+    }
+    nmeaRing_Write(ringPtr, END_SENTENCE);
+
+    LE_INFO("write: %" PRIu64 " sentences: %.1f ns/sentence",
+            sentenceCount, (double)writeNs / sentenceCount);
+
+    bool isPassed = true;
+    for (i = 0; i < NUM_ARRAY_MEMBERS(pids); i++)
+    {
+        LE_ASSERT(waitpid(pids[i], &status, 0) == pids[i]);
+        isPassed = isPassed && WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS);
+    }
+
+    if (!isPassed)
+    {
+        LE_ERROR("FAIL");
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
@@ -1954,6 +1954,25 @@ le_result_t le_gnss_GetNmeaSentences
     return LE_OK;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function gets the shared ring of the NMEA frames.
+ *
+ * @return
+ *  - LE_OK             Success
+ *  - LE_UNSUPPORTED    The NMEA frames are not handled by the positioning service
+ *  - LE_FAULT          The ring can't be created
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetNmeaRing
+(
+    int* fdPtr                  ///< [OUT] File descriptor of the ring.
+)
+{
+    *fdPtr = -1;
+    return LE_UNSUPPORTED;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the server service reference stub
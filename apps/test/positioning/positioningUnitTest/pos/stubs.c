@@ -57,6 +57,45 @@ le_msg_SessionRef_t le_pos_GetClientSessionRef
     return NULL;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Positioning geofences initialization stub
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_Init
+(
+    void
+)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Positioning track initialization stub
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Init
+(
+    void
+)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Positioning track flush stub
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Flush
+(
+    void
+)
+{
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference to a tree iterator object.
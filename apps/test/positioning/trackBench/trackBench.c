@@ -0,0 +1,407 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Track recorder benchmark.
+ *
+ * Records made-up 10 Hz fixes (a vehicle driving around, with the altitude sometimes unknown and
+ * the clock sometimes set back) with the track recorder, reports the CPU time and the flash
+ * space they took, then exports them and checks that they read back unchanged. It also checks
+ * the time range of the track, and the export of a range around the first time the clock was set
+ * back (or around the middle fix if it never was).
+ *
+ * Usage: trackBench [fixes [directory]]
+ *
+ *      fixes       Number of fixes (default 864000, one day at 10 Hz). They must fit in the
+ *                  TRACK_MAX_SEGMENTS segments kept.
+ *      directory   Track directory, deleted first (default /tmp/trackBench).
+ *
+ * The test passes if the exported fixes are the recorded ones of each range, and the time range is
+ * the one of the earliest and latest fixes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "track.h"
+
+#include <dirent.h>
+#include <sys/resource.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Made-up fix generator.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    track_Fix_t fix;            ///< Last fix.
+    int32_t     latSpeed;       ///< Speed, in 1e-6 degree per fix.
+    int32_t     lonSpeed;
+    unsigned    seed;           ///< rand_r() seed.
+}
+Generator_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Context of the fix check.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    Generator_t generator;      ///< Generator of the expected fixes.
+    size_t      generated;      ///< Number of fixes generated.
+    size_t      fixes;          ///< Number of fixes recorded.
+    uint64_t    startTime;      ///< Time range of the expected fixes.
+    uint64_t    endTime;
+    size_t      count;          ///< Number of fixes read.
+    size_t      errorCount;     ///< Number of fixes different from the expected ones.
+}
+CheckCtx_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a numeric argument, or its default value if not given.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetArg
+(
+    size_t index,
+    uint64_t defaultValue
+)
+{
+    const char* argPtr = le_arg_GetArg(index);
+
+    return (argPtr != NULL) ? strtoull(argPtr, NULL, 10) : defaultValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a fix generator.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitGenerator
+(
+    Generator_t* generatorPtr
+)
+{
+    memset(generatorPtr, 0, sizeof(*generatorPtr));
+    generatorPtr->fix.time = 1500000000000ULL;
+    generatorPtr->fix.latitude = 48849833;
+    generatorPtr->fix.longitude = 2281533;
+    generatorPtr->fix.altitude = 35000;
+    generatorPtr->seed = 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the next fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static const track_Fix_t* NextFix
+(
+    Generator_t* generatorPtr
+)
+{
+    track_Fix_t* fixPtr = &generatorPtr->fix;
+    int r = rand_r(&generatorPtr->seed);
+
+    // 100 ms between fixes, with some jitter, and the clock set back once in a while.
+    fixPtr->time += 95 + (r % 11);
+    if ((r % 100000) == 0)
+    {
+        fixPtr->time -= 3600000;
+    }
+
+    // Up to about 30 m/s, changing direction now and then.
+    if ((r % 50) == 0)
+    {
+        generatorPtr->latSpeed = (rand_r(&generatorPtr->seed) % 55) - 27;
+        generatorPtr->lonSpeed = (rand_r(&generatorPtr->seed) % 81) - 40;
+    }
+    fixPtr->latitude += generatorPtr->latSpeed + ((r >> 8) % 3) - 1;
+    fixPtr->longitude += generatorPtr->lonSpeed + ((r >> 10) % 3) - 1;
+
+    fixPtr->hasAltitude = ((r % 20) != 0);
+    if (fixPtr->hasAltitude)
+    {
+        fixPtr->altitude += ((r >> 12) % 201) - 100;
+    }
+
+    return fixPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the context of the fix check, for a time range.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitCheck
+(
+    CheckCtx_t* ctxPtr,
+    size_t fixes,
+    uint64_t startTime,
+    uint64_t endTime
+)
+{
+    memset(ctxPtr, 0, sizeof(*ctxPtr));
+    InitGenerator(&ctxPtr->generator);
+    ctxPtr->fixes = fixes;
+    ctxPtr->startTime = startTime;
+    ctxPtr->endTime = endTime;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next recorded fix in the time range of a check.
+ *
+ * @return The fix, or NULL if there is none left.
+ */
+//--------------------------------------------------------------------------------------------------
+static const track_Fix_t* NextExpectedFix
+(
+    CheckCtx_t* ctxPtr
+)
+{
+    while (ctxPtr->generated < ctxPtr->fixes)
+    {
+        const track_Fix_t* fixPtr = NextFix(&ctxPtr->generator);
+
+        ctxPtr->generated++;
+        if ((fixPtr->time >= ctxPtr->startTime) && (fixPtr->time <= ctxPtr->endTime))
+        {
+            return fixPtr;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a fix read from the exported track.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFix
+(
+    const track_Fix_t* fixPtr,
+    void* contextPtr
+)
+{
+    CheckCtx_t* ctxPtr = contextPtr;
+    const track_Fix_t* expectedPtr = NextExpectedFix(ctxPtr);
+
+    if (NULL == expectedPtr)
+    {
+        if (ctxPtr->errorCount == 0)
+        {
+            LE_ERROR("Fix %zu: %" PRIu64 " not expected", ctxPtr->count, fixPtr->time);
+        }
+        ctxPtr->errorCount++;
+    }
+    else if ((fixPtr->time != expectedPtr->time) ||
+        (fixPtr->latitude != expectedPtr->latitude) ||
+        (fixPtr->longitude != expectedPtr->longitude) ||
+        (fixPtr->hasAltitude != expectedPtr->hasAltitude) ||
+        (fixPtr->hasAltitude && (fixPtr->altitude != expectedPtr->altitude)))
+    {
+        if (ctxPtr->errorCount == 0)
+        {
+            LE_ERROR("Fix %zu: %" PRIu64 " [%d,%d] %d, expected %" PRIu64 " [%d,%d] %d",
+                     ctxPtr->count, fixPtr->time, fixPtr->latitude, fixPtr->longitude,
+                     fixPtr->altitude, expectedPtr->time, expectedPtr->latitude,
+                     expectedPtr->longitude, expectedPtr->altitude);
+        }
+        ctxPtr->errorCount++;
+    }
+
+    ctxPtr->count++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time used by this process so far (user and system), in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetCpuUs
+(
+    void
+)
+{
+    struct rusage usage;
+
+    LE_ASSERT(getrusage(RUSAGE_SELF, &usage) == 0);
+
+    return ((uint64_t)usage.ru_utime.tv_sec * 1000000) + usage.ru_utime.tv_usec +
+           ((uint64_t)usage.ru_stime.tv_sec * 1000000) + usage.ru_stime.tv_usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Export the fixes of a time range, and check that they are the recorded ones of that range.
+ *
+ * @return true if they are.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckExport
+(
+    const char* pathPtr,        ///< [IN] Path of the exported file.
+    size_t fixes,               ///< [IN] Number of fixes recorded.
+    uint64_t startTime,         ///< [IN] Time range.
+    uint64_t endTime,
+    uint32_t* countPtr,         ///< [OUT] Number of fixes exported.
+    uint64_t* exportUsPtr       ///< [OUT] CPU time of the export, in microseconds.
+)
+{
+    CheckCtx_t ctx;
+    size_t expectedCount;
+
+    // Count the recorded fixes of the range.
+    InitCheck(&ctx, fixes, startTime, endTime);
+    for (expectedCount = 0; NextExpectedFix(&ctx) != NULL; expectedCount++)
+    {
+    }
+
+    int fd = open(pathPtr, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    LE_FATAL_IF(fd < 0, "Can't open '%s' (%m).", pathPtr);
+
+    uint64_t startUs = GetCpuUs();
+    LE_ASSERT(track_Export(startTime, endTime, fd, countPtr) == LE_OK);
+    *exportUsPtr = GetCpuUs() - startUs;
+
+    // Read back.
+    InitCheck(&ctx, fixes, startTime, endTime);
+    LE_ASSERT(lseek(fd, 0, SEEK_SET) == 0);
+    le_result_t result = track_Read(fd, CheckFix, &ctx);
+    close(fd);
+    unlink(pathPtr);
+
+    if ((result != LE_OK) || (ctx.count != expectedCount) || (*countPtr != expectedCount) ||
+        (ctx.errorCount != 0))
+    {
+        LE_ERROR("FAIL: %" PRIu64 " to %" PRIu64 ": read %zu fixes (%s), %zu different, of %zu",
+                 startTime, endTime, ctx.count, LE_RESULT_TXT(result), ctx.errorCount,
+                 expectedCount);
+        return false;
+    }
+
+    return true;
+}
+
+
+COMPONENT_INIT
+{
+    size_t fixes = GetArg(0, 864000);
+    const char* dirPtr = (le_arg_NumArgs() > 1) ? le_arg_GetArg(1) : "/tmp/trackBench";
+    char path[256];
+    Generator_t generator;
+    uint64_t minTime = UINT64_MAX;
+    uint64_t maxTime = 0;
+    uint64_t stepTime = 0;
+    uint64_t middleTime = 0;
+    uint64_t startTime, endTime;
+    uint64_t exportUs;
+    uint32_t count;
+    size_t i;
+
+    LE_ASSERT(fixes > 0);
+
+    le_dir_RemoveRecursive(dirPtr);
+    LE_ASSERT(track_Init(dirPtr) == LE_OK);
+
+    // Record.
+    InitGenerator(&generator);
+    uint64_t startUs = GetCpuUs();
+    for (i = 0; i < fixes; i++)
+    {
+        track_Record(NextFix(&generator));
+    }
+    LE_ASSERT(track_Flush() == LE_OK);
+    uint64_t recordUs = GetCpuUs() - startUs;
+
+    // Expected time range, and time of the first fix after the clock was first set back.
+    InitGenerator(&generator);
+    for (i = 0; i < fixes; i++)
+    {
+        uint64_t lastTime = generator.fix.time;
+        const track_Fix_t* fixPtr = NextFix(&generator);
+
+        minTime = (fixPtr->time < minTime) ? fixPtr->time : minTime;
+        maxTime = (fixPtr->time > maxTime) ? fixPtr->time : maxTime;
+        if ((stepTime == 0) && (i > 0) && (fixPtr->time < lastTime))
+        {
+            stepTime = fixPtr->time;
+        }
+        if (i == (fixes / 2))
+        {
+            middleTime = fixPtr->time;
+        }
+    }
+    if (stepTime == 0)
+    {
+        stepTime = middleTime;
+    }
+    // Flash space.
+    uint64_t bytes = 0;
+    size_t segmentCount = 0;
+    DIR* dirRefPtr = opendir(dirPtr);
+    LE_ASSERT(dirRefPtr != NULL);
+    struct dirent* entryPtr;
+    while ((entryPtr = readdir(dirRefPtr)) != NULL)
+    {
+        struct stat fileStat;
+
+        if ((entryPtr->d_name[0] != '.') &&
+            (fstatat(dirfd(dirRefPtr), entryPtr->d_name, &fileStat, 0) == 0))
+        {
+            bytes += fileStat.st_size;
+            segmentCount++;
+        }
+    }
+    closedir(dirRefPtr);
+
+    LE_INFO("record: %zu fixes: %.3f us/fix, %.2f bytes/fix, %zu segments,"
+            " about %" PRIu64 " write calls",
+            fixes, (double)recordUs / fixes, (double)bytes / fixes, segmentCount,
+            (bytes + TRACK_BUFFER_BYTES - 1) / TRACK_BUFFER_BYTES);
+
+    // Time range (the clock is set back now and then, so it isn't the one of the first and last
+    // fixes).
+    LE_ASSERT(track_GetRange(&startTime, &endTime) == LE_OK);
+    if ((startTime != minTime) || (endTime != maxTime))
+    {
+        LE_ERROR("FAIL: range %" PRIu64 " to %" PRIu64 ", expected %" PRIu64 " to %" PRIu64,
+                 startTime, endTime, minTime, maxTime);
+        exit(EXIT_FAILURE);
+    }
+
+    // Export everything.
+    snprintf(path, sizeof(path), "%s.export", dirPtr);
+    if (!CheckExport(path, fixes, startTime, endTime, &count, &exportUs))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("export: %" PRIu32 " fixes from %" PRIu64 " to %" PRIu64 ": %.3f us/fix",
+            count, startTime, endTime, (double)exportUs / count);
+
+    // Export the 40 minutes around the first clock step: they were recorded twice, before and
+    // after it, in different segments.
+    if (!CheckExport(path, fixes, stepTime - 1200000, stepTime + 1200000, &count, &exportUs))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    LE_INFO("export around %" PRIu64 ": %" PRIu32 " fixes: %.3f us/fix",
+            stepTime, count, (double)exportUs / count);
+
+    LE_INFO("PASS");
+    exit(EXIT_SUCCESS);
+}
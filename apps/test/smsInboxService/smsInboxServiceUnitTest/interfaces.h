@@ -330,4 +330,14 @@ le_cfg_IteratorRef_t le_cfg_CreateReadTxn
 (
     const char* basePath    ///< [IN] Path to the location to create the new iterator.
 );
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the reception of a new SMS message. The message handler is called before returning.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_smsTest_SimulateRxMsg
+(
+    void
+);
+
 #endif /* interfaces.h */
@@ -18,6 +18,30 @@
 #define SIMU_MSG_PATH           " /tmp/smsInbox/msg/"
 #define SIMU_CONF_PATH          " /tmp/smsInbox/cfg/"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * SMSInbox files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_FILE_FORMAT         "/tmp/smsInbox/msg/%08x.msg"
+#define TMP_FILE_PATH           "/tmp/smsInbox/msg/7ffffffe.msg.tmp"
+#define INDEX_FILE_PATH         "/tmp/smsInbox/cfg/le_smsInbox1.idx"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the short index file simulated at restart.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHORT_INDEX_BYTES       100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Arguments of the test when it is restarted, after the index file was corrupted or shortened.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CORRUPT_INDEX_ARG       "corruptIndex"
+#define SHORT_INDEX_ARG         "shortIndex"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * SMSInbox directory path length.
@@ -34,6 +58,7 @@
 //--------------------------------------------------------------------------------------------------
 #define MAX_MESSAGE_INVALID_COUNT 101
 #define MAX_MESSAGE_COUNT         50
+#define EVICTION_MESSAGE_COUNT    3
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -161,6 +186,24 @@ static void Testle_smsInbox_GetNext
     LE_ASSERT(le_smsInbox1_GetFirst(NULL) == LE_BAD_PARAMETER)
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: conversion of the legacy (Jansson) files of the message box.
+ *
+ * The message box configuration file is converted when the message box is first browsed, with
+ * the read status of its messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_smsInbox_Migration
+(
+    void
+)
+{
+    LE_ASSERT(access("/tmp/smsInbox/cfg/le_smsInbox1.json", F_OK) != 0);
+    LE_ASSERT(access("/tmp/smsInbox/cfg/le_smsInbox1.idx", F_OK) == 0);
+    LE_ASSERT(le_smsInbox1_IsUnread(MyMsgId1) == false);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Test: Read/Unread status smsInbox.
@@ -438,6 +481,168 @@ static void Testle_smsInbox_GetSenderTel
 
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Browse the message box.
+ *
+ * Return:
+ * - Number of messages, oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetMsgIds
+(
+    uint32_t* msgIdsPtr,
+    size_t maxCount
+)
+{
+    size_t count = 0;
+    uint32_t msgId = le_smsInbox1_GetFirst(MyMbx1Ref);
+
+    while ((msgId != 0) && (count < maxCount))
+    {
+        msgIdsPtr[count++] = msgId;
+        msgId = le_smsInbox1_GetNext(MyMbx1Ref);
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: identifier of a new message.
+ *
+ * The identifiers of the new messages are greater than the identifiers of the converted legacy
+ * messages, even when the legacy files appeared after the message directory was scanned.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_smsInbox_NextMessageId
+(
+    void
+)
+{
+    uint32_t msgIds[MAX_MESSAGE_COUNT];
+
+    le_smsTest_SimulateRxMsg();
+
+    LE_ASSERT(GetMsgIds(msgIds, NUM_ARRAY_MEMBERS(msgIds)) == 3);
+    LE_ASSERT(msgIds[0] == MyMsgId1);
+    LE_ASSERT(msgIds[1] == MyMsgId2);
+    LE_ASSERT(msgIds[2] > MyMsgId3);
+    LE_ASSERT(le_smsInbox1_IsUnread(msgIds[2]) == true);
+    LE_INFO("SmsInbox new msgId [%d]", msgIds[2]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: eviction of the oldest messages.
+ *
+ * When the maximum number of messages is lowered, the oldest messages are evicted (and their
+ * files deleted) when the next message is received.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_smsInbox_Eviction
+(
+    void
+)
+{
+    uint32_t msgIds[MAX_MESSAGE_COUNT];
+    uint32_t newMsgIds[MAX_MESSAGE_COUNT];
+    char path[MAX_FILE_PATH_LEN];
+    size_t count;
+    size_t i;
+
+    for (i = 0; i < 3; i++)
+    {
+        le_smsTest_SimulateRxMsg();
+    }
+
+    count = GetMsgIds(msgIds, NUM_ARRAY_MEMBERS(msgIds));
+    LE_ASSERT(count == 6);
+
+    LE_ASSERT_OK(le_smsInbox1_SetMaxMessages(EVICTION_MESSAGE_COUNT));
+    le_smsTest_SimulateRxMsg();
+
+    LE_ASSERT(GetMsgIds(newMsgIds, NUM_ARRAY_MEMBERS(newMsgIds)) == EVICTION_MESSAGE_COUNT);
+    LE_ASSERT(newMsgIds[0] == msgIds[count - 2]);
+    LE_ASSERT(newMsgIds[1] == msgIds[count - 1]);
+    LE_ASSERT(newMsgIds[2] > msgIds[count - 1]);
+
+    // The other message box is disabled: the evicted messages are not stored anymore.
+    for (i = 0; i < count - 2; i++)
+    {
+        snprintf(path, sizeof(path), MSG_FILE_FORMAT, msgIds[i]);
+        LE_ASSERT(access(path, F_OK) != 0);
+    }
+
+    snprintf(path, sizeof(path), MSG_FILE_FORMAT, newMsgIds[2]);
+    LE_ASSERT(access(path, F_OK) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: restart of smsInbox after an interruption.
+ *
+ * The temporary file of an interrupted write is deleted, and a bad index file is reset.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_smsInbox_Restart
+(
+    void
+)
+{
+    uint32_t msgIds[MAX_MESSAGE_COUNT];
+    struct stat st;
+
+    LE_ASSERT(access(TMP_FILE_PATH, F_OK) != 0);
+
+    Testle_smsInbox_Open();
+    LE_ASSERT(le_smsInbox1_GetFirst(MyMbx1Ref) == 0);
+    LE_ASSERT(stat(INDEX_FILE_PATH, &st) == 0);
+    LE_ASSERT(st.st_size > SHORT_INDEX_BYTES);
+
+    // The identifier of the temporary file is not used to number the new messages.
+    LE_ASSERT_OK(le_smsInbox1_SetMaxMessages(EVICTION_MESSAGE_COUNT));
+    le_smsTest_SimulateRxMsg();
+
+    LE_ASSERT(GetMsgIds(msgIds, NUM_ARRAY_MEMBERS(msgIds)) == 1);
+    LE_ASSERT(msgIds[0] < 0x7ffffffe);
+
+    Testle_smsInbox_Close();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate an interrupted write and a bad index file, and restart the test (and smsInbox).
+ */
+//--------------------------------------------------------------------------------------------------
+static void Simulate_smsInbox_Restart
+(
+    const char* restartArgPtr
+)
+{
+    int fd = open(TMP_FILE_PATH, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    LE_ASSERT(fd >= 0);
+    close(fd);
+
+    if (0 == strcmp(restartArgPtr, CORRUPT_INDEX_ARG))
+    {
+        uint32_t magic = 0;
+
+        fd = open(INDEX_FILE_PATH, O_WRONLY);
+        LE_ASSERT(fd >= 0);
+        LE_ASSERT(pwrite(fd, &magic, sizeof(magic), 0) == sizeof(magic));
+        close(fd);
+    }
+    else
+    {
+        LE_ASSERT(truncate(INDEX_FILE_PATH, SHORT_INDEX_BYTES) == 0);
+    }
+
+    LE_INFO("Restart with %s", restartArgPtr);
+    execl("/proc/self/exe", "smsInboxServiceUnitTest", restartArgPtr, (char*) NULL);
+    LE_FATAL("Unable to restart: %m");
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Simulate smsInbox config files
@@ -520,6 +725,22 @@ COMPONENT_INIT
     LE_INFO("======== START UnitTest of SMS INBOX API ========");
     const char* argString = "";
 
+    if (le_arg_NumArgs() == 1)
+    {
+        argString = le_arg_GetArg(0);
+
+        LE_INFO("======== smsInbox Restart test (%s) ========", argString);
+        Testle_smsInbox_Restart();
+
+        if (0 == strcmp(argString, CORRUPT_INDEX_ARG))
+        {
+            Simulate_smsInbox_Restart(SHORT_INDEX_ARG);
+        }
+
+        LE_INFO("======== UnitTest of SMS INBOX  API FINISHED ========");
+        exit(EXIT_SUCCESS);
+    }
+
     if (le_arg_NumArgs() >= MAX_CMD_ARG)
     {
         argString = le_arg_GetArg(0);
@@ -579,6 +800,9 @@ COMPONENT_INIT
     LE_INFO("======== smsInbox GetNext test ========");
     Testle_smsInbox_GetNext();
 
+    LE_INFO("======== smsInbox Migration test ========");
+    Testle_smsInbox_Migration();
+
     LE_INFO("======== smsInbox MarkRead test ========");
     Testle_smsInbox_ReadUnreadStatus();
 
@@ -615,9 +839,14 @@ COMPONENT_INIT
     LE_INFO("======== smsInbox delete test ========");
     Testle_smsInbox_DeleteMsg();
 
+    LE_INFO("======== smsInbox NextMessageId test ========");
+    Testle_smsInbox_NextMessageId();
+
+    LE_INFO("======== smsInbox Eviction test ========");
+    Testle_smsInbox_Eviction();
+
     LE_INFO("======== smsInbox Close test ========");
     Testle_smsInbox_Close();
 
-    LE_INFO("======== UnitTest of SMS INBOX  API FINISHED ========");
-    exit(EXIT_SUCCESS);
+    Simulate_smsInbox_Restart(CORRUPT_INDEX_ARG);
 }
@@ -30,6 +30,15 @@ static le_msg_SessionRef_t _ClientSessionRef = NULL;
 //--------------------------------------------------------------------------------------------------
 static le_event_Id_t SmsInboxRxEventId = NULL;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * New SMS message handler, and its context.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_RxMessageHandlerFunc_t RxMessageHandlerPtr = NULL;
+static void* RxMessageContextPtr = NULL;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the server service reference
@@ -508,9 +517,26 @@ le_sms_RxMessageHandlerRef_t le_sms_AddRxMessageHandler
 
     le_event_SetContextPtr(handlerRef, contextPtr);
 
+    RxMessageHandlerPtr = handlerPtr;
+    RxMessageContextPtr = contextPtr;
+
     return (le_sms_RxMessageHandlerRef_t)(handlerRef);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the reception of a new SMS message. The message handler is called before returning.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_smsTest_SimulateRxMsg
+(
+    void
+)
+{
+    LE_ASSERT(RxMessageHandlerPtr != NULL);
+    RxMessageHandlerPtr((le_sms_MsgRef_t) 0x10000001, RxMessageContextPtr);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves the identification number (IMSI) of the SIM card. (max 15 digits)
@@ -41,6 +41,9 @@
 #define CFG_NODE_TX_COUNT                   "txCount"
 #define CFG_NODE_RX_CB_COUNT                "rxCbCount"
 #define CFG_NODE_STATUS_REPORT              "statusReportEnabled"
+#define CFG_NODE_STATS_FLUSH_PERIOD         "statsFlushPeriod"
+#define CFG_NODE_STATS_FLUSH_THRESHOLD      "statsFlushThreshold"
+#define CFG_NODE_BATCH_MAX_IN_FLIGHT        "batchMaxInFlight"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -92,6 +92,28 @@
 //--------------------------------------------------------------------------------------------------
 #define MAX_NUM_METRICS 1
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of snapshot handlers we expect to have at one time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_NUM_SNAPSHOT_HANDLERS   8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of coalesced signal strength change handlers we expect to have at one time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_NUM_COALESCED_SS_HANDLERS   8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum age of a snapshot given to a snapshot handler: the handlers whose period elapses within
+ * this time share the same measure.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_MAX_AGE    { .sec = 0, .usec = 500000 }
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mutex to prevent race condition with asynchronous functions.
@@ -212,7 +234,7 @@ typedef struct
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Signal Strength Indication Handler context.
+ * Coalesced Signal Strength Change Handler context.
  *
  */
 //--------------------------------------------------------------------------------------------------
@@ -220,10 +242,19 @@ typedef struct
 {
     le_mrc_SignalStrengthChangeHandlerFunc_t handlerFuncPtr; ///< Handler function.
     void*                                    handlerCtxPtr;  ///< Handler's context.
-    le_mrc_Rat_t                             rat;            ///< Radio Access Technology.
-    int32_t                                  ssPrevious;     ///< last recorded signal strength.
-    int32_t                                  ssThreshold;    ///< Signal strength threshold in dBm.
-    le_dls_Link_t                            link;           ///< Object node link.
+    le_event_HandlerRef_t                    eventHandlerRef; ///< Handler of the RAT's signal
+                                                              ///  strength change event.
+    uint16_t                                 hysteresis;     ///< Minimum change of the signal
+                                                             ///  strength in dBm.
+    le_clk_Time_t                            minInterval;    ///< Minimum interval between two
+                                                             ///  notifications.
+    le_timer_Ref_t                           timerRef;       ///< Timer of the pending
+                                                             ///  notification.
+    bool                                     isNotified;     ///< A signal strength was notified.
+    int32_t                                  ssNotified;     ///< Last notified signal strength.
+    le_clk_Time_t                            notifyTime;     ///< Time of the last notification.
+    int32_t                                  ssPending;      ///< Latest signal strength, notified
+                                                             ///  when the timer expires.
 } SignalStrengthHandlerCtx_t;
 
 
@@ -267,6 +298,57 @@ typedef struct
     le_msg_SessionRef_t sessionRef;                  ///< Message session reference.
 } SignalMetrics_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot of the serving cell, of its signal metrics and of the neighboring cells. The signal
+ * metrics are flattened, and the neighboring cells are stored in arrays, as the client handlers
+ * expect them.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_clk_Time_t  timestamp;                                       ///< Time of the measure.
+    le_result_t    result;                                          ///< Result of the measure.
+    le_mrc_Rat_t   rat;                                             ///< RAT in use.
+    uint32_t       cellId;                                          ///< Serving cell identifier.
+    uint32_t       lac;                                             ///< Location area code.
+    uint16_t       tac;                                             ///< Tracking area code.
+    le_mrc_Rat_t   metricsRat;                                      ///< RAT of the signal metrics.
+    int32_t        ss;                                              ///< Signal strength.
+    uint32_t       er;                                              ///< Error rate.
+    int32_t        ecio;                                            ///< Ec/Io.
+    int32_t        rscp;                                            ///< RSCP.
+    int32_t        sinr;                                            ///< SINR.
+    int32_t        rsrq;                                            ///< RSRQ.
+    int32_t        rsrp;                                            ///< RSRP.
+    int32_t        snr;                                             ///< SNR.
+    int32_t        io;                                              ///< Received IO.
+    size_t         ngbrCount;                                       ///< Number of neighbors.
+    uint32_t       ngbrCellId[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];       ///< Cell identifiers.
+    uint32_t       ngbrLac[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];          ///< Location area codes.
+    int32_t        ngbrRxLevel[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];      ///< Rx levels.
+    le_mrc_Rat_t   ngbrRat[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];          ///< RATs.
+    int32_t        ngbrUmtsEcIo[LE_MRC_SNAPSHOT_MAX_NEIGHBORS];     ///< Ec/Io (UMTS).
+    int32_t        ngbrLteIntraRsrp[LE_MRC_SNAPSHOT_MAX_NEIGHBORS]; ///< Intrafrequency RSRP (LTE).
+    int32_t        ngbrLteIntraRsrq[LE_MRC_SNAPSHOT_MAX_NEIGHBORS]; ///< Intrafrequency RSRQ (LTE).
+    int32_t        ngbrLteInterRsrp[LE_MRC_SNAPSHOT_MAX_NEIGHBORS]; ///< Interfrequency RSRP (LTE).
+    int32_t        ngbrLteInterRsrq[LE_MRC_SNAPSHOT_MAX_NEIGHBORS]; ///< Interfrequency RSRQ (LTE).
+} Snapshot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot handler context.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_mrc_SnapshotHandlerFunc_t handlerFuncPtr;    ///< Handler function.
+    void*                        handlerCtxPtr;     ///< Handler's context.
+    le_timer_Ref_t               timerRef;          ///< Timer of the period.
+} SnapshotHandlerCtx_t;
+
 
 //--------------------------------------------------------------------------------------------------
 // Static declarations.
@@ -433,6 +515,49 @@ static le_event_Id_t MrcCommandEventId;
 //--------------------------------------------------------------------------------------------------
 static le_mem_PoolRef_t PreferredNetworkOperatorPool;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for snapshot handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SnapshotHandlerPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe Reference Map for snapshot handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t SnapshotHandlerRefMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Last snapshot measured. The periodic snapshots reuse it if it is less than SNAPSHOT_MAX_AGE old,
+ * so the number of handlers doesn't change how often the platform adaptor is queried.
+ */
+//--------------------------------------------------------------------------------------------------
+static Snapshot_t LastSnapshot;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Whether LastSnapshot has been measured.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsLastSnapshotMeasured = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for coalesced signal strength change handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t CoalescedSsHandlerPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe Reference Map for coalesced signal strength change handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t CoalescedSsHandlerRefMap;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -681,6 +806,132 @@ static void SignalStrengthIndHandlerFunc
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the Signal Strength Change event of a RAT.
+ *
+ * @return The event ID, or NULL if the RAT is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_event_Id_t GetSsChangeId
+(
+    le_mrc_Rat_t rat   ///< [IN] Radio Access Technology
+)
+{
+    switch(rat)
+    {
+        case LE_MRC_RAT_GSM:
+            return GsmSsChangeId;
+
+        case LE_MRC_RAT_UMTS:
+            return UmtsSsChangeId;
+
+        case LE_MRC_RAT_TDSCDMA:
+            return TdscdmaSsChangeId;
+
+        case LE_MRC_RAT_LTE:
+            return LteSsChangeId;
+
+        case LE_MRC_RAT_CDMA:
+            return CdmaSsChangeId;
+
+        case LE_MRC_RAT_UNKNOWN:
+        default:
+            return NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Notify a signal strength to a coalesced Signal Strength Change handler.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void NotifyCoalescedSs
+(
+    SignalStrengthHandlerCtx_t* handlerCtxPtr,  ///< [IN] Handler context.
+    int32_t ss                                  ///< [IN] Signal strength in dBm.
+)
+{
+    handlerCtxPtr->isNotified = true;
+    handlerCtxPtr->ssNotified = ss;
+    handlerCtxPtr->notifyTime = le_clk_GetRelativeTime();
+
+    handlerCtxPtr->handlerFuncPtr(ss, handlerCtxPtr->handlerCtxPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer handler of a coalesced Signal Strength Change handler: the minimum interval has elapsed
+ * since the last notification, notify the latest signal strength.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void CoalescedSsTimerHandler
+(
+    le_timer_Ref_t timerRef     ///< [IN] Timer of the handler.
+)
+{
+    SignalStrengthHandlerCtx_t* handlerCtxPtr = le_timer_GetContextPtr(timerRef);
+
+    NotifyCoalescedSs(handlerCtxPtr, handlerCtxPtr->ssPending);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The first-layer coalesced Signal Strength Change Handler.
+ *
+ * A signal strength within the hysteresis of the last notified one is dropped. Otherwise it is
+ * notified at once if the minimum interval has elapsed since the last notification, else it
+ * replaces the pending signal strength, notified when the interval elapses.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void FirstLayerCoalescedSsChangeHandler
+(
+    void* reportPtr,
+    void* secondLayerHandlerFunc
+)
+{
+    pa_mrc_SignalStrengthIndication_t* ssIndPtr = (pa_mrc_SignalStrengthIndication_t*)reportPtr;
+    SignalStrengthHandlerCtx_t*        handlerCtxPtr = le_event_GetContextPtr();
+    int32_t                            ss = ssIndPtr->ss;
+
+    // The reportPtr is a reference counted object, so need to release it
+    le_mem_Release(reportPtr);
+
+    if ((handlerCtxPtr->isNotified) &&
+        (abs(ss - handlerCtxPtr->ssNotified) < handlerCtxPtr->hysteresis))
+    {
+        // Within the hysteresis of the last notified signal strength: drop the pending one.
+        if (le_timer_IsRunning(handlerCtxPtr->timerRef))
+        {
+            le_timer_Stop(handlerCtxPtr->timerRef);
+        }
+        return;
+    }
+
+    if (le_timer_IsRunning(handlerCtxPtr->timerRef))
+    {
+        handlerCtxPtr->ssPending = ss;
+        return;
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), handlerCtxPtr->notifyTime);
+
+    if ((!handlerCtxPtr->isNotified) ||
+        (!le_clk_GreaterThan(handlerCtxPtr->minInterval, elapsed)))
+    {
+        NotifyCoalescedSs(handlerCtxPtr, ss);
+        return;
+    }
+
+    handlerCtxPtr->ssPending = ss;
+    LE_ASSERT_OK(le_timer_SetInterval(handlerCtxPtr->timerRef,
+                                      le_clk_Sub(handlerCtxPtr->minInterval, elapsed)));
+    LE_ASSERT_OK(le_timer_Start(handlerCtxPtr->timerRef));
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Test mcc and mnc strings
@@ -1146,6 +1397,237 @@ static void NetworkRejectIndHandler
     le_event_ReportWithRefCounting(NetworkRejectIndId, networkRejectIndPtr);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure a snapshot of the serving cell, of its signal metrics and of the neighboring cells.
+ *
+ * @return
+ *  - LE_OK     Function succeeded.
+ *  - LE_FAULT  Neither the Radio Access Technology in use nor the signal metrics could be
+ *              retrieved.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MeasureSnapshot
+(
+    Snapshot_t* snapshotPtr     ///< [OUT] The snapshot.
+)
+{
+    pa_mrc_SignalMetrics_t metrics;
+    le_dls_List_t cellInfoList = LE_DLS_LIST_INIT;
+    le_dls_Link_t* linkPtr;
+
+    snapshotPtr->timestamp = le_clk_GetRelativeTime();
+
+    // Serving cell.
+    if (LE_OK != pa_mrc_GetRadioAccessTechInUse(&snapshotPtr->rat))
+    {
+        snapshotPtr->rat = LE_MRC_RAT_UNKNOWN;
+    }
+    if (LE_OK != pa_mrc_GetServingCellId(&snapshotPtr->cellId))
+    {
+        snapshotPtr->cellId = UINT32_MAX;
+    }
+    if (LE_OK != pa_mrc_GetServingCellLocAreaCode(&snapshotPtr->lac))
+    {
+        snapshotPtr->lac = UINT32_MAX;
+    }
+    if ((LE_MRC_RAT_LTE != snapshotPtr->rat) ||
+        (LE_OK != pa_mrc_GetServingCellLteTracAreaCode(&snapshotPtr->tac)))
+    {
+        snapshotPtr->tac = UINT16_MAX;
+    }
+
+    // Signal metrics, flattened: the metrics which don't apply to the RAT are not available.
+    snapshotPtr->ss = INT32_MAX;
+    snapshotPtr->er = UINT32_MAX;
+    snapshotPtr->ecio = INT32_MAX;
+    snapshotPtr->rscp = INT32_MAX;
+    snapshotPtr->sinr = INT32_MAX;
+    snapshotPtr->rsrq = INT32_MAX;
+    snapshotPtr->rsrp = INT32_MAX;
+    snapshotPtr->snr = INT32_MAX;
+    snapshotPtr->io = INT32_MAX;
+
+    if (LE_OK != pa_mrc_MeasureSignalMetrics(&metrics))
+    {
+        LE_ERROR("Unable to measure the signal metrics!");
+        metrics.rat = LE_MRC_RAT_UNKNOWN;
+    }
+    snapshotPtr->metricsRat = metrics.rat;
+
+    switch (metrics.rat)
+    {
+        case LE_MRC_RAT_GSM:
+            snapshotPtr->ss = metrics.ss;
+            snapshotPtr->er = metrics.er;
+            break;
+
+        case LE_MRC_RAT_UMTS:
+            snapshotPtr->ss = metrics.ss;
+            snapshotPtr->er = metrics.er;
+            snapshotPtr->ecio = metrics.umtsMetrics.ecio;
+            snapshotPtr->rscp = metrics.umtsMetrics.rscp;
+            break;
+
+        case LE_MRC_RAT_TDSCDMA:
+            snapshotPtr->ss = metrics.ss;
+            snapshotPtr->er = metrics.er;
+            snapshotPtr->ecio = metrics.tdscdmaMetrics.ecio;
+            snapshotPtr->rscp = metrics.tdscdmaMetrics.rscp;
+            snapshotPtr->sinr = metrics.tdscdmaMetrics.sinr;
+            break;
+
+        case LE_MRC_RAT_LTE:
+            snapshotPtr->ss = metrics.ss;
+            snapshotPtr->er = metrics.er;
+            snapshotPtr->rsrq = metrics.lteMetrics.rsrq;
+            snapshotPtr->rsrp = metrics.lteMetrics.rsrp;
+            snapshotPtr->snr = metrics.lteMetrics.snr;
+            break;
+
+        case LE_MRC_RAT_CDMA:
+            snapshotPtr->ss = metrics.ss;
+            snapshotPtr->er = metrics.er;
+            snapshotPtr->ecio = metrics.cdmaMetrics.ecio;
+            snapshotPtr->sinr = metrics.cdmaMetrics.sinr;
+            snapshotPtr->io = metrics.cdmaMetrics.io;
+            break;
+
+        case LE_MRC_RAT_UNKNOWN:
+        default:
+            break;
+    }
+
+    // Neighboring cells.
+    snapshotPtr->ngbrCount = 0;
+    if (pa_mrc_GetNeighborCellsInfo(&cellInfoList) > 0)
+    {
+        linkPtr = le_dls_Peek(&cellInfoList);
+        while ((NULL != linkPtr) && (snapshotPtr->ngbrCount < LE_MRC_SNAPSHOT_MAX_NEIGHBORS))
+        {
+            pa_mrc_CellInfo_t* cellInfoPtr = CONTAINER_OF(linkPtr, pa_mrc_CellInfo_t, link);
+            size_t i = snapshotPtr->ngbrCount++;
+
+            snapshotPtr->ngbrCellId[i] = cellInfoPtr->id;
+            snapshotPtr->ngbrLac[i] = cellInfoPtr->lac;
+            snapshotPtr->ngbrRxLevel[i] = cellInfoPtr->rxLevel;
+            snapshotPtr->ngbrRat[i] = cellInfoPtr->rat;
+            snapshotPtr->ngbrUmtsEcIo[i] = cellInfoPtr->umtsEcIo;
+            snapshotPtr->ngbrLteIntraRsrp[i] = cellInfoPtr->lteIntraRsrp;
+            snapshotPtr->ngbrLteIntraRsrq[i] = cellInfoPtr->lteIntraRsrq;
+            snapshotPtr->ngbrLteInterRsrp[i] = cellInfoPtr->lteInterRsrp;
+            snapshotPtr->ngbrLteInterRsrq[i] = cellInfoPtr->lteInterRsrq;
+
+            linkPtr = le_dls_PeekNext(&cellInfoList, linkPtr);
+        }
+    }
+    pa_mrc_DeleteNeighborCellsInfo(&cellInfoList);
+
+    if ((LE_MRC_RAT_UNKNOWN == snapshotPtr->rat) && (LE_MRC_RAT_UNKNOWN == snapshotPtr->metricsRat))
+    {
+        snapshotPtr->result = LE_FAULT;
+    }
+    else
+    {
+        snapshotPtr->result = LE_OK;
+    }
+
+    return snapshotPtr->result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a snapshot measured less than SNAPSHOT_MAX_AGE ago, measuring a new one if the last snapshot
+ * is older.
+ *
+ * @return The snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Snapshot_t* GetRecentSnapshot
+(
+    void
+)
+{
+    le_clk_Time_t maxAge = SNAPSHOT_MAX_AGE;
+
+    if ((!IsLastSnapshotMeasured) ||
+        (!le_clk_GreaterThan(maxAge,
+                             le_clk_Sub(le_clk_GetRelativeTime(), LastSnapshot.timestamp))))
+    {
+        MeasureSnapshot(&LastSnapshot);
+        IsLastSnapshotMeasured = true;
+    }
+
+    return &LastSnapshot;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer handler of a snapshot handler: report a snapshot to the client.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotTimerHandler
+(
+    le_timer_Ref_t timerRef     ///< [IN] Timer of the snapshot handler.
+)
+{
+    SnapshotHandlerCtx_t* handlerCtxPtr = le_timer_GetContextPtr(timerRef);
+    const Snapshot_t* snapshotPtr = GetRecentSnapshot();
+
+    if (LE_OK != snapshotPtr->result)
+    {
+        LE_WARN("No snapshot to report");
+        return;
+    }
+
+    handlerCtxPtr->handlerFuncPtr(snapshotPtr->rat,
+                                  snapshotPtr->cellId,
+                                  snapshotPtr->lac,
+                                  snapshotPtr->tac,
+                                  snapshotPtr->metricsRat,
+                                  snapshotPtr->ss,
+                                  snapshotPtr->er,
+                                  snapshotPtr->ecio,
+                                  snapshotPtr->rscp,
+                                  snapshotPtr->sinr,
+                                  snapshotPtr->rsrq,
+                                  snapshotPtr->rsrp,
+                                  snapshotPtr->snr,
+                                  snapshotPtr->io,
+                                  snapshotPtr->ngbrCellId, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrLac, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrRxLevel, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrRat, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrUmtsEcIo, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrLteIntraRsrp, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrLteIntraRsrq, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrLteInterRsrp, snapshotPtr->ngbrCount,
+                                  snapshotPtr->ngbrLteInterRsrq, snapshotPtr->ngbrCount,
+                                  handlerCtxPtr->handlerCtxPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the values of the neighboring cells of a snapshot into an array of the client.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CopyNeighborValues
+(
+    void*       dstPtr,         ///< [OUT] Array of the client.
+    size_t*     dstCountPtr,    ///< [IN/OUT] Size of the array, then number of values copied.
+    const void* srcPtr,         ///< [IN] Values of the snapshot.
+    size_t      srcCount,       ///< [IN] Number of values of the snapshot.
+    size_t      valueSize       ///< [IN] Size of a value.
+)
+{
+    if (*dstCountPtr > srcCount)
+    {
+        *dstCountPtr = srcCount;
+    }
+
+    memcpy(dstPtr, srcPtr, *dstCountPtr * valueSize);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * handler function to release memory objects of modem radio control service.
@@ -1329,6 +1811,17 @@ void le_mrc_Init
     // Create the Safe Reference Map to use for Signal Metrics object Safe References.
     MetricsRefMap = le_ref_CreateMap("MetricsRefMap", MAX_NUM_METRICS);
 
+    // Create the pool and the Safe Reference Map for the snapshot handlers.
+    SnapshotHandlerPool = le_mem_CreatePool("SnapshotHandlerPool", sizeof(SnapshotHandlerCtx_t));
+    SnapshotHandlerRefMap = le_ref_CreateMap("SnapshotHandlerRefMap", MAX_NUM_SNAPSHOT_HANDLERS);
+
+    // Create the pool and the Safe Reference Map for the coalesced signal strength change
+    // handlers.
+    CoalescedSsHandlerPool = le_mem_CreatePool("CoalescedSsHandlerPool",
+                                               sizeof(SignalStrengthHandlerCtx_t));
+    CoalescedSsHandlerRefMap = le_ref_CreateMap("CoalescedSsHandlerRefMap",
+                                                MAX_NUM_COALESCED_SS_HANDLERS);
+
     // Add a handler to the close session service
     le_msg_ServiceRef_t msgService = le_mrc_GetServiceRef();
     le_msg_AddServiceCloseHandler(msgService, CloseSessionEventHandler, NULL);
@@ -4102,6 +4595,107 @@ void le_mrc_RemoveSignalStrengthChangeHandler
    le_event_RemoveHandler((le_event_HandlerRef_t)handlerRef);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to register an handler for Signal Strength value changes, filtered
+ * by a hysteresis and a minimum interval between two notifications.
+ *
+ * @return A handler reference, which is only needed for later removal of the handler.
+ *
+ * @note  If the caller is passing a null handler function, thresholds values out of range or an
+ *        invalid RAT into this function, it's a fatal error, the function won't return. No need
+ *        then to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mrc_CoalescedSignalStrengthChangeHandlerRef_t le_mrc_AddCoalescedSignalStrengthChangeHandler
+(
+    le_mrc_Rat_t                             rat,                 ///< [IN] Radio Access Technology
+    int32_t                                  lowerRangeThreshold, ///< [IN] lower-range Signal
+                                                                  ///      strength threshold in dBm
+    int32_t                                  upperRangeThreshold, ///< [IN] upper-range Signal
+                                                                  ///      strength threshold in dBm
+    uint16_t                                 hysteresis,          ///< [IN] Minimum change of the
+                                                                  ///      Signal strength in dBm
+    uint32_t                                 minInterval,         ///< [IN] Minimum interval
+                                                                  ///      between two notifications
+                                                                  ///      in milliseconds
+    le_mrc_SignalStrengthChangeHandlerFunc_t handlerFuncPtr,      ///< [IN] The handler function
+    void*                                    contextPtr           ///< [IN] The handler's context
+)
+{
+    if (NULL == handlerFuncPtr)
+    {
+        LE_KILL_CLIENT("Handler function is NULL !");
+        return NULL;
+    }
+
+    if (IsRatInvalid (rat))
+    {
+        LE_KILL_CLIENT("Bad RAT parameter : %d", rat);
+        return NULL;
+    }
+
+    if (lowerRangeThreshold >= upperRangeThreshold)
+    {
+        LE_KILL_CLIENT("lowerRangeThreshold %d >= upperRangeThreshold %d !",
+                       lowerRangeThreshold, upperRangeThreshold);
+        return NULL;
+    }
+
+    if (pa_mrc_SetSignalStrengthIndThresholds(rat,
+                                              lowerRangeThreshold,
+                                              upperRangeThreshold) != LE_OK)
+    {
+        LE_KILL_CLIENT("Failed to set PA Signal Strength Indication thresholds!");
+        return NULL;
+    }
+
+    SignalStrengthHandlerCtx_t* handlerCtxPtr = le_mem_ForceAlloc(CoalescedSsHandlerPool);
+
+    memset(handlerCtxPtr, 0, sizeof(SignalStrengthHandlerCtx_t));
+    handlerCtxPtr->handlerFuncPtr = handlerFuncPtr;
+    handlerCtxPtr->handlerCtxPtr = contextPtr;
+    handlerCtxPtr->hysteresis = hysteresis;
+    handlerCtxPtr->minInterval.sec = minInterval / 1000;
+    handlerCtxPtr->minInterval.usec = (minInterval % 1000) * 1000;
+
+    handlerCtxPtr->timerRef = le_timer_Create("MrcCoalescedSsTimer");
+    LE_ASSERT_OK(le_timer_SetHandler(handlerCtxPtr->timerRef, CoalescedSsTimerHandler));
+    LE_ASSERT_OK(le_timer_SetContextPtr(handlerCtxPtr->timerRef, handlerCtxPtr));
+
+    handlerCtxPtr->eventHandlerRef =
+                        le_event_AddLayeredHandler("CoalescedSsChangeHandler",
+                                                   GetSsChangeId(rat),
+                                                   FirstLayerCoalescedSsChangeHandler,
+                                                   (le_event_HandlerFunc_t)handlerFuncPtr);
+    le_event_SetContextPtr(handlerCtxPtr->eventHandlerRef, handlerCtxPtr);
+
+    return le_ref_CreateRef(CoalescedSsHandlerRefMap, handlerCtxPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to remove an handler for coalesced Signal Strength value changes.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mrc_RemoveCoalescedSignalStrengthChangeHandler
+(
+    le_mrc_CoalescedSignalStrengthChangeHandlerRef_t handlerRef ///< [IN] The handler reference.
+)
+{
+    SignalStrengthHandlerCtx_t* handlerCtxPtr = le_ref_Lookup(CoalescedSsHandlerRefMap, handlerRef);
+    if (NULL == handlerCtxPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", handlerRef);
+        return;
+    }
+
+    le_ref_DeleteRef(CoalescedSsHandlerRefMap, handlerRef);
+    le_event_RemoveHandler(handlerCtxPtr->eventHandlerRef);
+    le_timer_Delete(handlerCtxPtr->timerRef);
+    le_mem_Release(handlerCtxPtr);
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -4190,6 +4784,194 @@ uint32_t le_mrc_GetServingCellLocAreaCode
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to get a snapshot of the serving cell, of its signal metrics and of
+ * the neighboring cells.
+ *
+ * @return
+ *  - LE_OK     Function succeeded.
+ *  - LE_FAULT  Neither the Radio Access Technology in use nor the signal metrics could be
+ *              retrieved.
+ *
+ * @note If the caller is passing a bad pointer into this function, it is a fatal error, the
+ *       function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_mrc_GetSnapshot
+(
+    le_mrc_Rat_t* ratPtr,                   ///< [OUT] Radio Access Technology in use.
+    uint32_t* cellIdPtr,                    ///< [OUT] Serving cell identifier.
+    uint32_t* locAreaCodePtr,               ///< [OUT] Serving cell location area code.
+    uint16_t* tracAreaCodePtr,              ///< [OUT] Serving cell tracking area code.
+    le_mrc_Rat_t* metricsRatPtr,            ///< [OUT] Radio Access Technology of the metrics.
+    int32_t* ssPtr,                         ///< [OUT] Signal strength in dBm.
+    uint32_t* erPtr,                        ///< [OUT] Bit/Block/Frame/Packet error rate.
+    int32_t* ecioPtr,                       ///< [OUT] Ec/Io.
+    int32_t* rscpPtr,                       ///< [OUT] RSCP in dBm.
+    int32_t* sinrPtr,                       ///< [OUT] SINR in dB.
+    int32_t* rsrqPtr,                       ///< [OUT] RSRQ in dB.
+    int32_t* rsrpPtr,                       ///< [OUT] RSRP in dBm.
+    int32_t* snrPtr,                        ///< [OUT] SNR in dB.
+    int32_t* ioPtr,                         ///< [OUT] Received IO in dBm.
+    uint32_t* ngbrCellIdPtr,                ///< [OUT] Neighboring cells identifiers.
+    size_t* ngbrCellIdSizePtr,              ///< [INOUT] Size of the array.
+    uint32_t* ngbrLocAreaCodePtr,           ///< [OUT] Neighboring cells location area codes.
+    size_t* ngbrLocAreaCodeSizePtr,         ///< [INOUT] Size of the array.
+    int32_t* ngbrRxLevelPtr,                ///< [OUT] Neighboring cells Rx levels in dBm.
+    size_t* ngbrRxLevelSizePtr,             ///< [INOUT] Size of the array.
+    le_mrc_Rat_t* ngbrRatPtr,               ///< [OUT] Neighboring cells RATs.
+    size_t* ngbrRatSizePtr,                 ///< [INOUT] Size of the array.
+    int32_t* ngbrUmtsEcIoPtr,               ///< [OUT] Neighboring cells Ec/Io (UMTS).
+    size_t* ngbrUmtsEcIoSizePtr,            ///< [INOUT] Size of the array.
+    int32_t* ngbrLteIntraRsrpPtr,           ///< [OUT] Neighboring cells intrafrequency RSRP.
+    size_t* ngbrLteIntraRsrpSizePtr,        ///< [INOUT] Size of the array.
+    int32_t* ngbrLteIntraRsrqPtr,           ///< [OUT] Neighboring cells intrafrequency RSRQ.
+    size_t* ngbrLteIntraRsrqSizePtr,        ///< [INOUT] Size of the array.
+    int32_t* ngbrLteInterRsrpPtr,           ///< [OUT] Neighboring cells interfrequency RSRP.
+    size_t* ngbrLteInterRsrpSizePtr,        ///< [INOUT] Size of the array.
+    int32_t* ngbrLteInterRsrqPtr,           ///< [OUT] Neighboring cells interfrequency RSRQ.
+    size_t* ngbrLteInterRsrqSizePtr         ///< [INOUT] Size of the array.
+)
+{
+    if ((NULL == ratPtr) || (NULL == cellIdPtr) || (NULL == locAreaCodePtr)
+        || (NULL == tracAreaCodePtr) || (NULL == metricsRatPtr) || (NULL == ssPtr)
+        || (NULL == erPtr) || (NULL == ecioPtr) || (NULL == rscpPtr) || (NULL == sinrPtr)
+        || (NULL == rsrqPtr) || (NULL == rsrpPtr) || (NULL == snrPtr) || (NULL == ioPtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    if ((NULL == ngbrCellIdPtr) || (NULL == ngbrCellIdSizePtr)
+        || (NULL == ngbrLocAreaCodePtr) || (NULL == ngbrLocAreaCodeSizePtr)
+        || (NULL == ngbrRxLevelPtr) || (NULL == ngbrRxLevelSizePtr)
+        || (NULL == ngbrRatPtr) || (NULL == ngbrRatSizePtr)
+        || (NULL == ngbrUmtsEcIoPtr) || (NULL == ngbrUmtsEcIoSizePtr)
+        || (NULL == ngbrLteIntraRsrpPtr) || (NULL == ngbrLteIntraRsrpSizePtr)
+        || (NULL == ngbrLteIntraRsrqPtr) || (NULL == ngbrLteIntraRsrqSizePtr)
+        || (NULL == ngbrLteInterRsrpPtr) || (NULL == ngbrLteInterRsrpSizePtr)
+        || (NULL == ngbrLteInterRsrqPtr) || (NULL == ngbrLteInterRsrqSizePtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    // The snapshot measured here is also reused by the periodic snapshots.
+    le_result_t result = MeasureSnapshot(&LastSnapshot);
+    IsLastSnapshotMeasured = true;
+    if (LE_OK != result)
+    {
+        LE_ERROR("Unable to measure the snapshot!");
+        return LE_FAULT;
+    }
+
+    *ratPtr = LastSnapshot.rat;
+    *cellIdPtr = LastSnapshot.cellId;
+    *locAreaCodePtr = LastSnapshot.lac;
+    *tracAreaCodePtr = LastSnapshot.tac;
+    *metricsRatPtr = LastSnapshot.metricsRat;
+    *ssPtr = LastSnapshot.ss;
+    *erPtr = LastSnapshot.er;
+    *ecioPtr = LastSnapshot.ecio;
+    *rscpPtr = LastSnapshot.rscp;
+    *sinrPtr = LastSnapshot.sinr;
+    *rsrqPtr = LastSnapshot.rsrq;
+    *rsrpPtr = LastSnapshot.rsrp;
+    *snrPtr = LastSnapshot.snr;
+    *ioPtr = LastSnapshot.io;
+
+    CopyNeighborValues(ngbrCellIdPtr, ngbrCellIdSizePtr,
+                       LastSnapshot.ngbrCellId, LastSnapshot.ngbrCount, sizeof(uint32_t));
+    CopyNeighborValues(ngbrLocAreaCodePtr, ngbrLocAreaCodeSizePtr,
+                       LastSnapshot.ngbrLac, LastSnapshot.ngbrCount, sizeof(uint32_t));
+    CopyNeighborValues(ngbrRxLevelPtr, ngbrRxLevelSizePtr,
+                       LastSnapshot.ngbrRxLevel, LastSnapshot.ngbrCount, sizeof(int32_t));
+    CopyNeighborValues(ngbrRatPtr, ngbrRatSizePtr,
+                       LastSnapshot.ngbrRat, LastSnapshot.ngbrCount, sizeof(le_mrc_Rat_t));
+    CopyNeighborValues(ngbrUmtsEcIoPtr, ngbrUmtsEcIoSizePtr,
+                       LastSnapshot.ngbrUmtsEcIo, LastSnapshot.ngbrCount, sizeof(int32_t));
+    CopyNeighborValues(ngbrLteIntraRsrpPtr, ngbrLteIntraRsrpSizePtr,
+                       LastSnapshot.ngbrLteIntraRsrp, LastSnapshot.ngbrCount, sizeof(int32_t));
+    CopyNeighborValues(ngbrLteIntraRsrqPtr, ngbrLteIntraRsrqSizePtr,
+                       LastSnapshot.ngbrLteIntraRsrq, LastSnapshot.ngbrCount, sizeof(int32_t));
+    CopyNeighborValues(ngbrLteInterRsrpPtr, ngbrLteInterRsrpSizePtr,
+                       LastSnapshot.ngbrLteInterRsrp, LastSnapshot.ngbrCount, sizeof(int32_t));
+    CopyNeighborValues(ngbrLteInterRsrqPtr, ngbrLteInterRsrqSizePtr,
+                       LastSnapshot.ngbrLteInterRsrq, LastSnapshot.ngbrCount, sizeof(int32_t));
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to register a handler for the periodic snapshots of the serving
+ * cell, of its signal metrics and of the neighboring cells.
+ *
+ * @return A handler reference, which is only needed for later removal of the handler.
+ *
+ * @note A period lower than LE_MRC_SNAPSHOT_MIN_PERIOD seconds is raised to it.
+ *
+ * @note If the caller is passing a null handler function into this function, it's a fatal error,
+ *       the function won't return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mrc_SnapshotHandlerRef_t le_mrc_AddSnapshotHandler
+(
+    uint32_t                     period,            ///< [IN] Period of the snapshots, in seconds.
+    le_mrc_SnapshotHandlerFunc_t handlerFuncPtr,    ///< [IN] The handler function.
+    void*                        contextPtr         ///< [IN] The handler's context.
+)
+{
+    if (NULL == handlerFuncPtr)
+    {
+        LE_KILL_CLIENT("Handler function is NULL !");
+        return NULL;
+    }
+
+    if (period < LE_MRC_SNAPSHOT_MIN_PERIOD)
+    {
+        LE_WARN("Snapshot period %u s raised to %u s", period, LE_MRC_SNAPSHOT_MIN_PERIOD);
+        period = LE_MRC_SNAPSHOT_MIN_PERIOD;
+    }
+
+    SnapshotHandlerCtx_t* handlerCtxPtr = le_mem_ForceAlloc(SnapshotHandlerPool);
+    le_clk_Time_t interval = { .sec = period, .usec = 0 };
+
+    handlerCtxPtr->handlerFuncPtr = handlerFuncPtr;
+    handlerCtxPtr->handlerCtxPtr = contextPtr;
+    handlerCtxPtr->timerRef = le_timer_Create("MrcSnapshotTimer");
+    LE_ASSERT_OK(le_timer_SetInterval(handlerCtxPtr->timerRef, interval));
+    LE_ASSERT_OK(le_timer_SetRepeat(handlerCtxPtr->timerRef, 0));
+    LE_ASSERT_OK(le_timer_SetHandler(handlerCtxPtr->timerRef, SnapshotTimerHandler));
+    LE_ASSERT_OK(le_timer_SetContextPtr(handlerCtxPtr->timerRef, handlerCtxPtr));
+    LE_ASSERT_OK(le_timer_Start(handlerCtxPtr->timerRef));
+
+    return le_ref_CreateRef(SnapshotHandlerRefMap, handlerCtxPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to remove a handler for the periodic snapshots.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_mrc_RemoveSnapshotHandler
+(
+    le_mrc_SnapshotHandlerRef_t handlerRef  ///< [IN] The handler reference.
+)
+{
+    SnapshotHandlerCtx_t* handlerCtxPtr = le_ref_Lookup(SnapshotHandlerRefMap, handlerRef);
+    if (NULL == handlerCtxPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", handlerRef);
+        return;
+    }
+
+    le_ref_DeleteRef(SnapshotHandlerRefMap, handlerRef);
+    le_timer_Delete(handlerCtxPtr->timerRef);
+    le_mem_Release(handlerCtxPtr);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the Bit mask for 2G/3G Band capabilities.
@@ -23,6 +23,24 @@
 #include "le_lpt_local.h"
 #include "sysResets.h"
 #include "watchdogChain.h"
+#include "persistentCounter.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The signal event handler function for SIGTERM called from the Legato event loop of the main
+ * thread: it saves the persistent counters of all the services, then exits like the default one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TermSignalHandler
+(
+    int sigNum      ///< [IN] The signal that was received.
+)
+{
+    persistentCounter_FlushAll();
+
+    LE_CRIT("Terminated");
+    exit(EXIT_SUCCESS);
+}
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -35,6 +53,9 @@ COMPONENT_INIT
 {
     le_wdogChain_Init(MS_WDOG_COUNT);
 
+    // Replace the default SIGTERM handler installed by main(), which keeps SIGTERM blocked.
+    le_sig_SetEventHandler(SIGTERM, TermSignalHandler);
+
     le_mrc_Init();
     le_sim_Init();
     le_sms_Init();
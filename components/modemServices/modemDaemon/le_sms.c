@@ -34,6 +34,7 @@
 #include "mdmCfgEntries.h"
 #include "le_ms_local.h"
 #include "watchdogChain.h"
+#include "persistentCounter.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -69,6 +70,36 @@
 //--------------------------------------------------------------------------------------------------
 #define SMS_MAX_SESSION 5
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of batches of messages we expect to have at one time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_NUM_OF_BATCH    8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default maximum number of PDU submissions of the batches in flight (see
+ * CFG_NODE_BATCH_MAX_IN_FLIGHT): pa_sms is not known to accept concurrent submissions.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_BATCH_MAX_IN_FLIGHT     1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default maximum time a change of the message counters is kept unsaved, in seconds (see
+ * CFG_NODE_STATS_FLUSH_PERIOD).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_STATS_FLUSH_PERIOD      60
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default number of message counter changes saved at once (see CFG_NODE_STATS_FLUSH_THRESHOLD).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_STATS_FLUSH_THRESHOLD   20
+
 //--------------------------------------------------------------------------------------------------
 /**
  * SMS command Type.
@@ -107,6 +138,8 @@ typedef struct le_sms_Msg
     char              timestamp[LE_SMS_TIMESTAMP_MAX_BYTES]; ///< SMS time stamp (in text mode).
     pa_sms_Pdu_t      pdu;                                 ///< SMS PDU.
     bool              pduReady;                            ///< Is the PDU value ready?
+    bool              decodePending;                       ///< Is the PDU still to be decoded
+                                                           ///< (message of a list)?
     union
     {
         char          text[LE_SMS_TEXT_MAX_BYTES];         ///< SMS text.
@@ -188,10 +221,12 @@ typedef struct
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    bool    counting;   ///< Is message counting activated.
-    int32_t rxCount;    ///< Number of messages successfully received.
-    int32_t rxCbCount;  ///< Number of broadcast messages successfully received.
-    int32_t txCount;    ///< Number of messages successfully sent.
+    bool                            counting;   ///< Is message counting activated.
+    persistentCounter_GroupRef_t    groupRef;   ///< Saving of the counters.
+    persistentCounter_Ref_t         rxCount;    ///< Number of messages successfully received.
+    persistentCounter_Ref_t         rxCbCount;  ///< Number of broadcast messages successfully
+                                                ///< received.
+    persistentCounter_Ref_t         txCount;    ///< Number of messages successfully sent.
 }
 le_sms_MsgStats_t;
 
@@ -245,6 +280,79 @@ typedef struct
 MsgRefNode_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Received message of the message storage, in the index of the stored messages.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t         storageIdx;        ///< Message index in storage.
+    pa_sms_Storage_t storage;           ///< Storage location.
+    pa_sms_Pdu_t     pdu;               ///< PDU, with the protocol and the status of the message.
+    le_dls_Link_t    link;              ///< Link for StoredMsgList.
+}
+StoredMsg_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message of a batch.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sms_Status_t  status;            ///< Sending status.
+    uint8_t          partCount;         ///< Number of parts (PDUs) of the message.
+    uint8_t          sentPartCount;     ///< Number of parts sent.
+}
+BatchMsg_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Part of a message of a batch: a PDU, encoded when the message is added to the batch.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    BatchMsg_t*      msgPtr;            ///< Message of the part.
+    pa_sms_Pdu_t     pdu;               ///< Encoded part.
+    le_dls_Link_t    link;              ///< Link for the part list of the batch.
+}
+BatchPart_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batch of messages.
+ *
+ * Once the batch is sent, its parts are submitted by the batch workers (see SendBatchParts()), and
+ * the message statuses, isDeleted, nextPartLinkPtr and workerCount are protected by BatchMutex.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sms_BatchRef_t        batchRef;          ///< Batch reference.
+    le_msg_SessionRef_t      sessionRef;        ///< Client session reference.
+    pa_sms_Protocol_t        protocol;          ///< Transport layer protocol of the PDUs.
+    le_sms_BatchResultFunc_t handlerPtr;        ///< Callback for the sending result.
+    void*                    contextPtr;        ///< Context of the callback.
+    le_thread_Ref_t          threadRef;         ///< Thread calling the callback.
+    bool                     isSent;            ///< Has the batch been sent?
+    bool                     isDeleted;         ///< Has the batch been deleted?
+    le_dls_List_t            partList;          ///< Parts of the messages, in sending order.
+    le_dls_Link_t*           nextPartLinkPtr;   ///< Next part to submit (NULL if none).
+    uint32_t                 workerCount;       ///< Number of workers still sending the batch.
+    uint32_t                 msgCount;          ///< Number of messages.
+    BatchMsg_t               msgs[LE_SMS_BATCH_MAX_MSGS];   ///< Messages.
+}
+Batch_t;
+
+
 //--------------------------------------------------------------------------------------------------
 //                                       Static declarations
 //--------------------------------------------------------------------------------------------------
@@ -339,10 +447,76 @@ static le_event_Id_t SmsCommandEventId;
 //--------------------------------------------------------------------------------------------------
 /**
  * Semaphore to synchronize threads.
+ *
+ * The PDU submissions of the batches in flight hold it together (see StartSubmission()), the other
+ * users alone (see WaitSmsSem()).
  */
 //--------------------------------------------------------------------------------------------------
 static le_sem_Ref_t SmsSem;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turnstile of SmsSem: a thread waiting for SmsSem alone holds it, so that no new PDU submission
+ * of a batch starts meanwhile and the thread is not starved by the submissions in flight.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t SmsTurnstileMutex;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of PDU submissions of the batches in flight, and its mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t SubmissionCount;
+static le_mutex_Ref_t SubmissionMutex;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for batches of messages.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t   BatchPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for the parts of the messages of the batches.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t   BatchPartPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe Reference Map for batches.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t BatchRefMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex protecting the batches being sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t BatchMutex;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batch workers: threads submitting the parts of the batches being sent, one submission each at a
+ * time. Their number is the maximum number of submissions in flight.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_thread_Ref_t BatchWorkers[LE_SMS_BATCH_MAX_IN_FLIGHT];
+static uint32_t BatchWorkerCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference number of the next concatenated message.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t ConcatRef;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Structure for message statistics.
@@ -365,6 +539,35 @@ static bool StatusReportActivation = false;
 //--------------------------------------------------------------------------------------------------
 static le_dls_List_t  SessionCtxList;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for the index of the stored messages.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t StoredMsgPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index of the received messages of the message storage, so that the lists of messages are
+ * created without reading the storage again.
+ *
+ * The index is built by the first listing, then kept up to date with the new message indications
+ * and the deletions and status changes made through this API. It is rebuilt when a storage
+ * indication is received, when the storage can't be read, and when the SIM state changes (the SIM
+ * may have been swapped).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t StoredMsgList;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the index of the stored messages built, and was the SIM ready when it was built?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsStoredMsgIndexValid = false;
+static bool IsStoredMsgIndexSimReady = false;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -411,49 +614,39 @@ static void SetCountingState
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read the message count for a message type
+ * Get the counter of a message type
+ *
+ * @return The counter, NULL if the message type is not counted.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetMessageCount
+static persistentCounter_Ref_t GetMessageCounter
 (
-    le_sms_Type_t   messageType,        ///< [IN] Message type
-    int32_t*        messageCountPtr     ///< [OUT] Message count pointer
+    le_sms_Type_t   messageType         ///< [IN] Message type
 )
 {
-    le_cfg_IteratorRef_t iteratorRef;
-    char countPath[LE_CFG_STR_LEN_BYTES];
-
     switch (messageType)
     {
         case LE_SMS_TYPE_RX:
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_RX_COUNT);
-            break;
+            return MessageStats.rxCount;
 
         case LE_SMS_TYPE_TX:
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_TX_COUNT);
-            break;
+            return MessageStats.txCount;
 
         case LE_SMS_TYPE_BROADCAST_RX:
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_RX_CB_COUNT);
-            break;
+            return MessageStats.rxCbCount;
 
         default:
             LE_ERROR("Unknown message type %d", messageType);
-            return LE_FAULT;
+            return NULL;
     }
-
-    iteratorRef = le_cfg_CreateReadTxn(CFG_MODEMSERVICE_SMS_PATH);
-    *messageCountPtr = le_cfg_GetInt(iteratorRef, countPath, 0);
-    le_cfg_CancelTxn(iteratorRef);
-
-    LE_DEBUG("Type=%d, count=%d", messageType, *messageCountPtr);
-
-    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Write the message count for a message type
+ *
+ * The count is saved to the config tree later, with the other changes (see
+ * InitializeMessageStatistics()).
  */
 //--------------------------------------------------------------------------------------------------
 static le_result_t SetMessageCount
@@ -462,36 +655,38 @@ static le_result_t SetMessageCount
     int32_t         messageCount    ///< [IN] New message count
 )
 {
-    le_cfg_IteratorRef_t iteratorRef;
-    char countPath[LE_CFG_STR_LEN_BYTES];
+    persistentCounter_Ref_t counterRef = GetMessageCounter(messageType);
 
-    switch (messageType)
+    if (NULL == counterRef)
     {
-        case LE_SMS_TYPE_RX:
-            MessageStats.rxCount = messageCount;
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_RX_COUNT);
-            break;
+        return LE_FAULT;
+    }
 
-        case LE_SMS_TYPE_TX:
-            MessageStats.txCount = messageCount;
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_TX_COUNT);
-            break;
+    persistentCounter_Set(counterRef, messageCount);
 
-        case LE_SMS_TYPE_BROADCAST_RX:
-            MessageStats.rxCbCount = messageCount;
-            snprintf(countPath, sizeof(countPath), "%s", CFG_NODE_RX_CB_COUNT);
-            break;
+    LE_DEBUG("Type=%d, count=%d", messageType, messageCount);
 
-        default:
-            LE_ERROR("Unknown message type %d", messageType);
-            return LE_FAULT;
-    }
+    return LE_OK;
+}
 
-    iteratorRef = le_cfg_CreateWriteTxn(CFG_MODEMSERVICE_SMS_PATH);
-    le_cfg_SetInt(iteratorRef, countPath, messageCount);
-    le_cfg_CommitTxn(iteratorRef);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Increment the message count for a message type
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t IncrementMessageCount
+(
+    le_sms_Type_t   messageType     ///< [IN] Message type
+)
+{
+    persistentCounter_Ref_t counterRef = GetMessageCounter(messageType);
 
-    LE_DEBUG("Type=%d, count=%d", messageType, messageCount);
+    if (NULL == counterRef)
+    {
+        return LE_FAULT;
+    }
+
+    persistentCounter_Add(counterRef, 1);
 
     return LE_OK;
 }
@@ -499,6 +694,11 @@ static le_result_t SetMessageCount
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize message statistics structure
+ *
+ * The message counters are kept in memory and saved to the config tree in batches, so that a burst
+ * of messages does not rewrite the config tree for each message. A crash loses the changes of the
+ * last CFG_NODE_STATS_FLUSH_PERIOD seconds at most, and less than CFG_NODE_STATS_FLUSH_THRESHOLD
+ * changes.
  */
 //--------------------------------------------------------------------------------------------------
 static void InitializeMessageStatistics
@@ -506,19 +706,38 @@ static void InitializeMessageStatistics
     void
 )
 {
+    le_cfg_IteratorRef_t iteratorRef;
+    int32_t flushPeriod;
+    int32_t flushThreshold;
+
     MessageStats.counting = GetCountingState();
-    if (LE_OK != GetMessageCount(LE_SMS_TYPE_RX, &MessageStats.rxCount))
-    {
-        LE_ERROR("Unable to retrieve received message count");
-    }
-    if (LE_OK != GetMessageCount(LE_SMS_TYPE_TX, &MessageStats.txCount))
+
+    iteratorRef = le_cfg_CreateReadTxn(CFG_MODEMSERVICE_SMS_PATH);
+    flushPeriod = le_cfg_GetInt(iteratorRef, CFG_NODE_STATS_FLUSH_PERIOD,
+                                SMS_STATS_FLUSH_PERIOD);
+    flushThreshold = le_cfg_GetInt(iteratorRef, CFG_NODE_STATS_FLUSH_THRESHOLD,
+                                   SMS_STATS_FLUSH_THRESHOLD);
+    le_cfg_CancelTxn(iteratorRef);
+
+    if ((flushPeriod < 0) || (flushPeriod > (int32_t)(UINT32_MAX / 1000)))
     {
-        LE_ERROR("Unable to retrieve sent message count");
+        LE_ERROR("Invalid statistics flush period %d", flushPeriod);
+        flushPeriod = SMS_STATS_FLUSH_PERIOD;
     }
-    if (LE_OK != GetMessageCount(LE_SMS_TYPE_BROADCAST_RX, &MessageStats.rxCbCount))
+    if (flushThreshold < 0)
     {
-        LE_ERROR("Unable to retrieve received broadcast message count");
+        LE_ERROR("Invalid statistics flush threshold %d", flushThreshold);
+        flushThreshold = SMS_STATS_FLUSH_THRESHOLD;
     }
+
+    LE_DEBUG("Statistics flushed every %d s or %d changes", flushPeriod, flushThreshold);
+
+    MessageStats.groupRef = persistentCounter_CreateGroup(CFG_MODEMSERVICE_SMS_PATH,
+                                                          flushPeriod * 1000, flushThreshold);
+    MessageStats.rxCount = persistentCounter_Create(MessageStats.groupRef, CFG_NODE_RX_COUNT);
+    MessageStats.txCount = persistentCounter_Create(MessageStats.groupRef, CFG_NODE_TX_COUNT);
+    MessageStats.rxCbCount = persistentCounter_Create(MessageStats.groupRef,
+                                                      CFG_NODE_RX_CB_COUNT);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -564,6 +783,61 @@ static void SetStatusReportState
     StatusReportActivation = statusReportState;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for SmsSem, to use it alone.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaitSmsSem
+(
+    void
+)
+{
+    le_mutex_Lock(SmsTurnstileMutex);
+    le_sem_Wait(SmsSem);
+    le_mutex_Unlock(SmsTurnstileMutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a PDU submission of a batch: the first submission in flight waits for SmsSem, and the
+ * following ones share it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartSubmission
+(
+    void
+)
+{
+    le_mutex_Lock(SmsTurnstileMutex);
+    le_mutex_Unlock(SmsTurnstileMutex);
+
+    le_mutex_Lock(SubmissionMutex);
+    if (0 == SubmissionCount++)
+    {
+        le_sem_Wait(SmsSem);
+    }
+    le_mutex_Unlock(SubmissionMutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a PDU submission of a batch: the last submission in flight posts SmsSem.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndSubmission
+(
+    void
+)
+{
+    le_mutex_Lock(SubmissionMutex);
+    if (0 == --SubmissionCount)
+    {
+        le_sem_Post(SmsSem);
+    }
+    le_mutex_Unlock(SubmissionMutex);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Re-initialize a List.
@@ -906,32 +1180,23 @@ static le_result_t PopulateSmsStatusReport
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create and Populate a new message object from a PDU.
+ * Populate a message object from a decoded PDU.
  *
+ * @return LE_OK     The message is populated.
+ * @return LE_FAULT  The message type or format is not supported.
  */
 //--------------------------------------------------------------------------------------------------
-static le_sms_Msg_t* CreateAndPopulateMessage
+static le_result_t PopulateMessage
 (
-    uint32_t            storageIdx,     ///< [IN] Storage index.
-    pa_sms_Pdu_t*       pduMsgPtr,      ///< [IN] PDU message.
-    pa_sms_Message_t*   decodedMsgPtr   ///< [IN] Decoded Message.
+    le_sms_Msg_t*       newSmsMsgObjPtr,    ///< [IN] Message object pointer.
+    pa_sms_Pdu_t*       pduMsgPtr,          ///< [IN] PDU message.
+    pa_sms_Message_t*   decodedMsgPtr       ///< [IN] Decoded Message.
 )
 {
-    // Create and populate the SMS message object (it is Read Only).
-    le_sms_Msg_t* newSmsMsgObjPtr;
-
-    // Create the message node.
-    newSmsMsgObjPtr = CreateMessage(storageIdx, pduMsgPtr);
-
     switch (decodedMsgPtr->type)
     {
         case PA_SMS_DELIVER:
-            if (LE_OK != PopulateSmsDeliver(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr))
-            {
-                le_mem_Release(newSmsMsgObjPtr);
-                newSmsMsgObjPtr = NULL;
-            }
-            break;
+            return PopulateSmsDeliver(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr);
 
         case PA_SMS_PDU:
             newSmsMsgObjPtr->type = LE_SMS_TYPE_RX;
@@ -939,45 +1204,235 @@ static le_sms_Msg_t* CreateAndPopulateMessage
             LE_WARN_IF((pduMsgPtr->dataLen > LE_SMS_PDU_MAX_BYTES),
                        "pduMsgPtr->dataLen=%d > LE_SMS_PDU_MAX_BYTES=%d",
                        pduMsgPtr->dataLen, LE_SMS_PDU_MAX_BYTES);
-            break;
+            return LE_OK;
 
         case PA_SMS_CELL_BROADCAST:
-            if (LE_OK != PopulateSmsCellBroadcast(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr))
-            {
-                le_mem_Release(newSmsMsgObjPtr);
-                newSmsMsgObjPtr = NULL;
-            }
-            break;
+            return PopulateSmsCellBroadcast(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr);
 
         case PA_SMS_STATUS_REPORT:
-            if (LE_OK != PopulateSmsStatusReport(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr))
-            {
-                le_mem_Release(newSmsMsgObjPtr);
-                newSmsMsgObjPtr = NULL;
-            }
-            break;
+            return PopulateSmsStatusReport(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr);
 
         default:
             LE_CRIT("Unknown or not supported SMS type %d", decodedMsgPtr->type);
-            le_mem_Release(newSmsMsgObjPtr);
-            return NULL;
+            return LE_FAULT;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create and Populate a new message object from a PDU.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_Msg_t* CreateAndPopulateMessage
+(
+    uint32_t            storageIdx,     ///< [IN] Storage index.
+    pa_sms_Pdu_t*       pduMsgPtr,      ///< [IN] PDU message.
+    pa_sms_Message_t*   decodedMsgPtr   ///< [IN] Decoded Message.
+)
+{
+    // Create and populate the SMS message object (it is Read Only).
+    le_sms_Msg_t* newSmsMsgObjPtr;
+
+    // Create the message node.
+    newSmsMsgObjPtr = CreateMessage(storageIdx, pduMsgPtr);
+
+    if (LE_OK != PopulateMessage(newSmsMsgObjPtr, pduMsgPtr, decodedMsgPtr))
+    {
+        le_mem_Release(newSmsMsgObjPtr);
+        return NULL;
+    }
+
+    return newSmsMsgObjPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode the PDU of a message of a list, the first time the message is returned to the client.
+ * A message which can't be decoded is kept as a PDU message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DecodeListedMessage
+(
+    le_sms_MsgRef_t msgRef  ///< [IN] The message.
+)
+{
+    pa_sms_Message_t messageConverted;
+    pa_sms_Pdu_t     messagePdu;
+    le_sms_Msg_t*    msgPtr = le_ref_Lookup(MsgRefMap, msgRef);
+
+    if ((NULL == msgPtr) || (!msgPtr->decodePending))
+    {
+        return;
+    }
+    msgPtr->decodePending = false;
+
+    // Populating the message may overwrite its PDU.
+    memcpy(&messagePdu, &msgPtr->pdu, sizeof(pa_sms_Pdu_t));
+
+    if (smsPdu_Decode(messagePdu.protocol,
+                      messagePdu.data,
+                      messagePdu.dataLen,
+                      true,
+                      &messageConverted) != LE_OK)
+    {
+        LE_WARN("Could not decode the message (idx.%d)", msgPtr->storageIdx);
+        return;
+    }
+
+    if (LE_OK != PopulateMessage(msgPtr, &messagePdu, &messageConverted))
+    {
+        LE_ERROR("Cannot populate the message (idx.%d), keep it as a PDU", msgPtr->storageIdx);
+        msgPtr->type = LE_SMS_TYPE_RX;
+        msgPtr->format = LE_SMS_FORMAT_PDU;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a message in the index of the stored messages.
+ *
+ * @return The message, or NULL if it is not in the index.
+ */
+//--------------------------------------------------------------------------------------------------
+static StoredMsg_t* FindStoredMessage
+(
+    uint32_t            storageIdx,     ///< [IN] Storage index.
+    pa_sms_Protocol_t   protocol,       ///< [IN] Protocol.
+    pa_sms_Storage_t    storage         ///< [IN] Storage used.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StoredMsgList);
+
+    while (linkPtr)
+    {
+        StoredMsg_t* storedMsgPtr = CONTAINER_OF(linkPtr, StoredMsg_t, link);
+
+        if (   (storedMsgPtr->storageIdx == storageIdx)
+            && (storedMsgPtr->pdu.protocol == protocol)
+            && (storedMsgPtr->storage == storage))
+        {
+            return storedMsgPtr;
+        }
+        linkPtr = le_dls_PeekNext(&StoredMsgList, linkPtr);
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a received message to the index of the stored messages. It replaces the message which had
+ * the same storage index, if any.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddStoredMessage
+(
+    uint32_t            storageIdx,     ///< [IN] Storage index.
+    pa_sms_Storage_t    storage,        ///< [IN] Storage used.
+    const pa_sms_Pdu_t* pduMsgPtr       ///< [IN] PDU message.
+)
+{
+    StoredMsg_t* storedMsgPtr = FindStoredMessage(storageIdx, pduMsgPtr->protocol, storage);
+
+    if (NULL == storedMsgPtr)
+    {
+        storedMsgPtr = (StoredMsg_t*)le_mem_ForceAlloc(StoredMsgPool);
+        storedMsgPtr->storageIdx = storageIdx;
+        storedMsgPtr->storage = storage;
+        storedMsgPtr->link = LE_DLS_LINK_INIT;
+        le_dls_Queue(&StoredMsgList, &(storedMsgPtr->link));
+    }
+
+    memcpy(&(storedMsgPtr->pdu), pduMsgPtr, sizeof(pa_sms_Pdu_t));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the status of a message in the index of the stored messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetStoredMessageStatus
+(
+    le_sms_Msg_t* msgPtr    ///< [IN] Message object pointer.
+)
+{
+    StoredMsg_t* storedMsgPtr = FindStoredMessage(msgPtr->storageIdx, msgPtr->protocol,
+                                                  msgPtr->storage);
+
+    if (storedMsgPtr)
+    {
+        storedMsgPtr->pdu.status = msgPtr->pdu.status;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a deleted message from the index of the stored messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveStoredMessage
+(
+    le_sms_Msg_t* msgPtr    ///< [IN] Message object pointer.
+)
+{
+    StoredMsg_t* storedMsgPtr = FindStoredMessage(msgPtr->storageIdx, msgPtr->protocol,
+                                                  msgPtr->storage);
+
+    if (storedMsgPtr)
+    {
+        le_dls_Remove(&StoredMsgList, &(storedMsgPtr->link));
+        le_mem_Release(storedMsgPtr);
     }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Empty the index of the stored messages. It is built again by the next listing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InvalidateStoredMessages
+(
+    void
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    while ((linkPtr = le_dls_Pop(&StoredMsgList)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, StoredMsg_t, link));
+    }
+
+    IsStoredMsgIndexValid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function for the new SIM state notifications: another SIM, with other messages, may have
+ * been inserted, so the index of the stored messages is built again by the next listing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SimStateHandler
+(
+    pa_sim_Event_t* eventPtr    ///< [IN] The new SIM state.
+)
+{
+    LE_DEBUG("New SIM state %d for SIM %d", eventPtr->state, eventPtr->simId);
+    InvalidateStoredMessages();
 
-    return newSmsMsgObjPtr;
+    le_mem_Release(eventPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Retrieve messages from memory. A new message object is created for each retrieved message and
- * then queued to the list of received messages.
+ * Retrieve messages from memory. Each retrieved message which is not a SMS-SUBMIT is added to the
+ * index of the stored messages (its PDU is decoded when it is listed).
  *
- * @return LE_FAULT          In case of failure
- * @return A positive value  The number of messages read in memory
+ * @return The number of messages added to the index.
  */
 //--------------------------------------------------------------------------------------------------
-static int32_t GetMessagesFromMem
+static int32_t IndexMessagesFromMem
 (
-    le_sms_List_t      *msgListObjPtr, ///< [OUT]List of received messages.
     pa_sms_Protocol_t   protocol,      ///< [IN] protocol to read.
     uint32_t            numOfMsg,      ///< [IN]Number of message to read from memory.
     uint32_t           *arrayPtr,      ///< [IN]Array of message indexes.
@@ -986,24 +1441,19 @@ static int32_t GetMessagesFromMem
 {
     pa_sms_Pdu_t messagePdu;
     uint32_t     i;
-    uint32_t     numOfQueuedMsg=0;
+    uint32_t     numOfIndexedMsg=0;
 
-    if (msgListObjPtr == NULL)
-    {
-        LE_FATAL("msgListObjPtr is NULL !");
-    }
     if (arrayPtr == NULL)
     {
         LE_FATAL("arrayPtr is NULL !");
     }
 
-    // Get Unread messages.
     for (i=0 ; i < numOfMsg ; i++)
     {
         // Try to read message for protocol mode.
         le_result_t res;
 
-        le_sem_Wait(SmsSem);
+        WaitSmsSem();
         res = pa_sms_RdPDUMsgFromMem(arrayPtr[i],protocol, storage, &messagePdu);
         le_sem_Post(SmsSem);
 
@@ -1021,90 +1471,29 @@ static int32_t GetMessagesFromMem
             continue;
         }
 
-        // Try to decode message.
-        pa_sms_Message_t messageConverted;
+        // Only the header is decoded here: messages which can't be decoded are listed as PDUs.
+        pa_sms_MsgType_t type;
 
-        if (smsPdu_Decode(messagePdu.protocol,
-                          messagePdu.data,
-                          messagePdu.dataLen,
-                          true,
-                          &messageConverted) == LE_OK)
-        {
-            if (messageConverted.type != PA_SMS_SUBMIT)
-            {
-                le_sms_Msg_t* newSmsMsgObjPtr = CreateAndPopulateMessage(arrayPtr[i],
-                                &messagePdu,
-                                &messageConverted);
-                if (newSmsMsgObjPtr == NULL)
-                {
-                    LE_ERROR("Cannot create a new message object! Jump to next one...");
-                    continue;
-                }
-                // Store sms area storage information.
-                newSmsMsgObjPtr->storage = storage;
-                newSmsMsgObjPtr->inAList = true;
-
-                // Allocate a new node message for the List SMS Message node.
-                le_sms_MsgReference_t* newReferencePtr =
-                                (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
-
-                // Create a Safe Reference for this Message object.
-                newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
-                (newSmsMsgObjPtr->smsUserCount)++;
-
-                LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
-                    newReferencePtr, newSmsMsgObjPtr,
-                    newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
-
-                newReferencePtr->listLink = LE_DLS_LINK_INIT;
-                // Insert the message in the List SMS Message node.
-                le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
-                numOfQueuedMsg++;
-            }
-            else
-            {
-                LE_WARN("Unexpected message type %d for message %d",
-                                messageConverted.type,
-                                arrayPtr[i]);
-            }
-        }
-        else
+        if ((smsPdu_GetType(messagePdu.protocol,
+                            messagePdu.data,
+                            messagePdu.dataLen,
+                            true,
+                            &type) == LE_OK) && (type == PA_SMS_SUBMIT))
         {
-            LE_WARN("Could not decode the message (idx.%d)", arrayPtr[i]);
-            le_sms_Msg_t* newSmsMsgObjPtr = CreateMessage(arrayPtr[i], &messagePdu);
-            if (newSmsMsgObjPtr == NULL)
-            {
-                LE_ERROR("Cannot create a new message object! Jump to next one...");
-                continue;
-            }
-            // Store sms area storage information.
-            newSmsMsgObjPtr->storage = storage;
-            newSmsMsgObjPtr->inAList = true;
-
-            // Allocate a new node message for the List SMS Message node.
-            le_sms_MsgReference_t* newReferencePtr =
-                            (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
-            // Create a Safe Reference for this Message object.
-            newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
-            (newSmsMsgObjPtr->smsUserCount)++;
-
-            LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
-                newReferencePtr, newSmsMsgObjPtr,
-                newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
-
-            newReferencePtr->listLink = LE_DLS_LINK_INIT;
-            // Insert the message in the List SMS Message node.
-            le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
-            numOfQueuedMsg++;
+            LE_WARN("Unexpected message type %d for message %d", type, arrayPtr[i]);
+            continue;
         }
+
+        AddStoredMessage(arrayPtr[i], storage, &messagePdu);
+        numOfIndexedMsg++;
     }
 
-    return numOfQueuedMsg;
+    return numOfIndexedMsg;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * This function must be called to list the Received Messages present in the message storage.
+ * This function must be called to index the Received Messages present in the message storage.
  *
  * @return LE_NO_MEMORY      The message storage is not available.
  * @return LE_FAULT          The function failed to list messages.
@@ -1112,9 +1501,8 @@ static int32_t GetMessagesFromMem
  *                           zero (no messages).
  */
 //--------------------------------------------------------------------------------------------------
-static int32_t ListReceivedMessages
+static int32_t IndexReceivedMessages
 (
-    le_sms_List_t      *msgListObjPtr,  ///< List of received messages.
     pa_sms_Protocol_t   protocol,       ///< [IN] protocol to read.
     le_sms_Status_t     status,         ///< [IN] status to read.
     pa_sms_Storage_t    storage         ///< [IN] Storage used.
@@ -1126,13 +1514,8 @@ static int32_t ListReceivedMessages
     /* Arrays to store IDs of messages saved in the storage area.*/
     uint32_t     idxArray[MAX_NUM_OF_SMS_MSG_IN_STORAGE]={0};
 
-    if (msgListObjPtr == NULL)
-    {
-        LE_FATAL("msgListObjPtr is NULL !");
-    }
-
     /* Get Indexes. */
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     result = pa_sms_ListMsgFromMem(status, protocol, &numTot, idxArray, storage);
     le_sem_Post(SmsSem);
 
@@ -1145,22 +1528,10 @@ static int32_t ListReceivedMessages
     /* Retrieve messages. */
     if ((numTot > 0) && (numTot < MAX_NUM_OF_SMS_MSG_IN_STORAGE))
     {
-        int32_t retValue;
-
-        retValue = GetMessagesFromMem(msgListObjPtr, protocol, numTot, idxArray, storage);
-        if(retValue == LE_FAULT)
-        {
-            LE_WARN("No message retrieve for protocol %d", protocol);
-        }
-        else
-        {
-            msgCount = retValue;
-        }
-
+        msgCount = IndexMessagesFromMem(protocol, numTot, idxArray, storage);
     }
     else if (numTot == 0)
     {
-        result = LE_OK;
         msgCount = 0;
     }
     else
@@ -1174,114 +1545,96 @@ static int32_t ListReceivedMessages
 
 //--------------------------------------------------------------------------------------------------
 /**
- * This function must be called to list the Received Messages present in the message storage.
+ * Build the index of the stored messages, with the Received Messages present in the message
+ * storage.
  *
  * @return
  * - LE_FAULT          The function failed to list messages.
- * - A positive value  The number of messages present in the storage area, it can be equal to
- *                       zero (no messages).
+ * - LE_OK             The function succeeded.
  */
 //--------------------------------------------------------------------------------------------------
-static int32_t ListAllReceivedMessages
+static le_result_t IndexAllReceivedMessages
 (
-    le_sms_List_t* msgListObjPtr ///< List of received messages.
+    bool isSimReady     ///< [IN] Is the SIM ready?
 )
 {
     int32_t    res, msgCount = 0;
-    le_sim_States_t state;
 
-    if (msgListObjPtr == NULL)
-    {
-        LE_FATAL("msgListObjPtr is NULL !");
-    }
+    InvalidateStoredMessages();
 
     // Check if a SIM is available to list SMS present.
-    if (pa_sim_GetState(&state) == LE_OK)
+    if (isSimReady)
     {
-        if(state == LE_SIM_READY)
+        // Retrieve message Read for protocol GSM in SIM storage.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_GSM, LE_SMS_RX_READ, PA_SMS_STORAGE_SIM);
+        if (res < 0)
         {
-            // Retrieve message Read for protocol GSM in SIM storage.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_GSM, LE_SMS_RX_READ,
-                            PA_SMS_STORAGE_SIM);
-            if (res < 0)
-            {
-                LE_ERROR("SMS read Sim storage is not available, return %d",res);
-                return LE_FAULT;
-            }
-            msgCount += res;
+            LE_ERROR("SMS read Sim storage is not available, return %d",res);
+            InvalidateStoredMessages();
+            return LE_FAULT;
+        }
+        msgCount += res;
 
-            // Retrieve message unRead for protocol GSM in SIM storage.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_GSM, LE_SMS_RX_UNREAD,
-                            PA_SMS_STORAGE_SIM);
-            if (res < 0)
-            {
-                LE_ERROR("SMS unread Sim storage is not available, return %d",res);
-                return LE_FAULT;
-            }
-            msgCount += res;
+        // Retrieve message unRead for protocol GSM in SIM storage.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_GSM, LE_SMS_RX_UNREAD, PA_SMS_STORAGE_SIM);
+        if (res < 0)
+        {
+            LE_ERROR("SMS unread Sim storage is not available, return %d",res);
+            InvalidateStoredMessages();
+            return LE_FAULT;
+        }
+        msgCount += res;
 
-            // GSM SMS memory storage is not available if SIM is not ready.
-            // Retrieve message Read for protocol GSM in memory storage.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_GSM, LE_SMS_RX_READ,
-                            PA_SMS_STORAGE_NV);
-            if (res < 0)
-            {
-                LE_ERROR("SMS read memory storage is not available, return %d",res);
-                return LE_FAULT;
-            }
-            msgCount += res;
+        // GSM SMS memory storage is not available if SIM is not ready.
+        // Retrieve message Read for protocol GSM in memory storage.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_GSM, LE_SMS_RX_READ, PA_SMS_STORAGE_NV);
+        if (res < 0)
+        {
+            LE_ERROR("SMS read memory storage is not available, return %d",res);
+            InvalidateStoredMessages();
+            return LE_FAULT;
+        }
+        msgCount += res;
 
-            // GSM SMS memory storage is not available if SIM is not ready.
-            // Retrieve message unRead for protocol GSM in memory storage.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_GSM, LE_SMS_RX_UNREAD,
-                            PA_SMS_STORAGE_NV);
-            if (res < 0)
-            {
-                LE_ERROR("SMS unread memory storage is not available, return %d",res);
-                return LE_FAULT;
-            }
-            msgCount += res;
+        // GSM SMS memory storage is not available if SIM is not ready.
+        // Retrieve message unRead for protocol GSM in memory storage.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_GSM, LE_SMS_RX_UNREAD, PA_SMS_STORAGE_NV);
+        if (res < 0)
+        {
+            LE_ERROR("SMS unread memory storage is not available, return %d",res);
+            InvalidateStoredMessages();
+            return LE_FAULT;
+        }
+        msgCount += res;
 
-            // No way to know if CDMA SMS sim storage is available.
-            // Retrieve message Read for protocol CDMA.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_READ,
-                            PA_SMS_STORAGE_SIM);
-            if (res < 0)
-            {
-                LE_WARN("SMS CDMA read sim storage is not available, return %d", res);
-            }
-            else
-            {
-                msgCount += res;
-            }
+        // No way to know if CDMA SMS sim storage is available.
+        // Retrieve message Read for protocol CDMA.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_READ, PA_SMS_STORAGE_SIM);
+        if (res < 0)
+        {
+            LE_WARN("SMS CDMA read sim storage is not available, return %d", res);
+        }
+        else
+        {
+            msgCount += res;
+        }
 
-            // No way to know if CDMA SMS sim storage is available.
-            // Retrieve message unRead for protocol CDMA.
-            res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_UNREAD,
-                            PA_SMS_STORAGE_SIM);
-            if (res < 0)
-            {
-                LE_WARN("SMS CDMA unread sim storage is not available, return %d", res);
-            }
-            else
-            {
-                msgCount += res;
-            }
+        // No way to know if CDMA SMS sim storage is available.
+        // Retrieve message unRead for protocol CDMA.
+        res = IndexReceivedMessages(PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_UNREAD, PA_SMS_STORAGE_SIM);
+        if (res < 0)
+        {
+            LE_WARN("SMS CDMA unread sim storage is not available, return %d", res);
         }
         else
         {
-            LE_WARN("Sim not ready");
+            msgCount += res;
         }
     }
-    else
-    {
-        LE_WARN("Sim not present");
-    }
 
     // No way to know if CDMA SMS memory storage is available.
     // Retrieve message Read for protocol CDMA.
-    res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_READ,
-                    PA_SMS_STORAGE_NV);
+    res = IndexReceivedMessages(PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_READ, PA_SMS_STORAGE_NV);
     if (res < 0)
     {
         LE_WARN("SMS CDMA read memory storage is not available, return %d", res);
@@ -1293,8 +1646,7 @@ static int32_t ListAllReceivedMessages
 
     // No way to know if CDMA SMS memory storage is available.
     // Retrieve message unRead for protocol CDMA.
-    res = ListReceivedMessages(msgListObjPtr, PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_UNREAD,
-                    PA_SMS_STORAGE_NV);
+    res = IndexReceivedMessages(PA_SMS_PROTOCOL_CDMA, LE_SMS_RX_UNREAD, PA_SMS_STORAGE_NV);
     if (res < 0)
     {
         LE_WARN("SMS CDMA unread memory storage is not available, return %d", res);
@@ -1304,7 +1656,98 @@ static int32_t ListAllReceivedMessages
         msgCount += res;
     }
 
-    // Check if almost one SMS storage has been read.
+    LE_DEBUG("%d stored messages indexed", msgCount);
+
+    IsStoredMsgIndexValid = true;
+    IsStoredMsgIndexSimReady = isSimReady;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to list the Received Messages present in the message storage.
+ * The messages are taken from the index of the stored messages, which is built first if needed.
+ *
+ * @return
+ * - LE_FAULT          The function failed to list messages.
+ * - A positive value  The number of messages present in the storage area, it can be equal to
+ *                       zero (no messages).
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t ListAllReceivedMessages
+(
+    le_sms_List_t* msgListObjPtr ///< List of received messages.
+)
+{
+    int32_t    msgCount = 0;
+    le_sim_States_t state;
+    bool isSimReady = false;
+
+    if (msgListObjPtr == NULL)
+    {
+        LE_FATAL("msgListObjPtr is NULL !");
+    }
+
+    // Check if a SIM is available to list SMS present.
+    if (pa_sim_GetState(&state) == LE_OK)
+    {
+        if(state == LE_SIM_READY)
+        {
+            isSimReady = true;
+        }
+        else
+        {
+            LE_WARN("Sim not ready");
+        }
+    }
+    else
+    {
+        LE_WARN("Sim not present");
+    }
+
+    // The SIM storage and the GSM memory storage are only indexed with a SIM ready.
+    if ((!IsStoredMsgIndexValid) || (isSimReady != IsStoredMsgIndexSimReady))
+    {
+        if (IndexAllReceivedMessages(isSimReady) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    // Create a message object for each stored message. The PDUs are decoded when the messages are
+    // returned by le_sms_GetFirst() and le_sms_GetNext().
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StoredMsgList);
+    while (linkPtr)
+    {
+        StoredMsg_t* storedMsgPtr = CONTAINER_OF(linkPtr, StoredMsg_t, link);
+        le_sms_Msg_t* newSmsMsgObjPtr = CreateMessage(storedMsgPtr->storageIdx,
+                                                      &(storedMsgPtr->pdu));
+
+        linkPtr = le_dls_PeekNext(&StoredMsgList, linkPtr);
+
+        // Store sms area storage information.
+        newSmsMsgObjPtr->storage = storedMsgPtr->storage;
+        newSmsMsgObjPtr->inAList = true;
+        newSmsMsgObjPtr->decodePending = true;
+
+        // Allocate a new node message for the List SMS Message node.
+        le_sms_MsgReference_t* newReferencePtr =
+                        (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
+
+        // Create a Safe Reference for this Message object.
+        newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
+        (newSmsMsgObjPtr->smsUserCount)++;
+
+        LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
+            newReferencePtr, newSmsMsgObjPtr,
+            newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
+
+        newReferencePtr->listLink = LE_DLS_LINK_INIT;
+        // Insert the message in the List SMS Message node.
+        le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
+        msgCount++;
+    }
+
     return msgCount;
 }
 
@@ -1676,7 +2119,7 @@ static void NewSmsHandler
 
     if (newMessageIndicationPtr->storage != PA_SMS_STORAGE_NONE)
     {
-        le_sem_Wait(SmsSem);
+        WaitSmsSem();
         res = pa_sms_RdPDUMsgFromMem(newMessageIndicationPtr->msgIndex,
                                      newMessageIndicationPtr->protocol,
                                      newMessageIndicationPtr->storage,
@@ -1701,6 +2144,9 @@ static void NewSmsHandler
     if (LE_OK != res)
     {
         LE_ERROR("pa_sms_RdPDUMsgFromMem failed");
+
+        // The index of the stored messages misses this one.
+        InvalidateStoredMessages();
         return;
     }
 
@@ -1733,6 +2179,18 @@ static void NewSmsHandler
         newSmsMsgObjPtr = CreateMessage(newMessageIndicationPtr->msgIndex, &messagePdu);
     }
 
+    // Add the received message to the index of the stored messages, as a listing would.
+    if (   (IsStoredMsgIndexValid)
+        && (newMessageIndicationPtr->storage != PA_SMS_STORAGE_NONE)
+        && (messagePdu.dataLen <= LE_SMS_PDU_MAX_BYTES)
+        && ((messagePdu.status == LE_SMS_RX_READ) || (messagePdu.status == LE_SMS_RX_UNREAD))
+        && ((LE_OK != res) || (messageConverted.type != PA_SMS_SUBMIT)))
+    {
+        AddStoredMessage(newMessageIndicationPtr->msgIndex,
+                         newMessageIndicationPtr->storage,
+                         &messagePdu);
+    }
+
     if (newSmsMsgObjPtr == NULL)
     {
         LE_CRIT("Cannot create a new message object, no report!");
@@ -1746,11 +2204,11 @@ static void NewSmsHandler
     {
         if (LE_SMS_TYPE_RX == newSmsMsgObjPtr->type)
         {
-            SetMessageCount(newSmsMsgObjPtr->type, MessageStats.rxCount + 1);
+            IncrementMessageCount(newSmsMsgObjPtr->type);
         }
         else if (LE_SMS_TYPE_BROADCAST_RX == newSmsMsgObjPtr->type)
         {
-            SetMessageCount(newSmsMsgObjPtr->type, MessageStats.rxCbCount + 1);
+            IncrementMessageCount(newSmsMsgObjPtr->type);
         }
         else if (LE_SMS_TYPE_STATUS_REPORT == newSmsMsgObjPtr->type)
         {
@@ -1833,6 +2291,10 @@ static void StorageIndicationHandler
         }
     }
 
+    // The storage may have changed without a new message indication: build the index of the
+    // stored messages again at the next listing.
+    InvalidateStoredMessages();
+
     // Notify all the registered client's handlers with own reference.
     le_event_Report(StorageStatusEventId, (void*)&storage, sizeof(le_sms_Storage_t));
 
@@ -1998,7 +2460,7 @@ static void SendSmsSendingStateEvent
         // Update sent message count if necessary
         if ((MessageStats.counting) && (LE_SMS_SENT == msgPtr->pdu.status))
         {
-            SetMessageCount(LE_SMS_TYPE_TX, MessageStats.txCount + 1);
+            IncrementMessageCount(LE_SMS_TYPE_TX);
         }
 
         Myfunction(messageRef, msgPtr->pdu.status, msgPtr->ctxPtr);
@@ -2037,7 +2499,7 @@ static void AsynSmsTimerHandler
         return;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
 
     msgPtr->timeoutExpires = true;
     le_timer_Delete(timerRef);
@@ -2197,7 +2659,7 @@ static void ProcessSmsSendingCommandHandler
                 int32_t remainingTime = PA_SMS_SENDING_TIMEOUT;
                 le_result_t res = LE_TIMEOUT;
 
-                le_sem_Wait(SmsSem);
+                WaitSmsSem();
                 LE_DEBUG("timer ref %p, ", msgPtr->timerRef);
                 if (msgPtr->timerRef)
                 {
@@ -2258,33 +2720,210 @@ static void ProcessSmsSendingCommandHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * This thread does the actual work of Pool and send a SMS.
+ * This thread does the actual work of Pool and send a SMS.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* SmsSenderThread
+(
+    void* contextPtr
+)
+{
+    LE_INFO("Sms command Thread started");
+
+    // Connect to services used by this thread
+    le_cfg_ConnectService();
+
+    // Register for SMS command events.
+    le_event_AddHandler(WDOG_THREAD_NAME_SMS_COMMAND_SENDING, SmsCommandEventId,
+        ProcessSmsSendingCommandHandler);
+
+    le_sem_Post(SmsSem);
+
+    // Watchdog SMS event loop
+    // Try to kick a couple of times before each timeout.
+    le_clk_Time_t watchdogInterval = { .sec = MS_WDOG_INTERVAL };
+    le_wdogChain_MonitorEventLoop(MS_WDOG_SMS_LOOP, watchdogInterval);
+
+    // Run the event loop
+    le_event_RunLoop();
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor of a batch: releases its parts.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchDestructor
+(
+    void* objPtr    ///< [IN] The batch.
+)
+{
+    Batch_t* batchPtr = objPtr;
+    le_dls_Link_t* linkPtr;
+
+    while ((linkPtr = le_dls_Pop(&batchPtr->partList)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, BatchPart_t, link));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the sending result of a batch, in the thread which sent it, and release the reference to
+ * the batch of its last worker.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportBatchResult
+(
+    void* param1Ptr,    ///< [IN] The batch.
+    void* param2Ptr     ///< [IN] Unused.
+)
+{
+    Batch_t* batchPtr = param1Ptr;
+    uint32_t sentCount = 0;
+    uint32_t i;
+
+    // The workers are done with the batch, and it is deleted by this thread.
+    if (!batchPtr->isDeleted)
+    {
+        for (i = 0; i < batchPtr->msgCount; i++)
+        {
+            if (LE_SMS_SENT == batchPtr->msgs[i].status)
+            {
+                sentCount++;
+            }
+        }
+
+        LE_INFO("Batch %p: %u messages sent, %u failed",
+                batchPtr->batchRef, sentCount, batchPtr->msgCount - sentCount);
+        batchPtr->handlerPtr(batchPtr->batchRef, sentCount, batchPtr->msgCount - sentCount,
+                             batchPtr->contextPtr);
+    }
+
+    le_mem_Release(batchPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function queued to a batch worker to send a batch: submits the next part of the batch to the
+ * modem, until there is none left or the batch is deleted.
+ *
+ * pa_sms_SendPduMsg() waits for the end of the submission, so the workers sending a batch keep
+ * that many submissions in flight. They hold SmsSem together meanwhile.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendBatchParts
+(
+    void* param1Ptr,    ///< [IN] The batch, with a reference for this worker.
+    void* param2Ptr     ///< [IN] Unused.
+)
+{
+    Batch_t* batchPtr = param1Ptr;
+
+    le_mutex_Lock(BatchMutex);
+    while ((!batchPtr->isDeleted) && (NULL != batchPtr->nextPartLinkPtr))
+    {
+        BatchPart_t* partPtr = CONTAINER_OF(batchPtr->nextPartLinkPtr, BatchPart_t, link);
+        BatchMsg_t* msgPtr = partPtr->msgPtr;
+
+        batchPtr->nextPartLinkPtr = le_dls_PeekNext(&batchPtr->partList,
+                                                    batchPtr->nextPartLinkPtr);
+        le_mutex_Unlock(BatchMutex);
+
+        StartSubmission();
+        le_result_t res = pa_sms_SendPduMsg(batchPtr->protocol,
+                                            partPtr->pdu.dataLen, partPtr->pdu.data,
+                                            PA_SMS_SENDING_TIMEOUT, &partPtr->pdu.errorCode);
+        EndSubmission();
+
+        le_mutex_Lock(BatchMutex);
+        if (LE_OK == res)
+        {
+            if (++msgPtr->sentPartCount == msgPtr->partCount)
+            {
+                msgPtr->status = LE_SMS_SENT;
+
+                // Update sent message count if necessary
+                if (MessageStats.counting)
+                {
+                    IncrementMessageCount(LE_SMS_TYPE_TX);
+                }
+            }
+        }
+        else if (LE_SMS_SENDING == msgPtr->status)
+        {
+            // The message fails with its first part failing.
+            LE_WARN("Batch %p: sending failed (%d)", batchPtr->batchRef, res);
+            msgPtr->status = (LE_TIMEOUT == res) ? LE_SMS_SENDING_TIMEOUT : LE_SMS_SENDING_FAILED;
+        }
+    }
+    bool isLast = (0 == --batchPtr->workerCount);
+    le_mutex_Unlock(BatchMutex);
+
+    if (isLast)
+    {
+        le_event_QueueFunctionToThread(batchPtr->threadRef, ReportBatchResult, batchPtr, NULL);
+    }
+    else
+    {
+        le_mem_Release(batchPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a batch worker: runs the functions queued by le_sms_SendBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+static void* BatchWorkerThread
+(
+    void* contextPtr    ///< [IN] Unused.
+)
+{
+    le_event_RunLoop();
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the batch workers, as many as the maximum number of PDU submissions in flight set in the
+ * config tree (see CFG_NODE_BATCH_MAX_IN_FLIGHT).
  */
 //--------------------------------------------------------------------------------------------------
-static void* SmsSenderThread
+static void StartBatchWorkers
 (
-    void* contextPtr
+    void
 )
 {
-    LE_INFO("Sms command Thread started");
+    le_cfg_IteratorRef_t iteratorRef;
+    int32_t maxInFlight;
+    uint32_t i;
 
-    // Connect to services used by this thread
-    le_cfg_ConnectService();
+    iteratorRef = le_cfg_CreateReadTxn(CFG_MODEMSERVICE_SMS_PATH);
+    maxInFlight = le_cfg_GetInt(iteratorRef, CFG_NODE_BATCH_MAX_IN_FLIGHT,
+                                SMS_BATCH_MAX_IN_FLIGHT);
+    le_cfg_CancelTxn(iteratorRef);
 
-    // Register for SMS command events.
-    le_event_AddHandler(WDOG_THREAD_NAME_SMS_COMMAND_SENDING, SmsCommandEventId,
-        ProcessSmsSendingCommandHandler);
+    if ((maxInFlight < 1) || (maxInFlight > LE_SMS_BATCH_MAX_IN_FLIGHT))
+    {
+        LE_ERROR("Invalid number of batch submissions in flight %d", maxInFlight);
+        maxInFlight = SMS_BATCH_MAX_IN_FLIGHT;
+    }
 
-    le_sem_Post(SmsSem);
+    LE_DEBUG("Up to %d batch submissions in flight", maxInFlight);
 
-    // Watchdog SMS event loop
-    // Try to kick a couple of times before each timeout.
-    le_clk_Time_t watchdogInterval = { .sec = MS_WDOG_INTERVAL };
-    le_wdogChain_MonitorEventLoop(MS_WDOG_SMS_LOOP, watchdogInterval);
+    BatchWorkerCount = maxInFlight;
+    for (i = 0; i < BatchWorkerCount; i++)
+    {
+        char threadName[20];
 
-    // Run the event loop
-    le_event_RunLoop();
-    return NULL;
+        snprintf(threadName, sizeof(threadName), "SmsBatch%u", i);
+        BatchWorkers[i] = le_thread_Create(threadName, BatchWorkerThread, NULL);
+        le_thread_Start(BatchWorkers[i]);
+    }
 }
 
 
@@ -2351,6 +2990,23 @@ static void CloseSessionEventHandler
         // Get the next value in the reference map.
         result = le_ref_NextNode(iterRef);
     }
+
+    iterRef = le_ref_GetIterator(BatchRefMap);
+    result = le_ref_NextNode(iterRef);
+    while (LE_OK == result)
+    {
+        Batch_t* batchPtr = (Batch_t*)le_ref_GetValue(iterRef);
+
+        // Check if the session reference saved matchs with the current session reference.
+        if (batchPtr->sessionRef == sessionRef)
+        {
+            le_sms_BatchRef_t batchRef = (le_sms_BatchRef_t) le_ref_GetSafeRef(iterRef);
+            LE_DEBUG("Release batch reference 0x%p, sessionRef 0x%p", batchRef, sessionRef);
+            le_sms_DeleteBatch(batchRef);
+        }
+        // Get the next value in the reference map.
+        result = le_ref_NextNode(iterRef);
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2411,6 +3067,15 @@ le_result_t le_sms_Init
     SessionCtxPool = le_mem_CreatePool("SessionCtxPool", sizeof(SessionCtxNode_t));
     le_mem_ExpandPool(SessionCtxPool, SMS_MAX_SESSION);
 
+    // Create the pools and the Safe Reference Map for batches, whose parts are allocated on demand.
+    BatchPool = le_mem_CreatePool("SmsBatchPool", sizeof(Batch_t));
+    le_mem_ExpandPool(BatchPool, MAX_NUM_OF_BATCH);
+    le_mem_SetDestructor(BatchPool, BatchDestructor);
+    BatchPartPool = le_mem_CreatePool("SmsBatchPartPool", sizeof(BatchPart_t));
+    BatchRefMap = le_ref_CreateMap("SmsBatchMap", MAX_NUM_OF_BATCH);
+    BatchMutex = le_mutex_CreateNonRecursive("SmsBatchMutex");
+    StartBatchWorkers();
+
     // Create an event Id for SMS storage indication.
     StorageStatusEventId = le_event_CreateId("StorageStatusEventId", sizeof(le_sms_Storage_t));
 
@@ -2419,13 +3084,25 @@ le_result_t le_sms_Init
 
     SessionCtxList = LE_DLS_LIST_INIT;
 
+    // Create a pool for the index of the stored messages.
+    StoredMsgPool = le_mem_CreatePool("SmsStoredMsgPool", sizeof(StoredMsg_t));
+    StoredMsgList = LE_DLS_LIST_INIT;
+
     // Register a handler function for SMS storage status indication.
     if (pa_sms_AddStorageStatusHandler(StorageIndicationHandler) == NULL)
     {
         LE_WARN("failed to register a handler function for SMS storage");
     }
 
+    // Register a handler function for new SIM state notification.
+    if (pa_sim_AddNewStateHandler(SimStateHandler) == NULL)
+    {
+        LE_WARN("failed to register a handler function for SIM state");
+    }
+
     SmsSem = le_sem_Create("SmsSem", 1);
+    SmsTurnstileMutex = le_mutex_CreateNonRecursive("SmsTurnstile");
+    SubmissionMutex = le_mutex_CreateNonRecursive("SmsSubmission");
 
     // Init the SMS command Event Id.
     SmsCommandEventId = le_event_CreateId("SmsSendCmd", sizeof(CmdRequest_t));
@@ -3874,7 +4551,7 @@ le_result_t le_sms_Send
         LE_DEBUG("Try to send PDU Msg %p, pdu.%p, pduLen.%u with protocol %d",
                         msgPtr, msgPtr->pdu.data, msgPtr->pdu.dataLen, msgPtr->protocol);
 
-        le_sem_Wait(SmsSem);
+        WaitSmsSem();
         result = pa_sms_SendPduMsg(msgPtr->protocol, msgPtr->pdu.dataLen,
                         msgPtr->pdu.data, PA_SMS_SENDING_TIMEOUT, &msgPtr->pdu.errorCode);
         le_sem_Post(SmsSem);
@@ -3896,7 +4573,7 @@ le_result_t le_sms_Send
             // Update sent message count if necessary
             if (MessageStats.counting)
             {
-                SetMessageCount(LE_SMS_TYPE_TX, MessageStats.txCount + 1);
+                IncrementMessageCount(LE_SMS_TYPE_TX);
             }
         }
     }
@@ -4136,10 +4813,21 @@ le_result_t le_sms_DeleteFromStorage
 
     if (1 == msgPtr->smsUserCount)
     {
-        le_sem_Wait(SmsSem);
+        WaitSmsSem();
         resp = pa_sms_DelMsgFromMem(msgPtr->storageIdx, msgPtr->protocol, msgPtr->storage);
         le_sem_Post(SmsSem);
 
+        // Keep the index of the stored messages up to date: on failure, whether the message is
+        // still stored is unknown.
+        if (LE_OK == resp)
+        {
+            RemoveStoredMessage(msgPtr);
+        }
+        else
+        {
+            InvalidateStoredMessages();
+        }
+
         if ((LE_COMM_ERROR == resp) || (LE_TIMEOUT == resp))
         {
             return LE_NO_MEMORY;
@@ -4257,6 +4945,7 @@ le_sms_MsgRef_t le_sms_GetFirst
     {
         nodePtr = CONTAINER_OF(msgLinkPtr, le_sms_MsgReference_t, listLink);
         listPtr->currentLink = msgLinkPtr;
+        DecodeListedMessage(nodePtr->msgRef);
         return nodePtr->msgRef;
     }
     else
@@ -4300,6 +4989,7 @@ le_sms_MsgRef_t le_sms_GetNext
         // Get the node from MsgList.
         nodePtr = CONTAINER_OF(msgLinkPtr, le_sms_MsgReference_t, listLink);
         listPtr->currentLink = msgLinkPtr;
+        DecodeListedMessage(nodePtr->msgRef);
         return nodePtr->msgRef;
     }
     else
@@ -4355,11 +5045,12 @@ void le_sms_MarkRead
         return;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     if (pa_sms_ChangeMessageStatus(msgPtr->storageIdx, msgPtr->protocol, LE_SMS_RX_READ,
                     msgPtr->storage) == LE_OK)
     {
         msgPtr->pdu.status = LE_SMS_RX_READ;
+        SetStoredMessageStatus(msgPtr);
     }
     le_sem_Post(SmsSem);
 
@@ -4386,11 +5077,12 @@ void le_sms_MarkUnread
         return;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     if (pa_sms_ChangeMessageStatus(msgPtr->storageIdx, msgPtr->protocol, LE_SMS_RX_UNREAD,
                     msgPtr->storage) == LE_OK)
     {
         msgPtr->pdu.status = LE_SMS_RX_UNREAD;
+        SetStoredMessageStatus(msgPtr);
     }
     le_sem_Post(SmsSem);
 }
@@ -4420,7 +5112,7 @@ le_result_t le_sms_GetSmsCenterAddress
     char smscMdmStr[LE_MDMDEFS_PHONE_NUM_MAX_BYTES] = {0};
     le_result_t res = LE_FAULT;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_GetSmsc(smscMdmStr, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
     le_sem_Post(SmsSem);
 
@@ -4468,7 +5160,7 @@ le_result_t le_sms_SetSmsCenterAddress
         return res;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_SetSmsc(telPtr);
     le_sem_Post(SmsSem);
 
@@ -4523,7 +5215,7 @@ le_result_t le_sms_ActivateCellBroadcast
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_ActivateCellBroadcast(PA_SMS_PROTOCOL_GSM);
     le_sem_Post(SmsSem);
 
@@ -4547,7 +5239,7 @@ le_result_t le_sms_DeactivateCellBroadcast
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_DeactivateCellBroadcast(PA_SMS_PROTOCOL_GSM);
     le_sem_Post(SmsSem);
 
@@ -4571,7 +5263,7 @@ le_result_t le_sms_ActivateCdmaCellBroadcast
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_ActivateCellBroadcast(PA_SMS_PROTOCOL_CDMA);
     le_sem_Post(SmsSem);
 
@@ -4595,7 +5287,7 @@ le_result_t le_sms_DeactivateCdmaCellBroadcast
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_DeactivateCellBroadcast(PA_SMS_PROTOCOL_CDMA);
     le_sem_Post(SmsSem);
 
@@ -4624,7 +5316,7 @@ le_result_t le_sms_AddCellBroadcastIds
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_AddCellBroadcastIds(fromId, toId);
     le_sem_Post(SmsSem);
 
@@ -4654,7 +5346,7 @@ le_result_t le_sms_RemoveCellBroadcastIds
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_RemoveCellBroadcastIds(fromId, toId);
     le_sem_Post(SmsSem);
 
@@ -4678,7 +5370,7 @@ le_result_t le_sms_ClearCellBroadcastIds
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_ClearCellBroadcastIds();
     le_sem_Post(SmsSem);
 
@@ -4717,7 +5409,7 @@ le_result_t le_sms_AddCdmaCellBroadcastServices
         return LE_BAD_PARAMETER;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_AddCdmaCellBroadcastServices(serviceCat, language);
     le_sem_Post(SmsSem);
 
@@ -4756,7 +5448,7 @@ le_result_t le_sms_RemoveCdmaCellBroadcastServices
         return LE_BAD_PARAMETER;
     }
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_RemoveCdmaCellBroadcastServices(serviceCat, language);
     le_sem_Post(SmsSem);
 
@@ -4779,7 +5471,7 @@ le_result_t le_sms_ClearCdmaCellBroadcastServices
 {
     le_result_t res;
 
-    le_sem_Wait(SmsSem);
+    WaitSmsSem();
     res = pa_sms_ClearCdmaCellBroadcastServices();
     le_sem_Post(SmsSem);
 
@@ -4810,26 +5502,15 @@ le_result_t le_sms_GetCount
         return LE_BAD_PARAMETER;
     }
 
-    switch (messageType)
+    persistentCounter_Ref_t counterRef = GetMessageCounter(messageType);
+    if (NULL == counterRef)
     {
-        case LE_SMS_TYPE_RX:
-            *messageCountPtr = MessageStats.rxCount;
-            break;
-
-        case LE_SMS_TYPE_TX:
-            *messageCountPtr = MessageStats.txCount;
-            break;
-
-        case LE_SMS_TYPE_BROADCAST_RX:
-            *messageCountPtr = MessageStats.rxCbCount;
-            break;
-
-        default:
-            LE_ERROR("Unknown message type %d", messageType);
-            *messageCountPtr = 0;
-            return LE_BAD_PARAMETER;
+        *messageCountPtr = 0;
+        return LE_BAD_PARAMETER;
     }
 
+    *messageCountPtr = persistentCounter_Get(counterRef);
+
     LE_DEBUG("Type=%d, count=%d", messageType, *messageCountPtr);
 
     return LE_OK;
@@ -4883,6 +5564,9 @@ void le_sms_ResetCount
     SetMessageCount(LE_SMS_TYPE_RX, 0);
     SetMessageCount(LE_SMS_TYPE_TX, 0);
     SetMessageCount(LE_SMS_TYPE_BROADCAST_RX, 0);
+
+    // Save the reset now, as requested by the client.
+    persistentCounter_Flush(MessageStats.groupRef);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -5191,3 +5875,307 @@ le_result_t le_sms_GetTpSt
 
     return LE_OK;
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an empty batch of messages.
+ *
+ * @return
+ *  - Reference to the new batch.
+ *  - NULL if the transport layer protocol can't be determined.
+ */
+//--------------------------------------------------------------------------------------------------
+le_sms_BatchRef_t le_sms_CreateBatch
+(
+    void
+)
+{
+    pa_sms_Protocol_t protocol;
+
+    // Get transport layer protocol
+    if (LE_OK != GetProtocol(&protocol))
+    {
+        return NULL;
+    }
+
+    Batch_t* batchPtr = le_mem_ForceAlloc(BatchPool);
+    memset(batchPtr, 0, sizeof(Batch_t));
+    batchPtr->sessionRef = le_sms_GetClientSessionRef();
+    batchPtr->protocol = protocol;
+    batchPtr->partList = LE_DLS_LIST_INIT;
+    batchPtr->batchRef = le_ref_CreateRef(BatchRefMap, batchPtr);
+
+    return batchPtr->batchRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a text message to a batch. A text longer than LE_SMS_TEXT_MAX_LEN characters is split into
+ * the parts of a concatenated message.
+ *
+ * @return
+ *  - LE_OK             Function succeeded.
+ *  - LE_BAD_PARAMETER  The telephone number or the text is empty.
+ *  - LE_OUT_OF_RANGE   The batch already holds LE_SMS_BATCH_MAX_MSGS messages.
+ *  - LE_BUSY           The batch has already been sent.
+ *  - LE_UNSUPPORTED    The text must be split, and concatenated messages are not supported by the
+ *                      transport layer protocol.
+ *  - LE_FORMAT_ERROR   The message can't be encoded.
+ *
+ * @note If telephone destination number is too long (max LE_MDMDEFS_PHONE_NUM_MAX_LEN digits), it
+ *       is a fatal error, the function will not return.
+ * @note If the text is too long (max LE_SMS_LONG_TEXT_MAX_LEN characters), it is a fatal error,
+ *       the function will not return.
+ * @note If the caller is passing a bad pointer into this function, it is a fatal error, the
+ *       function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_sms_AddToBatch
+(
+    le_sms_BatchRef_t batchRef, ///< [IN] Reference to the batch.
+    const char* destStr,        ///< [IN] Telephone number string.
+    const char* textStr         ///< [IN] SMS text.
+)
+{
+    Batch_t* batchPtr = le_ref_Lookup(BatchRefMap, batchRef);
+    if (NULL == batchPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", batchRef);
+        return LE_FAULT;
+    }
+
+    size_t destLength = strnlen(destStr, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
+    if (destLength > (LE_MDMDEFS_PHONE_NUM_MAX_BYTES-1))
+    {
+        LE_KILL_CLIENT("strlen(dest) > %d", (LE_MDMDEFS_PHONE_NUM_MAX_BYTES-1));
+        return LE_FAULT;
+    }
+
+    size_t length = strnlen(textStr, LE_SMS_LONG_TEXT_MAX_BYTES);
+    if (length > (LE_SMS_LONG_TEXT_MAX_BYTES-1))
+    {
+        LE_KILL_CLIENT("strlen(text) > %d", (LE_SMS_LONG_TEXT_MAX_BYTES-1));
+        return LE_FAULT;
+    }
+
+    if ((0 == destLength) || (0 == length))
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    if (batchPtr->isSent)
+    {
+        return LE_BUSY;
+    }
+
+    if (batchPtr->msgCount >= LE_SMS_BATCH_MAX_MSGS)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    const uint8_t* textPtr = (const uint8_t*)textStr;
+    BatchMsg_t* msgPtr = &batchPtr->msgs[batchPtr->msgCount];
+    smsPdu_DataToEncode_t data;
+    size_t maxPartLength = SMSPDU_7BITS_MAX_LENGTH;
+    size_t offset;
+
+    memset(&data, 0, sizeof(data));
+    data.protocol = batchPtr->protocol;
+    data.addressPtr = destStr;
+    data.encoding = SMSPDU_7_BITS;
+    data.messageType = PA_SMS_SUBMIT;
+    data.statusReport = StatusReportActivation;
+
+    // Split the text if it doesn't fit in a single message.
+    if (smsPdu_Get7BitsFittingLength(textPtr, length, SMSPDU_7BITS_MAX_LENGTH) < length)
+    {
+        maxPartLength = SMSPDU_CONCAT_7BITS_MAX_LENGTH;
+        for (offset = 0; offset < length; data.concatCount++)
+        {
+            offset += smsPdu_Get7BitsFittingLength(&textPtr[offset], length - offset,
+                                                   maxPartLength);
+        }
+        data.concatRef = ConcatRef++;
+    }
+
+    msgPtr->status = LE_SMS_UNSENT;
+    msgPtr->partCount = 0;
+    msgPtr->sentPartCount = 0;
+
+    // Encode the parts.
+    for (offset = 0; offset < length; offset += data.length)
+    {
+        BatchPart_t* partPtr = le_mem_ForceAlloc(BatchPartPool);
+        le_result_t result;
+
+        data.messagePtr = &textPtr[offset];
+        data.length = smsPdu_Get7BitsFittingLength(data.messagePtr, length - offset,
+                                                   maxPartLength);
+        data.concatIndex = msgPtr->partCount + 1;
+        result = smsPdu_Encode(&data, &partPtr->pdu);
+        if (LE_OK != result)
+        {
+            LE_ERROR("Cannot encode part %d of message %u", data.concatIndex, batchPtr->msgCount);
+            le_mem_Release(partPtr);
+            for (; msgPtr->partCount > 0; msgPtr->partCount--)
+            {
+                le_mem_Release(CONTAINER_OF(le_dls_PopTail(&batchPtr->partList), BatchPart_t,
+                                            link));
+            }
+            return (LE_UNSUPPORTED == result) ? LE_UNSUPPORTED : LE_FORMAT_ERROR;
+        }
+
+        partPtr->msgPtr = msgPtr;
+        partPtr->link = LE_DLS_LINK_INIT;
+        le_dls_Queue(&batchPtr->partList, &partPtr->link);
+        msgPtr->partCount++;
+    }
+
+    batchPtr->msgCount++;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the messages of a batch.
+ *
+ * @return
+ *  - LE_OK             Function succeeded, the callback function will be called once the whole
+ *                      batch is sent.
+ *  - LE_BAD_PARAMETER  The batch is empty.
+ *  - LE_BUSY           The batch has already been sent.
+ *
+ * @note If the caller is passing a bad pointer into this function, it is a fatal error, the
+ *       function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_sms_SendBatch
+(
+    le_sms_BatchRef_t batchRef,             ///< [IN] Reference to the batch.
+    le_sms_BatchResultFunc_t handlerPtr,    ///< [IN] CallBack for the sending result.
+    void* contextPtr                        ///< [IN] Context of the callback.
+)
+{
+    Batch_t* batchPtr = le_ref_Lookup(BatchRefMap, batchRef);
+    if (NULL == batchPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", batchRef);
+        return LE_FAULT;
+    }
+
+    if (batchPtr->isSent)
+    {
+        return LE_BUSY;
+    }
+
+    if (0 == batchPtr->msgCount)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    uint32_t partCount = le_dls_NumLinks(&batchPtr->partList);
+    uint32_t i;
+
+    batchPtr->isSent = true;
+    batchPtr->handlerPtr = handlerPtr;
+    batchPtr->contextPtr = contextPtr;
+    batchPtr->threadRef = le_thread_GetCurrent();
+    batchPtr->nextPartLinkPtr = le_dls_Peek(&batchPtr->partList);
+    batchPtr->workerCount = (partCount < BatchWorkerCount) ? partCount : BatchWorkerCount;
+    for (i = 0; i < batchPtr->msgCount; i++)
+    {
+        batchPtr->msgs[i].status = LE_SMS_SENDING;
+    }
+
+    LE_INFO("Send batch %p: %u messages, %u parts, %u in flight",
+            batchRef, batchPtr->msgCount, partCount, batchPtr->workerCount);
+
+    // workerCount is decremented by the workers as they are done with the batch. A worker busy
+    // with another batch sends this one afterwards.
+    uint32_t workerCount = batchPtr->workerCount;
+    for (i = 0; i < workerCount; i++)
+    {
+        le_mem_AddRef(batchPtr);
+        le_event_QueueFunctionToThread(BatchWorkers[i], SendBatchParts, batchPtr, NULL);
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the sending status of a message of a batch.
+ *
+ * @return
+ *  - LE_OK             Function succeeded.
+ *  - LE_OUT_OF_RANGE   There is no message of this index in the batch.
+ *
+ * @note If the caller is passing a bad pointer into this function, it is a fatal error, the
+ *       function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_sms_GetBatchStatus
+(
+    le_sms_BatchRef_t batchRef, ///< [IN] Reference to the batch.
+    uint32_t index,             ///< [IN] Index of the message in the batch, from 0.
+    le_sms_Status_t* statusPtr  ///< [OUT] Sending status of the message.
+)
+{
+    Batch_t* batchPtr = le_ref_Lookup(BatchRefMap, batchRef);
+    if (NULL == batchPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", batchRef);
+        return LE_FAULT;
+    }
+
+    if (NULL == statusPtr)
+    {
+        LE_KILL_CLIENT("statusPtr is NULL!");
+        return LE_FAULT;
+    }
+
+    if (index >= batchPtr->msgCount)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    le_mutex_Lock(BatchMutex);
+    *statusPtr = batchPtr->msgs[index].status;
+    le_mutex_Unlock(BatchMutex);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a batch. If the batch is being sent, no other message is sent, and the callback function
+ * is not called.
+ *
+ * @note If the caller is passing a bad pointer into this function, it is a fatal error, the
+ *       function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_sms_DeleteBatch
+(
+    le_sms_BatchRef_t batchRef  ///< [IN] Reference to the batch.
+)
+{
+    Batch_t* batchPtr = le_ref_Lookup(BatchRefMap, batchRef);
+    if (NULL == batchPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", batchRef);
+        return;
+    }
+
+    // Invalidate the Safe Reference.
+    le_ref_DeleteRef(BatchRefMap, batchRef);
+
+    // The worker threads stop, and release their references to the batch.
+    le_mutex_Lock(BatchMutex);
+    batchPtr->isDeleted = true;
+    le_mutex_Unlock(BatchMutex);
+
+    le_mem_Release(batchPtr);
+}
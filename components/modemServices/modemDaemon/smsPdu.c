@@ -98,6 +98,17 @@ static const char *DtmfChars = "D1234567890*#ABC";
 #define TYPE_OF_ADDRESS_UNKNOWN         0x81
 #define TYPE_OF_ADDRESS_INTERNATIONAL   0x91
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * User data header of a concatenated message part (cf. 3GPP TS 23.040 section 9.2.3.24.1):
+ * UDHL, then the information element with an 8-bit reference number (IEI, IEDL, reference number,
+ * number of parts, sequence number of the part).
+ */
+//--------------------------------------------------------------------------------------------------
+#define UDH_CONCAT_SIZE             6
+#define UDH_IEI_CONCAT_8BIT_REF     0x00
+#define UDH_IEDL_CONCAT_8BIT_REF    3
+
 /****************************************************************************
  * This lookup table converts from ISO-8859-1 8-bit ASCII to the
  * 7 bit "default alphabet" as defined in ETSI GSM 03.38
@@ -381,7 +392,8 @@ const uint8_t Ascii8to7[] = {
  *   character set, they are replaced by the NPC8-character.
  *
  *   If the character is decimal 27 (ESC) the following character have
- *   a special meaning and must be handled separately.
+ *   a special meaning: it is converted by the entry 128 + character (the
+ *   extension table), so that each character is converted by a single lookup.
  ****************************************************************************/
 const uint8_t Ascii7to8[] = {
     64,         /*  0      @  COMMERCIAL AT                           */
@@ -511,20 +523,37 @@ const uint8_t Ascii7to8[] = {
     246,        /*  124    ö  LATIN SMALL LETTER O WITH DIAERESIS     */
     241,        /*  125    ñ  LATIN SMALL LETTER N WITH TILDE         */
     252,        /*  126    ü  LATIN SMALL LETTER U WITH DIAERESIS     */
-    224         /*  127    à  LATIN SMALL LETTER A WITH GRAVE         */
+    224,        /*  127    à  LATIN SMALL LETTER A WITH GRAVE         */
 
-    /*  The double bytes below must be handled separately after the
-     *   table lookup.
+    /*  Extension table: characters following an escape (27 x).
+     *   Those which are not defined are replaced by the NPC8-character.
      *
-     *   12             27 10      FORM FEED
-     *   94             27 20   ^  CIRCUMFLEX ACCENT
-     *   123            27 40   {  LEFT CURLY BRACKET
-     *   125            27 41   }  RIGHT CURLY BRACKET
-     *   92             27 47   \  REVERSE SOLIDUS (BACKSLASH)
-     *   91             27 60   [  LEFT SQUARE BRACKET
-     *   126            27 61   ~  TILDE
-     *   93             27 62   ]  RIGHT SQUARE BRACKET
-     *   124            27 64   |  VERTICAL BAR                             */
+     *   27 10  12   FORM FEED
+     *   27 20  94   ^  CIRCUMFLEX ACCENT
+     *   27 40  123  {  LEFT CURLY BRACKET
+     *   27 41  125  }  RIGHT CURLY BRACKET
+     *   27 47  92   \  REVERSE SOLIDUS (BACKSLASH)
+     *   27 60  91   [  LEFT SQUARE BRACKET
+     *   27 61  126  ~  TILDE
+     *   27 62  93   ]  RIGHT SQUARE BRACKET
+     *   27 64  124  |  VERTICAL BAR
+     */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27   0 to   7 */
+    NPC8, NPC8, 12,   NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27   8 to  15 */
+    NPC8, NPC8, NPC8, NPC8, 94,   NPC8, NPC8, NPC8,         /* 27  16 to  23 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  24 to  31 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  32 to  39 */
+    123,  125,  NPC8, NPC8, NPC8, NPC8, NPC8, 92,           /* 27  40 to  47 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  48 to  55 */
+    NPC8, NPC8, NPC8, NPC8, 91,   126,  93,   NPC8,         /* 27  56 to  63 */
+    124,  NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  64 to  71 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  72 to  79 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  80 to  87 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  88 to  95 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27  96 to 103 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27 104 to 111 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8,         /* 27 112 to 119 */
+    NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8, NPC8          /* 27 120 to 127 */
 
 };
 
@@ -575,59 +604,106 @@ static inline unsigned int Read7Bits
     return (a|b) & 0x7F;
 }
 
-static inline void Write7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read packed septets into a 64-bit word. The septets are packed GSM 03.38 way: the first septet
+ * in the least significant bits of the first byte, so the bytes are read in little-endian order.
+ * 8 septets make 7 bytes.
+ *
+ * @return The word.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t ReadSeptetWord
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    const uint8_t* bytePtr,     ///< [IN] Packed bytes
+    size_t         byteCount    ///< [IN] Number of bytes (at most 7)
 )
 {
-    val &= 0x7F;
-    uint8_t idx = pos/8;
-
+    uint64_t word = 0;
+    size_t i;
 
-    if (!(pos&7)) {
-        bufferPtr[idx] = val;
-    }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<1);
-    }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<(pos&7));
-        bufferPtr[idx+1] = (val>>(8-(pos&7)));
+    for (i = 0; i < byteCount; i++)
+    {
+        word |= (uint64_t)bytePtr[i] << (8 * i);
     }
+
+    return word;
 }
 
-static inline unsigned int ReadCdma7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a 64-bit word of septets packed GSM 03.38 way (see ReadSeptetWord()).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void WriteSeptetWord
 (
-    const uint8_t* bufferPtr,
-    uint32_t       pos
+    uint64_t       word,        ///< [IN] Septets, the first one in the least significant bits
+    size_t         byteCount,   ///< [IN] Number of bytes (at most 7)
+    uint8_t*       bytePtr      ///< [OUT] Packed bytes
 )
 {
-    uint8_t idx = pos/8;
+    size_t i;
 
-    return (((bufferPtr[idx]<<(pos&7))&0xFF)|(bufferPtr[idx+1]>>(8-(pos&7))))>>1;
+    for (i = 0; i < byteCount; i++)
+    {
+        bytePtr[i] = (uint8_t)(word >> (8 * i));
+    }
 }
 
-static inline void WriteCdma7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack septets into bytes, CDMA way: the first septet in the most significant bits of the first
+ * byte. 8 septets make 7 bytes, which are assembled in a 64-bit word.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t PackCdmaSeptets
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    const uint8_t* septetPtr,   ///< [IN] Septets
+    size_t         count,       ///< [IN] Number of septets (at most 8)
+    uint8_t*       bytePtr      ///< [OUT] Packed bytes
 )
 {
-    val &= 0x7F;
-    uint8_t idx = pos/8;
+    uint64_t word = 0;
+    size_t byteCount = (count * 7 + 7) / 8;
+    size_t i;
 
-    if (!(pos&7)) {
-        bufferPtr[idx] = val << 1;
+    for (i = 0; i < count; i++)
+    {
+        word |= (uint64_t)(septetPtr[i] & 0x7F) << (49 - 7 * i);
     }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | val;
+    for (i = 0; i < byteCount; i++)
+    {
+        bytePtr[i] = (uint8_t)(word >> (48 - 8 * i));
     }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val>>((pos&7)-1));
-        bufferPtr[idx+1] = ((val<<(8-((pos&7)-1)))&0xff);
+
+    return byteCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack septets packed by PackCdmaSeptets(). Only the bytes holding the septets are read.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void UnpackCdmaSeptets
+(
+    const uint8_t* bytePtr,     ///< [IN] Packed bytes
+    size_t         count,       ///< [IN] Number of septets (at most 8)
+    uint8_t*       septetPtr    ///< [OUT] Septets
+)
+{
+    uint64_t word = 0;
+    size_t byteCount = (count * 7 + 7) / 8;
+    size_t i;
+
+    for (i = 0; i < byteCount; i++)
+    {
+        word |= (uint64_t)bytePtr[i] << (48 - 8 * i);
+    }
+    for (i = 0; i < count; i++)
+    {
+        septetPtr[i] = (word >> (49 - 7 * i)) & 0x7F;
     }
 }
 
@@ -635,6 +711,9 @@ static inline void WriteCdma7Bits
  * Convert an ascii array into a 7bits array
  * length is the number of bytes in the ascii buffer
  *
+ * The septets are accumulated in a 64-bit word, written 8 septets (7 bytes) at a time. The fill
+ * bits align the first septet on a septet boundary after a user data header.
+ *
  * @return the size of the a7bit string (in 7bit chars!), or LE_OVERFLOW if a7bitPtr is too small.
  */
 static int32_t Convert8BitsTo7Bits
@@ -644,48 +723,54 @@ static int32_t Convert8BitsTo7Bits
     int            length,      ///< [IN] size of 8bits byte conversion
     uint8_t       *a7bitPtr,    ///< [OUT] 7bits array result
     size_t         a7bitSize,   ///< [IN] 7bits array size
+    unsigned int   fillBits,    ///< [IN] number of zero bits before the first septet
     uint8_t       *a7bitsNumber ///< [OUT] number of char in &7bitsPtr
 )
 {
+    uint64_t word = 0;          // Septets not written yet
+    unsigned int bits = fillBits; // Number of bits in word
+    size_t size = 0;
     int read;
     int write = 0;
-    int size = 0;
 
     for (read = pos; read < length+pos; ++read)
     {
-        uint8_t byte = Ascii8to7[a8bitPtr[read]];
+        uint64_t septets = Ascii8to7[a8bitPtr[read]];
+        unsigned int count = 1;
 
         /* Escape */
-        if (byte >= 128)
+        if (septets >= 128)
         {
-            if (size>a7bitSize)
+            septets = 0x1B | ((septets - 128) << 7);
+            count = 2;
+        }
+
+        word |= septets << bits;
+        bits += count * 7;
+        write += count;
+
+        if (bits >= 56)
+        {
+            if ((size + 7) > a7bitSize)
             {
                 return LE_OVERFLOW;
             }
 
-            Write7Bits(a7bitPtr, 0x1B, write*7);
-            write++;
-            byte -= 128;
-        }
-
-        if (size>a7bitSize)
-        {
-            return LE_OVERFLOW;
+            WriteSeptetWord(word, 7, &a7bitPtr[size]);
+            size += 7;
+            word >>= 56;
+            bits -= 56;
         }
-
-        Write7Bits(a7bitPtr, byte, write*7);
-        write++;
-
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
     }
 
-    if (size>a7bitSize)
+    if ((size + (bits + 7) / 8) > a7bitSize)
     {
         return LE_OVERFLOW;
     }
 
+    WriteSeptetWord(word, (bits + 7) / 8, &a7bitPtr[size]);
+    size += (bits + 7) / 8;
+
     /* Number of written chars */
     *a7bitsNumber = write;
 
@@ -696,6 +781,9 @@ static int32_t Convert8BitsTo7Bits
  * Convert a 7bit array into a ascii array
  * length is the number of 7bit char in the a7bit buffer
  *
+ * The septets are read 8 at a time (7 bytes) in a 64-bit word, and each character (escaped or
+ * not) is converted by a single lookup in Ascii7to8.
+ *
  * @return the size of the ascii array, of LE_OVERFLOW if a8bitPtr is too small.
  */
 static int32_t Convert7BitsTo8Bits
@@ -707,75 +795,48 @@ static int32_t Convert7BitsTo8Bits
     size_t         a8bitSize     ///< [IN] 8bits array size.
 )
 {
+    uint64_t word = 0;
+    unsigned int extension = 0;
+    int end = pos + length;
     int r;
-    int w;
+    int w = 0;
 
-    w = 0;
-    for (r = pos; r < length+pos; r++)
+    for (r = pos; r < end; r++, word >>= 7)
     {
-        uint8_t byte = Read7Bits(a7bitPtr, r*7);
-        byte = Ascii7to8[byte];
+        // Read the word of the septet r, up to the last septet to convert.
+        if ((0 == (r % 8)) || (r == pos))
+        {
+            int first = r % 8;
+            int count = min(8, end - (r - first));
 
-        if (byte != 27)
+            word = ReadSeptetWord(&a7bitPtr[(r / 8) * 7], (count * 7 + 7) / 8) >> (first * 7);
+        }
+
+        unsigned int septet = word & 0x7F;
+
+        /* If we're escaped then the next byte have a special meaning. */
+        if ((27 == septet) && (0 == extension))
         {
-            if (w < a8bitSize)
-            {
-                a8bitPtr[w] = byte;
-                w++;
-            }
-            else
-            {
-                return LE_OVERFLOW;
-            }
+            extension = 128;
+            continue;
         }
-        else
+
+        if (w >= a8bitSize)
         {
-            /* If we're escaped then the next byte have a special meaning. */
-            r++;
+            return LE_OVERFLOW;
+        }
+        a8bitPtr[w++] = Ascii7to8[extension + septet];
+        extension = 0;
+    }
 
-            byte = Read7Bits(a7bitPtr, r*7);
-            if (w < a8bitSize)
-            {
-                switch (byte)
-                {
-                    case 10:
-                        a8bitPtr[w] = 12;
-                        break;
-                    case 20:
-                        a8bitPtr[w] = '^';
-                        break;
-                    case 40:
-                        a8bitPtr[w] = '{';
-                        break;
-                    case 41:
-                        a8bitPtr[w] = '}';
-                        break;
-                    case 47:
-                        a8bitPtr[w] = '\\';
-                        break;
-                    case 60:
-                        a8bitPtr[w] = '[';
-                        break;
-                    case 61:
-                        a8bitPtr[w] = '~';
-                        break;
-                    case 62:
-                        a8bitPtr[w] = ']';
-                        break;
-                    case 64:
-                        a8bitPtr[w] = '|';
-                        break;
-                    default:
-                        a8bitPtr[w] = NPC8;
-                        break;
-                }
-                w++;
-            }
-            else
-            {
-                return LE_OVERFLOW;
-            }
+    /* An escape ending the array is converted with the septet following the array. */
+    if (extension)
+    {
+        if (w >= a8bitSize)
+        {
+            return LE_OVERFLOW;
         }
+        a8bitPtr[w++] = Ascii7to8[extension + Read7Bits(a7bitPtr, end*7)];
     }
 
     return w;
@@ -1073,7 +1134,7 @@ static le_result_t DecodeUserDataField
                 return LE_OVERFLOW;
             }
             *destDataLenPtr = size;
-            LE_INFO(" messageLen %d, pos %d, size %d ", messageLen, *posPtr, size);
+            LE_DEBUG("messageLen %d, pos %d, size %d", messageLen, *posPtr, size);
             break;
 
         case SMSPDU_UCS2_16_BITS:
@@ -1413,11 +1474,12 @@ static le_result_t EncodeMessageGsm
 )
 {
     const int maxSmsLength = 160;
-    uint8_t tpUdhi = 0;
+    uint8_t tpUdhi = (dataPtr->concatCount > 1) ? 1 : 0;
     uint8_t tpDcs = 0x00;
     uint8_t tpSrr = 0x01;
     uint8_t firstByte = 0x00;
     uint8_t addressToa;
+    int udhSize = tpUdhi ? UDH_CONCAT_SIZE : 0;
 
     if (dataPtr->length > maxSmsLength)
     {
@@ -1426,6 +1488,12 @@ static le_result_t EncodeMessageGsm
         return LE_FAULT;
     }
 
+    if (tpUdhi && ((dataPtr->concatIndex < 1) || (dataPtr->concatIndex > dataPtr->concatCount)))
+    {
+        LE_ERROR("Invalid part %d of %d", dataPtr->concatIndex, dataPtr->concatCount);
+        return LE_FAULT;
+    }
+
     /* First Byte:
      * 1-0 TP-Message-Type-Indicator (TP-MTI)
      * 2   TP-More-Messages-to-Send (TP-MMS) in SMS-DELIVER (0 = more messages)
@@ -1562,11 +1630,18 @@ static le_result_t EncodeMessageGsm
 
         /* TP-UDL: User Data Length (1 byte) */
         int messageLen = min(dataPtr->length, maxSmsLength);
-        WriteByte(pduPtr->data, pos++, messageLen);
+        int udlPos = pos;
+        WriteByte(pduPtr->data, pos++, udhSize + messageLen);
 
-        if(tpUdhi)
+        /* TP-UDH: User Data Header, of a concatenated message part */
+        if (tpUdhi)
         {
-            LE_ERROR("Udhi not supported");
+            WriteByte(pduPtr->data, pos++, UDH_CONCAT_SIZE - 1);
+            WriteByte(pduPtr->data, pos++, UDH_IEI_CONCAT_8BIT_REF);
+            WriteByte(pduPtr->data, pos++, UDH_IEDL_CONCAT_8BIT_REF);
+            WriteByte(pduPtr->data, pos++, dataPtr->concatRef);
+            WriteByte(pduPtr->data, pos++, dataPtr->concatCount);
+            WriteByte(pduPtr->data, pos++, dataPtr->concatIndex);
         }
 
         /* TP-UD: User Data */
@@ -1574,12 +1649,16 @@ static le_result_t EncodeMessageGsm
         {
             case SMSPDU_7_BITS:
             {
+                // The septets start on a septet boundary after the header, which counts in the
+                // user data length as the septets it spans.
+                unsigned int udhSeptets = (udhSize * 8 + 6) / 7;
                 uint8_t newMessageLen;
                 int size = Convert8BitsTo7Bits(dataPtr->messagePtr,
                                                0,
                                                messageLen,
                                                &pduPtr->data[pos],
-                                               LE_SMS_PDU_MAX_PAYLOAD,
+                                               LE_SMS_PDU_MAX_PAYLOAD - udhSize,
+                                               udhSeptets * 7 - udhSize * 8,
                                                &newMessageLen);
                 if (size==LE_OVERFLOW)
                 {
@@ -1589,14 +1668,14 @@ static le_result_t EncodeMessageGsm
 
                 // Update message length size for special char.
                 /* TP-UDL: User Data Length (1 byte) */
-                WriteByte(pduPtr->data, pos-1 , newMessageLen);
+                WriteByte(pduPtr->data, udlPos, udhSeptets + newMessageLen);
 
                 pos+=size;
                 break;
             }
             case SMSPDU_8_BITS:
             {
-                if (messageLen <= LE_SMS_PDU_MAX_PAYLOAD)
+                if (messageLen <= LE_SMS_PDU_MAX_PAYLOAD - udhSize)
                 {
                     memcpy(&pduPtr->data[pos], dataPtr->messagePtr, messageLen);
 
@@ -1611,7 +1690,7 @@ static le_result_t EncodeMessageGsm
             }
             case SMSPDU_UCS2_16_BITS:
             {
-                if (messageLen <= LE_SMS_PDU_MAX_PAYLOAD)
+                if (messageLen <= LE_SMS_PDU_MAX_PAYLOAD - udhSize)
                 {
                     memcpy(&pduPtr->data[pos], dataPtr->messagePtr, messageLen);
                     pos += messageLen;
@@ -1847,28 +1926,23 @@ static le_result_t EncodeCdma7BitsData
 )
 {
     int read;
-    int write = 0;
-    int size = 0;
-
-    memset(a7bitPtr,0,a7bitSize);
+    size_t size = 0;
 
-    for (read = 0; read < a8bitPtrSize; ++read)
+    if ((((size_t)a8bitPtrSize * 7 + 7) / 8) > a7bitSize)
     {
-        if (size>a7bitSize)
-        {
-            return LE_OVERFLOW;
-        }
+        return LE_OVERFLOW;
+    }
 
-        WriteCdma7Bits(a7bitPtr, a8bitPtr[read], write*7);
-        write++;
+    memset(a7bitPtr,0,a7bitSize);
 
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
+    /* Pack the characters by groups of 8 */
+    for (read = 0; read < a8bitPtrSize; read += 8)
+    {
+        size += PackCdmaSeptets(&a8bitPtr[read], min(8, a8bitPtrSize - read), &a7bitPtr[size]);
     }
 
     /* Number of written chars */
-    *a7bitsNumber = write;
+    *a7bitsNumber = a8bitPtrSize;
 
     return LE_OK;
 }
@@ -1890,24 +1964,22 @@ static le_result_t DecodeCdma7bitsData
     uint32_t      *a8bitNumber   ///< [OUT] number of char written
 )
 {
-    int read;
-    int write;
+    uint32_t read;
+
+    if (a7bitPtrSize > a8bitSize)
+    {
+        return LE_OVERFLOW;
+    }
 
     memset(a8bitPtr,0,a8bitSize);
 
-    for (read = 0, write = 0; read < a7bitPtrSize; read++, write++)
+    /* Unpack the characters by groups of 8 */
+    for (read = 0; read < a7bitPtrSize; read += 8)
     {
-        if (write < a8bitSize)
-        {
-            a8bitPtr[write] = ReadCdma7Bits(a7bitPtr, read*7);
-        }
-        else
-        {
-            return LE_OVERFLOW;
-        }
+        UnpackCdmaSeptets(&a7bitPtr[(read / 8) * 7], min(8, a7bitPtrSize - read), &a8bitPtr[read]);
     }
 
-    *a8bitNumber = write;
+    *a8bitNumber = a7bitPtrSize;
 
     return LE_OK;
 }
@@ -2687,6 +2759,12 @@ static le_result_t EncodeMessageCdma
     le_result_t result = LE_OK;
     cdmaPdu_t message;
 
+    if (dataPtr->concatCount > 1)
+    {
+        LE_WARN("Concatenated messages are not supported");
+        return LE_UNSUPPORTED;
+    }
+
     memset(&message, 0, sizeof(message));
 
     // Hard-coded
@@ -2821,6 +2899,102 @@ le_result_t smsPdu_Decode
     return result;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a message from the header of its PDU, without decoding the rest of it.
+ *
+ * @return LE_OK            Function succeed
+ * @return LE_UNSUPPORTED   Protocol or message type is not supported
+ * @return LE_FAULT         Function failed
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t smsPdu_GetType
+(
+    pa_sms_Protocol_t protocol, ///< [IN] decoding protocol
+    const uint8_t*    dataPtr,  ///< [IN] PDU data
+    size_t            dataSize, ///< [IN] PDU data size
+    bool              smscInfo, ///< [IN] indicates if PDU starts with SMSC information
+    pa_sms_MsgType_t* typePtr   ///< [OUT] Message type
+)
+{
+    switch (protocol)
+    {
+        case PA_SMS_PROTOCOL_GSM:
+        {
+            size_t pos = 0;
+
+#ifdef HAS_SMSC_INFORMATION
+            if (smscInfo)
+            {
+                if (dataSize == 0)
+                {
+                    return LE_FAULT;
+                }
+                pos += 1 + ReadByte(dataPtr, 0); // skip SCA address and type of address
+            }
+#endif
+            if (pos >= dataSize)
+            {
+                return LE_FAULT;
+            }
+
+            // TP Message Type Indicator
+            switch (ReadByte(dataPtr, pos) & TP_MTI_MASK)
+            {
+                case TP_MTI_SMS_DELIVER:
+                    *typePtr = PA_SMS_DELIVER;
+                    return LE_OK;
+
+                case TP_MTI_SMS_SUBMIT:
+                    *typePtr = PA_SMS_SUBMIT;
+                    return LE_OK;
+
+                case TP_MTI_SMS_STATUS_REPORT:
+                    *typePtr = PA_SMS_STATUS_REPORT;
+                    return LE_OK;
+
+                default:
+                    return LE_UNSUPPORTED;
+            }
+        }
+
+        case PA_SMS_PROTOCOL_GW_CB:
+            *typePtr = PA_SMS_CELL_BROADCAST;
+            return LE_OK;
+
+        case PA_SMS_PROTOCOL_CDMA:
+        {
+            // The message identifier is in the bearer data, after the addresses.
+            cdmaPdu_t message;
+            cdmaPdu_MessageType_t messageType;
+
+            if ((LE_OK != cdmaPdu_Decode(dataPtr, dataSize, &message)) ||
+                (LE_OK != GetCdmaMessageType(&message, &messageType)))
+            {
+                return LE_FAULT;
+            }
+
+            switch (messageType)
+            {
+                case CDMAPDU_MESSAGETYPE_DELIVER:
+                    *typePtr = PA_SMS_DELIVER;
+                    return LE_OK;
+
+                case CDMAPDU_MESSAGETYPE_SUBMIT:
+                    *typePtr = PA_SMS_SUBMIT;
+                    return LE_OK;
+
+                default:
+                    return LE_UNSUPPORTED;
+            }
+        }
+
+        default:
+            LE_WARN("Protocol %d not supported", protocol);
+            return LE_UNSUPPORTED;
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Encode the content of messagePtr in PDU format.
@@ -2861,3 +3035,33 @@ le_result_t smsPdu_Encode
 
     return result;
 }
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the length of the longest start of a text which is encoded into at most a given number of
+ * GSM 7-bit characters (the characters of the GSM extension table are encoded into two).
+ *
+ * @return The length of the start of the text, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t smsPdu_Get7BitsFittingLength
+(
+    const uint8_t*  messagePtr, ///< [IN] Text (ISO-8859-1)
+    size_t          length,     ///< [IN] Length of the text, in bytes
+    size_t          maxLength   ///< [IN] Maximum number of 7-bit characters
+)
+{
+    size_t septetCount = 0;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        septetCount += (Ascii8to7[messagePtr[i]] >= 128) ? 2 : 1;
+        if (septetCount > maxLength)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
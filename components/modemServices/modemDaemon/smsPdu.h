@@ -26,6 +26,15 @@ typedef enum
 }
 smsPdu_Encoding_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of 7-bit characters of a message, and of a part of a concatenated message (whose
+ * user data header takes the room of 7 characters).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMSPDU_7BITS_MAX_LENGTH         160
+#define SMSPDU_CONCAT_7BITS_MAX_LENGTH  153
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Data used to encode the PDU.
@@ -40,6 +49,10 @@ typedef struct
     smsPdu_Encoding_t   encoding;       ///< Type of encoding to be used
     pa_sms_MsgType_t    messageType;    ///< Message Type
     bool                statusReport;   ///< Indicates if SMS Status Report is requested
+    uint8_t             concatRef;      ///< Reference number of a concatenated message
+    uint8_t             concatCount;    ///< Number of parts of a concatenated message (0 or 1 if
+                                        ///< the message is not concatenated)
+    uint8_t             concatIndex;    ///< Sequence number of the part, from 1
 }
 smsPdu_DataToEncode_t;
 
@@ -73,6 +86,24 @@ le_result_t smsPdu_Decode
     pa_sms_Message_t* smsPtr    ///< [OUT] Buffer to store decoded data
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a message from the header of its PDU, without decoding the rest of it.
+ *
+ * @return LE_OK            Function succeed
+ * @return LE_UNSUPPORTED   Protocol or message type is not supported
+ * @return LE_FAULT         Function failed
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t smsPdu_GetType
+(
+    pa_sms_Protocol_t protocol, ///< [IN] decoding protocol
+    const uint8_t*    dataPtr,  ///< [IN] PDU data
+    size_t            dataSize, ///< [IN] PDU data size
+    bool              smscInfo, ///< [IN] indicates if PDU starts with SMSC information
+    pa_sms_MsgType_t* typePtr   ///< [OUT] Message type
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Encode the content of messagePtr in PDU format.
@@ -88,4 +119,19 @@ le_result_t smsPdu_Encode
     pa_sms_Pdu_t*           pduPtr      ///< [OUT] Buffer for the encoded PDU
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the length of the longest start of a text which is encoded into at most a given number of
+ * GSM 7-bit characters (the characters of the GSM extension table are encoded into two).
+ *
+ * @return The length of the start of the text, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t smsPdu_Get7BitsFittingLength
+(
+    const uint8_t*  messagePtr, ///< [IN] Text (ISO-8859-1)
+    size_t          length,     ///< [IN] Length of the text, in bytes
+    size_t          maxLength   ///< [IN] Maximum number of 7-bit characters
+);
+
 #endif /* SMSPDU_H_ */
@@ -0,0 +1,426 @@
+//--------------------------------------------------------------------------------------------------
+/** @file persistentCounter.c
+ *
+ * Persistent counters, saved to the config tree in batches (see persistentCounter.h).
+ *
+ * The counter values are protected by a single mutex, so they can be changed from any thread.
+ * Only the thread of a group starts and stops its flush timer: a change made by another thread
+ * queues a check of the flush policy to the group's thread.
+ *
+ * persistentCounter_FlushAll() only reads the list of groups with Mutex held, as groups are never
+ * deleted, and saves each group with persistentCounter_Flush().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "persistentCounter.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Group of counters.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct persistentCounter_Group
+{
+    le_dls_Link_t   link;                           ///< Link in the list of groups.
+    char            path[LE_CFG_STR_LEN_BYTES];     ///< Config tree path of the counters.
+    le_dls_List_t   counterList;                    ///< Counters of the group.
+    le_thread_Ref_t threadRef;                      ///< Thread saving the group.
+    le_timer_Ref_t  timerRef;                       ///< Flush timer.
+    uint32_t        flushInterval;                  ///< Flush interval, in ms (0 for no limit).
+    uint32_t        flushThreshold;                 ///< Number of changes which are saved at once.
+    uint32_t        changeCount;                    ///< Number of changes not saved yet.
+    bool            isCheckQueued;                  ///< A flush policy check is queued.
+}
+Group_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counter.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct persistentCounter_Counter
+{
+    le_dls_Link_t   link;                           ///< Link in the group's list of counters.
+    Group_t*        groupPtr;                       ///< Group of the counter.
+    char            nodeName[LE_CFG_NAME_LEN_BYTES];    ///< Config tree node of the counter.
+    int32_t         value;                          ///< Current value.
+    int32_t         savedValue;                     ///< Value being saved.
+    bool            isChanged;                      ///< The value has changed since last saved.
+    bool            isSaving;                       ///< savedValue is to be saved.
+}
+Counter_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pools of groups and counters.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t GroupPoolRef = NULL;
+static le_mem_PoolRef_t CounterPoolRef = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of the groups.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t GroupList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex protecting the groups and the counters.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t Mutex = NULL;
+LE_MUTEX_DECLARE_REF(Mutex);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex serializing the flushes, which write to the config tree without holding Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t FlushMutex = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush timer handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    persistentCounter_Flush(le_timer_GetContextPtr(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply the flush policy of a group after some changes. Must be called by the group's thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFlushPolicy
+(
+    void* groupPtr,
+    void* unusedPtr
+)
+{
+    Group_t* gPtr = groupPtr;
+
+    Lock();
+    gPtr->isCheckQueued = false;
+    uint32_t changeCount = gPtr->changeCount;
+    Unlock();
+
+    if (0 == changeCount)
+    {
+        return;
+    }
+
+    if (changeCount >= gPtr->flushThreshold)
+    {
+        persistentCounter_Flush(gPtr);
+    }
+    else if ((gPtr->flushInterval != 0) && !le_timer_IsRunning(gPtr->timerRef))
+    {
+        le_timer_Start(gPtr->timerRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a change of a counter. Must be called with Mutex held, which it releases.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChangeAndUnlock
+(
+    Counter_t* counterPtr
+)
+{
+    Group_t* groupPtr = counterPtr->groupPtr;
+    bool isCheckNeeded = !groupPtr->isCheckQueued;
+
+    counterPtr->isChanged = true;
+    groupPtr->changeCount++;
+    groupPtr->isCheckQueued = true;
+    Unlock();
+
+    if (isCheckNeeded)
+    {
+        if (groupPtr->threadRef == le_thread_GetCurrent())
+        {
+            CheckFlushPolicy(groupPtr, NULL);
+        }
+        else
+        {
+            le_event_QueueFunctionToThread(groupPtr->threadRef, CheckFlushPolicy, groupPtr, NULL);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a group of counters, saved by the calling thread.
+ *
+ * @return The group.
+ */
+//--------------------------------------------------------------------------------------------------
+persistentCounter_GroupRef_t persistentCounter_CreateGroup
+(
+    const char* cfgPathPtr,         ///< [IN] Config tree path of the counters.
+    uint32_t flushInterval,         ///< [IN] Maximum time a change is kept unsaved, in
+                                    ///<      milliseconds (0 for no limit).
+    uint32_t flushThreshold         ///< [IN] Number of changes which are saved at once (0 or 1
+                                    ///<      to save each change).
+)
+{
+    if (NULL == GroupPoolRef)
+    {
+        GroupPoolRef = le_mem_CreatePool("PersistentCounterGroupPool", sizeof(Group_t));
+        CounterPoolRef = le_mem_CreatePool("PersistentCounterPool", sizeof(Counter_t));
+        Mutex = le_mutex_CreateNonRecursive("PCounterMutex");
+        FlushMutex = le_mutex_CreateNonRecursive("PCounterFlushMutex");
+    }
+
+    Group_t* groupPtr = le_mem_ForceAlloc(GroupPoolRef);
+    memset(groupPtr, 0, sizeof(*groupPtr));
+    LE_ASSERT(LE_OK == le_utf8_Copy(groupPtr->path, cfgPathPtr, sizeof(groupPtr->path), NULL));
+    groupPtr->link = LE_DLS_LINK_INIT;
+    groupPtr->counterList = LE_DLS_LIST_INIT;
+    groupPtr->threadRef = le_thread_GetCurrent();
+    groupPtr->flushThreshold = (flushThreshold > 1) ? flushThreshold : 1;
+
+    groupPtr->timerRef = le_timer_Create("PersistentCounterTimer");
+    le_timer_SetHandler(groupPtr->timerRef, FlushTimerHandler);
+    le_timer_SetContextPtr(groupPtr->timerRef, groupPtr);
+    groupPtr->flushInterval = flushInterval;
+    if (flushInterval != 0)
+    {
+        le_timer_SetMsInterval(groupPtr->timerRef, flushInterval);
+    }
+
+    Lock();
+    le_dls_Queue(&GroupList, &groupPtr->link);
+    Unlock();
+
+    return groupPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change when a group is saved. The changes not saved yet are saved if they exceed the new
+ * limits.
+ */
+//--------------------------------------------------------------------------------------------------
+void persistentCounter_SetFlushPolicy
+(
+    persistentCounter_GroupRef_t groupRef,  ///< [IN] The group.
+    uint32_t flushInterval,         ///< [IN] Maximum time a change is kept unsaved, in
+                                    ///<      milliseconds (0 for no limit).
+    uint32_t flushThreshold         ///< [IN] Number of changes which are saved at once (0 or 1
+                                    ///<      to save each change).
+)
+{
+    LE_FATAL_IF(groupRef->threadRef != le_thread_GetCurrent(),
+                "Flush policy of %s changed by another thread", groupRef->path);
+
+    le_timer_Stop(groupRef->timerRef);
+    groupRef->flushInterval = flushInterval;
+    if (flushInterval != 0)
+    {
+        le_timer_SetMsInterval(groupRef->timerRef, flushInterval);
+    }
+
+    groupRef->flushThreshold = (flushThreshold > 1) ? flushThreshold : 1;
+
+    CheckFlushPolicy(groupRef, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a counter in a group, with its saved value.
+ *
+ * @return The counter.
+ */
+//--------------------------------------------------------------------------------------------------
+persistentCounter_Ref_t persistentCounter_Create
+(
+    persistentCounter_GroupRef_t groupRef,  ///< [IN] The group.
+    const char* nodeNamePtr                 ///< [IN] Config tree node of the counter, relative to
+                                            ///<      the group's path.
+)
+{
+    Counter_t* counterPtr = le_mem_ForceAlloc(CounterPoolRef);
+    memset(counterPtr, 0, sizeof(*counterPtr));
+    LE_ASSERT(LE_OK == le_utf8_Copy(counterPtr->nodeName, nodeNamePtr,
+                                    sizeof(counterPtr->nodeName), NULL));
+    counterPtr->link = LE_DLS_LINK_INIT;
+    counterPtr->groupPtr = groupRef;
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(groupRef->path);
+    counterPtr->value = le_cfg_GetInt(iteratorRef, nodeNamePtr, 0);
+    le_cfg_CancelTxn(iteratorRef);
+
+    LE_DEBUG("%s/%s = %d", groupRef->path, nodeNamePtr, counterPtr->value);
+
+    // The counters of a group are saved with only FlushMutex held, so it protects the list too.
+    le_mutex_Lock(FlushMutex);
+    Lock();
+    le_dls_Queue(&groupRef->counterList, &counterPtr->link);
+    Unlock();
+    le_mutex_Unlock(FlushMutex);
+
+    return counterPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a counter.
+ *
+ * @return The value.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t persistentCounter_Get
+(
+    persistentCounter_Ref_t counterRef      ///< [IN] The counter.
+)
+{
+    Lock();
+    int32_t value = counterRef->value;
+    Unlock();
+
+    return value;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the value of a counter.
+ */
+//--------------------------------------------------------------------------------------------------
+void persistentCounter_Set
+(
+    persistentCounter_Ref_t counterRef,     ///< [IN] The counter.
+    int32_t value                           ///< [IN] The value.
+)
+{
+    Lock();
+    counterRef->value = value;
+    ChangeAndUnlock(counterRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to the value of a counter.
+ */
+//--------------------------------------------------------------------------------------------------
+void persistentCounter_Add
+(
+    persistentCounter_Ref_t counterRef,     ///< [IN] The counter.
+    int32_t delta                           ///< [IN] Value to add.
+)
+{
+    Lock();
+    counterRef->value += delta;
+    ChangeAndUnlock(counterRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the changed counters of a group now. The calling thread must be connected to the le_cfg
+ * service.
+ */
+//--------------------------------------------------------------------------------------------------
+void persistentCounter_Flush
+(
+    persistentCounter_GroupRef_t groupRef   ///< [IN] The group.
+)
+{
+    le_dls_Link_t* linkPtr;
+    bool isSaveNeeded = false;
+
+    if (groupRef->threadRef == le_thread_GetCurrent())
+    {
+        le_timer_Stop(groupRef->timerRef);
+    }
+
+    le_mutex_Lock(FlushMutex);
+
+    // Take the values to save, then save them without blocking the changes.
+    Lock();
+    for (linkPtr = le_dls_Peek(&groupRef->counterList); linkPtr != NULL;
+         linkPtr = le_dls_PeekNext(&groupRef->counterList, linkPtr))
+    {
+        Counter_t* counterPtr = CONTAINER_OF(linkPtr, Counter_t, link);
+
+        if (counterPtr->isChanged)
+        {
+            counterPtr->savedValue = counterPtr->value;
+            counterPtr->isChanged = false;
+            counterPtr->isSaving = true;
+            isSaveNeeded = true;
+        }
+    }
+    groupRef->changeCount = 0;
+    Unlock();
+
+    if (isSaveNeeded)
+    {
+        le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn(groupRef->path);
+
+        for (linkPtr = le_dls_Peek(&groupRef->counterList); linkPtr != NULL;
+             linkPtr = le_dls_PeekNext(&groupRef->counterList, linkPtr))
+        {
+            Counter_t* counterPtr = CONTAINER_OF(linkPtr, Counter_t, link);
+
+            if (counterPtr->isSaving)
+            {
+                le_cfg_SetInt(iteratorRef, counterPtr->nodeName, counterPtr->savedValue);
+                counterPtr->isSaving = false;
+                LE_DEBUG("%s/%s = %d", groupRef->path, counterPtr->nodeName,
+                         counterPtr->savedValue);
+            }
+        }
+
+        le_cfg_CommitTxn(iteratorRef);
+    }
+
+    le_mutex_Unlock(FlushMutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the changed counters of all the groups now, whatever their thread. The calling thread must
+ * be connected to the le_cfg service.
+ */
+//--------------------------------------------------------------------------------------------------
+void persistentCounter_FlushAll
+(
+    void
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    if (NULL == Mutex)
+    {
+        return;
+    }
+
+    // Groups are only added at the end of the list, so a link stays valid without Mutex held.
+    Lock();
+    linkPtr = le_dls_Peek(&GroupList);
+    Unlock();
+
+    while (linkPtr != NULL)
+    {
+        persistentCounter_Flush(CONTAINER_OF(linkPtr, Group_t, link));
+
+        Lock();
+        linkPtr = le_dls_PeekNext(&GroupList, linkPtr);
+        Unlock();
+    }
+}
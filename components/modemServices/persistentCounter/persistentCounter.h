@@ -0,0 +1,146 @@
+//--------------------------------------------------------------------------------------------------
+/** @file persistentCounter.h
+ *
+ * Persistent counters: integer counters kept in memory and saved to the config tree in batches,
+ * instead of one config tree commit per change.
+ *
+ * Counters belong to a group, saved as the integer nodes of a config tree path. A group is saved
+ * in a single write transaction:
+ *  - once a given number of changes has been made (the flush threshold),
+ *  - at the latest a given time after the first unsaved change (the flush interval),
+ *  - on request (persistentCounter_Flush(), or persistentCounter_FlushAll() for all the groups).
+ *
+ * So a crash loses at most the changes of the last flush interval, and less than flush threshold
+ * changes.
+ *
+ * A group is saved by the thread which created it, which must run an event loop and be connected
+ * to the le_cfg service. Its counters can be changed from any thread.
+ *
+ * This module does not handle SIGTERM: the daemon using it should save the groups from its own
+ * SIGTERM event handler, with persistentCounter_FlushAll().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_PERSISTENT_COUNTER_INCLUDE_GUARD
+#define LEGATO_PERSISTENT_COUNTER_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a group of counters.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct persistentCounter_Group* persistentCounter_GroupRef_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a counter.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct persistentCounter_Counter* persistentCounter_Ref_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a group of counters, saved by the calling thread.
+ *
+ * @return The group.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED persistentCounter_GroupRef_t persistentCounter_CreateGroup
+(
+    const char* cfgPathPtr,         ///< [IN] Config tree path of the counters.
+    uint32_t flushInterval,         ///< [IN] Maximum time a change is kept unsaved, in
+                                    ///<      milliseconds (0 for no limit).
+    uint32_t flushThreshold         ///< [IN] Number of changes which are saved at once (0 or 1
+                                    ///<      to save each change).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change when a group is saved. The changes not saved yet are saved if they exceed the new
+ * limits.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void persistentCounter_SetFlushPolicy
+(
+    persistentCounter_GroupRef_t groupRef,  ///< [IN] The group.
+    uint32_t flushInterval,         ///< [IN] Maximum time a change is kept unsaved, in
+                                    ///<      milliseconds (0 for no limit).
+    uint32_t flushThreshold         ///< [IN] Number of changes which are saved at once (0 or 1
+                                    ///<      to save each change).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a counter in a group, with its saved value.
+ *
+ * @return The counter.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED persistentCounter_Ref_t persistentCounter_Create
+(
+    persistentCounter_GroupRef_t groupRef,  ///< [IN] The group.
+    const char* nodeNamePtr                 ///< [IN] Config tree node of the counter, relative to
+                                            ///<      the group's path.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a counter.
+ *
+ * @return The value.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED int32_t persistentCounter_Get
+(
+    persistentCounter_Ref_t counterRef      ///< [IN] The counter.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the value of a counter.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void persistentCounter_Set
+(
+    persistentCounter_Ref_t counterRef,     ///< [IN] The counter.
+    int32_t value                           ///< [IN] The value.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to the value of a counter.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void persistentCounter_Add
+(
+    persistentCounter_Ref_t counterRef,     ///< [IN] The counter.
+    int32_t delta                           ///< [IN] Value to add.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the changed counters of a group now. The calling thread must be connected to the le_cfg
+ * service.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void persistentCounter_Flush
+(
+    persistentCounter_GroupRef_t groupRef   ///< [IN] The group.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the changed counters of all the groups now, whatever their thread. The calling thread must
+ * be connected to the le_cfg service.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void persistentCounter_FlushAll
+(
+    void
+);
+
+#endif /* LEGATO_PERSISTENT_COUNTER_INCLUDE_GUARD */
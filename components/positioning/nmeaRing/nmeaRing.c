@@ -0,0 +1,438 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file nmeaRing.c
+ *
+ * Shared NMEA ring, written by the positioning service and read by any number of clients (see
+ * nmeaRing.h for the layout).
+ *
+ * The writer never reads the readers' state: it advances tail past the records it is about to
+ * overwrite, announces the end of the new record in reserve, writes the record, then publishes it
+ * in head. A reader copies a record, then checks that reserve has not gone past the record's start
+ * by more than the ring's size meanwhile, in which case the copy may be torn and the reader jumps
+ * to tail.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "nmeaRing.h"
+
+#include <sys/mman.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Template of the path of a ring's file (deleted once created).
+ */
+//--------------------------------------------------------------------------------------------------
+#define RING_PATH_TEMPLATE      "/tmp/nmeaRingXXXXXX"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a record of a sentence, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_BYTES(length)    ((sizeof(nmeaRing_Record_t) + (length) + 7) & ~(size_t)7)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentence types, by their 3-letter formatter.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    char            formatter[4];
+    nmeaRing_Type_t type;
+}
+Formatters[] =
+{
+    { "GGA", NMEA_RING_TYPE_GGA },
+    { "RMC", NMEA_RING_TYPE_RMC },
+    { "GSA", NMEA_RING_TYPE_GSA },
+    { "GSV", NMEA_RING_TYPE_GSV },
+    { "VTG", NMEA_RING_TYPE_VTG },
+    { "GLL", NMEA_RING_TYPE_GLL },
+    { "GNS", NMEA_RING_TYPE_GNS },
+    { "ZDA", NMEA_RING_TYPE_ZDA },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the size of the record at an offset of the ring, in bytes (up to the end of the ring for a
+ * padding record).
+ *
+ * @return The size, 0 if the record is torn.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetRecordBytes
+(
+    uint64_t offset,                        ///< [IN] Offset of the record.
+    const nmeaRing_Record_t* recordPtr      ///< [IN] Header of the record.
+)
+{
+    size_t position = offset % NMEA_RING_DATA_BYTES;
+
+    if (NMEA_RING_TYPE_PAD == recordPtr->type)
+    {
+        return NMEA_RING_DATA_BYTES - position;
+    }
+
+    size_t recordBytes = RECORD_BYTES(recordPtr->length);
+    if ((recordPtr->length > NMEA_RING_MAX_SENTENCE_BYTES) ||
+        (position + recordBytes > NMEA_RING_DATA_BYTES))
+    {
+        return 0;
+    }
+
+    return recordBytes;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a ring, in a file which is deleted (so it is only reachable by its file descriptor).
+ *
+ * @return The mapped ring, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+nmeaRing_Ring_t* nmeaRing_Create
+(
+    int* fdPtr                      ///< [OUT] Read-only file descriptor of the ring, for readers.
+)
+{
+    char path[] = RING_PATH_TEMPLATE;
+    nmeaRing_Ring_t* ringPtr = MAP_FAILED;
+
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", path);
+        return NULL;
+    }
+
+    // Readers get a read-only descriptor, so they can't corrupt the ring.
+    *fdPtr = open(path, O_RDONLY | O_CLOEXEC);
+    (void)unlink(path);
+
+    if ((*fdPtr >= 0) && (ftruncate(fd, sizeof(nmeaRing_Ring_t)) == 0))
+    {
+        ringPtr = mmap(NULL, sizeof(nmeaRing_Ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (MAP_FAILED == ringPtr)
+    {
+        LE_ERROR("Failed to map '%s' (%m).", path);
+        if (*fdPtr >= 0)
+        {
+            close(*fdPtr);
+            *fdPtr = -1;
+        }
+        return NULL;
+    }
+
+    ringPtr->version = NMEA_RING_VERSION;
+    ringPtr->dataBytes = NMEA_RING_DATA_BYTES;
+    __atomic_store_n(&ringPtr->magic, NMEA_RING_MAGIC, __ATOMIC_RELEASE);
+
+    return ringPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a sentence to a ring. Only one thread may write to a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaRing_Write
+(
+    nmeaRing_Ring_t* ringPtr,       ///< [IN] The ring.
+    const char* sentencePtr         ///< [IN] The sentence.
+)
+{
+    size_t length = strlen(sentencePtr);
+
+    if (length > NMEA_RING_MAX_SENTENCE_BYTES)
+    {
+        LE_DEBUG("Sentence of %zu bytes dropped", length);
+        return;
+    }
+
+    uint64_t head = ringPtr->head;
+    size_t position = head % NMEA_RING_DATA_BYTES;
+    size_t recordBytes = RECORD_BYTES(length);
+    size_t padBytes = 0;
+
+    if (position + recordBytes > NMEA_RING_DATA_BYTES)
+    {
+        padBytes = NMEA_RING_DATA_BYTES - position;
+    }
+    uint64_t end = head + padBytes + recordBytes;
+
+    // Drop the records about to be overwritten.
+    uint64_t tail = ringPtr->tail;
+    while (end - tail > NMEA_RING_DATA_BYTES)
+    {
+        const nmeaRing_Record_t* oldPtr = (const nmeaRing_Record_t*)
+                                          &ringPtr->data[tail % NMEA_RING_DATA_BYTES];
+        tail += GetRecordBytes(tail, oldPtr);
+    }
+    __atomic_store_n(&ringPtr->tail, tail, __ATOMIC_RELAXED);
+
+    // Announce the overwrite before doing it.
+    __atomic_store_n(&ringPtr->reserve, end, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (padBytes)
+    {
+        nmeaRing_Record_t* padPtr = (nmeaRing_Record_t*)&ringPtr->data[position];
+        padPtr->length = 0;
+        padPtr->type = NMEA_RING_TYPE_PAD;
+        padPtr->seq = 0;
+        position = 0;
+    }
+
+    nmeaRing_Record_t* recordPtr = (nmeaRing_Record_t*)&ringPtr->data[position];
+    recordPtr->length = length;
+    recordPtr->type = nmeaRing_GetType(sentencePtr);
+    recordPtr->seq = ringPtr->nextSeq++;
+    memcpy(recordPtr + 1, sentencePtr, length);
+
+    __atomic_store_n(&ringPtr->head, end, __ATOMIC_RELEASE);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a sentence.
+ *
+ * @return The type.
+ */
+//--------------------------------------------------------------------------------------------------
+nmeaRing_Type_t nmeaRing_GetType
+(
+    const char* sentencePtr         ///< [IN] The sentence.
+)
+{
+    size_t i;
+
+    if ((sentencePtr[0] != '$') && (sentencePtr[0] != '!'))
+    {
+        return NMEA_RING_TYPE_OTHER;
+    }
+
+    if ('P' == sentencePtr[1])
+    {
+        return NMEA_RING_TYPE_PROPRIETARY;
+    }
+
+    // "$ttfff,": a 2-character talker, then the formatter.
+    if ((sentencePtr[1] == '\0') || (sentencePtr[2] == '\0'))
+    {
+        return NMEA_RING_TYPE_OTHER;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Formatters); i++)
+    {
+        if ((strncmp(&sentencePtr[3], Formatters[i].formatter, 3) == 0) &&
+            ((sentencePtr[6] == ',') || (sentencePtr[6] == '*')))
+        {
+            return Formatters[i].type;
+        }
+    }
+
+    return NMEA_RING_TYPE_OTHER;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start reading a ring, from its next sentence.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the file is not a ring of this version.
+ *      - LE_FAULT if the file can't be mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t nmeaRing_OpenReader
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [OUT] The reader.
+    int fd,                         ///< [IN] File descriptor of the ring (closed by this function).
+    uint32_t typeMask               ///< [IN] Types of the sentences to read (NMEA_RING_MASK()).
+)
+{
+    struct stat fileStat;
+
+    memset(readerPtr, 0, sizeof(*readerPtr));
+
+    if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size < (off_t)sizeof(nmeaRing_Ring_t)))
+    {
+        LE_ERROR("Bad ring file descriptor %d", fd);
+        close(fd);
+        return LE_FORMAT_ERROR;
+    }
+
+    const nmeaRing_Ring_t* ringPtr = mmap(NULL, sizeof(nmeaRing_Ring_t), PROT_READ, MAP_SHARED,
+                                          fd, 0);
+    close(fd);
+    if (MAP_FAILED == ringPtr)
+    {
+        LE_ERROR("Failed to map the ring (%m).");
+        return LE_FAULT;
+    }
+
+    if ((__atomic_load_n(&ringPtr->magic, __ATOMIC_ACQUIRE) != NMEA_RING_MAGIC) ||
+        (ringPtr->version != NMEA_RING_VERSION) ||
+        (ringPtr->dataBytes != NMEA_RING_DATA_BYTES))
+    {
+        LE_ERROR("Not a ring of version %d", NMEA_RING_VERSION);
+        munmap((void*)ringPtr, sizeof(nmeaRing_Ring_t));
+        return LE_FORMAT_ERROR;
+    }
+
+    // Skip the records already written, to start from the next one knowing its sequence number.
+    char sentence[NMEA_RING_MAX_SENTENCE_BYTES + 1];
+    readerPtr->ringPtr = ringPtr;
+    readerPtr->cursor = __atomic_load_n(&ringPtr->tail, __ATOMIC_RELAXED);
+    readerPtr->typeMask = 0;
+    LE_ASSERT(LE_WOULD_BLOCK == nmeaRing_Read(readerPtr, sentence, sizeof(sentence), NULL));
+
+    // Nothing written yet: the first sentence will be 0.
+    readerPtr->isSynchronized = true;
+    readerPtr->lostCount = 0;
+    readerPtr->typeMask = typeMask;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the types of the sentences to read.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaRing_SetTypeMask
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [IN] The reader.
+    uint32_t typeMask               ///< [IN] Types of the sentences to read (NMEA_RING_MASK()).
+)
+{
+    readerPtr->typeMask = typeMask;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the next sentence of the selected types.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_WOULD_BLOCK if there is no new sentence.
+ *      - LE_OVERFLOW if the sentence doesn't fit in the buffer (it is skipped).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t nmeaRing_Read
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [IN] The reader.
+    char* bufferPtr,                ///< [OUT] The null-terminated sentence.
+    size_t bufferSize,              ///< [IN] Size of the buffer.
+    nmeaRing_Type_t* typePtr        ///< [OUT] Type of the sentence (may be NULL).
+)
+{
+    const nmeaRing_Ring_t* ringPtr = readerPtr->ringPtr;
+    uint64_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+
+    while (readerPtr->cursor != head)
+    {
+        uint64_t cursor = readerPtr->cursor;
+        nmeaRing_Record_t record;
+        le_result_t result = LE_NOT_FOUND;
+        size_t recordBytes = 0;
+
+        if (head - cursor <= NMEA_RING_DATA_BYTES)
+        {
+            memcpy(&record, &ringPtr->data[cursor % NMEA_RING_DATA_BYTES], sizeof(record));
+            recordBytes = GetRecordBytes(cursor, &record);
+
+            if ((recordBytes != 0) && (record.type != NMEA_RING_TYPE_PAD) &&
+                (record.type < 32) && (readerPtr->typeMask & NMEA_RING_MASK(record.type)))
+            {
+                if (record.length < bufferSize)
+                {
+                    memcpy(bufferPtr, &ringPtr->data[cursor % NMEA_RING_DATA_BYTES] +
+                           sizeof(record), record.length);
+                    bufferPtr[record.length] = '\0';
+                    result = LE_OK;
+                }
+                else
+                {
+                    result = LE_OVERFLOW;
+                }
+            }
+        }
+
+        // Check that nothing read has been overwritten meanwhile.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t reserve = __atomic_load_n(&ringPtr->reserve, __ATOMIC_RELAXED);
+        if ((reserve - cursor > NMEA_RING_DATA_BYTES) || (0 == recordBytes))
+        {
+            // Overrun: resume from the oldest record, the lost sentences are counted from the
+            // sequence numbers.
+            readerPtr->cursor = __atomic_load_n(&ringPtr->tail, __ATOMIC_RELAXED);
+            head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+            continue;
+        }
+
+        readerPtr->cursor = cursor + recordBytes;
+        if (NMEA_RING_TYPE_PAD == record.type)
+        {
+            continue;
+        }
+
+        if (readerPtr->isSynchronized)
+        {
+            readerPtr->lostCount += (uint32_t)(record.seq - readerPtr->nextSeq);
+        }
+        readerPtr->nextSeq = record.seq + 1;
+        readerPtr->isSynchronized = true;
+
+        if (result != LE_NOT_FOUND)
+        {
+            if (typePtr)
+            {
+                *typePtr = record.type;
+            }
+            return result;
+        }
+    }
+
+    return LE_WOULD_BLOCK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of sentences overwritten by the writer before the reader read them.
+ *
+ * @return The number of sentences.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t nmeaRing_GetLostCount
+(
+    const nmeaRing_Reader_t* readerPtr  ///< [IN] The reader.
+)
+{
+    return readerPtr->lostCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop reading a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaRing_CloseReader
+(
+    nmeaRing_Reader_t* readerPtr    ///< [IN] The reader.
+)
+{
+    if (readerPtr->ringPtr)
+    {
+        munmap((void*)readerPtr->ringPtr, sizeof(nmeaRing_Ring_t));
+        readerPtr->ringPtr = NULL;
+    }
+}
@@ -0,0 +1,243 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file nmeaRing.h
+ *
+ * Shared NMEA ring: the positioning service writes each NMEA sentence once into a ring in shared
+ * memory (see le_gnss_GetNmeaRing()), and any number of readers map it read-only and read it at
+ * their own pace.
+ *
+ * Each reader keeps its own cursor. The writer never waits for the readers: a reader which falls
+ * behind by more than the ring's size loses the oldest sentences, and counts them (see
+ * nmeaRing_GetLostCount()). A reader can also select the sentence types it wants, and the others
+ * are skipped without being copied.
+ *
+ * The ring holds NMEA_RING_DATA_BYTES of sentences (several hundreds), so polling it once a
+ * second is enough to read every sentence.
+ *
+ * Ring layout: a header (see nmeaRing_Ring_t), then the records. Each record is a header (see
+ * nmeaRing_Record_t) followed by the sentence (without a terminating null character), padded to
+ * a multiple of 8 bytes. A record never wraps around the end of the ring: a padding record fills
+ * the end instead.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_NMEARING_INCLUDE_GUARD
+#define LEGATO_NMEARING_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring identification.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_RING_MAGIC             0x414D4E4C  // "LNMA"
+#define NMEA_RING_VERSION           1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the ring's records area, in bytes (a power of 2).
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_RING_DATA_BYTES        65536
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a sentence, in bytes (longer sentences are dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_RING_MAX_SENTENCE_BYTES    255
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentence types (independent of the talker, e.g. GPGGA and GNGGA are both NMEA_RING_TYPE_GGA).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    NMEA_RING_TYPE_OTHER = 0,       ///< Other standard sentence.
+    NMEA_RING_TYPE_GGA,             ///< Fix data.
+    NMEA_RING_TYPE_RMC,             ///< Recommended minimum data.
+    NMEA_RING_TYPE_GSA,             ///< DOP and active satellites.
+    NMEA_RING_TYPE_GSV,             ///< Satellites in view.
+    NMEA_RING_TYPE_VTG,             ///< Track and ground speed.
+    NMEA_RING_TYPE_GLL,             ///< Geographic position.
+    NMEA_RING_TYPE_GNS,             ///< GNSS fix data.
+    NMEA_RING_TYPE_ZDA,             ///< Time and date.
+    NMEA_RING_TYPE_PROPRIETARY,     ///< Proprietary sentence ($P...).
+    NMEA_RING_TYPE_PAD = 0xFFFF     ///< Padding record, up to the end of the ring.
+}
+nmeaRing_Type_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentence type mask bit of a type.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_RING_MASK(type)        (1U << (type))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mask of all the sentence types.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_RING_MASK_ALL          (NMEA_RING_MASK(NMEA_RING_TYPE_PROPRIETARY + 1) - 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record header.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t    length;             ///< Length of the sentence, in bytes.
+    uint16_t    type;               ///< Type of the sentence (nmeaRing_Type_t).
+    uint32_t    seq;                ///< Sequence number of the sentence.
+}
+nmeaRing_Record_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring layout.
+ *
+ * The counters are offsets in an endless stream of records, the records area holding its last
+ * NMEA_RING_DATA_BYTES. The writer advances tail, then reserve, writes the record, then advances
+ * head. A reader reading the records from tail to head checks reserve afterwards, to know whether
+ * the writer has overwritten them meanwhile.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;              ///< NMEA_RING_MAGIC, set once the ring is initialized.
+    uint32_t    version;            ///< NMEA_RING_VERSION.
+    uint32_t    dataBytes;          ///< NMEA_RING_DATA_BYTES.
+    uint32_t    nextSeq;            ///< Sequence number of the next sentence.
+    uint64_t    head;               ///< End of the last record written.
+    uint64_t    reserve;            ///< End of the record being written.
+    uint64_t    tail;               ///< Start of the oldest record which is not overwritten.
+    uint8_t     data[NMEA_RING_DATA_BYTES] __attribute__((aligned(8)));    ///< Records.
+}
+nmeaRing_Ring_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring reader.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const nmeaRing_Ring_t*  ringPtr;        ///< The mapped ring.
+    uint64_t                cursor;         ///< Start of the next record to read.
+    uint32_t                nextSeq;        ///< Expected sequence number of the next sentence.
+    bool                    isSynchronized; ///< true once nextSeq is known.
+    uint32_t                typeMask;       ///< Types of the sentences to read.
+    uint64_t                lostCount;      ///< Number of sentences overwritten before being read.
+}
+nmeaRing_Reader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a ring, in a file which is deleted (so it is only reachable by its file descriptor).
+ *
+ * @return The mapped ring, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED nmeaRing_Ring_t* nmeaRing_Create
+(
+    int* fdPtr                      ///< [OUT] Read-only file descriptor of the ring, for readers.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a sentence to a ring. Only one thread may write to a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void nmeaRing_Write
+(
+    nmeaRing_Ring_t* ringPtr,       ///< [IN] The ring.
+    const char* sentencePtr         ///< [IN] The sentence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a sentence.
+ *
+ * @return The type.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED nmeaRing_Type_t nmeaRing_GetType
+(
+    const char* sentencePtr         ///< [IN] The sentence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start reading a ring, from its next sentence.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the file is not a ring of this version.
+ *      - LE_FAULT if the file can't be mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t nmeaRing_OpenReader
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [OUT] The reader.
+    int fd,                         ///< [IN] File descriptor of the ring (closed by this function).
+    uint32_t typeMask               ///< [IN] Types of the sentences to read (NMEA_RING_MASK()).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the types of the sentences to read.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void nmeaRing_SetTypeMask
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [IN] The reader.
+    uint32_t typeMask               ///< [IN] Types of the sentences to read (NMEA_RING_MASK()).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the next sentence of the selected types.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_WOULD_BLOCK if there is no new sentence.
+ *      - LE_OVERFLOW if the sentence doesn't fit in the buffer (it is skipped).
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t nmeaRing_Read
+(
+    nmeaRing_Reader_t* readerPtr,   ///< [IN] The reader.
+    char* bufferPtr,                ///< [OUT] The null-terminated sentence.
+    size_t bufferSize,              ///< [IN] Size of the buffer.
+    nmeaRing_Type_t* typePtr        ///< [OUT] Type of the sentence (may be NULL).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of sentences overwritten by the writer before the reader read them.
+ *
+ * @return The number of sentences.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED uint64_t nmeaRing_GetLostCount
+(
+    const nmeaRing_Reader_t* readerPtr  ///< [IN] The reader.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop reading a ring.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void nmeaRing_CloseReader
+(
+    nmeaRing_Reader_t* readerPtr    ///< [IN] The reader.
+);
+
+#endif // LEGATO_NMEARING_INCLUDE_GUARD
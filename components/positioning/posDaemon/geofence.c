@@ -0,0 +1,813 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file geofence.c
+ *
+ * This file contains the source code of the geofence engine of the positioning daemon.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "geofence.h"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+#define PI                      3.14159265358979323846
+#define EARTH_RADIUS            6371000.0   // Mean radius, in meters.
+
+/// Length of a meridian arc of 1e-6 degree, in meters.
+#define METERS_PER_MICRODEGREE  (EARTH_RADIUS * PI / 180.0 / 1000000.0)
+
+#define MAX_LATITUDE            90000000
+#define MAX_LONGITUDE           180000000
+
+/// Maximum relative error of the equirectangular approximation for a circle to be tested with it.
+/// The error comes from the cosine of the latitude changing across the circle, and is about
+/// radius * tan(latitude) / EARTH_RADIUS.
+#define APPROX_MAX_ERROR        0.005
+
+/// Expected number of cells in the index.
+#define CELL_MAP_CAPACITY       4096
+
+//--------------------------------------------------------------------------------------------------
+// Data structures.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fence shapes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SHAPE_CIRCLE,
+    SHAPE_POLYGON
+}
+Shape_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fence structure.
+ */
+//--------------------------------------------------------------------------------------------------
+struct geofence_Fence
+{
+    Shape_t         shape;              ///< Shape of the fence.
+    int32_t         minLatitude;        ///< Bounding box of the fence.
+    int32_t         maxLatitude;
+    int32_t         minLongitude;
+    int32_t         maxLongitude;
+    union
+    {
+        struct
+        {
+            int32_t latitude;           ///< Latitude of the centre.
+            int32_t longitude;          ///< Longitude of the centre.
+            double  radius;             ///< Radius in meters.
+            double  cosLatitude;        ///< Cosine of the latitude of the centre.
+            double  innerSquare;        ///< Approximated squared distances (in meters) below
+            double  outerSquare;        ///< which a position is inside, and above which it is
+                                        ///< outside. Both are 0 if the approximation is not used.
+        }
+        circle;
+        struct
+        {
+            size_t  vertexCount;        ///< Number of vertices.
+            int32_t latitudes[GEOFENCE_MAX_VERTICES];
+            int32_t longitudes[GEOFENCE_MAX_VERTICES];
+        }
+        polygon;
+    };
+    uint32_t        dwellTime;          ///< Dwell time in milliseconds, 0 if none.
+    void*           contextPtr;         ///< Context of the fence.
+    bool            isIndexed;          ///< true if the fence is in the cells of the index, false
+                                        ///< if it is in the large fences list.
+    bool            isInside;           ///< true if the last position was inside.
+    bool            isDwellReported;    ///< true if the dwell transition has been reported.
+    uint64_t        enterTime;          ///< Time the position entered the fence.
+    uint32_t        updateCount;        ///< Value of UpdateCount when the fence was last tested.
+    le_dls_Link_t   largeLink;          ///< Link in the large fences list.
+    le_dls_Link_t   insideLink;         ///< Link in the inside fences list.
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cell of the index.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t        key;                ///< Key of the cell, see GetCellKey().
+    le_dls_List_t   entryList;          ///< Fences whose bounding box covers the cell.
+}
+Cell_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a fence in a cell.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    geofence_Fence_t*   fencePtr;       ///< The fence.
+    le_dls_Link_t       link;           ///< Link in the cell's entry list.
+}
+CellEntry_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pools for fences, cells and cell entries.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t FencePoolRef;
+static le_mem_PoolRef_t CellPoolRef;
+static le_mem_PoolRef_t CellEntryPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cells of the index, by key.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t CellMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fences too large to be indexed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t LargeFenceList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fences the last position was inside.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t InsideFenceList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of calls to geofence_Update(), used to test each fence only once per position.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t UpdateCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index of the cell row or column of a coordinate.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t GetCellIndex
+(
+    int32_t coordinate
+)
+{
+    // Round towards minus infinity, so that cells do not straddle the equator or the meridian.
+    if (coordinate >= 0)
+    {
+        return coordinate / GEOFENCE_CELL_SIZE;
+    }
+    return -(int32_t)(((-(int64_t)coordinate) + GEOFENCE_CELL_SIZE - 1) / GEOFENCE_CELL_SIZE);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the key of a cell.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetCellKey
+(
+    int32_t latitudeIndex,
+    int32_t longitudeIndex
+)
+{
+    return ((uint64_t)(uint32_t)latitudeIndex << 32) | (uint32_t)longitudeIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position is valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsValidPosition
+(
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    return (latitude >= -MAX_LATITUDE) && (latitude <= MAX_LATITUDE) &&
+           (longitude >= -MAX_LONGITUDE) && (longitude <= MAX_LONGITUDE);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the distance in meters between two positions with the haversine formula.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ComputeDistance
+(
+    int32_t latitude1,
+    int32_t longitude1,
+    int32_t latitude2,
+    int32_t longitude2
+)
+{
+    double dLat = ((double)latitude2 - (double)latitude1) / 1000000.0 * PI / 180.0;
+    double dLon = ((double)longitude2 - (double)longitude1) / 1000000.0 * PI / 180.0;
+    double lat1 = (double)latitude1 / 1000000.0 * PI / 180.0;
+    double lat2 = (double)latitude2 / 1000000.0 * PI / 180.0;
+    double a = (sin(dLat / 2) * sin(dLat / 2)) +
+               (sin(dLon / 2) * sin(dLon / 2) * cos(lat1) * cos(lat2));
+
+    return EARTH_RADIUS * 2 * atan2(sqrt(a), sqrt(1 - a));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position is inside a polygon (even-odd rule, with straight edges in the
+ * latitude/longitude plane).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsInsidePolygon
+(
+    const geofence_Fence_t* fencePtr,
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    const int32_t* latPtr = fencePtr->polygon.latitudes;
+    const int32_t* lonPtr = fencePtr->polygon.longitudes;
+    size_t count = fencePtr->polygon.vertexCount;
+    bool isInside = false;
+    size_t i, j;
+
+    for (i = 0, j = count - 1; i < count; j = i++)
+    {
+        if ((latPtr[i] > latitude) != (latPtr[j] > latitude))
+        {
+            // Longitude where the edge crosses the position's latitude.
+            double crossing = (double)lonPtr[i] +
+                              ((double)lonPtr[j] - (double)lonPtr[i]) *
+                              ((double)latitude - (double)latPtr[i]) /
+                              ((double)latPtr[j] - (double)latPtr[i]);
+
+            if ((double)longitude < crossing)
+            {
+                isInside = !isInside;
+            }
+        }
+    }
+
+    return isInside;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position is inside a fence, using the bounding box and the approximated
+ * distance first.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsInsideFence
+(
+    const geofence_Fence_t* fencePtr,
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    if ((latitude < fencePtr->minLatitude) || (latitude > fencePtr->maxLatitude) ||
+        (longitude < fencePtr->minLongitude) || (longitude > fencePtr->maxLongitude))
+    {
+        return false;
+    }
+
+    if (SHAPE_POLYGON == fencePtr->shape)
+    {
+        return IsInsidePolygon(fencePtr, latitude, longitude);
+    }
+
+    if (fencePtr->circle.outerSquare > 0)
+    {
+        // Equirectangular approximation.
+        double y = (double)(latitude - fencePtr->circle.latitude) * METERS_PER_MICRODEGREE;
+        double x = (double)(longitude - fencePtr->circle.longitude) * METERS_PER_MICRODEGREE *
+                   fencePtr->circle.cosLatitude;
+        double square = (x * x) + (y * y);
+
+        if (square < fencePtr->circle.innerSquare)
+        {
+            return true;
+        }
+        if (square > fencePtr->circle.outerSquare)
+        {
+            return false;
+        }
+    }
+
+    return (ComputeDistance(fencePtr->circle.latitude, fencePtr->circle.longitude,
+                            latitude, longitude) <= fencePtr->circle.radius);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the range of cells covered by the bounding box of a fence.
+ *
+ * @return The number of cells.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetCellRange
+(
+    const geofence_Fence_t* fencePtr,
+    int32_t* minLatIndexPtr,
+    int32_t* maxLatIndexPtr,
+    int32_t* minLonIndexPtr,
+    int32_t* maxLonIndexPtr
+)
+{
+    *minLatIndexPtr = GetCellIndex(fencePtr->minLatitude);
+    *maxLatIndexPtr = GetCellIndex(fencePtr->maxLatitude);
+    *minLonIndexPtr = GetCellIndex(fencePtr->minLongitude);
+    *maxLonIndexPtr = GetCellIndex(fencePtr->maxLongitude);
+
+    return (uint64_t)(*maxLatIndexPtr - *minLatIndexPtr + 1) *
+           (uint64_t)(*maxLonIndexPtr - *minLonIndexPtr + 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a fence to the index, or to the large fences list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexFence
+(
+    geofence_Fence_t* fencePtr
+)
+{
+    int32_t minLatIndex, maxLatIndex, minLonIndex, maxLonIndex;
+    int32_t latIndex, lonIndex;
+
+    if (GetCellRange(fencePtr, &minLatIndex, &maxLatIndex, &minLonIndex, &maxLonIndex) >
+        GEOFENCE_MAX_FENCE_CELLS)
+    {
+        fencePtr->isIndexed = false;
+        le_dls_Queue(&LargeFenceList, &fencePtr->largeLink);
+        return;
+    }
+
+    fencePtr->isIndexed = true;
+
+    for (latIndex = minLatIndex; latIndex <= maxLatIndex; latIndex++)
+    {
+        for (lonIndex = minLonIndex; lonIndex <= maxLonIndex; lonIndex++)
+        {
+            uint64_t key = GetCellKey(latIndex, lonIndex);
+            Cell_t* cellPtr = le_hashmap_Get(CellMap, &key);
+
+            if (NULL == cellPtr)
+            {
+                cellPtr = le_mem_ForceAlloc(CellPoolRef);
+                cellPtr->key = key;
+                cellPtr->entryList = LE_DLS_LIST_INIT;
+                le_hashmap_Put(CellMap, &cellPtr->key, cellPtr);
+            }
+
+            CellEntry_t* entryPtr = le_mem_ForceAlloc(CellEntryPoolRef);
+            entryPtr->fencePtr = fencePtr;
+            entryPtr->link = LE_DLS_LINK_INIT;
+            le_dls_Queue(&cellPtr->entryList, &entryPtr->link);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a fence from the index, or from the large fences list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnindexFence
+(
+    geofence_Fence_t* fencePtr
+)
+{
+    int32_t minLatIndex, maxLatIndex, minLonIndex, maxLonIndex;
+    int32_t latIndex, lonIndex;
+
+    if (!fencePtr->isIndexed)
+    {
+        le_dls_Remove(&LargeFenceList, &fencePtr->largeLink);
+        return;
+    }
+
+    GetCellRange(fencePtr, &minLatIndex, &maxLatIndex, &minLonIndex, &maxLonIndex);
+
+    for (latIndex = minLatIndex; latIndex <= maxLatIndex; latIndex++)
+    {
+        for (lonIndex = minLonIndex; lonIndex <= maxLonIndex; lonIndex++)
+        {
+            uint64_t key = GetCellKey(latIndex, lonIndex);
+            Cell_t* cellPtr = le_hashmap_Get(CellMap, &key);
+            le_dls_Link_t* linkPtr;
+
+            LE_ASSERT(NULL != cellPtr);
+
+            for (linkPtr = le_dls_Peek(&cellPtr->entryList);
+                 NULL != linkPtr;
+                 linkPtr = le_dls_PeekNext(&cellPtr->entryList, linkPtr))
+            {
+                CellEntry_t* entryPtr = CONTAINER_OF(linkPtr, CellEntry_t, link);
+
+                if (entryPtr->fencePtr == fencePtr)
+                {
+                    le_dls_Remove(&cellPtr->entryList, linkPtr);
+                    le_mem_Release(entryPtr);
+                    break;
+                }
+            }
+
+            if (le_dls_IsEmpty(&cellPtr->entryList))
+            {
+                le_hashmap_Remove(CellMap, &key);
+                le_mem_Release(cellPtr);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a fence and initialize its common fields.
+ */
+//--------------------------------------------------------------------------------------------------
+static geofence_Fence_t* AllocFence
+(
+    Shape_t shape,
+    uint32_t dwellTime,
+    void* contextPtr
+)
+{
+    geofence_Fence_t* fencePtr = le_mem_ForceAlloc(FencePoolRef);
+
+    memset(fencePtr, 0, sizeof(*fencePtr));
+    fencePtr->shape = shape;
+    fencePtr->dwellTime = dwellTime;
+    fencePtr->contextPtr = contextPtr;
+    fencePtr->largeLink = LE_DLS_LINK_INIT;
+    fencePtr->insideLink = LE_DLS_LINK_INIT;
+    // Not tested by the current update, if any.
+    fencePtr->updateCount = UpdateCount - 1;
+
+    return fencePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test a fence with a position, and report its transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateFence
+(
+    geofence_Fence_t* fencePtr,
+    int32_t latitude,
+    int32_t longitude,
+    uint64_t time,
+    geofence_TransitionFunc_t transitionFunc,
+    void* contextPtr
+)
+{
+    if (fencePtr->updateCount == UpdateCount)
+    {
+        return;
+    }
+    fencePtr->updateCount = UpdateCount;
+
+    bool isInside = IsInsideFence(fencePtr, latitude, longitude);
+
+    if (isInside != fencePtr->isInside)
+    {
+        fencePtr->isInside = isInside;
+
+        if (isInside)
+        {
+            fencePtr->enterTime = time;
+            fencePtr->isDwellReported = false;
+            le_dls_Queue(&InsideFenceList, &fencePtr->insideLink);
+            transitionFunc(fencePtr, GEOFENCE_ENTER, contextPtr);
+        }
+        else
+        {
+            le_dls_Remove(&InsideFenceList, &fencePtr->insideLink);
+            transitionFunc(fencePtr, GEOFENCE_EXIT, contextPtr);
+        }
+    }
+
+    if (isInside && (fencePtr->dwellTime != 0) && !fencePtr->isDwellReported &&
+        (time >= fencePtr->enterTime) && ((time - fencePtr->enterTime) >= fencePtr->dwellTime))
+    {
+        fencePtr->isDwellReported = true;
+        transitionFunc(fencePtr, GEOFENCE_DWELL, contextPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// APIs.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the geofence engine.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Init
+(
+    void
+)
+{
+    FencePoolRef = le_mem_CreatePool("GeofencePool", sizeof(geofence_Fence_t));
+    CellPoolRef = le_mem_CreatePool("GeofenceCellPool", sizeof(Cell_t));
+    CellEntryPoolRef = le_mem_CreatePool("GeofenceCellEntryPool", sizeof(CellEntry_t));
+
+    CellMap = le_hashmap_Create("GeofenceCellMap", CELL_MAP_CAPACITY,
+                                le_hashmap_HashUInt64, le_hashmap_EqualsUInt64);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a circular fence.
+ *
+ * @return The fence, or NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+geofence_Fence_t* geofence_CreateCircle
+(
+    int32_t latitude,           ///< [IN] Latitude of the centre [resolution 1e-6].
+    int32_t longitude,          ///< [IN] Longitude of the centre [resolution 1e-6].
+    uint32_t radius,            ///< [IN] Radius in meters.
+    uint32_t dwellTime,         ///< [IN] Dwell time in milliseconds (0 for no dwell transition).
+    void* contextPtr            ///< [IN] Context of the fence, see geofence_GetContext().
+)
+{
+    if (!IsValidPosition(latitude, longitude) || (0 == radius))
+    {
+        LE_ERROR("Invalid circle [%d,%d] radius %u", latitude, longitude, radius);
+        return NULL;
+    }
+
+    geofence_Fence_t* fencePtr = AllocFence(SHAPE_CIRCLE, dwellTime, contextPtr);
+    double cosLatitude = cos((double)latitude / 1000000.0 * PI / 180.0);
+    // Angle from the centre to the circle, and sine of the largest longitude difference within
+    // the circle (the circle covers all longitudes if it contains a pole).
+    double angle = (double)radius / EARTH_RADIUS;
+    double sinLonAngle = (angle < PI / 2) ? (sin(angle) / cosLatitude) : 2;
+    // One more 1e-6 degree, to absorb rounding.
+    int64_t latMargin = (int64_t)((double)radius / METERS_PER_MICRODEGREE) + 1;
+    int64_t lonMargin = (sinLonAngle < 1) ?
+                        (int64_t)(asin(sinLonAngle) * 180.0 / PI * 1000000.0) + 1 :
+                        MAX_LONGITUDE;
+
+    fencePtr->circle.latitude = latitude;
+    fencePtr->circle.longitude = longitude;
+    fencePtr->circle.radius = radius;
+    fencePtr->circle.cosLatitude = cosLatitude;
+
+    if ((double)radius * fabs(tan((double)latitude / 1000000.0 * PI / 180.0)) <
+        APPROX_MAX_ERROR * EARTH_RADIUS)
+    {
+        // The approximation decides when it is more than 1% of the radius plus 1 meter away from
+        // the radius.
+        double margin = ((double)radius / 100) + 1;
+        double inner = (double)radius - margin;
+
+        fencePtr->circle.innerSquare = (inner > 0) ? (inner * inner) : 0;
+        fencePtr->circle.outerSquare = ((double)radius + margin) * ((double)radius + margin);
+    }
+
+    // The bounding box is clamped, so a circle around a pole or crossing the 180th meridian
+    // covers all the longitudes it should.
+    fencePtr->minLatitude = (latitude - latMargin > -MAX_LATITUDE) ?
+                            (int32_t)(latitude - latMargin) : -MAX_LATITUDE;
+    fencePtr->maxLatitude = (latitude + latMargin < MAX_LATITUDE) ?
+                            (int32_t)(latitude + latMargin) : MAX_LATITUDE;
+    if ((longitude - lonMargin < -MAX_LONGITUDE) || (longitude + lonMargin > MAX_LONGITUDE) ||
+        (fencePtr->minLatitude == -MAX_LATITUDE) || (fencePtr->maxLatitude == MAX_LATITUDE))
+    {
+        fencePtr->minLongitude = -MAX_LONGITUDE;
+        fencePtr->maxLongitude = MAX_LONGITUDE;
+    }
+    else
+    {
+        fencePtr->minLongitude = (int32_t)(longitude - lonMargin);
+        fencePtr->maxLongitude = (int32_t)(longitude + lonMargin);
+    }
+
+    IndexFence(fencePtr);
+
+    return fencePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a polygonal fence.
+ *
+ * @return The fence, or NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+geofence_Fence_t* geofence_CreatePolygon
+(
+    const int32_t* latitudesPtr,    ///< [IN] Latitudes of the vertices [resolution 1e-6].
+    const int32_t* longitudesPtr,   ///< [IN] Longitudes of the vertices [resolution 1e-6].
+    size_t vertexCount,             ///< [IN] Number of vertices (3 to GEOFENCE_MAX_VERTICES).
+    uint32_t dwellTime,             ///< [IN] Dwell time in milliseconds (0 for no dwell
+                                    ///<      transition).
+    void* contextPtr                ///< [IN] Context of the fence, see geofence_GetContext().
+)
+{
+    size_t i;
+
+    if ((vertexCount < 3) || (vertexCount > GEOFENCE_MAX_VERTICES))
+    {
+        LE_ERROR("Invalid polygon with %zu vertices", vertexCount);
+        return NULL;
+    }
+    for (i = 0; i < vertexCount; i++)
+    {
+        if (!IsValidPosition(latitudesPtr[i], longitudesPtr[i]))
+        {
+            LE_ERROR("Invalid polygon vertex [%d,%d]", latitudesPtr[i], longitudesPtr[i]);
+            return NULL;
+        }
+    }
+
+    geofence_Fence_t* fencePtr = AllocFence(SHAPE_POLYGON, dwellTime, contextPtr);
+
+    fencePtr->polygon.vertexCount = vertexCount;
+    fencePtr->minLatitude = fencePtr->maxLatitude = latitudesPtr[0];
+    fencePtr->minLongitude = fencePtr->maxLongitude = longitudesPtr[0];
+    for (i = 0; i < vertexCount; i++)
+    {
+        fencePtr->polygon.latitudes[i] = latitudesPtr[i];
+        fencePtr->polygon.longitudes[i] = longitudesPtr[i];
+        if (latitudesPtr[i] < fencePtr->minLatitude)
+        {
+            fencePtr->minLatitude = latitudesPtr[i];
+        }
+        if (latitudesPtr[i] > fencePtr->maxLatitude)
+        {
+            fencePtr->maxLatitude = latitudesPtr[i];
+        }
+        if (longitudesPtr[i] < fencePtr->minLongitude)
+        {
+            fencePtr->minLongitude = longitudesPtr[i];
+        }
+        if (longitudesPtr[i] > fencePtr->maxLongitude)
+        {
+            fencePtr->maxLongitude = longitudesPtr[i];
+        }
+    }
+
+    IndexFence(fencePtr);
+
+    return fencePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a fence.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Delete
+(
+    geofence_Fence_t* fencePtr      ///< [IN] The fence.
+)
+{
+    UnindexFence(fencePtr);
+
+    if (fencePtr->isInside)
+    {
+        le_dls_Remove(&InsideFenceList, &fencePtr->insideLink);
+    }
+
+    le_mem_Release(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the context of a fence.
+ *
+ * @return The context given when the fence was created.
+ */
+//--------------------------------------------------------------------------------------------------
+void* geofence_GetContext
+(
+    const geofence_Fence_t* fencePtr    ///< [IN] The fence.
+)
+{
+    return fencePtr->contextPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the last position given to geofence_Update() is inside a fence.
+ *
+ * @return true if it is inside, false if it is outside or if there was no position yet.
+ */
+//--------------------------------------------------------------------------------------------------
+bool geofence_IsInside
+(
+    const geofence_Fence_t* fencePtr    ///< [IN] The fence.
+)
+{
+    return fencePtr->isInside;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position is inside a fence, without the index nor the approximations.
+ *
+ * @return true if it is inside.
+ */
+//--------------------------------------------------------------------------------------------------
+bool geofence_Contains
+(
+    const geofence_Fence_t* fencePtr,   ///< [IN] The fence.
+    int32_t latitude,                   ///< [IN] Latitude [resolution 1e-6].
+    int32_t longitude                   ///< [IN] Longitude [resolution 1e-6].
+)
+{
+    if (SHAPE_POLYGON == fencePtr->shape)
+    {
+        return IsInsidePolygon(fencePtr, latitude, longitude);
+    }
+
+    return (ComputeDistance(fencePtr->circle.latitude, fencePtr->circle.longitude,
+                            latitude, longitude) <= fencePtr->circle.radius);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the fences with a new position, and report their transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Update
+(
+    int32_t latitude,                       ///< [IN] Latitude [resolution 1e-6].
+    int32_t longitude,                      ///< [IN] Longitude [resolution 1e-6].
+    uint64_t time,                          ///< [IN] Time of the position in milliseconds.
+    geofence_TransitionFunc_t transitionFunc,   ///< [IN] Function called for each transition.
+    void* contextPtr                        ///< [IN] Context given to transitionFunc.
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    if (!IsValidPosition(latitude, longitude))
+    {
+        LE_ERROR("Invalid position [%d,%d]", latitude, longitude);
+        return;
+    }
+
+    UpdateCount++;
+
+    // Fences indexed in the position's cell.
+    uint64_t key = GetCellKey(GetCellIndex(latitude), GetCellIndex(longitude));
+    Cell_t* cellPtr = le_hashmap_Get(CellMap, &key);
+
+    if (NULL != cellPtr)
+    {
+        for (linkPtr = le_dls_Peek(&cellPtr->entryList);
+             NULL != linkPtr;
+             linkPtr = le_dls_PeekNext(&cellPtr->entryList, linkPtr))
+        {
+            UpdateFence(CONTAINER_OF(linkPtr, CellEntry_t, link)->fencePtr,
+                        latitude, longitude, time, transitionFunc, contextPtr);
+        }
+    }
+
+    // Fences too large to be indexed.
+    for (linkPtr = le_dls_Peek(&LargeFenceList);
+         NULL != linkPtr;
+         linkPtr = le_dls_PeekNext(&LargeFenceList, linkPtr))
+    {
+        UpdateFence(CONTAINER_OF(linkPtr, geofence_Fence_t, largeLink),
+                    latitude, longitude, time, transitionFunc, contextPtr);
+    }
+
+    // Fences the position may have exited, and dwell times of the fences it is still inside.
+    linkPtr = le_dls_Peek(&InsideFenceList);
+    while (NULL != linkPtr)
+    {
+        geofence_Fence_t* fencePtr = CONTAINER_OF(linkPtr, geofence_Fence_t, insideLink);
+
+        // Move to the next node first, as the fence is removed from the list if exited.
+        linkPtr = le_dls_PeekNext(&InsideFenceList, linkPtr);
+
+        UpdateFence(fencePtr, latitude, longitude, time, transitionFunc, contextPtr);
+    }
+}
@@ -0,0 +1,186 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file geofence.h
+ *
+ * Geofence engine of the positioning daemon.
+ *
+ * Fences are circles or polygons, with coordinates in degrees with 6 decimal places (as given by
+ * le_gnss_GetLocation()). They are indexed by a grid of GEOFENCE_CELL_SIZE sized cells, so that a
+ * fix is only tested against the fences whose bounding box covers its cell, the fences which are
+ * too large to be indexed, and the fences the previous fixes were inside.
+ *
+ * A circle is tested with an equirectangular approximation of the distance to its centre, and
+ * with the haversine formula only when the approximation is too close to the radius to decide.
+ *
+ * @note Fences crossing the 180th meridian are not supported.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_GEOFENCE_INCLUDE_GUARD
+#define LEGATO_GEOFENCE_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the index's cells, in degrees with 6 decimal places (0.01 degree is about 1.1 km).
+ */
+//--------------------------------------------------------------------------------------------------
+#define GEOFENCE_CELL_SIZE          10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of cells a fence can cover to be indexed. Larger fences are tested with each fix.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GEOFENCE_MAX_FENCE_CELLS    64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of vertices of a polygon.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GEOFENCE_MAX_VERTICES       16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fence transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    GEOFENCE_ENTER,     ///< The position has entered the fence.
+    GEOFENCE_EXIT,      ///< The position has exited the fence.
+    GEOFENCE_DWELL      ///< The position has stayed in the fence for its dwell time.
+}
+geofence_Transition_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fence object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct geofence_Fence geofence_Fence_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called for each fence transition found by geofence_Update().
+ *
+ * @note The function must not create nor delete fences.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*geofence_TransitionFunc_t)
+(
+    geofence_Fence_t* fencePtr,             ///< [IN] The fence.
+    geofence_Transition_t transition,       ///< [IN] The transition.
+    void* contextPtr                        ///< [IN] The context given to geofence_Update().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the geofence engine.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a circular fence.
+ *
+ * @return The fence, or NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+geofence_Fence_t* geofence_CreateCircle
+(
+    int32_t latitude,           ///< [IN] Latitude of the centre [resolution 1e-6].
+    int32_t longitude,          ///< [IN] Longitude of the centre [resolution 1e-6].
+    uint32_t radius,            ///< [IN] Radius in meters.
+    uint32_t dwellTime,         ///< [IN] Dwell time in milliseconds (0 for no dwell transition).
+    void* contextPtr            ///< [IN] Context of the fence, see geofence_GetContext().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a polygonal fence.
+ *
+ * @return The fence, or NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+geofence_Fence_t* geofence_CreatePolygon
+(
+    const int32_t* latitudesPtr,    ///< [IN] Latitudes of the vertices [resolution 1e-6].
+    const int32_t* longitudesPtr,   ///< [IN] Longitudes of the vertices [resolution 1e-6].
+    size_t vertexCount,             ///< [IN] Number of vertices (3 to GEOFENCE_MAX_VERTICES).
+    uint32_t dwellTime,             ///< [IN] Dwell time in milliseconds (0 for no dwell
+                                    ///<      transition).
+    void* contextPtr                ///< [IN] Context of the fence, see geofence_GetContext().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a fence.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Delete
+(
+    geofence_Fence_t* fencePtr      ///< [IN] The fence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the context of a fence.
+ *
+ * @return The context given when the fence was created.
+ */
+//--------------------------------------------------------------------------------------------------
+void* geofence_GetContext
+(
+    const geofence_Fence_t* fencePtr    ///< [IN] The fence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the last position given to geofence_Update() is inside a fence.
+ *
+ * @return true if it is inside, false if it is outside or if there was no position yet.
+ */
+//--------------------------------------------------------------------------------------------------
+bool geofence_IsInside
+(
+    const geofence_Fence_t* fencePtr    ///< [IN] The fence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position is inside a fence, without the index nor the approximations.
+ *
+ * @return true if it is inside.
+ */
+//--------------------------------------------------------------------------------------------------
+bool geofence_Contains
+(
+    const geofence_Fence_t* fencePtr,   ///< [IN] The fence.
+    int32_t latitude,                   ///< [IN] Latitude [resolution 1e-6].
+    int32_t longitude                   ///< [IN] Longitude [resolution 1e-6].
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the fences with a new position, and report their transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+void geofence_Update
+(
+    int32_t latitude,                       ///< [IN] Latitude [resolution 1e-6].
+    int32_t longitude,                      ///< [IN] Longitude [resolution 1e-6].
+    uint64_t time,                          ///< [IN] Time of the position in milliseconds.
+    geofence_TransitionFunc_t transitionFunc,   ///< [IN] Function called for each transition.
+    void* contextPtr                        ///< [IN] Context given to transitionFunc.
+);
+
+#endif // LEGATO_GEOFENCE_INCLUDE_GUARD
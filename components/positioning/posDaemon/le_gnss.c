@@ -12,6 +12,7 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "pa_gnss.h"
+#include "nmeaRing.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -190,6 +191,57 @@ typedef struct le_gnss_PositionHandler
 }
 le_gnss_PositionHandler_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position Snapshot's Handler structure.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_gnss_PositionSnapshotHandler
+{
+    le_gnss_PositionSnapshotHandlerFunc_t handlerFuncPtr;    ///< The handler function address.
+    void*                                 handlerContextPtr; ///< The handler function context.
+    le_dls_Link_t                         link;              ///< Object node link
+}
+le_gnss_PositionSnapshotHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position snapshot structure, see le_gnss_GetPositionSnapshot().
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_gnss_SnapshotBitMask_t validMask;          ///< Valid fields of the snapshot.
+    le_gnss_FixState_t        state;              ///< Position fix state.
+    int32_t                   latitude;           ///< Latitude
+    int32_t                   longitude;          ///< Longitude
+    int32_t                   hAccuracy;          ///< Horizontal accuracy
+    int32_t                   altitude;           ///< Altitude
+    int32_t                   vAccuracy;          ///< Vertical accuracy
+    int32_t                   altitudeOnWgs84;    ///< Altitude with respect to the WGS-84
+    uint32_t                  hSpeed;             ///< Horizontal speed
+    uint32_t                  hSpeedAccuracy;     ///< Horizontal speed accuracy
+    int32_t                   vSpeed;             ///< Vertical speed
+    int32_t                   vSpeedAccuracy;     ///< Vertical speed accuracy
+    uint32_t                  direction;          ///< Direction
+    uint32_t                  directionAccuracy;  ///< Direction accuracy
+    int32_t                   magneticDeviation;  ///< Magnetic deviation
+    uint64_t                  epochTime;          ///< Epoch time in milliseconds
+    uint32_t                  timeAccuracy;       ///< Time accuracy in nanoseconds
+    uint32_t                  gpsWeek;            ///< GPS week number
+    uint32_t                  gpsTimeOfWeek;      ///< Milliseconds into the GPS week
+    uint8_t                   leapSeconds;        ///< UTC leap seconds in advance
+    uint16_t                  hdop;               ///< Horizontal dilution of precision
+    uint16_t                  vdop;               ///< Vertical dilution of precision
+    uint16_t                  pdop;               ///< Position dilution of precision
+    uint8_t                   satsInViewCount;    ///< Satellites in View count
+    uint8_t                   satsTrackingCount;  ///< Tracking satellites in View count
+    uint8_t                   satsUsedCount;      ///< Satellites in View used for Navigation
+}
+le_gnss_PositionSnapshot_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Position sample request objet structure.
@@ -257,6 +309,30 @@ static int32_t NumOfPositionHandlers = 0;
 //--------------------------------------------------------------------------------------------------
 static le_dls_List_t PositionHandlerList = LE_DLS_LIST_INIT;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for position snapshot's handlers.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t   PositionSnapshotHandlerPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of position snapshot Handler functions.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t NumOfPositionSnapshotHandlers = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create and initialize the position snapshot's handlers list.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t PositionSnapshotHandlerList = LE_DLS_LIST_INIT;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Memory Pool for position samples.
@@ -304,6 +380,20 @@ static le_ref_MapRef_t PositionSampleMap;
 //--------------------------------------------------------------------------------------------------
 static int NmeaPipeFd = -1;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shared NMEA ring, NULL until a client asks for it
+ */
+//--------------------------------------------------------------------------------------------------
+static nmeaRing_Ring_t* NmeaRingPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read-only file descriptor of the shared NMEA ring, duplicated for each client
+ */
+//--------------------------------------------------------------------------------------------------
+static int NmeaRingFd = -1;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Position Handler destructor.
@@ -535,7 +625,11 @@ static void PaNmeaHandler
 {
     LE_DEBUG("Handler Function called with PA NMEA %p", nmeaPtr);
 
-    // Write the NMEA sentence to the /dev/nmea device folder
+    // Write the NMEA sentence to the shared ring, then to the /dev/nmea device folder
+    if (NmeaRingPtr != NULL)
+    {
+        nmeaRing_Write(NmeaRingPtr, nmeaPtr);
+    }
     WriteNmeaPipe(nmeaPtr);
 
     le_mem_Release(nmeaPtr);
@@ -658,6 +752,139 @@ static void GetPosSampleData
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fills in a position snapshot from a position sample.
+ *
+ * Invalid fields are set to 0 for the time fields, and to the maximum value of their type for the
+ * other ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetPositionSnapshot
+(
+    const le_gnss_PositionSample_t* samplePtr,   // [IN] The position sample.
+    le_gnss_PositionSnapshot_t* snapshotPtr      // [OUT] The position snapshot.
+)
+{
+// Set a field of the snapshot, and its bit in the valid mask if the field is valid.
+#define SET_SNAPSHOT_FIELD(field, isValid, value, invalidValue, bit)   \
+    if (isValid)                                                        \
+    {                                                                   \
+        snapshotPtr->field = (value);                                   \
+        snapshotPtr->validMask |= (bit);                                \
+    }                                                                   \
+    else                                                                \
+    {                                                                   \
+        snapshotPtr->field = (invalidValue);                            \
+    }
+
+    snapshotPtr->validMask = 0;
+    snapshotPtr->state = samplePtr->fixState;
+
+    SET_SNAPSHOT_FIELD(latitude, samplePtr->latitudeValid, samplePtr->latitude,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_LATITUDE);
+    SET_SNAPSHOT_FIELD(longitude, samplePtr->longitudeValid, samplePtr->longitude,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_LONGITUDE);
+    SET_SNAPSHOT_FIELD(hAccuracy, samplePtr->hAccuracyValid, samplePtr->hAccuracy,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_H_ACCURACY);
+    SET_SNAPSHOT_FIELD(altitude, samplePtr->altitudeValid, samplePtr->altitude,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_ALTITUDE);
+    SET_SNAPSHOT_FIELD(vAccuracy, samplePtr->vAccuracyValid, samplePtr->vAccuracy,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_V_ACCURACY);
+    SET_SNAPSHOT_FIELD(altitudeOnWgs84, samplePtr->altitudeOnWgs84Valid,
+                       samplePtr->altitudeOnWgs84, INT32_MAX, LE_GNSS_SNAPSHOT_ALTITUDE_ON_WGS84);
+    SET_SNAPSHOT_FIELD(hSpeed, samplePtr->hSpeedValid, samplePtr->hSpeed,
+                       UINT32_MAX, LE_GNSS_SNAPSHOT_H_SPEED);
+    SET_SNAPSHOT_FIELD(hSpeedAccuracy, samplePtr->hSpeedAccuracyValid, samplePtr->hSpeedAccuracy,
+                       UINT32_MAX, LE_GNSS_SNAPSHOT_H_SPEED_ACCURACY);
+    SET_SNAPSHOT_FIELD(vSpeed, samplePtr->vSpeedValid, samplePtr->vSpeed,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_V_SPEED);
+    SET_SNAPSHOT_FIELD(vSpeedAccuracy, samplePtr->vSpeedAccuracyValid, samplePtr->vSpeedAccuracy,
+                       INT32_MAX, LE_GNSS_SNAPSHOT_V_SPEED_ACCURACY);
+    SET_SNAPSHOT_FIELD(direction, samplePtr->directionValid, samplePtr->direction,
+                       UINT32_MAX, LE_GNSS_SNAPSHOT_DIRECTION);
+    SET_SNAPSHOT_FIELD(directionAccuracy, samplePtr->directionAccuracyValid,
+                       samplePtr->directionAccuracy, UINT32_MAX,
+                       LE_GNSS_SNAPSHOT_DIRECTION_ACCURACY);
+    SET_SNAPSHOT_FIELD(magneticDeviation, samplePtr->magneticDeviationValid,
+                       samplePtr->magneticDeviation, INT32_MAX,
+                       LE_GNSS_SNAPSHOT_MAGNETIC_DEVIATION);
+    SET_SNAPSHOT_FIELD(epochTime, samplePtr->timeValid, samplePtr->epochTime,
+                       0, LE_GNSS_SNAPSHOT_EPOCH_TIME);
+    SET_SNAPSHOT_FIELD(timeAccuracy, samplePtr->timeAccuracyValid, samplePtr->timeAccuracy,
+                       UINT32_MAX, LE_GNSS_SNAPSHOT_TIME_ACCURACY);
+    SET_SNAPSHOT_FIELD(gpsWeek, samplePtr->gpsTimeValid, samplePtr->gpsWeek,
+                       0, LE_GNSS_SNAPSHOT_GPS_TIME);
+    SET_SNAPSHOT_FIELD(gpsTimeOfWeek, samplePtr->gpsTimeValid, samplePtr->gpsTimeOfWeek,
+                       0, LE_GNSS_SNAPSHOT_GPS_TIME);
+    SET_SNAPSHOT_FIELD(leapSeconds, samplePtr->leapSecondsValid, samplePtr->leapSeconds,
+                       UINT8_MAX, LE_GNSS_SNAPSHOT_LEAP_SECONDS);
+    // The DOP values are reported on 16 bits.
+    SET_SNAPSHOT_FIELD(hdop, samplePtr->hdopValid && !(samplePtr->hdop >> 16),
+                       (uint16_t)samplePtr->hdop, UINT16_MAX, LE_GNSS_SNAPSHOT_HDOP);
+    SET_SNAPSHOT_FIELD(vdop, samplePtr->vdopValid && !(samplePtr->vdop >> 16),
+                       (uint16_t)samplePtr->vdop, UINT16_MAX, LE_GNSS_SNAPSHOT_VDOP);
+    SET_SNAPSHOT_FIELD(pdop, samplePtr->pdopValid && !(samplePtr->pdop >> 16),
+                       (uint16_t)samplePtr->pdop, UINT16_MAX, LE_GNSS_SNAPSHOT_PDOP);
+    SET_SNAPSHOT_FIELD(satsInViewCount, samplePtr->satsInViewCountValid,
+                       samplePtr->satsInViewCount, UINT8_MAX, LE_GNSS_SNAPSHOT_SATS_IN_VIEW_COUNT);
+    SET_SNAPSHOT_FIELD(satsTrackingCount, samplePtr->satsTrackingCountValid,
+                       samplePtr->satsTrackingCount, UINT8_MAX,
+                       LE_GNSS_SNAPSHOT_SATS_TRACKING_COUNT);
+    SET_SNAPSHOT_FIELD(satsUsedCount, samplePtr->satsUsedCountValid,
+                       samplePtr->satsUsedCount, UINT8_MAX, LE_GNSS_SNAPSHOT_SATS_USED_COUNT);
+
+#undef SET_SNAPSHOT_FIELD
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the snapshot of a position sample to the position snapshot's handlers.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportPositionSnapshot
+(
+    const le_gnss_PositionSample_t* samplePtr   // [IN] The position sample.
+)
+{
+    le_gnss_PositionSnapshot_t snapshot;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PositionSnapshotHandlerList);
+
+    if (NULL == linkPtr)
+    {
+        return;
+    }
+
+    GetPositionSnapshot(samplePtr, &snapshot);
+
+    do
+    {
+        le_gnss_PositionSnapshotHandler_t* handlerNodePtr =
+                        CONTAINER_OF(linkPtr, le_gnss_PositionSnapshotHandler_t, link);
+
+        // Move to the next node first, as the handler may remove itself.
+        linkPtr = le_dls_PeekNext(&PositionSnapshotHandlerList, linkPtr);
+
+        handlerNodePtr->handlerFuncPtr(snapshot.validMask, snapshot.state,
+                                       snapshot.latitude, snapshot.longitude, snapshot.hAccuracy,
+                                       snapshot.altitude, snapshot.vAccuracy,
+                                       snapshot.altitudeOnWgs84,
+                                       snapshot.hSpeed, snapshot.hSpeedAccuracy,
+                                       snapshot.vSpeed, snapshot.vSpeedAccuracy,
+                                       snapshot.direction, snapshot.directionAccuracy,
+                                       snapshot.magneticDeviation,
+                                       snapshot.epochTime, snapshot.timeAccuracy,
+                                       snapshot.gpsWeek, snapshot.gpsTimeOfWeek,
+                                       snapshot.leapSeconds,
+                                       snapshot.hdop, snapshot.vdop, snapshot.pdop,
+                                       snapshot.satsInViewCount, snapshot.satsTrackingCount,
+                                       snapshot.satsUsedCount,
+                                       handlerNodePtr->handlerContextPtr);
+    } while (NULL != linkPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The signal event handler function for SIGPIPE called from the Legato event loop.
@@ -710,6 +937,9 @@ static void PaPositionHandler
     // Get the position sample data from the PA position data report
     GetPosSampleData(&LastPositionSample, positionPtr);
 
+    // Push the snapshot to the clients which do not need a position sample
+    ReportPositionSnapshot(&LastPositionSample);
+
     if(!NumOfPositionHandlers)
     {
         LE_DEBUG("No positioning handlers, exit Handler Function");
@@ -911,6 +1141,10 @@ le_result_t gnss_Init
                                                sizeof(le_gnss_PositionHandler_t));
     le_mem_SetDestructor(PositionHandlerPoolRef, PositionHandlerDestructor);
 
+    // Create a pool for Position Snapshot Handler objects
+    PositionSnapshotHandlerPoolRef = le_mem_CreatePool("PositionSnapshotHandlerPoolRef",
+                                                   sizeof(le_gnss_PositionSnapshotHandler_t));
+
     // Create a pool for Position Sample objects
     PositionSamplePoolRef = le_mem_CreatePool("PositionSamplePoolRef",
                                               sizeof(le_gnss_PositionSample_t));
@@ -931,6 +1165,7 @@ le_result_t gnss_Init
 
     // Initialize Handler context
     NumOfPositionHandlers = 0;
+    NumOfPositionSnapshotHandlers = 0;
     PaHandlerRef = NULL;
 
     // Initialize last Position sample
@@ -1071,7 +1306,91 @@ void le_gnss_RemovePositionHandler
         } while (linkPtr != NULL);
     }
 
-    if(NumOfPositionHandlers == 0)
+    if((NumOfPositionHandlers == 0) && (NumOfPositionSnapshotHandlers == 0))
+    {
+        pa_gnss_RemovePositionDataHandler(PaHandlerRef);
+        PaHandlerRef = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to register an handler for position snapshot notifications.
+ *
+ *  - A handler reference, which is only needed for later removal of the handler.
+ *
+ * @note Doesn't return on failure, so there's no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_gnss_PositionSnapshotHandlerRef_t le_gnss_AddPositionSnapshotHandler
+(
+    le_gnss_PositionSnapshotHandlerFunc_t handlerPtr,   ///< [IN] The handler function.
+    void*                                 contextPtr    ///< [IN] The context pointer
+)
+{
+    le_gnss_PositionSnapshotHandler_t*  snapshotHandlerPtr;
+
+    LE_FATAL_IF((NULL == handlerPtr), "handlerPtr pointer is NULL !");
+
+    // Create the position snapshot handler node.
+    snapshotHandlerPtr = le_mem_ForceAlloc(PositionSnapshotHandlerPoolRef);
+    snapshotHandlerPtr->handlerFuncPtr = handlerPtr;
+    snapshotHandlerPtr->handlerContextPtr = contextPtr;
+    snapshotHandlerPtr->link = LE_DLS_LINK_INIT;
+
+    // Subscribe to PA position Data handler
+    if (NULL == PaHandlerRef)
+    {
+        if ((PaHandlerRef=pa_gnss_AddPositionDataHandler(PaPositionHandler)) == NULL)
+        {
+            LE_ERROR("Failed to add PA position Data handler!");
+        }
+        else
+        {
+            LE_DEBUG("PaHandlerRef %p subscribed", PaHandlerRef);
+        }
+    }
+
+    // Update the position snapshot handler list with that new handler
+    le_dls_Queue(&PositionSnapshotHandlerList, &(snapshotHandlerPtr->link));
+    NumOfPositionSnapshotHandlers++;
+
+    LE_DEBUG("Position snapshot handler %p added", handlerPtr);
+
+    return (le_gnss_PositionSnapshotHandlerRef_t)snapshotHandlerPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to remove a handler for position snapshot notifications.
+ *
+ * @note Doesn't return on failure, so there's no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_gnss_RemovePositionSnapshotHandler
+(
+    le_gnss_PositionSnapshotHandlerRef_t    handlerRef ///< [IN] The handler reference.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PositionSnapshotHandlerList);
+
+    while (NULL != linkPtr)
+    {
+        le_gnss_PositionSnapshotHandler_t* snapshotHandlerPtr =
+                        CONTAINER_OF(linkPtr, le_gnss_PositionSnapshotHandler_t, link);
+
+        if ((le_gnss_PositionSnapshotHandlerRef_t)snapshotHandlerPtr == handlerRef)
+        {
+            le_dls_Remove(&PositionSnapshotHandlerList, linkPtr);
+            le_mem_Release(snapshotHandlerPtr);
+            NumOfPositionSnapshotHandlers--;
+            break;
+        }
+
+        linkPtr = le_dls_PeekNext(&PositionSnapshotHandlerList, linkPtr);
+    }
+
+    if((NumOfPositionHandlers == 0) && (NumOfPositionSnapshotHandlers == 0))
     {
         pa_gnss_RemovePositionDataHandler(PaHandlerRef);
         PaHandlerRef = NULL;
@@ -2613,6 +2932,116 @@ le_result_t le_gnss_GetMagneticDeviation
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a snapshot of the position sample: fix state, location, altitude, speeds, direction, time,
+ * DOP and satellites counts, in one call.
+ *
+ * @return
+ *  - LE_FAULT         Function failed to get the snapshot. Invalid Position reference provided.
+ *  - LE_OK            Function succeeded.
+ *
+ * @note The fields which are not set in validMask are invalid: the time fields (epochTime,
+ *       gpsWeek and gpsTimeOfWeek) are set to 0, and the other ones to the maximum value of their
+ *       type (e.g. INT32_MAX for latitude).
+ *
+ * @note If the caller is passing an invalid Position sample reference or a null pointer into this
+ *       function, it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetPositionSnapshot
+(
+    le_gnss_SampleRef_t positionSampleRef,      ///< [IN] Position sample's reference.
+    le_gnss_SnapshotBitMask_t* validMaskPtr,    ///< [OUT] Valid fields of the snapshot.
+    le_gnss_FixState_t* statePtr,               ///< [OUT] Position fix state.
+    int32_t* latitudePtr,                       ///< [OUT] Latitude [resolution 1e-6].
+    int32_t* longitudePtr,                      ///< [OUT] Longitude [resolution 1e-6].
+    int32_t* hAccuracyPtr,                      ///< [OUT] Horizontal accuracy [resolution 1e-2].
+    int32_t* altitudePtr,                       ///< [OUT] Altitude [resolution 1e-3].
+    int32_t* vAccuracyPtr,                      ///< [OUT] Vertical accuracy [resolution 1e-1].
+    int32_t* altitudeOnWgs84Ptr,                ///< [OUT] Altitude on WGS-84 [resolution 1e-3].
+    uint32_t* hSpeedPtr,                        ///< [OUT] Horizontal speed [resolution 1e-2].
+    uint32_t* hSpeedAccuracyPtr,                ///< [OUT] Horizontal speed's accuracy
+                                                ///<       [resolution 1e-1].
+    int32_t* vSpeedPtr,                         ///< [OUT] Vertical speed [resolution 1e-2].
+    int32_t* vSpeedAccuracyPtr,                 ///< [OUT] Vertical speed's accuracy
+                                                ///<       [resolution 1e-1].
+    uint32_t* directionPtr,                     ///< [OUT] Direction [resolution 1e-1].
+    uint32_t* directionAccuracyPtr,             ///< [OUT] Direction's accuracy [resolution 1e-1].
+    int32_t* magneticDeviationPtr,              ///< [OUT] Magnetic deviation [resolution 1e-1].
+    uint64_t* epochTimePtr,                     ///< [OUT] Milliseconds since Jan. 1, 1970.
+    uint32_t* timeAccuracyPtr,                  ///< [OUT] Time accuracy in nanoseconds.
+    uint32_t* gpsWeekPtr,                       ///< [OUT] GPS week number.
+    uint32_t* gpsTimeOfWeekPtr,                 ///< [OUT] Milliseconds into the GPS week.
+    uint8_t* leapSecondsPtr,                    ///< [OUT] UTC leap seconds in advance.
+    uint16_t* hdopPtr,                          ///< [OUT] Horizontal DOP [resolution 1e-3].
+    uint16_t* vdopPtr,                          ///< [OUT] Vertical DOP [resolution 1e-3].
+    uint16_t* pdopPtr,                          ///< [OUT] Position DOP [resolution 1e-3].
+    uint8_t* satsInViewCountPtr,                ///< [OUT] Satellites in View count.
+    uint8_t* satsTrackingCountPtr,              ///< [OUT] Tracking satellites count.
+    uint8_t* satsUsedCountPtr                   ///< [OUT] Satellites used for Navigation count.
+)
+{
+    le_result_t result;
+    le_gnss_PositionSnapshot_t snapshot;
+    le_gnss_PositionSampleRequest_t* positionSampleRequestNodePtr
+                                            = le_ref_Lookup(PositionSampleMap,positionSampleRef);
+
+    // Check input pointers
+    if ((NULL == validMaskPtr) || (NULL == statePtr) || (NULL == latitudePtr)
+        || (NULL == longitudePtr) || (NULL == hAccuracyPtr) || (NULL == altitudePtr)
+        || (NULL == vAccuracyPtr) || (NULL == altitudeOnWgs84Ptr) || (NULL == hSpeedPtr)
+        || (NULL == hSpeedAccuracyPtr) || (NULL == vSpeedPtr) || (NULL == vSpeedAccuracyPtr)
+        || (NULL == directionPtr) || (NULL == directionAccuracyPtr)
+        || (NULL == magneticDeviationPtr) || (NULL == epochTimePtr) || (NULL == timeAccuracyPtr)
+        || (NULL == gpsWeekPtr) || (NULL == gpsTimeOfWeekPtr) || (NULL == leapSecondsPtr)
+        || (NULL == hdopPtr) || (NULL == vdopPtr) || (NULL == pdopPtr)
+        || (NULL == satsInViewCountPtr) || (NULL == satsTrackingCountPtr)
+        || (NULL == satsUsedCountPtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    // Check position sample's reference
+    result = ValidatePositionSamplePtr(positionSampleRequestNodePtr);
+    if (LE_OK != result)
+    {
+        return result;
+    }
+
+    GetPositionSnapshot(positionSampleRequestNodePtr->positionSampleNodePtr, &snapshot);
+
+    *validMaskPtr = snapshot.validMask;
+    *statePtr = snapshot.state;
+    *latitudePtr = snapshot.latitude;
+    *longitudePtr = snapshot.longitude;
+    *hAccuracyPtr = snapshot.hAccuracy;
+    *altitudePtr = snapshot.altitude;
+    *vAccuracyPtr = snapshot.vAccuracy;
+    *altitudeOnWgs84Ptr = snapshot.altitudeOnWgs84;
+    *hSpeedPtr = snapshot.hSpeed;
+    *hSpeedAccuracyPtr = snapshot.hSpeedAccuracy;
+    *vSpeedPtr = snapshot.vSpeed;
+    *vSpeedAccuracyPtr = snapshot.vSpeedAccuracy;
+    *directionPtr = snapshot.direction;
+    *directionAccuracyPtr = snapshot.directionAccuracy;
+    *magneticDeviationPtr = snapshot.magneticDeviation;
+    *epochTimePtr = snapshot.epochTime;
+    *timeAccuracyPtr = snapshot.timeAccuracy;
+    *gpsWeekPtr = snapshot.gpsWeek;
+    *gpsTimeOfWeekPtr = snapshot.gpsTimeOfWeek;
+    *leapSecondsPtr = snapshot.leapSeconds;
+    *hdopPtr = snapshot.hdop;
+    *vdopPtr = snapshot.vdop;
+    *pdopPtr = snapshot.pdop;
+    *satsInViewCountPtr = snapshot.satsInViewCount;
+    *satsTrackingCountPtr = snapshot.satsTrackingCount;
+    *satsUsedCountPtr = snapshot.satsUsedCount;
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function gets the last updated position sample object reference.
@@ -3884,6 +4313,57 @@ le_result_t le_gnss_GetNmeaSentences
     return result;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function gets the shared ring of the NMEA frames.
+ *
+ * @return
+ *  - LE_OK             Success
+ *  - LE_UNSUPPORTED    The NMEA frames are not handled by the positioning service
+ *  - LE_FAULT          The ring can't be created
+ *
+ * @note If the caller is passing an null pointer to this function, it is a fatal error
+ *       and the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetNmeaRing
+(
+    int* fdPtr                  ///< [OUT] File descriptor of the ring.
+)
+{
+    if (NULL == fdPtr)
+    {
+        LE_KILL_CLIENT("fdPtr is NULL !");
+        return LE_FAULT;
+    }
+    *fdPtr = -1;
+
+    // The NMEA frames are only received from the PA if /dev/nmea is not a character device.
+    if (NULL == PaNmeaHandlerRef)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    if (NULL == NmeaRingPtr)
+    {
+        NmeaRingPtr = nmeaRing_Create(&NmeaRingFd);
+        if (NULL == NmeaRingPtr)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    // The IPC layer closes the fd once it's sent, so send a duplicate.
+    *fdPtr = fcntl(NmeaRingFd, F_DUPFD_CLOEXEC, 0);
+    if (*fdPtr < 0)
+    {
+        LE_ERROR("Failed to duplicate the NMEA ring fd (%m).");
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function returns the state of the GNSS device.
@@ -12,6 +12,8 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "le_gnss_local.h"
+#include "le_posFence_local.h"
+#include "le_posTrack_local.h"
 #include "posCfgEntries.h"
 #include "watchdogChain.h"
 
@@ -1022,6 +1024,23 @@ static void PosCloseSessionEventHandler
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The signal event handler function for SIGTERM called from the Legato event loop: it replaces the
+ * default one, to write the recorded fixes to the track before exiting.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TermSignalHandler
+(
+    int sigNum      ///< [IN] The signal that was received.
+)
+{
+    posTrack_Flush();
+
+    LE_CRIT("Terminated");
+    exit(EXIT_SUCCESS);
+}
+
 //--------------------------------------------------------------------------------------------------
 // APIs.
 //--------------------------------------------------------------------------------------------------
@@ -1072,6 +1091,12 @@ COMPONENT_INIT
     PosCtrlHandlerPoolRef = le_mem_CreatePool("PosCtrlHandlerPoolRef", sizeof(ClientRequest_t));
     le_mem_ExpandPool(PosCtrlHandlerPoolRef,POSITIONING_ACTIVATION_MAX);
 
+    posFence_Init();
+    posTrack_Init();
+
+    // Replace the default SIGTERM handler installed by main(), which keeps SIGTERM blocked.
+    le_sig_SetEventHandler(SIGTERM, TermSignalHandler);
+
     // TODO define a policy for positioning device selection
     if (IsGNSSAvailable() == true)
     {
@@ -0,0 +1,515 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_posFence.c
+ *
+ * This file contains the source code of the Positioning Geofence API.
+ *
+ * The fences are kept by the geofence engine (see geofence.h), which is fed with the position
+ * snapshots of le_gnss while there is at least one fence.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "le_posFence_local.h"
+#include "geofence.h"
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expected number of fences.
+ */
+//--------------------------------------------------------------------------------------------------
+#define POSFENCE_FENCE_MAX      64
+
+//--------------------------------------------------------------------------------------------------
+// Data structures.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fence structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    geofence_Fence_t*       enginePtr;      ///< The fence in the geofence engine.
+    le_posFence_FenceRef_t  ref;            ///< Safe reference of the fence.
+    le_msg_SessionRef_t     sessionRef;     ///< Client session which created the fence.
+}
+Fence_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Transition handler structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_posFence_TransitionHandlerFunc_t handlerFuncPtr;     ///< The handler function.
+    void*                               handlerContextPtr;  ///< The handler's context.
+    le_msg_SessionRef_t                 sessionRef;         ///< Client session of the handler.
+    le_dls_Link_t                       link;               ///< Link in the handler list.
+}
+TransitionHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for fence objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t FencePoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe reference map for fences.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t FenceRefMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of fences.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t NumOfFences = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for transition handler objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t TransitionHandlerPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of transition handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t TransitionHandlerList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference of the le_gnss position snapshot handler, NULL if there is no fence.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_gnss_PositionSnapshotHandlerRef_t SnapshotHandlerRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a fence transition to the transition handlers of the client which created the fence.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportTransition
+(
+    geofence_Fence_t* enginePtr,
+    geofence_Transition_t transition,
+    void* contextPtr
+)
+{
+    Fence_t* fencePtr = geofence_GetContext(enginePtr);
+    le_posFence_Transition_t posFenceTransition;
+    le_dls_Link_t* linkPtr;
+
+    switch (transition)
+    {
+        case GEOFENCE_ENTER:
+            posFenceTransition = LE_POSFENCE_ENTER;
+            break;
+        case GEOFENCE_EXIT:
+            posFenceTransition = LE_POSFENCE_EXIT;
+            break;
+        default:
+            posFenceTransition = LE_POSFENCE_DWELL;
+            break;
+    }
+
+    LE_DEBUG("Fence %p transition %d", fencePtr->ref, posFenceTransition);
+
+    for (linkPtr = le_dls_Peek(&TransitionHandlerList);
+         NULL != linkPtr;
+         linkPtr = le_dls_PeekNext(&TransitionHandlerList, linkPtr))
+    {
+        TransitionHandler_t* handlerPtr = CONTAINER_OF(linkPtr, TransitionHandler_t, link);
+
+        if (handlerPtr->sessionRef == fencePtr->sessionRef)
+        {
+            handlerPtr->handlerFuncPtr(fencePtr->ref, posFenceTransition,
+                                       handlerPtr->handlerContextPtr);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_gnss position snapshot handler: update the fences with the new fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PositionSnapshotHandler
+(
+    le_gnss_SnapshotBitMask_t validMask,
+    le_gnss_FixState_t state,
+    int32_t latitude,
+    int32_t longitude,
+    int32_t hAccuracy,
+    int32_t altitude,
+    int32_t vAccuracy,
+    int32_t altitudeOnWgs84,
+    uint32_t hSpeed,
+    uint32_t hSpeedAccuracy,
+    int32_t vSpeed,
+    int32_t vSpeedAccuracy,
+    uint32_t direction,
+    uint32_t directionAccuracy,
+    int32_t magneticDeviation,
+    uint64_t epochTime,
+    uint32_t timeAccuracy,
+    uint32_t gpsWeek,
+    uint32_t gpsTimeOfWeek,
+    uint8_t leapSeconds,
+    uint16_t hdop,
+    uint16_t vdop,
+    uint16_t pdop,
+    uint8_t satsInViewCount,
+    uint8_t satsTrackingCount,
+    uint8_t satsUsedCount,
+    void* contextPtr
+)
+{
+    if (((validMask & LE_GNSS_SNAPSHOT_LATITUDE) == 0) ||
+        ((validMask & LE_GNSS_SNAPSHOT_LONGITUDE) == 0))
+    {
+        return;
+    }
+
+    // Dwell times are measured with the relative clock, which does not jump as the fix's time
+    // does when the system time is set.
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    uint64_t time = ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+
+    geofence_Update(latitude, longitude, time, ReportTransition, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a fence, and start receiving the position snapshots for the first one.
+ *
+ * @return The fence reference, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_posFence_FenceRef_t AddFence
+(
+    Fence_t* fencePtr
+)
+{
+    if (NULL == fencePtr->enginePtr)
+    {
+        le_mem_Release(fencePtr);
+        return NULL;
+    }
+
+    if (0 == NumOfFences)
+    {
+        SnapshotHandlerRef = le_gnss_AddPositionSnapshotHandler(PositionSnapshotHandler, NULL);
+        if (NULL == SnapshotHandlerRef)
+        {
+            LE_ERROR("Failed to add GNSS position snapshot handler!");
+            geofence_Delete(fencePtr->enginePtr);
+            le_mem_Release(fencePtr);
+            return NULL;
+        }
+    }
+    NumOfFences++;
+
+    fencePtr->sessionRef = le_posFence_GetClientSessionRef();
+    fencePtr->ref = le_ref_CreateRef(FenceRefMap, fencePtr);
+
+    return fencePtr->ref;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a fence, and stop receiving the position snapshots after the last one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteFence
+(
+    Fence_t* fencePtr
+)
+{
+    le_ref_DeleteRef(FenceRefMap, fencePtr->ref);
+    geofence_Delete(fencePtr->enginePtr);
+    le_mem_Release(fencePtr);
+
+    NumOfFences--;
+    if (0 == NumOfFences)
+    {
+        le_gnss_RemovePositionSnapshotHandler(SnapshotHandlerRef);
+        SnapshotHandlerRef = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function to release the fences and transition handlers of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseSessionEventHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    if (!sessionRef)
+    {
+        LE_ERROR("ERROR sessionRef is NULL");
+        return;
+    }
+
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(FenceRefMap);
+    le_result_t result = le_ref_NextNode(iterRef);
+    while (result == LE_OK)
+    {
+        Fence_t* fencePtr = (Fence_t*)le_ref_GetValue(iterRef);
+
+        // Get the next node first, as the current one is deleted.
+        result = le_ref_NextNode(iterRef);
+
+        if (fencePtr->sessionRef == sessionRef)
+        {
+            LE_DEBUG("Delete fence %p, Session %p", fencePtr->ref, sessionRef);
+            DeleteFence(fencePtr);
+        }
+    }
+
+    linkPtr = le_dls_Peek(&TransitionHandlerList);
+    while (NULL != linkPtr)
+    {
+        TransitionHandler_t* handlerPtr = CONTAINER_OF(linkPtr, TransitionHandler_t, link);
+
+        linkPtr = le_dls_PeekNext(&TransitionHandlerList, linkPtr);
+
+        if (handlerPtr->sessionRef == sessionRef)
+        {
+            le_dls_Remove(&TransitionHandlerList, &handlerPtr->link);
+            le_mem_Release(handlerPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Internal interface functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to initialize the positioning geofences
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_Init
+(
+    void
+)
+{
+    geofence_Init();
+
+    FencePoolRef = le_mem_CreatePool("PosFencePoolRef", sizeof(Fence_t));
+    FenceRefMap = le_ref_CreateMap("PosFenceMap", POSFENCE_FENCE_MAX);
+
+    TransitionHandlerPoolRef = le_mem_CreatePool("PosFenceHandlerPoolRef",
+                                                 sizeof(TransitionHandler_t));
+
+    le_msg_AddServiceCloseHandler(le_posFence_GetServiceRef(), CloseSessionEventHandler, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// APIs.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a circular fence.
+ *
+ * @return
+ *      - Reference to the fence.
+ *      - NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_posFence_FenceRef_t le_posFence_CreateCircle
+(
+    int32_t latitude,       ///< [IN] WGS84 Latitude of the centre [resolution 1e-6].
+    int32_t longitude,      ///< [IN] WGS84 Longitude of the centre [resolution 1e-6].
+    uint32_t radius,        ///< [IN] Radius in meters.
+    uint32_t dwellTime      ///< [IN] Dwell time in milliseconds, 0 for no dwell transition.
+)
+{
+    Fence_t* fencePtr = le_mem_ForceAlloc(FencePoolRef);
+
+    fencePtr->enginePtr = geofence_CreateCircle(latitude, longitude, radius, dwellTime,
+                                                fencePtr);
+
+    return AddFence(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a polygonal fence.
+ *
+ * @return
+ *      - Reference to the fence.
+ *      - NULL if a parameter is invalid (less than 3 vertices, or not as many latitudes as
+ *        longitudes).
+ */
+//--------------------------------------------------------------------------------------------------
+le_posFence_FenceRef_t le_posFence_CreatePolygon
+(
+    const int32_t* latitudePtr,     ///< [IN] WGS84 Latitudes of the vertices [resolution 1e-6].
+    size_t latitudeSize,            ///< [IN] Number of latitudes.
+    const int32_t* longitudePtr,    ///< [IN] WGS84 Longitudes of the vertices [resolution 1e-6].
+    size_t longitudeSize,           ///< [IN] Number of longitudes.
+    uint32_t dwellTime              ///< [IN] Dwell time in milliseconds, 0 for no dwell
+                                    ///<      transition.
+)
+{
+    if (latitudeSize != longitudeSize)
+    {
+        LE_ERROR("%zu latitudes for %zu longitudes", latitudeSize, longitudeSize);
+        return NULL;
+    }
+
+    Fence_t* fencePtr = le_mem_ForceAlloc(FencePoolRef);
+
+    fencePtr->enginePtr = geofence_CreatePolygon(latitudePtr, longitudePtr, latitudeSize,
+                                                 dwellTime, fencePtr);
+
+    return AddFence(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a fence.
+ *
+ * @note If the caller is passing an invalid fence reference into this function,
+ *       it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_posFence_Delete
+(
+    le_posFence_FenceRef_t fenceRef     ///< [IN] Reference to the fence.
+)
+{
+    Fence_t* fencePtr = le_ref_Lookup(FenceRefMap, fenceRef);
+
+    if ((NULL == fencePtr) || (fencePtr->sessionRef != le_posFence_GetClientSessionRef()))
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", fenceRef);
+        return;
+    }
+
+    DeleteFence(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the last fix is inside a fence.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_BAD_PARAMETER if the fence reference is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_posFence_IsInside
+(
+    le_posFence_FenceRef_t fenceRef,    ///< [IN] Reference to the fence.
+    bool* isInsidePtr                   ///< [OUT] true if the last fix is inside.
+)
+{
+    Fence_t* fencePtr = le_ref_Lookup(FenceRefMap, fenceRef);
+
+    if ((NULL == fencePtr) || (fencePtr->sessionRef != le_posFence_GetClientSessionRef()))
+    {
+        LE_ERROR("Invalid reference (%p) provided!", fenceRef);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (NULL == isInsidePtr)
+    {
+        LE_KILL_CLIENT("isInsidePtr is NULL !");
+        return LE_BAD_PARAMETER;
+    }
+
+    *isInsidePtr = geofence_IsInside(fencePtr->enginePtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'le_posFence_Transition'
+ *
+ * This event provides the transitions of the client's fences.
+ */
+//--------------------------------------------------------------------------------------------------
+le_posFence_TransitionHandlerRef_t le_posFence_AddTransitionHandler
+(
+    le_posFence_TransitionHandlerFunc_t handlerPtr,     ///< [IN] The handler function.
+    void* contextPtr                                    ///< [IN] The context pointer.
+)
+{
+    if (NULL == handlerPtr)
+    {
+        LE_KILL_CLIENT("handlerPtr pointer is NULL!");
+        return NULL;
+    }
+
+    TransitionHandler_t* transitionHandlerPtr = le_mem_ForceAlloc(TransitionHandlerPoolRef);
+
+    transitionHandlerPtr->handlerFuncPtr = handlerPtr;
+    transitionHandlerPtr->handlerContextPtr = contextPtr;
+    transitionHandlerPtr->sessionRef = le_posFence_GetClientSessionRef();
+    transitionHandlerPtr->link = LE_DLS_LINK_INIT;
+    le_dls_Queue(&TransitionHandlerList, &transitionHandlerPtr->link);
+
+    return (le_posFence_TransitionHandlerRef_t)transitionHandlerPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'le_posFence_Transition'
+ */
+//--------------------------------------------------------------------------------------------------
+void le_posFence_RemoveTransitionHandler
+(
+    le_posFence_TransitionHandlerRef_t handlerRef   ///< [IN] The handler reference.
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    for (linkPtr = le_dls_Peek(&TransitionHandlerList);
+         NULL != linkPtr;
+         linkPtr = le_dls_PeekNext(&TransitionHandlerList, linkPtr))
+    {
+        TransitionHandler_t* handlerPtr = CONTAINER_OF(linkPtr, TransitionHandler_t, link);
+
+        if ((le_posFence_TransitionHandlerRef_t)handlerPtr == handlerRef)
+        {
+            le_dls_Remove(&TransitionHandlerList, linkPtr);
+            le_mem_Release(handlerPtr);
+            return;
+        }
+    }
+}
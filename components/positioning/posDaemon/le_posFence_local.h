@@ -0,0 +1,24 @@
+/**
+ * @file le_posFence_local.h
+ *
+ * Local Positioning Geofence Definitions
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_POSFENCE_LOCAL_INCLUDE_GUARD
+#define LEGATO_POSFENCE_LOCAL_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to initialize the positioning geofences
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_Init
+(
+    void
+);
+
+#endif // LEGATO_POSFENCE_LOCAL_INCLUDE_GUARD
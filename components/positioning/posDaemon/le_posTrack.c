@@ -0,0 +1,426 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_posTrack.c
+ *
+ * This file contains the source code of the Positioning Track API.
+ *
+ * The fixes are recorded by the track recorder (see track.h), which is fed with the position
+ * snapshots of le_gnss while there is at least one recording request, and flushed periodically
+ * and when the daemon is terminated.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "le_posTrack_local.h"
+#include "track.h"
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Track directory.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifdef LEGATO_EMBEDDED
+#define POSTRACK_PATH           "/data/le_pos/track"
+#else
+#define POSTRACK_PATH           "/tmp/le_pos/track"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interval between two flushes of the recorded fixes, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define POSTRACK_FLUSH_INTERVAL 60000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expected number of recording requests.
+ */
+//--------------------------------------------------------------------------------------------------
+#define POSTRACK_RECORDING_MAX  8
+
+//--------------------------------------------------------------------------------------------------
+// Data structures.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Recording request structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_posTrack_RecordingRef_t  ref;            ///< Safe reference of the request.
+    le_msg_SessionRef_t         sessionRef;     ///< Client session of the request.
+}
+Recording_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if the track recorder is initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTrackAvailable = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for recording request objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t RecordingPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe reference map for recording requests.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t RecordingRefMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of recording requests.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t NumOfRecordings = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference of the le_gnss position snapshot handler, NULL if not recording.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_gnss_PositionSnapshotHandlerRef_t SnapshotHandlerRef = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer to flush the recorded fixes.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t FlushTimerRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * le_gnss position snapshot handler: record the fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PositionSnapshotHandler
+(
+    le_gnss_SnapshotBitMask_t validMask,
+    le_gnss_FixState_t state,
+    int32_t latitude,
+    int32_t longitude,
+    int32_t hAccuracy,
+    int32_t altitude,
+    int32_t vAccuracy,
+    int32_t altitudeOnWgs84,
+    uint32_t hSpeed,
+    uint32_t hSpeedAccuracy,
+    int32_t vSpeed,
+    int32_t vSpeedAccuracy,
+    uint32_t direction,
+    uint32_t directionAccuracy,
+    int32_t magneticDeviation,
+    uint64_t epochTime,
+    uint32_t timeAccuracy,
+    uint32_t gpsWeek,
+    uint32_t gpsTimeOfWeek,
+    uint8_t leapSeconds,
+    uint16_t hdop,
+    uint16_t vdop,
+    uint16_t pdop,
+    uint8_t satsInViewCount,
+    uint8_t satsTrackingCount,
+    uint8_t satsUsedCount,
+    void* contextPtr
+)
+{
+    const le_gnss_SnapshotBitMask_t requiredMask = LE_GNSS_SNAPSHOT_LATITUDE |
+                                                   LE_GNSS_SNAPSHOT_LONGITUDE |
+                                                   LE_GNSS_SNAPSHOT_EPOCH_TIME;
+
+    if ((validMask & requiredMask) != requiredMask)
+    {
+        return;
+    }
+
+    track_Fix_t fix =
+    {
+        .time = epochTime,
+        .latitude = latitude,
+        .longitude = longitude,
+        .altitude = altitude,
+        .hasAltitude = ((validMask & LE_GNSS_SNAPSHOT_ALTITUDE) != 0)
+    };
+
+    track_Record(&fix);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush timer handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    track_Flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function to release the recording requests of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseSessionEventHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    if (!sessionRef)
+    {
+        LE_ERROR("ERROR sessionRef is NULL");
+        return;
+    }
+
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(RecordingRefMap);
+    le_result_t result = le_ref_NextNode(iterRef);
+    while (result == LE_OK)
+    {
+        Recording_t* recordingPtr = (Recording_t*)le_ref_GetValue(iterRef);
+
+        // Get the next node first, as the current one is deleted.
+        result = le_ref_NextNode(iterRef);
+
+        if (recordingPtr->sessionRef == sessionRef)
+        {
+            LE_DEBUG("Release le_posTrack_Stop %p, Session %p", recordingPtr->ref, sessionRef);
+            le_posTrack_Stop(recordingPtr->ref);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Internal interface functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to initialize the positioning track
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Init
+(
+    void
+)
+{
+    IsTrackAvailable = (LE_OK == track_Init(POSTRACK_PATH));
+    if (!IsTrackAvailable)
+    {
+        LE_CRIT("Track can't be recorded in %s", POSTRACK_PATH);
+    }
+
+    RecordingPoolRef = le_mem_CreatePool("PosTrackRecordingPoolRef", sizeof(Recording_t));
+    RecordingRefMap = le_ref_CreateMap("PosTrackRecordingMap", POSTRACK_RECORDING_MAX);
+
+    FlushTimerRef = le_timer_Create("PosTrackFlushTimer");
+    le_timer_SetMsInterval(FlushTimerRef, POSTRACK_FLUSH_INTERVAL);
+    le_timer_SetRepeat(FlushTimerRef, 0);
+    le_timer_SetHandler(FlushTimerRef, FlushTimerHandler);
+
+    le_msg_AddServiceCloseHandler(le_posTrack_GetServiceRef(), CloseSessionEventHandler, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function writes the recorded fixes not written yet to the track, e.g. before exiting.
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Flush
+(
+    void
+)
+{
+    if (IsTrackAvailable)
+    {
+        track_Flush();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// APIs.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Request that the fixes be recorded.
+ *
+ * @return
+ *      - Reference to the recording request (to be used later for releasing the request).
+ *      - NULL if the track can't be recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_posTrack_RecordingRef_t le_posTrack_Start
+(
+    void
+)
+{
+    if (!IsTrackAvailable)
+    {
+        return NULL;
+    }
+
+    if (0 == NumOfRecordings)
+    {
+        SnapshotHandlerRef = le_gnss_AddPositionSnapshotHandler(PositionSnapshotHandler, NULL);
+        if (NULL == SnapshotHandlerRef)
+        {
+            LE_ERROR("Failed to add GNSS position snapshot handler!");
+            return NULL;
+        }
+        le_timer_Start(FlushTimerRef);
+    }
+    NumOfRecordings++;
+
+    Recording_t* recordingPtr = le_mem_ForceAlloc(RecordingPoolRef);
+    recordingPtr->sessionRef = le_posTrack_GetClientSessionRef();
+    recordingPtr->ref = le_ref_CreateRef(RecordingRefMap, recordingPtr);
+
+    return recordingPtr->ref;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a recording request.
+ *
+ * @note If the caller is passing an invalid reference into this function,
+ *       it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_posTrack_Stop
+(
+    le_posTrack_RecordingRef_t ref      ///< [IN] Reference to a recording request.
+)
+{
+    Recording_t* recordingPtr = le_ref_Lookup(RecordingRefMap, ref);
+
+    if (NULL == recordingPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", ref);
+        return;
+    }
+
+    le_ref_DeleteRef(RecordingRefMap, ref);
+    le_mem_Release(recordingPtr);
+
+    NumOfRecordings--;
+    if (0 == NumOfRecordings)
+    {
+        le_gnss_RemovePositionSnapshotHandler(SnapshotHandlerRef);
+        SnapshotHandlerRef = NULL;
+        le_timer_Stop(FlushTimerRef);
+        track_Flush();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time range of the recorded fixes.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if no fix has been recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_posTrack_GetRange
+(
+    uint64_t* startTimePtr,     ///< [OUT] Time of the first fix, in milliseconds since
+                                ///<       Jan. 1, 1970.
+    uint64_t* endTimePtr        ///< [OUT] Time of the last fix, in milliseconds since
+                                ///<       Jan. 1, 1970.
+)
+{
+    if ((NULL == startTimePtr) || (NULL == endTimePtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    if (!IsTrackAvailable)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return track_GetRange(startTimePtr, endTimePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the recorded fixes of a time range to a file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_BAD_PARAMETER if the file is not a regular file.
+ *      - LE_FAULT if the file can't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_posTrack_Export
+(
+    uint64_t startTime,         ///< [IN] Time of the first fix to export, in milliseconds since
+                                ///<      Jan. 1, 1970.
+    uint64_t endTime,           ///< [IN] Time of the last fix to export, in milliseconds since
+                                ///<      Jan. 1, 1970.
+    int fd,                     ///< [IN] Regular file, opened for writing.
+    uint32_t* countPtr          ///< [OUT] Number of fixes written.
+)
+{
+    struct stat fileStat;
+    le_result_t result;
+
+    if (NULL == countPtr)
+    {
+        LE_KILL_CLIENT("countPtr is NULL !");
+        return LE_FAULT;
+    }
+    *countPtr = 0;
+
+    // The file is written synchronously, so it must not be a pipe or a socket, which could block
+    // the positioning service.
+    if ((fd < 0) || (fstat(fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+    {
+        LE_ERROR("Bad file descriptor %d", fd);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return LE_BAD_PARAMETER;
+    }
+
+    if (IsTrackAvailable)
+    {
+        result = track_Export(startTime, endTime, fd, countPtr);
+    }
+    else
+    {
+        result = LE_FAULT;
+    }
+
+    close(fd);
+
+    return result;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file le_posTrack_local.h
+ *
+ * Local Positioning Track Definitions
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_POSTRACK_LOCAL_INCLUDE_GUARD
+#define LEGATO_POSTRACK_LOCAL_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to initialize the positioning track
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function writes the recorded fixes not written yet to the track, e.g. before exiting.
+ */
+//--------------------------------------------------------------------------------------------------
+void posTrack_Flush
+(
+    void
+);
+
+#endif // LEGATO_POSTRACK_LOCAL_INCLUDE_GUARD
@@ -0,0 +1,985 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file track.c
+ *
+ * This file contains the source code of the track recorder of the positioning daemon.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "track.h"
+
+#include <dirent.h>
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+#define MAX_PATH_BYTES          256
+
+#define HEADER_BYTES            8
+#define FORMAT_VERSION          1
+
+/// Largest record: flags, time (10 bytes), latitude, longitude and altitude (5 bytes each).
+#define MAX_RECORD_BYTES        (1 + 10 + (3 * 5))
+
+/// Segment file name: sequence number and extension.
+#define SEGMENT_NAME_FORMAT     "%08" PRIu32 ".trk"
+#define SEGMENT_NAME_LENGTH     12
+
+/// Segment path: directory, '/', and name (the sequence number may take up to 10 digits).
+#define SEGMENT_PATH_BYTES      (MAX_PATH_BYTES + 16)
+
+//--------------------------------------------------------------------------------------------------
+// Data structures.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record encoder.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t     buffer[TRACK_BUFFER_BYTES];     ///< Records not written yet.
+    size_t      used;                           ///< Number of bytes in buffer.
+    track_Fix_t last;                           ///< Values of the last record (the altitude is the
+                                                ///< last one recorded).
+    uint32_t    sinceKeyframe;                  ///< Number of records since the last keyframe.
+    bool        needHeader;                     ///< true if the file header is to be written.
+    uint8_t     headerFlags;                    ///< Flags of the next file header
+                                                ///< (TRACK_HEADER_*).
+}
+Encoder_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Context of track_Export().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    Encoder_t*  encoderPtr;     ///< Encoder of the exported file.
+    int         fd;             ///< Exported file.
+    uint64_t    startTime;      ///< Time range to export.
+    uint64_t    endTime;
+    uint32_t    count;          ///< Number of fixes written.
+    bool        isFailed;       ///< true if the file couldn't be written.
+}
+ExportCtx_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Track directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static char DirPath[MAX_PATH_BYTES];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sequence numbers of the oldest segment, and of the current one (which is only created when
+ * the first fixes are written to it).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FirstSeq;
+static uint32_t CurrentSeq;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Current segment file (-1 if not open yet), and its size.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SegmentFd = -1;
+static size_t SegmentBytes;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encoder of the recorded fixes.
+ */
+//--------------------------------------------------------------------------------------------------
+static Encoder_t Recorder;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append an unsigned LEB128 varint to a buffer.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t PutVarint
+(
+    uint8_t* bufferPtr,
+    uint64_t value
+)
+{
+    size_t i = 0;
+
+    while (value >= 0x80)
+    {
+        bufferPtr[i++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bufferPtr[i++] = (uint8_t)value;
+
+    return i;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a signed value as a zigzag-encoded LEB128 varint to a buffer.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t PutSignedVarint
+(
+    uint8_t* bufferPtr,
+    int64_t value
+)
+{
+    return PutVarint(bufferPtr, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read an unsigned LEB128 varint from a buffer.
+ *
+ * @return The number of bytes read, 0 if the buffer ends before the varint, or -1 if it is too
+ *         long.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t GetVarint
+(
+    const uint8_t* bufferPtr,
+    size_t size,
+    uint64_t* valuePtr
+)
+{
+    uint64_t value = 0;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (i == 10)
+        {
+            return -1;
+        }
+
+        value |= (uint64_t)(bufferPtr[i] & 0x7F) << (7 * i);
+        if ((bufferPtr[i] & 0x80) == 0)
+        {
+            *valuePtr = value;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a zigzag-encoded LEB128 varint from a buffer.
+ *
+ * @return See GetVarint().
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t GetSignedVarint
+(
+    const uint8_t* bufferPtr,
+    size_t size,
+    int64_t* valuePtr
+)
+{
+    uint64_t value = 0;
+    ssize_t length = GetVarint(bufferPtr, size, &value);
+
+    *valuePtr = (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+
+    return length;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a whole buffer to a file.
+ *
+ * @return LE_OK on success, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteAll
+(
+    int fd,
+    const uint8_t* bufferPtr,
+    size_t size
+)
+{
+    while (size > 0)
+    {
+        ssize_t count = write(fd, bufferPtr, size);
+
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            LE_ERROR("Can't write track (%m)");
+            return LE_FAULT;
+        }
+
+        bufferPtr += count;
+        size -= count;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the file header to a buffer.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t PutHeader
+(
+    uint8_t* bufferPtr,
+    uint8_t flags
+)
+{
+    memcpy(bufferPtr, "LTRK", 4);
+    bufferPtr[4] = FORMAT_VERSION;
+    bufferPtr[5] = flags;
+    memset(bufferPtr + 6, 0, HEADER_BYTES - 6);
+
+    return HEADER_BYTES;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset an encoder, to start a new file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetEncoder
+(
+    Encoder_t* encoderPtr
+)
+{
+    encoderPtr->used = 0;
+    encoderPtr->needHeader = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record to the buffer of an encoder.
+ *
+ * @return false if the buffer is too full, true otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool Encode
+(
+    Encoder_t* encoderPtr,
+    const track_Fix_t* fixPtr
+)
+{
+    uint8_t* bufferPtr = encoderPtr->buffer + encoderPtr->used;
+    track_Fix_t* lastPtr = &encoderPtr->last;
+    size_t size = 0;
+    uint8_t flags = 0;
+
+    if (encoderPtr->used + HEADER_BYTES + MAX_RECORD_BYTES > sizeof(encoderPtr->buffer))
+    {
+        return false;
+    }
+
+    if (encoderPtr->needHeader)
+    {
+        size = PutHeader(bufferPtr, encoderPtr->headerFlags);
+        encoderPtr->needHeader = false;
+        encoderPtr->headerFlags = 0;
+        // Force a keyframe.
+        encoderPtr->sinceKeyframe = TRACK_KEYFRAME_INTERVAL;
+    }
+
+    if ((encoderPtr->sinceKeyframe >= TRACK_KEYFRAME_INTERVAL) || (fixPtr->time < lastPtr->time))
+    {
+        flags |= TRACK_FLAG_KEYFRAME;
+        memset(lastPtr, 0, sizeof(*lastPtr));
+        encoderPtr->sinceKeyframe = 0;
+    }
+    if (fixPtr->hasAltitude)
+    {
+        flags |= TRACK_FLAG_ALTITUDE;
+    }
+
+    bufferPtr[size++] = flags;
+    size += PutVarint(bufferPtr + size, fixPtr->time - lastPtr->time);
+    size += PutSignedVarint(bufferPtr + size,
+                            (int64_t)fixPtr->latitude - (int64_t)lastPtr->latitude);
+    size += PutSignedVarint(bufferPtr + size,
+                            (int64_t)fixPtr->longitude - (int64_t)lastPtr->longitude);
+    if (fixPtr->hasAltitude)
+    {
+        size += PutSignedVarint(bufferPtr + size,
+                                (int64_t)fixPtr->altitude - (int64_t)lastPtr->altitude);
+        lastPtr->altitude = fixPtr->altitude;
+    }
+
+    lastPtr->time = fixPtr->time;
+    lastPtr->latitude = fixPtr->latitude;
+    lastPtr->longitude = fixPtr->longitude;
+    encoderPtr->sinceKeyframe++;
+    encoderPtr->used += size;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a record.
+ *
+ * @return The number of bytes read, 0 if the buffer ends before the record, or -1 if the record is
+ *         invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t Decode
+(
+    const uint8_t* bufferPtr,
+    size_t size,
+    track_Fix_t* lastPtr            ///< [IN/OUT] Values of the previous record, then of this one.
+)
+{
+    track_Fix_t fix;
+    uint64_t time;
+    int64_t delta[3] = { 0, 0, 0 };
+    ssize_t length;
+    size_t i, count;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    uint8_t flags = bufferPtr[0];
+    if ((flags & ~(TRACK_FLAG_KEYFRAME | TRACK_FLAG_ALTITUDE)) != 0)
+    {
+        return -1;
+    }
+
+    size_t offset = 1;
+    length = GetVarint(bufferPtr + offset, size - offset, &time);
+    if (length <= 0)
+    {
+        return length;
+    }
+    offset += length;
+
+    count = (flags & TRACK_FLAG_ALTITUDE) ? 3 : 2;
+    for (i = 0; i < count; i++)
+    {
+        length = GetSignedVarint(bufferPtr + offset, size - offset, &delta[i]);
+        if (length <= 0)
+        {
+            return length;
+        }
+        offset += length;
+    }
+
+    fix = *lastPtr;
+    if (flags & TRACK_FLAG_KEYFRAME)
+    {
+        memset(&fix, 0, sizeof(fix));
+    }
+    fix.time += time;
+    fix.latitude = (int32_t)(fix.latitude + delta[0]);
+    fix.longitude = (int32_t)(fix.longitude + delta[1]);
+    fix.altitude = (int32_t)(fix.altitude + delta[2]);
+    fix.hasAltitude = ((flags & TRACK_FLAG_ALTITUDE) != 0);
+
+    *lastPtr = fix;
+
+    return offset;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the fixes of a file in the segment format, from its current offset.
+ *
+ * @return See track_Read().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadFile
+(
+    int fd,
+    track_FixFunc_t fixFunc,
+    void* contextPtr,
+    bool isFirstOnly,               ///< [IN] true to stop after the first fix.
+    uint8_t* headerFlagsPtr         ///< [OUT] Flags of the header (NULL if not needed).
+)
+{
+    uint8_t buffer[TRACK_BUFFER_BYTES];
+    track_Fix_t last;
+    size_t size = 0;
+    bool isHeaderRead = false;
+
+    memset(&last, 0, sizeof(last));
+
+    for (;;)
+    {
+        ssize_t count = read(fd, buffer + size, sizeof(buffer) - size);
+
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            LE_ERROR("Can't read track (%m)");
+            return LE_FAULT;
+        }
+        if (count == 0)
+        {
+            // Bytes left at the end of the file are an incomplete record.
+            return ((size == 0) && isHeaderRead) ? LE_OK : LE_FORMAT_ERROR;
+        }
+        size += count;
+
+        size_t offset = 0;
+        if (!isHeaderRead)
+        {
+            if (size < HEADER_BYTES)
+            {
+                continue;
+            }
+            if ((memcmp(buffer, "LTRK", 4) != 0) || (buffer[4] != FORMAT_VERSION))
+            {
+                return LE_FORMAT_ERROR;
+            }
+            if (NULL != headerFlagsPtr)
+            {
+                *headerFlagsPtr = buffer[5];
+            }
+            offset = HEADER_BYTES;
+            isHeaderRead = true;
+        }
+
+        for (;;)
+        {
+            ssize_t length = Decode(buffer + offset, size - offset, &last);
+
+            if (length < 0)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            if (length == 0)
+            {
+                break;
+            }
+            offset += length;
+
+            fixFunc(&last, contextPtr);
+            if (isFirstOnly)
+            {
+                return LE_OK;
+            }
+        }
+
+        // Keep the incomplete record for the next read.
+        memmove(buffer, buffer + offset, size - offset);
+        size -= offset;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of a segment.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetSegmentPath
+(
+    uint32_t seq,
+    char* pathPtr,
+    size_t pathSize
+)
+{
+    snprintf(pathPtr, pathSize, "%s/" SEGMENT_NAME_FORMAT, DirPath, seq);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the fixes of a segment.
+ *
+ * @return
+ *      - LE_OK on success (including when the segment is truncated).
+ *      - LE_NOT_FOUND if the segment doesn't exist.
+ *      - LE_FAULT if it can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadSegment
+(
+    uint32_t seq,
+    track_FixFunc_t fixFunc,
+    void* contextPtr,
+    bool isFirstOnly,
+    uint8_t* headerFlagsPtr
+)
+{
+    char path[SEGMENT_PATH_BYTES];
+
+    GetSegmentPath(seq, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return (ENOENT == errno) ? LE_NOT_FOUND : LE_FAULT;
+    }
+
+    le_result_t result = ReadFile(fd, fixFunc, contextPtr, isFirstOnly, headerFlagsPtr);
+    close(fd);
+
+    if (LE_FORMAT_ERROR == result)
+    {
+        LE_WARN("Segment %s is truncated or invalid", path);
+        result = LE_OK;
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fix function saving the time of the fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SaveTime
+(
+    const track_Fix_t* fixPtr,
+    void* contextPtr
+)
+{
+    *(uint64_t*)contextPtr = fixPtr->time;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time of the first fix of a segment, and the flags of its header.
+ *
+ * @return true if the segment has a fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetSegmentStart
+(
+    uint32_t seq,
+    uint64_t* timePtr,
+    uint8_t* headerFlagsPtr
+)
+{
+    *timePtr = UINT64_MAX;
+    *headerFlagsPtr = 0;
+
+    return (LE_OK == ReadSegment(seq, SaveTime, timePtr, true, headerFlagsPtr)) &&
+           (*timePtr != UINT64_MAX);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the oldest segments, to keep at most TRACK_MAX_SEGMENTS (including the current one).
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteOldSegments
+(
+    void
+)
+{
+    char path[SEGMENT_PATH_BYTES];
+
+    while (CurrentSeq - FirstSeq >= TRACK_MAX_SEGMENTS)
+    {
+        GetSegmentPath(FirstSeq, path, sizeof(path));
+        LE_DEBUG("Delete segment %s", path);
+        if ((unlink(path) != 0) && (errno != ENOENT))
+        {
+            LE_WARN("Can't delete %s (%m)", path);
+        }
+        FirstSeq++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the current segment and start a new one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NextSegment
+(
+    void
+)
+{
+    if (SegmentFd >= 0)
+    {
+        close(SegmentFd);
+        SegmentFd = -1;
+        CurrentSeq++;
+        DeleteOldSegments();
+    }
+
+    ResetEncoder(&Recorder);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Export fix function: write the fix if it is in the time range.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExportFix
+(
+    const track_Fix_t* fixPtr,
+    void* contextPtr
+)
+{
+    ExportCtx_t* ctxPtr = contextPtr;
+    Encoder_t* encoderPtr = ctxPtr->encoderPtr;
+
+    if (ctxPtr->isFailed || (fixPtr->time < ctxPtr->startTime) || (fixPtr->time > ctxPtr->endTime))
+    {
+        return;
+    }
+
+    if (!Encode(encoderPtr, fixPtr))
+    {
+        if (LE_OK != WriteAll(ctxPtr->fd, encoderPtr->buffer, encoderPtr->used))
+        {
+            ctxPtr->isFailed = true;
+            return;
+        }
+        encoderPtr->used = 0;
+        LE_ASSERT(Encode(encoderPtr, fixPtr));
+    }
+
+    ctxPtr->count++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Internal interface functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the track recorder. The fixes are recorded in a new segment.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the track directory can't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Init
+(
+    const char* dirPathPtr          ///< [IN] Track directory.
+)
+{
+    bool hasSegment = false;
+    uint32_t minSeq = 0;
+    uint32_t maxSeq = 0;
+
+    if (LE_OK != le_utf8_Copy(DirPath, dirPathPtr, sizeof(DirPath), NULL))
+    {
+        LE_ERROR("Track directory path is too long");
+        return LE_FAULT;
+    }
+
+    if (LE_OK != le_dir_MakePath(DirPath, S_IRWXU))
+    {
+        LE_ERROR("Can't create %s", DirPath);
+        return LE_FAULT;
+    }
+
+    DIR* dirPtr = opendir(DirPath);
+    if (NULL == dirPtr)
+    {
+        LE_ERROR("Can't open %s (%m)", DirPath);
+        return LE_FAULT;
+    }
+
+    struct dirent* entryPtr;
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        uint32_t seq;
+        char extension[5];
+
+        if ((strlen(entryPtr->d_name) == SEGMENT_NAME_LENGTH) &&
+            (sscanf(entryPtr->d_name, "%8" SCNu32 ".%4s", &seq, extension) == 2) &&
+            (strcmp(extension, "trk") == 0))
+        {
+            minSeq = (!hasSegment || (seq < minSeq)) ? seq : minSeq;
+            maxSeq = (!hasSegment || (seq > maxSeq)) ? seq : maxSeq;
+            hasSegment = true;
+        }
+    }
+    closedir(dirPtr);
+
+    // The last segment may be truncated, so it isn't appended to.
+    FirstSeq = minSeq;
+    CurrentSeq = hasSegment ? (maxSeq + 1) : 0;
+    SegmentFd = -1;
+    SegmentBytes = 0;
+    ResetEncoder(&Recorder);
+    // The clock may have been set back since the last fix of the previous run.
+    Recorder.headerFlags = hasSegment ? TRACK_HEADER_CLOCK_STEP : 0;
+    DeleteOldSegments();
+
+    LE_DEBUG("Track segments %" PRIu32 " to %" PRIu32 " in %s", FirstSeq, CurrentSeq, DirPath);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a fix.
+ */
+//--------------------------------------------------------------------------------------------------
+void track_Record
+(
+    const track_Fix_t* fixPtr       ///< [IN] The fix.
+)
+{
+    if (fixPtr->time < Recorder.last.time)
+    {
+        // The clock was set back: keep the fixes of a segment in time order.
+        if (!Recorder.needHeader)
+        {
+            track_Flush();
+            NextSegment();
+        }
+        Recorder.headerFlags = TRACK_HEADER_CLOCK_STEP;
+    }
+
+    if (!Encode(&Recorder, fixPtr))
+    {
+        track_Flush();
+        LE_ASSERT(Encode(&Recorder, fixPtr));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buffered fixes to the current segment.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the segment can't be written (the fixes are dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Flush
+(
+    void
+)
+{
+    char path[SEGMENT_PATH_BYTES];
+
+    if (Recorder.used == 0)
+    {
+        return LE_OK;
+    }
+
+    if (SegmentFd < 0)
+    {
+        GetSegmentPath(CurrentSeq, path, sizeof(path));
+        SegmentFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (SegmentFd < 0)
+        {
+            LE_ERROR("Can't create %s (%m)", path);
+            ResetEncoder(&Recorder);
+            // The dropped fixes may have been later than the next ones.
+            Recorder.headerFlags = TRACK_HEADER_CLOCK_STEP;
+            return LE_FAULT;
+        }
+        SegmentBytes = 0;
+    }
+
+    if (LE_OK != WriteAll(SegmentFd, Recorder.buffer, Recorder.used))
+    {
+        // The segment may end with part of the buffer, so the next fixes go to a new one.
+        NextSegment();
+        Recorder.headerFlags = TRACK_HEADER_CLOCK_STEP;
+        return LE_FAULT;
+    }
+
+    SegmentBytes += Recorder.used;
+    Recorder.used = 0;
+
+    if (SegmentBytes >= TRACK_SEGMENT_MAX_BYTES)
+    {
+        NextSegment();
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time range of the recorded fixes (flushing them first).
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if there is no fix.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_GetRange
+(
+    uint64_t* startTimePtr,         ///< [OUT] Time of the earliest fix.
+    uint64_t* endTimePtr            ///< [OUT] Time of the latest fix.
+)
+{
+    uint64_t segmentStart;
+    uint64_t nextSegmentStart;
+    uint8_t nextHeaderFlags;
+    bool hasSegmentStart;
+    bool hasFix = false;
+    uint32_t seq;
+
+    track_Flush();
+
+    *startTimePtr = UINT64_MAX;
+    *endTimePtr = 0;
+
+    // The fixes of a segment are in time order, and a segment without TRACK_HEADER_CLOCK_STEP
+    // doesn't start before the previous one ends. So the latest fix is the last one of a segment
+    // that isn't followed by such a segment.
+    hasSegmentStart = GetSegmentStart(FirstSeq, &segmentStart, &nextHeaderFlags);
+    for (seq = FirstSeq; seq <= CurrentSeq; seq++)
+    {
+        bool hasNextSegmentStart = (seq < CurrentSeq) &&
+                                   GetSegmentStart(seq + 1, &nextSegmentStart, &nextHeaderFlags);
+
+        if (hasSegmentStart)
+        {
+            hasFix = true;
+            if (segmentStart < *startTimePtr)
+            {
+                *startTimePtr = segmentStart;
+            }
+
+            if (!hasNextSegmentStart || (nextHeaderFlags & TRACK_HEADER_CLOCK_STEP))
+            {
+                uint64_t segmentEnd = segmentStart;
+
+                ReadSegment(seq, SaveTime, &segmentEnd, false, NULL);
+                if (segmentEnd > *endTimePtr)
+                {
+                    *endTimePtr = segmentEnd;
+                }
+            }
+        }
+
+        hasSegmentStart = hasNextSegmentStart;
+        segmentStart = nextSegmentStart;
+    }
+
+    return hasFix ? LE_OK : LE_NOT_FOUND;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the recorded fixes of a time range to a file, in the segment format (flushing them
+ * first).
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the file can't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Export
+(
+    uint64_t startTime,             ///< [IN] Time of the first fix to export.
+    uint64_t endTime,               ///< [IN] Time of the last fix to export.
+    int fd,                         ///< [IN] File to write to.
+    uint32_t* countPtr              ///< [OUT] Number of fixes written.
+)
+{
+    static Encoder_t encoder;
+    ExportCtx_t ctx =
+    {
+        .encoderPtr = &encoder,
+        .fd = fd,
+        .startTime = startTime,
+        .endTime = endTime,
+        .count = 0,
+        .isFailed = false
+    };
+    uint64_t segmentStart;
+    uint64_t nextSegmentStart;
+    uint8_t nextHeaderFlags;
+    bool hasSegmentStart;
+    uint32_t seq;
+
+    track_Flush();
+    ResetEncoder(&encoder);
+
+    // The fixes of a segment are in time order, so a segment is skipped if it starts after the
+    // range. It is also skipped if the next one starts before the range, unless the clock was set
+    // back in between (TRACK_HEADER_CLOCK_STEP).
+    hasSegmentStart = GetSegmentStart(FirstSeq, &segmentStart, &nextHeaderFlags);
+    for (seq = FirstSeq; (seq <= CurrentSeq) && !ctx.isFailed; seq++)
+    {
+        bool hasNextSegmentStart = (seq < CurrentSeq) &&
+                                   GetSegmentStart(seq + 1, &nextSegmentStart, &nextHeaderFlags);
+
+        if (hasSegmentStart && (segmentStart <= endTime) &&
+            (!hasNextSegmentStart || (nextHeaderFlags & TRACK_HEADER_CLOCK_STEP) ||
+             (nextSegmentStart >= startTime)))
+        {
+            if (LE_FAULT == ReadSegment(seq, ExportFix, &ctx, false, NULL))
+            {
+                LE_WARN("Segment %" PRIu32 " can't be read", seq);
+            }
+        }
+
+        hasSegmentStart = hasNextSegmentStart;
+        segmentStart = nextSegmentStart;
+    }
+
+    if (!ctx.isFailed)
+    {
+        if (encoder.needHeader)
+        {
+            // No fix: write the header only.
+            encoder.used = PutHeader(encoder.buffer, 0);
+        }
+        if (LE_OK != WriteAll(fd, encoder.buffer, encoder.used))
+        {
+            ctx.isFailed = true;
+        }
+    }
+
+    *countPtr = ctx.count;
+
+    return ctx.isFailed ? LE_FAULT : LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the fixes of a file in the segment format, from its current offset.
+ *
+ * @return
+ *      - LE_OK if the whole file was read.
+ *      - LE_FORMAT_ERROR if it is not in the segment format, or it ends with an incomplete record.
+ *        The fixes up to the error have been read.
+ *      - LE_FAULT if it can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Read
+(
+    int fd,                         ///< [IN] The file.
+    track_FixFunc_t fixFunc,        ///< [IN] Function called for each fix.
+    void* contextPtr                ///< [IN] Context given to fixFunc.
+)
+{
+    return ReadFile(fd, fixFunc, contextPtr, false, NULL);
+}
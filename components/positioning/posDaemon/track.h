@@ -0,0 +1,202 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file track.h
+ *
+ * Track recorder of the positioning daemon.
+ *
+ * Fixes are appended to a fixed-size buffer, which is written to the current segment file of the
+ * track directory when it is full or when track_Flush() is called, so the flash is written in
+ * blocks rather than once per fix. A segment is closed when it reaches TRACK_SEGMENT_MAX_BYTES,
+ * and the oldest segments are deleted to keep at most TRACK_MAX_SEGMENTS.
+ *
+ * Segment format (also used by track_Export()):
+ *  - an 8 byte header: "LTRK", the format version (1), a flags byte (TRACK_HEADER_*, always 0 in
+ *    an exported file) and 2 reserved bytes (0),
+ *  - one record per fix: a flags byte (TRACK_FLAG_*), then the differences with the previous
+ *    record of the time (milliseconds since Jan. 1, 1970, as an unsigned LEB128 varint), of the
+ *    latitude and longitude (1e-6 degree), and, if TRACK_FLAG_ALTITUDE is set, of the altitude
+ *    (1e-3 meter) with the last record having one (as zigzag-encoded LEB128 varints).
+ *
+ * A keyframe record (TRACK_FLAG_KEYFRAME) is decoded from zero values instead of the previous
+ * record, so it holds the absolute values. Each segment starts with a keyframe, and there is one
+ * at least every TRACK_KEYFRAME_INTERVAL records, and whenever the time goes backwards.
+ *
+ * The fixes of a segment are in time order: when the time of a fix goes backwards (the clock was
+ * set back), it starts a new segment, flagged with TRACK_HEADER_CLOCK_STEP. So the first fix of a
+ * segment without that flag is not earlier than any fix of the segments before it, which lets
+ * track_Export() and track_GetRange() skip whole segments.
+ *
+ * A segment truncated by a power failure is read up to its last whole record.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_TRACK_INCLUDE_GUARD
+#define LEGATO_TRACK_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the record buffer, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_BUFFER_BYTES          4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size from which a segment is closed, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_SEGMENT_MAX_BYTES     (1024 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of segments kept.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_MAX_SEGMENTS          32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of records between two keyframes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_KEYFRAME_INTERVAL     600
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_FLAG_KEYFRAME         0x01    ///< The record holds absolute values.
+#define TRACK_FLAG_ALTITUDE         0x02    ///< The record has an altitude.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Segment header flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_HEADER_CLOCK_STEP     0x01    ///< The segment may start earlier than the previous
+                                            ///< ones end (the clock was set back, or the daemon
+                                            ///< restarted).
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fix.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    time;           ///< Milliseconds since Jan. 1, 1970.
+    int32_t     latitude;       ///< Latitude [resolution 1e-6].
+    int32_t     longitude;      ///< Longitude [resolution 1e-6].
+    int32_t     altitude;       ///< Altitude in meters [resolution 1e-3], if hasAltitude.
+    bool        hasAltitude;    ///< true if the altitude is known.
+}
+track_Fix_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called for each fix read from a track.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*track_FixFunc_t)
+(
+    const track_Fix_t* fixPtr,      ///< [IN] The fix.
+    void* contextPtr                ///< [IN] The context given to track_Read().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the track recorder. The fixes are recorded in a new segment.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the track directory can't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Init
+(
+    const char* dirPathPtr          ///< [IN] Track directory.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a fix.
+ */
+//--------------------------------------------------------------------------------------------------
+void track_Record
+(
+    const track_Fix_t* fixPtr       ///< [IN] The fix.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buffered fixes to the current segment.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the segment can't be written (the fixes are dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Flush
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time range of the recorded fixes (flushing them first): the times of the earliest and
+ * latest fixes, which are not the first and last ones recorded if the clock was set back.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if there is no fix.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_GetRange
+(
+    uint64_t* startTimePtr,         ///< [OUT] Time of the first fix.
+    uint64_t* endTimePtr            ///< [OUT] Time of the last fix.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the recorded fixes of a time range to a file, in the segment format (flushing them
+ * first). The fixes are written in the order they were recorded, which is not the time order if
+ * the clock was set back.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the file can't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Export
+(
+    uint64_t startTime,             ///< [IN] Time of the first fix to export.
+    uint64_t endTime,               ///< [IN] Time of the last fix to export.
+    int fd,                         ///< [IN] File to write to.
+    uint32_t* countPtr              ///< [OUT] Number of fixes written.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the fixes of a file in the segment format, from its current offset.
+ *
+ * @return
+ *      - LE_OK if the whole file was read.
+ *      - LE_FORMAT_ERROR if it is not in the segment format, or it ends with an incomplete record.
+ *        The fixes up to the error have been read.
+ *      - LE_FAULT if it can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Read
+(
+    int fd,                         ///< [IN] The file.
+    track_FixFunc_t fixFunc,        ///< [IN] Function called for each fix.
+    void* contextPtr                ///< [IN] Context given to fixFunc.
+);
+
+#endif // LEGATO_TRACK_INCLUDE_GUARD
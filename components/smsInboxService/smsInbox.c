@@ -5,15 +5,21 @@
  * When the service is activated, or when a SMS is received, the SMS is copied from the SIM to a
  * specific folder (SMSINBOX_PATH/MSG_PATH).
  *
- * Each SMS is copied into a dedicated file (named with a unique message identifier). The data
- * are stored using the Jannsson representation: Each data (imsi, SMS format, message length,
- * text/pdu, sender telephone number, timestamp, read/unread) are recorded with a key to retrieve
- * each value.
- *
- * Each application using the SMS Inbox Server possesses a configuration file in
- * SMSINBOX_PATH/CONF_PATH directory (also encoding using Jansson format): this file is used to
- * store the message identifier contained in the application mailbox. It is updated each time is new
- * SMS is received.
+ * Each SMS is copied into a dedicated binary file (named with a unique message identifier): a
+ * fixed-size header (imsi, SMS format, message length, sender telephone number, timestamp) followed
+ * by the payload (text, binary or pdu). A message file is written once, to a temporary file which
+ * is then renamed, so it is either complete or absent.
+ *
+ * Each application using the SMS Inbox Server possesses an index file in SMSINBOX_PATH/CONF_PATH:
+ * a fixed array of slots, each holding the identifier of a message of the application mailbox and
+ * its read/unread status. The index is memory-mapped and updated in place: a slot's identifier is
+ * written last when a message is added (and first when it is removed), then the index is synced,
+ * so a slot is always either free or refers to a whole message. A hashmap of the slots by message
+ * identifier is kept in memory, so looking up a message or marking it as read does not read any
+ * file.
+ *
+ * Earlier versions stored the messages and the mailboxes as Jansson (JSON) files. Those are
+ * converted when a mailbox is first used, then deleted.
  *
  *  Copyright (C) Sierra Wireless Inc.
  */
@@ -24,10 +30,10 @@
 #include "mdmCfgEntries.h"
 #include "le_smsInbox.h"
 
-#include "le_print.h"
 #include "le_hex.h"
 
 #include <dirent.h>
+#include <sys/mman.h>
 #include "jansson.h"
 
 //--------------------------------------------------------------------------------------------------
@@ -49,14 +55,24 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * File extension definition.
+ * File extension definitions.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_FILE_EXTENSION      ".msg"
+#define INDEX_FILE_EXTENSION    ".idx"
+#define TMP_FILE_EXTENSION      ".tmp"
+#define LEGACY_FILE_EXTENSION   ".json"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a file path (bytes, including the null terminator).
  */
 //--------------------------------------------------------------------------------------------------
-#define FILE_EXTENSION ".json"
+#define MAX_PATH_BYTES 256
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Json keys.
+ * Json keys (of the legacy files).
  */
 //--------------------------------------------------------------------------------------------------
 #define JSON_FORMAT "format"
@@ -71,6 +87,38 @@
 #define JSON_ISDELETED "isDeleted"
 #define JSON_MSGINBOX "msgInBox"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic numbers ("SMSM" and "SMSI") and format version of the message and index files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_FILE_MAGIC      0x4d534d53U
+#define INDEX_FILE_MAGIC    0x49534d53U
+#define FILE_VERSION        1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Optional fields of a message file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_HAS_SENDERTEL   0x01
+#define MSG_HAS_TIMESTAMP   0x02
+#define MSG_HAS_PAYLOAD     0x04
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a message payload (bytes).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_MAX_PAYLOAD_BYTES   LE_SMS_PDU_MAX_BYTES
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index slot flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SLOT_UNREAD         0x01
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of user applications.
@@ -133,46 +181,80 @@ typedef uint32_t MessageId_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Browsing structure.
+ * Message file header. The payload follows it.
  *
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    json_t* jsonObjPtr;
-    json_t* jsonArrayPtr;
-    uint32_t currentMessageIndex;
-    uint32_t maxIndex;
+    uint32_t magic;                                     ///< MSG_FILE_MAGIC
+    uint8_t  version;                                   ///< FILE_VERSION
+    uint8_t  format;                                    ///< SMS format (le_sms_Format_t)
+    uint8_t  fields;                                    ///< Optional fields present (MSG_HAS_xxx)
+    uint8_t  reserved;
+    uint32_t msgLen;                                    ///< Message length
+    uint32_t payloadLen;                                ///< Payload length (bytes)
+    char     imsi[LE_SIM_IMSI_BYTES];                   ///< IMSI of the receiver SIM
+    char     senderTel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES]; ///< Sender telephone number
+    char     timestamp[LE_SMS_TIMESTAMP_MAX_BYTES];     ///< Message time stamp
 }
-BrowseCtx_t;
+MsgHeader_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Entry description structure.
+ * Message, as stored in a message file.
  *
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    enum
-    {
-        DESC_INT,
-        DESC_STRING,
-        DESC_BOOL
-    }                               type;       ///< Union type (string or integer
-    union
-    {
-        struct
-        {
-            char*   strPtr;                     ///< String
-            size_t  lenStr;                     ///< Length of the string
-        }                  str;                 ///< Value for string
-        uint32_t           val;                 ///< Value for integer
-        bool               boolVal;             ///< Boolean value
-    }                               uVal;       ///< Union type
+    MsgHeader_t header;                                 ///< Header
+    uint8_t     payload[MSG_MAX_PAYLOAD_BYTES];         ///< Payload (header.payloadLen bytes)
+}
+Msg_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index slot.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MessageId_t msgId;                  ///< Message identifier (0 if the slot is free)
+    uint32_t    flags;                  ///< SLOT_xxx
 }
-EntryDesc_t;
+IndexSlot_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index file of a message box.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    magic;                  ///< INDEX_FILE_MAGIC
+    uint32_t    version;                ///< FILE_VERSION
+    uint32_t    slotCount;              ///< MAX_MBOX_SIZE
+    uint32_t    reserved;
+    IndexSlot_t slots[MAX_MBOX_SIZE];   ///< Slots
+}
+IndexFile_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Browsing structure.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MessageId_t msgIds[MAX_MBOX_SIZE];  ///< Messages of the box when browsing started, oldest first
+    uint32_t currentMessageIndex;
+    uint32_t maxIndex;
+}
+BrowseCtx_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -185,7 +267,8 @@ typedef struct
     char *    namePtr;                  ///< App name
     uint32_t inboxSize;                 ///< Max messages in the inbox
     uint32_t msgCount;                  ///< Number message
-
+    IndexFile_t* indexPtr;              ///< Mapped index file (NULL until the box is loaded)
+    le_hashmap_Ref_t slotMap;           ///< Slots of the index, by message identifier
 }
 MboxCtx_t;
 
@@ -336,1069 +419,1031 @@ static le_ref_MapRef_t ActivationRequestRefMap;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a boolean value of a key in a Jason object
+ * Check whether a file name ends with an extension
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddBooleanKeyInJsonObject
+static bool HasExtension
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    bool value          ///<[IN] Value to be added
+    const char* fileNamePtr,    ///<[IN] File name
+    const char* extPtr          ///<[IN] File extension
 )
 {
-    json_t *jsonBoolPtr;
-    int ret = -1;
-
-    if ( value == true )
-    {
-        jsonBoolPtr = json_true();
-    }
-    else
-    {
-        jsonBoolPtr = json_false();
-    }
+    size_t nameLen = strlen(fileNamePtr);
+    size_t extLen = strlen(extPtr);
 
-    if (jsonBoolPtr)
-    {
-        ret = json_object_set_new(jsonObjPtr, key, jsonBoolPtr);
-    }
-    else
-    {
-        LE_ERROR("Error during set of the key %s", key);
-    }
-
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
-    {
-        return LE_FAULT;
-    }
+    return (nameLen > extLen) && (strcmp(fileNamePtr + nameLen - extLen, extPtr) == 0);
 }
 
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Add an integer value of a key in a Jason object
+ * Get the path of a message file
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddIntegerKeyInJsonObject
+static void GetMsgPath
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    int  value          ///<[IN] Value to be added
+    MessageId_t messageId,  ///<[IN] Message identifier
+    const char* extPtr,     ///<[IN] File extension
+    char* pathPtr,          ///<[OUT] File path
+    size_t pathSize         ///<[IN] Size of the path buffer
 )
 {
-    json_t *jsonIntPtr = json_integer(value);
-    int ret = -1;
-
-    if (jsonIntPtr)
-    {
-        if (json_is_array(jsonObjPtr))
-        {
-            ret = json_array_append_new(jsonObjPtr, jsonIntPtr);
-        }
-        else
-        {
-            ret = json_object_set_new(jsonObjPtr, key, jsonIntPtr);
-        }
-    }
-    else
-    {
-        LE_ERROR("Error during set of the key %s", key);
-    }
+    snprintf(pathPtr, pathSize, "%s%s%08x%s", SMSINBOX_PATH, MSG_PATH, messageId, extPtr);
+}
 
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
-    {
-        return LE_FAULT;
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of a message box file
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetMboxPath
+(
+    const char* mboxNamePtr,    ///<[IN] Message box name
+    const char* extPtr,         ///<[IN] File extension
+    char* pathPtr,              ///<[OUT] File path
+    size_t pathSize             ///<[IN] Size of the path buffer
+)
+{
+    snprintf(pathPtr, pathSize, "%s%s%s%s", SMSINBOX_PATH, CONF_PATH, mboxNamePtr, extPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a string value of a key in a Jason object
+ * Write a file atomically: the data are written to a temporary file, which replaces the file once
+ * it is synced.
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure (the file is unchanged)
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddStringKeyInJsonObject
+static le_result_t WriteFileAtomically
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    char* string        ///<[IN] String to be added
+    const char* pathPtr,    ///<[IN] File path
+    const void* dataPtr,    ///<[IN] Data
+    size_t size             ///<[IN] Size of the data
 )
 {
-    json_t * jsonStrPtr = json_string(string);
-    int ret = -1;
+    char tmpPath[MAX_PATH_BYTES];
+    const uint8_t* bytePtr = dataPtr;
+
+    snprintf(tmpPath, sizeof(tmpPath), "%s%s", pathPtr, TMP_FILE_EXTENSION);
 
-    if (jsonStrPtr)
+    int fd = open(tmpPath, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
     {
-        ret = json_object_set_new(jsonObjPtr, key, jsonStrPtr);
+        LE_ERROR("Unable to create %s: %m", tmpPath);
+        return LE_FAULT;
     }
-    else
+
+    while (size > 0)
     {
-        LE_ERROR("Error during set of the key %s", key);
+        ssize_t writtenSize = write(fd, bytePtr, size);
+        if (writtenSize < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            break;
+        }
+        bytePtr += writtenSize;
+        size -= writtenSize;
     }
 
-    if (ret == 0)
+    if ((size > 0) || (fsync(fd) != 0))
     {
-        return LE_OK;
+        LE_ERROR("Unable to write %s: %m", tmpPath);
+        close(fd);
+        unlink(tmpPath);
+        return LE_FAULT;
     }
-    else
+
+    close(fd);
+
+    if (rename(tmpPath, pathPtr) != 0)
     {
+        LE_ERROR("Unable to rename %s: %m", tmpPath);
+        unlink(tmpPath);
         return LE_FAULT;
     }
-}
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the SMSInbox directory path length
- *
- */
-//--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxMessagePathLen
-(
-    void
-)
-{
-    return 2*sizeof(MessageId_t)+strlen(SMSINBOX_PATH)+strlen(MSG_PATH)+strlen(FILE_EXTENSION)+1;
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox file path
+ * Write a message file
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxMessagePath
+static le_result_t WriteMsg
 (
-    MessageId_t messageId,  ///[IN] message identifier
-    char* pathPtr,          ///<[OUT] path of the messageId file
-    uint32_t pathLen        ///<[IN] Length of pathPtr
+    MessageId_t messageId,  ///<[IN] Message identifier
+    const Msg_t* msgPtr     ///<[IN] Message
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%08x%s", SMSINBOX_PATH, MSG_PATH,
-                                            (int) messageId,
-                                            FILE_EXTENSION);
-}
+    char path[MAX_PATH_BYTES];
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the SMSInbox configuration path length
- *
- */
-//--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxConfigPathLen
-(
-    char* appNamePtr    ///<[IN] Application name
-)
-{
-    return strlen(appNamePtr)+strlen(SMSINBOX_PATH)+strlen(CONF_PATH)+strlen(FILE_EXTENSION)+1;
+    GetMsgPath(messageId, MSG_FILE_EXTENSION, path, sizeof(path));
+    LE_DEBUG("Write messageId %d, path %s", messageId, path);
+
+    return WriteFileAtomically(path, msgPtr, sizeof(MsgHeader_t) + msgPtr->header.payloadLen);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the application's box file descriptor path
+ * Read a message file
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT if the file is missing or corrupted
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxConfigPath
+static le_result_t ReadMsg
 (
-    char* appNamePtr,   ///<[IN] Application name
-    char* pathPtr,      ///<[OUT] configuration file path
-    uint32_t pathLen    ///<[IN] path length
+    MessageId_t messageId,  ///<[IN] Message identifier
+    Msg_t* msgPtr           ///<[OUT] Message
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%s%s", SMSINBOX_PATH, CONF_PATH, appNamePtr, FILE_EXTENSION);
+    char path[MAX_PATH_BYTES];
+    ssize_t size;
+
+    GetMsgPath(messageId, MSG_FILE_EXTENSION, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        LE_ERROR("Unable to open %s: %m", path);
+        return LE_FAULT;
+    }
+
+    do
+    {
+        size = read(fd, msgPtr, sizeof(Msg_t));
+    }
+    while ((size < 0) && (EINTR == errno));
+
+    close(fd);
+
+    if ((size < (ssize_t)sizeof(MsgHeader_t)) ||
+        (msgPtr->header.magic != MSG_FILE_MAGIC) ||
+        (msgPtr->header.version != FILE_VERSION) ||
+        (msgPtr->header.payloadLen > MSG_MAX_PAYLOAD_BYTES) ||
+        (size != (ssize_t)(sizeof(MsgHeader_t) + msgPtr->header.payloadLen)))
+    {
+        LE_ERROR("Bad message file %s", path);
+        return LE_FAULT;
+    }
+
+    // Make sure the strings are terminated.
+    msgPtr->header.imsi[sizeof(msgPtr->header.imsi) - 1] = '\0';
+    msgPtr->header.senderTel[sizeof(msgPtr->header.senderTel) - 1] = '\0';
+    msgPtr->header.timestamp[sizeof(msgPtr->header.timestamp) - 1] = '\0';
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Modify Json object
+ * Encode a SMS into a message
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ModifyJsonObj
+static void EncodeMsg
 (
-    json_t* jsonObjPtr,         ///<[IN] Json object (root object)
-    json_t* jsonValPtr,         ///<[IN] Json value to be modified
-    char*   key,                ///<[IN] Key to modify
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
+    le_sms_MsgRef_t msgRef, ///<[IN] SMS to be encoded
+    Msg_t* msgPtr           ///<[OUT] Message
 )
 {
-    int res = 0;
+    le_result_t result;
 
-    if (jsonValPtr == NULL)
-    {
-        LE_ERROR("NULL jsonValPtr");
-        return LE_FAULT;
-    }
+    memset(msgPtr, 0, sizeof(Msg_t));
+    msgPtr->header.magic = MSG_FILE_MAGIC;
+    msgPtr->header.version = FILE_VERSION;
+
+    le_utf8_Copy(msgPtr->header.imsi, SimImsi, sizeof(msgPtr->header.imsi), NULL);
+
+    le_sms_Format_t format = le_sms_GetFormat(msgRef);
+    msgPtr->header.format = format;
 
-    switch (modifPtr->type)
+    switch ( format )
     {
-        case DESC_STRING:
-            // check the type
-            if (json_is_string(jsonValPtr) == false)
+        case LE_SMS_FORMAT_TEXT:
+        case LE_SMS_FORMAT_BINARY:
+        {
+            // Add phone number
+            result = le_sms_GetSenderTel(msgRef, msgPtr->header.senderTel,
+                                         sizeof(msgPtr->header.senderTel));
+            if (result != LE_OK)
             {
-                LE_ERROR("Bad key format");
-                res = -1;
+                LE_ERROR("Unable to get the tel number %d", result);
+            }
+            else
+            {
+                LE_DEBUG("Tel num: %s", msgPtr->header.senderTel);
+                msgPtr->header.fields |= MSG_HAS_SENDERTEL;
             }
 
-            if ( res == 0 )
+            // Add timestamp
+            result = le_sms_GetTimeStamp(msgRef, msgPtr->header.timestamp,
+                                         sizeof(msgPtr->header.timestamp));
+            if (result != LE_OK)
             {
-                res = json_string_set(jsonValPtr, modifPtr->uVal.str.strPtr);
+                LE_ERROR("Unable to get the timestamp %d", result);
             }
-        break;
-        case DESC_INT:
-            // check the type
-            if (json_is_integer(jsonValPtr) == false )
+            else
             {
-                LE_ERROR("Bad key format");
-                res = -1;
+                LE_DEBUG("Timestamp: %s", msgPtr->header.timestamp);
+                msgPtr->header.fields |= MSG_HAS_TIMESTAMP;
             }
 
-            if ( res == 0 )
+            msgPtr->header.msgLen = le_sms_GetUserdataLen(msgRef);
+
+            // Add a character for last '\0'
+            size_t len = msgPtr->header.msgLen + 1;
+
+            if (len > sizeof(msgPtr->payload))
             {
-                res = json_integer_set(jsonValPtr, modifPtr->uVal.val);
+                result = LE_OVERFLOW;
             }
-        break;
-        case DESC_BOOL:
-            // check the type
-            if ( (json_is_true(jsonValPtr) != true) && (json_is_false(jsonValPtr) != true) )
+            else if (format == LE_SMS_FORMAT_TEXT)
             {
-                LE_ERROR("Bad key format");
-                res = -1;
+                // Get text
+                result = le_sms_GetText(msgRef, (char*) msgPtr->payload, len);
+            }
+            else
+            {
+                // Get binary
+                result = le_sms_GetBinary(msgRef, msgPtr->payload, &len);
             }
 
-            if (( res == 0 ) &&
-                (AddBooleanKeyInJsonObject(jsonObjPtr, key, modifPtr->uVal.boolVal) != LE_OK))
+            if (result != LE_OK)
+            {
+                LE_ERROR("Unable to get payload %d", result);
+                msgPtr->header.msgLen = 0;
+            }
+            else
             {
-                res = -1;
+                msgPtr->header.payloadLen = len;
+                msgPtr->header.fields |= MSG_HAS_PAYLOAD;
             }
+        }
         break;
-        default:
-            res = -1;
+
+        case LE_SMS_FORMAT_PDU:
+        {
+            size_t len = sizeof(msgPtr->payload);
+
+            msgPtr->header.msgLen = le_sms_GetPDULen(msgRef);
+
+            // Add pdu
+            result = le_sms_GetPDU(msgRef, msgPtr->payload, &len);
+
+            if (result != LE_OK)
+            {
+                LE_ERROR("Unable to get pdu %d", result);
+                msgPtr->header.msgLen = 0;
+            }
+            else
+            {
+                msgPtr->header.payloadLen = len;
+                msgPtr->header.fields |= MSG_HAS_PAYLOAD;
+                LE_DEBUG("PDU format OK");
+            }
+        }
         break;
+        case LE_SMS_FORMAT_UNKNOWN:
+        default:
+            LE_ERROR("Bad format %d", format);
     }
+}
 
-    if (res < 0)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string field of a message
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the buffer is too small
+ *      - LE_FAULT if the message has no such field
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyMsgString
+(
+    const char* srcPtr,     ///<[IN] Field of the message
+    bool isPresent,         ///<[IN] Whether the message has the field
+    char* destPtr,          ///<[OUT] Buffer
+    size_t destSize         ///<[IN] Size of the buffer
+)
+{
+    if (!isPresent)
     {
-        LE_ERROR(("Update error %d"), modifPtr->type);
+        LE_ERROR("Field not found");
         return LE_FAULT;
     }
-    else
+
+    if (le_utf8_Copy(destPtr, srcPtr, destSize, NULL) != LE_OK)
     {
-        LE_DEBUG("ModifyJsonObj OK");
-        return LE_OK;
+        LE_ERROR("String too long");
+        return LE_OVERFLOW;
     }
 
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Modify message file
+ * Copy the payload of a message
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the buffer is too small
+ *      - LE_FAULT if the message has no payload of this format
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ModifyMsgEntry
+static le_result_t CopyMsgPayload
 (
-    MessageId_t messageId,      ///<[IN] Message identifier to be modified
-    char* keyPtr[],              ///<[IN] Key to modify
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
+    const Msg_t* msgPtr,        ///<[IN] Message
+    le_sms_Format_t format,     ///<[IN] Payload format
+    uint8_t* destPtr,           ///<[OUT] Buffer
+    size_t* destSizePtr         ///<[INOUT] Size of the buffer, then of the payload
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res;
-    int indexKey = -1;
-
-    GetSMSInboxMessagePath(messageId, path, pathLen);
-
-    LE_DEBUG("ModifyMsgEntry: messageId %d, path %s",messageId, path);
-
-    json_t* jsonRootPtr = json_load_file(path, 0, &error);
-
-    if ( jsonRootPtr == NULL )
+    if ((msgPtr->header.format != format) || !(msgPtr->header.fields & MSG_HAS_PAYLOAD))
     {
-        LE_ERROR("Json decoder error %s", error.text);
+        LE_ERROR("Payload not found");
         return LE_FAULT;
     }
 
-    json_t* jsonValPtr = jsonRootPtr;
-    json_t* jsonSubObjPtr = jsonRootPtr;
-
-    while ( ( json_is_object(jsonValPtr) == true ) && ( nbKey > indexKey ) )
+    if (msgPtr->header.payloadLen > *destSizePtr)
     {
-        indexKey++;
-        jsonSubObjPtr = jsonValPtr;
-        jsonValPtr = json_object_get(jsonSubObjPtr, keyPtr[indexKey]);
+        LE_ERROR("Payload too long");
+        return LE_OVERFLOW;
     }
 
-    if ( !jsonValPtr )
-    {
-        if ((indexKey > -1) && (indexKey < nbKey))
-        {
-            LE_ERROR("Unable to get the object %s", keyPtr[indexKey]);
-        }
-        else
-        {
-            LE_ERROR("IndexKey: %d is out of range", indexKey);
-        }
+    memcpy(destPtr, msgPtr->payload, msgPtr->header.payloadLen);
+    *destSizePtr = msgPtr->header.payloadLen;
 
-        res = LE_FAULT;
-    }
-    else
-    {
-        res = ModifyJsonObj(jsonSubObjPtr, jsonValPtr, keyPtr[indexKey], modifPtr);
-    }
-
-    if ( res == LE_OK )
-    {
-        if (json_dump_file(jsonRootPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0)
-        {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
-        }
-    }
-    else
-    {
-        LE_ERROR("Something was wrong in ModifyJsonObj");
-    }
+    return LE_OK;
+}
 
-    json_decref(jsonRootPtr);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string of a legacy message (if it is present)
+ *
+ * @return
+ *      - true if the string was copied
+ *      - false otherwise
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CopyLegacyString
+(
+    json_t* jsonRootPtr,    ///<[IN] Legacy message
+    const char* keyPtr,     ///<[IN] Json key
+    char* destPtr,          ///<[OUT] Buffer
+    size_t destSize         ///<[IN] Size of the buffer
+)
+{
+    const char* strPtr = json_string_value(json_object_get(jsonRootPtr, keyPtr));
 
-    return res;
+    return (strPtr != NULL) && (le_utf8_Copy(destPtr, strPtr, destSize, NULL) == LE_OK);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Json object
+ * Convert a legacy (Jansson) message of a message box
  *
+ * @return
+ *      - true if the message is part of the message box (and was converted)
+ *      - false otherwise
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ReadJsonObj
+static bool ConvertLegacyMsg
 (
-    json_t* jsonValPtr,         ///<[IN] Json value to be read
-    char* keyPtr[],             ///<[IN] Key to read
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr     ///<[OUT] Decoding result
+    MessageId_t messageId,      ///<[IN] Message identifier
+    const char* mboxNamePtr,    ///<[IN] Message box name
+    uint32_t* flagsPtr          ///<[OUT] Index slot flags of the message
 )
 {
-    le_result_t res = LE_OK;
+    char path[MAX_PATH_BYTES];
+    json_error_t error;
+
+    GetMsgPath(messageId, LEGACY_FILE_EXTENSION, path, sizeof(path));
 
-    if ( jsonValPtr == NULL )
+    json_t* jsonRootPtr = json_load_file(path, 0, &error);
+    if (NULL == jsonRootPtr)
     {
-        LE_ERROR("No information");
-        return LE_FAULT;
+        LE_WARN("Dropping message %08x of %s: %s", messageId, mboxNamePtr, error.text);
+        return false;
     }
 
-    switch json_typeof(jsonValPtr)
+    bool isConverted = false;
+
+    if (!json_is_true(json_object_get(json_object_get(jsonRootPtr, JSON_ISDELETED), mboxNamePtr)))
     {
-        case JSON_STRING:
-        {
-            if ( decodePtr->type != DESC_STRING )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
+        Msg_t msg;
 
-            if (res == LE_OK)
-            {
-                const char* strPtr = json_string_value((const json_t *)jsonValPtr);
-
-                if ( strlen(strPtr) >= decodePtr->uVal.str.lenStr )
-                {
-                    LE_ERROR("String too long");
-                    res = LE_OVERFLOW;
-                }
-                else
-                {
-                    strncpy(decodePtr->uVal.str.strPtr, strPtr, decodePtr->uVal.str.lenStr);
-                    decodePtr->uVal.str.lenStr = strlen(strPtr);
-                }
-            }
+        memset(&msg, 0, sizeof(msg));
+        msg.header.magic = MSG_FILE_MAGIC;
+        msg.header.version = FILE_VERSION;
+        msg.header.format = json_integer_value(json_object_get(jsonRootPtr, JSON_FORMAT));
+        msg.header.msgLen = json_integer_value(json_object_get(jsonRootPtr, JSON_MSGLEN));
+
+        CopyLegacyString(jsonRootPtr, JSON_IMSI, msg.header.imsi, sizeof(msg.header.imsi));
+        if (CopyLegacyString(jsonRootPtr, JSON_SENDERTEL, msg.header.senderTel,
+                             sizeof(msg.header.senderTel)))
+        {
+            msg.header.fields |= MSG_HAS_SENDERTEL;
         }
-        break;
-        case JSON_INTEGER:
+        if (CopyLegacyString(jsonRootPtr, JSON_TIMESTAMP, msg.header.timestamp,
+                             sizeof(msg.header.timestamp)))
         {
-            if ( decodePtr->type != DESC_INT )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
-            else
-            {
-                decodePtr->uVal.val = json_integer_value((const json_t *)jsonValPtr);
-            }
+            msg.header.fields |= MSG_HAS_TIMESTAMP;
         }
-        break;
-        case JSON_TRUE:
-        case JSON_FALSE:
+
+        const char* keyPtr = (msg.header.format == LE_SMS_FORMAT_TEXT) ? JSON_TEXT :
+                             (msg.header.format == LE_SMS_FORMAT_BINARY) ? JSON_BIN : JSON_PDU;
+        const char* hexPtr = json_string_value(json_object_get(jsonRootPtr, keyPtr));
+        int32_t len = 0;
+
+        if (hexPtr != NULL)
         {
-            if ( decodePtr->type != DESC_BOOL )
-            {
-                LE_ERROR("Bad format %d", decodePtr->type);
-                res = LE_FAULT;
-            }
-            else
-            {
-                decodePtr->uVal.boolVal = json_is_true((const json_t *)jsonValPtr);
-            }
+            len = le_hex_StringToBinary(hexPtr, strlen(hexPtr), msg.payload, sizeof(msg.payload));
+            msg.header.payloadLen = len;
+            msg.header.fields |= MSG_HAS_PAYLOAD;
         }
-        break;
-        case JSON_OBJECT:
+
+        if (len < 0)
         {
-            // if key-value is an object, read the next key
-            if (nbKey >= 1)
-            {
-                json_t* jsonSubValPtr = json_object_get(jsonValPtr, keyPtr[0]);
-
-                if ( jsonSubValPtr )
-                {
-                    res = ReadJsonObj(jsonSubValPtr, &keyPtr[1], nbKey-1,  decodePtr );
-                }
-                else
-                {
-                    LE_ERROR("Bad format");
-                    res = LE_FAULT;
-                }
-            }
-            else
-            {
-                LE_ERROR("Key error");
-                res = LE_FAULT;
-            }
+            LE_WARN("Dropping message %08x of %s: bad payload", messageId, mboxNamePtr);
+        }
+        else if (WriteMsg(messageId, &msg) == LE_OK)
+        {
+            json_t* jsonUnreadPtr = json_object_get(json_object_get(jsonRootPtr, JSON_ISUNREAD),
+                                                    mboxNamePtr);
+
+            *flagsPtr = json_is_false(jsonUnreadPtr) ? 0 : SLOT_UNREAD;
+            isConverted = true;
         }
-        break;
-        case JSON_ARRAY:
-        case JSON_REAL:
-        case JSON_NULL:
-        default:
-            LE_ERROR("Bad json_typeof");
-            res = LE_FAULT;
-        break;
     }
 
-    return res;
+    json_decref(jsonRootPtr);
+
+    return isConverted;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Application's config file
+ * Delete the legacy message files, once the legacy files of all message boxes are converted
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetMsgListFromMbox
+static void DeleteLegacyMsgFiles
 (
-    char* pathPtr,              ///<[IN] Application's config file path
-    json_t **jsonRootObjPtr,    ///<[OUT] json root object
-    json_t **jsonArrayPtr       ///<[OUT] messages in box list
+    void
 )
 {
-    json_error_t error;
-    *jsonRootObjPtr = json_load_file(pathPtr, 0, &error);
+    char path[MAX_PATH_BYTES];
+    int i;
 
-    if ( !(*jsonRootObjPtr) )
+    for (i = 0; i < MAX_APPS; i++)
     {
-        // File doesn't exist, create objects
-        *jsonRootObjPtr = json_object();
-
-        if ( !(*jsonRootObjPtr) )
+        if (Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0))
         {
-            LE_ERROR("Json error");
-            return LE_FAULT;
+            GetMboxPath(Apps[i].namePtr, LEGACY_FILE_EXTENSION, path, sizeof(path));
+            if (access(path, F_OK) == 0)
+            {
+                return;
+            }
         }
     }
 
-    *jsonArrayPtr = json_object_get(*jsonRootObjPtr, JSON_MSGINBOX);
+    snprintf(path, sizeof(path), "%s%s", SMSINBOX_PATH, MSG_PATH);
 
-    if ( !(*jsonArrayPtr) )
+    DIR* dirPtr = opendir(path);
+    if (NULL == dirPtr)
     {
-        // Array doesn't exist, create it
-        *jsonArrayPtr = json_array();
-
-        if (!(*jsonArrayPtr))
-        {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
-        }
+        return;
+    }
 
-        if ( json_object_set(*jsonRootObjPtr, JSON_MSGINBOX, *jsonArrayPtr) < 0 )
+    struct dirent* entryPtr;
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if (HasExtension(entryPtr->d_name, LEGACY_FILE_EXTENSION))
         {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
+            LE_DEBUG("Delete legacy message file %s", entryPtr->d_name);
+            unlinkat(dirfd(dirPtr), entryPtr->d_name, 0);
         }
     }
 
-    return LE_OK;
+    closedir(dirPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove a message from the application's cfg file
+ * Convert the legacy (Jansson) configuration file of a message box, if there is one
  *
+ * @return
+ *      - true if the message box had a legacy configuration file
+ *      - false otherwise
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DeleteMsgInAppCfg
+static bool ConvertLegacyMbox
 (
-    char *appNamePtr,               ///<[IN] application name
-    MessageId_t deleteMessageId     ///<[IN] message to delete
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    IndexFile_t* indexPtr       ///<[OUT] Index of the message box
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appNamePtr);
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    GetSMSInboxConfigPath(appNamePtr, path, pathLen);
-    json_t *jsonObjPtr;
-    json_t *jsonArrayPtr;
+    char path[MAX_PATH_BYTES];
+    json_error_t error;
 
-    LE_DEBUG("DeleteMessageId %d, path %s",deleteMessageId, path);
+    GetMboxPath(mboxPtr->namePtr, LEGACY_FILE_EXTENSION, path, sizeof(path));
 
-    if (GetMsgListFromMbox(path, &jsonObjPtr, &jsonArrayPtr) != LE_OK)
+    if (access(path, F_OK) != 0)
     {
-       LE_ERROR("No message");
-       return LE_FAULT;
+        return false;
     }
 
-    int i;
-    MessageId_t messageId;
+    LE_INFO("Converting message box %s", mboxPtr->namePtr);
+
+    json_t* jsonRootPtr = json_load_file(path, 0, &error);
+    json_t* jsonArrayPtr = json_object_get(jsonRootPtr, JSON_MSGINBOX);
 
-    for (i=0; i < json_array_size(jsonArrayPtr); i++)
+    if (!json_is_array(jsonArrayPtr))
     {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
+        LE_WARN("Dropping the messages of %s: %s", mboxPtr->namePtr,
+                (NULL == jsonRootPtr) ? error.text : "no message list");
+    }
+
+    // Keep the most recent messages (at the end of the list) if there are too many.
+    size_t count = json_array_size(jsonArrayPtr);
+    size_t i = (count > MAX_MBOX_SIZE) ? (count - MAX_MBOX_SIZE) : 0;
+    uint32_t slot = 0;
+
+    for (; i < count; i++)
+    {
+        MessageId_t messageId = json_integer_value(json_array_get(jsonArrayPtr, i));
+        uint32_t flags;
 
-        if (jsonIntegerPtr)
+        if ((messageId != 0) && ConvertLegacyMsg(messageId, mboxPtr->namePtr, &flags))
         {
-            messageId = json_integer_value(jsonIntegerPtr);
+            indexPtr->slots[slot].msgId = messageId;
+            indexPtr->slots[slot].flags = flags;
+            slot++;
 
-            if (messageId == deleteMessageId)
+            if (messageId >= NextMessageId)
             {
-                LE_DEBUG("Remove %d", (int) messageId);
-                json_array_remove(jsonArrayPtr, i);
+                NextMessageId = messageId + 1;
             }
         }
-        else
-        {
-            LE_ERROR("Json error");
-        }
     }
 
-    le_result_t res = LE_OK;
-    if ( json_dump_file(jsonObjPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
-    {
-        res = LE_FAULT;
-        LE_ERROR("Json_dump_file error");
-    }
+    json_decref(jsonRootPtr);
 
-    json_decref(jsonObjPtr);
+    LE_INFO("Converted %u messages of %s", slot, mboxPtr->namePtr);
 
-    return res;
+    return true;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if a message belongs to a message box
+ * Create the index file of a message box, from its legacy configuration file if there is one
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
  */
 //--------------------------------------------------------------------------------------------------
-
-static le_result_t CheckMessageIdInMbox
+static le_result_t CreateIndex
 (
-    char* mboxName,
-    MessageId_t messageId
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    const char* pathPtr         ///<[IN] Index file path
 )
 {
-    json_t *jsonRootObjPtr;
-    json_t *jsonArrayPtr;
-    uint32_t pathLen = GetSMSInboxConfigPathLen(mboxName);
-    char path[pathLen];
-    GetSMSInboxConfigPath(mboxName, path, pathLen);
+    IndexFile_t index;
+
+    memset(&index, 0, sizeof(index));
+    index.magic = INDEX_FILE_MAGIC;
+    index.version = FILE_VERSION;
+    index.slotCount = MAX_MBOX_SIZE;
 
-    if ( GetMsgListFromMbox(path, &jsonRootObjPtr, &jsonArrayPtr) != LE_OK )
+    bool isLegacy = ConvertLegacyMbox(mboxPtr, &index);
+
+    if (WriteFileAtomically(pathPtr, &index, sizeof(index)) != LE_OK)
     {
-        LE_ERROR("Error in GetMsgListFromMbox");
         return LE_FAULT;
     }
 
-    int i = 0;
-
-    while (i < json_array_size(jsonArrayPtr))
+    if (isLegacy)
     {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
-        MessageId_t msgId = 0;
-
-        if (jsonIntegerPtr)
-        {
-            msgId = json_integer_value(jsonIntegerPtr);
-        }
-        else
-        {
-            LE_ERROR("Json error");
-            json_decref(jsonRootObjPtr);
-            return LE_FAULT;
-        }
+        char path[MAX_PATH_BYTES];
 
-        LE_DEBUG("MessageId %d, msgId %d, i %d", messageId, msgId, i);
-        if (msgId == messageId)
-        {
-            json_decref(jsonRootObjPtr);
-            return LE_OK;
-        }
+        GetMboxPath(mboxPtr->namePtr, LEGACY_FILE_EXTENSION, path, sizeof(path));
+        unlink(path);
 
-        i++;
+        DeleteLegacyMsgFiles();
     }
 
-    LE_ERROR("Bad msg id or mbox name");
-    json_decref(jsonRootObjPtr);
-    return LE_FAULT;
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Decode message file
+ * Check the index file of a message box
  *
+ * @return
+ *      - true if the index file exists and is valid
+ *      - false otherwise
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DecodeMsgEntry
+static bool IsIndexValid
 (
-    char* mboxName,                      ///<[IN] mbox name
-    MessageId_t messageId,               ///<[IN] Message identifier to decode
-    char* keyPtr[],                      ///<[IN] Key to retrieve
-    uint8_t nbKey,                       ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr              ///<[IN/OUT] Decoding result
+    const char* pathPtr         ///<[IN] Index file path
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res = LE_OK;
-
-    GetSMSInboxMessagePath(messageId, path, pathLen);
-
-    json_t* jsonRootPtr = json_load_file(path, JSON_REJECT_DUPLICATES, &error);
+    IndexFile_t index;
+    struct stat st;
 
-    if ( jsonRootPtr == NULL )
+    int fd = open(pathPtr, O_RDONLY);
+    if (fd < 0)
     {
-        LE_ERROR("Json decoder error %s mboxName %s", error.text, mboxName);
-        DeleteMsgInAppCfg(mboxName, messageId);
-        return LE_FAULT;
+        return false;
     }
 
-    res = ReadJsonObj(jsonRootPtr, keyPtr, nbKey, decodePtr);
+    bool isValid = (fstat(fd, &st) == 0) &&
+                   (st.st_size == sizeof(IndexFile_t)) &&
+                   (pread(fd, &index, offsetof(IndexFile_t, slots), 0) ==
+                    offsetof(IndexFile_t, slots)) &&
+                   (index.magic == INDEX_FILE_MAGIC) &&
+                   (index.version == FILE_VERSION) &&
+                   (index.slotCount == MAX_MBOX_SIZE);
 
-    json_decref(jsonRootPtr);
+    close(fd);
 
-    return res;
-}
+    if (!isValid)
+    {
+        LE_ERROR("Bad index file %s, resetting it", pathPtr);
+    }
 
+    return isValid;
+}
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if an application requested the deletion of a message
+ * Load a message box: map its index file (creating it if needed), and hash its messages.
  *
+ * @return
+ *      - LE_OK on success (or if the message box is already loaded)
+ *      - LE_FAULT on failure
  */
 //--------------------------------------------------------------------------------------------------
-static bool IsDeleted
+static le_result_t LoadMbox
 (
-    MessageId_t messageId,  ///<[IN] Message identifier
-    char* appNamePtr        ///<[IN] Application name
+    MboxCtx_t* mboxPtr          ///<[IN] Message box
 )
 {
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[2] = {JSON_ISDELETED, appNamePtr};
+    char path[MAX_PATH_BYTES];
+    char legacyPath[MAX_PATH_BYTES];
+    int i;
 
-    if (DecodeMsgEntry(appNamePtr, messageId, key, 2, &decode) == LE_OK)
+    if (mboxPtr->indexPtr != NULL)
     {
-        LE_DEBUG("Decode.uVal.boolVal %d", decode.uVal.boolVal);
-        return decode.uVal.boolVal;
+        return LE_OK;
     }
-    else
+
+    GetMboxPath(mboxPtr->namePtr, INDEX_FILE_EXTENSION, path, sizeof(path));
+    GetMboxPath(mboxPtr->namePtr, LEGACY_FILE_EXTENSION, legacyPath, sizeof(legacyPath));
+
+    // A legacy configuration file is deleted once converted: if there is one, it is more recent
+    // than the index.
+    if ((access(legacyPath, F_OK) == 0) || !IsIndexValid(path))
+    {
+        if (CreateIndex(mboxPtr, path) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0)
+    {
+        LE_ERROR("Unable to open %s: %m", path);
+        return LE_FAULT;
+    }
+
+    void* mapPtr = mmap(NULL, sizeof(IndexFile_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (MAP_FAILED == mapPtr)
     {
-        // if error, delete the message
-        return true;
+        LE_ERROR("Unable to map %s: %m", path);
+        return LE_FAULT;
     }
+
+    mboxPtr->indexPtr = mapPtr;
+    mboxPtr->msgCount = 0;
+
+    if (NULL == mboxPtr->slotMap)
+    {
+        mboxPtr->slotMap = le_hashmap_Create(mboxPtr->namePtr,
+                                             MAX_MBOX_SIZE,
+                                             le_hashmap_HashUInt32,
+                                             le_hashmap_EqualsUInt32);
+    }
+
+    for (i = 0; i < MAX_MBOX_SIZE; i++)
+    {
+        IndexSlot_t* slotPtr = &mboxPtr->indexPtr->slots[i];
+
+        if (0 == slotPtr->msgId)
+        {
+            continue;
+        }
+
+        if (le_hashmap_ContainsKey(mboxPtr->slotMap, &slotPtr->msgId))
+        {
+            LE_WARN("Duplicate message %08x in %s", slotPtr->msgId, mboxPtr->namePtr);
+            slotPtr->msgId = 0;
+            slotPtr->flags = 0;
+            continue;
+        }
+
+        le_hashmap_Put(mboxPtr->slotMap, &slotPtr->msgId, slotPtr);
+        mboxPtr->msgCount++;
+    }
+
+    LE_DEBUG("Message box %s loaded: %u messages", mboxPtr->namePtr, mboxPtr->msgCount);
+
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform the deleteion
+ * Sync the index file of a (loaded) message box
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void PerformDeletion
+static void SyncIndex
 (
-    MessageId_t messageId   ///<[IN] Message identifier
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    int flags                   ///<[IN] MS_SYNC to wait for the write, MS_ASYNC otherwise
 )
 {
-    int i;
-    bool deleted = true;
-
-    for (i=0; i < MAX_APPS; i++)
-    {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            deleted &= IsDeleted(messageId, Apps[i].namePtr);
-        }
-    }
-
-    // All applications mark this message to be delteted => erase physically the message
-    if (deleted)
+    if (msync(mboxPtr->indexPtr, sizeof(IndexFile_t), flags) != 0)
     {
-        uint16_t pathLen = GetSMSInboxMessagePathLen();
-        char path[pathLen];
-        memset(path, 0, pathLen);
-
-        GetSMSInboxMessagePath(messageId, path, pathLen);
-
-        LE_DEBUG("Delete messageId %d, path %s",messageId, path);
-        unlink(path);
+        LE_ERROR("Unable to sync the index of %s: %m", mboxPtr->namePtr);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a message in the application's cfg file
+ * Find a message in a message box
  *
+ * @return
+ *      - Index slot of the message
+ *      - NULL if the message is not in the message box
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddMsgInAppCfg
+static IndexSlot_t* FindMsgInMbox
 (
-    MboxCtx_t* appsPtr,         ///<[IN] application config
-    MessageId_t messageId     ///<[IN] message to add
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    MessageId_t messageId       ///<[IN] Message identifier
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appsPtr->namePtr);
-    char path[pathLen];
-    GetSMSInboxConfigPath(appsPtr->namePtr, path, pathLen);
-    json_t* jsonMsgIdPtr = NULL;
-    json_t* jsonPtr;
-    json_t* jsonArrayPtr;
-
-    if ( GetMsgListFromMbox (path, &jsonPtr, &jsonArrayPtr) != LE_OK )
+    if (LoadMbox(mboxPtr) != LE_OK)
     {
-        LE_ERROR("Message %s not found", path);
-        return LE_FAULT;
+        return NULL;
     }
-    LE_DEBUG("Add messageId %d, path %s, array Size %zu", messageId,
-                                                          path,
-                                                          json_array_size(jsonArrayPtr) );
 
-    if ( json_array_size(jsonArrayPtr) == appsPtr->inboxSize )
-    {
-        // delete older entry
-        jsonMsgIdPtr = json_array_get(jsonArrayPtr, 0);
-        MessageId_t messageId = 0;
+    return le_hashmap_Get(mboxPtr->slotMap, &messageId);
+}
 
-        if (jsonMsgIdPtr)
-        {
-            messageId = json_integer_value(jsonMsgIdPtr);
-        }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a message from a (loaded) message box
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveMsgFromMbox
+(
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    IndexSlot_t* slotPtr        ///<[IN] Index slot of the message
+)
+{
+    LE_DEBUG("Remove messageId %d from %s", slotPtr->msgId, mboxPtr->namePtr);
 
-        if (messageId != 0)
-        {
-            json_array_remove(jsonArrayPtr, 0);
+    le_hashmap_Remove(mboxPtr->slotMap, &slotPtr->msgId);
+    slotPtr->msgId = 0;
+    slotPtr->flags = 0;
+    mboxPtr->msgCount--;
 
-            EntryDesc_t modif;
-            modif.type = DESC_BOOL;
-            modif.uVal.boolVal = true;
-            char* key[2]={JSON_ISDELETED, appsPtr->namePtr};
+    SyncIndex(mboxPtr, MS_SYNC);
+}
 
-            if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-            {
-                LE_ERROR("Can't modify entry %08x, path %s", (int) messageId, path);
-            }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform the deletion of a message, if it is not in any message box anymore
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void PerformDeletion
+(
+    MessageId_t messageId   ///<[IN] Message identifier
+)
+{
+    char path[MAX_PATH_BYTES];
+    int i;
 
-            PerformDeletion(messageId);
-        }
-        else
+    for (i=0; i < MAX_APPS; i++)
+    {
+        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) &&
+             (FindMsgInMbox(&Apps[i], messageId) != NULL) )
         {
-            json_decref(jsonPtr);
-            LE_ERROR("Json error");
-            return LE_FAULT;
+            return;
         }
     }
 
-    if (AddIntegerKeyInJsonObject(jsonArrayPtr, NULL, messageId) != LE_OK)
-    {
-        json_decref(jsonPtr);
-        LE_ERROR("Json error");
-        return LE_FAULT;
-    }
+    // No message box contains this message => erase physically the message
+    GetMsgPath(messageId, MSG_FILE_EXTENSION, path, sizeof(path));
+
+    LE_DEBUG("Delete messageId %d, path %s",messageId, path);
+    unlink(path);
+}
 
-    if ( json_dump_file(jsonPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a message of a message box. A message which can't be read is removed from the message box.
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadMboxMsg
+(
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    MessageId_t messageId,      ///<[IN] Message identifier
+    Msg_t* msgPtr               ///<[OUT] Message
+)
+{
+    if (ReadMsg(messageId, msgPtr) == LE_OK)
     {
-        json_decref(jsonPtr);
-        LE_ERROR("Json error");
-        return LE_FAULT;
+        return LE_OK;
     }
 
-    json_decref(jsonPtr);
+    IndexSlot_t* slotPtr = FindMsgInMbox(mboxPtr, messageId);
 
-    // Use for the first initialization
-    if (jsonArrayPtr->refcount > 0)
+    if (slotPtr != NULL)
     {
-        json_decref(jsonArrayPtr);
+        RemoveMsgFromMbox(mboxPtr, slotPtr);
+        PerformDeletion(messageId);
     }
 
-    return LE_OK;
+    return LE_FAULT;
 }
 
-
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Encode Json file
+ * Add a message in a message box
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t EncodeMsgEntry
+static le_result_t AddMsgInMbox
 (
-    uint32_t fd,            ///<[IN] file descriptor
-    le_sms_MsgRef_t msgRef  ///<[IN] SMS to be encoding
+    MboxCtx_t* mboxPtr,         ///<[IN] Message box
+    MessageId_t messageId       ///<[IN] message to add
 )
 {
-    json_t *jsonRootPtr = json_object();
+    IndexSlot_t* slotPtr = NULL;
+    int i;
 
-    if (!jsonRootPtr)
+    if (LoadMbox(mboxPtr) != LE_OK)
     {
-        LE_ERROR("Json error");
         return LE_FAULT;
     }
 
-    // Add imsi in json file
-    AddStringKeyInJsonObject(jsonRootPtr, JSON_IMSI, SimImsi);
-
-    // Add sms format in json file
-    le_sms_Format_t format = le_sms_GetFormat(msgRef);
-    AddIntegerKeyInJsonObject(jsonRootPtr, JSON_FORMAT, (int) format);
-
-    // Unread by default for all applications
-    json_t *jsonUnreadPtr = json_object();
-    int i;
-    for (i=0; i < MAX_APPS; i++)
-    {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            AddBooleanKeyInJsonObject(jsonUnreadPtr, Apps[i].namePtr, true);
-        }
-    }
-
-    json_object_set_new(jsonRootPtr, JSON_ISUNREAD, jsonUnreadPtr);
-
-    // Undeleted by default for all applications
-    json_t *jsonDeletePtr = json_object();
-    for (i=0; i < MAX_APPS; i++)
+    // Delete the older entries to make room for the new one
+    while ((mboxPtr->msgCount > 0) && (mboxPtr->msgCount >= mboxPtr->inboxSize))
     {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            AddBooleanKeyInJsonObject(jsonDeletePtr, Apps[i].namePtr, false);
-        }
-    }
+        IndexSlot_t* olderSlotPtr = NULL;
 
-    json_object_set_new(jsonRootPtr, JSON_ISDELETED, jsonDeletePtr);
-
-    switch ( format )
-    {
-        case LE_SMS_FORMAT_TEXT:
-        case LE_SMS_FORMAT_BINARY:
+        for (i = 0; i < MAX_MBOX_SIZE; i++)
         {
-            char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
-            memset(tel, 0, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
-
-            // Add phone number
-            le_result_t result = le_sms_GetSenderTel(msgRef, tel, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
-
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get the tel number %d", result);
-            }
-            else
-            {
-                LE_DEBUG("Tel num: %s", tel);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_SENDERTEL, tel);
-            }
-
-            // Add timestamp
-            char timeStamp[LE_SMS_TIMESTAMP_MAX_BYTES];
-            result = le_sms_GetTimeStamp (msgRef, timeStamp, LE_SMS_TIMESTAMP_MAX_BYTES);
-
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get the timestamp %d", result);
-            }
-            else
-            {
-                LE_DEBUG("Timestamp: %s", timeStamp);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_TIMESTAMP, timeStamp);
-            }
-
-            size_t len = le_sms_GetUserdataLen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
-
-            // Add a character for last '\0'
-            len++;
-
-            uint8_t bin[len];
-            memset(bin, 0, len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string, 0, strLen);
-            const char* jsonKey;
-
-            if (format == LE_SMS_FORMAT_TEXT)
-            {
-                // Get text
-                result = le_sms_GetText(msgRef, (char*) bin, len);
-                jsonKey = JSON_TEXT;
-            }
-            else
-            {
-                // Get binary
-                result = le_sms_GetBinary(msgRef, bin, &len);
-                jsonKey = JSON_BIN;
-            }
+            slotPtr = &mboxPtr->indexPtr->slots[i];
 
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get payload %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
-            }
-            else
+            if ((slotPtr->msgId != 0) &&
+                ((NULL == olderSlotPtr) || (slotPtr->msgId < olderSlotPtr->msgId)))
             {
-                // Convert payload in string: json supports only utf-8 characters.
-                // Some extended-ASCII characters can be sent by SMS (such as character with accent)
-                // and can't be convert directly in utf-8. A convertion in string solves this issue.
-                strLen = le_hex_BinaryToString(bin, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, jsonKey, string);
-
+                olderSlotPtr = slotPtr;
             }
         }
-        break;
 
-        case LE_SMS_FORMAT_PDU:
-        {
-            size_t len = le_sms_GetPDULen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
-            // Add a character for last '\0'
-            len++;
-            uint8_t pdu[len];
-            memset(pdu, 0, len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string, 0, strLen);
-
-            // Add pdu
-            le_result_t result = le_sms_GetPDU(msgRef, pdu, &len);
+        MessageId_t olderMessageId = olderSlotPtr->msgId;
 
-            if (result != LE_OK)
-            {
-                LE_ERROR("Unable to get pdu %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
-            }
-            else
-            {
-                // Convert pdu in string
-                strLen = le_hex_BinaryToString(pdu, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_PDU, string);
-                LE_DEBUG("PDU format OK");
-            }
-        }
-        break;
-        case LE_SMS_FORMAT_UNKNOWN:
-        default:
-            LE_ERROR("Bad format %d", format);
+        RemoveMsgFromMbox(mboxPtr, olderSlotPtr);
+        PerformDeletion(olderMessageId);
     }
 
-    // Write json file in the file system
-    char* jsondumpStr = json_dumps( (const json_t *) jsonRootPtr,
-                                    JSON_INDENT(1) | JSON_PRESERVE_ORDER);
-    if (!jsondumpStr)
+    if (0 == mboxPtr->inboxSize)
     {
-        LE_ERROR("JsondumpStr is NULL");
-        return LE_FAULT;
+        LE_DEBUG("Message box %s is disabled", mboxPtr->namePtr);
+        return LE_OK;
     }
 
-    char* restJsondumpStr = jsondumpStr;
-    ssize_t writeSize = strlen(jsondumpStr);
-    ssize_t writtenSize;
-
-    do
+    for (i = 0; i < MAX_MBOX_SIZE; i++)
     {
-        writtenSize = write( fd, restJsondumpStr, writeSize );
-        if (writtenSize > 0)
+        slotPtr = &mboxPtr->indexPtr->slots[i];
+
+        if (0 == slotPtr->msgId)
         {
-            writeSize -= writtenSize;
-            restJsondumpStr += writtenSize;
+            // Unread by default; the identifier commits the slot.
+            slotPtr->flags = SLOT_UNREAD;
+            slotPtr->msgId = messageId;
+            mboxPtr->msgCount++;
+            le_hashmap_Put(mboxPtr->slotMap, &slotPtr->msgId, slotPtr);
+
+            SyncIndex(mboxPtr, MS_SYNC);
+
+            LE_DEBUG("Add messageId %d in %s, %u messages", messageId,
+                                                            mboxPtr->namePtr,
+                                                            mboxPtr->msgCount);
+            return LE_OK;
         }
     }
-    while ((writeSize > 0) && ((writtenSize >= 0) || (EINTR == errno)));
-
-    free(jsondumpStr);
-    json_decref(jsonRootPtr);
 
-    return LE_OK;
+    LE_ERROR("No free slot in %s", mboxPtr->namePtr);
+    return LE_FAULT;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create a new message entry
+ * Store a new message, and add it in all the message boxes
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateMsgEntry
+static le_result_t StoreMsg
 (
-    MessageId_t *msgPtr,    ///<[OUT] create messageId
-    int32_t *fdPtr         ///<[OUT] Created file descriptor
+    le_sms_MsgRef_t msgRef,     ///<[IN] SMS to be stored
+    MessageId_t *msgPtr         ///<[OUT] created messageId
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-
-    GetSMSInboxMessagePath(NextMessageId, path, pathLen);
-    LE_DEBUG("Create entry: NextMessageId %d, path %s",NextMessageId, path);
+    Msg_t msg;
+    MessageId_t messageId = NextMessageId;
+    int i;
 
-    *fdPtr = open( path, O_CREAT | O_RDWR | O_SYNC, S_IRUSR | S_IWUSR );
+    EncodeMsg(msgRef, &msg);
 
-    if (*fdPtr < 0)
+    if (WriteMsg(messageId, &msg) != LE_OK)
     {
-        LE_ERROR("No such file: %s: %m", path);
         return LE_FAULT;
     }
 
-    LE_DEBUG("New entry: %s", path);
-
-    int i;
+    NextMessageId++;
 
     // For all the applications
     for (i = 0; i < MAX_APPS; i++)
     {
         if ( Apps[i].namePtr && strlen(Apps[i].namePtr) )
         {
-            AddMsgInAppCfg(&Apps[i], NextMessageId);
+            if (AddMsgInMbox(&Apps[i], messageId) != LE_OK)
+            {
+                LE_ERROR("Unable to add messageId %d in %s", messageId, Apps[i].namePtr);
+            }
         }
     }
 
-    *msgPtr = NextMessageId;
+    // Erase the message if no message box could take it
+    PerformDeletion(messageId);
 
-    NextMessageId++;
+    *msgPtr = messageId;
 
     return LE_OK;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two message identifiers (for qsort)
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareMsgIds
+(
+    const void* aPtr,   ///<[IN] first message identifier
+    const void* bPtr    ///<[IN] second message identifier
+)
+{
+    MessageId_t a = *(const MessageId_t*)aPtr;
+    MessageId_t b = *(const MessageId_t*)bPtr;
+
+    return (a > b) - (a < b);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Convert the file name string in hexa
@@ -1459,8 +1504,7 @@ static void InitSmsInBoxDirectory
     void
 )
 {
-    struct dirent **namelist;
-    uint32_t nbSmsEntries;
+    char path[MAX_PATH_BYTES];
 
     LE_DEBUG("InitSmsInBoxDirectory");
 
@@ -1470,52 +1514,62 @@ static void InitSmsInBoxDirectory
         return;
     }
 
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, CONF_PATH);
+    snprintf(path, sizeof(path), "%s%s", SMSINBOX_PATH, CONF_PATH);
 
     if (LE_OK != MkdirCreate(path))
     {
         return;
     }
 
-    memset(path, 0, pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, MSG_PATH);
+    snprintf(path, sizeof(path), "%s%s", SMSINBOX_PATH, MSG_PATH);
 
     if (LE_OK != MkdirCreate(path))
     {
         return;
     }
 
-    nbSmsEntries = scandir(path, &namelist, NULL, alphasort);
-    if ( nbSmsEntries > 2 )
+    DIR* dirPtr = opendir(path);
+    if (NULL == dirPtr)
     {
-        uint8_t len = strlen(namelist[nbSmsEntries-1]->d_name);
-        char name[len+1];
-        MessageId_t id;
+        LE_ERROR("Unable to open %s: %m", path);
+        return;
+    }
 
-        memset(name, 0, len+1);
-        strncpy(name, namelist[nbSmsEntries-1]->d_name, len);
+    struct dirent* entryPtr;
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if ('.' == entryPtr->d_name[0])
+        {
+            continue;
+        }
 
-        id = GetMessageId(name);
-        if (-1 == id)
+        // Remove the files left over by an interrupted write
+        if (HasExtension(entryPtr->d_name, TMP_FILE_EXTENSION))
         {
-            LE_ERROR("Unable to get the id of %s", name);
-            return;
+            LE_WARN("Delete incomplete file %s", entryPtr->d_name);
+            unlinkat(dirfd(dirPtr), entryPtr->d_name, 0);
+            continue;
         }
 
-        NextMessageId = ++id;
+        char name[NAME_MAX + 1];
+        le_utf8_Copy(name, entryPtr->d_name, sizeof(name), NULL);
 
-        LE_DEBUG("NextMessageId %d", (int) NextMessageId);
-    }
+        MessageId_t id = GetMessageId(name);
+        if (-1 == id)
+        {
+            LE_ERROR("Unable to get the id of %s", entryPtr->d_name);
+            continue;
+        }
 
-    while (nbSmsEntries--)
-    {
-        free(namelist[nbSmsEntries]);
+        if (id >= NextMessageId)
+        {
+            NextMessageId = id + 1;
+        }
     }
 
-    free(namelist);
+    closedir(dirPtr);
+
+    LE_DEBUG("NextMessageId %d", (int) NextMessageId);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1529,7 +1583,6 @@ static void MoveSmsFromSimToFolder
     void
 )
 {
-    int32_t fd;
     le_result_t result = LE_OK;
 
     le_sms_MsgListRef_t msgListRef = le_sms_CreateRxMsgList();
@@ -1546,18 +1599,7 @@ static void MoveSmsFromSimToFolder
     {
         MessageId_t msgId;
 
-        result = CreateMsgEntry(&msgId, &fd);
-
-        if (result == LE_OK)
-        {
-            if ( EncodeMsgEntry(fd, smsRef) != LE_OK )
-            {
-                LE_ERROR("Encoding issue");
-            }
-
-            close(fd);
-        }
-        else
+        if (StoreMsg(smsRef, &msgId) != LE_OK)
         {
             LE_ERROR("Error during new entry creation");
         }
@@ -1586,23 +1628,12 @@ static void NewSmsMsgHandler
     void*           contextPtr
 )
 {
-    int32_t fd;
     le_result_t result;
     MessageId_t msgId;
 
     LE_DEBUG("Receive new message");
 
-    result = CreateMsgEntry(&msgId, &fd);
-
-    if (result == LE_OK)
-    {
-        result = EncodeMsgEntry(fd, msgRef);
-        close(fd);
-    }
-    else
-    {
-        LE_ERROR("CreateMsgEntry error");
-    }
+    result = StoreMsg(msgRef, &msgId);
 
     if (result == LE_OK)
     {
@@ -1614,7 +1645,7 @@ static void NewSmsMsgHandler
     }
     else
     {
-        LE_ERROR("EncodeMsgEntry error");
+        LE_ERROR("StoreMsg error");
     }
 }
 
@@ -1691,6 +1722,12 @@ static le_result_t LoadInboxSettings
 
         Apps[i].namePtr = (char*) le_smsInbox_mboxName[i];
 
+        if (Apps[i].inboxSize > MAX_MBOX_SIZE)
+        {
+            LE_WARN("Size of %s limited to %d", Apps[i].namePtr, MAX_MBOX_SIZE);
+            Apps[i].inboxSize = MAX_MBOX_SIZE;
+        }
+
         le_cfg_CancelTxn(appIter);
 
         i++;
@@ -2024,30 +2061,17 @@ void SmsInbox_DeleteMsg
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    IndexSlot_t* slotPtr = FindMsgInMbox(mboxPtr, msgId);
+
+    if (NULL == slotPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISDELETED, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-    {
-        LE_ERROR("ModifyMsgEntry error");
-    }
-
-    if (DeleteMsgInAppCfg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId)
-                          != LE_OK)
-    {
-        LE_ERROR("DeleteMsgInAppCfg error");
-    }
-
-    PerformDeletion(messageId);
+    RemoveMsgFromMbox(mboxPtr, slotPtr);
+    PerformDeletion((MessageId_t) msgId);
 }
 
 
@@ -2095,13 +2119,13 @@ le_result_t SmsInbox_GetImsi
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
 
     memset(imsiPtr, 0, imsiNumElements);
@@ -2111,14 +2135,12 @@ le_result_t SmsInbox_GetImsi
         return LE_OVERFLOW;
     }
 
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = imsiPtr;
-    decode.uVal.str.lenStr = imsiNumElements;
-    char* key[1] = {JSON_IMSI};
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
+    {
+        res = CopyMsgString(msg.header.imsi, true, imsiPtr, imsiNumElements);
+    }
 
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                              messageId, key, 1, &decode)) == LE_OK)
+    if (res == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2162,22 +2184,18 @@ le_sms_Format_t SmsInbox_GetFormat
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_FORMAT};
+    Msg_t msg;
 
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                      &decode) == LE_OK)
+    if (ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
-        return decode.uVal.val;
+        return msg.header.format;
     }
     else
     {
@@ -2227,23 +2245,24 @@ le_result_t SmsInbox_GetSenderTel
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = telPtr;
-    decode.uVal.str.lenStr = telNumElements;
+
     memset(telPtr, 0, telNumElements);
-    char* key[1] = {JSON_SENDERTEL};
 
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key,
-                              1, &decode)) == LE_OK)
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
+    {
+        res = CopyMsgString(msg.header.senderTel, msg.header.fields & MSG_HAS_SENDERTEL,
+                            telPtr, telNumElements);
+    }
+
+    if (res == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2297,23 +2316,24 @@ le_result_t SmsInbox_GetTimeStamp
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = timestampPtr;
-    decode.uVal.str.lenStr = timestampNumElements;
-    memset(timestampPtr, 0, timestampNumElements);
-    char* key[1] = {JSON_TIMESTAMP};
+    Msg_t msg;
     le_result_t res;
 
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                               key, 1, &decode)) == LE_OK )
+    memset(timestampPtr, 0, timestampNumElements);
+
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
+    {
+        res = CopyMsgString(msg.header.timestamp, msg.header.fields & MSG_HAS_TIMESTAMP,
+                            timestampPtr, timestampNumElements);
+    }
+
+    if (res == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2354,28 +2374,19 @@ size_t SmsInbox_GetMsgLen
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
 
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_MSGLEN};
-    le_result_t res;
-
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                                messageId,
-                                key,
-                                1,
-                                &decode)) == LE_OK )
+    if (ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
 
-        return decode.uVal.val;
+        return msg.header.msgLen;
     }
     else
     {
@@ -2426,38 +2437,25 @@ le_result_t SmsInbox_GetText
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
+    Msg_t msg;
     le_result_t res;
-    size_t len = 2*textNumElements+1;
-    char tmpTextPtr[len];
-    memset(tmpTextPtr, 0, len);
-    memset(textPtr, 0, textNumElements);
-
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpTextPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_TEXT};
+    size_t len = textNumElements;
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    memset(textPtr, 0, textNumElements);
 
-    if ( res == LE_OK )
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
     {
-        if ( le_hex_StringToBinary(tmpTextPtr,
-                                   decode.uVal.str.lenStr,
-                                   (uint8_t*) textPtr,
-                                   textNumElements ) < 0 )
-        {
-            return LE_FAULT;
-        }
+        res = CopyMsgPayload(&msg, LE_SMS_FORMAT_TEXT, (uint8_t*) textPtr, &len);
+    }
 
+    if (res == LE_OK)
+    {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2513,42 +2511,24 @@ le_result_t SmsInbox_GetBinary
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*binNumElementsPtr)+1;
-    char tmpBinPtr[len];
-    memset(tmpBinPtr, 0, len);
-    memset(binPtr, 0, *binNumElementsPtr);
-
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpBinPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_BIN};
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                         key, 1, &decode);
+    memset(binPtr, 0, *binNumElementsPtr);
 
-    if ( res == LE_OK )
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
     {
-        int32_t binNumElements = le_hex_StringToBinary(tmpBinPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    binPtr,
-                                                    *binNumElementsPtr);
-
-        if ( binNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *binNumElementsPtr = binNumElements;
+        res = CopyMsgPayload(&msg, LE_SMS_FORMAT_BINARY, binPtr, binNumElementsPtr);
+    }
 
+    if (res == LE_OK)
+    {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2608,42 +2588,24 @@ le_result_t SmsInbox_GetPdu
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    if (FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId) == NULL)
     {
         LE_ERROR("Message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
+    Msg_t msg;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*pduNumElementsPtr)+1;
-    char tmpPduPtr[len];
-    memset(tmpPduPtr, 0, len);
-    memset(pduPtr, 0, *pduNumElementsPtr);
-
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpPduPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_PDU};
 
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    memset(pduPtr, 0, *pduNumElementsPtr);
 
-    if ( res == LE_OK )
+    if ((res = ReadMboxMsg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId, &msg)) == LE_OK)
     {
-        int32_t pduNumElements = le_hex_StringToBinary(tmpPduPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    pduPtr,
-                                                    *pduNumElementsPtr);
-
-        if ( pduNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *pduNumElementsPtr = pduNumElements;
+        res = CopyMsgPayload(&msg, LE_SMS_FORMAT_PDU, pduPtr, pduNumElementsPtr);
+    }
 
+    if (res == LE_OK)
+    {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2682,75 +2644,40 @@ uint32_t SmsInbox_GetFirst
         return 0;
     }
 
-    uint32_t pathLen = GetSMSInboxConfigPathLen(clientRequestPtr->
-                                                mboxSessionPtr->mboxCtxPtr->namePtr);
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    GetSMSInboxConfigPath(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, path, pathLen);
-    le_result_t res = LE_OK;
-    MessageId_t messageId=0;
+    MboxCtx_t* mboxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
+    int i;
+
+    memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
 
-    if ( GetMsgListFromMbox(path,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr) != LE_OK )
+    if (LoadMbox(mboxPtr) != LE_OK)
     {
-        LE_ERROR("Error in GetMsgListFromMbox");
+        LE_ERROR("Error in LoadMbox");
         return 0;
     }
 
-    clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex =
-                      json_array_size(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr);
-
-    LE_DEBUG("MaxIndex %d", clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex);
-
-    if ( clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex > 0 )
+    // Take a snapshot of the message box, oldest message first
+    for (i = 0; i < MAX_MBOX_SIZE; i++)
     {
-        json_t * jsonIntegerPtr =
-                 json_array_get(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr, 0);
-
-        if (jsonIntegerPtr)
-        {
-            messageId = json_integer_value(jsonIntegerPtr);
-        }
-        else
-        {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
-        }
-
-        if (messageId)
-        {
-            clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex = 1;
-        }
-        else
+        if (mboxPtr->indexPtr->slots[i].msgId != 0)
         {
-            LE_ERROR("Json error");
-            res = LE_FAULT;
+            browseCtxPtr->msgIds[browseCtxPtr->maxIndex++] = mboxPtr->indexPtr->slots[i].msgId;
         }
     }
-    else
-    {
-        res = LE_FAULT;
-        LE_DEBUG("Empty mbox");
-    }
 
-    if (res == LE_FAULT)
-    {
-        if (clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr)
-        {
-            json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-        }
+    qsort(browseCtxPtr->msgIds, browseCtxPtr->maxIndex, sizeof(MessageId_t), CompareMsgIds);
 
-        memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
+    LE_DEBUG("MaxIndex %d", browseCtxPtr->maxIndex);
 
-        return 0;
-    }
-    else
+    if (0 == browseCtxPtr->maxIndex)
     {
-        return messageId;
+        LE_DEBUG("Empty mbox");
+        return 0;
     }
 
-    return 0;
+    browseCtxPtr->currentMessageIndex = 1;
+
+    return browseCtxPtr->msgIds[0];
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2778,58 +2705,26 @@ uint32_t SmsInbox_GetNext
         return LE_BAD_PARAMETER;
     }
 
-    while(clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex !=
-          clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex)
-    {
-        LE_DEBUG("CurrentIndex %d, maxIndex %d", clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.maxIndex);
+    MboxCtx_t* mboxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
 
-        json_t * jsonIntegerPtr = json_array_get(clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.jsonArrayPtr,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex);
+    while (browseCtxPtr->currentMessageIndex < browseCtxPtr->maxIndex)
+    {
+        LE_DEBUG("CurrentIndex %d, maxIndex %d", browseCtxPtr->currentMessageIndex,
+                                                 browseCtxPtr->maxIndex);
 
-        if (jsonIntegerPtr)
-        {
-            MessageId_t messageId = json_integer_value(jsonIntegerPtr);
+        MessageId_t messageId = browseCtxPtr->msgIds[browseCtxPtr->currentMessageIndex++];
 
-            if (messageId > 0)
-            {
-                clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex++;
-
-                // Check if the message exist (it may be deleted since the GetFirst call)
-                uint16_t pathLen = GetSMSInboxMessagePathLen();
-                char path[pathLen];
-                memset(path, 0, pathLen);
-                GetSMSInboxMessagePath(messageId, path, pathLen);
-                int32_t fd = open(path, O_RDWR);
-
-                if (fd >= 0)
-                {
-                    // message is still existing
-                    close(fd);
-                    return messageId;
-                }
-
-                // else continue the parsing
-            }
-            else
-            {
-                LE_ERROR("Json error");
-            }
-        }
-        else
+        // Check if the message exist (it may be deleted since the GetFirst call)
+        if (FindMsgInMbox(mboxPtr, messageId) != NULL)
         {
-            LE_ERROR("Json error");
+            return messageId;
         }
     }
 
-    // Parsing end => free the memory
+    // Parsing end
     LE_DEBUG("No more messages");
-    json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-    memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
+    memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
 
     return 0;
 }
@@ -2870,27 +2765,15 @@ bool SmsInbox_IsUnread
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    IndexSlot_t* slotPtr = FindMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == slotPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[] = {JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 2,
-                       &decode) == LE_OK)
-    {
-        return decode.uVal.boolVal;
-    }
-    else
-    {
-        LE_ERROR("Error in DecodeMsgEntry");
-        return false;
-    }
+    return (slotPtr->flags & SLOT_UNREAD) != 0;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2925,21 +2808,19 @@ void SmsInbox_MarkRead
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    IndexSlot_t* slotPtr = FindMsgInMbox(mboxPtr, msgId);
+
+    if (NULL == slotPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = false;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
+    if (slotPtr->flags & SLOT_UNREAD)
     {
-        LE_ERROR("Error in ModifyMsgEntry");
+        slotPtr->flags &= ~SLOT_UNREAD;
+        SyncIndex(mboxPtr, MS_ASYNC);
     }
 }
 
@@ -2975,21 +2856,19 @@ void SmsInbox_MarkUnread
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    IndexSlot_t* slotPtr = FindMsgInMbox(mboxPtr, msgId);
+
+    if (NULL == slotPtr)
     {
         LE_ERROR("Message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
+    if (!(slotPtr->flags & SLOT_UNREAD))
     {
-        LE_ERROR("Error in ModifyMsgEntry");
+        slotPtr->flags |= SLOT_UNREAD;
+        SyncIndex(mboxPtr, MS_ASYNC);
     }
 }
 
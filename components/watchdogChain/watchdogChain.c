@@ -5,6 +5,10 @@
  * watchdog.  The watchdog will be kicked when all non-stopped tasks on the chain have requested
  * a kick.
  *
+ * The process watchdog is kicked through the heartbeat page given by le_wdog_GetHeartbeat(), which
+ * costs no IPC, falling back to le_wdog_Kick() if there is no page or the page isn't watched any
+ * more.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -12,6 +16,9 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "watchdogChain.h"
+#include "wdogHeartbeat.h"
+
+#include <sys/mman.h>
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -75,6 +82,20 @@ typedef struct
 }
 WatchdogObj_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The process's heartbeat page, or NULL if it has none.
+ */
+//--------------------------------------------------------------------------------------------------
+static wdogHeartbeat_Page_t* HeartbeatPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set once getting a heartbeat page has failed, so it isn't attempted on every kick.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HeartbeatFailed = false;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Array of watchdogs
@@ -124,6 +145,78 @@ static void CheckEventLoopHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a (new) heartbeat page from the watchdog service.
+ *
+ * The previous page, if any, is not unmapped, as another thread may still be using it.  A new page
+ * is only needed after the process's watchdog expired or one of its sessions was closed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetHeartbeat
+(
+    wdogHeartbeat_Page_t* oldHeartbeatPtr    ///< Page being replaced (NULL if none)
+)
+{
+    int fd;
+
+    if (LE_OK != le_wdog_GetHeartbeat(&fd))
+    {
+        LE_WARN("Failed to get a heartbeat page; kicking the watchdog through IPC.");
+        HeartbeatFailed = true;
+        return;
+    }
+
+    void* pagePtr = mmap(NULL, LE_WDOG_HEARTBEAT_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+    close(fd);
+
+    if (MAP_FAILED == pagePtr)
+    {
+        LE_WARN("Failed to map heartbeat page (%m); kicking the watchdog through IPC.");
+        HeartbeatFailed = true;
+        return;
+    }
+
+    // Another thread may have got a new page already.
+    if (!__sync_bool_compare_and_swap(&HeartbeatPtr, oldHeartbeatPtr, pagePtr))
+    {
+        munmap(pagePtr, LE_WDOG_HEARTBEAT_PAGE_BYTES);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kick the process watchdog.
+ */
+//--------------------------------------------------------------------------------------------------
+static void KickWatchdog
+(
+    void
+)
+{
+    wdogHeartbeat_Page_t* heartbeatPtr = __atomic_load_n(&HeartbeatPtr, __ATOMIC_ACQUIRE);
+
+    if ((NULL != heartbeatPtr) && __atomic_load_n(&heartbeatPtr->isWatched, __ATOMIC_ACQUIRE))
+    {
+        le_clk_Time_t now = le_clk_GetRelativeTime();
+
+        __atomic_store_n(&heartbeatPtr->kickTime,
+                         ((uint64_t)now.sec * 1000) + (now.usec / 1000),
+                         __ATOMIC_RELEASE);
+        return;
+    }
+
+    le_wdog_Kick();
+
+    if (!HeartbeatFailed)
+    {
+        GetHeartbeat(heartbeatPtr);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check if the watchdog chain is all kicked, and if so kick the process watchdog.
@@ -144,7 +237,7 @@ void CheckChain
         // a problem.
         TRACE("Watchdog chain is all kicked, kick watchdog.");
 
-        le_wdog_Kick();
+        KickWatchdog();
         __sync_and_and_fetch(&WatchdogChain, ((uint64_t)-(INT64_C(1) << MAX_WATCHDOGS)));
     }
 }
@@ -0,0 +1,849 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file fdLog.c
+ *
+ * Logging of the standard out and standard error of application processes (see fdLog.h).
+ *
+ * The data read from each file descriptor is split into lines, each logged as one message (to the
+ * system log and the log store), subject to the application's rate limit.  Alternatively, an
+ * application's output can be spliced straight into a log file of its own in APP_LOG_DIR.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "log.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "logStore.h"
+#include "fdLog.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of processes that we expect to see.  Used to set the hashmap and pool sizes.
+ *
+ * @todo Make this configurable.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define MAX_EXPECTED_PROCESSES 32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest line read from a file descriptor that is logged as one message (including the null
+ * terminator).  Longer lines are split.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FD_LOG_MAX_LINE_BYTES   1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes read from (or spliced from) a file descriptor each time it becomes readable.
+ * Reading no more than this at a time keeps one busy file descriptor from starving the others.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FD_LOG_READ_BYTES       4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * How long after a line is dropped by an app's rate limit the number of lines dropped is reported,
+ * if no line from the app is logged before (in ms).
+ */
+//--------------------------------------------------------------------------------------------------
+#define DROP_REPORT_MS          1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Application logging object.
+ *
+ * Stores how the standard out and standard error of an application's processes are logged, and
+ * the state of the application's rate limiting and log file.
+ *
+ * The rate limiting is a token bucket: each logged line takes 1000 tokens, and maxLinesPerSec
+ * tokens are added every millisecond, up to burstLines * 1000.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char            appName[LIMIT_MAX_APP_NAME_BYTES];      ///< App name.
+    uint32_t        maxLinesPerSec;                         ///< Rate limit (0 = no limit).
+    uint32_t        burstLines;                             ///< Lines that can be logged at once.
+    uint32_t        logFileBytes;                           ///< Log file size (0 = no log file).
+    uint64_t        tokens;                                 ///< Tokens available.
+    uint64_t        lastRefillMs;                           ///< When tokens were last added.
+    size_t          droppedLines;                           ///< Lines dropped since last report.
+    le_timer_Ref_t  dropTimerRef;                           ///< Reports the lines dropped.
+    char            dropProcName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Process of last line dropped.
+    int             dropPid;                                ///< PID of that process.
+    int             logFileFd;                              ///< Log file (-1 if not open).
+    off_t           logFileSize;                            ///< Current size of the log file.
+    size_t          logFileUsers;                           ///< Fds being written to the log file.
+}
+AppLog_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for application logging objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t AppLogPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash map of application logging objects, keyed by app name.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t AppLogMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor logging object.
+ *
+ * Stores info about a file descriptor to be logged.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char            appName[LIMIT_MAX_APP_NAME_BYTES];      ///< App name.
+    char            procName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Process name.
+    int             pid;                                    ///< PID of the process.
+    le_log_Level_t  level;                                  ///< Log level.
+    le_fdMonitor_Ref_t monitorRef;                          ///< Monitor object.
+    AppLog_t*       appLogPtr;                              ///< App the process belongs to.
+    bool            toLogFile;                              ///< Data goes to the app's log file.
+    size_t          lineLen;                                ///< Bytes in line (not terminated).
+    bool            isLineSplit;                            ///< Last line logged was too long.
+    char            line[FD_LOG_MAX_LINE_BYTES];            ///< Incomplete line read so far.
+}
+FdLog_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for file descriptor logging objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t FdLogPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current relative time in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the application logging object for an app, creating it (with no limits) if needed.  The
+ * app name must have been checked to fit in LIMIT_MAX_APP_NAME_BYTES.
+ */
+//--------------------------------------------------------------------------------------------------
+static AppLog_t* GetAppLog
+(
+    const char* appNamePtr      ///< [IN] Name of the application.
+)
+{
+    AppLog_t* appLogPtr = le_hashmap_Get(AppLogMapRef, appNamePtr);
+
+    if (appLogPtr == NULL)
+    {
+        appLogPtr = le_mem_ForceAlloc(AppLogPoolRef);
+        memset(appLogPtr, 0, sizeof(*appLogPtr));
+
+        LE_ASSERT(le_utf8_Copy(appLogPtr->appName, appNamePtr, sizeof(appLogPtr->appName), NULL)
+                  == LE_OK);
+        appLogPtr->logFileFd = -1;
+
+        le_hashmap_Put(AppLogMapRef, appLogPtr->appName, appLogPtr);
+    }
+
+    return appLogPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of an app's log file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetAppLogFilePath
+(
+    const AppLog_t* appLogPtr,  ///< [IN] Application logging object.
+    const char* suffixPtr,      ///< [IN] Suffix added to the file name ("" for the current file).
+    char* pathPtr,              ///< [OUT] Buffer for the path.
+    size_t pathSize             ///< [IN] Size of the buffer.
+)
+{
+    LE_ASSERT(snprintf(pathPtr, pathSize, "%s/%s.log%s", APP_LOG_DIR, appLogPtr->appName,
+                       suffixPtr) < pathSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens an app's log file, creating it if needed, and positions it at the end.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenAppLogFile
+(
+    AppLog_t* appLogPtr         ///< [IN] Application logging object.
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    if (le_dir_MakePath(APP_LOG_DIR, S_IRWXU | S_IRGRP | S_IXGRP) != LE_OK)
+    {
+        LE_ERROR("Could not create directory '%s'.", APP_LOG_DIR);
+        return LE_FAULT;
+    }
+
+    GetAppLogFilePath(appLogPtr, "", path, sizeof(path));
+
+    // Not opened in append mode, which splice() does not support.  This is the only writer.
+    int fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open log file '%s'.  %m.", path);
+        return LE_FAULT;
+    }
+
+    off_t size = lseek(fd, 0, SEEK_END);
+
+    if (size < 0)
+    {
+        LE_ERROR("Could not seek to the end of log file '%s'.  %m.", path);
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    appLogPtr->logFileFd = fd;
+    appLogPtr->logFileSize = size;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes an app's log file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseAppLogFile
+(
+    AppLog_t* appLogPtr         ///< [IN] Application logging object.
+)
+{
+    if (appLogPtr->logFileFd >= 0)
+    {
+        fd_Close(appLogPtr->logFileFd);
+        appLogPtr->logFileFd = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a new log file for an app if the current one is full.  The full one is kept as
+ * <appName>.log.1, replacing the previous one.
+ *
+ * @return
+ *      LE_OK if the log file can be written to.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RotateAppLogFile
+(
+    AppLog_t* appLogPtr         ///< [IN] Application logging object.
+)
+{
+    if ((appLogPtr->logFileFd >= 0) && (appLogPtr->logFileSize < appLogPtr->logFileBytes))
+    {
+        return LE_OK;
+    }
+
+    CloseAppLogFile(appLogPtr);
+
+    char path[LIMIT_MAX_PATH_BYTES];
+    char oldPath[LIMIT_MAX_PATH_BYTES];
+
+    GetAppLogFilePath(appLogPtr, "", path, sizeof(path));
+    GetAppLogFilePath(appLogPtr, ".1", oldPath, sizeof(oldPath));
+
+    if ((rename(path, oldPath) != 0) && (errno != ENOENT))
+    {
+        LE_ERROR("Could not rename log file '%s' to '%s'.  %m.", path, oldPath);
+    }
+
+    return OpenAppLogFile(appLogPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports the number of lines of an app dropped by its rate limit since the last report, if any.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportDroppedLines
+(
+    AppLog_t* appLogPtr         ///< [IN] Application logging object.
+)
+{
+    if (appLogPtr->droppedLines == 0)
+    {
+        return;
+    }
+
+    char msg[128];
+
+    snprintf(msg, sizeof(msg), "%zu lines from app '%s' dropped (over %" PRIu32 " lines/s).",
+             appLogPtr->droppedLines, appLogPtr->appName, appLogPtr->maxLinesPerSec);
+    log_LogGenericMsg(LE_LOG_WARN, appLogPtr->dropProcName, appLogPtr->dropPid, msg);
+    logStore_Add(LE_LOG_WARN, appLogPtr->dropProcName, appLogPtr->dropPid, "", msg);
+
+    appLogPtr->droppedLines = 0;
+    le_timer_Stop(appLogPtr->dropTimerRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when an app's drop report timer expires: reports the lines dropped, so that they are
+ * reported even if the app doesn't log anything else.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropTimerExpired
+(
+    le_timer_Ref_t timerRef     ///< [IN] Timer.
+)
+{
+    ReportDroppedLines(le_timer_GetContextPtr(timerRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks an app's rate limit before logging a line.  Reports the number of lines dropped, if any,
+ * when lines can be logged again, or DROP_REPORT_MS after the first line dropped (whichever comes
+ * first).
+ *
+ * @return
+ *      true if the line can be logged.
+ *      false if it must be dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsLineAllowed
+(
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object the line was read from.
+)
+{
+    AppLog_t* appLogPtr = fdLogPtr->appLogPtr;
+
+    if (appLogPtr->maxLinesPerSec == 0)
+    {
+        return true;
+    }
+
+    uint64_t now = GetNowMs();
+    uint64_t maxTokens = (uint64_t)appLogPtr->burstLines * 1000;
+
+    appLogPtr->tokens += (now - appLogPtr->lastRefillMs) * appLogPtr->maxLinesPerSec;
+    if (appLogPtr->tokens > maxTokens)
+    {
+        appLogPtr->tokens = maxTokens;
+    }
+    appLogPtr->lastRefillMs = now;
+
+    if (appLogPtr->tokens < 1000)
+    {
+        LE_ASSERT(le_utf8_Copy(appLogPtr->dropProcName, fdLogPtr->procName,
+                               sizeof(appLogPtr->dropProcName), NULL) == LE_OK);
+        appLogPtr->dropPid = fdLogPtr->pid;
+
+        if (appLogPtr->droppedLines++ == 0)
+        {
+            if (appLogPtr->dropTimerRef == NULL)
+            {
+                appLogPtr->dropTimerRef = le_timer_Create("AppLogDrops");
+                LE_ASSERT(le_timer_SetMsInterval(appLogPtr->dropTimerRef, DROP_REPORT_MS)
+                          == LE_OK);
+                LE_ASSERT(le_timer_SetHandler(appLogPtr->dropTimerRef, DropTimerExpired)
+                          == LE_OK);
+                LE_ASSERT(le_timer_SetContextPtr(appLogPtr->dropTimerRef, appLogPtr) == LE_OK);
+            }
+            LE_ASSERT(le_timer_Start(appLogPtr->dropTimerRef) == LE_OK);
+        }
+        return false;
+    }
+
+    appLogPtr->tokens -= 1000;
+
+    ReportDroppedLines(appLogPtr);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs the line assembled in an fd log object (if the app's rate limit allows it), and empties it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogLine
+(
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object.
+)
+{
+    fdLogPtr->line[fdLogPtr->lineLen] = '\0';
+    fdLogPtr->lineLen = 0;
+
+    if (IsLineAllowed(fdLogPtr))
+    {
+        // TODO: Don't log the app name for now so that it matches all the other log formats.  Add
+        //       the app name to all log messages at the same time.
+        log_LogGenericMsg(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, fdLogPtr->line);
+        logStore_Add(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, "", fdLogPtr->line);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Splits data read from a file descriptor into lines, and logs each complete line.  An incomplete
+ * line is kept until the rest of it is read (or until it is too long for one message).
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogData
+(
+    FdLog_t* fdLogPtr,          ///< [IN] Fd log object.
+    const char* dataPtr,        ///< [IN] Data read.
+    size_t dataLen              ///< [IN] Number of bytes read.
+)
+{
+    while (dataLen > 0)
+    {
+        size_t space = sizeof(fdLogPtr->line) - 1 - fdLogPtr->lineLen;
+        const char* endPtr = memchr(dataPtr, '\n', (dataLen < space) ? dataLen : space);
+        size_t count = (endPtr != NULL) ? (size_t)(endPtr - dataPtr) :
+                                          ((dataLen < space) ? dataLen : space);
+
+        memcpy(fdLogPtr->line + fdLogPtr->lineLen, dataPtr, count);
+        fdLogPtr->lineLen += count;
+
+        if (endPtr != NULL)
+        {
+            // Skip the newline.  A newline right after a line that was split ends that line.
+            count++;
+            if ((fdLogPtr->lineLen > 0) || !fdLogPtr->isLineSplit)
+            {
+                LogLine(fdLogPtr);
+            }
+            fdLogPtr->isLineSplit = false;
+        }
+        else if (fdLogPtr->lineLen == sizeof(fdLogPtr->line) - 1)
+        {
+            LogLine(fdLogPtr);
+            fdLogPtr->isLineSplit = true;
+        }
+
+        dataPtr += count;
+        dataLen -= count;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes data to an app's log file.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteLogFile
+(
+    AppLog_t* appLogPtr,        ///< [IN] Application logging object.
+    const char* dataPtr,        ///< [IN] Data to write.
+    size_t dataLen              ///< [IN] Number of bytes.
+)
+{
+    if (RotateAppLogFile(appLogPtr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (fd_WriteSize(appLogPtr->logFileFd, (void*)dataPtr, dataLen) != (ssize_t)dataLen)
+    {
+        LE_ERROR("Could not write to log file of app '%s'.  %m.", appLogPtr->appName);
+        return LE_FAULT;
+    }
+
+    appLogPtr->logFileSize += dataLen;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves data from a file descriptor straight into its app's log file, without copying it through
+ * user space if the file system supports it.
+ *
+ * @return
+ *      Number of bytes moved, 0 at end of file, or -1 if there was an error (errno is EAGAIN if
+ *      there was no data).
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t SpliceToLogFile
+(
+    int fd,                     ///< [IN] Fd to read from.
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object.
+)
+{
+    static bool SpliceUnsupported = false;
+    AppLog_t* appLogPtr = fdLogPtr->appLogPtr;
+    ssize_t count;
+
+    if (RotateAppLogFile(appLogPtr) != LE_OK)
+    {
+        return -1;
+    }
+
+    if (!SpliceUnsupported)
+    {
+        do
+        {
+            count = splice(fd, NULL, appLogPtr->logFileFd, NULL, FD_LOG_READ_BYTES,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        }
+        while ((count == -1) && (errno == EINTR));
+
+        if ((count != -1) || (errno != EINVAL))
+        {
+            if (count > 0)
+            {
+                appLogPtr->logFileSize += count;
+            }
+            return count;
+        }
+
+        LE_INFO("Log file system does not support splice().  Copying instead.");
+        SpliceUnsupported = true;
+    }
+
+    char buffer[FD_LOG_READ_BYTES];
+
+    do
+    {
+        count = read(fd, buffer, sizeof(buffer));
+    }
+    while ((count == -1) && (errno == EINTR));
+
+    if ((count > 0) && (WriteLogFile(appLogPtr, buffer, count) != LE_OK))
+    {
+        return -1;
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops writing a file descriptor's data to its app's log file.  The log file is closed when the
+ * app has no other file descriptor written to it, so it isn't kept open forever.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopLogFile
+(
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object.
+)
+{
+    if (fdLogPtr->toLogFile)
+    {
+        fdLogPtr->toLogFile = false;
+
+        if (--fdLogPtr->appLogPtr->logFileUsers == 0)
+        {
+            CloseAppLogFile(fdLogPtr->appLogPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads one chunk of data from a file descriptor and logs it.
+ *
+ * @return
+ *      Number of bytes read, 0 at end of file, or -1 if there was an error (errno is EAGAIN if
+ *      there was no data).
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t ReadFd
+(
+    int fd,                     ///< [IN] Fd to read from.
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object.
+)
+{
+    // The app's log file may have been turned off (see fdLog_SetAppLimits()) since the fd was
+    // registered, in which case its data goes back to the system log.
+    if (fdLogPtr->toLogFile && (fdLogPtr->appLogPtr->logFileBytes == 0))
+    {
+        StopLogFile(fdLogPtr);
+    }
+
+    if (fdLogPtr->toLogFile)
+    {
+        return SpliceToLogFile(fd, fdLogPtr);
+    }
+
+    char buffer[FD_LOG_READ_BYTES];
+    ssize_t count;
+
+    do
+    {
+        count = read(fd, buffer, sizeof(buffer));
+    }
+    while ((count == -1) && (errno == EINTR));
+
+    if (count > 0)
+    {
+        LogData(fdLogPtr, buffer, count);
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the fd log object and monitor.  Logs any incomplete line left and closes the associated
+ * fd.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteFdLog
+(
+    int fd,                     ///< [IN] Fd to close.
+    FdLog_t* fdLogPtr           ///< [IN] Fd log object to delete.
+)
+{
+    if (fdLogPtr->lineLen > 0)
+    {
+        LogLine(fdLogPtr);
+    }
+
+    StopLogFile(fdLogPtr);
+
+    // Delete the fd monitor.
+    le_fdMonitor_Delete(fdLogPtr->monitorRef);
+
+    // Close the fd.
+    fd_Close(fd);
+
+    // Delete the fd log object.
+    le_mem_Release(fdLogPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs messages received from the fd.
+ *
+ * Only one chunk is read each time the fd becomes readable, so a process that writes a lot can't
+ * keep the log daemon from serving the others.  When the fd is hung up, whatever is left in it is
+ * read before it is closed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogFdMessages
+(
+    int   fd,
+    short events
+)
+{
+    FdLog_t* fdLogPtr = le_fdMonitor_GetContextPtr();
+    bool isHungUp = ((events & POLLRDHUP) || (events & POLLERR) || (events & POLLHUP));
+    ssize_t count = 1;
+
+    if (events & POLLIN)
+    {
+        count = ReadFd(fd, fdLogPtr);
+    }
+
+    if (isHungUp)
+    {
+        while (count > 0)
+        {
+            count = ReadFd(fd, fdLogPtr);
+        }
+
+        LE_DEBUG("Error on app/proc '%s/%s' log fd, events=%d.  Cannot log from this fd.",
+                fdLogPtr->appName, fdLogPtr->procName, events);
+
+        DeleteFdLog(fd, fdLogPtr);
+    }
+    else if (count == 0)
+    {
+        DeleteFdLog(fd, fdLogPtr);
+    }
+    else if ((count < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+    {
+        LE_ERROR("Could not read fd log message for app/process '%s/%s[%d]'.  %m.",
+                 fdLogPtr->appName, fdLogPtr->procName, fdLogPtr->pid);
+
+        DeleteFdLog(fd, fdLogPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start logging what an application process writes to a file descriptor.  The file descriptor is
+ * closed when the process closes its end.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the app or process name is too long (the file descriptor is closed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t fdLog_Add
+(
+    int fd,                     ///< [IN] File descriptor to log.
+    const char* appNamePtr,     ///< [IN] Name of the application.
+    const char* procNamePtr,    ///< [IN] Name of the process.
+    pid_t pid,                  ///< [IN] PID of the process.
+    le_log_Level_t logLevel,    ///< [IN] Level to log messages from this fd at.
+    const char* monitorNamePtr  ///< [IN] Name of the fd monitor.
+)
+{
+    // Create fd log object.
+    FdLog_t* fdLogPtr = le_mem_ForceAlloc(FdLogPoolRef);
+
+    if (   (le_utf8_Copy(fdLogPtr->appName, appNamePtr, LIMIT_MAX_APP_NAME_BYTES, NULL) != LE_OK)
+        || (le_utf8_Copy(fdLogPtr->procName, procNamePtr, LIMIT_MAX_PROCESS_NAME_BYTES, NULL)
+            != LE_OK))
+    {
+        le_mem_Release(fdLogPtr);
+        fd_Close(fd);
+        return LE_OVERFLOW;
+    }
+
+    fdLogPtr->level = logLevel;
+    fdLogPtr->pid = pid;
+    fdLogPtr->lineLen = 0;
+    fdLogPtr->isLineSplit = false;
+    fdLogPtr->appLogPtr = GetAppLog(appNamePtr);
+    fdLogPtr->toLogFile = false;
+
+    if (fdLogPtr->appLogPtr->logFileBytes > 0)
+    {
+        fdLogPtr->toLogFile = true;
+        fdLogPtr->appLogPtr->logFileUsers++;
+    }
+
+    // Reads must never block the daemon.
+    fd_SetNonBlocking(fd);
+
+    // Create the fd monitor.
+    fdLogPtr->monitorRef = le_fdMonitor_Create(monitorNamePtr, fd, LogFdMessages, 0);
+
+    // Set the fd monitor context.
+    le_fdMonitor_SetContextPtr(fdLogPtr->monitorRef, fdLogPtr);
+
+    // Enable the monitoring.
+    le_fdMonitor_Enable(fdLogPtr->monitorRef, POLLIN);
+
+    return LE_OK;
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the file descriptor logging.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdLog_Init
+(
+    void
+)
+{
+    FdLogPoolRef = le_mem_CreatePool("FdLogs", sizeof(FdLog_t));
+    AppLogPoolRef = le_mem_CreatePool("AppLogs", sizeof(AppLog_t));
+
+    // Tune the pools' initial sizes to reduce warnings in the log at start-up.
+    // Generally 2 fds per process (stderr, stdout).
+    le_mem_ExpandPool(FdLogPoolRef, MAX_EXPECTED_PROCESSES * 2);
+    le_mem_ExpandPool(AppLogPoolRef, MAX_EXPECTED_PROCESSES);
+
+    AppLogMapRef = le_hashmap_Create("AppLog",
+                                     MAX_EXPECTED_PROCESSES,
+                                     le_hashmap_HashString,
+                                     le_hashmap_EqualsString);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how the standard out and standard error of an application's processes are logged.  Applies
+ * to the file descriptors added for the application afterwards, and to the rate limiting of those
+ * added already.  Those already written to the app's log file go back to the system log if
+ * logFileBytes is 0.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the app name is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t fdLog_SetAppLimits
+(
+    const char* appNamePtr,     ///< [IN] Name of the application.
+    uint32_t maxLinesPerSec,    ///< [IN] Average lines logged per second (0 = no limit).
+    uint32_t burstLines,        ///< [IN] Lines that can be logged at once.
+    uint32_t logFileBytes       ///< [IN] Maximum size of the app's log file (0 = log to the
+                                ///       system log).
+)
+{
+    if (strlen(appNamePtr) >= LIMIT_MAX_APP_NAME_BYTES)
+    {
+        return LE_OVERFLOW;
+    }
+
+    AppLog_t* appLogPtr = GetAppLog(appNamePtr);
+
+    appLogPtr->maxLinesPerSec = maxLinesPerSec;
+    appLogPtr->burstLines = (burstLines > 0) ? burstLines : 1;
+    appLogPtr->logFileBytes = logFileBytes;
+
+    // Start with a full bucket.
+    appLogPtr->tokens = (uint64_t)appLogPtr->burstLines * 1000;
+    appLogPtr->lastRefillMs = GetNowMs();
+
+    LE_DEBUG("App '%s': %" PRIu32 " lines/s (burst %" PRIu32 "), log file %" PRIu32 " bytes.",
+             appNamePtr, maxLinesPerSec, appLogPtr->burstLines, logFileBytes);
+
+    return LE_OK;
+}
@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file fdLog.h
+ *
+ * Logging of the standard out and standard error of application processes, which the Supervisor
+ * hands the Log Control Daemon as pipes (see logFd.api).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_FD_LOG_H_INCLUDE_GUARD
+#define LEGATO_FD_LOG_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory holding the apps' log files (see fdLog_SetAppLimits()).
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef APP_LOG_DIR
+#define APP_LOG_DIR             "/legato/logs"
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the file descriptor logging.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdLog_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start logging what an application process writes to a file descriptor.  The file descriptor is
+ * closed when the process closes its end.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the app or process name is too long (the file descriptor is closed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t fdLog_Add
+(
+    int fd,                     ///< [IN] File descriptor to log.
+    const char* appNamePtr,     ///< [IN] Name of the application.
+    const char* procNamePtr,    ///< [IN] Name of the process.
+    pid_t pid,                  ///< [IN] PID of the process.
+    le_log_Level_t logLevel,    ///< [IN] Level to log messages from this fd at.
+    const char* monitorNamePtr  ///< [IN] Name of the fd monitor.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how the standard out and standard error of an application's processes are logged.  Applies
+ * to the file descriptors added for the application afterwards, and to the rate limiting of those
+ * added already.  Those already written to the app's log file go back to the system log if
+ * logFileBytes is 0.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the app name is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t fdLog_SetAppLimits
+(
+    const char* appNamePtr,     ///< [IN] Name of the application.
+    uint32_t maxLinesPerSec,    ///< [IN] Average lines logged per second (0 = no limit).
+    uint32_t burstLines,        ///< [IN] Lines that can be logged at once.
+    uint32_t logFileBytes       ///< [IN] Maximum size of the app's log file (0 = log to the
+                                ///       system log).
+);
+
+
+#endif // LEGATO_FD_LOG_H_INCLUDE_GUARD
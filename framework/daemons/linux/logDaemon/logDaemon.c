@@ -59,6 +59,16 @@
  * running process that belongs to an IPC session reference when the IPC system reports that
  * a session closed.  This is how the Log Control Daemon finds out that a client process died.
  *
+ * The Log Control Daemon also logs the standard out and standard error of application processes,
+ * which the Supervisor hands it as pipes (see logFd.api and fdLog.c).  The data read from each pipe
+ * is split into lines, each logged as one message, subject to the application's rate limit.
+ * Alternatively, an application's output can be spliced straight into a log file of its own.
+ *
+ * The messages the Log Control Daemon logs can also be kept in a persistent log store (see
+ * logStore.h), which the log control tool can query.  While the store is enabled, each running
+ * process is also handed a datagram socket through which it sends the messages its components log
+ * (see LOG_CMD_SET_STORE_SOCKET), so that they are kept in the store too.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -67,6 +77,8 @@
 #include "logDaemon.h"
 #include "limit.h"
 #include "fileDescriptor.h"
+#include "logStore.h"
+#include "fdLog.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -223,6 +235,9 @@ typedef struct
     pid_t               pid;            ///< The process ID.
     le_msg_SessionRef_t ipcSessionRef;  ///< Reference to the IPC session connected to this process.
     le_dls_List_t       logSessionList; ///< List of log sessions in this process.
+    int                 storeFd;        ///< Socket the process sends its messages to the log
+                                        ///  store through (-1 if the store is disabled).
+    le_fdMonitor_Ref_t  storeMonitorRef;///< Monitor of the log store socket.
 /* TODO: Implement shared memory.
     void*               sharedMemAddr;  ///< Address of base of memory region shared with
                                         ///  this process.
@@ -303,36 +318,12 @@ static le_mem_PoolRef_t TracePoolRef;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * File descriptor logging object.
- *
- * Stores info about a file descriptor to be logged.
- **/
-//--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    char            appName[LIMIT_MAX_APP_NAME_BYTES];      ///< App name.
-    char            procName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Process name.
-    int             pid;                                    ///< PID of the process.
-    le_log_Level_t  level;                                  ///< Log level.
-    le_fdMonitor_Ref_t monitorRef;                          ///< Monitor object.
-}
-FdLog_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Pool for file descriptor logging objects.
+ * Maximum number of messages read from a process's log store socket each time it becomes readable.
  */
 //--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t FdLogPoolRef;
+#define STORE_MAX_READS         16
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Maximum length of log messages.
- */
-//--------------------------------------------------------------------------------------------------
-#define MAX_MSG_SIZE            256
 
 
 
@@ -705,6 +696,171 @@ static inline RunningProcess_t* FindProcessByIpcSession
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a message received through a process's log store socket to the log store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StoreProcessMsg
+(
+    const RunningProcess_t* runningProcObjPtr,  ///< [IN] Process that sent the message.
+    char* buffPtr                               ///< [IN] Message received (null-terminated).
+)
+{
+    int level = buffPtr[0] - '0';
+    char* slashPtr = strchr(buffPtr, '/');
+
+    if ((level < LE_LOG_DEBUG) || (level > LE_LOG_EMERG) || (slashPtr == NULL))
+    {
+        LE_DEBUG("Malformed log store message from pid %d.", runningProcObjPtr->pid);
+        return;
+    }
+
+    *slashPtr = '\0';
+
+    logStore_Add(level,
+                 runningProcObjPtr->procNameObjPtr->name,
+                 runningProcObjPtr->pid,
+                 buffPtr + 1,
+                 slashPtr + 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the messages a process sent through its log store socket.
+ *
+ * Only a few messages are read each time the socket becomes readable, so a process that logs a lot
+ * can't keep the log daemon from serving the others.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadStoreSocket
+(
+    int   fd,
+    short events
+)
+{
+    RunningProcess_t* runningProcObjPtr = le_fdMonitor_GetContextPtr();
+    char buff[LOG_MAX_STORE_MSG_BYTES + 1];
+    int i;
+
+    for (i = 0; i < STORE_MAX_READS; i++)
+    {
+        ssize_t count = recv(fd, buff, sizeof(buff) - 1, MSG_DONTWAIT);
+
+        if (count <= 0)
+        {
+            break;
+        }
+
+        buff[count] = '\0';
+        StoreProcessMsg(runningProcObjPtr, buff);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hands a running process a socket through which it sends the messages its components log to the
+ * log store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartProcessStore
+(
+    RunningProcess_t* runningProcObjPtr
+)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0)
+    {
+        LE_ERROR("Failed to create log store socket for pid %d (%m).", runningProcObjPtr->pid);
+        return;
+    }
+
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(runningProcObjPtr->ipcSessionRef);
+
+    snprintf(le_msg_GetPayloadPtr(msgRef),
+             le_msg_GetMaxPayloadSize(msgRef),
+             "%c*/1",
+             LOG_CMD_SET_STORE_SOCKET);
+    le_msg_SetFd(msgRef, fds[1]);
+    le_msg_Send(msgRef);
+
+    runningProcObjPtr->storeFd = fds[0];
+    runningProcObjPtr->storeMonitorRef = le_fdMonitor_Create("LogStore",
+                                                             fds[0],
+                                                             ReadStoreSocket,
+                                                             0);
+    le_fdMonitor_SetContextPtr(runningProcObjPtr->storeMonitorRef, runningProcObjPtr);
+    le_fdMonitor_Enable(runningProcObjPtr->storeMonitorRef, POLLIN);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes a running process's log store socket, if it has one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopProcessStore
+(
+    RunningProcess_t* runningProcObjPtr,
+    bool isRunning                          ///< [IN] true to tell the process to stop sending.
+)
+{
+    if (runningProcObjPtr->storeFd < 0)
+    {
+        return;
+    }
+
+    le_fdMonitor_Delete(runningProcObjPtr->storeMonitorRef);
+    runningProcObjPtr->storeMonitorRef = NULL;
+    fd_Close(runningProcObjPtr->storeFd);
+    runningProcObjPtr->storeFd = -1;
+
+    if (isRunning)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(runningProcObjPtr->ipcSessionRef);
+
+        snprintf(le_msg_GetPayloadPtr(msgRef),
+                 le_msg_GetMaxPayloadSize(msgRef),
+                 "%c*/0",
+                 LOG_CMD_SET_STORE_SOCKET);
+        le_msg_Send(msgRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hands all running processes a log store socket if the log store is enabled, or closes them if
+ * it is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateProcessStores
+(
+    void
+)
+{
+    bool isEnabled = logStore_IsEnabled();
+    le_hashmap_It_Ref_t iteratorRef = le_hashmap_GetIterator(ProcessIdMapRef);
+
+    while (le_hashmap_NextNode(iteratorRef) == LE_OK)
+    {
+        RunningProcess_t* runningProcObjPtr = le_hashmap_GetValue(iteratorRef);
+
+        if (!isEnabled)
+        {
+            StopProcessStore(runningProcObjPtr, true);
+        }
+        else if (runningProcObjPtr->storeFd < 0)
+        {
+            StartProcessStore(runningProcObjPtr);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a Running Process object.
@@ -730,11 +886,18 @@ static RunningProcess_t* CreateRunningProcess
 
     objPtr->pid = pid;
     objPtr->ipcSessionRef = ipcSessionRef;
+    objPtr->storeFd = -1;
+    objPtr->storeMonitorRef = NULL;
 //    objPtr->sharedMemAddr = NULL;   // TODO: Implement shared memory.
 
     le_hashmap_Put(ProcessIdMapRef, &objPtr->pid, objPtr);
     le_hashmap_Put(IpcSessionMapRef, &objPtr->ipcSessionRef, objPtr);
 
+    if (logStore_IsEnabled())
+    {
+        StartProcessStore(objPtr);
+    }
+
     return objPtr;
 }
 
@@ -991,9 +1154,9 @@ static bool ParseCmdPacket
         }
     }
 
-    if (commandCode == LOG_CMD_FORGET_PROCESS)
+    if ((commandCode == LOG_CMD_FORGET_PROCESS) || (commandCode == LOG_CMD_SET_STORE_SIZE))
     {
-        // The forget process command has only a process name argument
+        // The forget process and store size commands have only a process name (or size) argument
         // (terminated by '/' for consistency with other commands).
         return true;
     }
@@ -1474,6 +1637,8 @@ static void ClientIpcSessionClosed
              procNameObjPtr->name,
              runningProcObjPtr->pid);
 
+    StopProcessStore(runningProcObjPtr, false);
+
     // Remove the process from the PID and IPC Session hash maps.
     le_hashmap_Remove(ProcessIdMapRef, &runningProcObjPtr->pid);
     le_hashmap_Remove(IpcSessionMapRef, &ipcSessionRef);
@@ -2457,6 +2622,63 @@ static void ForgetProcess
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables (with a given size) or disables the persistent log store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetStoreSize
+(
+    const char* sizeStr,                    ///< [IN] Size (KiB), or "0" to disable the store.
+    le_msg_SessionRef_t toolIpcSessionRef   ///< [IN] Log tool's IPC session.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char message[128];
+    char* endPtr;
+
+    errno = 0;
+    unsigned long kBytes = strtoul(sizeStr, &endPtr, 10);
+
+    if ((errno != 0) || (endPtr == sizeStr) || (*endPtr != '\0'))
+    {
+        snprintf(message, sizeof(message), "***ERROR: Invalid log store size '%s'.", sizeStr);
+        SendToLogTool(toolIpcSessionRef, message);
+        return;
+    }
+
+    switch (logStore_SetSize(kBytes))
+    {
+        case LE_OK:
+            UpdateProcessStores();
+
+            if (kBytes == 0)
+            {
+                snprintf(message, sizeof(message), "Log store disabled.");
+            }
+            else
+            {
+                snprintf(message, sizeof(message), "Log store enabled (%lu KiB).", kBytes);
+            }
+            break;
+
+        case LE_OUT_OF_RANGE:
+            snprintf(message,
+                     sizeof(message),
+                     "***ERROR: Log store size must be 0, or %d to %d KiB.",
+                     LOGSTORE_MIN_KBYTES,
+                     LOGSTORE_MAX_KBYTES);
+            break;
+
+        default:
+            snprintf(message, sizeof(message), "***ERROR: Failed to set up the log store.");
+            break;
+    }
+
+    SendToLogTool(toolIpcSessionRef, message);
+}
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -2583,6 +2805,12 @@ static void ControlToolMsgReceiveHandler
 
                 break;
 
+            case LOG_CMD_SET_STORE_SIZE:
+
+                SetStoreSize(processName, ipcSessionRef);
+
+                break;
+
             default:
 
                 LE_ERROR("Unknown command byte '%c' received from log control tool.", command);
@@ -2597,120 +2825,6 @@ static void ControlToolMsgReceiveHandler
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Deletes the fd log object and monitor.  Closes the associated fd.
- */
-//--------------------------------------------------------------------------------------------------
-static void DeleteFdLog
-(
-    int fd,                     ///< [IN] Fd to close.
-    FdLog_t* fdLogPtr           ///< [IN] Fd log object to delete.
-)
-{
-    // Delete the fd monitor.
-    le_fdMonitor_Delete(fdLogPtr->monitorRef);
-
-    // Close the fd.
-    fd_Close(fd);
-
-    // Delete the fd log object.
-    le_mem_Release(fdLogPtr);
-}
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Logs message received from the fd.
- */
-//--------------------------------------------------------------------------------------------------
-static void LogFdMessages
-(
-    int   fd,
-    short events
-)
-{
-    FdLog_t* fdLogPtr = le_fdMonitor_GetContextPtr();
-
-    if (events & POLLIN)
-    {
-        // Read the data from the fd.
-        char msg[MAX_MSG_SIZE] = {'\0'};
-
-        int c;
-
-        do
-        {
-            c = read(fd, msg, sizeof(msg));
-        }
-        while ( (c == -1) && (errno == EINTR) );
-
-        if (c == -1)
-        {
-            LE_ERROR("Could not read fd log message for app/process '%s/%s[%d]'.  %m.",
-                     fdLogPtr->appName, fdLogPtr->procName, fdLogPtr->pid);
-
-            DeleteFdLog(fd, fdLogPtr);
-        }
-
-        // Log the data.
-        // TODO: Don't log the app name for now so that it matches all the other log formats.  Add
-        //       the app name to all log messages at the same time.
-        log_LogGenericMsg(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, msg);
-    }
-
-    if ( (events & POLLRDHUP) || (events & POLLERR) || (events & POLLHUP) )
-    {
-        LE_DEBUG("Error on app/proc '%s/%s' log fd, events=%d.  Cannot log from this fd.",
-                fdLogPtr->appName, fdLogPtr->procName, events);
-
-        DeleteFdLog(fd, fdLogPtr);
-    }
-}
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Creates a monitor for an application process' file descriptor for logging.
- */
-//--------------------------------------------------------------------------------------------------
-static void CreateFdLogMonitor
-(
-    int fd,                     ///< [IN] File descriptor to log.
-    const char* appNamePtr,     ///< [IN] Name of the application.
-    const char* procNamePtr,    ///< [IN] Name of the process.
-    pid_t pid,                  ///< [IN] PID of the process.
-    le_log_Level_t logLevel,    ///< [IN] Level to log messages from this fd at.
-    const char* monitorNamePtr  ///< [IN] Name of monitor.
-)
-{
-    // Create fd log object.
-    FdLog_t* fdLogPtr = le_mem_ForceAlloc(FdLogPoolRef);
-
-    if (le_utf8_Copy(fdLogPtr->appName, appNamePtr, LIMIT_MAX_APP_NAME_BYTES, NULL) != LE_OK)
-    {
-        LE_KILL_CLIENT("App name '%s' too long.", appNamePtr);
-    }
-
-    if (le_utf8_Copy(fdLogPtr->procName, procNamePtr, LIMIT_MAX_PROCESS_NAME_BYTES, NULL) != LE_OK)
-    {
-        LE_KILL_CLIENT("Proc name '%s' too long.", procNamePtr);
-    }
-
-    fdLogPtr->level = logLevel;
-    fdLogPtr->pid = pid;
-
-    // Create the fd monitor.
-    fdLogPtr->monitorRef = le_fdMonitor_Create(monitorNamePtr, fd, LogFdMessages, 0);
-
-    // Set the fd monitor context.
-    le_fdMonitor_SetContextPtr(fdLogPtr->monitorRef, fdLogPtr);
-
-    // Enable the monitoring.
-    le_fdMonitor_Enable(fdLogPtr->monitorRef, POLLIN);
-}
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Registers an application process' standard error for logging.  Messages from this file descriptor
@@ -2744,7 +2858,10 @@ void logFd_StdErr
     char monitorName[LIMIT_MAX_PROCESS_NAME_BYTES + 6];
     LE_ASSERT(snprintf(monitorName, sizeof(monitorName), "%s%s", procName, "Stderr") < sizeof(monitorName));
 
-    CreateFdLogMonitor(fd, appName, procName, pid, LE_LOG_ERR, monitorName);
+    if (fdLog_Add(fd, appName, procName, pid, LE_LOG_ERR, monitorName) != LE_OK)
+    {
+        LE_KILL_CLIENT("App name '%s' or process name '%s' too long.", appName, procName);
+    }
 }
 
 
@@ -2781,7 +2898,44 @@ void logFd_StdOut
     char monitorName[LIMIT_MAX_PROCESS_NAME_BYTES + 6];
     LE_ASSERT(snprintf(monitorName, sizeof(monitorName), "%s%s", procName, "Stdout") < sizeof(monitorName));
 
-    CreateFdLogMonitor(fd, appName, procName, pid, LE_LOG_INFO, monitorName);
+    if (fdLog_Add(fd, appName, procName, pid, LE_LOG_INFO, monitorName) != LE_OK)
+    {
+        LE_KILL_CLIENT("App name '%s' or process name '%s' too long.", appName, procName);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets how the standard out and standard error of an application's processes are logged.  Applies
+ * to the file descriptors registered for the application afterwards, and to the rate limiting of
+ * those registered already.  Those already written to the app's log file go back to the system log
+ * if logFileBytes is 0.
+ */
+//--------------------------------------------------------------------------------------------------
+void logFd_SetAppLimits
+(
+    const char* appName,
+        ///< [IN]
+        ///< Name of the application.
+
+    uint32_t maxLinesPerSec,
+        ///< [IN]
+        ///< Average lines logged per second (0 = no limit).
+
+    uint32_t burstLines,
+        ///< [IN]
+        ///< Lines that can be logged at once.
+
+    uint32_t logFileBytes
+        ///< [IN]
+        ///< Maximum size of the app's log file (0 = log to the system log).
+)
+{
+    if (fdLog_SetAppLimits(appName, maxLinesPerSec, burstLines, logFileBytes) != LE_OK)
+    {
+        LE_KILL_CLIENT("App name '%s' too long.", appName);
+    }
 }
 
 
@@ -2800,7 +2954,6 @@ COMPONENT_INIT
     RunningProcessPoolRef = le_mem_CreatePool("RunningProcess", sizeof(RunningProcess_t));
     LogSessionPoolRef = le_mem_CreatePool("LogSession", sizeof(LogSession_t));
     TracePoolRef = le_mem_CreatePool("Traces", sizeof(Trace_t));
-    FdLogPoolRef = le_mem_CreatePool("FdLogs", sizeof(FdLog_t));
 
     // Tune the pools' initial sizes to reduce warnings in the log at start-up.
     // TODO: Make this configurable.
@@ -2810,7 +2963,6 @@ COMPONENT_INIT
     le_mem_ExpandPool(RunningProcessPoolRef, MAX_EXPECTED_PROCESSES);
     le_mem_ExpandPool(LogSessionPoolRef, MAX_EXPECTED_COMPONENTS);
     le_mem_ExpandPool(TracePoolRef, MAX_EXPECTED_TRACES);
-    le_mem_ExpandPool(FdLogPoolRef, MAX_EXPECTED_PROCESSES * 2); // Generally 2 fds per process (stderr, stdout).
 
     // Create the hash maps.
     ProcessNameMapRef = le_hashmap_Create("ProcessName",
@@ -2826,6 +2978,9 @@ COMPONENT_INIT
                                           ProcessIdHash,
                                           ProcessIdEquals);
 
+    fdLog_Init();
+    logStore_Init();
+
     // Get a reference to the Log Control Protocol identification.
     le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(LOG_CONTROL_PROTOCOL_ID,
                                                              LOG_MAX_CMD_PACKET_BYTES);
@@ -46,6 +46,16 @@
 #define LOG_MAX_CMD_PACKET_BYTES        300
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The maximum size in bytes of the messages that components send through the log store socket (see
+ * LOG_CMD_SET_STORE_SOCKET).  Each datagram holds one message logged: its level as a digit
+ * ('0' + le_log_Level_t), the component name, a '/', then the message (not null-terminated).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_MAX_STORE_MSG_BYTES         512
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The log control service's well known service instance name.
@@ -96,6 +106,16 @@
 #define LOG_CMD_REG_COMPONENT           'r' // CommandData = string containing the process ID.
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logging commands that can be sent from the log daemon to the components only.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_CMD_SET_STORE_SOCKET        'S' // CommandData = "1" with the fd of a datagram socket
+                                            // to send the messages logged to for the log store,
+                                            // or "0" to stop.  The ComponentName is ignored.
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Logging commands that can be sent from the log tool to the log daemon only.
@@ -103,6 +123,8 @@
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_LIST_COMPONENTS         'c' // No ProcessName, ComponentName, or CommandData
 #define LOG_CMD_FORGET_PROCESS          'x' // No ComponentName or CommandData
+#define LOG_CMD_SET_STORE_SIZE          's' // Log store size (KiB) in place of ProcessName, and
+                                            // no ComponentName or CommandData
 
 
 // =======================================================
@@ -0,0 +1,493 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file logStore.c
+ *
+ * Implementation of the persistent log store (see logStore.h for the file format).
+ *
+ * The store is enabled by the log control tool ("log store SIZE"), and stays enabled across
+ * restarts for as long as its file exists.  Messages are written straight into the memory-mapped
+ * file, so adding a message costs no system call, and the block just completed is flushed
+ * asynchronously each time a new block is started.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "logStore.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The store's memory mapping (NULL if the store is disabled), and its size.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* StorePtr = NULL;
+static size_t StoreBytes;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The store's header and index, in the memory mapping.
+ */
+//--------------------------------------------------------------------------------------------------
+static logStore_Header_t* HeaderPtr;
+static logStore_IndexEntry_t* IndexPtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block that records are being added to, offset of the next record in it, and generation number
+ * of the next block to be started.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CurrentBlock;
+static size_t CurrentOffset;
+static uint32_t NextGeneration;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset of the first block in a store with a given number of blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetDataOffset
+(
+    uint32_t blockCount         ///< [IN] Number of blocks.
+)
+{
+    size_t indexEnd = LOGSTORE_INDEX_OFFSET + (blockCount * sizeof(logStore_IndexEntry_t));
+
+    return (indexEnd + LOGSTORE_BLOCK_BYTES - 1) & ~(size_t)(LOGSTORE_BLOCK_BYTES - 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to a record in the store.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline logStore_Record_t* GetRecord
+(
+    uint32_t block,             ///< [IN] Block index.
+    size_t offset               ///< [IN] Offset of the record in the block.
+)
+{
+    return (logStore_Record_t*)(StorePtr + HeaderPtr->dataOffset +
+                                ((size_t)block * LOGSTORE_BLOCK_BYTES) + offset);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find where to add the next record in a store that was just opened: after the last valid record
+ * of the block with the newest generation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Recover
+(
+    void
+)
+{
+    // Start with block 0 if the store is empty.
+    CurrentBlock = logStore_GetNewestBlock(IndexPtr, HeaderPtr->blockCount);
+    CurrentOffset = LOGSTORE_BLOCK_BYTES;
+
+    uint32_t maxGeneration = IndexPtr[CurrentBlock].generation;
+
+    if (maxGeneration == 0)
+    {
+        NextGeneration = 1;
+        return;
+    }
+
+    // Generation 0 means "never used".
+    NextGeneration = maxGeneration + 1;
+    if (NextGeneration == 0)
+    {
+        NextGeneration = 1;
+    }
+
+    size_t offset = 0;
+
+    while (offset + sizeof(logStore_Record_t) <= LOGSTORE_BLOCK_BYTES)
+    {
+        logStore_Record_t* recordPtr = GetRecord(CurrentBlock, offset);
+
+        // The records after the last one are left over from the block's previous generation (or
+        // were never written).
+        if ((recordPtr->length == 0) || (recordPtr->generation != maxGeneration))
+        {
+            break;
+        }
+
+        if (   (recordPtr->length < sizeof(logStore_Record_t))
+            || (offset + recordPtr->length > LOGSTORE_BLOCK_BYTES)
+            || (logStore_RecordCrc(recordPtr) != recordPtr->crc))
+        {
+            // A record that was not completely written.  Don't write after it, in case valid
+            // records of this generation follow, but start a new block.
+            offset = LOGSTORE_BLOCK_BYTES;
+            break;
+        }
+
+        offset += recordPtr->length;
+    }
+
+    CurrentOffset = offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the store, if it is open.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Close
+(
+    void
+)
+{
+    if (StorePtr != NULL)
+    {
+        (void)msync(StorePtr, StoreBytes, MS_SYNC);
+        munmap(StorePtr, StoreBytes);
+        StorePtr = NULL;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the store file and map it in memory.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the store does not exist.
+ *      LE_FORMAT_ERROR if the file is not a valid store.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Open
+(
+    void
+)
+{
+    int fd = open(LOGSTORE_PATH, O_RDWR | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        LE_ERROR("Failed to open '%s' (%m).", LOGSTORE_PATH);
+        return LE_FAULT;
+    }
+
+    struct stat st;
+    logStore_Header_t header;
+
+    if (   (fstat(fd, &st) != 0)
+        || (pread(fd, &header, sizeof(header), 0) != sizeof(header)))
+    {
+        LE_ERROR("Failed to read '%s' (%m).", LOGSTORE_PATH);
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    if (   (header.magic != LOGSTORE_MAGIC)
+        || (header.version != LOGSTORE_VERSION)
+        || (header.blockBytes != LOGSTORE_BLOCK_BYTES)
+        || (header.blockCount == 0)
+        || (header.blockCount > (LOGSTORE_MAX_KBYTES * 1024) / LOGSTORE_BLOCK_BYTES)
+        || (header.dataOffset != GetDataOffset(header.blockCount))
+        || (st.st_size != (off_t)header.dataOffset +
+                          ((off_t)header.blockCount * LOGSTORE_BLOCK_BYTES)))
+    {
+        LE_ERROR("'%s' is not a valid log store.", LOGSTORE_PATH);
+        fd_Close(fd);
+        return LE_FORMAT_ERROR;
+    }
+
+    void* mapPtr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    fd_Close(fd);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map '%s' (%m).", LOGSTORE_PATH);
+        return LE_FAULT;
+    }
+
+    StorePtr = mapPtr;
+    StoreBytes = st.st_size;
+    HeaderPtr = mapPtr;
+    IndexPtr = (logStore_IndexEntry_t*)(StorePtr + LOGSTORE_INDEX_OFFSET);
+
+    Recover();
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an empty store, replacing any existing one.  The new store is fully written under a
+ * temporary name before it replaces the old one.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Create
+(
+    uint32_t blockCount         ///< [IN] Number of blocks.
+)
+{
+    const char* tmpPathPtr = LOGSTORE_PATH ".new";
+    logStore_Header_t header =
+    {
+        .magic = LOGSTORE_MAGIC,
+        .version = LOGSTORE_VERSION,
+        .blockBytes = LOGSTORE_BLOCK_BYTES,
+        .blockCount = blockCount,
+        .dataOffset = GetDataOffset(blockCount)
+    };
+
+    int fd = open(tmpPathPtr, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", tmpPathPtr);
+        return LE_FAULT;
+    }
+
+    if (   (ftruncate(fd, (off_t)header.dataOffset + ((off_t)blockCount * LOGSTORE_BLOCK_BYTES))
+            != 0)
+        || (pwrite(fd, &header, sizeof(header), 0) != sizeof(header))
+        || (fsync(fd) != 0))
+    {
+        LE_ERROR("Failed to write '%s' (%m).", tmpPathPtr);
+        fd_Close(fd);
+        (void)unlink(tmpPathPtr);
+        return LE_FAULT;
+    }
+
+    fd_Close(fd);
+
+    if (rename(tmpPathPtr, LOGSTORE_PATH) != 0)
+    {
+        LE_ERROR("Failed to rename '%s' to '%s' (%m).", tmpPathPtr, LOGSTORE_PATH);
+        (void)unlink(tmpPathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new block: the one after the current block (the oldest one).
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartBlock
+(
+    uint64_t timeUs             ///< [IN] Time of the block's first record.
+)
+{
+    // Flush the block just completed, and the index.
+    (void)msync(GetRecord(CurrentBlock, 0), LOGSTORE_BLOCK_BYTES, MS_ASYNC);
+    (void)msync(StorePtr, HeaderPtr->dataOffset, MS_ASYNC);
+
+    CurrentBlock = (CurrentBlock + 1) % HeaderPtr->blockCount;
+    CurrentOffset = 0;
+
+    logStore_IndexEntry_t* entryPtr = &IndexPtr[CurrentBlock];
+
+    // Invalidate the block's old records before the summary is cleared.
+    entryPtr->generation = 0;
+    entryPtr->levelMask = 0;
+    entryPtr->minTimeUs = timeUs;
+    entryPtr->maxTimeUs = timeUs;
+    entryPtr->pidMask = 0;
+    entryPtr->nameMask = 0;
+    entryPtr->compMask = 0;
+    __atomic_store_n(&entryPtr->generation, NextGeneration, __ATOMIC_RELEASE);
+
+    // Generation 0 means "never used".
+    NextGeneration++;
+    if (NextGeneration == 0)
+    {
+        NextGeneration = 1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the log store if it exists, so that messages are added to it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Init
+(
+    void
+)
+{
+    if (Open() == LE_OK)
+    {
+        LE_INFO("Log store enabled (%" PRIu32 " KiB).",
+                (HeaderPtr->blockCount * LOGSTORE_BLOCK_BYTES) / 1024);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable the log store with a given size, or disable it (and delete it).  An existing store of the
+ * same size is kept.  A store of a different size is replaced by an empty one.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OUT_OF_RANGE if the size is not valid.
+ *      LE_FAULT if the store could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_SetSize
+(
+    size_t kBytes               ///< [IN] Size of the store (KiB), or 0 to disable it.
+)
+{
+    if (kBytes == 0)
+    {
+        Close();
+
+        if ((unlink(LOGSTORE_PATH) != 0) && (errno != ENOENT))
+        {
+            LE_ERROR("Failed to delete '%s' (%m).", LOGSTORE_PATH);
+            return LE_FAULT;
+        }
+
+        return LE_OK;
+    }
+
+    if ((kBytes < LOGSTORE_MIN_KBYTES) || (kBytes > LOGSTORE_MAX_KBYTES))
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    uint32_t blockCount = (kBytes * 1024) / LOGSTORE_BLOCK_BYTES;
+
+    if ((StorePtr != NULL) && (HeaderPtr->blockCount == blockCount))
+    {
+        return LE_OK;
+    }
+
+    Close();
+
+    if ((Create(blockCount) != LE_OK) || (Open() != LE_OK))
+    {
+        return LE_FAULT;
+    }
+
+    LE_INFO("Log store enabled (%zu KiB).", kBytes);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the log store is enabled.
+ *
+ * @return true if messages are added to the store.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logStore_IsEnabled
+(
+    void
+)
+{
+    return (StorePtr != NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a message to the log store (if it is enabled).
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Add
+(
+    le_log_Level_t level,       ///< [IN] Message level.
+    const char* procNamePtr,    ///< [IN] Name of the process that logged the message.
+    pid_t pid,                  ///< [IN] PID of the process that logged the message.
+    const char* compNamePtr,    ///< [IN] Name of the component that logged the message ("" if
+                                ///       not logged by a component).
+    const char* msgPtr          ///< [IN] Message.
+)
+{
+    if (StorePtr == NULL)
+    {
+        return;
+    }
+
+    size_t nameLen = strnlen(procNamePtr, UINT8_MAX);
+    size_t compLen = strnlen(compNamePtr, UINT8_MAX);
+    size_t maxMsgLen = LOGSTORE_BLOCK_BYTES - sizeof(logStore_Record_t) - nameLen - compLen;
+    size_t msgLen = strnlen(msgPtr, maxMsgLen);
+    size_t length = (sizeof(logStore_Record_t) + nameLen + compLen + msgLen + 7) & ~(size_t)7;
+
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+    uint64_t timeUs = ((uint64_t)now.sec * 1000000) + now.usec;
+
+    if (CurrentOffset + length > LOGSTORE_BLOCK_BYTES)
+    {
+        StartBlock(timeUs);
+    }
+
+    // Widen the block's summary before the record is written, so that it always covers all of the
+    // block's valid records.
+    logStore_IndexEntry_t* entryPtr = &IndexPtr[CurrentBlock];
+
+    entryPtr->levelMask |= (uint32_t)1 << level;
+    entryPtr->pidMask |= logStore_PidBit(pid);
+    entryPtr->nameMask |= logStore_NameBit(procNamePtr, nameLen);
+    entryPtr->compMask |= logStore_NameBit(compNamePtr, compLen);
+    if (timeUs < entryPtr->minTimeUs)
+    {
+        entryPtr->minTimeUs = timeUs;
+    }
+    if (timeUs > entryPtr->maxTimeUs)
+    {
+        entryPtr->maxTimeUs = timeUs;
+    }
+
+    logStore_Record_t* recordPtr = GetRecord(CurrentBlock, CurrentOffset);
+    char* textPtr = (char*)(recordPtr + 1);
+    size_t textLen = nameLen + compLen + msgLen;
+
+    recordPtr->generation = entryPtr->generation;
+    recordPtr->timeUs = timeUs;
+    recordPtr->pid = pid;
+    recordPtr->length = length;
+    recordPtr->msgLen = msgLen;
+    recordPtr->level = level;
+    recordPtr->nameLen = nameLen;
+    recordPtr->compLen = compLen;
+    memset(recordPtr->reserved, 0, sizeof(recordPtr->reserved));
+    memcpy(textPtr, procNamePtr, nameLen);
+    memcpy(textPtr + nameLen, compNamePtr, compLen);
+    memcpy(textPtr + nameLen + compLen, msgPtr, msgLen);
+    memset(textPtr + textLen, 0, length - sizeof(logStore_Record_t) - textLen);
+
+    // Written last, as it makes the record valid.
+    __atomic_store_n(&recordPtr->crc, logStore_RecordCrc(recordPtr), __ATOMIC_RELEASE);
+
+    CurrentOffset += length;
+}
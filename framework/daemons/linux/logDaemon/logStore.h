@@ -0,0 +1,441 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file logStore.h
+ *
+ * Persistent log store definitions, shared by the Log Control Daemon (which writes the store) and
+ * the log control tool (which queries it).
+ *
+ * The store is a fixed-size file, memory-mapped by the daemon, that keeps the most recent messages
+ * logged by the components of all processes (which send them to the daemon) and by the daemon
+ * itself (the standard output and error of apps) in a ring of fixed-size blocks:
+ *
+ * @verbatim
+    +--------+-------------------------------+---------+---------+-----+---------+
+    | header | index (one entry per block)   | block 0 | block 1 | ... | block N |
+    +--------+-------------------------------+---------+---------+-----+---------+
+@endverbatim
+ *
+ * Each block holds whole records (a record never spans two blocks).  Each index entry summarizes
+ * its block: the time range, the levels, and 64-bit "bloom" masks of the PIDs, the process names
+ * and the component names of its records.  A query only reads the blocks whose summary matches its
+ * filters.
+ *
+ * Every time a block is (re)started it gets a new generation number, which is stored in its index
+ * entry and in each of its records.  A record is only valid if its generation matches its index
+ * entry's and its CRC is correct, so the records left over from a block's previous use, and those
+ * that were being written when the device crashed or lost power, are ignored.  The index entry is
+ * widened before a record is written, so it never misses a valid record.
+ *
+ * Generation numbers wrap around (skipping 0), so they are compared with serial number arithmetic
+ * (see logStore_IsNewer()): the generations of the blocks in a store are always within a store's
+ * block count of each other.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_LOG_STORE_H_INCLUDE_GUARD
+#define LEGATO_LOG_STORE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Absolute file system path of the log store.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LOGSTORE_PATH
+#define LOGSTORE_PATH           "/legato/logStore"
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of a log store ("LGST"), and format version.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGSTORE_MAGIC          0x5453474cU
+#define LOGSTORE_VERSION        2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a block (bytes).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGSTORE_BLOCK_BYTES    4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits on the size of the store (KiB).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGSTORE_MIN_KBYTES     16
+#define LOGSTORE_MAX_KBYTES     (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offset of the index in the store file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOGSTORE_INDEX_OFFSET   64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store header.  The magic number is written last when a store is created.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;             ///< LOGSTORE_MAGIC.
+    uint32_t version;           ///< LOGSTORE_VERSION.
+    uint32_t blockBytes;        ///< LOGSTORE_BLOCK_BYTES.
+    uint32_t blockCount;        ///< Number of blocks.
+    uint32_t dataOffset;        ///< Offset of block 0 in the file.
+}
+logStore_Header_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index entry, summarizing the records of one block.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t generation;        ///< Block's generation (0 if the block was never used).
+    uint32_t levelMask;         ///< Bit (1 << level) set for each level in the block.
+    uint64_t minTimeUs;         ///< Time of the earliest record (us since the Epoch).
+    uint64_t maxTimeUs;         ///< Time of the latest record (us since the Epoch).
+    uint64_t pidMask;           ///< Bloom mask of the records' PIDs (see logStore_PidBit()).
+    uint64_t nameMask;          ///< Bloom mask of the records' process names.
+    uint64_t compMask;          ///< Bloom mask of the records' component names.
+}
+logStore_IndexEntry_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record header.  The record's process name, component name, then message follow it (none of them
+ * null-terminated).  The record is padded to a multiple of 8 bytes.
+ *
+ * A length of 0 marks the end of the records in a block.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t crc;               ///< CRC32 of the rest of the record (from the generation on).
+    uint32_t generation;        ///< Generation of the block when the record was written.
+    uint64_t timeUs;            ///< Time the message was logged (us since the Epoch).
+    int32_t pid;                ///< PID of the process that logged the message.
+    uint16_t length;            ///< Length of the record, including this header and padding.
+    uint16_t msgLen;            ///< Length of the message.
+    uint8_t level;              ///< Message level (le_log_Level_t).
+    uint8_t nameLen;            ///< Length of the process name.
+    uint8_t compLen;            ///< Length of the component name (0 if none).
+    uint8_t reserved[5];
+}
+logStore_Record_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer big enough for any record, to copy a record into before it is checked.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef union
+{
+    logStore_Record_t record;
+    uint8_t bytes[LOGSTORE_BLOCK_BYTES];
+}
+logStore_RecordBuffer_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Filter used to select messages from the log store.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t minTimeUs;         ///< Earliest time (us since the Epoch).
+    uint64_t maxTimeUs;         ///< Latest time (us since the Epoch).
+    uint32_t levelMask;         ///< Bit (1 << level) set for each level to select.
+    int32_t pid;                ///< PID, or -1 for all.
+    const char* namePtr;        ///< Process name, or NULL for all.
+    size_t nameLen;             ///< Length of the process name.
+    const char* compPtr;        ///< Component name, or NULL for all.
+    size_t compLen;             ///< Length of the component name.
+}
+logStore_Filter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a record's bloom bit for a PID.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t logStore_PidBit
+(
+    int32_t pid                 ///< [IN] PID.
+)
+{
+    return (uint64_t)1 << (((uint32_t)pid * 2654435761U) >> 26);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a record's bloom bit for a process or component name.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t logStore_NameBit
+(
+    const char* namePtr,        ///< [IN] Name (not null-terminated).
+    size_t nameLen              ///< [IN] Length of the name.
+)
+{
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < nameLen; i++)
+    {
+        hash = (hash ^ (uint8_t)namePtr[i]) * 16777619U;
+    }
+
+    return (uint64_t)1 << (hash >> 26);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the CRC of a record (whose length has been checked).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t logStore_RecordCrc
+(
+    const logStore_Record_t* recordPtr  ///< [IN] Record.
+)
+{
+    return le_crc_Crc32((uint8_t*)&recordPtr->generation,
+                        recordPtr->length - offsetof(logStore_Record_t, generation),
+                        LE_CRC_START_CRC32);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a generation is newer than another one (both non-zero).
+ *
+ * @return true if generation a was started after generation b.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool logStore_IsNewer
+(
+    uint32_t a,                 ///< [IN] Generation.
+    uint32_t b                  ///< [IN] Generation.
+)
+{
+    return ((int32_t)(a - b) > 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the block that records are being added to: the one with the newest generation.
+ *
+ * @return The newest block, or the last block if the store is empty (so that the block after it is
+ *         block 0).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t logStore_GetNewestBlock
+(
+    const logStore_IndexEntry_t* indexPtr,  ///< [IN] Index.
+    uint32_t blockCount                     ///< [IN] Number of blocks.
+)
+{
+    uint32_t newestBlock = blockCount - 1;
+    uint32_t newestGeneration = 0;
+    uint32_t i;
+
+    for (i = 0; i < blockCount; i++)
+    {
+        uint32_t generation = indexPtr[i].generation;
+
+        if (   (generation != 0)
+            && ((newestGeneration == 0) || logStore_IsNewer(generation, newestGeneration)))
+        {
+            newestGeneration = generation;
+            newestBlock = i;
+        }
+    }
+
+    return newestBlock;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a record of a block and check that it is valid.  The record is copied before it is checked,
+ * as the Log Control Daemon may be overwriting it.
+ *
+ * @return The length of the record, or 0 if there is no valid record at this offset (which ends
+ *         the block's records).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t logStore_CopyRecord
+(
+    const uint8_t* blockPtr,            ///< [IN] Block.
+    size_t offset,                      ///< [IN] Offset of the record in the block.
+    uint32_t generation,                ///< [IN] Block's generation, from its index entry.
+    logStore_RecordBuffer_t* bufPtr     ///< [OUT] Copy of the record.
+)
+{
+    if (offset + sizeof(logStore_Record_t) > LOGSTORE_BLOCK_BYTES)
+    {
+        return 0;
+    }
+
+    memcpy(&bufPtr->record, blockPtr + offset, sizeof(bufPtr->record));
+
+    size_t length = bufPtr->record.length;
+
+    if (   (bufPtr->record.generation != generation)
+        || (length < sizeof(logStore_Record_t))
+        || (offset + length > LOGSTORE_BLOCK_BYTES)
+        || (  bufPtr->record.nameLen + bufPtr->record.compLen + bufPtr->record.msgLen
+            > length - sizeof(logStore_Record_t)))
+    {
+        return 0;
+    }
+
+    memcpy(bufPtr->bytes + sizeof(bufPtr->record),
+           blockPtr + offset + sizeof(bufPtr->record),
+           length - sizeof(bufPtr->record));
+
+    if (logStore_RecordCrc(&bufPtr->record) != bufPtr->record.crc)
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a block of the log store may hold messages that match a filter, using its index
+ * entry only.
+ *
+ * @return true if the block must be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool logStore_IsBlockMatching
+(
+    const logStore_IndexEntry_t* entryPtr,  ///< [IN] Block's index entry.
+    const logStore_Filter_t* filterPtr      ///< [IN] Filter.
+)
+{
+    return    (entryPtr->generation != 0)
+           && (entryPtr->maxTimeUs >= filterPtr->minTimeUs)
+           && (entryPtr->minTimeUs <= filterPtr->maxTimeUs)
+           && ((entryPtr->levelMask & filterPtr->levelMask) != 0)
+           && (   (filterPtr->pid < 0)
+               || ((entryPtr->pidMask & logStore_PidBit(filterPtr->pid)) != 0))
+           && (   (filterPtr->namePtr == NULL)
+               || ((entryPtr->nameMask &
+                    logStore_NameBit(filterPtr->namePtr, filterPtr->nameLen)) != 0))
+           && (   (filterPtr->compPtr == NULL)
+               || ((entryPtr->compMask &
+                    logStore_NameBit(filterPtr->compPtr, filterPtr->compLen)) != 0));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a (valid) record of the log store matches a filter.
+ *
+ * @return true if the record is selected.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool logStore_IsRecordMatching
+(
+    const logStore_Record_t* recordPtr,     ///< [IN] Record.
+    const logStore_Filter_t* filterPtr      ///< [IN] Filter.
+)
+{
+    return    (recordPtr->timeUs >= filterPtr->minTimeUs)
+           && (recordPtr->timeUs <= filterPtr->maxTimeUs)
+           && ((((uint32_t)1 << recordPtr->level) & filterPtr->levelMask) != 0)
+           && ((filterPtr->pid < 0) || (recordPtr->pid == filterPtr->pid))
+           && (   (filterPtr->namePtr == NULL)
+               || (   (recordPtr->nameLen == filterPtr->nameLen)
+                   && (memcmp(recordPtr + 1, filterPtr->namePtr, filterPtr->nameLen) == 0)))
+           && (   (filterPtr->compPtr == NULL)
+               || (   (recordPtr->compLen == filterPtr->compLen)
+                   && (memcmp((const char*)(recordPtr + 1) + recordPtr->nameLen,
+                              filterPtr->compPtr,
+                              filterPtr->compLen) == 0)));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the log store if it exists, so that messages are added to it.
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable the log store with a given size, or disable it (and delete it).  An existing store of the
+ * same size is kept.  A store of a different size is replaced by an empty one.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OUT_OF_RANGE if the size is not valid.
+ *      LE_FAULT if the store could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logStore_SetSize
+(
+    size_t kBytes               ///< [IN] Size of the store (KiB), or 0 to disable it.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the log store is enabled.
+ *
+ * @return true if messages are added to the store.
+ */
+//--------------------------------------------------------------------------------------------------
+bool logStore_IsEnabled
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a message to the log store (if it is enabled).
+ */
+//--------------------------------------------------------------------------------------------------
+void logStore_Add
+(
+    le_log_Level_t level,       ///< [IN] Message level.
+    const char* procNamePtr,    ///< [IN] Name of the process that logged the message.
+    pid_t pid,                  ///< [IN] PID of the process that logged the message.
+    const char* compNamePtr,    ///< [IN] Name of the component that logged the message ("" if
+                                ///       not logged by a component).
+    const char* msgPtr          ///< [IN] Message.
+);
+
+
+#endif // LEGATO_LOG_STORE_H_INCLUDE_GUARD
@@ -2089,6 +2089,72 @@ static void SdirToolList
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer used to write the JSON output of the 'sdir' tool's requests (bytes).  Much
+ * larger than any single token written (names of at most LIMIT_MAX_IPC_INTERFACE_NAME_BYTES or
+ * LIMIT_MAX_PROTOCOL_ID_BYTES, which escaping makes at most 6 times longer), so that the writer
+ * never fails with LE_OVERFLOW.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SDIR_JSON_BUFFER_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a string member of a JSON object.  A string that is not valid UTF-8 is written as null.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteJsonStringMember
+(
+    le_json_Writer_t* writerPtr,    ///< [in] The JSON writer.
+    const char* namePtr,            ///< [in] The member name.
+    const char* valuePtr            ///< [in] The member value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_json_WriteMember(writerPtr, namePtr);
+
+    if (le_json_WriteString(writerPtr, valuePtr) == LE_FORMAT_ERROR)
+    {
+        le_json_WriteNull(writerPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a JSON object member that identifies an interface of a user or app, in the form
+ * "<memberName>":{"<app|user>":"<name>","interface":"<interfaceName>"}.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteJsonInterface
+(
+    le_json_Writer_t* writerPtr,    ///< [in] The JSON writer.
+    const char* memberNamePtr,      ///< [in] The member name ("client" or "service").
+    const User_t* userPtr,          ///< [in] The user that has the interface.
+    const char* interfaceNamePtr    ///< [in] The interface name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_json_WriteMember(writerPtr, memberNamePtr);
+    le_json_StartObject(writerPtr);
+
+    // Check whether the user is an app or not.
+    if (strncmp(userPtr->name, "app", 3) == 0)
+    {
+        WriteJsonStringMember(writerPtr, "app", userPtr->name + 3);
+    }
+    else
+    {
+        WriteJsonStringMember(writerPtr, "user", userPtr->name);
+    }
+    WriteJsonStringMember(writerPtr, "interface", interfaceNamePtr);
+
+    le_json_EndObject(writerPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handles the "List Services" request from the 'sdir' tool. Dumps output in json format.
@@ -2096,13 +2162,12 @@ static void SdirToolList
 //--------------------------------------------------------------------------------------------------
 static void SdirToolListServicesJson
 (
-    int fd      ///< [in] The file descriptor to write the output to.
+    le_json_Writer_t* writerPtr     ///< [in] The JSON writer to write the output to.
 )
 //--------------------------------------------------------------------------------------------------
 {
     // Iterate over the User List, and for each user, iterate over their Service List.
     le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
-    bool isFirstJsonEntry = true;
 
     while (userLinkPtr != NULL)
     {
@@ -2115,40 +2180,17 @@ static void SdirToolListServicesJson
             ServerConnection_t* connectionPtr = CONTAINER_OF(serviceLinkPtr,
                                                              ServerConnection_t,
                                                              link);
-            size_t nameOffset = 0;
-            const char* serverTypeStr = "user";
-
-            // Check whether server is app or not.
-            if (strncmp(userPtr->name, "app", 3) == 0)
-            {
-                nameOffset = 3;
-                serverTypeStr = "app";
-            }
 
-            // Print the service info to the provided file descriptor.
-            if (isFirstJsonEntry == false)
-            {
-                // Not the first Json entry. So, print comma before dumping json entry.
-                dprintf(fd, ",");
-            }
-
-            dprintf(fd, "{"
-                        "\"service\":{"
-                        "\"%s\":\"%s\","
-                        "\"interface\":\"%s\""
-                        "},"
-                        "\"pid\":%d,"
-                        "\"maxMessageSize\":%zu,"
-                        "\"protocolId\":\"%s\""
-                        "}",
-                        serverTypeStr,
-                        userPtr->name + nameOffset,
-                        connectionPtr->interface.interfaceName,
-                        connectionPtr->pid,
-                        connectionPtr->interface.maxProtocolMsgSize,
-                        connectionPtr->interface.protocolId);
+            le_json_StartObject(writerPtr);
+            WriteJsonInterface(writerPtr, "service", userPtr,
+                               connectionPtr->interface.interfaceName);
+            le_json_WriteMember(writerPtr, "pid");
+            le_json_WriteInt(writerPtr, connectionPtr->pid);
+            le_json_WriteMember(writerPtr, "maxMessageSize");
+            le_json_WriteUint(writerPtr, connectionPtr->interface.maxProtocolMsgSize);
+            WriteJsonStringMember(writerPtr, "protocolId", connectionPtr->interface.protocolId);
+            le_json_EndObject(writerPtr);
 
-            isFirstJsonEntry = false;
             serviceLinkPtr = le_dls_PeekNext(&userPtr->serviceList, serviceLinkPtr);
         }
 
@@ -2164,28 +2206,17 @@ static void SdirToolListServicesJson
 //--------------------------------------------------------------------------------------------------
 static void SdirToolListWaitingClientsJson
 (
-    int fd      ///< [in] The file descriptor to write the output to.
+    le_json_Writer_t* writerPtr     ///< [in] The JSON writer to write the output to.
 )
 //--------------------------------------------------------------------------------------------------
 {
     // Iterate over the User List, and for each user,
     le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
-    bool isFirstJsonEntry = true;
 
     while (userLinkPtr != NULL)
     {
         User_t* userPtr = CONTAINER_OF(userLinkPtr, User_t, link);
 
-        size_t nameOffsetClient = 0;
-        const char* clientTypeStr = "user";
-
-        // Check whether client is app or not.
-        if (strncmp(userPtr->name, "app", 3) == 0)
-        {
-            nameOffsetClient = 3;
-            clientTypeStr = "app";
-        }
-
         // List all the unbound client connections:
         le_dls_Link_t* clientLinkPtr = le_dls_Peek(&userPtr->unboundClientsList);
         while (clientLinkPtr != NULL)
@@ -2194,27 +2225,14 @@ static void SdirToolListWaitingClientsJson
                                                              ClientConnection_t,
                                                              link);
 
-            if (isFirstJsonEntry == false)
-            {
-                // Not the first Json entry. So, print comma before dumping json entry.
-                dprintf(fd, ",");
-            }
-
-            dprintf(fd, "{"
-                        "\"client\":{"
-                        "\"%s\":\"%s\","
-                        "\"interface\":\"%s\""
-                        "},"
-                        "\"pid\":%d,"
-                        "\"protocolId\":\"%s\""
-                        "}",
-                        clientTypeStr,
-                        userPtr->name + nameOffsetClient,
-                        connectionPtr->interface.interfaceName,
-                        connectionPtr->pid,
-                        connectionPtr->interface.protocolId);
+            le_json_StartObject(writerPtr);
+            WriteJsonInterface(writerPtr, "client", userPtr,
+                               connectionPtr->interface.interfaceName);
+            le_json_WriteMember(writerPtr, "pid");
+            le_json_WriteInt(writerPtr, connectionPtr->pid);
+            WriteJsonStringMember(writerPtr, "protocolId", connectionPtr->interface.protocolId);
+            le_json_EndObject(writerPtr);
 
-            isFirstJsonEntry = false;
             clientLinkPtr = le_dls_PeekNext(&userPtr->unboundClientsList, clientLinkPtr);
         }
 
@@ -2232,47 +2250,20 @@ static void SdirToolListWaitingClientsJson
                 ClientConnection_t* connectionPtr = CONTAINER_OF(clientLinkPtr,
                                                                  ClientConnection_t,
                                                                  link);
-                size_t nameOffsetServer = 0;
-                const char* serverTypeStr = "user";
-
-                // Check whether server is app or not.
-                if (strncmp(bindingPtr->serverUserPtr->name, "app", 3) == 0)
-                {
-                    nameOffsetServer = 3;
-                    serverTypeStr = "app";
-                }
 
                 // Print a description of the waiting connection and what it is waiting for.
-                if (isFirstJsonEntry == false)
-                {
-                    // Not the first Json entry. So, print comma before dumping json entry.
-                    dprintf(fd, ",");
-                }
+                le_json_StartObject(writerPtr);
+                WriteJsonInterface(writerPtr, "client", userPtr,
+                                   connectionPtr->interface.interfaceName);
+                le_json_WriteMember(writerPtr, "pid");
+                le_json_WriteInt(writerPtr, connectionPtr->pid);
+                WriteJsonInterface(writerPtr, "service", bindingPtr->serverUserPtr,
+                                   bindingPtr->serverInterfaceName);
+                WriteJsonStringMember(writerPtr, "protocolId",
+                                      connectionPtr->interface.protocolId);
+                le_json_EndObject(writerPtr);
 
-                dprintf(fd, "{"
-                            "\"client\":{"
-                            "\"%s\":\"%s\","
-                            "\"interface\":\"%s\""
-                            "},"
-                            "\"pid\":%d,"
-                            "\"service\": {"
-                            "\"%s\":\"%s\","
-                            "\"interface\":\"%s\""
-                            "},"
-                            "\"protocolId\":\"%s\""
-                            "}",
-                            clientTypeStr,
-                            userPtr->name + nameOffsetClient,
-                            connectionPtr->interface.interfaceName,
-                            connectionPtr->pid,
-                            serverTypeStr,
-                            bindingPtr->serverUserPtr->name + nameOffsetServer,
-                            bindingPtr->serverInterfaceName,
-                            connectionPtr->interface.protocolId);
-
-                isFirstJsonEntry = false;
                 clientLinkPtr = le_dls_PeekNext(&bindingPtr->waitingClientsList, clientLinkPtr);
-
             }
 
             bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
@@ -2290,13 +2281,12 @@ static void SdirToolListWaitingClientsJson
 //--------------------------------------------------------------------------------------------------
 static void SdirToolListBindingsJson
 (
-    int fd      ///< [in] The file descriptor to write the output to.
+    le_json_Writer_t* writerPtr     ///< [in] The JSON writer to write the output to.
 )
 //--------------------------------------------------------------------------------------------------
 {
     // Iterate over the User List, and for each user, iterate over their Bindings List.
     le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
-    bool isFirstJsonEntry = true;
 
     while (userLinkPtr != NULL)
     {
@@ -2308,51 +2298,12 @@ static void SdirToolListBindingsJson
         {
             Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, link);
 
-            size_t nameOffsetClient = 0;
-            const char* clientTypeStr = "user";
+            le_json_StartObject(writerPtr);
+            WriteJsonInterface(writerPtr, "client", userPtr, bindingPtr->clientInterfaceName);
+            WriteJsonInterface(writerPtr, "service", bindingPtr->serverUserPtr,
+                               bindingPtr->serverInterfaceName);
+            le_json_EndObject(writerPtr);
 
-            // Check whether client is app or not.
-            if (strncmp(userPtr->name, "app", 3) == 0)
-            {
-                nameOffsetClient = 3;
-                clientTypeStr = "app";
-            }
-
-            size_t nameOffsetServer = 0;
-            const char* serverTypeStr = "user";
-
-            // Check whether server is app or not.
-            if (strncmp(bindingPtr->serverUserPtr->name, "app", 3) == 0)
-            {
-                nameOffsetServer = 3;
-                serverTypeStr = "app";
-            }
-
-            // Print the binding to the provided file descriptor.
-            if (isFirstJsonEntry == false)
-            {
-                // Not the first Json entry. So, print comma before dumping json entry.
-                dprintf(fd, ",");
-            }
-
-            dprintf(fd, "{"
-                        "\"client\":{"
-                        "\"%s\":\"%s\","
-                        "\"interface\":\"%s\""
-                        "},"
-                        "\"service\":{"
-                        "\"%s\":\"%s\","
-                        "\"interface\":\"%s\""
-                        "}"
-                        "}",
-                        clientTypeStr,
-                        userPtr->name + nameOffsetClient,
-                        bindingPtr->clientInterfaceName,
-                        serverTypeStr,
-                        bindingPtr->serverUserPtr->name + nameOffsetServer,
-                        bindingPtr->serverInterfaceName);
-
-            isFirstJsonEntry = false;
             bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
         }
 
@@ -2364,6 +2315,14 @@ static void SdirToolListBindingsJson
 //--------------------------------------------------------------------------------------------------
 /**
  * Handles the "List" request from the 'sdir' tool. Dumps output in json format.
+ *
+ * The output is batched in a buffer on the stack, so it only takes a few writes to the
+ * file descriptor, however many bindings and services there are.
+ *
+ * The writer's calls are not checked one by one: the fd is made blocking so that none of them
+ * can fail with LE_WOULD_BLOCK (which would drop a token without failing the writer), and strings
+ * that are not valid UTF-8 are written as null.  Any other failure is sticky, so it is caught by
+ * the last calls.
  */
 //--------------------------------------------------------------------------------------------------
 static void SdirToolListJson
@@ -2378,21 +2337,37 @@ static void SdirToolListJson
     }
     else
     {
-        dprintf(fd, "{\"bindings\":[");
+        char buffer[SDIR_JSON_BUFFER_BYTES];
+        le_json_Writer_t writer;
+
+        // The tool may have handed over a non-blocking fd.
+        fd_SetBlocking(fd);
 
-        SdirToolListBindingsJson(fd);
+        le_json_InitFdWriter(&writer, fd, buffer, sizeof(buffer));
 
-        dprintf(fd, "],"
-                    "\"services\":[");
+        le_json_StartObject(&writer);
 
-        SdirToolListServicesJson(fd);
+        le_json_WriteMember(&writer, "bindings");
+        le_json_StartArray(&writer);
+        SdirToolListBindingsJson(&writer);
+        le_json_EndArray(&writer);
 
-        dprintf(fd, "],"
-                    "\"waiting\":[");
+        le_json_WriteMember(&writer, "services");
+        le_json_StartArray(&writer);
+        SdirToolListServicesJson(&writer);
+        le_json_EndArray(&writer);
 
-        SdirToolListWaitingClientsJson(fd);
+        le_json_WriteMember(&writer, "waiting");
+        le_json_StartArray(&writer);
+        SdirToolListWaitingClientsJson(&writer);
+        le_json_EndArray(&writer);
 
-        dprintf(fd, "]}\n");
+        if (   (le_json_EndObject(&writer) != LE_OK)
+            || (le_json_Flush(&writer) != LE_OK)
+            || (write(fd, "\n", 1) != 1))
+        {
+            LE_WARN("Failed to write JSON listing to the 'sdir' tool (%m).");
+        }
 
         fd_Close(fd);
     }
@@ -99,6 +99,22 @@
 #define CFG_NODE_BINDINGS                               "bindings"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The names of the nodes in the config tree that set how the standard out and standard error of
+ * the app's processes are logged (see logFd_SetAppLimits()):
+ *
+ *  - logRateLimit: average number of lines logged per second (0 or missing = no limit).
+ *  - logBurst: number of lines that can be logged at once (missing = same as logRateLimit).
+ *  - logFileBytes: if not 0, write the output to a log file of this size in /legato/logs instead
+ *    of the system log.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CFG_NODE_LOG_RATE_LIMIT                         "logRateLimit"
+#define CFG_NODE_LOG_BURST                              "logBurst"
+#define CFG_NODE_LOG_FILE_BYTES                         "logFileBytes"
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The name of the node in the config tree that contains the list of required files and directories.
@@ -2823,6 +2839,36 @@ void app_Delete
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tells the log daemon how to log the standard out and standard error of the app's processes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetLogLimits
+(
+    app_Ref_t appRef                    ///< [IN] Reference to the application.
+)
+{
+    le_cfg_IteratorRef_t appCfg = le_cfg_CreateReadTxn(appRef->cfgPathRoot);
+
+    int rateLimit = le_cfg_GetInt(appCfg, CFG_NODE_LOG_RATE_LIMIT, 0);
+    int burst = le_cfg_GetInt(appCfg, CFG_NODE_LOG_BURST, rateLimit);
+    int logFileBytes = le_cfg_GetInt(appCfg, CFG_NODE_LOG_FILE_BYTES, 0);
+
+    le_cfg_CancelTxn(appCfg);
+
+    if ((rateLimit < 0) || (burst < 0) || (logFileBytes < 0))
+    {
+        LE_ERROR("Invalid log limits for app '%s'.  Ignoring them.", appRef->name);
+        rateLimit = 0;
+        burst = 0;
+        logFileBytes = 0;
+    }
+
+    logFd_SetAppLimits(appRef->name, rateLimit, burst, logFileBytes);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts an application.
@@ -2853,6 +2899,8 @@ le_result_t app_Start
 
     appRef->state = APP_STATE_RUNNING;
 
+    SetLogLimits(appRef);
+
     // Create /tmp for sandboxed apps and link in /tmp files.
     if (appRef->sandboxed)
     {
@@ -0,0 +1,403 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/appStats.c
+ *
+ * Samples the resource usage of running applications (see appStats.h).
+ *
+ * The cpuacct and memory statistics files of each sampled app's cgroups are opened once, when the
+ * app starts, and are re-read at each sample, so sampling costs two reads per app.  The sample
+ * timer only runs while at least one app is being sampled.
+ *
+ * Each app keeps a ring of compact samples (CPU time used during the period and memory used at the
+ * end of it).  Since all apps are sampled by the same periodic timer, the samples' times don't need
+ * to be stored.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "appStats.h"
+#include "cgroups.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample period (ms).  Can be overridden, for the unit tests.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef SAMPLE_PERIOD_MS
+#define SAMPLE_PERIOD_MS            10000
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of samples kept for each app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SAMPLES                 LE_APPINFO_MAX_USAGE_SAMPLES
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An app whose memory usage never went down during a whole ring of samples, and grew by at least
+ * this much, is reported as possibly leaking memory.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LEAK_MIN_GROWTH_KBYTES      256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expected number of sampled apps.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EXPECTED_APPS               16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resource usage sample.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t cpuMs;                 ///< CPU time used during the sample period (ms).
+    uint32_t memKBytes;             ///< Memory used at the end of the sample period (KiB).
+}
+Sample_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampled app.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                         ///< Link in the list of sampled apps.
+    char appName[LIMIT_MAX_APP_NAME_BYTES];     ///< Name of the app.
+    int cpuFd;                                  ///< CPU usage file (-1 if not available).
+    int memFd;                                  ///< Memory usage file (-1 if not available).
+    uint64_t lastCpuNs;                         ///< CPU usage at the previous sample (ns).
+    size_t count;                               ///< Number of samples in the ring.
+    size_t next;                                ///< Index of the next sample in the ring.
+    bool isLeakReported;                        ///< true if a possible leak has been reported.
+    Sample_t samples[MAX_SAMPLES];              ///< Ring of samples.
+}
+AppStats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool and list of sampled apps.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t AppStatsPool;
+static le_dls_List_t AppStatsList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t SampleTimer;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds a sampled app.
+ *
+ * @return The sampled app, or NULL if the app is not being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+static AppStats_t* FindAppStats
+(
+    const char* appNamePtr          ///< [IN] Name of the app.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&AppStatsList);
+
+    while (linkPtr != NULL)
+    {
+        AppStats_t* appStatsPtr = CONTAINER_OF(linkPtr, AppStats_t, link);
+
+        if (strcmp(appStatsPtr->appName, appNamePtr) == 0)
+        {
+            return appStatsPtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&AppStatsList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a statistic, closing its file if it can't be read.
+ *
+ * @return The statistic's value, or 0 if not available.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ReadStat
+(
+    int* fdPtr                      ///< [IN/OUT] File of the statistic.
+)
+{
+    uint64_t value = 0;
+
+    if ((*fdPtr >= 0) && (cgrp_ReadStat(*fdPtr, &value) != LE_OK))
+    {
+        fd_Close(*fdPtr);
+        *fdPtr = -1;
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports an app whose memory usage grew steadily during the whole ring of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckForLeak
+(
+    AppStats_t* appStatsPtr         ///< [IN] Sampled app.
+)
+{
+    if (appStatsPtr->count < MAX_SAMPLES)
+    {
+        return;
+    }
+
+    // The ring is full, so the next sample to be overwritten is the oldest.
+    size_t i = appStatsPtr->next;
+    uint32_t firstKBytes = appStatsPtr->samples[i].memKBytes;
+    uint32_t prevKBytes = firstKBytes;
+    size_t n;
+
+    for (n = 1; n < MAX_SAMPLES; n++)
+    {
+        i = (i + 1) % MAX_SAMPLES;
+
+        if (appStatsPtr->samples[i].memKBytes < prevKBytes)
+        {
+            // Memory usage went down, so this is not a steady leak.
+            appStatsPtr->isLeakReported = false;
+            return;
+        }
+
+        prevKBytes = appStatsPtr->samples[i].memKBytes;
+    }
+
+    if ((prevKBytes - firstKBytes >= LEAK_MIN_GROWTH_KBYTES) && !appStatsPtr->isLeakReported)
+    {
+        LE_WARN("Memory used by app '%s' grew steadily from %" PRIu32 " to %" PRIu32 " KiB in"
+                " %d s.  Possible memory leak.",
+                appStatsPtr->appName,
+                firstKBytes,
+                prevKBytes,
+                (MAX_SAMPLES * SAMPLE_PERIOD_MS) / 1000);
+
+        appStatsPtr->isLeakReported = true;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a sample of each sampled app's resource usage.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleTimerHandler
+(
+    le_timer_Ref_t timerRef         ///< [IN] Sample timer.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&AppStatsList);
+
+    while (linkPtr != NULL)
+    {
+        AppStats_t* appStatsPtr = CONTAINER_OF(linkPtr, AppStats_t, link);
+        Sample_t* samplePtr = &appStatsPtr->samples[appStatsPtr->next];
+
+        uint64_t cpuNs = ReadStat(&appStatsPtr->cpuFd);
+        uint64_t cpuMs = (cpuNs > appStatsPtr->lastCpuNs) ?
+                         (cpuNs - appStatsPtr->lastCpuNs) / 1000000 : 0;
+
+        samplePtr->cpuMs = (cpuMs > UINT32_MAX) ? UINT32_MAX : cpuMs;
+        samplePtr->memKBytes = ReadStat(&appStatsPtr->memFd) / 1024;
+        appStatsPtr->lastCpuNs = cpuNs;
+
+        appStatsPtr->next = (appStatsPtr->next + 1) % MAX_SAMPLES;
+        if (appStatsPtr->count < MAX_SAMPLES)
+        {
+            appStatsPtr->count++;
+        }
+
+        CheckForLeak(appStatsPtr);
+
+        linkPtr = le_dls_PeekNext(&AppStatsList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the app resource usage sampler.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Init
+(
+    void
+)
+{
+    AppStatsPool = le_mem_CreatePool("AppStats", sizeof(AppStats_t));
+    le_mem_ExpandPool(AppStatsPool, EXPECTED_APPS);
+
+    SampleTimer = le_timer_Create("AppStats");
+    LE_ASSERT(le_timer_SetMsInterval(SampleTimer, SAMPLE_PERIOD_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(SampleTimer, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(SampleTimer, SampleTimerHandler) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sampling the resource usage of an app that is being started.  The app's cgroups must
+ * exist.  Does nothing if the app is already being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Start
+(
+    const char* appNamePtr          ///< [IN] Name of the app.
+)
+{
+    if (FindAppStats(appNamePtr) != NULL)
+    {
+        return;
+    }
+
+    AppStats_t* appStatsPtr = le_mem_ForceAlloc(AppStatsPool);
+
+    LE_ASSERT(le_utf8_Copy(appStatsPtr->appName, appNamePtr, sizeof(appStatsPtr->appName), NULL)
+              == LE_OK);
+    appStatsPtr->link = LE_DLS_LINK_INIT;
+    appStatsPtr->cpuFd = cgrp_OpenStat(CGRP_STAT_CPU_USAGE, appNamePtr);
+    appStatsPtr->memFd = cgrp_OpenStat(CGRP_STAT_MEM_USAGE, appNamePtr);
+    appStatsPtr->count = 0;
+    appStatsPtr->next = 0;
+    appStatsPtr->isLeakReported = false;
+
+    // The first sample covers the time from now on.
+    appStatsPtr->lastCpuNs = ReadStat(&appStatsPtr->cpuFd);
+
+    le_dls_Queue(&AppStatsList, &appStatsPtr->link);
+
+    if (!le_timer_IsRunning(SampleTimer))
+    {
+        LE_ASSERT(le_timer_Start(SampleTimer) == LE_OK);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop sampling the resource usage of an app, and forget its samples.  Does nothing if the app is
+ * not being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Stop
+(
+    const char* appNamePtr          ///< [IN] Name of the app.
+)
+{
+    AppStats_t* appStatsPtr = FindAppStats(appNamePtr);
+
+    if (appStatsPtr == NULL)
+    {
+        return;
+    }
+
+    if (appStatsPtr->cpuFd >= 0)
+    {
+        fd_Close(appStatsPtr->cpuFd);
+    }
+    if (appStatsPtr->memFd >= 0)
+    {
+        fd_Close(appStatsPtr->memFd);
+    }
+
+    le_dls_Remove(&AppStatsList, &appStatsPtr->link);
+    le_mem_Release(appStatsPtr);
+
+    if (le_dls_IsEmpty(&AppStatsList))
+    {
+        LE_ASSERT(le_timer_Stop(SampleTimer) == LE_OK);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the resource usage samples of an app, oldest first.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the arrays are too small to hold all the samples (the most recent ones are
+ *                  returned).
+ *      LE_NOT_FOUND if the app is not being sampled or has not been sampled yet.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t appStats_GetHistory
+(
+    const char* appNamePtr,         ///< [IN] Name of the app.
+    uint32_t* cpuMsPtr,             ///< [OUT] CPU time used during each sample period (ms).
+    size_t* cpuMsCountPtr,          ///< [IN/OUT] Size of the CPU time array / number of samples.
+    uint32_t* memKBytesPtr,         ///< [OUT] Memory used at the end of each period (KiB).
+    size_t* memKBytesCountPtr,      ///< [IN/OUT] Size of the memory array / number of samples.
+    uint32_t* samplePeriodMsPtr     ///< [OUT] Sample period (ms).
+)
+{
+    AppStats_t* appStatsPtr = FindAppStats(appNamePtr);
+
+    *samplePeriodMsPtr = SAMPLE_PERIOD_MS;
+
+    if ((appStatsPtr == NULL) || (appStatsPtr->count == 0))
+    {
+        *cpuMsCountPtr = 0;
+        *memKBytesCountPtr = 0;
+        return LE_NOT_FOUND;
+    }
+
+    size_t count = appStatsPtr->count;
+    le_result_t result = LE_OK;
+
+    if ((*cpuMsCountPtr < count) || (*memKBytesCountPtr < count))
+    {
+        count = (*cpuMsCountPtr < *memKBytesCountPtr) ? *cpuMsCountPtr : *memKBytesCountPtr;
+        result = LE_OVERFLOW;
+    }
+
+    // Start with the oldest sample returned.
+    size_t i = (appStatsPtr->next + MAX_SAMPLES - count) % MAX_SAMPLES;
+    size_t n;
+
+    for (n = 0; n < count; n++)
+    {
+        cpuMsPtr[n] = appStatsPtr->samples[i].cpuMs;
+        memKBytesPtr[n] = appStatsPtr->samples[i].memKBytes;
+        i = (i + 1) % MAX_SAMPLES;
+    }
+
+    *cpuMsCountPtr = count;
+    *memKBytesCountPtr = count;
+
+    return result;
+}
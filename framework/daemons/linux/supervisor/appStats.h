@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/appStats.h
+ *
+ * API for sampling the resource usage of running applications.
+ *
+ * While an app is running, the CPU time and memory used by its cgroups are sampled at a fixed
+ * period, and the last LE_APPINFO_MAX_USAGE_SAMPLES samples are kept in memory so that usage
+ * trends (and slow memory leaks) can be seen with le_appInfo_GetUsageHistory().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#ifndef LEGATO_SRC_APP_STATS_INCLUDE_GUARD
+#define LEGATO_SRC_APP_STATS_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the app resource usage sampler.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sampling the resource usage of an app that is being started.  The app's cgroups must
+ * exist.  Does nothing if the app is already being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Start
+(
+    const char* appNamePtr          ///< [IN] Name of the app.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop sampling the resource usage of an app, and forget its samples.  Does nothing if the app is
+ * not being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+void appStats_Stop
+(
+    const char* appNamePtr          ///< [IN] Name of the app.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the resource usage samples of an app, oldest first.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the arrays are too small to hold all the samples (the most recent ones are
+ *                  returned).
+ *      LE_NOT_FOUND if the app is not being sampled or has not been sampled yet.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t appStats_GetHistory
+(
+    const char* appNamePtr,         ///< [IN] Name of the app.
+    uint32_t* cpuMsPtr,             ///< [OUT] CPU time used during each sample period (ms).
+    size_t* cpuMsCountPtr,          ///< [IN/OUT] Size of the CPU time array / number of samples.
+    uint32_t* memKBytesPtr,         ///< [OUT] Memory used at the end of each period (KiB).
+    size_t* memKBytesCountPtr,      ///< [IN/OUT] Size of the memory array / number of samples.
+    uint32_t* samplePeriodMsPtr     ///< [OUT] Sample period (ms).
+);
+
+
+#endif // LEGATO_SRC_APP_STATS_INCLUDE_GUARD
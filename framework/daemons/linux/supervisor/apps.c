@@ -63,6 +63,7 @@
 #include "legato.h"
 #include "apps.h"
 #include "app.h"
+#include "appStats.h"
 #include "interfaces.h"
 #include "limit.h"
 #include "wait.h"
@@ -353,6 +354,8 @@ static void DeleteApp
     // Reset the additional link overrides here too because it is persistent in the file system.
     app_RemoveAllLinks(appContainerPtr->appRef);
 
+    appStats_Stop(app_GetName(appContainerPtr->appRef));
+
     app_Delete(appContainerPtr->appRef);
 
     le_mem_Release(appContainerPtr);
@@ -373,6 +376,8 @@ static void DeactivateAppContainer
 
     LE_INFO("Application '%s' has stopped.", app_GetName(appContainerPtr->appRef));
 
+    appStats_Stop(app_GetName(appContainerPtr->appRef));
+
     appContainerPtr->stopHandler = NULL;
 
     le_dls_Queue(&InactiveAppsList, &(appContainerPtr->link));
@@ -667,6 +672,9 @@ static le_result_t StartApp
     le_dls_Queue(&ActiveAppsList, &(appContainerPtr->link));
     appContainerPtr->isActive = true;
 
+    // Sample the app's resource usage while it runs.
+    appStats_Start(app_GetName(appContainerPtr->appRef));
+
     // Start the app.
     return app_Start(appContainerPtr->appRef);
 }
@@ -1232,6 +1240,7 @@ void apps_Init
 )
 {
     app_Init();
+    appStats_Init();
 
     // Create memory pools.
     AppContainerPool = le_mem_CreatePool("appContainers", sizeof(AppContainer_t));
@@ -2314,6 +2323,63 @@ le_result_t le_appInfo_GetHash
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the recent resource usage of a running application.  The Supervisor samples the CPU time
+ * and memory used by each running application's processes at a fixed period, and keeps the last
+ * LE_APPINFO_MAX_USAGE_SAMPLES samples.  The samples are returned oldest first, and the last one
+ * is at most one sample period old.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the arrays are too small to hold all the samples (the most recent ones are
+ *                  returned).
+ *      LE_NOT_FOUND if the application is not running or has not been sampled yet.
+ *
+ * @note If the application name pointer is null or if its string is empty or of bad format it is a
+ *       fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_appInfo_GetUsageHistory
+(
+    const char* appName,
+        ///< [IN]
+        ///< Application name.
+
+    uint32_t* cpuMsPtr,
+        ///< [OUT]
+        ///< CPU time used during each sample period (ms).
+
+    size_t* cpuMsSizePtr,
+        ///< [INOUT]
+
+    uint32_t* memKBytesPtr,
+        ///< [OUT]
+        ///< Memory used at the end of each period (KiB).
+
+    size_t* memKBytesSizePtr,
+        ///< [INOUT]
+
+    uint32_t* samplePeriodMsPtr
+        ///< [OUT]
+        ///< Sample period (ms).
+)
+{
+    if (!IsAppNameValid(appName))
+    {
+        LE_KILL_CLIENT("Invalid app name.");
+        return LE_FAULT;
+    }
+
+    return appStats_GetHistory(appName,
+                               cpuMsPtr,
+                               cpuMsSizePtr,
+                               memKBytesPtr,
+                               memKBytesSizePtr,
+                               samplePeriodMsPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * A watchdog has timed out. This function determines the watchdogAction to take and applies it.
@@ -39,6 +39,7 @@
 #include "smack.h"
 #include "sysPaths.h"
 #include "fileSystem.h"
+#include "fileStore.h"
 
 
 static const char* InstallHookScriptPath = "/legato/systems/current/bin/install-hook";
@@ -553,6 +554,36 @@ le_result_t app_SetSmackPermReadOnly
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share the files of an app's read-only directory that are identical to files of other installed
+ * apps (see fileStore.h).  Must be done before the app's SMACK labels are set.
+ */
+//--------------------------------------------------------------------------------------------------
+void app_ShareFiles
+(
+    const char* appMd5Ptr,  ///< [IN] Hash ID of the application.
+    const char* appNamePtr  ///< [IN] Name of the application.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char readOnlyPath[LIMIT_MAX_PATH_BYTES] = "";
+    LE_ASSERT(snprintf(readOnlyPath, sizeof(readOnlyPath), "/legato/apps/%s/read-only", appMd5Ptr)
+              < sizeof(readOnlyPath));
+
+    // Files can only be shared by apps that label them the same.  Without SMACK, all apps (and
+    // the system libraries, see system.c) share one namespace.
+    char label[LIMIT_MAX_SMACK_LABEL_BYTES] = "_";
+
+    if (smack_IsEnabled())
+    {
+        smack_GetAppLabel(appNamePtr, label, sizeof(label));
+    }
+
+    fileStore_AddTree(readOnlyPath, label);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check to see if the given application exists.
@@ -709,6 +740,8 @@ le_result_t app_InstallIndividual
             sysStatus_MarkBad();
             LE_FATAL("Rolling-back to snapshot.");
         }
+
+        app_ShareFiles(appMd5Ptr, appNamePtr);
     }
 
     // If this app is already in the current system but its app hash is different,
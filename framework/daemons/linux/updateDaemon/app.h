@@ -72,6 +72,19 @@ le_result_t app_SetSmackPermReadOnly
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share the files of an app's read-only directory that are identical to files of other installed
+ * apps (see fileStore.h).  Must be done before the app's SMACK labels are set.
+ */
+//--------------------------------------------------------------------------------------------------
+void app_ShareFiles
+(
+    const char* appMd5Ptr,  ///< [IN] Hash ID of the application.
+    const char* appNamePtr  ///< [IN] Name of the application.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set up a given app's writeable files in the "unpack" system.
@@ -0,0 +1,784 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file appDelta.c
+ *
+ * Applies file-level app deltas (see appDelta.h for the format).
+ *
+ * Patches are applied with bounded memory: the base file is mapped read-only, and the patch's
+ * three blocks and the new file are read and written sequentially through small buffers, so even
+ * large files can be rebuilt on targets with little RAM.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "file.h"
+#include "fileDescriptor.h"
+#include "appDelta.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the patch file header (magic, control block length, diff block length, new size).
+ */
+//--------------------------------------------------------------------------------------------------
+#define PATCH_HEADER_BYTES  32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes processed at a time when rebuilding a file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHUNK_BYTES         4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of hex digits in a file's CRC in the manifest.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CRC_DIGITS          8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a 64-bit signed integer stored the way bsdiff stores them.
+ *
+ * @return The integer.
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t DecodeInt
+(
+    const uint8_t* bufPtr   ///< [IN] The 8 encoded bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int64_t value = bufPtr[7] & 0x7F;
+    int i;
+
+    for (i = 6; i >= 0; i--)
+    {
+        value = (value << 8) + bufPtr[i];
+    }
+
+    if (bufPtr[7] & 0x80)
+    {
+        value = -value;
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read exactly the requested number of bytes from a stream.
+ *
+ * @return true if successful, false on error or premature end of file.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadExact
+(
+    FILE* streamPtr,    ///< [IN] Stream to read from.
+    void* bufPtr,       ///< [OUT] Buffer to read into.
+    size_t size         ///< [IN] Number of bytes to read.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (fread(bufPtr, 1, size, streamPtr) == size);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a patch file and position a stream at the start of one of its blocks.
+ *
+ * @return The stream, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* OpenBlock
+(
+    const char* patchPathPtr,   ///< [IN] Path of the patch file.
+    int64_t offset              ///< [IN] Offset of the block in the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FILE* streamPtr = fopen(patchPathPtr, "re");
+
+    if (streamPtr == NULL)
+    {
+        LE_ERROR("Failed to open patch '%s' (%m).", patchPathPtr);
+        return NULL;
+    }
+
+    if (fseeko(streamPtr, (off_t)offset, SEEK_SET) != 0)
+    {
+        LE_ERROR("Failed to seek in patch '%s' (%m).", patchPathPtr);
+        fclose(streamPtr);
+        return NULL;
+    }
+
+    return streamPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the CRC32 of a file's contents.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FAULT if the file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CrcFile
+(
+    const char* pathPtr,    ///< [IN] Path of the file.
+    uint32_t* crcPtr        ///< [OUT] CRC32 of the file's contents.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(pathPtr, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    uint8_t buf[CHUNK_BYTES];
+    uint32_t crc = LE_CRC_START_CRC32;
+    ssize_t count;
+
+    while ((count = fd_ReadSize(fd, buf, sizeof(buf))) > 0)
+    {
+        crc = le_crc_Crc32(buf, count, crc);
+    }
+
+    fd_Close(fd);
+
+    if (count < 0)
+    {
+        LE_ERROR("Failed to read '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    *crcPtr = crc;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild a file from a base file and a patch.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the patch is malformed or the new file doesn't have the expected CRC.
+ *      - LE_FAULT for any other failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PatchFile
+(
+    const char* basePathPtr,    ///< [IN] Path of the base file.
+    const char* patchPathPtr,   ///< [IN] Path of the patch file.
+    const char* newPathPtr,     ///< [IN] Path of the file to create.
+    uint32_t newCrc             ///< [IN] Expected CRC32 of the new file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_FAULT;
+    FILE* ctrlPtr = NULL;
+    FILE* diffPtr = NULL;
+    FILE* extraPtr = NULL;
+    FILE* newPtr = NULL;
+    const uint8_t* oldPtr = NULL;
+    struct stat oldStat;
+    struct stat patchStat;
+    int64_t ctrlLen, diffLen, newSize;
+
+    // Read and check the header.
+    uint8_t header[PATCH_HEADER_BYTES];
+
+    // A patch that is listed in the manifest but missing from the delta makes the delta malformed.
+    ctrlPtr = OpenBlock(patchPathPtr, 0);
+    if (ctrlPtr == NULL)
+    {
+        result = LE_FORMAT_ERROR;
+        goto done;
+    }
+
+    if (   !ReadExact(ctrlPtr, header, sizeof(header))
+        || (memcmp(header, APPDELTA_PATCH_MAGIC, 8) != 0))
+    {
+        LE_ERROR("'%s' is not a valid patch.", patchPathPtr);
+        result = LE_FORMAT_ERROR;
+        goto done;
+    }
+
+    if (fstat(fileno(ctrlPtr), &patchStat) != 0)
+    {
+        LE_ERROR("Failed to stat patch '%s' (%m).", patchPathPtr);
+        goto done;
+    }
+
+    ctrlLen = DecodeInt(header + 8);
+    diffLen = DecodeInt(header + 16);
+    newSize = DecodeInt(header + 24);
+
+    // The blocks must fit in the file, and every byte of the new file comes from either the diff
+    // block or the extra block, so the new file can't be bigger than those together.
+    int64_t blocksLen = patchStat.st_size - PATCH_HEADER_BYTES;
+
+    if (   (ctrlLen < 0) || (diffLen < 0) || (newSize < 0)
+        || (ctrlLen > blocksLen) || (diffLen > blocksLen - ctrlLen)
+        || (newSize > blocksLen - ctrlLen))
+    {
+        LE_ERROR("Corrupt patch '%s'.", patchPathPtr);
+        result = LE_FORMAT_ERROR;
+        goto done;
+    }
+
+    diffPtr = OpenBlock(patchPathPtr, PATCH_HEADER_BYTES + ctrlLen);
+    extraPtr = OpenBlock(patchPathPtr, PATCH_HEADER_BYTES + ctrlLen + diffLen);
+    if ((diffPtr == NULL) || (extraPtr == NULL))
+    {
+        goto done;
+    }
+
+    // Map the base file.
+    int oldFd = open(basePathPtr, O_RDONLY | O_CLOEXEC);
+    if (oldFd < 0)
+    {
+        LE_ERROR("Failed to open base file '%s' (%m).", basePathPtr);
+        result = LE_FORMAT_ERROR;
+        goto done;
+    }
+
+    if (fstat(oldFd, &oldStat) != 0)
+    {
+        LE_ERROR("Failed to stat base file '%s' (%m).", basePathPtr);
+        fd_Close(oldFd);
+        goto done;
+    }
+
+    if (oldStat.st_size > 0)
+    {
+        oldPtr = mmap(NULL, oldStat.st_size, PROT_READ, MAP_PRIVATE, oldFd, 0);
+        if (oldPtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map base file '%s' (%m).", basePathPtr);
+            oldPtr = NULL;
+            fd_Close(oldFd);
+            goto done;
+        }
+    }
+
+    fd_Close(oldFd);
+
+    // The new file replaces anything the tarball may have put there.
+    unlink(newPathPtr);
+
+    newPtr = fopen(newPathPtr, "we");
+    if (newPtr == NULL)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", newPathPtr);
+        goto done;
+    }
+
+    // Each control triple says: add the next x bytes of the diff block to the base file's bytes,
+    // then copy the next y bytes of the extra block, then move z bytes through the base file.
+    // Each block is only read up to its own end, not into the next one.
+    int64_t oldPos = 0;
+    int64_t newPos = 0;
+    int64_t ctrlLeft = ctrlLen;
+    int64_t diffLeft = diffLen;
+    int64_t extraLeft = blocksLen - ctrlLen - diffLen;
+    uint32_t crc = LE_CRC_START_CRC32;
+    uint8_t buf[CHUNK_BYTES];
+
+    while (newPos < newSize)
+    {
+        uint8_t ctrl[24];
+
+        if ((ctrlLeft < (int64_t)sizeof(ctrl)) || !ReadExact(ctrlPtr, ctrl, sizeof(ctrl)))
+        {
+            LE_ERROR("Truncated control block in patch '%s'.", patchPathPtr);
+            result = LE_FORMAT_ERROR;
+            goto done;
+        }
+
+        int64_t addLen = DecodeInt(ctrl);
+        int64_t copyLen = DecodeInt(ctrl + 8);
+        int64_t seekLen = DecodeInt(ctrl + 16);
+        int64_t nextOldPos;
+
+        ctrlLeft -= sizeof(ctrl);
+
+        if (   (addLen < 0) || (copyLen < 0)
+            || (addLen > newSize - newPos) || (copyLen > newSize - newPos - addLen)
+            || (addLen > diffLeft) || (copyLen > extraLeft)
+            || __builtin_add_overflow(oldPos, addLen, &nextOldPos)
+            || __builtin_add_overflow(nextOldPos, seekLen, &nextOldPos))
+        {
+            LE_ERROR("Corrupt control block in patch '%s'.", patchPathPtr);
+            result = LE_FORMAT_ERROR;
+            goto done;
+        }
+
+        diffLeft -= addLen;
+        extraLeft -= copyLen;
+
+        while (addLen > 0)
+        {
+            size_t count = (addLen < CHUNK_BYTES) ? addLen : CHUNK_BYTES;
+            size_t i;
+
+            if (!ReadExact(diffPtr, buf, count))
+            {
+                LE_ERROR("Truncated diff block in patch '%s'.", patchPathPtr);
+                result = LE_FORMAT_ERROR;
+                goto done;
+            }
+
+            for (i = 0; i < count; i++)
+            {
+                int64_t pos = oldPos + i;
+
+                if ((pos >= 0) && (pos < oldStat.st_size))
+                {
+                    buf[i] += oldPtr[pos];
+                }
+            }
+
+            crc = le_crc_Crc32(buf, count, crc);
+            if (fwrite(buf, 1, count, newPtr) != count)
+            {
+                LE_ERROR("Failed to write '%s' (%m).", newPathPtr);
+                goto done;
+            }
+
+            addLen -= count;
+            oldPos += count;
+            newPos += count;
+        }
+
+        while (copyLen > 0)
+        {
+            size_t count = (copyLen < CHUNK_BYTES) ? copyLen : CHUNK_BYTES;
+
+            if (!ReadExact(extraPtr, buf, count))
+            {
+                LE_ERROR("Truncated extra block in patch '%s'.", patchPathPtr);
+                result = LE_FORMAT_ERROR;
+                goto done;
+            }
+
+            crc = le_crc_Crc32(buf, count, crc);
+            if (fwrite(buf, 1, count, newPtr) != count)
+            {
+                LE_ERROR("Failed to write '%s' (%m).", newPathPtr);
+                goto done;
+            }
+
+            copyLen -= count;
+            newPos += count;
+        }
+
+        oldPos = nextOldPos;
+    }
+
+    if (crc != newCrc)
+    {
+        LE_ERROR("'%s' rebuilt from patch '%s' has the wrong CRC (%08" PRIx32 ", expected %08"
+                 PRIx32 ").", newPathPtr, patchPathPtr, crc, newCrc);
+        result = LE_FORMAT_ERROR;
+        goto done;
+    }
+
+    if (fchmod(fileno(newPtr), oldStat.st_mode & 07777) != 0)
+    {
+        LE_ERROR("Failed to set permissions of '%s' (%m).", newPathPtr);
+        goto done;
+    }
+
+    result = LE_OK;
+
+done:
+    if (newPtr != NULL)
+    {
+        if ((fclose(newPtr) != 0) && (result == LE_OK))
+        {
+            LE_ERROR("Failed to write '%s' (%m).", newPathPtr);
+            result = LE_FAULT;
+        }
+    }
+    if (oldPtr != NULL)
+    {
+        munmap((void*)oldPtr, oldStat.st_size);
+    }
+    if (extraPtr != NULL)
+    {
+        fclose(extraPtr);
+    }
+    if (diffPtr != NULL)
+    {
+        fclose(diffPtr);
+    }
+    if (ctrlPtr != NULL)
+    {
+        fclose(ctrlPtr);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file that is the same as a file of the base app.  The file is hard linked, which takes
+ * no space, unless that isn't possible.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the base file doesn't exist, isn't a regular file or doesn't have the
+ *        expected CRC.
+ *      - LE_FAULT for any other failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyFile
+(
+    const char* basePathPtr,    ///< [IN] Path of the base file.
+    const char* newPathPtr,     ///< [IN] Path of the file to create.
+    uint32_t newCrc             ///< [IN] Expected CRC32 of the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat baseStat;
+    uint32_t crc;
+
+    if (lstat(basePathPtr, &baseStat) != 0)
+    {
+        LE_ERROR("Base file '%s' is missing (%m).", basePathPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    // Only regular files are listed in manifests.
+    if (!S_ISREG(baseStat.st_mode))
+    {
+        LE_ERROR("Base file '%s' is not a regular file.", basePathPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (CrcFile(basePathPtr, &crc) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (crc != newCrc)
+    {
+        LE_ERROR("Base file '%s' has the wrong CRC (%08" PRIx32 ", expected %08" PRIx32 ").",
+                 basePathPtr, crc, newCrc);
+        return LE_FORMAT_ERROR;
+    }
+
+    // The new file replaces anything the tarball may have put there.
+    unlink(newPathPtr);
+
+    if (link(basePathPtr, newPathPtr) == 0)
+    {
+        return LE_OK;
+    }
+
+    LE_DEBUG("Can't link '%s' to '%s' (%m). Copying it.", newPathPtr, basePathPtr);
+
+    if (file_Copy(basePathPtr, newPathPtr, NULL) != LE_OK)
+    {
+        LE_ERROR("Failed to copy '%s' to '%s'.", basePathPtr, newPathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a path from a manifest stays inside the app (is relative and has no ".." element).
+ *
+ * @return true if the path is acceptable.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSafePath
+(
+    const char* pathPtr     ///< [IN] Path relative to the root of the app.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((pathPtr[0] == '\0') || (pathPtr[0] == '/'))
+    {
+        return false;
+    }
+
+    const char* elemPtr = pathPtr;
+
+    while (elemPtr != NULL)
+    {
+        if ((strncmp(elemPtr, "..", 2) == 0) && ((elemPtr[2] == '/') || (elemPtr[2] == '\0')))
+        {
+            return false;
+        }
+
+        elemPtr = strchr(elemPtr, '/');
+        if (elemPtr != NULL)
+        {
+            elemPtr++;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the CRC field at the start of what remains of a manifest line.
+ *
+ * @return Pointer to the rest of the line (after the CRC and its separating space), or NULL if the
+ *         line doesn't start with a valid CRC.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* ParseCrc
+(
+    char* fieldPtr,     ///< [IN] Start of the CRC field.
+    uint32_t* crcPtr    ///< [OUT] The CRC.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t crc = 0;
+    int i;
+
+    for (i = 0; i < CRC_DIGITS; i++)
+    {
+        if (!isxdigit((unsigned char)fieldPtr[i]))
+        {
+            return NULL;
+        }
+
+        char digit = tolower((unsigned char)fieldPtr[i]);
+
+        crc = (crc << 4) | (isdigit((unsigned char)digit) ? (digit - '0') : (digit - 'a' + 10));
+    }
+
+    if (fieldPtr[CRC_DIGITS] != ' ')
+    {
+        return NULL;
+    }
+
+    *crcPtr = crc;
+    return fieldPtr + CRC_DIGITS + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply one line of a manifest.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the line is malformed or doesn't match the base app.
+ *      - LE_FAULT for any other failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyLine
+(
+    char* linePtr,              ///< [IN] Manifest line, without the newline.
+    const char* unpackDirPtr,   ///< [IN] Directory the delta was unpacked into.
+    const char* baseDirPtr      ///< [IN] Directory of the base app.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* patchNamePtr = NULL;
+    char* pathPtr;
+    uint32_t crc;
+
+    if (strncmp(linePtr, "copy ", 5) == 0)
+    {
+        pathPtr = ParseCrc(linePtr + 5, &crc);
+    }
+    else if (strncmp(linePtr, "patch ", 6) == 0)
+    {
+        patchNamePtr = ParseCrc(linePtr + 6, &crc);
+        pathPtr = (patchNamePtr == NULL) ? NULL : strchr(patchNamePtr, ' ');
+        if (pathPtr == NULL)
+        {
+            LE_ERROR("Malformed delta manifest line '%s'.", linePtr);
+            return LE_FORMAT_ERROR;
+        }
+        *pathPtr++ = '\0';
+    }
+    else
+    {
+        pathPtr = NULL;
+    }
+
+    if (pathPtr == NULL)
+    {
+        LE_ERROR("Malformed delta manifest line '%s'.", linePtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (!IsSafePath(pathPtr) || ((patchNamePtr != NULL) && !IsSafePath(patchNamePtr)))
+    {
+        LE_ERROR("Illegal path in delta manifest line '%s'.", linePtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    char basePath[LIMIT_MAX_PATH_BYTES] = "";
+    char newPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (   (le_path_Concat("/", basePath, sizeof(basePath), baseDirPtr, pathPtr, NULL) != LE_OK)
+        || (le_path_Concat("/", newPath, sizeof(newPath), unpackDirPtr, pathPtr, NULL) != LE_OK))
+    {
+        LE_ERROR("Path too long in delta manifest: '%s'.", pathPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    // The tarball normally holds all of the app's directories, but make sure.
+    char dirPath[LIMIT_MAX_PATH_BYTES];
+
+    le_utf8_Copy(dirPath, newPath, sizeof(dirPath), NULL);
+    *strrchr(dirPath, '/') = '\0';
+    if (le_dir_MakePath(dirPath, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != LE_OK)
+    {
+        LE_ERROR("Failed to create directory '%s'.", dirPath);
+        return LE_FAULT;
+    }
+
+    if (patchNamePtr == NULL)
+    {
+        return CopyFile(basePath, newPath, crc);
+    }
+
+    char patchPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (le_path_Concat("/", patchPath, sizeof(patchPath),
+                       unpackDirPtr, APPDELTA_DIR, patchNamePtr, NULL) != LE_OK)
+    {
+        LE_ERROR("Path too long in delta manifest: '%s'.", patchNamePtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    return PatchFile(basePath, patchPath, newPath, crc);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild an app from a delta that has been unpacked into a directory and the base app the delta
+ * was made against.  On success, APPDELTA_DIR has been removed from the unpack directory, which
+ * then holds the complete app.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the delta is malformed or doesn't match the base app.
+ *      - LE_FAULT for any other failure.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t appDelta_Apply
+(
+    const char* unpackDirPtr,   ///< [IN] Directory the delta was unpacked into.
+    const char* baseDirPtr      ///< [IN] Directory of the (installed) base app.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char deltaDir[LIMIT_MAX_PATH_BYTES] = "";
+    char manifestPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (!le_dir_IsDir(baseDirPtr))
+    {
+        LE_ERROR("Base app '%s' is not installed.", baseDirPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    LE_ASSERT(le_path_Concat("/", deltaDir, sizeof(deltaDir),
+                             unpackDirPtr, APPDELTA_DIR, NULL) == LE_OK);
+    LE_ASSERT(le_path_Concat("/", manifestPath, sizeof(manifestPath),
+                             deltaDir, APPDELTA_MANIFEST, NULL) == LE_OK);
+
+    FILE* manifestPtr = fopen(manifestPath, "re");
+    if (manifestPtr == NULL)
+    {
+        LE_ERROR("Failed to open delta manifest '%s' (%m).", manifestPath);
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    size_t lineNum = 0;
+    size_t fileCount = 0;
+    char line[LIMIT_MAX_PATH_BYTES * 2];
+
+    while ((result == LE_OK) && (fgets(line, sizeof(line), manifestPtr) != NULL))
+    {
+        size_t len = strlen(line);
+
+        lineNum++;
+
+        if ((len == 0) || (line[len - 1] != '\n'))
+        {
+            LE_ERROR("Line %zu of delta manifest is too long or unterminated.", lineNum);
+            result = LE_FORMAT_ERROR;
+        }
+        else
+        {
+            line[len - 1] = '\0';
+
+            if (lineNum == 1)
+            {
+                if (strcmp(line, APPDELTA_MANIFEST_HEADER) != 0)
+                {
+                    LE_ERROR("Unsupported delta manifest ('%s').", line);
+                    result = LE_FORMAT_ERROR;
+                }
+            }
+            else
+            {
+                result = ApplyLine(line, unpackDirPtr, baseDirPtr);
+                fileCount++;
+            }
+        }
+    }
+
+    if ((result == LE_OK) && ferror(manifestPtr))
+    {
+        LE_ERROR("Failed to read delta manifest '%s'.", manifestPath);
+        result = LE_FAULT;
+    }
+    else if ((result == LE_OK) && (lineNum == 0))
+    {
+        LE_ERROR("Empty delta manifest.");
+        result = LE_FORMAT_ERROR;
+    }
+
+    fclose(manifestPtr);
+
+    if (result == LE_OK)
+    {
+        if (le_dir_RemoveRecursive(deltaDir) != LE_OK)
+        {
+            LE_ERROR("Failed to remove '%s'.", deltaDir);
+            result = LE_FAULT;
+        }
+        else
+        {
+            LE_INFO("Rebuilt %zu files from base app '%s'.", fileCount, baseDirPtr);
+        }
+    }
+
+    return result;
+}
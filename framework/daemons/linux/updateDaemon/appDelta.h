@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file appDelta.h
+ *
+ * App delta module exported definitions.
+ *
+ * An app update section whose JSON header has a "base" member carries a file-level delta against
+ * the app that is installed in /legato/apps/<base>, instead of the complete app.  The payload is
+ * still a tarball, which is unpacked the normal way.  It contains the files that are new or that
+ * changed too much to be worth patching, plus a directory named APPDELTA_DIR holding:
+ *
+ *  - APPDELTA_MANIFEST, a text file whose first line is APPDELTA_MANIFEST_HEADER, followed by one
+ *    line per file to be rebuilt from the base app:
+ *     - "copy <crc> <path>" - the file is the same as in the base app (it is hard linked, or
+ *       copied).
+ *     - "patch <crc> <patch> <path>" - the file is rebuilt from the base app's file and the patch
+ *       file APPDELTA_DIR/<patch>.  The file keeps the base app's file's permissions.
+ *
+ *    <crc> is the le_crc_Crc32() of the file's contents, as 8 hex digits.  Every rebuilt file is
+ *    checked against it, so a base app that isn't the one the delta was made against is detected.
+ *  - The patch files, each starting with APPDELTA_PATCH_MAGIC.  These are bsdiff patches with
+ *    the three blocks left uncompressed (the tarball is compressed already, so this saves the
+ *    target from decompressing each patch separately):
+ *     - 8 bytes: APPDELTA_PATCH_MAGIC.
+ *     - 8 bytes: length of the control block.
+ *     - 8 bytes: length of the diff block.
+ *     - 8 bytes: size of the new file.
+ *     - The control block, the diff block, and the extra block (the rest of the file).
+ *
+ *    All numbers, including those in the control block, are 64-bit signed integers stored the way
+ *    bsdiff stores them (little-endian magnitude, with the sign in the top bit).
+ *
+ * Paths are relative to the root of the app.  The update-util host tool generates these deltas.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_APP_DELTA_H_INCLUDE_GUARD
+#define LEGATO_APP_DELTA_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the directory (at the root of an unpacked delta) holding the manifest and patches.
+ */
+//--------------------------------------------------------------------------------------------------
+#define APPDELTA_DIR                ".delta"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the manifest file inside APPDELTA_DIR, and the line it must start with.
+ */
+//--------------------------------------------------------------------------------------------------
+#define APPDELTA_MANIFEST           "manifest"
+#define APPDELTA_MANIFEST_HEADER    "legato-app-delta 2"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number at the start of every patch file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define APPDELTA_PATCH_MAGIC        "LEDELTA1"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild an app from a delta that has been unpacked into a directory and the base app the delta
+ * was made against.  On success, APPDELTA_DIR has been removed from the unpack directory, which
+ * then holds the complete app.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the delta is malformed or doesn't match the base app.
+ *      - LE_FAULT for any other failure.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t appDelta_Apply
+(
+    const char* unpackDirPtr,   ///< [IN] Directory the delta was unpacked into.
+    const char* baseDirPtr      ///< [IN] Directory of the (installed) base app.
+);
+
+
+#endif // LEGATO_APP_DELTA_H_INCLUDE_GUARD
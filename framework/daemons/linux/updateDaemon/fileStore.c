@@ -0,0 +1,392 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file fileStore.c
+ *
+ * Implementation of the content-addressed file store (see fileStore.h).
+ *
+ * Files are stored as FILESTORE_PATH/<namespace>/<key>, where the key is made of the file's CRC32,
+ * size, permissions and owner.  Since a CRC32 match doesn't prove that two files are identical,
+ * the contents are always compared before a file is replaced by a link.  Different files with the
+ * same key are stored as <key>.1, <key>.2, etc.
+ *
+ * Files are replaced by linking the stored file to a temporary name in the same directory and
+ * renaming that over the file, so a file is never missing, even if power is lost.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "fileStore.h"
+
+#include <fts.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Files smaller than this are not worth sharing.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MIN_FILE_BYTES      1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of different files with the same key.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_COLLISIONS      8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffers used to read files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define READ_CHUNK_BYTES    4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the CRC32 of a file's contents.
+ *
+ * @return LE_OK if successful, LE_FAULT if the file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ComputeCrc
+(
+    const char* pathPtr,    ///< [IN] File.
+    uint32_t* crcPtr        ///< [OUT] CRC32.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(pathPtr, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    uint8_t buf[READ_CHUNK_BYTES];
+    uint32_t crc = LE_CRC_START_CRC32;
+    ssize_t count;
+
+    while ((count = fd_ReadSize(fd, buf, sizeof(buf))) > 0)
+    {
+        crc = le_crc_Crc32(buf, count, crc);
+    }
+
+    fd_Close(fd);
+
+    if (count < 0)
+    {
+        LE_ERROR("Failed to read '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    *crcPtr = crc;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare the contents of two files of the same size.
+ *
+ * @return true if they are identical.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSameContent
+(
+    const char* path1Ptr,   ///< [IN] First file.
+    const char* path2Ptr    ///< [IN] Second file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isSame = false;
+    int fd1 = open(path1Ptr, O_RDONLY | O_CLOEXEC);
+    int fd2 = open(path2Ptr, O_RDONLY | O_CLOEXEC);
+
+    if ((fd1 >= 0) && (fd2 >= 0))
+    {
+        uint8_t buf1[READ_CHUNK_BYTES];
+        uint8_t buf2[READ_CHUNK_BYTES];
+
+        for (;;)
+        {
+            ssize_t count1 = fd_ReadSize(fd1, buf1, sizeof(buf1));
+            ssize_t count2 = fd_ReadSize(fd2, buf2, sizeof(buf2));
+
+            if ((count1 < 0) || (count1 != count2) || (memcmp(buf1, buf2, count1) != 0))
+            {
+                break;
+            }
+
+            if (count1 == 0)
+            {
+                isSame = true;
+                break;
+            }
+        }
+    }
+
+    if (fd1 >= 0)
+    {
+        fd_Close(fd1);
+    }
+    if (fd2 >= 0)
+    {
+        fd_Close(fd2);
+    }
+
+    return isSame;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace a file by a hard link to another (identical) file.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReplaceByLink
+(
+    const char* storedPathPtr,  ///< [IN] File in the store.
+    const char* pathPtr         ///< [IN] File to replace.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char tmpPath[LIMIT_MAX_PATH_BYTES];
+
+    if (snprintf(tmpPath, sizeof(tmpPath), "%s.fileStore", pathPtr) >= sizeof(tmpPath))
+    {
+        return LE_FAULT;
+    }
+
+    (void)unlink(tmpPath);
+
+    if (link(storedPathPtr, tmpPath) != 0)
+    {
+        LE_WARN("Failed to link '%s' to '%s' (%m).", tmpPath, storedPathPtr);
+        return LE_FAULT;
+    }
+
+    if (rename(tmpPath, pathPtr) != 0)
+    {
+        LE_WARN("Failed to rename '%s' to '%s' (%m).", tmpPath, pathPtr);
+        (void)unlink(tmpPath);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share one file: replace it by a link to an identical stored file, or add it to the store.
+ *
+ * @return true if the file was replaced by a link (so its space was saved).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool AddFile
+(
+    const char* pathPtr,        ///< [IN] File.
+    const struct stat* statPtr, ///< [IN] File's status.
+    const char* storeDirPtr     ///< [IN] Namespace directory in the store.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t crc;
+
+    if (ComputeCrc(pathPtr, &crc) != LE_OK)
+    {
+        return false;
+    }
+
+    char storedPath[LIMIT_MAX_PATH_BYTES];
+    int keyLen = snprintf(storedPath, sizeof(storedPath), "%s/%08x-%llx-%o-%u-%u",
+                          storeDirPtr,
+                          crc,
+                          (unsigned long long)statPtr->st_size,
+                          (unsigned int)(statPtr->st_mode & 07777),
+                          (unsigned int)statPtr->st_uid,
+                          (unsigned int)statPtr->st_gid);
+    LE_ASSERT(keyLen < sizeof(storedPath) - 4);
+
+    int i;
+
+    for (i = 0; i < MAX_COLLISIONS; i++)
+    {
+        if (i > 0)
+        {
+            snprintf(storedPath + keyLen, sizeof(storedPath) - keyLen, ".%d", i);
+        }
+
+        struct stat storedStat;
+
+        if (lstat(storedPath, &storedStat) != 0)
+        {
+            // No stored file is identical.  Add this one.
+            if (link(pathPtr, storedPath) != 0)
+            {
+                LE_DEBUG("Failed to link '%s' to '%s' (%m).", storedPath, pathPtr);
+            }
+            return false;
+        }
+
+        if ((storedStat.st_dev == statPtr->st_dev) && (storedStat.st_ino == statPtr->st_ino))
+        {
+            // Already shared.
+            return false;
+        }
+
+        if (S_ISREG(storedStat.st_mode) && IsSameContent(storedPath, pathPtr))
+        {
+            return (ReplaceByLink(storedPath, pathPtr) == LE_OK);
+        }
+    }
+
+    LE_DEBUG("Too many files with the same key as '%s'.", pathPtr);
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace the regular files found in a directory tree by hard links to identical files in the
+ * store, and add the others to the store.
+ *
+ * Failing to share a file is not an error (the file just keeps taking its own space).
+ */
+//--------------------------------------------------------------------------------------------------
+void fileStore_AddTree
+(
+    const char* dirPathPtr,     ///< [IN] Directory whose files are to be shared.
+    const char* namespacePtr    ///< [IN] Namespace (SMACK label of the files).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char storeDir[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (le_path_Concat("/", storeDir, sizeof(storeDir), FILESTORE_PATH, namespacePtr, NULL)
+        != LE_OK)
+    {
+        LE_ERROR("File store namespace '%s' is too long.", namespacePtr);
+        return;
+    }
+
+    if (le_dir_MakePath(storeDir, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Failed to create directory '%s'.", storeDir);
+        return;
+    }
+
+    if (!le_dir_IsDir(dirPathPtr))
+    {
+        return;
+    }
+
+    char* pathArrayPtr[] = { (char*)dirPathPtr, NULL };
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL, NULL);
+
+    LE_FATAL_IF(ftsPtr == NULL, "Could not access dir '%s'.  %m.", dirPathPtr);
+
+    size_t sharedCount = 0;
+    off_t sharedBytes = 0;
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        // Files that already have other links are shared already (or are hard linked inside
+        // their app, in which case they are better left alone).
+        if (   (entPtr->fts_info == FTS_F)
+            && (entPtr->fts_statp->st_size >= MIN_FILE_BYTES)
+            && (entPtr->fts_statp->st_nlink == 1))
+        {
+            if (AddFile(entPtr->fts_path, entPtr->fts_statp, storeDir))
+            {
+                sharedCount++;
+                sharedBytes += entPtr->fts_statp->st_size;
+            }
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    LE_INFO("%zu files (%lld bytes) in '%s' shared with existing files.",
+            sharedCount,
+            (long long)sharedBytes,
+            dirPathPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the files in the store that are not used any more (that have no hard link other than the
+ * one in the store).
+ */
+//--------------------------------------------------------------------------------------------------
+void fileStore_RemoveUnused
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!le_dir_IsDir(FILESTORE_PATH))
+    {
+        return;
+    }
+
+    char* pathArrayPtr[] = { FILESTORE_PATH, NULL };
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL, NULL);
+
+    LE_FATAL_IF(ftsPtr == NULL, "Could not access dir '%s'.  %m.", FILESTORE_PATH);
+
+    size_t removedCount = 0;
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        switch (entPtr->fts_info)
+        {
+            case FTS_F:
+            case FTS_SL:
+            case FTS_SLNONE:
+            case FTS_DEFAULT:
+                if ((entPtr->fts_info != FTS_F) || (entPtr->fts_statp->st_nlink <= 1))
+                {
+                    if (unlink(entPtr->fts_path) != 0)
+                    {
+                        LE_ERROR("Unable to remove '%s' (%m).", entPtr->fts_path);
+                    }
+                    else
+                    {
+                        removedCount++;
+                    }
+                }
+                break;
+
+            case FTS_DP:
+                // Remove namespaces that have become empty (fails harmlessly if not empty).
+                if (entPtr->fts_level == 1)
+                {
+                    (void)rmdir(entPtr->fts_path);
+                }
+                break;
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    if (removedCount > 0)
+    {
+        LE_INFO("Removed %zu unused files from the file store.", removedCount);
+    }
+}
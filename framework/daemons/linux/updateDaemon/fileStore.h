@@ -0,0 +1,67 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file fileStore.h
+ *
+ * Content-addressed file store exported definitions.
+ *
+ * Installed apps and systems often contain identical files (the same library in every version of
+ * an app that is kept for roll-back, the framework libraries of every system snapshot, etc.).
+ * The file store keeps one hard link to each distinct file under FILESTORE_PATH, named after its
+ * content (CRC32, size, permissions and owner), and identical files that are installed later are
+ * replaced by hard links to it, so they take no extra space in flash.
+ *
+ * Because all hard links to a file share the same SMACK label, the store is divided into
+ * namespaces, and files are only shared within a namespace.  Callers use the SMACK label the files
+ * will have as the namespace.
+ *
+ * Files in the store must never be modified in place.  Only read-only files are added to it.
+ *
+ * A file that is no longer used by any app or system is only linked from the store, and is
+ * removed by fileStore_RemoveUnused().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_FILE_STORE_H_INCLUDE_GUARD
+#define LEGATO_FILE_STORE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Absolute file system path of the file store (unit tests build the store somewhere else).
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef FILESTORE_PATH
+#define FILESTORE_PATH  "/legato/fileStore"
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace the regular files found in a directory tree by hard links to identical files in the
+ * store, and add the others to the store.
+ *
+ * Failing to share a file is not an error (the file just keeps taking its own space).
+ */
+//--------------------------------------------------------------------------------------------------
+void fileStore_AddTree
+(
+    const char* dirPathPtr,     ///< [IN] Directory whose files are to be shared.
+    const char* namespacePtr    ///< [IN] Namespace (SMACK label of the files).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the files in the store that are not used any more (that have no hard link other than the
+ * one in the store).
+ */
+//--------------------------------------------------------------------------------------------------
+void fileStore_RemoveUnused
+(
+    void
+);
+
+
+#endif // LEGATO_FILE_STORE_H_INCLUDE_GUARD
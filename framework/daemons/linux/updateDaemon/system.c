@@ -23,6 +23,7 @@
 #include "sysPaths.h"
 #include "sysStatus.h"
 #include "smack.h"
+#include "fileStore.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -282,6 +283,27 @@ static void SetSystemFilesPermissions
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share the files of a system's 'lib' directory that are identical to files of other systems
+ * (see fileStore.h).  Must be done after SetSystemFilesPermissions(), as the files are shared in
+ * the namespace of their SMACK label ('_').
+ */
+//--------------------------------------------------------------------------------------------------
+static void ShareSystemLibs
+(
+    const char* systemPath          ///< [IN] Path to the system.
+)
+{
+    char systemLibPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    LE_ASSERT(snprintf(systemLibPath, sizeof(systemLibPath), "%s/%s", systemPath, "lib")
+              < sizeof(systemLibPath));
+
+    fileStore_AddTree(systemLibPath, "_");
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a given system's index.
@@ -744,6 +766,9 @@ le_result_t system_FinishUpdate
     // path to some index.
     SetSystemFilesPermissions(system_UnpackPath);
 
+    // Share the libraries with the other systems.
+    ShareSystemLibs(system_UnpackPath);
+
     // Now, move the unpacked system into its index.
     char newSystemPath[100] = "";
     snprintf(newSystemPath, sizeof(newSystemPath), "%s/%d", SystemPath, currentIndex);
@@ -788,6 +813,9 @@ le_result_t system_Snapshot
         return LE_FAULT;
     }
 
+    // The snapshot's libraries are the current system's.  Don't keep two copies.
+    ShareSystemLibs(system_UnpackPath);
+
     // Make sure everything under appsWriteable is copied too.  This is necessary because sandboxed
     // apps under appsWriteable may have been bind mounted unto itself.
     DIR* appsWriteableDir = opendir(APPS_WRITEABLE_DIR);
@@ -1009,12 +1037,13 @@ bool system_HasApp
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Delete any apps that are not used by any systems (including the "unpack" system, if there is one).
+ * Delete any apps that are not used by any systems (including the "unpack" system, if there is one),
+ * and the files of the file store that are not used any more.
  */
 //--------------------------------------------------------------------------------------------------
 void system_RemoveUnusedApps
 (
-    void
+    const char* keepAppHashPtr  ///< [IN] Hash of an app to keep even if unused (NULL if none).
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -1032,7 +1061,8 @@ void system_RemoveUnusedApps
             {
                 char* foundHashPtr = le_path_GetBasenamePtr(entPtr->fts_path, "/");
 
-                if (!system_AppUsedInAnySystem(foundHashPtr))
+                if (   ((keepAppHashPtr == NULL) || (strcmp(foundHashPtr, keepAppHashPtr) != 0))
+                    && !system_AppUsedInAnySystem(foundHashPtr))
                 {
                     LE_INFO("Removing unused app with MD5 sum %s.", foundHashPtr);
 
@@ -1057,6 +1087,10 @@ void system_RemoveUnusedApps
     }
 
     fts_close(ftsPtr);
+
+    // The files of the removed apps (and of the systems removed before calling this) that no
+    // other app or system uses are now only linked from the file store.
+    fileStore_RemoveUnused();
 }
 
 
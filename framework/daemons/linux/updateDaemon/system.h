@@ -270,12 +270,13 @@ bool system_AppUsedInAnySystem
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Delete any apps that are not used by any systems (including the "unpack" system, if there is one).
+ * Delete any apps that are not used by any systems (including the "unpack" system, if there is one),
+ * and the files of the file store that are not used any more.
  */
 //--------------------------------------------------------------------------------------------------
 void system_RemoveUnusedApps
 (
-    void
+    const char* keepAppHashPtr  ///< [IN] Hash of an app to keep even if unused (NULL if none).
 );
 
 
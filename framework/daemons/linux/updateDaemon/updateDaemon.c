@@ -233,7 +233,7 @@ void updateDaemon_MarkGood
     le_timer_Stop(ProbationTimer);
     sysStatus_MarkGood();
     system_RemoveUnneeded();
-    system_RemoveUnusedApps();
+    system_RemoveUnusedApps(NULL);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -540,7 +540,9 @@ static le_result_t InstallSystemApps
                         return LE_FAULT;
                     }
 
-                    // Now setup the smack permission.
+                    // Share files with the other apps, then setup the smack permission.
+                    app_ShareFiles(appMd5Hash, appName);
+
                     if (app_SetSmackPermReadOnly(appMd5Hash, appName) != LE_OK)
                     {
                         LE_CRIT("Failed to setup smack permission for app '%s<%s>'",
@@ -2021,7 +2023,7 @@ le_result_t le_appRemove_Remove
 
     // Make sure there's space to make a snapshot if we need to.
     system_RemoveUnneeded();
-    system_RemoveUnusedApps();
+    system_RemoveUnusedApps(NULL);
 
     // If the removal was successful, kick off the probation timer.
     le_result_t result = app_RemoveIndividual(appName);
@@ -19,6 +19,7 @@
 #include "fileDescriptor.h"
 #include "system.h"
 #include "app.h"
+#include "appDelta.h"
 
 
 /// An MD5 hash string is 32 characters long, plus a null terminator.
@@ -51,6 +52,9 @@ static char AppName[LIMIT_MAX_APP_NAME_BYTES];
 /// The MD5 hash obtained from a JSON header.
 static char Md5[MD5_STRING_BYTES]; ///< The system's MD5 hash.
 
+/// The MD5 hash of the installed app an app update is a delta against (empty if not a delta).
+static char BaseMd5[MD5_STRING_BYTES];
+
 /// # of bytes of payload following the JSON.
 static size_t PayloadSize;
 
@@ -349,6 +353,7 @@ static void StartParsing
     Command[0] = '\0';
     AppName[0] = '\0';
     Md5[0] = '\0';
+    BaseMd5[0] = '\0';
     PayloadSize = 0;
 
     // Set the state
@@ -359,6 +364,88 @@ static void StartParsing
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a string is an MD5 hash (32 lower-case hex digits).
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsMd5
+(
+    const char* strPtr  ///< [IN] The string to check.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < MD5_STRING_BYTES - 1; i++)
+    {
+        if (!isxdigit((unsigned char)strPtr[i]) || isupper((unsigned char)strPtr[i]))
+        {
+            return false;
+        }
+    }
+
+    return (strPtr[i] == '\0');
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * If the app that has just been unpacked is a delta, rebuild the complete app from it and the
+ * installed base app.
+ *
+ * @return true if successful, false if an error was reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ApplyAppDelta
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((strcmp(Command, "updateApp") != 0) || (BaseMd5[0] == '\0'))
+    {
+        return true;
+    }
+
+    char unpackPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (Type == TYPE_APP_UPDATE)
+    {
+        le_utf8_Copy(unpackPath, app_UnpackPath, sizeof(unpackPath), NULL);
+    }
+    else
+    {
+        le_path_Concat("/", unpackPath, sizeof(unpackPath), app_UnpackPath, Md5, NULL);
+    }
+
+    char baseDir[LIMIT_MAX_PATH_BYTES] = "";
+
+    LE_ASSERT(snprintf(baseDir, sizeof(baseDir), "/legato/apps/%s", BaseMd5) < sizeof(baseDir));
+
+    le_result_t result = appDelta_Apply(unpackPath, baseDir);
+
+    if (result == LE_FORMAT_ERROR)
+    {
+        LE_ERROR("Malformed update pack (bad delta for app '%s' against <%s>).",
+                 AppName,
+                 BaseMd5);
+        HandleFormatError();
+        return false;
+    }
+    else if (result != LE_OK)
+    {
+        LE_ERROR("Failed to apply delta for app '%s'.", AppName);
+        HandleInternalError();
+        return false;
+    }
+
+    return true;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Completion callback for "tar xj" operation.
@@ -393,6 +480,11 @@ static void UntarDone
         return;
     }
 
+    if (!ApplyAppDelta())
+    {
+        return;
+    }
+
     // If this update pack contains changes to individual apps,
     if (Type == TYPE_APP_UPDATE)
     {
@@ -409,7 +501,7 @@ static void UntarDone
         // systems.
         if (strcmp(Command, "updateSystem") == 0)
         {
-            system_RemoveUnusedApps();
+            system_RemoveUnusedApps(NULL);
         }
         // After the unpack of one of the apps, we rename the app to the appropriate location
         // and copy over any writable files that may have been inherited from an earlier version
@@ -849,8 +941,16 @@ static void JsonDone
             LE_ERROR("Malformed update pack (app update payload missing)");
             HandleFormatError();
         }
+        // The base hash becomes part of a path, so it must really be a hash.
+        else if ((BaseMd5[0] != '\0') && !IsMd5(BaseMd5))
+        {
+            LE_ERROR("Malformed update pack (bad base app hash '%s').", BaseMd5);
+            HandleFormatError();
+        }
         else
         {
+            bool isDelta = (BaseMd5[0] != '\0') && (app_Exists(Md5) == false);
+
             if (Type == TYPE_UNKNOWN)
             {
                 Type = TYPE_APP_UPDATE;
@@ -858,11 +958,22 @@ static void JsonDone
                 // Make space by removing extra systems.
                 system_RemoveUnneeded();
 
-                // Make space by removing unneeded apps.
-                system_RemoveUnusedApps();
+                // Make space by removing unneeded apps, but keep the app the delta is against,
+                // even if it was only used by one of the systems that were just removed.
+                system_RemoveUnusedApps(isDelta ? BaseMd5 : NULL);
             }
 
-            if (app_Exists(Md5) == false)
+            // A delta can only be applied if the app it was made against is installed.  This is
+            // checked after the clean-up above, or the clean-up done earlier in this update,
+            // because those can remove apps.
+            if (isDelta && (app_Exists(BaseMd5) == false))
+            {
+                LE_ERROR("App '%s' is a delta against <%s>, which is not installed.",
+                         AppName,
+                         BaseMd5);
+                HandleFormatError();
+            }
+            else if (app_Exists(Md5) == false)
             {
                 LE_INFO("App with MD5 sum %s being unpacked.", Md5);
 
@@ -925,7 +1036,7 @@ static void JsonDone
 
                 // Make space by removing extra systems and apps.
                 system_RemoveUnneeded();
-                system_RemoveUnusedApps();
+                system_RemoveUnusedApps(NULL);
             }
 
             AppUnpackDone();
@@ -1045,6 +1156,21 @@ static void Md5EventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * "base" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BaseMd5EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StringMemberEventHandler(event, BaseMd5, sizeof(BaseMd5), "base app MD5 hash");
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * "version" member parsing event function.
@@ -1160,6 +1286,10 @@ static void JsonEventHandler
             {
                 le_json_SetEventHandler(NameEventHandler);
             }
+            else if (strcmp(memberName, "base") == 0)
+            {
+                le_json_SetEventHandler(BaseMd5EventHandler);
+            }
             else if (strcmp(memberName, "version") == 0)
             {
                 le_json_SetEventHandler(VersionEventHandler);
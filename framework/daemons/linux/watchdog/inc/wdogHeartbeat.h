@@ -0,0 +1,30 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file wdogHeartbeat.h
+ *
+ * Layout of the heartbeat pages given out by le_wdog_GetHeartbeat(), shared by the watchdog daemon
+ * and its clients.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_WDOG_HEARTBEAT_INCLUDE_GUARD
+#define LEGATO_WDOG_HEARTBEAT_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of a heartbeat page.  The offsets of the members are part of the le_wdog API, and both are
+ * only accessed atomically, because the process and the watchdog daemon share the page.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t kickTime;      ///< Time of the last kick (ms, relative clock).  Written by the process.
+    uint32_t isWatched;     ///< Non-zero while the daemon watches the page.  Written by the daemon.
+}
+wdogHeartbeat_Page_t;
+
+
+#endif // LEGATO_WDOG_HEARTBEAT_INCLUDE_GUARD
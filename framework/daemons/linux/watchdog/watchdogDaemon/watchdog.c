@@ -95,6 +95,18 @@
  * the threshold value is increased until a point at which all allowable watchdog resources have
  * been allocated at which point no more will be be created.
  *
+ * Heartbeat
+ * A process can also kick its watchdog without IPC, by storing the time in the heartbeat page
+ * returned by le_wdog_GetHeartbeat().  Each process gets its own page, so no process can kick
+ * another's watchdog.  Heartbeat kicks are not seen as they happen.  Instead:
+ *    when a watchdog's timer expires, its heartbeat is checked, and if the process has kicked
+ *    since the timer was started, the timer is restarted for the rest of the interval after
+ *    that kick, and
+ *    a scan timer (running only while there are heartbeat pages) starts the timers of watchdogs
+ *    that are kicked while stopped, and restarts those whose new deadline is earlier (because
+ *    of a shorter le_wdog_Timeout()).
+ * So kicking through the heartbeat costs the daemon nothing, whatever the kick rate.
+ *
  * @note Critical systems rely on the watchdog daemon to ensure system liveness, so all
  * unrecoverable errors in the watchdogDaemon are considered fatal to the system, and will
  * cause a system reboot by calling LE_FATAL or LE_ASSERT.
@@ -108,6 +120,9 @@
 #include "user.h"
 #include "fileDescriptor.h"
 #include "pa_wdog.h"
+#include "wdogHeartbeat.h"
+
+#include <sys/mman.h>
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -210,6 +225,20 @@
 //--------------------------------------------------------------------------------------------------
 #define SYSTEM_FRAMEWORK_CFG "/framework"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the file backing a process's heartbeat page (the parameter is the process ID).
+ */
+//--------------------------------------------------------------------------------------------------
+#define HEARTBEAT_PATH_FORMAT "/tmp/legato-wdog.%d"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interval at which heartbeat pages are scanned for kicks of stopped watchdogs (in milliseconds).
+ */
+//--------------------------------------------------------------------------------------------------
+#define HEARTBEAT_SCAN_INTERVAL 1000
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Definition of Watchdog object, pool for allocation of watchdogs and container for organizing and
@@ -226,6 +255,10 @@ typedef struct
                                         ///< beyond it's maximum period by being treated as a
                                         ///< non-mandatory watchdog.
     le_timer_Ref_t timer;               ///< The timer this watchdog uses
+    wdogHeartbeat_Page_t* heartbeatPtr; ///< The process's heartbeat page, or NULL if none
+    uint64_t heartbeatSeen;             ///< Last heartbeat kick time that was acted upon
+    uint64_t deadline;                  ///< When the timer expires (ms, relative clock), or 0
+                                        ///< if unknown.  Only kept up to date for heartbeats.
 }
 WatchdogObj_t;
 
@@ -273,6 +306,11 @@ static le_hashmap_Ref_t MandatoryWatchdogRefs;  ///< The container used to track
 
 static le_timer_Ref_t DefaultExternalWdogTimer; ///< Default external wdog timer
 
+static le_timer_Ref_t HeartbeatScanTimer;       ///< Timer scanning the heartbeat pages
+static size_t HeartbeatCount;                   ///< Number of heartbeat pages being watched
+
+static le_clk_Time_t MakeTimerInterval(uint64_t milliseconds);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trace reference used for controlling tracing in this module.
@@ -287,6 +325,171 @@ static le_log_TraceRef_t TraceRef;
 /// Macro used to query current trace state in this module
 #define IS_TRACE_ENABLED LE_IS_TRACE_ENABLED(TraceRef)
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time in milliseconds, the time base of the heartbeat pages.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowMs
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000) + (now.usec / 1000);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop watching a watchdog's heartbeat page, if it has one.  The page is marked as no longer
+ * watched, so the process will fall back to le_wdog_Kick().
+ */
+//--------------------------------------------------------------------------------------------------
+static void DetachHeartbeat
+(
+    WatchdogObj_t* dogPtr
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    if (dogPtr->heartbeatPtr == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&(dogPtr->heartbeatPtr->isWatched), 0, __ATOMIC_RELEASE);
+    LE_ASSERT(munmap(dogPtr->heartbeatPtr, LE_WDOG_HEARTBEAT_PAGE_BYTES) == 0);
+    dogPtr->heartbeatPtr = NULL;
+
+    snprintf(path, sizeof(path), HEARTBEAT_PATH_FORMAT, dogPtr->procId);
+    if ((unlink(path) != 0) && (errno != ENOENT))
+    {
+        LE_WARN("Failed to remove '%s' (%m).", path);
+    }
+
+    LE_ASSERT(HeartbeatCount > 0);
+    if (--HeartbeatCount == 0)
+    {
+        le_timer_Stop(HeartbeatScanTimer);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a watchdog's (stopped) timer, unless the timeout is LE_WDOG_TIMEOUT_NEVER.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartWatchdogTimer
+(
+    WatchdogObj_t* dogPtr,
+    le_clk_Time_t timeoutValue
+)
+{
+    if (!le_clk_Equal(timeoutValue, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)))
+    {
+        // timer should be stopped here so this should never fail
+        LE_ASSERT(LE_OK == le_timer_SetInterval(dogPtr->timer, timeoutValue));
+        le_timer_Start(dogPtr->timer);
+        dogPtr->deadline = GetNowMs() + (timeoutValue.sec * 1000) + (timeoutValue.usec / 1000);
+    }
+    else
+    {
+        LE_DEBUG("Timeout set to NEVER!");
+        dogPtr->deadline = 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Act upon a heartbeat kick, if there was one that hasn't been acted upon yet: (re)start the
+ * watchdog's timer for what is left of the kick timeout interval after the kick.
+ *
+ * If the timer is running (and hasn't expired), this is only done if it brings the deadline
+ * forward.  Otherwise it is left to the timer's expiry, to avoid touching the timer on every scan.
+ *
+ * @return true if the watchdog was kicked and hasn't expired, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckHeartbeat
+(
+    WatchdogObj_t* dogPtr,
+    bool isExpired          ///< true if called because the watchdog's timer expired.
+)
+{
+    if (dogPtr->heartbeatPtr == NULL)
+    {
+        return false;
+    }
+
+    uint64_t kickTime = __atomic_load_n(&(dogPtr->heartbeatPtr->kickTime), __ATOMIC_ACQUIRE);
+    if (kickTime == dogPtr->heartbeatSeen)
+    {
+        return false;
+    }
+
+    bool isNever = le_clk_Equal(dogPtr->kickTimeoutInterval,
+                                MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER));
+    uint64_t newDeadline = kickTime + (dogPtr->kickTimeoutInterval.sec * 1000) +
+                           (dogPtr->kickTimeoutInterval.usec / 1000);
+
+    if (   (!isExpired)
+        && le_timer_IsRunning(dogPtr->timer)
+        && (isNever || (dogPtr->deadline == 0) || (newDeadline >= dogPtr->deadline)))
+    {
+        return false;
+    }
+
+    TRACE("Heartbeat kick from %d", dogPtr->procId);
+    dogPtr->heartbeatSeen = kickTime;
+    le_timer_Stop(dogPtr->timer);
+
+    if (isNever)
+    {
+        StartWatchdogTimer(dogPtr, dogPtr->kickTimeoutInterval);
+        return true;
+    }
+
+    uint64_t now = GetNowMs();
+    if (newDeadline <= now)
+    {
+        return false;
+    }
+
+    StartWatchdogTimer(dogPtr, MakeTimerInterval(newDeadline - now));
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a watchdog's heartbeat.  Called for each watchdog by the heartbeat scan timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ScanHeartbeat
+(
+    const void* keyPtr,
+    const void* valuePtr,
+    void* contextPtr
+)
+{
+    CheckHeartbeat((WatchdogObj_t*)valuePtr, false);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for the heartbeat scan timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HeartbeatScanHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    le_hashmap_ForEach(WatchdogRefsContainer, ScanHeartbeat, NULL);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Remove the watchdog from our container, free the timer it contains and then free the storage
@@ -303,6 +506,7 @@ static void DeleteWatchdog
     {
         // All good. The dog was in the hash
         LE_DEBUG("Cleaning up watchdog resources for %d", deadDogPtr->procId);
+        DetachHeartbeat(deadDogPtr);
         // Give the watchdog one more kick if it hasn't had one, then release it.
         // This allows mandatory watchdogs (which still exist in the MandatoryWatchdogRefs
         // one more kick to restart before they're considered expired.
@@ -479,6 +683,13 @@ static void WatchdogHandleExpiry
 )
 {
     WatchdogObj_t* watchDogPtr = le_timer_GetContextPtr(timerRef);
+
+    // The process may have kicked through its heartbeat page since the timer was started.
+    if (CheckHeartbeat(watchDogPtr, true))
+    {
+        return;
+    }
+
     if (watchDogPtr->procId == NO_PROC)
     {
         // Mandatory watchdog expired without the process restarting.  Restart Legato.
@@ -819,6 +1030,9 @@ static void InitNewWatchdog
     char timerName[LIMIT_MAX_TIMER_NAME_BYTES];
 
     newDogPtr->procId = clientPid;
+    newDogPtr->heartbeatPtr = NULL;
+    newDogPtr->heartbeatSeen = 0;
+    newDogPtr->deadline = 0;
     newDogPtr->kickTimeoutInterval = kickTimeoutInterval;
     newDogPtr->maxKickTimeoutInterval = maxKickTimeoutInterval;
 
@@ -1034,6 +1248,14 @@ static void ResetClientWatchdog
     if (watchDogPtr != NULL)
     {
         le_timer_Stop(watchDogPtr->timer);
+
+        // This supersedes any heartbeat kick made so far.
+        if (watchDogPtr->heartbeatPtr != NULL)
+        {
+            watchDogPtr->heartbeatSeen = __atomic_load_n(&(watchDogPtr->heartbeatPtr->kickTime),
+                                                         __ATOMIC_ACQUIRE);
+        }
+
         if (timeout == TIMEOUT_KICK)
         {
             timeoutValue = watchDogPtr->kickTimeoutInterval;
@@ -1055,16 +1277,7 @@ static void ResetClientWatchdog
             }
         }
 
-        if (!le_clk_Equal(timeoutValue, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)))
-        {
-            // timer should be stopped here so this should never fail
-            LE_ASSERT(LE_OK == le_timer_SetInterval(watchDogPtr->timer, timeoutValue));
-            le_timer_Start(watchDogPtr->timer);
-        }
-        else
-        {
-            LE_DEBUG("Timeout set to NEVER!");
-        }
+        StartWatchdogTimer(watchDogPtr, timeoutValue);
     }
 }
 
@@ -1159,6 +1372,93 @@ le_result_t le_wdog_GetWatchdogTimeout
     return LE_NOT_FOUND;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get this process's heartbeat page.  The process can then kick its watchdog by atomically
+ * storing the current time (in milliseconds, as returned by le_clk_GetRelativeTime()) as a
+ * uint64_t at offset 0 of the page, instead of calling le_wdog_Kick().
+ *
+ * All the sessions of a process get the same page.
+ *
+ * @return
+ *      - LE_OK            The heartbeat page was returned
+ *      - LE_FAULT         The heartbeat page couldn't be created (use le_wdog_Kick() instead)
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_wdog_GetHeartbeat
+(
+    int* fdPtr
+        ///< [OUT] File descriptor of the heartbeat page
+)
+{
+    if (fdPtr == NULL)
+    {
+        LE_KILL_CLIENT("fdPtr is NULL.");
+        return LE_FAULT;
+    }
+
+    *fdPtr = -1;
+
+    WatchdogObj_t* watchDogPtr = GetClientWatchdogPtr();
+    if (watchDogPtr == NULL)
+    {
+        return LE_FAULT;
+    }
+
+    char path[LIMIT_MAX_PATH_BYTES];
+    snprintf(path, sizeof(path), HEARTBEAT_PATH_FORMAT, watchDogPtr->procId);
+
+    if (watchDogPtr->heartbeatPtr != NULL)
+    {
+        // The IPC layer closes the fd once it's sent, so open the page again.
+        *fdPtr = open(path, O_RDWR | O_CLOEXEC | O_NOFOLLOW);
+        if (*fdPtr < 0)
+        {
+            LE_ERROR("Failed to open '%s' (%m).", path);
+            return LE_FAULT;
+        }
+        return LE_OK;
+    }
+
+    // A file left by an earlier process with the same PID is of no use.
+    (void)unlink(path);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", path);
+        return LE_FAULT;
+    }
+
+    void* pagePtr = MAP_FAILED;
+    if (ftruncate(fd, LE_WDOG_HEARTBEAT_PAGE_BYTES) == 0)
+    {
+        pagePtr = mmap(NULL, LE_WDOG_HEARTBEAT_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+    }
+    if (pagePtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map '%s' (%m).", path);
+        fd_Close(fd);
+        (void)unlink(path);
+        return LE_FAULT;
+    }
+
+    watchDogPtr->heartbeatPtr = pagePtr;
+    watchDogPtr->heartbeatSeen = 0;
+    __atomic_store_n(&(watchDogPtr->heartbeatPtr->isWatched), 1, __ATOMIC_RELEASE);
+
+    if (HeartbeatCount++ == 0)
+    {
+        le_timer_Start(HeartbeatScanTimer);
+    }
+
+    LE_DEBUG("Heartbeat page created for %d", watchDogPtr->procId);
+
+    *fdPtr = fd;
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the max watchdog timeout configured for this process
@@ -1518,6 +1818,14 @@ COMPONENT_INIT
     le_timer_SetRepeat(DefaultExternalWdogTimer, 0); // repeat indefinitely
     le_timer_SetWakeup(DefaultExternalWdogTimer, false);
     le_timer_Start(DefaultExternalWdogTimer);
+
+    // The heartbeat scan timer is only started while there are heartbeat pages.
+    HeartbeatScanTimer = le_timer_Create("HeartbeatScanTimer");
+    le_timer_SetMsInterval(HeartbeatScanTimer, HEARTBEAT_SCAN_INTERVAL);
+    le_timer_SetHandler(HeartbeatScanTimer, HeartbeatScanHandler);
+    le_timer_SetRepeat(HeartbeatScanTimer, 0);
+    le_timer_SetWakeup(HeartbeatScanTimer, false);
+
     pa_wdog_Init();
 
     LE_INFO("The watchdog service is ready");
@@ -20,6 +20,9 @@
  * @note It is possible to compute a "global" CRC32 of a huge amount of data by splitting into small
  * blocks and continue computing the CRC32 on each one.
  *
+ * The CRC32 is computed 8 bytes at a time, using the CPU's CRC32 or carry-less multiplication
+ * instructions when available, so it is fast enough for multi-megabyte images.
+ *
  * This code compute the whole CRC32 of amount of data splitted into an array of small blocks:
  * @code
  * #define MAX_BLOCKS 4  // Maximum number of blocks
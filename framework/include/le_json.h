@@ -109,9 +109,66 @@
  * still go to <c>TopLevelHandler()</c>, because the context returns to the top level object
  * after the parser finishes parsing member "x".
  *
+ *  @section c_json_writer Writing JSON
+ *
+ * The JSON writer streams a document into a buffer provided by the caller, without allocating
+ * any memory.  The caller declares an @ref le_json_Writer_t (e.g., on the stack) and initializes
+ * it with either
+ * - le_json_InitBufferWriter(), to write the whole document into the buffer (which always holds
+ *   a null-terminated string), or
+ * - le_json_InitFdWriter(), to use the buffer to batch the output to a file descriptor.  The
+ *   buffer is written to the file descriptor when it is full, and by le_json_Flush().
+ *
+ * The document is then written, in order, with le_json_StartObject(), le_json_WriteMember(),
+ * le_json_WriteString(), le_json_WriteInt(), le_json_EndObject(), etc.  Commas and colons are
+ * added as needed, and strings are escaped.
+ *
+ * Each call either writes its whole token (with the comma before it) or nothing.  So, if it fails
+ * with:
+ * - LE_WOULD_BLOCK: the file descriptor is non-blocking and can't take any more data right now.
+ *   Wait for it to become writeable (e.g., using an @ref c_fdMonitor "FD Monitor"), then make the
+ *   same call again.
+ * - LE_OVERFLOW: a buffer writer's buffer is full, or a token is larger than an fd writer's
+ *   buffer.
+ * - LE_FORMAT_ERROR: the string is not valid UTF-8.
+ * - LE_FAULT: writing to the file descriptor failed.  All later calls fail the same way (and are
+ *   not checked for the errors below), so a document can be written without checking each call,
+ *   then checked by le_json_Flush().
+ *
+ * Only LE_FAULT is sticky.  After any other failure, the token is simply not written, and the
+ * document can't be completed unless that call (or another one in its place) succeeds.  So a
+ * document can only be written without checking each call if none of them can fail that way: the
+ * file descriptor is blocking, the buffer is larger than any token, and the strings are known to
+ * be valid UTF-8 (or their LE_FORMAT_ERROR is handled).
+ *
+ * For example, to write <c>{"name":"joe","ids":[1,2]}</c> to a file descriptor:
+ *
+ * @code
+ * char buffer[512];
+ * le_json_Writer_t writer;
+ *
+ * le_json_InitFdWriter(&writer, fd, buffer, sizeof(buffer));
+ * le_json_StartObject(&writer);
+ * le_json_WriteMember(&writer, "name");
+ * le_json_WriteString(&writer, "joe");
+ * le_json_WriteMember(&writer, "ids");
+ * le_json_StartArray(&writer);
+ * le_json_WriteInt(&writer, 1);
+ * le_json_WriteInt(&writer, 2);
+ * le_json_EndArray(&writer);
+ * le_json_EndObject(&writer);
+ * if (le_json_Flush(&writer) != LE_OK)
+ * {
+ *     LE_ERROR("Failed to write JSON document.");
+ * }
+ * @endcode
+ *
+ * Writing a value where it is not allowed (e.g., an object member's value without its name), or
+ * ending a context that was not started, is a programming error that is fatal to the process.
+ *
  *  @section c_json_threads Multi-Threading
  *
- * This API is not thread safe.  DO NOT attempt to SHARE parsers between threads.
+ * This API is not thread safe.  DO NOT attempt to SHARE parsers or writers between threads.
  *
  * If a thread dies, any parsers in use by that thread that have not been cleaned-up by calls to
  * le_json_Cleanup() will be cleaned up automatically.
@@ -404,4 +461,246 @@ le_json_ParsingSessionRef_t le_json_GetSession
 );
 
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum nesting depth of the objects and arrays of a document written by a JSON writer.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_JSON_WRITER_MAX_DEPTH    32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * JSON writer.  Declared by the caller (e.g., on the stack) and initialized by
+ * le_json_InitBufferWriter() or le_json_InitFdWriter().
+ *
+ * @warning The members of this structure must not be accessed directly.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* bufferPtr;        ///< Buffer provided by the caller.
+    size_t bufferSize;      ///< Number of bytes of the buffer that can be used.
+    size_t usedBytes;       ///< Number of bytes in the buffer not yet written to the fd.
+    size_t flushedBytes;    ///< Number of bytes written to the fd.
+    int fd;                 ///< File descriptor to write to, or -1 to write to the buffer only.
+    bool isFailed;          ///< True if writing to the file descriptor failed.
+    bool isMemberNamed;     ///< True if an object member's name was written, but not its value.
+    uint8_t depth;          ///< Number of objects and arrays started but not ended.
+    uint32_t objectMask;    ///< Bit (1 << (depth - 1)) is set if that context is an object.
+    uint32_t nonEmptyMask;  ///< Bit (1 << (depth - 1)) is set if that context has any element.
+}
+le_json_Writer_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a JSON writer that writes a document into a buffer.  The buffer always holds a
+ * null-terminated string.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_InitBufferWriter
+(
+    le_json_Writer_t* writerPtr,    ///< [OUT] Writer.
+    char* bufferPtr,                ///< [IN] Buffer to write the document into.
+    size_t bufferSize               ///< [IN] Size of the buffer (bytes).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a JSON writer that writes a document to a file descriptor, through a buffer.
+ *
+ * The buffer must be larger than any single token (e.g., string value) of the document.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_InitFdWriter
+(
+    le_json_Writer_t* writerPtr,    ///< [OUT] Writer.
+    int fd,                         ///< [IN] File descriptor to write to.
+    char* bufferPtr,                ///< [IN] Buffer.
+    size_t bufferSize               ///< [IN] Size of the buffer (bytes).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the contents of a JSON writer's buffer to its file descriptor.  Does nothing for a writer
+ * initialized by le_json_InitBufferWriter().
+ *
+ * @return
+ *      - LE_OK if all the buffered data was written.
+ *      - LE_WOULD_BLOCK if the file descriptor couldn't take all of it (try again later).
+ *      - LE_FAULT if writing to the file descriptor failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_Flush
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes written so far by a JSON writer (into its buffer or to its file
+ * descriptor), not counting the null-terminator of a buffer writer.
+ *
+ * @return The number of bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_json_GetBytesWritten
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an object.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_StartObject
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the current object.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_EndObject
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_StartArray
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the current array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_EndArray
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the name of a member of the current object.  Its value must be written next.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteMember
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    const char* namePtr             ///< [IN] Member name (UTF-8).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteString
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    const char* valuePtr            ///< [IN] Value (UTF-8).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a signed integer number value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteInt
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    int64_t value                   ///< [IN] Value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write an unsigned integer number value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteUint
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    uint64_t value                  ///< [IN] Value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a number value.  Infinite and NaN values, which JSON can't represent, are written as null.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteNumber
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    double value                    ///< [IN] Value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a true or false value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteBool
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    bool value                      ///< [IN] Value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a null value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteNull
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+);
+
 #endif // LEGATO_JSON_H_INCLUDE_GUARD
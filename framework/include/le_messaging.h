@@ -141,6 +141,12 @@
  *     msgPayloadPtr->... = ...; // <-- Populate message payload...
  * @endcode
  *
+ * Messages created by le_msg_CreateMsg() have room for the largest message of the protocol.  If
+ * a message (and its response) is known to be smaller, le_msg_CreateSizedMsg() can be used
+ * instead, and le_msg_SetPayloadSize() can be used to send only the part of the payload that is
+ * in use.  The receiving side sees the rest of the payload as zeros.  See
+ * @ref c_messagingMessageSizes.
+ *
  * If no response is required from the server, the client sends the message using le_msg_Send().
  * At this point, the client has handed off the message to the messaging system, and the messaging
  * system will delete the message automatically once it has finished sending it.
@@ -679,6 +685,20 @@
  * From this, they obtain a protocol reference that they provide to sessions when they create
  * them.
  *
+ * @subsection c_messagingMessageSizes Message Sizes
+ *
+ * Each protocol has a few message pools of different sizes (size classes), up to the size of the
+ * largest message.  le_msg_CreateMsg() always allocates from the largest, while
+ * le_msg_CreateSizedMsg() allocates from the smallest pool that fits the given payload size.
+ *
+ * Only the bytes of the payload that are in use are sent, if the sender says how many there are
+ * with le_msg_SetPayloadSize().  The receiver allocates a message big enough for the received
+ * payload and zero-fills the remainder.  Because a server writes its response into the request
+ * message, the receiver needs to know how big a response can be.  Protocols whose first payload
+ * word is a message ID (as in all interfaces generated by ifgen) can give the largest message
+ * size for each ID with le_msg_SetProtocolMsgSizes().  Messages with an unknown ID are received
+ * into messages of the protocol's largest size.
+ *
  * @section c_messagingSecurity Security
  *
  * Security is provided in the form of authentication and access control.
@@ -970,6 +990,24 @@ size_t le_msg_GetProtocolMaxMsgSize
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the size of the largest message (request or response) for each message ID of a protocol
+ * whose payloads start with a uint32_t message ID.  This allows received messages to be allocated
+ * from smaller message pools (see @ref c_messagingMessageSizes).
+ *
+ * The array must remain valid as long as the process runs (typically, it is a constant).  Only the
+ * first call for a protocol has any effect.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetProtocolMsgSizes
+(
+    le_msg_ProtocolRef_t protocolRef,   ///< [in] Reference to the protocol.
+    const size_t* msgSizesPtr,          ///< [in] Largest payload size for each message ID.
+    size_t msgCount                     ///< [in] Number of message IDs.
+);
+
+
 // =======================================
 //  SESSION FUNCTIONS
 // =======================================
@@ -1263,6 +1301,26 @@ le_msg_MessageRef_t le_msg_CreateMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a message to be sent over a given session, with a payload buffer of at least a given
+ * size (but no larger than the protocol's largest message).
+ *
+ * @return  Message reference.
+ *
+ * @note
+ * - Function never returns on failure, there's no need to check the return code.
+ * - On the client side, the payload size doesn't need to account for the response, which is
+ *   received in a different message.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_msg_CreateSizedMsg
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t payloadSize              ///< [in] Size (in bytes) of the payload needed.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Adds to the reference count on a message object.
@@ -1332,6 +1390,22 @@ size_t le_msg_GetMaxPayloadSize
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets how many bytes at the start of the message payload buffer are in use and need to be sent.
+ * By default, the whole buffer is sent.  The receiver sees the rest of the payload as zeros.
+ *
+ * @note A server must set this after writing its response, as the request was received in the
+ *       same buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadSize
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t payloadSize              ///< [in] Number of bytes in use (at most the buffer size).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the file descriptor to be sent with this message.
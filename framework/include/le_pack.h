@@ -476,6 +476,44 @@ static inline bool le_pack_PackArrayHeader
         }                                                               \
     } while (0)
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack an array of plain data elements (integers, chars or doubles) into a buffer, incrementing
+ * the buffer pointer and decrementing the available size.
+ *
+ * The array is packed the same way as by LE_PACK_PACKARRAY, but with a single copy instead of a
+ * call per element.
+ *
+ * @note Always decrements available size according to the max possible size used, not actual size
+ * used.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_PackPodArray
+(
+    uint8_t **bufferPtr,
+    size_t *sizePtr,
+    const void *arrayPtr,
+    size_t elementSize,
+    size_t arrayCount,
+    size_t arrayMaxCount
+)
+{
+    if (!le_pack_PackArrayHeader(bufferPtr, sizePtr, arrayPtr, elementSize,
+                                 arrayCount, arrayMaxCount))
+    {
+        return false;
+    }
+
+    if (arrayCount > 0)
+    {
+        memcpy(*bufferPtr, arrayPtr, arrayCount*elementSize);
+        *bufferPtr += arrayCount*elementSize;
+    }
+    *sizePtr -= arrayMaxCount*elementSize;
+
+    return true;
+}
+
 //--------------------------------------------------------------------------------------------------
 // Unpack functions
 //--------------------------------------------------------------------------------------------------
@@ -825,6 +863,11 @@ static inline bool le_pack_UnpackReference
  * Unpack a string from a buffer, incrementing the buffer pointer and decrementing the available
  * size.
  *
+ * Fails if the string doesn't fit in the output buffer with its null-terminator.  The bytes of the
+ * string are copied as they are, without checking that they are valid UTF-8: some services pass
+ * text in other encodings (e.g., the ISO-8859-1 text of SMS messages), so failing to unpack it
+ * would abort the client that receives it.  Use le_utf8_IsFormatCorrect() where UTF-8 is required.
+ *
  * @note Always decrements available size according to the max possible size used, not actual size
  * used.  Will assert if provided string is larger than maximum allowable string.
  */
@@ -871,6 +914,12 @@ static inline bool le_pack_UnpackString
         }
     }
 
+    // The string must fit in the output buffer with its null-terminator.
+    if (stringSize >= bufferSize)
+    {
+        return false;
+    }
+
     memcpy(stringPtr, *bufferPtr, stringSize);
     stringPtr[stringSize] = '\0';
 
@@ -955,4 +1004,191 @@ static inline bool le_pack_UnpackArrayHeader
         }                                                               \
     } while (0)
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack an array of plain data elements (integers, chars or doubles) from a buffer, incrementing
+ * the buffer pointer and decrementing the available size.
+ *
+ * This is the counterpart of le_pack_PackPodArray(), and can unpack any array packed by
+ * LE_PACK_PACKARRAY with the matching pack function.
+ *
+ * @note Always decrements available size according to the max possible size used, not actual size
+ * used.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_UnpackPodArray
+(
+    uint8_t **bufferPtr,
+    size_t *sizePtr,
+    void *arrayPtr,
+    size_t elementSize,
+    size_t *arrayCountPtr,
+    size_t arrayMaxCount
+)
+{
+    if (!le_pack_UnpackArrayHeader(bufferPtr, sizePtr, arrayPtr, elementSize,
+                                   arrayCountPtr, arrayMaxCount))
+    {
+        return false;
+    }
+
+    if (*arrayCountPtr > 0)
+    {
+        memcpy(arrayPtr, *bufferPtr, (*arrayCountPtr)*elementSize);
+        *bufferPtr += (*arrayCountPtr)*elementSize;
+    }
+    *sizePtr -= arrayMaxCount*elementSize;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Fixed-offset functions
+//
+// These store (Put) or load (Get) a single value at a given position in a buffer, using the same
+// encoding as the matching Pack and Unpack functions.  They don't check the buffer size: they are
+// meant for the fixed-size part of a message, where the space needed for all the values can be
+// checked at once and each value's offset is known in advance (as in code generated by ifgen).
+//--------------------------------------------------------------------------------------------------
+
+// Storing or loading a simple value is basically the same regardless of type.
+#define LE_PACK_PUT_GET_SIMPLE_VALUE(typeName, type)                                    \
+    static inline void le_pack_Put##typeName(uint8_t* bufferPtr, type value)            \
+    {                                                                                   \
+        memcpy(bufferPtr, &value, sizeof(value));                                       \
+    }                                                                                   \
+    static inline void le_pack_Get##typeName(const uint8_t* bufferPtr, type* valuePtr)  \
+    {                                                                                   \
+        memcpy(valuePtr, bufferPtr, sizeof(*valuePtr));                                 \
+    }
+
+LE_PACK_PUT_GET_SIMPLE_VALUE(Uint8, uint8_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Uint16, uint16_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Uint32, uint32_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Uint64, uint64_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Int8, int8_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Int16, int16_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Int32, int32_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Int64, int64_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Char, char)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Double, double)
+LE_PACK_PUT_GET_SIMPLE_VALUE(Result, le_result_t)
+LE_PACK_PUT_GET_SIMPLE_VALUE(OnOff, le_onoff_t)
+
+#undef LE_PACK_PUT_GET_SIMPLE_VALUE
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a bool at a given position in a buffer (as a uint8_t 0 or 1, like le_pack_PackBool()).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void le_pack_PutBool
+(
+    uint8_t* bufferPtr,
+    bool value
+)
+{
+    *bufferPtr = ((value)?1:0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a bool from a given position in a buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void le_pack_GetBool
+(
+    const uint8_t* bufferPtr,
+    bool* valuePtr
+)
+{
+    *valuePtr = !!(*bufferPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a size_t at a given position in a buffer (as a uint32_t, like le_pack_PackSize()).
+ *
+ * @note Asserts if the value is larger than 2^32-1.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void le_pack_PutSize
+(
+    uint8_t* bufferPtr,
+    size_t value
+)
+{
+    LE_ASSERT(value <= UINT32_MAX);
+    le_pack_PutUint32(bufferPtr, (uint32_t)value);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a size_t from a given position in a buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void le_pack_GetSize
+(
+    const uint8_t* bufferPtr,
+    size_t* valuePtr
+)
+{
+    uint32_t rawValue;
+
+    le_pack_GetUint32(bufferPtr, &rawValue);
+    *valuePtr = rawValue;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a reference at a given position in a buffer.
+ *
+ * @note Asserts if the reference is not a safe reference (or NULL), just as le_pack_PackReference()
+ * would fail.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void le_pack_PutReference
+(
+    uint8_t* bufferPtr,
+    const void* ref
+)
+{
+    size_t refAsInt = (size_t)ref;
+
+    LE_ASSERT((refAsInt <= UINT32_MAX) && ((refAsInt & 0x01) || !refAsInt));
+    le_pack_PutUint32(bufferPtr, (uint32_t)refAsInt);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a reference from a given position in a buffer.
+ *
+ * @return false if the value is not a valid safe reference (or NULL), in which case the reference
+ *         is left unchanged.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_GetReference
+(
+    const uint8_t* bufferPtr,
+    void* refPtr                ///< Pointer to the reference.  Declared as void * to allow implicit
+                                ///< conversion from pointer to reference types.
+)
+{
+    uint32_t refAsInt;
+
+    le_pack_GetUint32(bufferPtr, &refAsInt);
+
+    //  All references passed through an API must be safe references, so
+    // 0-bit will be set.
+    if ((refAsInt & 0x01) ||
+        (!refAsInt))
+    {
+        // Double cast to avoid warnings.
+        *(void **)refPtr = (void *)(size_t)refAsInt;
+        return true;
+    }
+
+    return false;
+}
+
 #endif /* LE_PACK_H_INCLUDE_GUARD */
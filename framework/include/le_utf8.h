@@ -114,6 +114,9 @@
  * encoding.  Not all valid UTF-8 characters are valid for a given character set;
  * le_utf8_IsFormatCorrect() does not check for this.
  *
+ * @c le_utf8_ValidateAndCopy() checks the format of a string that is not null-terminated (e.g.,
+ * received in a message) while copying it to a null-terminated string.
+ *
  *  @section utf8_parsing String Parsing
  *
  * To assist with converting integer values from UTF-8 strings to binary numerical values,
@@ -317,6 +320,35 @@ bool le_utf8_IsFormatCorrect
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that a buffer holds a correctly formatted UTF-8 string, without any null-character, and
+ * copies it to a destination buffer, adding a null-terminator.
+ *
+ * This is faster than calling le_utf8_IsFormatCorrect() then copying the string, as the source is
+ * only read once.
+ *
+ * If the source is not correctly formatted, or doesn't fit in the destination buffer, the
+ * destination is set to an empty string.
+ *
+ * If destStr and srcPtr overlap the behaviour of this function is undefined.
+ *
+ * @return
+ *      - LE_OK if the string was checked and copied.
+ *      - LE_FORMAT_ERROR if the source is not a correctly formatted UTF-8 string, or holds a
+ *        null-character.
+ *      - LE_OVERFLOW if the string and its null-terminator don't fit in the destination buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_utf8_ValidateAndCopy
+(
+    char* destStr,          ///< [OUT] Destination where the string is to be copied.
+    const char* srcPtr,     ///< [IN] Source string (not null-terminated).
+    size_t srcSize,         ///< [IN] Number of bytes in the source string.
+    size_t destSize         ///< [IN] Size of the destination buffer in bytes.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parse an integer value from a string.
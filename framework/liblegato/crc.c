@@ -5,12 +5,32 @@
  *
  * @note Only CRC32 is supported in this API
  *
+ * The CRC32 is computed 8 bytes at a time using "slicing-by-8" tables, or, when the CPU supports
+ * it (checked at start-up), with carry-less multiplication (x86 PCLMULQDQ) or with the ARMv8 CRC32
+ * instructions.  All implementations give the same result, so the incremental CRC of a buffer
+ * split in blocks doesn't depend on which one was used for each block.
+ *
  * Copyright (C) Sierra Wireless Inc.
  *
  */
 
 #include "legato.h"
 
+#include <endian.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CRC32_HAS_PCLMUL    1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#define CRC32_HAS_ARMV8     1
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32         (1 << 7)
+#endif
+#endif
+
 //--------------------------------------------------------------------------------------------------
 /**
  * CRC table
@@ -84,6 +104,276 @@ static const unsigned int Crc32Table[256] =
     0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D      /* 0xFC */
 };
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slicing-by-8 tables.  SliceTable[k][i] is the CRC of byte i followed by k zero bytes, so that 8
+ * bytes can be processed with 8 independent lookups.  Built from Crc32Table by InitCrc32().
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t SliceTable[8][256];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype of the CRC32 implementations.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef uint32_t (*Crc32Func_t)
+(
+    const uint8_t* bufPtr,  ///< [IN] Input buffer
+    size_t size,            ///< [IN] Number of bytes to read
+    uint32_t crc            ///< [IN] Starting CRC seed
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute a CRC32 one byte at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Crc32Bytewise
+(
+    const uint8_t* bufPtr,  ///< [IN] Input buffer
+    size_t size,            ///< [IN] Number of bytes to read
+    uint32_t crc            ///< [IN] Starting CRC seed
+)
+{
+    for (; size > 0 ; size--)
+    {
+        crc = (crc >> 8) ^ Crc32Table[(crc ^ *bufPtr++) & 0x000000FF];
+    }
+    return crc;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute a CRC32 eight bytes at a time, using the slicing-by-8 tables.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Crc32SliceBy8
+(
+    const uint8_t* bufPtr,  ///< [IN] Input buffer
+    size_t size,            ///< [IN] Number of bytes to read
+    uint32_t crc            ///< [IN] Starting CRC seed
+)
+{
+    for (; size >= 8; size -= 8, bufPtr += 8)
+    {
+        uint32_t low;
+        uint32_t high;
+
+        memcpy(&low, bufPtr, sizeof(low));
+        memcpy(&high, bufPtr + 4, sizeof(high));
+        low = le32toh(low) ^ crc;
+        high = le32toh(high);
+
+        crc = SliceTable[7][low & 0xFF] ^
+              SliceTable[6][(low >> 8) & 0xFF] ^
+              SliceTable[5][(low >> 16) & 0xFF] ^
+              SliceTable[4][low >> 24] ^
+              SliceTable[3][high & 0xFF] ^
+              SliceTable[2][(high >> 8) & 0xFF] ^
+              SliceTable[1][(high >> 16) & 0xFF] ^
+              SliceTable[0][high >> 24];
+    }
+
+    return Crc32Bytewise(bufPtr, size, crc);
+}
+
+#if CRC32_HAS_PCLMUL
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute a CRC32 by folding 64 bytes at a time with carry-less multiplications, then reducing
+ * the result with a Barrett reduction (see Intel's "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction").  The constants are those of the bit-reflected CRC32 polynomial.
+ *
+ * Buffers of less than 64 bytes, and the last (size % 16) bytes, are done by Crc32SliceBy8().
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t Crc32Pclmul
+(
+    const uint8_t* bufPtr,  ///< [IN] Input buffer
+    size_t size,            ///< [IN] Number of bytes to read
+    uint32_t crc            ///< [IN] Starting CRC seed
+)
+{
+    if (size < 64)
+    {
+        return Crc32SliceBy8(bufPtr, size, crc);
+    }
+
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    size_t tailSize = size & 15;
+    __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+    size -= tailSize;
+
+    x1 = _mm_loadu_si128((const __m128i*)(bufPtr + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(bufPtr + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(bufPtr + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(bufPtr + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    bufPtr += 64;
+    size -= 64;
+
+    // Fold four 128-bit lanes in parallel.
+    for (; size >= 64; size -= 64, bufPtr += 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                           _mm_loadu_si128((const __m128i*)(bufPtr + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                           _mm_loadu_si128((const __m128i*)(bufPtr + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                           _mm_loadu_si128((const __m128i*)(bufPtr + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                           _mm_loadu_si128((const __m128i*)(bufPtr + 0x30)));
+    }
+
+    // Fold the four lanes into one.
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Fold the remaining 16-byte blocks.
+    for (; size >= 16; size -= 16, bufPtr += 16)
+    {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)bufPtr)), x5);
+    }
+
+    // Reduce 128 bits to 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits.
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    crc = (uint32_t)_mm_extract_epi32(x1, 1);
+
+    return Crc32SliceBy8(bufPtr, tailSize, crc);
+}
+#endif
+
+#if CRC32_HAS_ARMV8
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute a CRC32 eight bytes at a time with the ARMv8 CRC32 instructions (which use the same
+ * bit-reflected polynomial, without inverting the CRC).
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((target("+crc")))
+static uint32_t Crc32Armv8
+(
+    const uint8_t* bufPtr,  ///< [IN] Input buffer
+    size_t size,            ///< [IN] Number of bytes to read
+    uint32_t crc            ///< [IN] Starting CRC seed
+)
+{
+    for (; (size > 0) && (((uintptr_t)bufPtr & 7) != 0); size--)
+    {
+        crc = __crc32b(crc, *bufPtr++);
+    }
+
+    for (; size >= 8; size -= 8, bufPtr += 8)
+    {
+        crc = __crc32d(crc, le64toh(*(const uint64_t*)bufPtr));
+    }
+
+    for (; size > 0; size--)
+    {
+        crc = __crc32b(crc, *bufPtr++);
+    }
+
+    return crc;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation used by le_crc_Crc32().  Crc32Bytewise() is used until InitCrc32() has run, in
+ * case a CRC is computed by another constructor.
+ */
+//--------------------------------------------------------------------------------------------------
+static Crc32Func_t Crc32Impl = Crc32Bytewise;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the slicing-by-8 tables and select the fastest implementation supported by the CPU.
+ *
+ * This is a constructor, rather than part of the framework's initialization, because this file is
+ * also built into host tools (e.g., mkPatch) that don't use the rest of the framework.
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((constructor)) static void InitCrc32
+(
+    void
+)
+{
+    int i;
+    int k;
+
+    for (i = 0; i < 256; i++)
+    {
+        SliceTable[0][i] = Crc32Table[i];
+    }
+    for (k = 1; k < 8; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            uint32_t prev = SliceTable[k - 1][i];
+
+            SliceTable[k][i] = (prev >> 8) ^ Crc32Table[prev & 0xFF];
+        }
+    }
+
+    Crc32Impl = Crc32SliceBy8;
+
+#if CRC32_HAS_PCLMUL
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1))
+    {
+        Crc32Impl = Crc32Pclmul;
+    }
+#elif CRC32_HAS_ARMV8
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32)
+    {
+        Crc32Impl = Crc32Armv8;
+    }
+#endif
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function is used to calculate a CRC-32
@@ -99,11 +389,5 @@ uint32_t le_crc_Crc32
     uint32_t crc        ///< [IN] Starting CRC seed
 )
 {
-    for (; size > 0 ; size--)
-    {
-        // byte loop
-        crc = (((crc >> 8) & 0x00FFFFFF) ^ Crc32Table[(crc ^ *addressPtr++) & 0x000000FF]);
-    }
-    return crc;
+    return Crc32Impl(addressPtr, size, crc);
 }
-
@@ -12,6 +12,22 @@
 #ifndef LEGATO_SRC_EVENTLOOP_H_INCLUDE_GUARD
 #define LEGATO_SRC_EVENTLOOP_H_INCLUDE_GUARD
 
+#include "metrics.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace keyword that turns on the event handler profiler.
+ *
+ * While this keyword is enabled in a process (e.g., "log trace eventProfile proc/framework"), the
+ * Event Loop, FD Monitor and Timer modules record an execution time histogram for every handler
+ * they call, in the process's metrics segment, named "handler.<kind>.<name>".  The time each
+ * report waits on an Event Queue is also recorded, per thread.  When it is disabled, the cost is
+ * one test of the keyword per handler call.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EVENT_PROFILE_KEYWORD "eventProfile"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -61,6 +77,10 @@ typedef struct
     uint64_t            liveEventCount;     ///< Number of events ready for dequeing.  Ensures
                                             ///< balance between queued events and monitored fds
                                             ///< in le_event_ServiceLoop().
+    metrics_CounterRef_t   queueDepthMetricRef; ///< Runtime metric: reports on the Event Queue.
+    metrics_HistogramRef_t handlerTimeMetricRef;///< Runtime metric: handler execution time.
+    metrics_HistogramRef_t queueTimeMetricRef;  ///< Runtime metric: time reports wait on the
+                                                ///  Event Queue (only while profiling).
 }
 event_PerThreadRec_t;
 
@@ -246,6 +246,14 @@
 #define LIMIT_MAX_EVENT_NAME_BYTES              LIMIT_MAX_EVENT_HANDLER_NAME_BYTES + 15
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a runtime metric (counter or histogram) name, including the null terminator.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define LIMIT_MAX_METRIC_NAME_BYTES             64
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Size of a MD5 string.
@@ -71,6 +71,23 @@ static const char* SubSysName[CGRP_NUM_SUBSYSTEMS] = {"cpu,cpuacct", "memory", "
 #define FREEZE_STATE_FILENAME       "freezer.state"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory usage and maximum memory usage file names.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MEM_USAGE_FILENAME          "memory.memsw.usage_in_bytes"
+#define MEM_MAX_USAGE_FILENAME      "memory.memsw.max_usage_in_bytes"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * CPU usage file name.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CPU_USAGE_FILENAME          "cpuacct.usage"
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum digits in a cgroup integer value.
@@ -1013,7 +1030,7 @@ ssize_t cgrp_GetMemUsed
 
     if (GetValue(CGRP_SUBSYS_MEM,
                  cgroupNamePtr,
-                 "memory.memsw.usage_in_bytes",
+                 MEM_USAGE_FILENAME,
                  buffer,
                  sizeof(buffer)) == LE_OK)
     {
@@ -1046,7 +1063,7 @@ ssize_t cgrp_GetMaxMemUsed
 
     if (GetValue(CGRP_SUBSYS_MEM,
                  cgroupNamePtr,
-                 "memory.memsw.max_usage_in_bytes",
+                 MEM_MAX_USAGE_FILENAME,
                  buffer,
                  sizeof(buffer)) == LE_OK)
     {
@@ -1062,3 +1079,86 @@ ssize_t cgrp_GetMaxMemUsed
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the file of a cgroup statistic, so that it can be read repeatedly with cgrp_ReadStat()
+ * without opening it each time.  The caller must close the file descriptor once done with it, and
+ * before the cgroup is deleted.
+ *
+ * @return
+ *      The file descriptor of the statistic's file if successful.
+ *      A negative value if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+int cgrp_OpenStat
+(
+    cgrp_Stat_t stat,               ///< [IN] Statistic.
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
+)
+{
+    switch (stat)
+    {
+        case CGRP_STAT_CPU_USAGE:
+            return OpenCgrpFile(CGRP_SUBSYS_CPU, cgroupNamePtr, CPU_USAGE_FILENAME,
+                                O_RDONLY | O_CLOEXEC);
+
+        case CGRP_STAT_MEM_USAGE:
+            return OpenCgrpFile(CGRP_SUBSYS_MEM, cgroupNamePtr, MEM_USAGE_FILENAME,
+                                O_RDONLY | O_CLOEXEC);
+
+        case CGRP_STAT_MEM_MAX_USAGE:
+            return OpenCgrpFile(CGRP_SUBSYS_MEM, cgroupNamePtr, MEM_MAX_USAGE_FILENAME,
+                                O_RDONLY | O_CLOEXEC);
+    }
+
+    LE_FATAL("Unknown cgroup statistic %d.", stat);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the current value of a cgroup statistic from a file opened with cgrp_OpenStat().
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_ReadStat
+(
+    int fd,                         ///< [IN] File descriptor returned by cgrp_OpenStat().
+    uint64_t* valuePtr              ///< [OUT] Value.
+)
+{
+    char buffer[32];
+    ssize_t numBytesRead;
+
+    // Reading from the start of the file makes the kernel generate the current value.
+    do
+    {
+        numBytesRead = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    }
+    while ((numBytesRead == -1) && (errno == EINTR));
+
+    if (numBytesRead <= 0)
+    {
+        LE_ERROR("Could not read cgroup statistic.  %m.");
+        return LE_FAULT;
+    }
+
+    buffer[numBytesRead] = '\0';
+
+    char* endPtr;
+    errno = 0;
+    unsigned long long value = strtoull(buffer, &endPtr, 10);
+
+    if ((errno != 0) || (endPtr == buffer) || ((*endPtr != '\n') && (*endPtr != '\0')))
+    {
+        LE_ERROR("Invalid cgroup statistic '%s'.", buffer);
+        return LE_FAULT;
+    }
+
+    *valuePtr = value;
+
+    return LE_OK;
+}
@@ -132,6 +132,20 @@ typedef enum
 cgrp_FreezeState_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cgroup statistics that can be sampled (see cgrp_OpenStat()).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CGRP_STAT_CPU_USAGE,            ///< CPU time used (ns).
+    CGRP_STAT_MEM_USAGE,            ///< Memory used (bytes).
+    CGRP_STAT_MEM_MAX_USAGE         ///< Maximum memory used so far (bytes).
+}
+cgrp_Stat_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initializes cgroups for the system.  Sets up a hierarchy for each supported subsystem.
@@ -435,4 +449,38 @@ ssize_t cgrp_GetMaxMemUsed
     const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the file of a cgroup statistic, so that it can be read repeatedly with cgrp_ReadStat()
+ * without opening it each time.  The caller must close the file descriptor once done with it, and
+ * before the cgroup is deleted.
+ *
+ * @return
+ *      The file descriptor of the statistic's file if successful.
+ *      A negative value if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+int cgrp_OpenStat
+(
+    cgrp_Stat_t stat,               ///< [IN] Statistic.
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the current value of a cgroup statistic from a file opened with cgrp_OpenStat().
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_ReadStat
+(
+    int fd,                         ///< [IN] File descriptor returned by cgrp_OpenStat().
+    uint64_t* valuePtr              ///< [OUT] Value.
+);
+
 #endif // LEGATO_SRC_CGROUPS_INCLUDE_GUARD
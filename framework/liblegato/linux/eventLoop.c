@@ -102,6 +102,7 @@
 
 #include <pthread.h>
 #include <sys/eventfd.h>
+#include <dlfcn.h>
 
 // ==============================================
 //  PRIVATE DATA
@@ -129,6 +130,10 @@
 /// @todo Make this configurable.
 #define DEFAULT_EVENT_POOL_SIZE 5
 
+/// Maximum number of different queued functions that the event profiler keeps apart.  Any others
+/// are lumped together.
+#define MAX_PROFILED_FUNCTIONS 64
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -209,6 +214,8 @@ typedef struct
 
     le_event_LayeredHandlerFunc_t   firstLayerFunc;     ///< First-layer handler function.
     void*                           secondLayerFunc;    ///< Second-layer handler function.
+
+    metrics_HistogramRef_t  profileRef; ///< Execution time histogram (NULL until first profiled).
 }
 Handler_t;
 
@@ -260,6 +267,7 @@ typedef struct
 {
     le_sls_Link_t           link;       ///< Used to link onto an Event Queue.
     EventReportType_t       type;       ///< Indicates what type of event report this is.
+    uint64_t                queuedTime; ///< When it was queued (us), or 0 if not profiling.
 }
 Report_t;
 
@@ -335,6 +343,30 @@ static le_ref_MapRef_t HandlerRefMap;
 static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Execution time histogram of a queued function, kept by the event profiler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_event_DeferredFunc_t function;   ///< Address of the queued function.
+    metrics_HistogramRef_t  histRef;    ///< Its histogram, or NULL if it isn't to be profiled.
+}
+FunctionProfile_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued functions that the event profiler has seen so far.  Only used while profiling.
+ *
+ * @warning This can be accessed by multiple threads.  Use the Mutex to protect it from races.
+ */
+//--------------------------------------------------------------------------------------------------
+static FunctionProfile_t FunctionProfiles[MAX_PROFILED_FUNCTIONS];
+static size_t NumFunctionProfiles;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Guards against thread cancellation and locks the mutex.
@@ -392,6 +424,17 @@ static le_log_TraceRef_t TraceRef;
 #define TRACE(...) LE_TRACE(TraceRef, ##__VA_ARGS__)
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace reference used to turn the event profiler on and off.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_log_TraceRef_t ProfileTraceRef;
+
+/// Macro used to check whether the event profiler is on.
+#define IS_PROFILING_ENABLED() LE_IS_TRACE_ENABLED(ProfileTraceRef)
+
+
 // ==============================================
 //  PRIVATE FUNCTIONS
 // ==============================================
@@ -484,6 +527,21 @@ static void DeleteHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the time at which a report is being queued, if the event profiler is on.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void StampReport
+(
+    Report_t* reportPtr     ///< [in] Report about to be queued.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    reportPtr->queuedTime = IS_PROFILING_ENABLED() ? metrics_GetTimeUs() : 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Write to a thread's Event File Descriptor.  This increments it by one.
@@ -501,6 +559,9 @@ static void WriteEventFd
 
     ssize_t writeSize;
 
+    // This is called exactly once per queued report, so it's also where the queue depth is counted.
+    metrics_Inc(perThreadRecPtr->queueDepthMetricRef);
+
     for (;;)
     {
         writeSize = write(perThreadRecPtr->eventQueueFd, &writeBuff, sizeof(writeBuff));
@@ -562,6 +623,165 @@ static uint64_t ReadEventFd
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record how long a report waited on the Event Queue, if it was queued while profiling.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordQueueTime
+(
+    event_PerThreadRec_t* perThreadRecPtr,  ///< [in] Ptr to the calling thread's per-thread record.
+    Report_t* reportPtr,                    ///< [in] Report that has just been popped.
+    uint64_t startTime                      ///< [in] When its handler was started (us).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((reportPtr->queuedTime != 0) && (startTime >= reportPtr->queuedTime))
+    {
+        metrics_Record(perThreadRecPtr->queueTimeMetricRef, startTime - reportPtr->queuedTime);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the histogram that the event profiler records a queued function's execution time in.
+ *
+ * The histogram is named after the function's symbol if it can be found, or else after its
+ * offset in the library or executable that contains it (resolve that with addr2line).
+ *
+ * @return The histogram, or NULL if the function isn't to be profiled.
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_HistogramRef_t GetFunctionProfile
+(
+    le_event_DeferredFunc_t func    ///< [in] The queued function.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    metrics_HistogramRef_t histRef = NULL;
+    size_t i;
+
+    int oldState = Lock();
+
+    for (i = 0; i < NumFunctionProfiles; i++)
+    {
+        if (FunctionProfiles[i].function == func)
+        {
+            histRef = FunctionProfiles[i].histRef;
+            break;
+        }
+    }
+
+    if (i == NumFunctionProfiles)
+    {
+        Dl_info info;
+
+        if (fdMon_IsDispatcher(func))
+        {
+            // The FD Monitor module profiles each of its handlers itself.
+            histRef = NULL;
+        }
+        else if (i == MAX_PROFILED_FUNCTIONS)
+        {
+            histRef = metrics_GetHistogram("handler.func.others");
+        }
+        else if (dladdr((void*)func, &info) == 0)
+        {
+            histRef = metrics_GetHistogram("handler.func.%p", (void*)func);
+        }
+        else if (info.dli_sname != NULL)
+        {
+            histRef = metrics_GetHistogram("handler.func.%s", info.dli_sname);
+        }
+        else
+        {
+            histRef = metrics_GetHistogram("handler.func.%s+%#tx",
+                                           le_path_GetBasenamePtr(info.dli_fname, "/"),
+                                           (char*)(void*)func - (char*)info.dli_fbase);
+        }
+
+        if (i < MAX_PROFILED_FUNCTIONS)
+        {
+            FunctionProfiles[i].function = func;
+            FunctionProfiles[i].histRef = histRef;
+            NumFunctionProfiles++;
+        }
+    }
+
+    Unlock(oldState);
+
+    return histRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a queued function call in the event profiler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProfileQueuedFunction
+(
+    event_PerThreadRec_t* perThreadRecPtr,  ///< [in] Ptr to the calling thread's per-thread record.
+    QueuedFunctionReport_t* reportPtr,      ///< [in] Report of the function that was called.
+    uint64_t startTime,                     ///< [in] When the function was called (us).
+    uint64_t runTime                        ///< [in] How long it ran (us).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RecordQueueTime(perThreadRecPtr, &reportPtr->baseClass, startTime);
+
+    metrics_HistogramRef_t histRef = GetFunctionProfile(reportPtr->function);
+
+    if (histRef != NULL)
+    {
+        metrics_Record(histRef, runTime);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a publish-subscribe handler call in the event profiler.
+ *
+ * If the handler deleted itself, only the time its report waited on the queue is recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProfilePubSubHandler
+(
+    event_PerThreadRec_t* perThreadRecPtr,  ///< [in] Ptr to the calling thread's per-thread record.
+    PubSubEventReport_t* reportPtr,         ///< [in] Report that was delivered to the handler.
+    uint64_t startTime,                     ///< [in] When the handler was called (us).
+    uint64_t runTime                        ///< [in] How long it ran (us).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RecordQueueTime(perThreadRecPtr, &reportPtr->baseClass, startTime);
+
+    metrics_HistogramRef_t histRef = NULL;
+
+    int oldState = Lock();
+
+    Handler_t* handlerPtr = le_ref_Lookup(HandlerRefMap, reportPtr->handlerRef);
+    if (handlerPtr != NULL)
+    {
+        if (handlerPtr->profileRef == NULL)
+        {
+            handlerPtr->profileRef = metrics_GetHistogram("handler.event.%s", handlerPtr->name);
+        }
+
+        histRef = handlerPtr->profileRef;
+    }
+
+    Unlock(oldState);
+
+    if (histRef != NULL)
+    {
+        metrics_Record(histRef, runTime);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process one event report from the calling thread's Event Queue.
@@ -589,6 +809,8 @@ static void ProcessOneEventReport
         return;
     }
 
+    metrics_Dec(perThreadRecPtr->queueDepthMetricRef);
+
     // Convert the link pointer into a pointer to the Report base class.
     reportObjPtr = CONTAINER_OF(linkPtr, Report_t, link);
 
@@ -600,8 +822,16 @@ static void ProcessOneEventReport
         queuedFuncReportPtr = CONTAINER_OF(reportObjPtr, QueuedFunctionReport_t, baseClass);
 
         // Call the function.
+        uint64_t startTime = metrics_GetTimeUs();
         queuedFuncReportPtr->function(queuedFuncReportPtr->param1Ptr,
                                       queuedFuncReportPtr->param2Ptr);
+        uint64_t runTime = metrics_GetTimeUs() - startTime;
+        metrics_Record(perThreadRecPtr->handlerTimeMetricRef, runTime);
+
+        if (IS_PROFILING_ENABLED())
+        {
+            ProfileQueuedFunction(perThreadRecPtr, queuedFuncReportPtr, startTime, runTime);
+        }
 
     }
     // If it's a publish-subscribe event report,
@@ -652,7 +882,15 @@ static void ProcessOneEventReport
             Unlock(oldState);  // Unlock the mutex before calling the handler function.
                                // Don't access the Handler object anymore after this.
 
+            uint64_t startTime = metrics_GetTimeUs();
             firstLayerFunc(reportPtr, secondLayerFunc);
+            uint64_t runTime = metrics_GetTimeUs() - startTime;
+            metrics_Record(perThreadRecPtr->handlerTimeMetricRef, runTime);
+
+            if (IS_PROFILING_ENABLED())
+            {
+                ProfilePubSubHandler(perThreadRecPtr, pubSubReportPtr, startTime, runTime);
+            }
         }
     }
 
@@ -736,6 +974,7 @@ static void QueueFunction
     // Initialize it.
     reportPtr->baseClass.link = LE_SLS_LINK_INIT;
     reportPtr->baseClass.type = LE_EVENT_REPORT_QUEUED_FUNC;
+    StampReport(&reportPtr->baseClass);
     reportPtr->function = func;
     reportPtr->param1Ptr = param1Ptr;
     reportPtr->param2Ptr = param2Ptr;
@@ -808,6 +1047,9 @@ void event_Init
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("eventLoop");
 
+    // Get a reference to the trace keyword that turns the event profiler on and off.
+    ProfileTraceRef = le_log_GetTraceRef(EVENT_PROFILE_KEYWORD);
+
     // Initialize the FD Monitor module.
     fdMon_Init();
 }
@@ -869,6 +1111,13 @@ void event_InitThread
     // Set the context pointer to NULL for safety's sake.
     recPtr->contextPtr = NULL;
 
+    // Register this thread's runtime metrics.  Threads with the same name share them.
+    const char* threadNamePtr = le_thread_GetMyName();
+    recPtr->queueDepthMetricRef = metrics_GetCounter(METRICS_GAUGE,
+                                                     "event.%s.queueDepth", threadNamePtr);
+    recPtr->handlerTimeMetricRef = metrics_GetHistogram("event.%s.handlerTime", threadNamePtr);
+    recPtr->queueTimeMetricRef = metrics_GetHistogram("event.%s.queueTime", threadNamePtr);
+
     // Initialize the FD Monitor module's thread-specific stuff.
     fdMon_InitThread(recPtr);
 
@@ -1113,6 +1362,7 @@ le_event_HandlerRef_t le_event_AddLayeredHandler
     handlerPtr->contextPtr = NULL;
     handlerPtr->firstLayerFunc = firstLayerFunc;
     handlerPtr->secondLayerFunc = secondLayerFunc;
+    handlerPtr->profileRef = NULL;
     if (le_utf8_Copy(handlerPtr->name, name, sizeof(handlerPtr->name), NULL) == LE_OVERFLOW)
     {
         LE_WARN("Event handler name '%s' truncated to '%s'.", name, handlerPtr->name);
@@ -1218,6 +1468,7 @@ void le_event_Report
         PubSubEventReport_t* reportObjPtr = le_mem_ForceAlloc(eventPtr->reportPoolRef);
         reportObjPtr->baseClass.link = LE_SLS_LINK_INIT;
         reportObjPtr->baseClass.type = LE_EVENT_REPORT_PLAIN;
+        StampReport(&reportObjPtr->baseClass);
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         memset(reportObjPtr->payload, 0, eventPtr->payloadSize);
         memcpy(reportObjPtr->payload, payloadPtr, payloadSize);
@@ -1279,6 +1530,7 @@ void le_event_ReportWithRefCounting
         PubSubEventReport_t* reportObjPtr = le_mem_ForceAlloc(eventPtr->reportPoolRef);
         reportObjPtr->baseClass.link = LE_SLS_LINK_INIT;
         reportObjPtr->baseClass.type = LE_EVENT_REPORT_COUNTED_REF;
+        StampReport(&reportObjPtr->baseClass);
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         reportObjPtr->payload[0] = objectPtr;
         le_mem_AddRef(objectPtr);
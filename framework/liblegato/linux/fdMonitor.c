@@ -92,6 +92,8 @@ typedef struct FdMonitor
     void*                       contextPtr;     ///< The context pointer for this handler.
 
     char        name[MAX_FD_MONITOR_NAME_BYTES];            ///< UTF-8 name of this object.
+
+    metrics_HistogramRef_t  profileRef; ///< Execution time histogram (NULL until first profiled).
 }
 FdMonitor_t;
 
@@ -145,6 +147,17 @@ static le_log_TraceRef_t TraceRef;
 #define IS_TRACE_ENABLED() LE_IS_TRACE_ENABLED(TraceRef)
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace reference used to turn the event profiler on and off.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_log_TraceRef_t ProfileTraceRef;
+
+/// Macro used to check whether the event profiler is on.
+#define IS_PROFILING_ENABLED() LE_IS_TRACE_ENABLED(ProfileTraceRef)
+
+
 // ==============================================
 //  PRIVATE FUNCTIONS
 // ==============================================
@@ -380,6 +393,30 @@ static void DeleteFdMonitor
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call an FD Monitor's handler function and record its execution time in the event profiler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallHandlerProfiled
+(
+    FdMonitor_t* fdMonitorPtr,  ///< [in] The FD Monitor.
+    short pollEvents            ///< [in] poll() events to report to the handler.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Only the monitoring thread gets here, so the profile can be created without locking.
+    if (fdMonitorPtr->profileRef == NULL)
+    {
+        fdMonitorPtr->profileRef = metrics_GetHistogram("handler.fd.%s", fdMonitorPtr->name);
+    }
+
+    uint64_t startTime = metrics_GetTimeUs();
+    fdMonitorPtr->handlerFunc(fdMonitorPtr->fd, pollEvents);
+    metrics_Record(fdMonitorPtr->profileRef, metrics_GetTimeUs() - startTime);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Dispatch an FD Event to the appropriate registered handler function.
@@ -449,7 +486,14 @@ static void DispatchToHandler
     event_SetCurrentContextPtr(fdMonitorPtr->contextPtr);
 
     // Call the handler function.
-    fdMonitorPtr->handlerFunc(fdMonitorPtr->fd, pollEvents);
+    if (IS_PROFILING_ENABLED())
+    {
+        CallHandlerProfiled(fdMonitorPtr, pollEvents);
+    }
+    else
+    {
+        fdMonitorPtr->handlerFunc(fdMonitorPtr->fd, pollEvents);
+    }
 
     // Clear the thread-specific pointer to the FD Monitor.
     LE_ASSERT(pthread_setspecific(FDMonitorPtrKey, NULL) == 0);
@@ -543,6 +587,9 @@ void fdMon_Init
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("fdMonitor");
 
+    // Get a reference to the trace keyword that turns the event profiler on and off.
+    ProfileTraceRef = le_log_GetTraceRef(EVENT_PROFILE_KEYWORD);
+
     // Create the thread-specific data key for the FD Monitor Ptr of the current running handler.
     LE_ASSERT(pthread_key_create(&FDMonitorPtrKey, NULL) == 0);
 }
@@ -585,6 +632,26 @@ void fdMon_Report
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a queued function is the one that dispatches FD events to FD Monitor handlers.
+ *
+ * The event profiler uses this to leave the profiling of those calls to this module, which knows
+ * which FD Monitor each one is for.
+ *
+ * @return true if it is the FD event dispatcher.
+ */
+//--------------------------------------------------------------------------------------------------
+bool fdMon_IsDispatcher
+(
+    le_event_DeferredFunc_t func    ///< [in] The queued function.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (func == DispatchToHandler);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete all FD Monitor objects for the calling thread.
@@ -665,6 +732,7 @@ le_fdMonitor_Ref_t le_fdMonitor_Create
     fdMonitorPtr->threadRecPtr = perThreadRecPtr;
     fdMonitorPtr->handlerFunc = handlerFunc;
     fdMonitorPtr->contextPtr = NULL;
+    fdMonitorPtr->profileRef = NULL;
 
     // Copy the name into it.
     if (le_utf8_Copy(fdMonitorPtr->name, name, sizeof(fdMonitorPtr->name), NULL) == LE_OVERFLOW)
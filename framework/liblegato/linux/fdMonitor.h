@@ -68,6 +68,22 @@ void fdMon_Report
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a queued function is the one that dispatches FD events to FD Monitor handlers.
+ *
+ * The event profiler uses this to leave the profiling of those calls to this module, which knows
+ * which FD Monitor each one is for.
+ *
+ * @return true if it is the FD event dispatcher.
+ */
+//--------------------------------------------------------------------------------------------------
+bool fdMon_IsDispatcher
+(
+    le_event_DeferredFunc_t func    ///< [in] The queued function.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete all FD Monitor objects for the calling thread.
@@ -7,6 +7,7 @@
 
 #include "legato.h"
 
+#include "metrics.h"
 #include "mem.h"
 #include "hashmap.h"
 #include "safeRef.h"
@@ -50,6 +51,7 @@ __attribute__((constructor)) void _legato_InitFramework
     // hasn't been called yet.  Keep it that way.  Also, be careful when using logging inside
     // the memory pool module, because there is the risk of creating infinite recursion.
 
+    metrics_Init();    // Must come before anything that registers metrics.
     mem_Init();
     log_Init();        // Uses memory pools.
     sig_Init();        // Uses memory pools.
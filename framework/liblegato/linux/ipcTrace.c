@@ -0,0 +1,344 @@
+//--------------------------------------------------------------------------------------------------
+/** @file ipcTrace.c
+ *
+ * Implementation of the per-process IPC message trace ring.
+ *
+ * The ring is created the first time a record is written, so processes that never have tracing
+ * enabled don't pay for it.  Writers claim a slot with a single atomic increment of the ring's
+ * head, so records can be written from any thread without a lock.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "ipcTrace.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The calling process's trace ring, or NULL if it hasn't been created yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static ipcTrace_Ring_t* RingPtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if creating the ring failed (so it isn't attempted for every message).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RingFailed;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex used to serialize creation of the ring.  Writing records doesn't need it.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define LOCK    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+#define UNLOCK  LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the ring file when the process exits normally.
+ *
+ * Forked children inherit this handler, so it only acts in the process that created the file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveRingFile
+(
+    void
+)
+{
+    if ((RingPtr != NULL) && (RingPtr->pid == getpid()))
+    {
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        snprintf(path, sizeof(path), IPCTRACE_RING_PATH_FMT, getpid());
+        unlink(path);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the calling process's ring file and map it.
+ *
+ * @return Pointer to the mapped ring, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static ipcTrace_Ring_t* CreateRing
+(
+    void
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    snprintf(path, sizeof(path), IPCTRACE_RING_PATH_FMT, getpid());
+
+    // A file with this name may have been left behind by an earlier process that had the same
+    // PID.  Never follow a symlink that someone else may have planted in /tmp.
+    unlink(path);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_WARN("Can't create IPC trace ring '%s' (%m).", path);
+        return NULL;
+    }
+
+    ipcTrace_Ring_t* ringPtr = NULL;
+
+    if (ftruncate(fd, sizeof(ipcTrace_Ring_t)) != 0)
+    {
+        LE_WARN("Can't size IPC trace ring '%s' (%m).", path);
+    }
+    else
+    {
+        ringPtr = mmap(NULL, sizeof(ipcTrace_Ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ringPtr == MAP_FAILED)
+        {
+            LE_WARN("Can't map IPC trace ring '%s' (%m).", path);
+            ringPtr = NULL;
+        }
+    }
+
+    fd_Close(fd);
+
+    if (ringPtr == NULL)
+    {
+        unlink(path);
+        return NULL;
+    }
+
+    // The mapping is zero-filled, so only the header needs to be filled in.
+    ringPtr->pid = getpid();
+    ringPtr->numRecords = IPCTRACE_NUM_RECORDS;
+    le_utf8_Copy(ringPtr->procName, program_invocation_short_name, sizeof(ringPtr->procName),
+                 NULL);
+    ringPtr->version = IPCTRACE_VERSION;
+
+    // Publish the ring last, so readers never see a half-initialized header.
+    __atomic_store_n(&ringPtr->magic, IPCTRACE_MAGIC, __ATOMIC_RELEASE);
+
+    LE_INFO("IPC trace ring created at '%s'.", path);
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the calling process's ring, creating it if necessary.
+ *
+ * A forked child that inherited its parent's ring gets a ring of its own.
+ *
+ * @return Pointer to the ring, or NULL if it can't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+static ipcTrace_Ring_t* GetRing
+(
+    void
+)
+{
+    ipcTrace_Ring_t* ringPtr = __atomic_load_n(&RingPtr, __ATOMIC_ACQUIRE);
+
+    if ((ringPtr != NULL) && (ringPtr->pid == getpid()))
+    {
+        return ringPtr;
+    }
+
+    LOCK
+
+    if ((RingPtr == NULL) || (RingPtr->pid != getpid()))
+    {
+        if (RingPtr != NULL)
+        {
+            // Inherited across a fork().  Leave the parent's ring alone.
+            munmap(RingPtr, sizeof(ipcTrace_Ring_t));
+            __atomic_store_n(&RingPtr, NULL, __ATOMIC_RELEASE);
+            RingFailed = false;
+        }
+
+        if (!RingFailed)
+        {
+            ringPtr = CreateRing();
+
+            if (ringPtr == NULL)
+            {
+                RingFailed = true;
+            }
+            else
+            {
+                static bool atexitRegistered = false;
+
+                if (!atexitRegistered)
+                {
+                    atexit(RemoveRingFile);
+                    atexitRegistered = true;
+                }
+
+                __atomic_store_n(&RingPtr, ringPtr, __ATOMIC_RELEASE);
+            }
+        }
+    }
+
+    ringPtr = RingPtr;
+
+    UNLOCK
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a traced message's record into the calling process's trace ring and stop tracing it.
+ */
+//--------------------------------------------------------------------------------------------------
+void ipcTrace_Write
+(
+    ipcTrace_MsgState_t* statePtr,  ///< [IN] Message's tracing state.
+    ipcTrace_Role_t role,           ///< [IN] Side of the session.
+    const char* interfaceName,      ///< [IN] Name of the interface.
+    size_t size,                    ///< [IN] Message size (bytes).
+    pid_t peerPid                   ///< [IN] Client's process ID (server side), or 0.
+)
+{
+    statePtr->isActive = false;
+
+    ipcTrace_Ring_t* ringPtr = GetRing();
+
+    if (ringPtr == NULL)
+    {
+        return;
+    }
+
+    uint64_t seq = __atomic_fetch_add(&ringPtr->head, 1, __ATOMIC_RELAXED);
+    ipcTrace_Record_t* recPtr = &ringPtr->records[seq % IPCTRACE_NUM_RECORDS];
+
+    __atomic_store_n(&recPtr->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    recPtr->role = role;
+    recPtr->size = size;
+    recPtr->msgId = statePtr->msgId;
+    recPtr->peerPid = peerPid;
+    recPtr->txnId = (uint64_t)(uintptr_t)statePtr->txnId;
+    memcpy(recPtr->stamps, statePtr->stamps, sizeof(recPtr->stamps));
+    le_utf8_Copy(recPtr->interfaceName, interfaceName, sizeof(recPtr->interfaceName), NULL);
+
+    __atomic_store_n(&recPtr->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map another process's trace ring read-only (for use by diagnostic tools).
+ *
+ * @return Pointer to the ring, or NULL if the process has no (valid) ring.  Release it with
+ *         ipcTrace_UnmapRing().
+ */
+//--------------------------------------------------------------------------------------------------
+const ipcTrace_Ring_t* ipcTrace_MapProcessRing
+(
+    pid_t pid                       ///< [IN] ID of the process to look at.
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    int len;
+
+    // Go through the process's own root directory, so sandboxed processes are found too.
+    len = snprintf(path, sizeof(path), "/proc/%d/root", pid);
+    snprintf(path + len, sizeof(path) - len, IPCTRACE_RING_PATH_FMT, pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    ipcTrace_Ring_t* ringPtr = NULL;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size == sizeof(ipcTrace_Ring_t)))
+    {
+        ringPtr = mmap(NULL, sizeof(ipcTrace_Ring_t), PROT_READ, MAP_SHARED, fd, 0);
+        if (ringPtr == MAP_FAILED)
+        {
+            ringPtr = NULL;
+        }
+    }
+
+    fd_Close(fd);
+
+    if ((ringPtr != NULL) &&
+        ((__atomic_load_n(&ringPtr->magic, __ATOMIC_ACQUIRE) != IPCTRACE_MAGIC) ||
+         (ringPtr->version != IPCTRACE_VERSION) ||
+         (ringPtr->pid != pid)))
+    {
+        munmap(ringPtr, sizeof(ipcTrace_Ring_t));
+        ringPtr = NULL;
+    }
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a ring mapped using ipcTrace_MapProcessRing().
+ */
+//--------------------------------------------------------------------------------------------------
+void ipcTrace_UnmapRing
+(
+    const ipcTrace_Ring_t* ringPtr  ///< [IN] Ring to unmap.
+)
+{
+    munmap((void*)ringPtr, sizeof(ipcTrace_Ring_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a record out of a mapped ring.
+ *
+ * @return true if the slot holds a complete record, false if it is empty or being overwritten.
+ */
+//--------------------------------------------------------------------------------------------------
+bool ipcTrace_ReadRecord
+(
+    const ipcTrace_Ring_t* ringPtr, ///< [IN] Ring.
+    size_t index,                   ///< [IN] Slot index (0 to IPCTRACE_NUM_RECORDS - 1).
+    ipcTrace_Record_t* recordPtr    ///< [OUT] Copy of the record.
+)
+{
+    const ipcTrace_Record_t* recPtr = &ringPtr->records[index % IPCTRACE_NUM_RECORDS];
+
+    uint64_t seq = __atomic_load_n(&recPtr->seq, __ATOMIC_ACQUIRE);
+
+    if (seq == 0)
+    {
+        return false;
+    }
+
+    memcpy(recordPtr, recPtr, sizeof(*recordPtr));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(&recPtr->seq, __ATOMIC_RELAXED) != seq)
+    {
+        return false;
+    }
+
+    recordPtr->seq = seq;
+    recordPtr->interfaceName[sizeof(recordPtr->interfaceName) - 1] = '\0';
+
+    return true;
+}
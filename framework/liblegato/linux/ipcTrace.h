@@ -0,0 +1,281 @@
+//--------------------------------------------------------------------------------------------------
+/** @file ipcTrace.h
+ *
+ * Legato IPC message tracing inter-module include file.
+ *
+ * While the IPCTRACE_KEYWORD trace keyword is enabled for a process's framework component, every
+ * IPC message it sends or receives is time-stamped as it moves through the messaging layers
+ * (queued for sending, written to the socket, read from the socket, handler started, handler
+ * finished).  When a message's part of a transaction is over, its time stamps are written as one
+ * ipcTrace_Record_t into a per-process ring buffer.
+ *
+ * The ring buffer is a file at IPCTRACE_RING_PATH_FMT inside the process's own /tmp, created the
+ * first time a message is traced.  The ipcTrace tool maps the rings of all processes read-only
+ * and merges client and server records of the same transaction (matched by client process ID and
+ * transaction ID) into per-API latency breakdowns.
+ *
+ * Time stamps are taken from CLOCK_MONOTONIC, so they can be compared between processes.
+ *
+ * This file exposes interfaces that are for use by other modules inside the framework
+ * implementation, but must not be used outside of the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SRC_IPC_TRACE_INCLUDE_GUARD
+#define LEGATO_SRC_IPC_TRACE_INCLUDE_GUARD
+
+#include "limit.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace keyword that turns IPC message tracing on for a process (e.g., with
+ * "log trace ipcTrace <process>/framework").
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPCTRACE_KEYWORD                "ipcTrace"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path (printf format taking the process ID) of a process's trace ring, as seen from inside that
+ * process.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPCTRACE_RING_PATH_FMT          "/tmp/legato-ipctrace.%d"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number and layout version stored at the start of every trace ring.
+ *
+ * @note The version must be incremented whenever the layout of ipcTrace_Ring_t changes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPCTRACE_MAGIC                  0x4c495043
+#define IPCTRACE_VERSION                1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of records in a trace ring.  When the ring is full, the oldest records are overwritten.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPCTRACE_NUM_RECORDS            1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of the interface name kept in a trace record (including the null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPCTRACE_INTERFACE_NAME_BYTES   48
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Points in the life of a message that are time-stamped.
+ *
+ * For a client, the message is the request: it is queued and sent by the client, and the
+ * "receive" and "handler" stamps are those of the response and of the completion callback.
+ * For a server, the message is the request: it is received and handled by the server, and the
+ * "enqueue" and "send" stamps are those of the response.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    IPCTRACE_ENQUEUE,               ///< Put on the session's Transmit Queue.
+    IPCTRACE_SEND,                  ///< Written to the socket.
+    IPCTRACE_RECEIVE,               ///< Read from the socket.
+    IPCTRACE_HANDLER_START,         ///< Handler (receive handler or completion callback) called.
+    IPCTRACE_HANDLER_END,           ///< Handler returned.
+    IPCTRACE_NUM_STAMPS
+}
+ipcTrace_Stamp_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Side of the session that wrote a record.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    IPCTRACE_ROLE_CLIENT,
+    IPCTRACE_ROLE_SERVER
+}
+ipcTrace_Role_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-message tracing state, kept in the Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool        isActive;                       ///< true if this message is being traced.
+    uint32_t    msgId;                          ///< Message ID (first word of the payload).
+    void*       txnId;                          ///< Transaction ID (0 = no response expected).
+    size_t      size;                           ///< Payload bytes sent or received.
+    uint64_t    stamps[IPCTRACE_NUM_STAMPS];    ///< Time stamps (ns), 0 = not reached.
+}
+ipcTrace_MsgState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace record.
+ *
+ * The seq field is cleared before a record is overwritten and set (with release semantics) after
+ * it has been filled in, so a reader that sees the same non-zero seq before and after copying a
+ * record knows the copy is consistent.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    seq;                            ///< Record number + 1 (0 = being written).
+    uint32_t    role;                           ///< ipcTrace_Role_t.
+    uint32_t    size;                           ///< Message size (bytes).
+    uint32_t    msgId;                          ///< Message ID (first word of the payload).
+    int32_t     peerPid;                        ///< Client's process ID (server records only).
+    uint64_t    txnId;                          ///< Transaction ID (0 = no response expected).
+    uint64_t    stamps[IPCTRACE_NUM_STAMPS];    ///< Time stamps (ns, CLOCK_MONOTONIC).
+    char        interfaceName[IPCTRACE_INTERFACE_NAME_BYTES];   ///< Name of the interface.
+}
+ipcTrace_Record_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of a process's trace ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t            magic;                  ///< IPCTRACE_MAGIC.
+    uint32_t            version;                ///< IPCTRACE_VERSION.
+    int32_t             pid;                    ///< ID of the process that owns the ring.
+    uint32_t            numRecords;             ///< IPCTRACE_NUM_RECORDS.
+    uint64_t            head;                   ///< Number of records ever written.
+    char                procName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Name of the process.
+    ipcTrace_Record_t   records[IPCTRACE_NUM_RECORDS];
+}
+ipcTrace_Ring_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in nanoseconds from CLOCK_MONOTONIC.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t ipcTrace_GetTimeNs
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start tracing a message, taking its first time stamp.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void ipcTrace_Begin
+(
+    ipcTrace_MsgState_t* statePtr,  ///< [IN] Message's tracing state.
+    ipcTrace_Stamp_t stamp,         ///< [IN] Point reached.
+    uint32_t msgId,                 ///< [IN] Message ID.
+    void* txnId                     ///< [IN] Transaction ID.
+)
+{
+    memset(statePtr->stamps, 0, sizeof(statePtr->stamps));
+    statePtr->stamps[stamp] = ipcTrace_GetTimeNs();
+    statePtr->msgId = msgId;
+    statePtr->txnId = txnId;
+    statePtr->isActive = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time-stamp a point in the life of a message, if the message is being traced.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void ipcTrace_Stamp
+(
+    ipcTrace_MsgState_t* statePtr,  ///< [IN] Message's tracing state.
+    ipcTrace_Stamp_t stamp          ///< [IN] Point reached.
+)
+{
+    if (statePtr->isActive)
+    {
+        statePtr->stamps[stamp] = ipcTrace_GetTimeNs();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a traced message's record into the calling process's trace ring and stop tracing it.
+ */
+//--------------------------------------------------------------------------------------------------
+void ipcTrace_Write
+(
+    ipcTrace_MsgState_t* statePtr,  ///< [IN] Message's tracing state.
+    ipcTrace_Role_t role,           ///< [IN] Side of the session.
+    const char* interfaceName,      ///< [IN] Name of the interface.
+    size_t size,                    ///< [IN] Message size (bytes).
+    pid_t peerPid                   ///< [IN] Client's process ID (server side), or 0.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map another process's trace ring read-only (for use by diagnostic tools).
+ *
+ * @return Pointer to the ring, or NULL if the process has no (valid) ring.  Release it with
+ *         ipcTrace_UnmapRing().
+ */
+//--------------------------------------------------------------------------------------------------
+const ipcTrace_Ring_t* ipcTrace_MapProcessRing
+(
+    pid_t pid                       ///< [IN] ID of the process to look at.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a ring mapped using ipcTrace_MapProcessRing().
+ */
+//--------------------------------------------------------------------------------------------------
+void ipcTrace_UnmapRing
+(
+    const ipcTrace_Ring_t* ringPtr  ///< [IN] Ring to unmap.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a record out of a mapped ring.
+ *
+ * @return true if the slot holds a complete record, false if it is empty or being overwritten.
+ */
+//--------------------------------------------------------------------------------------------------
+bool ipcTrace_ReadRecord
+(
+    const ipcTrace_Ring_t* ringPtr, ///< [IN] Ring.
+    size_t index,                   ///< [IN] Slot index (0 to IPCTRACE_NUM_RECORDS - 1).
+    ipcTrace_Record_t* recordPtr    ///< [OUT] Copy of the record.
+);
+
+
+#endif  // LEGATO_SRC_IPC_TRACE_INCLUDE_GUARD
@@ -0,0 +1,691 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file jsonWriter.c JSON Writing API implementation
+ *
+ * Each token (with the comma that precedes it) is formatted directly into the free space of the
+ * writer's buffer.  If it doesn't fit, the part that was formatted is dropped, the buffer is
+ * flushed to the writer's file descriptor and the token is formatted again.  So a token is always
+ * written whole or not at all, and a call that fails can be made again later.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Token being formatted into the free space of a writer's buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* ptr;          ///< Where the next byte goes.
+    char* endPtr;       ///< End of the free space.
+    bool isFull;        ///< True if the token didn't fit in the free space.
+}
+Token_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add bytes to a token.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PutBytes
+(
+    Token_t* tokenPtr,      ///< [IN] Token.
+    const char* bytesPtr,   ///< [IN] Bytes.
+    size_t count            ///< [IN] Number of bytes.
+)
+{
+    if (count <= (size_t)(tokenPtr->endPtr - tokenPtr->ptr))
+    {
+        memcpy(tokenPtr->ptr, bytesPtr, count);
+        tokenPtr->ptr += count;
+    }
+    else
+    {
+        tokenPtr->isFull = true;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a quoted and escaped string to a token.
+ *
+ * @return
+ *      - LE_OK if successful (or if the token is full).
+ *      - LE_FORMAT_ERROR if the string is not valid UTF-8.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PutString
+(
+    Token_t* tokenPtr,      ///< [IN] Token.
+    const char* strPtr      ///< [IN] String (UTF-8).
+)
+{
+    PutBytes(tokenPtr, "\"", 1);
+
+    while ((*strPtr != '\0') && !tokenPtr->isFull)
+    {
+        // Copy the characters that need no escaping in one go.
+        size_t count = 0;
+        unsigned char c;
+
+        while (c = (unsigned char)strPtr[count],
+               (c >= 0x20) && (c < 0x80) && (c != '"') && (c != '\\'))
+        {
+            count++;
+        }
+        PutBytes(tokenPtr, strPtr, count);
+        strPtr += count;
+
+        if (c == '\0')
+        {
+            break;
+        }
+
+        if (c >= 0x80)
+        {
+            // Multi-byte character: check it, then copy it as is.
+            size_t charBytes = le_utf8_NumBytesInChar((char)c);
+            size_t i;
+
+            if (charBytes == 0)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            for (i = 1; i < charBytes; i++)
+            {
+                if (!le_utf8_IsContinuationByte(strPtr[i]))
+                {
+                    return LE_FORMAT_ERROR;
+                }
+            }
+
+            PutBytes(tokenPtr, strPtr, charBytes);
+            strPtr += charBytes;
+        }
+        else
+        {
+            char escape[8];
+
+            switch (c)
+            {
+                case '"':   PutBytes(tokenPtr, "\\\"", 2); break;
+                case '\\':  PutBytes(tokenPtr, "\\\\", 2); break;
+                case '\b':  PutBytes(tokenPtr, "\\b", 2); break;
+                case '\f':  PutBytes(tokenPtr, "\\f", 2); break;
+                case '\n':  PutBytes(tokenPtr, "\\n", 2); break;
+                case '\r':  PutBytes(tokenPtr, "\\r", 2); break;
+                case '\t':  PutBytes(tokenPtr, "\\t", 2); break;
+                default:
+                    snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    PutBytes(tokenPtr, escape, 6);
+                    break;
+            }
+            strPtr++;
+        }
+    }
+
+    PutBytes(tokenPtr, "\"", 1);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bit of the current context in the writer's context masks.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t ContextBit
+(
+    const le_json_Writer_t* writerPtr   ///< [IN] Writer.
+)
+{
+    return (uint32_t)1 << (writerPtr->depth - 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if the writer is inside an object (rather than an array, or at the top level).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsInObject
+(
+    const le_json_Writer_t* writerPtr   ///< [IN] Writer.
+)
+{
+    return (writerPtr->depth > 0) && ((writerPtr->objectMask & ContextBit(writerPtr)) != 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a token: an optional comma, then an optional quoted string, then optional raw text.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteToken
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    bool needsComma,                ///< [IN] True to start the token with a comma.
+    const char* strPtr,             ///< [IN] String to quote and escape, or NULL.
+    const char* rawPtr,             ///< [IN] Text to write as is.
+    size_t rawBytes                 ///< [IN] Number of bytes of text.
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+
+    le_result_t result;
+
+    for (;;)
+    {
+        Token_t token =
+        {
+            .ptr = writerPtr->bufferPtr + writerPtr->usedBytes,
+            .endPtr = writerPtr->bufferPtr + writerPtr->bufferSize,
+            .isFull = false
+        };
+
+        if (needsComma)
+        {
+            PutBytes(&token, ",", 1);
+        }
+        if ((strPtr != NULL) && (PutString(&token, strPtr) != LE_OK))
+        {
+            result = LE_FORMAT_ERROR;
+            break;
+        }
+        PutBytes(&token, rawPtr, rawBytes);
+
+        if (!token.isFull)
+        {
+            writerPtr->usedBytes = token.ptr - writerPtr->bufferPtr;
+            result = LE_OK;
+            break;
+        }
+
+        // Make room by flushing the buffer, unless it can't help.
+        if ((writerPtr->fd < 0) || (writerPtr->usedBytes == 0))
+        {
+            result = LE_OVERFLOW;
+            break;
+        }
+
+        result = le_json_Flush(writerPtr);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // Terminate a buffer writer's document (again, if a token was dropped).
+    if (writerPtr->fd < 0)
+    {
+        writerPtr->bufferPtr[writerPtr->usedBytes] = '\0';
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a value (including the start of an object or array).
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteValue
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    const char* strPtr,             ///< [IN] String value to quote and escape, or NULL.
+    const char* rawPtr,             ///< [IN] Text to write as is.
+    size_t rawBytes                 ///< [IN] Number of bytes of text.
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+
+    LE_FATAL_IF(IsInObject(writerPtr) && !writerPtr->isMemberNamed,
+                "JSON object member value written without a name.");
+
+    bool needsComma = (writerPtr->depth > 0) &&
+                      !writerPtr->isMemberNamed &&
+                      ((writerPtr->nonEmptyMask & ContextBit(writerPtr)) != 0);
+
+    le_result_t result = WriteToken(writerPtr, needsComma, strPtr, rawPtr, rawBytes);
+
+    if ((result == LE_OK) && (writerPtr->depth > 0))
+    {
+        writerPtr->nonEmptyMask |= ContextBit(writerPtr);
+        writerPtr->isMemberNamed = false;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an object or an array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartContext
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    bool isObject                   ///< [IN] True for an object, false for an array.
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+
+    LE_FATAL_IF(writerPtr->depth >= LE_JSON_WRITER_MAX_DEPTH, "JSON document nested too deeply.");
+
+    le_result_t result = WriteValue(writerPtr, NULL, isObject ? "{" : "[", 1);
+
+    if (result == LE_OK)
+    {
+        writerPtr->depth++;
+        if (isObject)
+        {
+            writerPtr->objectMask |= ContextBit(writerPtr);
+        }
+        else
+        {
+            writerPtr->objectMask &= ~ContextBit(writerPtr);
+        }
+        writerPtr->nonEmptyMask &= ~ContextBit(writerPtr);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the current object or array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t EndContext
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    bool isObject                   ///< [IN] True for an object, false for an array.
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+
+    LE_FATAL_IF((writerPtr->depth == 0) || (IsInObject(writerPtr) != isObject),
+                "Ending a JSON %s that was not started.", isObject ? "object" : "array");
+    LE_FATAL_IF(writerPtr->isMemberNamed, "JSON object member has no value.");
+
+    le_result_t result = WriteToken(writerPtr, false, NULL, isObject ? "}" : "]", 1);
+
+    if (result == LE_OK)
+    {
+        writerPtr->depth--;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a JSON writer that writes a document into a buffer.  The buffer always holds a
+ * null-terminated string.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_InitBufferWriter
+(
+    le_json_Writer_t* writerPtr,    ///< [OUT] Writer.
+    char* bufferPtr,                ///< [IN] Buffer to write the document into.
+    size_t bufferSize               ///< [IN] Size of the buffer (bytes).
+)
+{
+    LE_ASSERT((bufferPtr != NULL) && (bufferSize > 0));
+
+    memset(writerPtr, 0, sizeof(*writerPtr));
+    writerPtr->bufferPtr = bufferPtr;
+    writerPtr->bufferSize = bufferSize - 1;     // Room for the null-terminator.
+    writerPtr->fd = -1;
+
+    bufferPtr[0] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a JSON writer that writes a document to a file descriptor, through a buffer.
+ *
+ * The buffer must be larger than any single token (e.g., string value) of the document.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_json_InitFdWriter
+(
+    le_json_Writer_t* writerPtr,    ///< [OUT] Writer.
+    int fd,                         ///< [IN] File descriptor to write to.
+    char* bufferPtr,                ///< [IN] Buffer.
+    size_t bufferSize               ///< [IN] Size of the buffer (bytes).
+)
+{
+    LE_ASSERT((fd >= 0) && (bufferPtr != NULL) && (bufferSize > 0));
+
+    memset(writerPtr, 0, sizeof(*writerPtr));
+    writerPtr->bufferPtr = bufferPtr;
+    writerPtr->bufferSize = bufferSize;
+    writerPtr->fd = fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the contents of a JSON writer's buffer to its file descriptor.  Does nothing for a writer
+ * initialized by le_json_InitBufferWriter().
+ *
+ * @return
+ *      - LE_OK if all the buffered data was written.
+ *      - LE_WOULD_BLOCK if the file descriptor couldn't take all of it (try again later).
+ *      - LE_FAULT if writing to the file descriptor failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_Flush
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+    if (writerPtr->fd < 0)
+    {
+        return LE_OK;
+    }
+
+    size_t offset = 0;
+
+    while (offset < writerPtr->usedBytes)
+    {
+        ssize_t count = write(writerPtr->fd,
+                              writerPtr->bufferPtr + offset,
+                              writerPtr->usedBytes - offset);
+        if (count > 0)
+        {
+            offset += count;
+        }
+        else if ((count < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else if ((count == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            writerPtr->isFailed = true;
+            return LE_FAULT;
+        }
+    }
+
+    // Keep what couldn't be written at the start of the buffer.
+    memmove(writerPtr->bufferPtr, writerPtr->bufferPtr + offset, writerPtr->usedBytes - offset);
+    writerPtr->usedBytes -= offset;
+    writerPtr->flushedBytes += offset;
+
+    return (writerPtr->usedBytes == 0) ? LE_OK : LE_WOULD_BLOCK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes written so far by a JSON writer (into its buffer or to its file
+ * descriptor), not counting the null-terminator of a buffer writer.
+ *
+ * @return The number of bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t le_json_GetBytesWritten
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return writerPtr->flushedBytes + writerPtr->usedBytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an object.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_StartObject
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return StartContext(writerPtr, true);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the current object.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_EndObject
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return EndContext(writerPtr, true);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_StartArray
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return StartContext(writerPtr, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the current array.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_EndArray
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return EndContext(writerPtr, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the name of a member of the current object.  Its value must be written next.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteMember
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    const char* namePtr             ///< [IN] Member name (UTF-8).
+)
+{
+    if (writerPtr->isFailed)
+    {
+        return LE_FAULT;
+    }
+
+    LE_FATAL_IF(!IsInObject(writerPtr), "JSON member name written outside of an object.");
+    LE_FATAL_IF(writerPtr->isMemberNamed, "JSON object member has no value.");
+
+    le_result_t result = WriteToken(writerPtr,
+                                    (writerPtr->nonEmptyMask & ContextBit(writerPtr)) != 0,
+                                    namePtr,
+                                    ":",
+                                    1);
+    if (result == LE_OK)
+    {
+        writerPtr->nonEmptyMask |= ContextBit(writerPtr);
+        writerPtr->isMemberNamed = true;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteString
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    const char* valuePtr            ///< [IN] Value (UTF-8).
+)
+{
+    return WriteValue(writerPtr, valuePtr, "", 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a signed integer number value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteInt
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    int64_t value                   ///< [IN] Value.
+)
+{
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%" PRId64, value);
+
+    return WriteValue(writerPtr, NULL, text, len);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write an unsigned integer number value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteUint
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    uint64_t value                  ///< [IN] Value.
+)
+{
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%" PRIu64, value);
+
+    return WriteValue(writerPtr, NULL, text, len);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a number value.  Infinite and NaN values, which JSON can't represent, are written as null.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteNumber
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    double value                    ///< [IN] Value.
+)
+{
+    if (!isfinite(value))
+    {
+        return le_json_WriteNull(writerPtr);
+    }
+
+    char text[32];
+    int len = snprintf(text, sizeof(text), "%.17g", value);
+
+    return WriteValue(writerPtr, NULL, text, len);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a true or false value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteBool
+(
+    le_json_Writer_t* writerPtr,    ///< [IN] Writer.
+    bool value                      ///< [IN] Value.
+)
+{
+    return value ? WriteValue(writerPtr, NULL, "true", 4) : WriteValue(writerPtr, NULL, "false", 5);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a null value.
+ *
+ * @return LE_OK, or an error described in @ref c_json_writer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_json_WriteNull
+(
+    le_json_Writer_t* writerPtr     ///< [IN] Writer.
+)
+{
+    return WriteValue(writerPtr, NULL, "null", 4);
+}
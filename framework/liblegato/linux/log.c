@@ -12,6 +12,8 @@
 #include "logDaemon/logDaemon.h"
 #include "limit.h"
 #include "messagingSession.h"
+#include "fileDescriptor.h"
+#include <sys/socket.h>
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -129,6 +131,17 @@ static le_mem_PoolRef_t KeywordMemPool;
 static le_msg_SessionRef_t IpcSessionRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Socket through which the messages logged are sent to the Log Control Daemon, to be kept in its
+ * log store.  -1 if the log store is not enabled.
+ *
+ * @note    Only changed with the Mutex locked, but read without it to skip locking when it's -1.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int StoreFd = -1;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trace reference used for controlling tracing in this module.
@@ -618,6 +631,75 @@ static bool ParseCmdPacket
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts or stops sending the messages logged to the Log Control Daemon's log store.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SetStoreSocket
+(
+    int fd      ///< [IN] Socket to send the messages to, or -1 to stop.
+)
+{
+    if (fd >= 0)
+    {
+        // Don't pass the socket on to programs exec'ed, which would be logging under our name.
+        LE_ASSERT(fcntl(fd, F_SETFD, FD_CLOEXEC) == 0);
+    }
+
+    Lock();
+
+    int oldFd = StoreFd;
+    __atomic_store_n(&StoreFd, fd, __ATOMIC_RELAXED);
+
+    Unlock();
+
+    if (oldFd >= 0)
+    {
+        fd_Close(oldFd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a message logged to the Log Control Daemon's log store, if it is enabled.  The message is
+ * dropped rather than blocking the caller if the Log Control Daemon is not keeping up.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SendToStore
+(
+    le_log_Level_t level,           ///< [IN] Severity level (LE_LOG_DEBUG for traces).
+    const char* compNamePtr,        ///< [IN] Name of the component that logged the message.
+    const char* msgPtr              ///< [IN] Message.
+)
+{
+    if (__atomic_load_n(&StoreFd, __ATOMIC_RELAXED) < 0)
+    {
+        return;
+    }
+
+    char buff[LOG_MAX_STORE_MSG_BYTES];
+    int len = snprintf(buff, sizeof(buff), "%c%s/%s", '0' + level, compNamePtr, msgPtr);
+
+    if (len >= (int)sizeof(buff))
+    {
+        len = sizeof(buff) - 1;
+    }
+
+    // The socket is only closed with the mutex locked, so that it can't be closed (and its fd
+    // reused) while a message is being sent through it.
+    Lock();
+
+    if (StoreFd >= 0)
+    {
+        (void)send(StoreFd, buff, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    Unlock();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Processes a remote logging command.  This function should be called by the event loop when there
@@ -661,6 +743,10 @@ static void ProcessLogCmd
                 DisableTrace(componentName, commandDataPtr);
                 break;
 
+            case LOG_CMD_SET_STORE_SOCKET:
+                SetStoreSocket((strcmp(commandDataPtr, "1") == 0) ? le_msg_GetFd(msgRef) : -1);
+                break;
+
             default:
                 LE_ERROR("Invalid command character '%c'.", command);
                 break;
@@ -1102,6 +1188,8 @@ void _le_log_Send
 
     va_end(varParams);
 
+    SendToStore((traceRef == NULL) ? level : LE_LOG_DEBUG, compNamePtr, msg);
+
     // If running on an embedded target, write the message out to the log.
 #ifdef LEGATO_EMBEDDED
 
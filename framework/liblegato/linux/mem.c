@@ -335,6 +335,7 @@ static void InitPool
     pool->totalBlocks = 0;
     pool->numBlocksInUse = 0;
     pool->maxNumBlocksUsed = 0;
+    pool->maxUsedMetricRef = metrics_GetCounter(METRICS_GAUGE, "pool.%s", pool->name);
     pool->numBlocksToForce = DEFAULT_NUM_BLOCKS_TO_FORCE;
 
     #ifdef LE_MEM_TRACE
@@ -698,6 +699,8 @@ le_mem_PoolRef_t le_mem_ExpandPool
             if (pool->superPoolPtr->numBlocksInUse > pool->superPoolPtr->maxNumBlocksUsed)
             {
                 pool->superPoolPtr->maxNumBlocksUsed = pool->superPoolPtr->numBlocksInUse;
+                metrics_Set(pool->superPoolPtr->maxUsedMetricRef,
+                            pool->superPoolPtr->maxNumBlocksUsed);
             }
         }
         else
@@ -761,6 +764,7 @@ void* le_mem_TryAlloc
         if (pool->numBlocksInUse > pool->maxNumBlocksUsed)
         {
             pool->maxNumBlocksUsed = pool->numBlocksInUse;
+            metrics_Set(pool->maxUsedMetricRef, pool->maxNumBlocksUsed);
         }
 
         blockPtr->refCount = 1;
@@ -13,6 +13,7 @@
 #define MEM_INCLUDE_GUARD
 
 #include "limit.h"
+#include "metrics.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -38,6 +39,7 @@ typedef struct le_mem_Pool
                                         ///  and allocated blocks.
     size_t numBlocksInUse;              ///< Number of currently allocated blocks.
     size_t maxNumBlocksUsed;            ///< Maximum number of allocated blocks at any one time.
+    metrics_CounterRef_t maxUsedMetricRef; ///< Runtime metric mirroring maxNumBlocksUsed.
     size_t numBlocksToForce;            ///< Number of blocks that is added when Force Alloc
                                         ///  expands the pool.
     #ifdef LE_MEM_TRACE
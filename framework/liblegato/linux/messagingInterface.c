@@ -200,6 +200,13 @@ static void InitInterface
                 sizeof(interfacePtr->id.name));
 
     interfacePtr->sessionList = LE_DLS_LIST_INIT;
+
+    // Interfaces that are deleted and re-created keep counting into the same metrics.
+    const char* rolePtr = (interfaceType == LE_MSG_INTERFACE_SERVER) ? "srv" : "cli";
+    interfacePtr->txCountRef = metrics_GetCounter(METRICS_COUNTER,
+                                                  "ipc.%s.%s.tx", rolePtr, interfacePtr->id.name);
+    interfacePtr->rxCountRef = metrics_GetCounter(METRICS_COUNTER,
+                                                  "ipc.%s.%s.rx", rolePtr, interfacePtr->id.name);
 }
 
 
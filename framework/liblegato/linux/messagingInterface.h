@@ -11,6 +11,7 @@
 #define LE_MESSAGING_INTERFACE_H_INCLUDE_GUARD
 
 #include "limit.h"
+#include "metrics.h"
 #include "serviceDirectory/serviceDirectoryProtocol.h"
 
 
@@ -53,6 +54,8 @@ typedef struct le_msg_Interface
     le_dls_List_t sessionList;         ///< List of Session objects for open sessions with other
                                        ///  interfaces.
     msgInterface_Type_t interfaceType; ///< The type of the more specific interface object.
+    metrics_CounterRef_t txCountRef;   ///< Runtime metric: messages sent through the interface.
+    metrics_CounterRef_t rxCountRef;   ///< Runtime metric: messages received by the interface.
 }
 msgInterface_Interface_t;
 
@@ -67,6 +67,55 @@ static void MessageDestructor
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates a Message object with a payload buffer of at least a given size (but no larger than
+ * the protocol's largest message) and initializes everything but the payload.
+ *
+ * @return A pointer to the Message object.
+ */
+//--------------------------------------------------------------------------------------------------
+static Message_t* AllocMessage
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Session the message belongs to.
+    size_t payloadSize              ///< [in] Size (in bytes) of the payload needed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Get a reference to the Session's Protocol and ask the Protocol to allocate a Message
+    // object from one of its Message Pools.
+    Message_t* msgPtr = msgProto_AllocMessage(le_msg_GetSessionProtocol(sessionRef), payloadSize);
+
+    // Initialize the Message object's data members.
+    msgPtr->link = LE_DLS_LINK_INIT;
+    msgPtr->sessionRef = sessionRef;
+    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
+
+    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
+    switch (interfaceType)
+    {
+        case LE_MSG_INTERFACE_CLIENT:
+            msgPtr->clientServer.client.completionCallback = NULL;
+            msgPtr->clientServer.client.contextPtr = NULL;
+            break;
+
+        case LE_MSG_INTERFACE_SERVER:
+            msgPtr->clientServer.server.responseFd = -1;
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d).", interfaceType);
+    }
+
+    msgPtr->fd = -1;
+    msgPtr->trace.isActive = false;
+    msgPtr->usedSize = msgPtr->payloadSize;
+    msgPtr->txnId = 0;
+
+    return msgPtr;
+}
+
+
 // =======================================
 //  PROTECTED (INTER-MODULE) FUNCTIONS
 // =======================================
@@ -89,34 +138,34 @@ void msgMessage_Init
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create a Message Pool.
+ * Create a Message Pool.  The pool is named "msgs<payloadSize>-<name>".
  *
  * @return  A reference to the pool.
  */
 //--------------------------------------------------------------------------------------------------
 le_mem_PoolRef_t msgMessage_CreatePool
 (
-    const char* name,       ///< [in] Name of the pool.
-    size_t largestMsgSize   ///< [in] Size of the largest message payload, in bytes.
+    const char* name,       ///< [in] Name of the protocol.
+    size_t payloadSize,     ///< [in] Size of the message payloads in the pool, in bytes.
+    size_t numObjs          ///< [in] Number of messages to allocate up front.
 )
 //--------------------------------------------------------------------------------------------------
 {
     char poolName[LIMIT_MAX_MEM_POOL_NAME_BYTES];
-    size_t bytesCopied;
-    le_result_t result;
 
-    le_utf8_Copy(poolName, "msgs-", sizeof(poolName), &bytesCopied);
-    result = le_utf8_Copy(poolName + bytesCopied, name, sizeof(poolName) - bytesCopied, NULL);
-    if (result != LE_OK)
+    if (snprintf(poolName, sizeof(poolName), "msgs%zu-%s", payloadSize, name) >= sizeof(poolName))
     {
         LE_DEBUG("Pool name truncated to '%s' for protocol '%s'.", poolName, name);
     }
 
-    le_mem_PoolRef_t poolRef = le_mem_CreatePool(poolName, sizeof(Message_t) + largestMsgSize);
+    le_mem_PoolRef_t poolRef = le_mem_CreatePool(poolName, sizeof(Message_t) + payloadSize);
 
     le_mem_SetDestructor(poolRef, MessageDestructor);
 
-    le_mem_ExpandPool(poolRef, 10); /// @todo Make this configurable.
+    if (numObjs > 0)
+    {
+        le_mem_ExpandPool(poolRef, numObjs); /// @todo Make this configurable.
+    }
 
     return poolRef;
 }
@@ -160,9 +209,10 @@ le_result_t msgMessage_Send
 
     // The first bytes come from our transaction ID and the rest (if any)
     // from our Message object's payload section, which comes right after the transaction ID.
+    // Only the part of the payload that is in use is sent.
     return unixSocket_SendMsg(  socketFd,
                                 &msgPtr->txnId,
-                                sizeof(msgPtr->txnId) + le_msg_GetMaxPayloadSize(msgPtr),
+                                sizeof(msgPtr->txnId) + msgPtr->usedSize,
                                 msgPtr->fd,
                                 false   ); // Don't send process credentials.
 }
@@ -170,36 +220,81 @@ le_result_t msgMessage_Send
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Receive a single message from a connected socket.
+ * Receive a single message from a connected socket into a new Message object, big enough for the
+ * message and for the largest response to it.
  *
  * @return
  * - LE_OK if successful.
  * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking.
  * - LE_CLOSED if the connection has closed.
- * - LE_COMM_ERROR if an error was encountered.
+ * - LE_FAULT if an error was encountered.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t msgMessage_Receive
 (
-    int                 socketFd,   ///< [IN] The socket's file descriptor.
-    le_msg_MessageRef_t msgRef      ///< [IN] Message object to store the received message in.
+    int                  socketFd,  ///< [IN] The socket's file descriptor.
+    le_msg_SessionRef_t  sessionRef,///< [IN] Session the message is received on.
+    le_msg_MessageRef_t* msgRefPtr  ///< [OUT] New Message object (only set if LE_OK returned).
 )
 //--------------------------------------------------------------------------------------------------
 {
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
+
+    // Look at the transaction ID and message ID (if any) to find out how big the payload buffer
+    // needs to be.  A server writes its response in the request's buffer, so that must be big
+    // enough for the largest response too.
+    uint8_t header[sizeof(void*) + sizeof(uint32_t)];
+    size_t byteCount = sizeof(header);
+    le_result_t result = unixSocket_PeekMsg(socketFd, header, &byteCount);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    size_t payloadSize = le_msg_GetProtocolMaxMsgSize(protocolRef);
+
+    if (byteCount >= sizeof(header))
+    {
+        uint32_t msgId;
+        memcpy(&msgId, header + sizeof(void*), sizeof(msgId));
+
+        payloadSize = msgProto_GetMsgSize(protocolRef, msgId);
+        if (payloadSize < byteCount - sizeof(void*))
+        {
+            payloadSize = byteCount - sizeof(void*);
+        }
+    }
+
+    Message_t* msgPtr = AllocMessage(sessionRef, payloadSize);
+
     // Receive the first bytes into our transaction ID and the rest (if any)
     // into our Message object's payload section.
-    size_t byteCount = sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef);
-    le_result_t result = unixSocket_ReceiveMsg( socketFd,
-                                                &msgRef->txnId,
-                                                &byteCount,
-                                                &msgRef->fd,
-                                                NULL    );  // Don't receive credentials.
-    if (msgSession_GetInterfaceType(msgRef->sessionRef) == LE_MSG_INTERFACE_SERVER)
+    byteCount = sizeof(msgPtr->txnId) + msgPtr->payloadSize;
+    result = unixSocket_ReceiveMsg( socketFd,
+                                    &msgPtr->txnId,
+                                    &byteCount,
+                                    &msgPtr->fd,
+                                    NULL    );  // Don't receive credentials.
+    if (result != LE_OK)
     {
-        msgRef->clientServer.server.responseFd = -1;
+        // Don't let the destructor think a response is owed for a message that wasn't received.
+        msgPtr->txnId = 0;
+        le_msg_ReleaseMsg(msgPtr);
+        return result;
     }
 
-    return result;
+    // The sender may only have sent the part of its payload that was in use.
+    size_t receivedSize = (byteCount > sizeof(msgPtr->txnId)) ?
+                          (byteCount - sizeof(msgPtr->txnId)) : 0;
+    memset((uint8_t*)msgPtr->payload + receivedSize, 0, msgPtr->payloadSize - receivedSize);
+
+    // The IPC trace records the bytes actually received, not the size of the buffer.
+    msgPtr->trace.size = receivedSize;
+
+    *msgRefPtr = msgPtr;
+
+    return LE_OK;
 }
 
 
@@ -245,35 +340,32 @@ le_msg_MessageRef_t le_msg_CreateMsg
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Get a reference to the Session's Protocol and ask the Protocol to allocate a Message
-    // object from its Message Pool.
     le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
-    Message_t* msgPtr = msgProto_AllocMessage(protocolRef);
 
-    // Initialize the Message object's data members.
-    msgPtr->link = LE_DLS_LINK_INIT;
-    msgPtr->sessionRef = sessionRef;
-    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
-
-    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
-    switch (interfaceType)
-    {
-        case LE_MSG_INTERFACE_CLIENT:
-            msgPtr->clientServer.client.completionCallback = NULL;
-            msgPtr->clientServer.client.contextPtr = NULL;
-            break;
+    return le_msg_CreateSizedMsg(sessionRef, le_msg_GetProtocolMaxMsgSize(protocolRef));
+}
 
-        case LE_MSG_INTERFACE_SERVER:
-            msgPtr->clientServer.server.responseFd = -1;
-            break;
 
-        default:
-            LE_FATAL("Unhandled interface type (%d).", interfaceType);
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a message to be sent over a given session, with a payload buffer of at least a given
+ * size (but no larger than the protocol's largest message).
+ *
+ * @return  The message reference.
+ *
+ * @note This function never returns on failure, so no need to check the return code.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_msg_CreateSizedMsg
+(
+    le_msg_SessionRef_t sessionRef, ///< [in] Reference to the session.
+    size_t payloadSize              ///< [in] Size (in bytes) of the payload needed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Message_t* msgPtr = AllocMessage(sessionRef, payloadSize);
 
-    msgPtr->fd = -1;
-    msgPtr->txnId = 0;
-    memset(msgPtr->payload, 0, le_msg_GetProtocolMaxMsgSize(protocolRef));
+    memset(msgPtr->payload, 0, msgPtr->payloadSize);
 
     return msgPtr;
 }
@@ -368,7 +460,29 @@ size_t le_msg_GetMaxPayloadSize
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(msgRef->sessionRef));
+    return msgRef->payloadSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets how many bytes at the start of the message payload buffer are in use and need to be sent.
+ * By default, the whole buffer is sent.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadSize
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t payloadSize              ///< [in] Number of bytes in use (at most the buffer size).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(payloadSize > msgRef->payloadSize,
+                "Payload size (%zu) is larger than the message's buffer (%zu).",
+                payloadSize,
+                msgRef->payloadSize);
+
+    msgRef->usedSize = payloadSize;
 }
 
 
@@ -8,6 +8,8 @@
 #ifndef LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 #define LEGATO_MESSAGING_MESSAGE_H_INCLUDE_GUARD
 
+#include "ipcTrace.h"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a message.
@@ -41,6 +43,9 @@ typedef struct le_msg_Message
     clientServer;
 
     int                         fd;         ///< File descriptor to send or received (-1 = no fd)
+    ipcTrace_MsgState_t         trace;      ///< Time stamps recorded while tracing is enabled.
+    size_t                      payloadSize;///< Size of the payload buffer (size class), in bytes.
+    size_t                      usedSize;   ///< Number of payload bytes to send.
     void*                       txnId;      ///< Safe reference value used as a transaction ID.
     void*                       payload[0]; ///< Variable-length payload buffer appears at the end.
 }
@@ -68,8 +73,9 @@ void msgMessage_Init
 //--------------------------------------------------------------------------------------------------
 le_mem_PoolRef_t msgMessage_CreatePool
 (
-    const char* name,       ///< [in] Name of the pool.
-    size_t largestMsgSize   ///< [in] Size of the largest message payload, in bytes.
+    const char* name,       ///< [in] Name of the protocol.
+    size_t payloadSize,     ///< [in] Size of the message payloads in the pool, in bytes.
+    size_t numObjs          ///< [in] Number of messages to allocate up front.
 );
 
 
@@ -92,19 +98,21 @@ le_result_t msgMessage_Send
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Receive a single message from a connected socket.
+ * Receive a single message from a connected socket into a new Message object, big enough for the
+ * message and for the largest response to it.
  *
  * @return
  * - LE_OK if successful.
  * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking.
  * - LE_CLOSED if the connection has closed.
- * - LE_COMM_ERROR if an error was encountered.
+ * - LE_FAULT if an error was encountered.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t msgMessage_Receive
 (
-    int                 socketFd,   ///< [IN] The socket's file descriptor.
-    le_msg_MessageRef_t msgRef      ///< [IN] Message object to store the received message in.
+    int                  socketFd,  ///< [IN] The socket's file descriptor.
+    le_msg_SessionRef_t  sessionRef,///< [IN] Session the message is received on.
+    le_msg_MessageRef_t* msgRefPtr  ///< [OUT] New Message object (only set if LE_OK returned).
 );
 
 
@@ -175,6 +183,36 @@ static inline void* msgMessage_GetTxnId
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of payload bytes a Message object sends.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t msgMessage_GetUsedSize
+(
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return msgRef->usedSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to a Message object's IPC tracing state.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline ipcTrace_MsgState_t* msgMessage_GetTraceStatePtr
+(
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return &msgRef->trace;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Call the completion callback function for a given message.
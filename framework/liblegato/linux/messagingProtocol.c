@@ -110,12 +110,33 @@ static msgProtocol_Protocol_t* CreateProtocol
 
     protocolPtr->link = LE_SLS_LINK_INIT;
     protocolPtr->maxPayloadSize = largestMsgSize;
+    protocolPtr->msgSizesPtr = NULL;
+    protocolPtr->msgCount = 0;
     if (le_utf8_Copy(protocolPtr->id, protocolId, sizeof(protocolPtr->id), NULL) == LE_OVERFLOW)
     {
         LE_CRIT("Protocol identifier truncated from '%s' to '%s'.", protocolId, protocolPtr->id);
     }
 
-    protocolPtr->messagePoolRef = msgMessage_CreatePool(protocolId, largestMsgSize);
+    // Create one Message Pool per size class.  Only the smallest class is populated up front, as
+    // most messages are small; the others grow when they are used.
+    size_t classSize = MSG_PROTOCOL_MIN_CLASS_SIZE;
+    size_t i = 0;
+
+    while ((classSize < largestMsgSize) && (i < MSG_PROTOCOL_MAX_SIZE_CLASSES - 1))
+    {
+        protocolPtr->classSizes[i] = classSize;
+        protocolPtr->messagePoolRefs[i] = msgMessage_CreatePool(protocolId,
+                                                                classSize,
+                                                                (i == 0) ? 10 : 0);
+        classSize *= 4;
+        i++;
+    }
+
+    protocolPtr->classSizes[i] = largestMsgSize;
+    protocolPtr->messagePoolRefs[i] = msgMessage_CreatePool(protocolId,
+                                                            largestMsgSize,
+                                                            (i == 0) ? 10 : 0);
+    protocolPtr->classCount = i + 1;
 
     LOCK
 
@@ -150,19 +171,58 @@ void msgProto_Init
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Allocate a Message object from a given Protocol's Message Pool.
+ * Allocate a Message object from the smallest of a given Protocol's Message Pools that can hold a
+ * given payload size (or from the largest, if the payload size is bigger than the protocol allows).
  *
- * @return A pointer to the (uninitialized) Message object memory.
+ * @return A pointer to the Message object memory.  Only the payload size field is initialized.
  */
 //--------------------------------------------------------------------------------------------------
 le_msg_MessageRef_t msgProto_AllocMessage
 (
-    le_msg_ProtocolRef_t protocolRef
+    le_msg_ProtocolRef_t protocolRef,
+    size_t payloadSize
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Allocate a Message object from this Protocol's Message Pool.
-    return le_mem_ForceAlloc(protocolRef->messagePoolRef);
+    size_t i = 0;
+
+    while ((i < protocolRef->classCount - 1) && (protocolRef->classSizes[i] < payloadSize))
+    {
+        i++;
+    }
+
+    // Allocate a Message object from this size class's Message Pool.
+    Message_t* msgPtr = le_mem_ForceAlloc(protocolRef->messagePoolRefs[i]);
+    msgPtr->payloadSize = protocolRef->classSizes[i];
+
+    return msgPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the largest payload size of messages that have a given message ID (the first uint32_t of
+ * the payload).
+ *
+ * @return The size, in bytes, or the protocol's maximum payload size if it is not known.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgProto_GetMsgSize
+(
+    le_msg_ProtocolRef_t protocolRef,
+    uint32_t msgId
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The count is set before the table pointer is published, so it is valid if the pointer is.
+    const size_t* msgSizesPtr = __atomic_load_n(&protocolRef->msgSizesPtr, __ATOMIC_ACQUIRE);
+
+    if ((msgSizesPtr == NULL) || (msgId >= protocolRef->msgCount))
+    {
+        return protocolRef->maxPayloadSize;
+    }
+
+    return msgSizesPtr[msgId];
 }
 
 
@@ -201,6 +261,48 @@ le_msg_ProtocolRef_t le_msg_GetProtocolRef
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the size of the largest message (request or response) for each message ID of a protocol
+ * whose payloads start with a uint32_t message ID.  This allows received messages to be allocated
+ * from smaller message pools.
+ *
+ * The array must remain valid as long as the process runs (typically, it is a constant).  Only the
+ * first call for a protocol has any effect.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetProtocolMsgSizes
+(
+    le_msg_ProtocolRef_t protocolRef,   ///< [in] Reference to the protocol.
+    const size_t* msgSizesPtr,          ///< [in] Largest payload size for each message ID.
+    size_t msgCount                     ///< [in] Number of message IDs.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < msgCount; i++)
+    {
+        LE_FATAL_IF(msgSizesPtr[i] > protocolRef->maxPayloadSize,
+                    "Message %zu of protocol '%s' is larger (%zu) than the protocol allows (%zu).",
+                    i,
+                    protocolRef->id,
+                    msgSizesPtr[i],
+                    protocolRef->maxPayloadSize);
+    }
+
+    LOCK
+
+    if (protocolRef->msgSizesPtr == NULL)
+    {
+        protocolRef->msgCount = msgCount;
+        __atomic_store_n(&protocolRef->msgSizesPtr, msgSizesPtr, __ATOMIC_RELEASE);
+    }
+
+    UNLOCK
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the unique identifier string of the protocol.
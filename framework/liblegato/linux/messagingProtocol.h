@@ -10,6 +10,23 @@
 
 #include "limit.h"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of message size classes (message pools) per protocol.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_PROTOCOL_MAX_SIZE_CLASSES   6
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Payload size (in bytes) of the smallest message size class.  Each class is four times the size
+ * of the previous one, except the last one, which is the protocol's maximum payload size.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_PROTOCOL_MIN_CLASS_SIZE     128
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a messaging protocol.
@@ -20,7 +37,11 @@ typedef struct le_msg_Protocol
     le_sls_Link_t link;                     ///< Used to link this into the Protocol List.
     char id[LIMIT_MAX_PROTOCOL_ID_BYTES];   ///< Unique identifier for the protocol.
     size_t maxPayloadSize;                  ///< Max payload size (in bytes) in this protocol.
-    le_mem_PoolRef_t messagePoolRef;        ///< Pool of Message objects.
+    size_t classCount;                      ///< Number of message size classes.
+    size_t classSizes[MSG_PROTOCOL_MAX_SIZE_CLASSES];   ///< Payload size of each class, ascending.
+    le_mem_PoolRef_t messagePoolRefs[MSG_PROTOCOL_MAX_SIZE_CLASSES];    ///< Pool for each class.
+    const size_t* msgSizesPtr;              ///< Largest payload size of each message ID, or NULL.
+    size_t msgCount;                        ///< Number of entries in msgSizesPtr.
 }
 msgProtocol_Protocol_t;
 
@@ -39,14 +60,31 @@ void msgProto_Init
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Allocate a Message object from a given Protocol's Message Pool.
+ * Allocate a Message object from the smallest of a given Protocol's Message Pools that can hold a
+ * given payload size (or from the largest, if the payload size is bigger than the protocol allows).
  *
- * @return A pointer to the (uninitialized) Message object memory.
+ * @return A pointer to the Message object memory.  Only the payload size field is initialized.
  */
 //--------------------------------------------------------------------------------------------------
 le_msg_MessageRef_t msgProto_AllocMessage
 (
-    le_msg_ProtocolRef_t protocolRef
+    le_msg_ProtocolRef_t protocolRef,
+    size_t payloadSize
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the largest payload size of messages that have a given message ID (the first uint32_t of
+ * the payload).
+ *
+ * @return The size, in bytes, or the protocol's maximum payload size if it is not known.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgProto_GetMsgSize
+(
+    le_msg_ProtocolRef_t protocolRef,
+    uint32_t msgId
 );
 
 
@@ -54,6 +54,17 @@ static le_log_TraceRef_t TraceRef;
 #define TRACE(...) LE_TRACE(TraceRef, ##__VA_ARGS__)
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace reference used for turning IPC message tracing on and off (see ipcTrace.h).
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_log_TraceRef_t IpcTraceRef;
+
+/// true if new messages should be traced.
+#define IS_IPC_TRACE_ENABLED() LE_IS_TRACE_ENABLED(IpcTraceRef)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Pool from which Session objects are allocated.
@@ -207,6 +218,76 @@ static le_msg_MessageRef_t PopReceiveQueue
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts tracing a message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BeginTrace
+(
+    le_msg_MessageRef_t msgRef,
+    ipcTrace_Stamp_t stamp          ///< [IN] Point reached.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t msgId = 0;
+
+    // Generated interface code puts the message ID in the first word of the payload.
+    if (le_msg_GetMaxPayloadSize(msgRef) >= sizeof(msgId))
+    {
+        memcpy(&msgId, le_msg_GetPayloadPtr(msgRef), sizeof(msgId));
+    }
+
+    ipcTrace_Begin(msgMessage_GetTraceStatePtr(msgRef), stamp, msgId, msgMessage_GetTxnId(msgRef));
+
+    // A received message's size was recorded when it was received. A message being sent has its
+    // payload filled in by now, so only the used part of the buffer is counted.
+    if (stamp != IPCTRACE_RECEIVE)
+    {
+        msgMessage_GetTraceStatePtr(msgRef)->size = msgMessage_GetUsedSize(msgRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the trace record of a traced message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTrace
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ipcTrace_Role_t role = IPCTRACE_ROLE_CLIENT;
+    pid_t peerPid = 0;
+
+    if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
+    {
+        struct ucred credentials;
+        socklen_t credSize = sizeof(credentials);
+
+        role = IPCTRACE_ROLE_SERVER;
+
+        // The client's PID is what allows this record to be matched with the client's record.
+        // The session may already be closed, in which case the record just won't be matched.
+        if (getsockopt(sessionPtr->socketFd, SOL_SOCKET, SO_PEERCRED, &credentials, &credSize)
+            == 0)
+        {
+            peerPid = credentials.pid;
+        }
+    }
+
+    ipcTrace_Write(msgMessage_GetTraceStatePtr(msgRef),
+                   role,
+                   le_msg_GetInterfaceName(sessionPtr->interfaceRef),
+                   msgMessage_GetTraceStatePtr(msgRef)->size,
+                   peerPid);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a transaction ID for a given message and stores it inside the Message object.
@@ -759,9 +840,28 @@ static void ProcessMessageFromServer
         // Remove the request message from the session's Transaction List.
         RemoveFromTxnList(sessionPtr, requestMsgRef);
 
+        // If the request is being traced, the response's arrival completes its time stamps.
+        ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(requestMsgRef);
+
+        if (tracePtr->isActive)
+        {
+            ipcTrace_MsgState_t* responseTracePtr = msgMessage_GetTraceStatePtr(msgRef);
+
+            tracePtr->stamps[IPCTRACE_RECEIVE] = responseTracePtr->isActive ?
+                                                    responseTracePtr->stamps[IPCTRACE_RECEIVE] :
+                                                    ipcTrace_GetTimeNs();
+            ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_START);
+        }
+
         // Call the completion callback function from the request message.
         msgMessage_CallCompletionCallback(requestMsgRef, msgRef);
 
+        if (tracePtr->isActive)
+        {
+            ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_END);
+            WriteTrace(sessionPtr, requestMsgRef);
+        }
+
         // Release the request message.
         le_msg_ReleaseMsg(requestMsgRef);
     }
@@ -769,7 +869,24 @@ static void ProcessMessageFromServer
     // receive handler, if there is one.
     else if (sessionPtr->rxHandler != NULL)
     {
-        sessionPtr->rxHandler(msgRef, sessionPtr->rxContextPtr);
+        ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(msgRef);
+
+        if (tracePtr->isActive)
+        {
+            // Hold on to the message while the handler runs, because the handler releases it.
+            le_msg_AddRef(msgRef);
+
+            ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_START);
+            sessionPtr->rxHandler(msgRef, sessionPtr->rxContextPtr);
+            ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_END);
+
+            WriteTrace(sessionPtr, msgRef);
+            le_msg_ReleaseMsg(msgRef);
+        }
+        else
+        {
+            sessionPtr->rxHandler(msgRef, sessionPtr->rxContextPtr);
+        }
     }
     // Discard the message if no handler is registered.
     else
@@ -782,6 +899,40 @@ static void ProcessMessageFromServer
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process a traced message that was received from a client, time-stamping the server's receive
+ * handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessTracedMessageFromClient
+(
+    msgSession_Session_t*   sessionPtr,
+    le_msg_MessageRef_t     msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(msgRef);
+
+    // Hold on to the message while the handler runs, because the handler either responds to it
+    // or releases it.
+    le_msg_AddRef(msgRef);
+
+    ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_START);
+    msgInterface_ProcessMessageFromClient((le_msg_ServiceRef_t)sessionPtr->interfaceRef, msgRef);
+    ipcTrace_Stamp(tracePtr, IPCTRACE_HANDLER_END);
+
+    // If a response is expected but hasn't been sent yet, the record will be written when it is.
+    // (The transaction ID is cleared once the response has been sent.)
+    if (tracePtr->isActive && (msgMessage_GetTxnId(msgRef) == 0))
+    {
+        WriteTrace(sessionPtr, msgRef);
+    }
+
+    le_msg_ReleaseMsg(msgRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process all the messages waiting in the Receive Queue.
@@ -805,8 +956,15 @@ static void ProcessReceivedMessages
         }
         else if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
         {
-            msgInterface_ProcessMessageFromClient((le_msg_ServiceRef_t)sessionPtr->interfaceRef,
-                                                  msgRef);
+            if (msgMessage_GetTraceStatePtr(msgRef)->isActive)
+            {
+                ProcessTracedMessageFromClient(sessionPtr, msgRef);
+            }
+            else
+            {
+                msgInterface_ProcessMessageFromClient((le_msg_ServiceRef_t)sessionPtr->interfaceRef,
+                                                      msgRef);
+            }
         }
     }
 }
@@ -913,21 +1071,25 @@ static void ReceiveMessages
 {
     for (;;)
     {
-        // Create a Message object.
-        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionPtr);
-
-        // Receive from the socket into the Message object.
-        le_result_t result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
+        // Receive from the socket into a new Message object.
+        le_msg_MessageRef_t msgRef;
+        le_result_t result = msgMessage_Receive(sessionPtr->socketFd, sessionPtr, &msgRef);
 
         if (result == LE_OK)
         {
+            metrics_Inc(sessionPtr->interfaceRef->rxCountRef);
+
+            if (IS_IPC_TRACE_ENABLED())
+            {
+                BeginTrace(msgRef, IPCTRACE_RECEIVE);
+            }
+
             // Received something.  Push it onto the Receive Queue for later processing.
             PushReceiveQueue(sessionPtr, msgRef);
         }
         else
         {
             // Nothing left to receive from the socket.  We are done.
-            le_msg_ReleaseMsg(msgRef);
             break;
         }
     }
@@ -1004,11 +1166,17 @@ static void SendFromTransmitQueue
             break;
         }
 
+        // Stamp the message before it is written, so the other side never appears to receive it
+        // before it was sent.  (If the socket is full, the stamp is re-taken on the next try.)
+        ipcTrace_Stamp(msgMessage_GetTraceStatePtr(msgRef), IPCTRACE_SEND);
+
         le_result_t result = msgMessage_Send(sessionPtr->socketFd, msgRef);
 
         switch (result)
         {
             case LE_OK:
+                metrics_Inc(sessionPtr->interfaceRef->txCountRef);
+
                 switch (sessionPtr->interfaceRef->interfaceType)
                 {
                     // If this is the client side of the session,
@@ -1022,6 +1190,11 @@ static void SendFromTransmitQueue
                         // Otherwise, release it.
                         else
                         {
+                            if (msgMessage_GetTraceStatePtr(msgRef)->isActive)
+                            {
+                                WriteTrace(sessionPtr, msgRef);
+                            }
+
                             le_msg_ReleaseMsg(msgRef);
                         }
 
@@ -1029,6 +1202,18 @@ static void SendFromTransmitQueue
 
                     // If this is the server side of the session,
                     case LE_MSG_INTERFACE_SERVER:
+                    {
+                        // If this response is sent from inside the receive handler, the trace
+                        // record is written when the handler returns.
+                        ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(msgRef);
+
+                        if (tracePtr->isActive &&
+                            ((tracePtr->stamps[IPCTRACE_RECEIVE] == 0) ||
+                             (tracePtr->stamps[IPCTRACE_HANDLER_END] != 0)))
+                        {
+                            WriteTrace(sessionPtr, msgRef);
+                        }
+
                         // Release the message, but first clear out the transaction ID so that
                         // the message knows that it is not being deleted without a reponse message
                         // being sent if one was expected.
@@ -1036,6 +1221,7 @@ static void SendFromTransmitQueue
                         le_msg_ReleaseMsg(msgRef);
 
                         break;
+                    }
 
                     default:
                         LE_FATAL("Unhandled interface type (%d)",
@@ -1538,6 +1724,8 @@ void msgSession_Init
 
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("messaging");
+
+    IpcTraceRef = le_log_GetTraceRef(IPCTRACE_KEYWORD);
 }
 
 
@@ -1602,6 +1790,18 @@ void msgSession_SendMessage
     }
     else
     {
+        // A response continues the trace of the request it responds to.
+        ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(messageRef);
+
+        if (tracePtr->isActive)
+        {
+            ipcTrace_Stamp(tracePtr, IPCTRACE_ENQUEUE);
+        }
+        else if (IS_IPC_TRACE_ENABLED())
+        {
+            BeginTrace(messageRef, IPCTRACE_ENQUEUE);
+        }
+
         // Put the message on the Transmit Queue.
         PushTransmitQueue(sessionRef, messageRef);
 
@@ -1636,6 +1836,11 @@ void msgSession_RequestResponse
     // Create an ID for this transaction.
     CreateTxnId(msgRef);
 
+    if (IS_IPC_TRACE_ENABLED())
+    {
+        BeginTrace(msgRef, IPCTRACE_ENQUEUE);
+    }
+
     // Put the message on the Transmit Queue.
     PushTransmitQueue(sessionRef, msgRef);
 
@@ -1667,11 +1872,23 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     // Create an ID for this transaction.
     CreateTxnId(msgRef);
 
+    ipcTrace_MsgState_t* tracePtr = msgMessage_GetTraceStatePtr(msgRef);
+
+    if (IS_IPC_TRACE_ENABLED())
+    {
+        BeginTrace(msgRef, IPCTRACE_ENQUEUE);
+    }
+
     // Put the socket into blocking mode.
     fd_SetBlocking(sessionRef->socketFd);
 
     // Send the Request Message.
-    msgMessage_Send(sessionRef->socketFd, msgRef);
+    ipcTrace_Stamp(tracePtr, IPCTRACE_SEND);
+
+    if (msgMessage_Send(sessionRef->socketFd, msgRef) == LE_OK)
+    {
+        metrics_Inc(sessionRef->interfaceRef->txCountRef);
+    }
 
     // While we have not yet received the response we are waiting for, keep
     // receiving messages.  Any that we receive that don't match the transaction ID
@@ -1679,25 +1896,36 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     // function call.
     for (;;)
     {
-        rxMsgRef = le_msg_CreateMsg(sessionRef);
-
-        le_result_t result = msgMessage_Receive(sessionRef->socketFd, rxMsgRef);
+        le_result_t result = msgMessage_Receive(sessionRef->socketFd, sessionRef, &rxMsgRef);
 
         if (result != LE_OK)
         {
             // The socket experienced an error or the connection was closed.
             // No message was received.
-            le_msg_ReleaseMsg(rxMsgRef);
             rxMsgRef = NULL;
             break;
         }
 
+        metrics_Inc(sessionRef->interfaceRef->rxCountRef);
+
         if (msgMessage_GetTxnId(rxMsgRef) == msgMessage_GetTxnId(msgRef))
         {
-            // Got the synchronous response we were waiting for.
+            // Got the synchronous response we were waiting for.  There is no completion
+            // callback, so the request's trace is complete.
+            if (tracePtr->isActive)
+            {
+                ipcTrace_Stamp(tracePtr, IPCTRACE_RECEIVE);
+                WriteTrace(sessionRef, msgRef);
+            }
+
             break;
         }
 
+        if (IS_IPC_TRACE_ENABLED())
+        {
+            BeginTrace(rxMsgRef, IPCTRACE_RECEIVE);
+        }
+
         // Got some other message that we weren't waiting for.
 
         // If the Receive Queue is empty, queue up a function call on the Event Queue so that
@@ -0,0 +1,382 @@
+//--------------------------------------------------------------------------------------------------
+/** @file metrics.c
+ *
+ * Implementation of the per-process runtime metrics registry.
+ *
+ * The registry is a fixed-size metrics_Segment_t mapped from a file in the process's /tmp (a
+ * tmpfs on all supported targets), so updating a counter is a single atomic operation on
+ * ordinary memory and a reader never has to interrupt the process.  Slots are allocated, but
+ * never freed, so references handed out remain valid for the life of the process.  Registering a
+ * name that already exists returns the existing slot, which lets objects that come and go (e.g.,
+ * IPC interfaces) keep accumulating into the same counter.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "metrics.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The calling process's metrics segment.
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_Segment_t* SegmentPtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scratch slots handed out when the segment is full.  Updates to these are never seen by anyone.
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_Counter_t ScratchCounter;
+static metrics_Histogram_t ScratchHistogram;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex used to serialize slot registration.  Updates to the slots don't need it.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define LOCK    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+#define UNLOCK  LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the shared segment file and map it.
+ *
+ * @return Pointer to the mapped segment, or NULL on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_Segment_t* CreateSharedSegment
+(
+    void
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    snprintf(path, sizeof(path), METRICS_SEGMENT_PATH_FMT, getpid());
+
+    // A file with this name may have been left behind by an earlier process that had the same
+    // PID.  Never follow a symlink that someone else may have planted in /tmp.
+    unlink(path);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_DEBUG("Can't create metrics segment '%s' (%m).", path);
+        return NULL;
+    }
+
+    metrics_Segment_t* segPtr = NULL;
+
+    if (ftruncate(fd, sizeof(metrics_Segment_t)) != 0)
+    {
+        LE_DEBUG("Can't size metrics segment '%s' (%m).", path);
+    }
+    else
+    {
+        segPtr = mmap(NULL, sizeof(metrics_Segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (segPtr == MAP_FAILED)
+        {
+            LE_DEBUG("Can't map metrics segment '%s' (%m).", path);
+            segPtr = NULL;
+        }
+    }
+
+    fd_Close(fd);
+
+    if (segPtr == NULL)
+    {
+        unlink(path);
+    }
+
+    return segPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the segment file when the process exits normally.
+ *
+ * Forked children inherit this handler, so it only acts in the process that created the file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveSegmentFile
+(
+    void
+)
+{
+    if ((SegmentPtr != NULL) && (SegmentPtr->pid == getpid()))
+    {
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        snprintf(path, sizeof(path), METRICS_SEGMENT_PATH_FMT, getpid());
+        unlink(path);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Detach a forked child from its parent's segment.
+ *
+ * The segment is replaced at the same address by a private copy, so references held by other
+ * modules stay valid but the child's updates are no longer attributed to the parent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DetachSegmentInChild
+(
+    void
+)
+{
+    static metrics_Segment_t* copyPtr;
+
+    copyPtr = mmap(NULL, sizeof(metrics_Segment_t), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (copyPtr != MAP_FAILED)
+    {
+        memcpy(copyPtr, SegmentPtr, sizeof(metrics_Segment_t));
+
+        if (mmap(SegmentPtr, sizeof(metrics_Segment_t), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED)
+        {
+            memcpy(SegmentPtr, copyPtr, sizeof(metrics_Segment_t));
+        }
+
+        munmap(copyPtr, sizeof(metrics_Segment_t));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the metrics module and create the calling process's metrics segment.
+ *
+ * Must be called before any other module (including the memory pools) is initialized.  If the
+ * segment can't be created (e.g., no writeable /tmp), the metrics are kept in private memory
+ * instead, and simply can't be seen by the tools.
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_Init
+(
+    void
+)
+{
+    SegmentPtr = CreateSharedSegment();
+
+    if (SegmentPtr == NULL)
+    {
+        SegmentPtr = mmap(NULL, sizeof(metrics_Segment_t), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        LE_FATAL_IF(SegmentPtr == MAP_FAILED, "Can't allocate metrics segment (%m).");
+    }
+    else
+    {
+        atexit(RemoveSegmentFile);
+        pthread_atfork(NULL, NULL, DetachSegmentInChild);
+    }
+
+    // The mapping is zero-filled, so only the header needs to be filled in.
+    SegmentPtr->pid = getpid();
+    SegmentPtr->startTime = metrics_GetTimeUs();
+    le_utf8_Copy(SegmentPtr->procName, program_invocation_short_name,
+                 sizeof(SegmentPtr->procName), NULL);
+    SegmentPtr->version = METRICS_VERSION;
+
+    // Publish the segment last, so readers never see a half-initialized header.
+    __atomic_store_n(&SegmentPtr->magic, METRICS_MAGIC, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a counter by name, creating it if it doesn't exist yet.
+ *
+ * Names longer than LIMIT_MAX_METRIC_NAME_BYTES - 1 are truncated.
+ *
+ * @return Reference to the counter.
+ */
+//--------------------------------------------------------------------------------------------------
+metrics_CounterRef_t metrics_GetCounter
+(
+    metrics_CounterType_t type,     ///< [IN] Kind of counter (only used if it is created).
+    const char* nameFormat,         ///< [IN] printf-style format of the counter name.
+    ...
+)
+{
+    char name[LIMIT_MAX_METRIC_NAME_BYTES];
+    va_list args;
+    metrics_CounterRef_t counterRef = NULL;
+    uint32_t i;
+
+    va_start(args, nameFormat);
+    vsnprintf(name, sizeof(name), nameFormat, args);
+    va_end(args);
+
+    LOCK
+
+    for (i = 0; i < SegmentPtr->numCounters; i++)
+    {
+        if (strcmp(SegmentPtr->counters[i].name, name) == 0)
+        {
+            counterRef = &SegmentPtr->counters[i];
+            break;
+        }
+    }
+
+    if (counterRef == NULL)
+    {
+        if (SegmentPtr->numCounters < METRICS_MAX_COUNTERS)
+        {
+            counterRef = &SegmentPtr->counters[SegmentPtr->numCounters];
+            counterRef->type = type;
+            le_utf8_Copy(counterRef->name, name, sizeof(counterRef->name), NULL);
+            __atomic_store_n(&counterRef->inUse, 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&SegmentPtr->numCounters, SegmentPtr->numCounters + 1,
+                             __ATOMIC_RELEASE);
+        }
+        else
+        {
+            SegmentPtr->numDropped++;
+            counterRef = &ScratchCounter;
+        }
+    }
+
+    UNLOCK
+
+    return counterRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a histogram by name, creating it if it doesn't exist yet.
+ *
+ * @return Reference to the histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+metrics_HistogramRef_t metrics_GetHistogram
+(
+    const char* nameFormat,         ///< [IN] printf-style format of the histogram name.
+    ...
+)
+{
+    char name[LIMIT_MAX_METRIC_NAME_BYTES];
+    va_list args;
+    metrics_HistogramRef_t histRef = NULL;
+    uint32_t i;
+
+    va_start(args, nameFormat);
+    vsnprintf(name, sizeof(name), nameFormat, args);
+    va_end(args);
+
+    LOCK
+
+    for (i = 0; i < SegmentPtr->numHistograms; i++)
+    {
+        if (strcmp(SegmentPtr->histograms[i].name, name) == 0)
+        {
+            histRef = &SegmentPtr->histograms[i];
+            break;
+        }
+    }
+
+    if (histRef == NULL)
+    {
+        if (SegmentPtr->numHistograms < METRICS_MAX_HISTOGRAMS)
+        {
+            histRef = &SegmentPtr->histograms[SegmentPtr->numHistograms];
+            le_utf8_Copy(histRef->name, name, sizeof(histRef->name), NULL);
+            __atomic_store_n(&histRef->inUse, 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&SegmentPtr->numHistograms, SegmentPtr->numHistograms + 1,
+                             __ATOMIC_RELEASE);
+        }
+        else
+        {
+            SegmentPtr->numDropped++;
+            histRef = &ScratchHistogram;
+        }
+    }
+
+    UNLOCK
+
+    return histRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map another process's metrics segment read-only (for use by diagnostic tools).
+ *
+ * @return Pointer to the segment, or NULL if the process has no (valid) segment.  Release it
+ *         with metrics_UnmapSegment().
+ */
+//--------------------------------------------------------------------------------------------------
+const metrics_Segment_t* metrics_MapProcessSegment
+(
+    pid_t pid                       ///< [IN] ID of the process to look at.
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    int len;
+
+    // Go through the process's own root directory, so sandboxed processes are found too.
+    len = snprintf(path, sizeof(path), "/proc/%d/root", pid);
+    snprintf(path + len, sizeof(path) - len, METRICS_SEGMENT_PATH_FMT, pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    metrics_Segment_t* segPtr = NULL;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size == sizeof(metrics_Segment_t)))
+    {
+        segPtr = mmap(NULL, sizeof(metrics_Segment_t), PROT_READ, MAP_SHARED, fd, 0);
+        if (segPtr == MAP_FAILED)
+        {
+            segPtr = NULL;
+        }
+    }
+
+    fd_Close(fd);
+
+    if ((segPtr != NULL) &&
+        ((__atomic_load_n(&segPtr->magic, __ATOMIC_ACQUIRE) != METRICS_MAGIC) ||
+         (segPtr->version != METRICS_VERSION) ||
+         (segPtr->pid != pid)))
+    {
+        munmap(segPtr, sizeof(metrics_Segment_t));
+        segPtr = NULL;
+    }
+
+    return segPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a segment mapped using metrics_MapProcessSegment().
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_UnmapSegment
+(
+    const metrics_Segment_t* segPtr ///< [IN] Segment to unmap.
+)
+{
+    munmap((void*)segPtr, sizeof(metrics_Segment_t));
+}
@@ -0,0 +1,353 @@
+//--------------------------------------------------------------------------------------------------
+/** @file metrics.h
+ *
+ * Legato runtime metrics inter-module include file.
+ *
+ * Each Legato process owns a small shared-memory segment containing named counters and
+ * histograms.  The framework updates these using lock-free atomic operations (registration is
+ * the only operation that takes a lock), and diagnostic tools map the segment read-only to
+ * report on the process without stopping it or chasing its internal data structures.
+ *
+ * The segment is a file at METRICS_SEGMENT_PATH_FMT inside the process's own /tmp, so that it
+ * works the same way for sandboxed and unsandboxed processes.  Tools running outside a sandbox
+ * reach it through /proc/<pid>/root (see metrics_MapProcessSegment()).
+ *
+ * This file exposes interfaces that are for use by other modules inside the framework
+ * implementation, but must not be used outside of the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SRC_METRICS_INCLUDE_GUARD
+#define LEGATO_SRC_METRICS_INCLUDE_GUARD
+
+#include "limit.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path (printf format taking the process ID) of a process's metrics segment, as seen from inside
+ * that process.
+ */
+//--------------------------------------------------------------------------------------------------
+#define METRICS_SEGMENT_PATH_FMT        "/tmp/legato-metrics.%d"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number and layout version stored at the start of every metrics segment.
+ *
+ * @note The version must be incremented whenever the layout of metrics_Segment_t changes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define METRICS_MAGIC                   0x4c4d4554
+#define METRICS_VERSION                 2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of counter and histogram slots in a metrics segment.  There are enough histogram slots
+ * for one per event handler in a typical process while the event profiler is enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+#define METRICS_MAX_COUNTERS            512
+#define METRICS_MAX_HISTOGRAMS          256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of buckets in a histogram.  Bucket i counts samples in [2^(i-1), 2^i) microseconds
+ * (bucket 0 counts samples under 1 us).  The last bucket also counts everything larger.
+ */
+//--------------------------------------------------------------------------------------------------
+#define METRICS_HISTOGRAM_BUCKETS       24
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of counter.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    METRICS_COUNTER,        ///< Monotonically increasing count.
+    METRICS_GAUGE           ///< Current level, with the highest level ever seen kept in "max".
+}
+metrics_CounterType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counter slot.
+ *
+ * A slot is published (inUse set to 1 with release semantics) only after its name has been
+ * written, so readers that see inUse == 1 (with acquire semantics) can trust the name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    inUse;                              ///< 1 once the slot has been published.
+    uint32_t    type;                               ///< metrics_CounterType_t.
+    char        name[LIMIT_MAX_METRIC_NAME_BYTES];  ///< Name of the counter.
+    uint64_t    value;                              ///< Count or current level.
+    uint64_t    max;                                ///< High-water mark (gauges only).
+}
+metrics_Counter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Histogram slot.  Samples are durations in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t    inUse;                              ///< 1 once the slot has been published.
+    uint32_t    reserved;                           ///< Padding (keeps the counts aligned).
+    char        name[LIMIT_MAX_METRIC_NAME_BYTES];  ///< Name of the histogram.
+    uint64_t    count;                              ///< Number of samples recorded.
+    uint64_t    sum;                                ///< Sum of all samples (us).
+    uint64_t    max;                                ///< Largest sample seen (us).
+    uint64_t    buckets[METRICS_HISTOGRAM_BUCKETS]; ///< Sample counts per power-of-two bucket.
+}
+metrics_Histogram_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of a process's metrics segment.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t            magic;                      ///< METRICS_MAGIC.
+    uint32_t            version;                    ///< METRICS_VERSION.
+    int32_t             pid;                        ///< ID of the process that owns the segment.
+    uint32_t            numCounters;                ///< Number of counter slots allocated.
+    uint32_t            numHistograms;              ///< Number of histogram slots allocated.
+    uint32_t            numDropped;                 ///< Registrations refused (segment full).
+    uint64_t            startTime;                  ///< Time the segment was created (us since
+                                                    ///  boot, CLOCK_MONOTONIC).
+    char                procName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Name of the process.
+    metrics_Counter_t   counters[METRICS_MAX_COUNTERS];
+    metrics_Histogram_t histograms[METRICS_MAX_HISTOGRAMS];
+}
+metrics_Segment_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * References to counters and histograms.  These are never NULL: when a segment is full, a
+ * private scratch slot is handed out instead, so callers never have to check.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef metrics_Counter_t* metrics_CounterRef_t;
+typedef metrics_Histogram_t* metrics_HistogramRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the metrics module and create the calling process's metrics segment.
+ *
+ * Must be called before any other module (including the memory pools) is initialized.  If the
+ * segment can't be created (e.g., no writeable /tmp), the metrics are kept in private memory
+ * instead, and simply can't be seen by the tools.
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a counter by name, creating it if it doesn't exist yet.
+ *
+ * Names longer than LIMIT_MAX_METRIC_NAME_BYTES - 1 are truncated.
+ *
+ * @return Reference to the counter.
+ */
+//--------------------------------------------------------------------------------------------------
+metrics_CounterRef_t metrics_GetCounter
+(
+    metrics_CounterType_t type,     ///< [IN] Kind of counter (only used if it is created).
+    const char* nameFormat,         ///< [IN] printf-style format of the counter name.
+    ...
+)
+__attribute__ ((format (printf, 2, 3)));
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a histogram by name, creating it if it doesn't exist yet.
+ *
+ * @return Reference to the histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+metrics_HistogramRef_t metrics_GetHistogram
+(
+    const char* nameFormat,         ///< [IN] printf-style format of the histogram name.
+    ...
+)
+__attribute__ ((format (printf, 1, 2)));
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map another process's metrics segment read-only (for use by diagnostic tools).
+ *
+ * @return Pointer to the segment, or NULL if the process has no (valid) segment.  Release it
+ *         with metrics_UnmapSegment().
+ */
+//--------------------------------------------------------------------------------------------------
+const metrics_Segment_t* metrics_MapProcessSegment
+(
+    pid_t pid                       ///< [IN] ID of the process to look at.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a segment mapped using metrics_MapProcessSegment().
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_UnmapSegment
+(
+    const metrics_Segment_t* segPtr ///< [IN] Segment to unmap.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in microseconds from CLOCK_MONOTONIC.  Used to time the samples that are
+ * recorded in histograms.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t metrics_GetTimeUs
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Raise a high-water mark to a given value if the value is higher.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_RaiseMax
+(
+    uint64_t* maxPtr,               ///< [IN] High-water mark.
+    uint64_t value                  ///< [IN] New value.
+)
+{
+    uint64_t oldMax = __atomic_load_n(maxPtr, __ATOMIC_RELAXED);
+
+    while ((value > oldMax) &&
+           !__atomic_compare_exchange_n(maxPtr, &oldMax, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // oldMax has been refreshed by the failed exchange; try again.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to a counter or gauge.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_Add
+(
+    metrics_CounterRef_t counterRef,    ///< [IN] Counter.
+    uint64_t amount                     ///< [IN] Amount to add.
+)
+{
+    uint64_t value = __atomic_add_fetch(&counterRef->value, amount, __ATOMIC_RELAXED);
+
+    if (counterRef->type == METRICS_GAUGE)
+    {
+        metrics_RaiseMax(&counterRef->max, value);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Increment a counter or gauge by one.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_Inc
+(
+    metrics_CounterRef_t counterRef     ///< [IN] Counter.
+)
+{
+    metrics_Add(counterRef, 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decrement a gauge by one.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_Dec
+(
+    metrics_CounterRef_t counterRef     ///< [IN] Gauge.
+)
+{
+    __atomic_sub_fetch(&counterRef->value, 1, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the level of a gauge.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_Set
+(
+    metrics_CounterRef_t counterRef,    ///< [IN] Gauge.
+    uint64_t value                      ///< [IN] New level.
+)
+{
+    __atomic_store_n(&counterRef->value, value, __ATOMIC_RELAXED);
+    metrics_RaiseMax(&counterRef->max, value);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a duration sample in a histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void metrics_Record
+(
+    metrics_HistogramRef_t histRef,     ///< [IN] Histogram.
+    uint64_t durationUs                 ///< [IN] Sample (us).
+)
+{
+    // Bucket index is the number of significant bits in the duration.
+    unsigned int bucket = (durationUs == 0) ? 0 : 64 - __builtin_clzll(durationUs);
+
+    if (bucket >= METRICS_HISTOGRAM_BUCKETS)
+    {
+        bucket = METRICS_HISTOGRAM_BUCKETS - 1;
+    }
+
+    __atomic_add_fetch(&histRef->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histRef->sum, durationUs, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histRef->count, 1, __ATOMIC_RELAXED);
+    metrics_RaiseMax(&histRef->max, durationUs);
+}
+
+
+#endif  // LEGATO_SRC_METRICS_INCLUDE_GUARD
@@ -10,6 +10,7 @@
 #include "clock.h"
 #include "timer.h"
 #include "thread.h"
+#include "eventLoop.h"
 #include "fileDescriptor.h"
 #include <sys/timerfd.h>
 #include "fileDescriptor.h"
@@ -74,6 +75,17 @@ static le_log_TraceRef_t TraceRef;
 /// Macro used to query current trace state in this module
 #define IS_TRACE_ENABLED LE_IS_TRACE_ENABLED(TraceRef)
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace reference used to turn the event profiler on and off.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_log_TraceRef_t ProfileTraceRef;
+
+/// Macro used to check whether the event profiler is on.
+#define IS_PROFILING_ENABLED() LE_IS_TRACE_ENABLED(ProfileTraceRef)
+
 /// Workaround to CLOCK_BOOTTIME & CLOCK_BOOTTIME_ALARM not being defined on older
 /// versions of the glibc.
 /// Values are extracted from <linux/time.h> and are provided by <time.h> in more recent glibc.
@@ -126,6 +138,7 @@ static Timer_t* CreateTimer
     timerPtr->safeRef = NULL;
     timerPtr->safeRef = le_ref_CreateRef(SafeRefMap, timerPtr);
     timerPtr->isWakeupEnabled = true;
+    timerPtr->profileRef = NULL;
 
     return timerPtr;
 }
@@ -405,6 +418,31 @@ static void StopTimerFD
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call a timer's expiry handler and record its execution time in the event profiler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallExpiryHandlerProfiled
+(
+    Timer_t* expiredTimer
+)
+{
+    // Only the timer's own thread gets here, so the profile can be created without locking.
+    if (expiredTimer->profileRef == NULL)
+    {
+        expiredTimer->profileRef = metrics_GetHistogram("handler.timer.%s", expiredTimer->name);
+    }
+
+    // The handler may delete the timer, so don't look at it once the handler is called.
+    metrics_HistogramRef_t profileRef = expiredTimer->profileRef;
+
+    uint64_t startTime = metrics_GetTimeUs();
+    expiredTimer->handlerRef(expiredTimer->safeRef);
+    metrics_Record(profileRef, metrics_GetTimeUs() - startTime);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process a single expired timer
@@ -445,7 +483,14 @@ static void ProcessExpiredTimer
     // call the optional expiry handler function
     if ( expiredTimer->handlerRef != NULL )
     {
-        expiredTimer->handlerRef(expiredTimer->safeRef);
+        if ( IS_PROFILING_ENABLED() )
+        {
+            CallExpiryHandlerProfiled(expiredTimer);
+        }
+        else
+        {
+            expiredTimer->handlerRef(expiredTimer->safeRef);
+        }
     }
 }
 
@@ -613,6 +658,9 @@ void timer_Init
 
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("timers");
+
+    // Get a reference to the trace keyword that turns the event profiler on and off.
+    ProfileTraceRef = le_log_GetTraceRef(EVENT_PROFILE_KEYWORD);
 }
 
 
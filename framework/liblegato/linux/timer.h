@@ -11,6 +11,7 @@
 #define LEGATO_SRC_TIMER_H_INCLUDE_GUARD
 
 #include "limit.h"
+#include "metrics.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -48,6 +49,8 @@ typedef struct
     le_timer_Ref_t safeRef;                  ///< For the API user to refer to this timer by
     bool isWakeupEnabled;                    ///< Will system be woken up from suspended timer.
                                              ///  Default behaviour will be set to true.
+    metrics_HistogramRef_t profileRef;       ///< Expiry handler execution time histogram
+                                             ///  (NULL until first profiled).
 }
 Timer_t;
 
@@ -518,6 +518,31 @@ le_result_t unixSocket_ReceiveDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks at the next message waiting to be received through a connected Unix domain datagram or
+ * sequenced-packet socket, without removing it from the socket, and gets its size.
+ *
+ * @return
+ * - LE_OK if successful
+ * - LE_WOULD_BLOCK if the socket is set non-blocking and there is nothing to be received.
+ * - LE_CLOSED if the connection closed.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ *
+ * @note A message of size zero may also mean that the connection closed.  The following receive
+ *       will tell.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_PeekMsg
+(
+    int localSocketFd,      ///< [IN] fd of local socket that the message will be received from.
+    void* dataBuffPtr,      ///< [OUT] Pointer to where the start of the data payload will be put.
+    size_t* dataSizePtr     ///< [IN+OUT] Ptr to the number of bytes that can fit in the array
+                            ///     pointed to by dataBuffPtr.  This will be updated to the full
+                            ///     size of the message's data payload (which may be larger).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
@@ -16,6 +16,104 @@
 #define IS_THREE_BYTE_CHAR(leadByte)            ( (leadByte & 0xF0) == 0xE0 )
 #define IS_FOUR_BYTE_CHAR(leadByte)             ( (leadByte & 0xF8) == 0xF0 )
 
+// Word used to check several bytes at once, and the constants used to check all its bytes.
+typedef uint64_t __attribute__((__may_alias__)) Word_t;
+#define WORD_BYTES                              sizeof(Word_t)
+#define WORD_ONES                               ((Word_t)0x0101010101010101ULL)
+#define WORD_HIGH_BITS                          (WORD_ONES * 0x80)
+
+// Checks if any byte of a word is a null-character or not an ASCII character.  A byte that is 0
+// gets its high bit set by the subtraction (bytes below it are non-zero, so don't borrow from it).
+#define HAS_NULL_OR_NON_ASCII(word)             \
+    ( ((((word) - WORD_ONES) | (word)) & WORD_HIGH_BITS) != 0 )
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts the ASCII characters at the start of a null-terminated string, a word at a time.
+ *
+ * The count stops at the first word that holds a null-character or a non-ASCII byte, so it may be
+ * less than the actual number of leading ASCII characters.  It is never more than maxBytes.
+ *
+ * Words are read at aligned addresses only, so the word that holds the null-terminator may be read
+ * beyond the end of the string but never crosses a page boundary (this is why the address
+ * sanitizer must not check this function).
+ *
+ * @return
+ *      Number of leading ASCII characters counted.
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((no_sanitize_address))
+static size_t CountAscii
+(
+    const char* string,     ///< [IN] The string.
+    size_t maxBytes         ///< [IN] Maximum number of characters to count.
+)
+{
+    size_t count = 0;
+
+    // Check one byte at a time up to a word boundary.
+    for (; (((uintptr_t)&string[count]) % WORD_BYTES) != 0; count++)
+    {
+        if ((count >= maxBytes) || (string[count] == '\0') || !IS_SINGLE_BYTE_CHAR(string[count]))
+        {
+            return (count < maxBytes) ? count : maxBytes;
+        }
+    }
+
+    while ((count < maxBytes) && !HAS_NULL_OR_NON_ASCII(*(const Word_t*)&string[count]))
+    {
+        count += WORD_BYTES;
+    }
+
+    return (count < maxBytes) ? count : maxBytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the ASCII characters at the start of a null-terminated string, a word at a time, like
+ * CountAscii() counts them.  The null-terminator is not copied.
+ *
+ * @return
+ *      Number of leading ASCII characters copied (never more than maxBytes).
+ */
+//--------------------------------------------------------------------------------------------------
+__attribute__((no_sanitize_address))
+static size_t CopyAscii
+(
+    char* destStr,          ///< [OUT] Destination.
+    const char* srcStr,     ///< [IN] The string.
+    size_t maxBytes         ///< [IN] Maximum number of characters to copy.
+)
+{
+    size_t count = 0;
+
+    // Copy one byte at a time up to a word boundary.
+    for (; (((uintptr_t)&srcStr[count]) % WORD_BYTES) != 0; count++)
+    {
+        if ((count >= maxBytes) || (srcStr[count] == '\0') || !IS_SINGLE_BYTE_CHAR(srcStr[count]))
+        {
+            return count;
+        }
+        destStr[count] = srcStr[count];
+    }
+
+    while ((maxBytes - count) >= WORD_BYTES)
+    {
+        Word_t word = *(const Word_t*)&srcStr[count];
+
+        if (HAS_NULL_OR_NON_ASCII(word))
+        {
+            break;
+        }
+
+        memcpy(&destStr[count], &word, WORD_BYTES);
+        count += WORD_BYTES;
+    }
+
+    return count;
+}
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -54,6 +152,14 @@ ssize_t le_utf8_NumChars
             return LE_FORMAT_ERROR;
         }
 
+        if (numBytes == 1)
+        {
+            // Skip the ASCII characters that follow a word at a time.
+            size_t asciiCount = CountAscii(&string[strIndex + 1], SIZE_MAX);
+            strIndex += asciiCount;
+            numChars += asciiCount;
+        }
+
         // Go through the bytes in this character to make sure all bytes are formatted correctly.
         for (i = 1; i < numBytes; i++)
         {
@@ -217,6 +323,14 @@ le_result_t le_utf8_Copy
 
                 return LE_OVERFLOW;
             }
+            else if (charLength == 1)
+            {
+                // Copy this character and the ASCII characters that follow a word at a time,
+                // leaving room for the null-terminator (ASCII characters are whole bytes).
+                destStr[i] = srcStr[i];
+                i++;
+                i += CopyAscii(&destStr[i], &srcStr[i], destSize - 1 - i);
+            }
             else
             {
                 // Copy the character.
@@ -421,6 +535,12 @@ bool le_utf8_IsFormatCorrect
             return false;
         }
 
+        if (numBytes == 1)
+        {
+            // Skip the ASCII characters that follow a word at a time.
+            strIndex += CountAscii(&string[strIndex + 1], SIZE_MAX);
+        }
+
         // Go through the bytes in this character to make sure all bytes are formatted correctly.
         for (i = 1; i < numBytes; i++)
         {
@@ -438,6 +558,97 @@ bool le_utf8_IsFormatCorrect
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that a buffer holds a correctly formatted UTF-8 string, without any null-character, and
+ * copies it to a destination buffer, adding a null-terminator.
+ *
+ * The source is only read once, a word at a time as long as it holds ASCII characters, so this is
+ * faster than checking the string's format, then copying it.
+ *
+ * If the source is not correctly formatted, or doesn't fit in the destination buffer, the
+ * destination is set to an empty string.
+ *
+ * If destStr and srcPtr overlap the behaviour of this function is undefined.
+ *
+ * @return
+ *      - LE_OK if the string was checked and copied.
+ *      - LE_FORMAT_ERROR if the source is not a correctly formatted UTF-8 string, or holds a
+ *        null-character.
+ *      - LE_OVERFLOW if the string and its null-terminator don't fit in the destination buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_utf8_ValidateAndCopy
+(
+    char* destStr,          ///< [OUT] Destination where the string is to be copied.
+    const char* srcPtr,     ///< [IN] Source string (not null-terminated).
+    size_t srcSize,         ///< [IN] Number of bytes in the source string.
+    size_t destSize         ///< [IN] Size of the destination buffer in bytes.
+)
+{
+    // Check parameters.
+    LE_ASSERT( (destStr != NULL) && ((srcPtr != NULL) || (srcSize == 0)) && (destSize > 0) );
+
+    if (srcSize >= destSize)
+    {
+        destStr[0] = '\0';
+        return LE_OVERFLOW;
+    }
+
+    size_t i = 0;
+    while (i < srcSize)
+    {
+        // Copy ASCII characters a word at a time.
+        while ((srcSize - i) >= WORD_BYTES)
+        {
+            Word_t word;
+
+            memcpy(&word, &srcPtr[i], WORD_BYTES);
+            if (HAS_NULL_OR_NON_ASCII(word))
+            {
+                break;
+            }
+
+            memcpy(&destStr[i], &word, WORD_BYTES);
+            i += WORD_BYTES;
+        }
+
+        if (i == srcSize)
+        {
+            break;
+        }
+
+        // Check and copy one character.
+        size_t charLength = le_utf8_NumBytesInChar(srcPtr[i]);
+        size_t j;
+
+        if ((charLength == 0) || (srcPtr[i] == '\0') || (charLength > (srcSize - i)))
+        {
+            destStr[0] = '\0';
+            return LE_FORMAT_ERROR;
+        }
+
+        destStr[i] = srcPtr[i];
+        for (j = 1; j < charLength; j++)
+        {
+            if (!le_utf8_IsContinuationByte(srcPtr[i + j]))
+            {
+                destStr[0] = '\0';
+                return LE_FORMAT_ERROR;
+            }
+
+            destStr[i + j] = srcPtr[i + j];
+        }
+
+        i += charLength;
+    }
+
+    destStr[srcSize] = '\0';
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parse an integer value from a string.
@@ -322,6 +322,20 @@ class Function(object):
 
         self.comment = ""
 
+    def getMessageSize(self):
+        """
+        Get size of largest possible message that uses this function's message ID: a request or
+        response for this function, or an event for the handler passed to it (if any).
+
+        Messages are laid out as described in Interface.getMessageSize().
+        """
+        return 8 + max([sum([self.returnType.size if self.returnType else 0] +
+                            [parameter.GetMaxSize() for parameter in self.parameters])] +
+                       [sum([handlerParameter.GetMaxSize()
+                             for handlerParameter in parameter.apiType.parameters])
+                        for parameter in self.parameters
+                        if isinstance(parameter.apiType, HandlerType)])
+
     def __str__(self):
         if self.returnType == None:
             return "FUNCTION %s(%s)" \
@@ -12,6 +12,12 @@ def AddLangArgumentGroup(parser):
                         action='store_true',
                         default=False,
                         help='generate asynchronous-style server functions')
+    parser.add_argument('--pack-per-value',
+                        dest="packPerValue",
+                        action='store_true',
+                        default=False,
+                        help='pack every value with its own le_pack call, instead of packing'
+                             ' fixed-size values at fixed offsets (to compare the two)')
 
 # Custom filters needed for C templates
 Filters = { 'EscapeString':        codeGenHelpers.EscapeString,
@@ -25,10 +31,15 @@ Filters = { 'EscapeString':        codeGenHelpers.EscapeString,
             'GetParameterCountPtr': codeGenHelpers.GetParameterCountPtr,
             'PackFunction':        codeGenHelpers.GetPackFunction,
             'UnpackFunction':      codeGenHelpers.GetUnpackFunction,
-            'CAPIParameters':      codeGenHelpers.IterCAPIParameters }
+            'PutFunction':         codeGenHelpers.GetPutFunction,
+            'GetFunction':         codeGenHelpers.GetGetFunction,
+            'CAPIParameters':      codeGenHelpers.IterCAPIParameters,
+            'GroupInputParameters': codeGenHelpers.GroupInputParameters }
 
 
-Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter }
+Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter,
+          'FixedRun':              codeGenHelpers.IsFixedRun,
+          'PodType':               codeGenHelpers.IsPodType }
 
 Globals = { 'Labeler':             codeGenHelpers.Labeler }
 
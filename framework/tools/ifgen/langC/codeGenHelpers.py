@@ -193,6 +193,18 @@ def GetUnpackFunction(apiType):
     else:
         return _PackFunctionMapping[apiType] % ("Unpack", )
 
+def GetPutFunction(apiType):
+    """
+    Get the function which stores a value of a fixed-size type at a given offset in a buffer.
+    """
+    return GetPackFunction(apiType).replace("le_pack_Pack", "le_pack_Put")
+
+def GetGetFunction(apiType):
+    """
+    Get the function which loads a value of a fixed-size type from a given offset in a buffer.
+    """
+    return GetUnpackFunction(apiType).replace("le_pack_Unpack", "le_pack_Get")
+
 def EscapeString(string):
     return string.encode('string_escape').replace('"', '\\"')
 
@@ -202,6 +214,32 @@ def EscapeString(string):
 def IsSizeParameter(parameter):
     return isinstance(parameter, SizeParameter)
 
+# Types which are packed as plain bytes in host order, so arrays of them can be copied in one go.
+_PodTypes = frozenset([ interfaceIR.UINT8_TYPE,
+                        interfaceIR.UINT16_TYPE,
+                        interfaceIR.UINT32_TYPE,
+                        interfaceIR.UINT64_TYPE,
+                        interfaceIR.INT8_TYPE,
+                        interfaceIR.INT16_TYPE,
+                        interfaceIR.INT32_TYPE,
+                        interfaceIR.INT64_TYPE,
+                        interfaceIR.CHAR_TYPE,
+                        interfaceIR.DOUBLE_TYPE ])
+
+def IsPodType(apiType):
+    return apiType in _PodTypes
+
+def IsFixedSizeType(apiType):
+    """
+    Is this a type whose packed size is always the same (so it can be stored at a fixed offset)?
+    """
+    if isinstance(apiType, interfaceIR.ReferenceType) or \
+       isinstance(apiType, interfaceIR.BitmaskType) or \
+       isinstance(apiType, interfaceIR.EnumType):
+        return True
+    else:
+        return (apiType in _PackFunctionMapping) and (apiType != interfaceIR.STRING_TYPE)
+
 #---------------------------------------------------------------------------------------------------
 # Global functions
 #---------------------------------------------------------------------------------------------------
@@ -249,6 +287,51 @@ def IterCAPIParameters(function):
     if isinstance(function, interfaceIR.HandlerType):
         yield interfaceIR.Parameter(_CONTEXT_TYPE, 'contextPtr')
 
+class FixedRun(object):
+    """
+    A run of consecutive fixed-size input parameters, which are packed at known offsets after a
+    single check of the buffer size.  Each entry of fields is a (parameter, offset) tuple.
+    """
+    def __init__(self):
+        self.fields = []
+        self.size = 0
+
+    def add(self, parameter):
+        self.fields.append((parameter, self.size))
+        self.size += parameter.apiType.size
+
+def GroupInputParameters(parameterList, groupFixed=True):
+    """
+    Given a list of parameters, yield the parameters that are packed as inputs (in the same order
+    as they are packed), but with consecutive fixed-size input parameters grouped in FixedRun
+    objects (unless groupFixed is False).  Other parameters are yielded unmodified.
+    """
+    run = None
+    for parameter in parameterList:
+        if not (parameter.direction & interfaceIR.DIR_IN or
+                isinstance(parameter, interfaceIR.StringParameter) or
+                isinstance(parameter, interfaceIR.ArrayParameter)):
+            continue
+
+        if (groupFixed and
+            (parameter.direction & interfaceIR.DIR_IN) and
+            type(parameter) is interfaceIR.Parameter and
+            IsFixedSizeType(parameter.apiType)):
+            if run is None:
+                run = FixedRun()
+            run.add(parameter)
+        else:
+            if run is not None:
+                yield run
+                run = None
+            yield parameter
+
+    if run is not None:
+        yield run
+
+def IsFixedRun(item):
+    return isinstance(item, FixedRun)
+
 class Labeler(object):
     def __init__(self, label):
         self.label = label
@@ -7,7 +7,7 @@
  #
  #  Copyright (C) Sierra Wireless Inc.
  #}
-{%- import 'pack.templ' as pack -%}
+{%- import 'pack.templ' as pack with context -%}
 /*
  * ====================== WARNING ======================
  *
@@ -199,6 +199,7 @@ static le_result_t InitClientForThread
     le_msg_SessionRef_t sessionRef;
 
     protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
+    le_msg_SetProtocolMsgSizes(protocolRef, _MsgSizes, NUM_ARRAY_MEMBERS(_MsgSizes));
     sessionRef = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
     le_msg_SetSessionRecvHandler(sessionRef, ClientIndicationRecvHandler, NULL);
 
@@ -573,11 +574,11 @@ static void _Handle_{{apiName}}_{{function.name}}
     le_msg_MessageRef_t _msgRef = _reportPtr;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     uint8_t* _msgBufPtr = _msgPtr->buffer;
-    size_t _msgBufSize = _MAX_MSG_SIZE;
+    size_t _msgBufSize = le_msg_GetMaxPayloadSize(_msgRef) - sizeof(_msgPtr->id);
 
     // The clientContextPtr always exists and is always first. It is a safe reference to the client
     // data object, but we already get the pointer to the client data object through the _dataPtr
-    // parameter, so we don't need to do anything with clientContextPtr, other than unpacking it.
+    // parameter, so we only need clientContextPtr to delete the safe reference once it is used up.
     void* _clientContextPtr;
     if (!le_pack_UnpackReference( &_msgBufPtr, &_msgBufSize,
                                   &_clientContextPtr ))
@@ -613,9 +614,13 @@ static void _Handle_{{apiName}}_{{function.name}}
     }
     {%- if function is not EventFunction %}
 
-    // The registered handler has been called, so no longer need the client data.
+    // The registered handler has been called, so no longer need the client data, nor the safe
+    // reference to it (otherwise the safe reference map grows with every call).
     // Explicitly set handlerPtr to NULL, so that we can catch if this function gets
     // accidently called again.
+    _LOCK
+    le_ref_DeleteRef(_HandlerRefMap, _clientContextPtr);
+    _UNLOCK
     _clientDataPtr->handlerPtr = NULL;
     le_mem_Release(_clientDataPtr);
     {% endif %}
@@ -687,12 +692,12 @@ error_unpack:
     {%- endfor %}
 
 
-    // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    // Create a new message object (just big enough for this function) and get the message buffer
+    _msgRef = le_msg_CreateSizedMsg(GetCurrentSessionRef(), _MSGSIZE_{{apiName}}_{{function.name}});
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_{{apiName}}_{{function.name}};
     _msgBufPtr = _msgPtr->buffer;
-    _msgBufSize = _MAX_MSG_SIZE;
+    _msgBufSize = le_msg_GetMaxPayloadSize(_msgRef) - sizeof(_msgPtr->id);
 
     // Pack a list of outputs requested by the client.
     {%- if any(function.parameters, "OutParameter") %}
@@ -727,6 +732,8 @@ error_unpack:
     TRACE("Sending message to server and waiting for response : %ti bytes sent",
           _msgBufPtr-_msgPtr->buffer);
 
+    // Only send the part of the buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
     _responseMsgRef = le_msg_RequestSyncResponse(_msgRef);
     // It is a serious error if we don't get a valid response from the server.  Call disconnect
     // handler (if one is defined) to allow cleanup
@@ -738,7 +745,7 @@ error_unpack:
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
-    _msgBufSize = _MAX_MSG_SIZE;
+    _msgBufSize = le_msg_GetMaxPayloadSize(_responseMsgRef) - sizeof(_msgPtr->id);
     {%- if function.returnType %}
 
     // Unpack the result first
@@ -799,7 +806,7 @@ static void ClientIndicationRecvHandler
     // Get the message payload
     _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
     uint8_t* _msgBufPtr = msgPtr->buffer;
-    size_t _msgBufSize = _MAX_MSG_SIZE;
+    size_t _msgBufSize = le_msg_GetMaxPayloadSize(msgRef) - sizeof(msgPtr->id);
 
     // Have to partially unpack the received message in order to know which thread
     // the queued function should actually go to.
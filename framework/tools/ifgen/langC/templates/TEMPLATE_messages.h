@@ -46,5 +46,20 @@ _Message_t;
 #define _MSGID_{{apiName}}_{{function.name}} {{loop.index0}}
 {%- endfor %}
 
+// Size of the largest message (request, response or event) for each message ID, counted the
+// same way as sizeof(_Message_t).
+{%- for function in functions %}
+#define _MSGSIZE_{{apiName}}_{{function.name}} (sizeof(uint32_t) + {{function.getMessageSize()}})
+{%- endfor %}
+
+__attribute__((unused)) static const size_t _MsgSizes[] =
+{
+{%- for function in functions %}
+    _MSGSIZE_{{apiName}}_{{function.name}},
+{%- else %}
+    sizeof(_Message_t),
+{%- endfor %}
+};
+
 
 #endif // {{apiName|upper}}_MESSAGES_H_INCLUDE_GUARD
@@ -7,7 +7,7 @@
  #
  #  Copyright (C) Sierra Wireless Inc.
  #}
-{% import 'pack.templ' as pack -%}
+{% import 'pack.templ' as pack with context -%}
 /*
  * ====================== WARNING ======================
  *
@@ -340,6 +340,7 @@ void {{apiName}}_AdvertiseService
 
     // Start the server side of the service
     protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
+    le_msg_SetProtocolMsgSizes(protocolRef, _MsgSizes, NUM_ARRAY_MEMBERS(_MsgSizes));
     _ServerServiceRef = le_msg_CreateService(protocolRef, SERVICE_INSTANCE_NAME);
     le_msg_SetServiceRecvHandler(_ServerServiceRef, ServerMsgRecvHandler, NULL);
     le_msg_AdvertiseService(_ServerServiceRef);
@@ -385,12 +386,13 @@ static void AsyncResponse_{{apiName}}_{{function.name}}
     __attribute__((unused)) uint8_t* _msgBufPtr;
     __attribute__((unused)) size_t _msgBufSize;
 
-    // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(serverDataPtr->clientSessionRef);
+    // Create a new message object (just big enough for this event) and get the message buffer
+    _msgRef = le_msg_CreateSizedMsg(serverDataPtr->clientSessionRef,
+                                    _MSGSIZE_{{apiName}}_{{function.name}});
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_{{apiName}}_{{function.name}};
     _msgBufPtr = _msgPtr->buffer;
-    _msgBufSize = _MAX_MSG_SIZE;
+    _msgBufSize = le_msg_GetMaxPayloadSize(_msgRef) - sizeof(_msgPtr->id);
 
     // Always pack the client context pointer first
     LE_ASSERT(le_pack_PackReference( &_msgBufPtr, &_msgBufSize, serverDataPtr->contextPtr ))
@@ -403,6 +405,8 @@ static void AsyncResponse_{{apiName}}_{{function.name}}
           serverDataPtr->clientSessionRef,
           _msgBufPtr-_msgPtr->buffer);
 
+    // Only send the part of the buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
     SendMsgToClient(_msgRef);
 
     {%- if function is not AddHandlerFunction %}
@@ -439,7 +443,8 @@ void {{apiName}}_{{function.name}}Respond
     le_msg_MessageRef_t _msgRef = _cmdRef->msgRef;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
-    __attribute__((unused)) size_t _msgBufSize = _MAX_MSG_SIZE;
+    __attribute__((unused)) size_t _msgBufSize = le_msg_GetMaxPayloadSize(_msgRef) -
+                                                 sizeof(_msgPtr->id);
 
     // Ensure the passed in msgRef is for the correct message
     LE_ASSERT(_msgPtr->id == _MSGID_{{apiName}}_{{function.name}});
@@ -475,6 +480,8 @@ void {{apiName}}_{{function.name}}Respond
     // Return the response
     TRACE("Sending response to client session %p", le_msg_GetSession(_msgRef));
 
+    // Only send the part of the buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
     le_msg_Respond(_msgRef);
 
     // Release the command
@@ -495,7 +502,8 @@ static void Handle_{{apiName}}_{{function.name}}
     // Get the message buffer pointer
     __attribute__((unused)) uint8_t* _msgBufPtr =
         ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
-    __attribute__((unused)) size_t _msgBufSize = _MAX_MSG_SIZE;
+    __attribute__((unused)) size_t _msgBufSize =
+        le_msg_GetMaxPayloadSize(_msgRef) - sizeof(((_Message_t*)NULL)->id);
 
     // Unpack which outputs are needed.
     _serverCmdPtr->requiredOutputs = 0;
@@ -543,7 +551,8 @@ static void Handle_{{apiName}}_{{function.name}}
     // Get the message buffer pointer
     __attribute__((unused)) uint8_t* _msgBufPtr =
         ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
-    __attribute__((unused)) size_t _msgBufSize = _MAX_MSG_SIZE;
+    __attribute__((unused)) size_t _msgBufSize =
+        le_msg_GetMaxPayloadSize(_msgRef) - sizeof(((_Message_t*)NULL)->id);
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
@@ -667,7 +676,7 @@ static void Handle_{{apiName}}_{{function.name}}
 
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
-    _msgBufSize = _MAX_MSG_SIZE;
+    _msgBufSize = le_msg_GetMaxPayloadSize(_msgRef) - sizeof(((_Message_t*)NULL)->id);
     {%- if function.returnType %}
 
     // Pack the result first
@@ -682,7 +691,8 @@ static void Handle_{{apiName}}_{{function.name}}
           le_msg_GetSession(_msgRef),
           _msgBufPtr-_msgBufStartPtr);
 
-
+    // Only send the part of the buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)le_msg_GetPayloadPtr(_msgRef));
     le_msg_Respond(_msgRef);
 
     return;
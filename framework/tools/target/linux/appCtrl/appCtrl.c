@@ -202,6 +202,7 @@ static void PrintHelp
         "    app status [<appName>]\n"
         "    app version <appName>\n"
         "    app info [<appName>]\n"
+        "    app usage [<appName>]\n"
         "    app runProc <appName> <procName> [options]\n"
         "    app runProc <appName> [<procName>] --exe=<exePath> [options]\n"
         "\n"
@@ -249,6 +250,12 @@ static void PrintHelp
         "       If no name is given, prints the information of all installed applications.\n"
         "       If a name is given, prints the information of the specified application.\n"
         "\n"
+        "    app usage [<appName>]\n"
+        "       If no name is given, prints a summary of the recent CPU and memory usage of all\n"
+        "       running applications.\n"
+        "       If a name is given, also prints each of the specified application's usage\n"
+        "       samples, oldest first.\n"
+        "\n"
         "    app runProc <appName> <procName> [options]\n"
         "       Runs a configured process inside an app using the process settings from the\n"
         "       configuration database.  If an exePath is provided as an option then the specified\n"
@@ -664,6 +671,124 @@ static void PrintStatus
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the recent resource usage of an application: a summary, and optionally each sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintUsage
+(
+    const char* appNamePtr,     ///< [IN] Application name.
+    bool printSamples           ///< [IN] true to print each sample.
+)
+{
+    uint32_t cpuMs[LE_APPINFO_MAX_USAGE_SAMPLES];
+    uint32_t memKBytes[LE_APPINFO_MAX_USAGE_SAMPLES];
+    size_t cpuMsCount = NUM_ARRAY_MEMBERS(cpuMs);
+    size_t memKBytesCount = NUM_ARRAY_MEMBERS(memKBytes);
+    uint32_t periodMs;
+
+    le_result_t result = le_appInfo_GetUsageHistory(appNamePtr,
+                                                    cpuMs,
+                                                    &cpuMsCount,
+                                                    memKBytes,
+                                                    &memKBytesCount,
+                                                    &periodMs);
+    if (result == LE_NOT_FOUND)
+    {
+        if (printSamples)
+        {
+            printf("%s: no usage samples (not running, or just started).\n", appNamePtr);
+        }
+        return;
+    }
+
+    if ((result != LE_OK) || (cpuMsCount == 0) || (periodMs == 0))
+    {
+        INTERNAL_ERR("Failed to get the usage of app '%s' (%s).", appNamePtr,
+                     LE_RESULT_TXT(result));
+    }
+
+    uint64_t totalCpuMs = 0;
+    uint32_t minKBytes = UINT32_MAX;
+    uint32_t maxKBytes = 0;
+    size_t i;
+
+    for (i = 0; i < cpuMsCount; i++)
+    {
+        totalCpuMs += cpuMs[i];
+        minKBytes = (memKBytes[i] < minKBytes) ? memKBytes[i] : minKBytes;
+        maxKBytes = (memKBytes[i] > maxKBytes) ? memKBytes[i] : maxKBytes;
+    }
+
+    uint64_t windowMs = (uint64_t)cpuMsCount * periodMs;
+
+    printf("%s: CPU %.1f%%, memory %" PRIu32 " KiB (min %" PRIu32 ", max %" PRIu32 ")"
+           " over the last %" PRIu64 " s\n",
+           appNamePtr,
+           (totalCpuMs * 100.0) / windowMs,
+           memKBytes[cpuMsCount - 1],
+           minKBytes,
+           maxKBytes,
+           windowMs / 1000);
+
+    if (printSamples)
+    {
+        printf("\n%10s %10s %8s %14s\n", "Age (s)", "CPU (ms)", "CPU (%)", "Memory (KiB)");
+
+        for (i = 0; i < cpuMsCount; i++)
+        {
+            printf("%10" PRIu64 " %10" PRIu32 " %8.1f %14" PRIu32 "\n",
+                   ((uint64_t)(cpuMsCount - 1 - i) * periodMs) / 1000,
+                   cpuMs[i],
+                   (cpuMs[i] * 100.0) / periodMs,
+                   memKBytes[i]);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints a summary of the recent resource usage of an application, if it is running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintUsageSummary
+(
+    const char* appNamePtr      ///< [IN] Application name.
+)
+{
+    PrintUsage(appNamePtr, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implements the "usage" command.
+ *
+ * @note This function does not return.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void PrintAppsUsage
+(
+    void
+)
+{
+    le_appInfo_ConnectService();
+
+    if (AppNamePtr == NULL)
+    {
+        ListInstalledApps(PrintUsageSummary);
+    }
+    else
+    {
+        PrintUsage(AppNamePtr, true);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parses a line of the APP_INFO_FILE for display.
@@ -1872,6 +1997,14 @@ static void CommandArgHandler
         le_arg_AddPositionalCallback(AppNameArgHandler);
         le_arg_AllowLessPositionalArgsThanCallbacks();
     }
+    else if (strcmp(command, "usage") == 0)
+    {
+        CommandFunc = PrintAppsUsage;
+
+        // Accept an optional app name argument.
+        le_arg_AddPositionalCallback(AppNameArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
     else
     {
         fprintf(stderr, "Unknown command '%s'.  Try --help.\n", command);
@@ -22,6 +22,8 @@
 #include "addr.h"
 #include "fileDescriptor.h"
 #include "timer.h"
+#include "eventLoop.h"
+#include "metrics.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -40,6 +42,7 @@ typedef struct ServiceObjIter*      ServiceObjIter_Ref_t;
 typedef struct ClientObjIter*       ClientObjIter_Ref_t;
 typedef struct SessionObjIter*      SessionObjIter_Ref_t;
 typedef struct InterfaceObjIter*    InterfaceObjIter_Ref_t;
+typedef struct HandlerIter*         HandlerIter_Ref_t;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -57,7 +60,8 @@ typedef enum
     INSPECT_INSP_TYPE_IPC_SERVERS,
     INSPECT_INSP_TYPE_IPC_CLIENTS,
     INSPECT_INSP_TYPE_IPC_SERVERS_SESSIONS,
-    INSPECT_INSP_TYPE_IPC_CLIENTS_SESSIONS
+    INSPECT_INSP_TYPE_IPC_CLIENTS_SESSIONS,
+    INSPECT_INSP_TYPE_HANDLERS
 }
 InspType_t;
 
@@ -198,6 +202,16 @@ typedef struct InterfaceObjIter
 }
 InterfaceObjIter_t;
 
+// The event handler profiles aren't walked in the remote process's memory; they're copied out of
+// its metrics segment in one go, busiest handler first.
+typedef struct HandlerIter
+{
+    metrics_Histogram_t profiles[METRICS_MAX_HISTOGRAMS]; ///< Snapshot of the profiles.
+    size_t numProfiles;                  ///< Number of profiles in the snapshot.
+    size_t currIndex;                    ///< Index of the next profile to return.
+}
+HandlerIter_t;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -231,6 +245,22 @@ static le_mem_PoolRef_t IteratorPool;
 #define DEFAULT_RETRY_INTERVAL              500000
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default number of event handlers listed by "inspect handlers".
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_TOP_HANDLERS                10
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of event handlers listed by "inspect handlers" (settable with --top=N).
+ */
+//--------------------------------------------------------------------------------------------------
+static int TopHandlers = DEFAULT_TOP_HANDLERS;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Variable storing the configurable refresh interval in seconds.
@@ -1538,6 +1568,148 @@ static msgSession_Session_t* GetNextSessionObj
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares two event handler profiles by the total time spent in the handlers, for sorting the
+ * busiest handler first.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareHandlerProfiles
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const metrics_Histogram_t* profileAPtr = aPtr;
+    const metrics_Histogram_t* profileBPtr = bPtr;
+
+    if (profileAPtr->sum == profileBPtr->sum)
+    {
+        return 0;
+    }
+
+    return (profileAPtr->sum > profileBPtr->sum) ? -1 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator over the busiest event handlers of the process being inspected, followed by
+ * the time reports spent waiting on each of its threads' Event Queues.
+ *
+ * The profiles are only recorded while the "eventProfile" trace keyword is enabled in the process.
+ *
+ * @return
+ *      An iterator to the event handler profiles of the specified process.
+ */
+//--------------------------------------------------------------------------------------------------
+static HandlerIter_Ref_t CreateHandlerIter
+(
+    void
+)
+{
+    const metrics_Segment_t* segPtr = metrics_MapProcessSegment(PidToInspect);
+
+    if (segPtr == NULL)
+    {
+        fprintf(stderr, "Can't read the metrics of process %d.\n", PidToInspect);
+        exit(EXIT_FAILURE);
+    }
+
+    HandlerIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
+    iteratorPtr->numProfiles = 0;
+    iteratorPtr->currIndex = 0;
+
+    uint32_t numHistograms = __atomic_load_n(&segPtr->numHistograms, __ATOMIC_ACQUIRE);
+    uint32_t i;
+
+    // First the handler profiles, busiest first.
+    for (i = 0; i < numHistograms; i++)
+    {
+        const metrics_Histogram_t* histPtr = &segPtr->histograms[i];
+
+        if ((strncmp(histPtr->name, "handler.", 8) == 0) && (histPtr->count != 0))
+        {
+            iteratorPtr->profiles[iteratorPtr->numProfiles++] = *histPtr;
+        }
+    }
+
+    qsort(iteratorPtr->profiles, iteratorPtr->numProfiles, sizeof(metrics_Histogram_t),
+          CompareHandlerProfiles);
+
+    if (iteratorPtr->numProfiles > TopHandlers)
+    {
+        iteratorPtr->numProfiles = TopHandlers;
+    }
+
+    // Then the Event Queue waiting times.
+    for (i = 0; i < numHistograms; i++)
+    {
+        const metrics_Histogram_t* histPtr = &segPtr->histograms[i];
+        size_t nameLen = strlen(histPtr->name);
+
+        if ((nameLen > 10) && (strcmp(histPtr->name + nameLen - 10, ".queueTime") == 0) &&
+            (histPtr->count != 0))
+        {
+            iteratorPtr->profiles[iteratorPtr->numProfiles++] = *histPtr;
+        }
+    }
+
+    metrics_UnmapSegment(segPtr);
+
+    static bool isHintGiven = false;
+
+    if ((iteratorPtr->numProfiles == 0) && !isHintGiven)
+    {
+        fprintf(stderr, "No event handler profiles.  Enable profiling with:\n"
+                        "    log trace %s <process name>/framework\n", EVENT_PROFILE_KEYWORD);
+        isHintGiven = true;
+    }
+
+    return iteratorPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the change counter of the event handler profiles.  The profiles are a snapshot, so they
+ * never change while being printed.
+ *
+ * @return
+ *      Change counter (always 0).
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetHandlerListChgCnt
+(
+    HandlerIter_Ref_t iterator ///< [IN] The iterator to get the list change counter from.
+)
+{
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next event handler profile from the specified iterator.
+ *
+ * @return
+ *      A handler profile, or NULL if there are no more.
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_Histogram_t* GetNextHandler
+(
+    HandlerIter_Ref_t handlerIterRef ///< [IN] The iterator to get the next profile from.
+)
+{
+    if (handlerIterRef->currIndex >= handlerIterRef->numProfiles)
+    {
+        return NULL;
+    }
+
+    return &(handlerIterRef->profiles[handlerIterRef->currIndex++]);
+}
+
+
 // TODO: migrate the above to a separate module.
 //--------------------------------------------------------------------------------------------------
 /**
@@ -1557,6 +1729,7 @@ static void PrintHelp
         "SYNOPSIS:\n"
         "    inspect <pools|threads|timers|mutexes|semaphores> [OPTIONS] PID\n"
         "    inspect ipc <servers|clients [sessions]> [OPTIONS] PID\n"
+        "    inspect handlers [OPTIONS] PID\n"
         "\n"
         "DESCRIPTION:\n"
         "    inspect pools              Prints the memory pools usage for the specified process.\n"
@@ -1569,6 +1742,11 @@ static void PrintHelp
                                         " specified process.\n"
         "    inspect ipc                Prints the info of ipc in all threads for the"
                                         " specified process.\n"
+        "    inspect handlers           Prints the busiest event handlers of the specified\n"
+        "                               process, and how long events wait to be handled.\n"
+        "                               Profiling must be enabled in the process first, with\n"
+        "                               'log trace " EVENT_PROFILE_KEYWORD
+                                        " <process name>/framework'.\n"
         "\n"
         "OPTIONS:\n"
         "    -f\n"
@@ -1583,6 +1761,10 @@ static void PrintHelp
         "    --format=json\n"
         "        Outputs the inspection results in JSON format.\n"
         "\n"
+        "    --top=N\n"
+        "        Number of event handlers listed by 'inspect handlers' (default "
+                 STRINGIZE(DEFAULT_TOP_HANDLERS) ").\n"
+        "\n"
         "    --help\n"
         "        Display this help and exit.\n"
         );
@@ -1734,6 +1916,17 @@ static ColumnInfo_t SessionObjTableInfo[] =
 };
 static size_t SessionObjTableInfoSize = NUM_ARRAY_MEMBERS(SessionObjTableInfo);
 
+static ColumnInfo_t HandlerTableInfo[] =
+{
+    {"CALLS",     "%*s",  NULL, "%*"PRIu64"", sizeof(uint64_t),            false, 0, true},
+    {"TOTAL(us)", "%*s",  NULL, "%*"PRIu64"", sizeof(uint64_t),            false, 0, true},
+    {"AVG(us)",   "%*s",  NULL, "%*"PRIu64"", sizeof(uint32_t),            false, 0, true},
+    {"P99(us)",   "%*s",  NULL, "%*"PRIu64"", sizeof(uint32_t),            false, 0, false},
+    {"MAX(us)",   "%*s",  NULL, "%*"PRIu64"", sizeof(uint32_t),            false, 0, true},
+    {"HANDLER",   "%-*s", NULL, "%-*s",       LIMIT_MAX_METRIC_NAME_BYTES, true,  0, true}
+};
+static size_t HandlerTableInfoSize = NUM_ARRAY_MEMBERS(HandlerTableInfo);
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -2067,6 +2260,10 @@ static void InitDisplay
             InitDisplayTable(SessionObjTableInfo, SessionObjTableInfoSize);
             break;
 
+        case INSPECT_INSP_TYPE_HANDLERS:
+            InitDisplayTable(HandlerTableInfo, HandlerTableInfoSize);
+            break;
+
         default:
             INTERNAL_ERR("Failed to initialize display table - unexpected inspect type %d.",
                          inspectType);
@@ -2273,6 +2470,12 @@ static int PrintInspectHeader
             tableSize = SessionObjTableInfoSize;
             break;
 
+        case INSPECT_INSP_TYPE_HANDLERS:
+            strncpy(inspectTypeString, "Event Handler Profile", inspectTypeStringSize);
+            table = HandlerTableInfo;
+            tableSize = HandlerTableInfoSize;
+            break;
+
         default:
             INTERNAL_ERR("unexpected inspect type %d.", InspectType);
     }
@@ -3660,6 +3863,104 @@ static int PrintSessionObjInfo
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimate the 99th percentile of an event handler profile.  Samples are only known to the
+ * nearest power of two, so this is the upper bound of the bucket it falls in.
+ *
+ * @return
+ *      Estimated 99th percentile (us).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetHandlerP99
+(
+    metrics_Histogram_t* profileRef ///< [IN] ref to the profile.
+)
+{
+    uint64_t threshold = profileRef->count - (profileRef->count / 100);
+    uint64_t seen = 0;
+    int i;
+
+    for (i = 0; i < METRICS_HISTOGRAM_BUCKETS - 1; i++)
+    {
+        seen += profileRef->buckets[i];
+
+        if (seen >= threshold)
+        {
+            uint64_t upperBound = ((uint64_t)1 << i);
+            return (upperBound < profileRef->max) ? upperBound : profileRef->max;
+        }
+    }
+
+    return profileRef->max;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print event handler profile information to stdout.
+ */
+//--------------------------------------------------------------------------------------------------
+static int PrintHandlerInfo
+(
+    metrics_Histogram_t* profileRef ///< [IN] ref to handler profile to be printed.
+)
+{
+    int lineCount = 0;
+    uint64_t average = profileRef->sum / profileRef->count;
+    uint64_t p99 = GetHandlerP99(profileRef);
+
+    // Output handler profile info
+    int index = 0;
+
+    if (!IsOutputJson)
+    {
+        FillUint64ColField(profileRef->count, HandlerTableInfo, HandlerTableInfoSize, &index);
+        FillUint64ColField(profileRef->sum,   HandlerTableInfo, HandlerTableInfoSize, &index);
+        FillUint64ColField(average,           HandlerTableInfo, HandlerTableInfoSize, &index);
+        FillUint64ColField(p99,               HandlerTableInfo, HandlerTableInfoSize, &index);
+        FillUint64ColField(profileRef->max,   HandlerTableInfo, HandlerTableInfoSize, &index);
+        FillStrColField   (profileRef->name,  HandlerTableInfo, HandlerTableInfoSize, &index);
+
+        PrintInfo(HandlerTableInfo, HandlerTableInfoSize);
+        lineCount++;
+    }
+    else
+    {
+        // If it's not the first time, print a comma.
+        if (!IsPrintedNodeFirst)
+        {
+            printf(",");
+        }
+        else
+        {
+            IsPrintedNodeFirst = false;
+        }
+
+        bool printed = false;
+
+        printf("[");
+
+        ExportUint64ToJson(profileRef->count, HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+        ExportUint64ToJson(profileRef->sum,   HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+        ExportUint64ToJson(average,           HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+        ExportUint64ToJson(p99,               HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+        ExportUint64ToJson(profileRef->max,   HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+        ExportStrToJson   (profileRef->name,  HandlerTableInfo,
+                                              HandlerTableInfoSize, &index, &printed);
+
+        printf("]");
+    }
+
+    return lineCount;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function prototype needed by InspectEndHandling.
@@ -3841,6 +4142,13 @@ static void InspectFunc
             printNodeInfoFunc = (PrintNodeInfoFunc_t) PrintSessionObjInfo;
             break;
 
+        case INSPECT_INSP_TYPE_HANDLERS:
+            createIterFunc    = (CreateIterFunc_t)    CreateHandlerIter;
+            getListChgCntFunc = (GetListChgCntFunc_t) GetHandlerListChgCnt;
+            getNextNodeFunc   = (GetNextNodeFunc_t)   GetNextHandler;
+            printNodeInfoFunc = (PrintNodeInfoFunc_t) PrintHandlerInfo;
+            break;
+
         default:
             INTERNAL_ERR("unexpected inspect type %d.", inspectType);
     }
@@ -4042,6 +4350,10 @@ static void CommandArgHandler
     {
         le_arg_AddPositionalCallback(IpcInterfaceTypeHandler);
     }
+    else if (strcmp(command, "handlers") == 0)
+    {
+        InspectType = INSPECT_INSP_TYPE_HANDLERS;
+    }
     else
     {
         fprintf(stderr, "Invalid command '%s'.\n", command);
@@ -4154,6 +4466,10 @@ static void InitIteratorPool
                    sizeof(ThreadObjIter_t) : sizeof(SessionObjIter_t);
             break;
 
+        case INSPECT_INSP_TYPE_HANDLERS:
+            size = sizeof(HandlerIter_t);
+            break;
+
         default:
             INTERNAL_ERR("unexpected inspect type %d.", inspectType);
     }
@@ -4183,6 +4499,9 @@ COMPONENT_INIT
     // --format=json option outputs data to the specified file in JSON format.
     le_arg_SetStringCallback(FormatOptionCallback, NULL, "format");
 
+    // --top=N option specifies how many event handlers "inspect handlers" lists.
+    le_arg_SetIntVar(&TopHandlers, NULL, "top");
+
     le_arg_Scan();
 
     // Create a memory pool for iterators.
@@ -0,0 +1,696 @@
+//--------------------------------------------------------------------------------------------------
+/** @file ipcTrace.c
+ *
+ * Legato IPC trace tool.  Reads the IPC trace rings that processes write while IPC tracing is
+ * enabled for them (see liblegato's ipcTrace.h), and either dumps the raw records or merges the
+ * client and server records of each request-response transaction to break its latency down
+ * into queueing, transport and server handler time, per API.
+ *
+ * A client record and a server record belong to the same transaction if the server's peer
+ * (client) process ID and the transaction ID match, and the server received the request between
+ * the time the client sent it and the time the client received the response.  Transaction IDs are
+ * re-used, so the last condition is needed to tell transactions apart.
+ *
+ * Must be run as root (to reach the rings of sandboxed apps through /proc/<pid>/root).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "ipcTrace.h"
+#include "limit.h"
+
+#include <dirent.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of distinct APIs (interface and message ID) in a report.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_APIS                    256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commands.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CMD_LIST,       ///< List the processes that have a trace ring.
+    CMD_DUMP,       ///< Print the raw records of one or all processes.
+    CMD_REPORT      ///< Print per-API latency breakdowns of matched transactions.
+}
+Command_t;
+
+static Command_t Command;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * PID of the process to dump, or 0 for all processes.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t Pid = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A record collected from a ring, along with the process that wrote it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    pid_t pid;                      ///< Process that wrote the record.
+    ipcTrace_Record_t record;       ///< The record.
+}
+Collected_t;
+
+static Collected_t* CollectedPtr;
+static size_t NumCollected;
+static size_t CollectedSize;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latency totals of one API (report command).  All times are in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char interfaceName[IPCTRACE_INTERFACE_NAME_BYTES];  ///< Server's name of the interface.
+    uint32_t msgId;                 ///< Message ID.
+    uint64_t count;                 ///< Number of transactions.
+    uint64_t total;                 ///< Client's request queued -> client's response received.
+    uint64_t clientQueue;           ///< Client's request queued -> request sent.
+    uint64_t transport;             ///< Request sent -> received, plus response sent -> received.
+    uint64_t serverQueue;           ///< Request received -> handler, plus response queued -> sent.
+    uint64_t handler;               ///< Server's handler called -> response queued.
+    uint64_t max;                   ///< Longest total.
+}
+Api_t;
+
+static Api_t Apis[MAX_APIS];
+static size_t NumApis;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints help to stdout and exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts(
+        "NAME:\n"
+        "    ipcTrace - Prints the IPC message traces recorded by Legato processes.\n"
+        "\n"
+        "SYNOPSIS:\n"
+        "    ipcTrace list\n"
+        "    ipcTrace dump [PID]\n"
+        "    ipcTrace report\n"
+        "\n"
+        "DESCRIPTION:\n"
+        "    Processes record their IPC messages only while the \"" IPCTRACE_KEYWORD "\" trace\n"
+        "    keyword is enabled for their framework component, e.g.:\n"
+        "        log trace " IPCTRACE_KEYWORD " <process>/framework\n"
+        "    Enable it in both the client and the server to get latency breakdowns.\n"
+        "\n"
+        "    ipcTrace list              Lists the processes that have recorded IPC messages.\n"
+        "    ipcTrace dump              Prints the recorded messages of the specified process,\n"
+        "                               or of all processes if no PID is given.\n"
+        "    ipcTrace report            Matches client and server records of the same\n"
+        "                               transactions and prints, per API, the average time\n"
+        "                               spent queued, in transport and in the server's handler.\n"
+        "\n"
+        "OPTIONS:\n"
+        "    --help\n"
+        "        Display this help and exit.\n"
+        );
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call a function for the ring of every process that has one (or just for the process given on
+ * the command-line).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ForEachRing
+(
+    void (*func)(const ipcTrace_Ring_t* ringPtr)
+)
+{
+    if (Pid != 0)
+    {
+        const ipcTrace_Ring_t* ringPtr = ipcTrace_MapProcessRing(Pid);
+
+        if (ringPtr == NULL)
+        {
+            fprintf(stderr, "Process %d hasn't recorded any IPC messages.\n", Pid);
+            exit(EXIT_FAILURE);
+        }
+
+        func(ringPtr);
+        ipcTrace_UnmapRing(ringPtr);
+        return;
+    }
+
+    DIR* dirPtr = opendir("/proc");
+    struct dirent* entryPtr;
+
+    LE_FATAL_IF(dirPtr == NULL, "Could not open /proc (%m).");
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        pid_t pid;
+
+        if (le_utf8_ParseInt(&pid, entryPtr->d_name) != LE_OK)
+        {
+            continue;
+        }
+
+        const ipcTrace_Ring_t* ringPtr = ipcTrace_MapProcessRing(pid);
+
+        if (ringPtr != NULL)
+        {
+            func(ringPtr);
+            ipcTrace_UnmapRing(ringPtr);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the summary line of a process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListRing
+(
+    const ipcTrace_Ring_t* ringPtr
+)
+{
+    printf("%8d %12" PRIu64 "  %s\n",
+           ringPtr->pid, __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE), ringPtr->procName);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print a time stamp of a record as an offset (us) from the record's first time stamp.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintStampOffset
+(
+    uint64_t stamp,
+    uint64_t base
+)
+{
+    if (stamp == 0)
+    {
+        printf(" %9s", "-");
+    }
+    else
+    {
+        printf(" %9.1f", (double)(stamp - base) / 1000);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print all records of a process, oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DumpRing
+(
+    const ipcTrace_Ring_t* ringPtr
+)
+{
+    uint64_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+    uint64_t seq = (head > IPCTRACE_NUM_RECORDS) ? (head - IPCTRACE_NUM_RECORDS) : 0;
+    ipcTrace_Record_t record;
+
+    printf("\nProcess %d (%s)\n", ringPtr->pid, ringPtr->procName);
+    printf("%4s %16s %10s %6s %7s %17s %9s %9s %9s %9s  %s\n",
+           "ROLE", "TXN", "MSG", "SIZE", "PEER", "TIME(s)",
+           "SEND", "RECEIVE", "H_START", "H_END", "INTERFACE");
+
+    for (; seq < head; seq++)
+    {
+        // Skip records that are being overwritten or that belong to a later lap of the ring.
+        if (!ipcTrace_ReadRecord(ringPtr, seq % IPCTRACE_NUM_RECORDS, &record) ||
+            (record.seq != seq + 1))
+        {
+            continue;
+        }
+
+        // Offsets are relative to the first point the message reached in this process.
+        uint64_t base = 0;
+        int i;
+
+        for (i = 0; i < IPCTRACE_NUM_STAMPS; i++)
+        {
+            if ((record.stamps[i] != 0) && ((base == 0) || (record.stamps[i] < base)))
+            {
+                base = record.stamps[i];
+            }
+        }
+
+        printf("%4s %16" PRIx64 " %10" PRIu32 " %6" PRIu32 " %7d %10" PRIu64 ".%06" PRIu64,
+               (record.role == IPCTRACE_ROLE_SERVER) ? "srv" : "cli",
+               record.txnId,
+               record.msgId,
+               record.size,
+               (int)record.peerPid,
+               base / 1000000000,
+               (base % 1000000000) / 1000);
+
+        PrintStampOffset(record.stamps[IPCTRACE_SEND], base);
+        PrintStampOffset(record.stamps[IPCTRACE_RECEIVE], base);
+        PrintStampOffset(record.stamps[IPCTRACE_HANDLER_START], base);
+        PrintStampOffset(record.stamps[IPCTRACE_HANDLER_END], base);
+
+        printf("  %s\n", record.interfaceName);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy all complete request-response records of a process into the collected records table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CollectRing
+(
+    const ipcTrace_Ring_t* ringPtr
+)
+{
+    size_t i;
+
+    for (i = 0; i < IPCTRACE_NUM_RECORDS; i++)
+    {
+        if (NumCollected >= CollectedSize)
+        {
+            CollectedSize = (CollectedSize == 0) ? IPCTRACE_NUM_RECORDS : (CollectedSize * 2);
+            CollectedPtr = realloc(CollectedPtr, CollectedSize * sizeof(Collected_t));
+            LE_FATAL_IF(CollectedPtr == NULL, "Out of memory.");
+        }
+
+        Collected_t* colPtr = &CollectedPtr[NumCollected];
+
+        if (ipcTrace_ReadRecord(ringPtr, i, &colPtr->record) && (colPtr->record.txnId != 0))
+        {
+            colPtr->pid = ringPtr->pid;
+            NumCollected++;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two collected records for sorting by role, then transaction key, then time received.
+ * Client records are keyed by their own process ID and server records by their peer's, so the
+ * two records of a transaction have the same key.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareCollected
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const Collected_t* a = aPtr;
+    const Collected_t* b = bPtr;
+    pid_t aPid = (a->record.role == IPCTRACE_ROLE_SERVER) ? a->record.peerPid : a->pid;
+    pid_t bPid = (b->record.role == IPCTRACE_ROLE_SERVER) ? b->record.peerPid : b->pid;
+
+    if (a->record.role != b->record.role)
+    {
+        return (a->record.role < b->record.role) ? -1 : 1;
+    }
+    if (aPid != bPid)
+    {
+        return (aPid < bPid) ? -1 : 1;
+    }
+    if (a->record.txnId != b->record.txnId)
+    {
+        return (a->record.txnId < b->record.txnId) ? -1 : 1;
+    }
+    if (a->record.stamps[IPCTRACE_RECEIVE] != b->record.stamps[IPCTRACE_RECEIVE])
+    {
+        return (a->record.stamps[IPCTRACE_RECEIVE] < b->record.stamps[IPCTRACE_RECEIVE]) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the server record that matches a client record.
+ *
+ * @return Pointer to the server record, or NULL if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static const ipcTrace_Record_t* FindServerRecord
+(
+    const Collected_t* clientPtr,
+    const Collected_t* serversPtr,  ///< [IN] Server records (sorted).
+    size_t numServers
+)
+{
+    const ipcTrace_Record_t* cliPtr = &clientPtr->record;
+    size_t low = 0;
+    size_t high = numServers;
+
+    // Find the first server record with this client's transaction key.
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        const ipcTrace_Record_t* srvPtr = &serversPtr[mid].record;
+
+        if ((srvPtr->peerPid < clientPtr->pid) ||
+            ((srvPtr->peerPid == clientPtr->pid) && (srvPtr->txnId < cliPtr->txnId)))
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    for (; low < numServers; low++)
+    {
+        const ipcTrace_Record_t* srvPtr = &serversPtr[low].record;
+
+        if ((srvPtr->peerPid != clientPtr->pid) || (srvPtr->txnId != cliPtr->txnId))
+        {
+            break;
+        }
+
+        if ((srvPtr->stamps[IPCTRACE_RECEIVE] >= cliPtr->stamps[IPCTRACE_SEND]) &&
+            (srvPtr->stamps[IPCTRACE_RECEIVE] <= cliPtr->stamps[IPCTRACE_RECEIVE]))
+        {
+            return srvPtr;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find (or add) an API's latency totals.
+ *
+ * @return Pointer to the totals, or NULL if the table is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static Api_t* GetApi
+(
+    const char* interfaceName,
+    uint32_t msgId
+)
+{
+    size_t i;
+
+    for (i = 0; i < NumApis; i++)
+    {
+        if ((Apis[i].msgId == msgId) && (strcmp(Apis[i].interfaceName, interfaceName) == 0))
+        {
+            return &Apis[i];
+        }
+    }
+
+    if (NumApis >= MAX_APIS)
+    {
+        return NULL;
+    }
+
+    Api_t* apiPtr = &Apis[NumApis++];
+
+    memset(apiPtr, 0, sizeof(*apiPtr));
+    le_utf8_Copy(apiPtr->interfaceName, interfaceName, sizeof(apiPtr->interfaceName), NULL);
+    apiPtr->msgId = msgId;
+
+    return apiPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that all time stamps of a record are set, except (optionally) the handler ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HasStamps
+(
+    const ipcTrace_Record_t* recPtr,
+    bool needHandler
+)
+{
+    return ((recPtr->stamps[IPCTRACE_ENQUEUE] != 0) &&
+            (recPtr->stamps[IPCTRACE_SEND] != 0) &&
+            (recPtr->stamps[IPCTRACE_RECEIVE] != 0) &&
+            (!needHandler || (recPtr->stamps[IPCTRACE_HANDLER_START] != 0)));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print average latencies (us) of an API.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintApi
+(
+    const Api_t* apiPtr
+)
+{
+    double count = (double)apiPtr->count * 1000;
+
+    printf("%8" PRIu64 " %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f  %s #%" PRIu32 "\n",
+           apiPtr->count,
+           apiPtr->total / count,
+           apiPtr->clientQueue / count,
+           apiPtr->transport / count,
+           apiPtr->serverQueue / count,
+           apiPtr->handler / count,
+           (double)apiPtr->max / 1000,
+           apiPtr->interfaceName,
+           apiPtr->msgId);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match the client and server records of all processes and print the per-API latencies.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    void
+)
+{
+    size_t numServers;
+    size_t numMatched = 0;
+    size_t numUnmatched = 0;
+    size_t i;
+
+    NumCollected = 0;
+    NumApis = 0;
+
+    ForEachRing(CollectRing);
+
+    qsort(CollectedPtr, NumCollected, sizeof(Collected_t), CompareCollected);
+
+    // Client records sort before server records.
+    for (numServers = 0; numServers < NumCollected; numServers++)
+    {
+        if (CollectedPtr[NumCollected - numServers - 1].record.role != IPCTRACE_ROLE_SERVER)
+        {
+            break;
+        }
+    }
+
+    const Collected_t* serversPtr = CollectedPtr + (NumCollected - numServers);
+
+    for (i = 0; i < NumCollected - numServers; i++)
+    {
+        const ipcTrace_Record_t* cliPtr = &CollectedPtr[i].record;
+        const ipcTrace_Record_t* srvPtr;
+        Api_t* apiPtr;
+
+        if (!HasStamps(cliPtr, false))
+        {
+            continue;
+        }
+
+        srvPtr = FindServerRecord(&CollectedPtr[i], serversPtr, numServers);
+
+        if ((srvPtr == NULL) || !HasStamps(srvPtr, true))
+        {
+            numUnmatched++;
+            continue;
+        }
+
+        if ((apiPtr = GetApi(srvPtr->interfaceName, cliPtr->msgId)) == NULL)
+        {
+            continue;
+        }
+
+        const uint64_t* c = cliPtr->stamps;
+        const uint64_t* s = srvPtr->stamps;
+        uint64_t total = c[IPCTRACE_RECEIVE] - c[IPCTRACE_ENQUEUE];
+
+        apiPtr->count++;
+        apiPtr->total += total;
+        apiPtr->clientQueue += c[IPCTRACE_SEND] - c[IPCTRACE_ENQUEUE];
+        apiPtr->transport += (s[IPCTRACE_RECEIVE] - c[IPCTRACE_SEND]) +
+                             (c[IPCTRACE_RECEIVE] - s[IPCTRACE_SEND]);
+        apiPtr->serverQueue += (s[IPCTRACE_HANDLER_START] - s[IPCTRACE_RECEIVE]) +
+                               (s[IPCTRACE_SEND] - s[IPCTRACE_ENQUEUE]);
+        apiPtr->handler += s[IPCTRACE_ENQUEUE] - s[IPCTRACE_HANDLER_START];
+        apiPtr->max = (total > apiPtr->max) ? total : apiPtr->max;
+
+        numMatched++;
+    }
+
+    printf("%8s %10s %10s %10s %10s %10s %10s  %s\n",
+           "COUNT", "TOTAL(us)", "CLI_Q(us)", "XPORT(us)", "SRV_Q(us)", "HANDLR(us)", "MAX(us)",
+           "API");
+
+    for (i = 0; i < NumApis; i++)
+    {
+        PrintApi(&Apis[i]);
+    }
+
+    printf("\n%zu transactions matched, %zu client transactions without a server record.\n",
+           numMatched, numUnmatched);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove ring files left behind in our own /tmp by processes that no longer exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveStaleRings
+(
+    void
+)
+{
+    DIR* dirPtr = opendir("/tmp");
+    struct dirent* entryPtr;
+
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        int pid;
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        if ((sscanf(entryPtr->d_name, "legato-ipctrace.%d", &pid) == 1) &&
+            (kill(pid, 0) != 0) && (errno == ESRCH))
+        {
+            snprintf(path, sizeof(path), IPCTRACE_RING_PATH_FMT, pid);
+            unlink(path);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the command-line argument scanner when it sees the PID argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PidArgHandler
+(
+    const char* pidStr
+)
+{
+    if ((le_utf8_ParseInt(&Pid, pidStr) != LE_OK) || (Pid <= 0))
+    {
+        fprintf(stderr, "Invalid PID '%s'.\n", pidStr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the command-line argument scanner when it sees the command argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CommandArgHandler
+(
+    const char* command
+)
+{
+    if (strcmp(command, "list") == 0)
+    {
+        Command = CMD_LIST;
+    }
+    else if (strcmp(command, "dump") == 0)
+    {
+        Command = CMD_DUMP;
+
+        le_arg_AddPositionalCallback(PidArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
+    else if (strcmp(command, "report") == 0)
+    {
+        Command = CMD_REPORT;
+    }
+    else
+    {
+        fprintf(stderr, "Invalid command '%s'.\n", command);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+COMPONENT_INIT
+{
+    le_arg_AddPositionalCallback(CommandArgHandler);
+    le_arg_SetFlagCallback(PrintHelp, NULL, "help");
+
+    le_arg_Scan();
+
+    RemoveStaleRings();
+
+    switch (Command)
+    {
+        case CMD_LIST:
+            printf("%8s %12s  %s\n", "PID", "RECORDS", "NAME");
+            ForEachRing(ListRing);
+            break;
+
+        case CMD_DUMP:
+            ForEachRing(DumpRing);
+            break;
+
+        case CMD_REPORT:
+            Report();
+            break;
+    }
+
+    exit(EXIT_SUCCESS);
+}
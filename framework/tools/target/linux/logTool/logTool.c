@@ -29,6 +29,23 @@ $ log stoptrace keyword processName/componentName
 @endverbatim
  *
  *
+ * To keep the messages logged by all processes in a 1024 KiB persistent log store:
+ * @verbatim
+$ log store 1024
+@endverbatim
+ *
+ * To show the stored warnings (and worse) logged by a process in the last 10 minutes:
+ * @verbatim
+$ log show --last=600 --level=WARNING --proc=processName
+@endverbatim
+ *
+ * To show the stored messages logged by a component:
+ * @verbatim
+$ log show --comp=componentName
+@endverbatim
+ *
+ * The "show" command is executed by the log tool itself, which reads the log store directly.
+ *
  * With all of the above examples "*" can be used in place of processName and componentName to mean
  * all processes and/or all components.  In fact if the "processName/componentName" is omitted the
  * default destination is set to all processes and all components.
@@ -53,7 +70,9 @@ $ log stoptrace keyword processName/componentName
 #include "log.h"
 #include "logDaemon.h"
 #include "limit.h"
+#include "logStore.h"
 #include <ctype.h>
+#include <sys/mman.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -99,6 +118,28 @@ static const char* SessionIdPtr = DEFAULT_SESSION_ID;
 static bool ErrorOccurred = false;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * True if the command is "show", which is not sent to the Log Control Daemon.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool IsShowCommand = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Filters of the "show" command (NULL if not given).
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* SinceStr = NULL;
+static const char* UntilStr = NULL;
+static const char* LastStr = NULL;
+static const char* LevelStr = NULL;
+static const char* ProcNameStr = NULL;
+static const char* PidStr = NULL;
+static const char* CompNameStr = NULL;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prints help to stdout.
@@ -119,6 +160,9 @@ static void PrintHelpAndExit
         "    log trace KEYWORD_STR [DESTINATION]\n"
         "    log stoptrace KEYWORD_STR [DESTINATION]\n"
         "    log forget PROCESS_NAME\n"
+        "    log store SIZE\n"
+        "    log show [--since=TIME] [--until=TIME] [--last=SECONDS] [--level=FILTER_STR]\n"
+        "             [--proc=PROCESS_NAME] [--pid=PID] [--comp=COMPONENT_NAME]\n"
         "\n"
         "DESCRIPTION:\n"
         "    log list            Lists all processes/components registered with the\n"
@@ -146,6 +190,22 @@ static void PrintHelpAndExit
         "                        Future processes with that name will have default\n"
         "                        settings.\n"
         "\n"
+        "    log store           Keeps the messages logged by all processes'\n"
+        "                        components, and the standard output and error of\n"
+        "                        apps, in a persistent log store of SIZE KiB, or\n"
+        "                        stops keeping them and deletes the store if SIZE is\n"
+        "                        0.  Changing the size empties the store.\n"
+        "\n"
+        "    log show            Shows the messages in the log store, oldest first.\n"
+        "                        --since and --until only show the messages logged\n"
+        "                        in a time range.  A TIME is a number of seconds\n"
+        "                        since the Epoch, or before now if negative.\n"
+        "                        --last=SECONDS is the same as --since=-SECONDS.\n"
+        "                        --level only shows the messages at or above a level\n"
+        "                        (see 'log level').  --proc and --pid only show the\n"
+        "                        messages logged by a process.  --comp only shows\n"
+        "                        the messages logged by a component.\n"
+        "\n"
         "The [DESTINATION] is optional and specifies the process and component to\n"
         "send the command to.  The [DESTINATION] must be in this format:\n"
         "\n"
@@ -479,6 +539,270 @@ static void ProcessIdArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that gets called by le_arg_Scan() when the size argument for a "store" command is found
+ * on the command line.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void StoreSizeArgHandler
+(
+    const char* size
+)
+{
+    if ((*size == '\0') || (strspn(size, "0123456789") != strlen(size)))
+    {
+        ExitWithErrorMsg("Invalid log store size.");
+    }
+
+    CommandParamPtr = size;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a time given to the "show" command.
+ *
+ * @return The time in microseconds since the Epoch.
+ **/
+//--------------------------------------------------------------------------------------------------
+static uint64_t ParseTime
+(
+    const char* timeStr         ///< Seconds since the Epoch, or before now if negative.
+)
+{
+    char* endPtr;
+
+    errno = 0;
+    long long seconds = strtoll(timeStr, &endPtr, 10);
+
+    if ((errno != 0) || (endPtr == timeStr) || (*endPtr != '\0'))
+    {
+        ExitWithErrorMsg("Invalid time.");
+    }
+
+    if (seconds < 0)
+    {
+        seconds += le_clk_GetAbsoluteTime().sec;
+        if (seconds < 0)
+        {
+            seconds = 0;
+        }
+    }
+
+    return (uint64_t)seconds * 1000000;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the filter of the "show" command from its options.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void GetStoreFilter
+(
+    logStore_Filter_t* filterPtr    ///< [OUT] Filter.
+)
+{
+    filterPtr->minTimeUs = 0;
+    filterPtr->maxTimeUs = UINT64_MAX;
+    filterPtr->levelMask = UINT32_MAX;
+    filterPtr->pid = -1;
+    filterPtr->namePtr = ProcNameStr;
+    filterPtr->nameLen = (ProcNameStr != NULL) ? strlen(ProcNameStr) : 0;
+    filterPtr->compPtr = CompNameStr;
+    filterPtr->compLen = (CompNameStr != NULL) ? strlen(CompNameStr) : 0;
+
+    if (SinceStr != NULL)
+    {
+        filterPtr->minTimeUs = ParseTime(SinceStr);
+    }
+
+    if (LastStr != NULL)
+    {
+        if (LastStr[0] == '-')
+        {
+            ExitWithErrorMsg("Invalid number of seconds.");
+        }
+
+        char sinceStr[32];
+        snprintf(sinceStr, sizeof(sinceStr), "-%s", LastStr);
+        filterPtr->minTimeUs = ParseTime(sinceStr);
+    }
+
+    if (UntilStr != NULL)
+    {
+        filterPtr->maxTimeUs = ParseTime(UntilStr) + 999999;
+    }
+
+    if (LevelStr != NULL)
+    {
+        le_log_Level_t level = ParseSeverityLevel(LevelStr);
+        if (level == (le_log_Level_t)(-1))
+        {
+            ExitWithErrorMsg("Invalid log level.");
+        }
+
+        // Show the messages at this level and above.
+        filterPtr->levelMask = ~(((uint32_t)1 << level) - 1);
+    }
+
+    if (PidStr != NULL)
+    {
+        char* endPtr;
+        long pid = strtol(PidStr, &endPtr, 10);
+
+        if ((endPtr == PidStr) || (*endPtr != '\0') || (pid <= 0) || (pid > INT32_MAX))
+        {
+            ExitWithErrorMsg("Invalid PID.");
+        }
+
+        filterPtr->pid = pid;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints a record of the log store.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void PrintRecord
+(
+    const logStore_Record_t* recordPtr      ///< Record.
+)
+{
+    time_t seconds = recordPtr->timeUs / 1000000;
+    struct tm tm;
+    char timeStr[32] = "";
+    const char* textPtr = (const char*)(recordPtr + 1);
+    const char* levelStr = log_SeverityLevelToStr(recordPtr->level);
+
+    if (localtime_r(&seconds, &tm) != NULL)
+    {
+        strftime(timeStr, sizeof(timeStr), "%b %e %H:%M:%S", &tm);
+    }
+
+    // Same format as the system log: "process[pid]/component", or "process[pid]" for the lines
+    // an app wrote to its standard output or error.
+    printf("%s.%06u | %.*s[%d]%s%.*s | %s | %.*s\n",
+           timeStr,
+           (unsigned int)(recordPtr->timeUs % 1000000),
+           recordPtr->nameLen,
+           textPtr,
+           recordPtr->pid,
+           (recordPtr->compLen > 0) ? "/" : "",
+           recordPtr->compLen,
+           textPtr + recordPtr->nameLen,
+           (levelStr != NULL) ? levelStr : "?",
+           recordPtr->msgLen,
+           textPtr + recordPtr->nameLen + recordPtr->compLen);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the messages of a block of the log store that match a filter.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ShowBlock
+(
+    const uint8_t* blockPtr,                ///< Block.
+    uint32_t generation,                    ///< Block's generation, from its index entry.
+    const logStore_Filter_t* filterPtr      ///< Filter.
+)
+{
+    logStore_RecordBuffer_t buf;
+    size_t offset = 0;
+    size_t length;
+
+    while ((length = logStore_CopyRecord(blockPtr, offset, generation, &buf)) != 0)
+    {
+        if (logStore_IsRecordMatching(&buf.record, filterPtr))
+        {
+            PrintRecord(&buf.record);
+        }
+
+        offset += length;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the messages in the log store that match the filter given on the command line.  Only the
+ * blocks whose index entry matches the filter are read.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ShowStoredLogs
+(
+    void
+)
+{
+    logStore_Filter_t filter;
+    GetStoreFilter(&filter);
+
+    int fd = open(LOGSTORE_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            ExitWithErrorMsg("The log store is not enabled (see 'log store').");
+        }
+
+        fprintf(stderr, "log: Failed to open '%s' (%m).\n", LOGSTORE_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    logStore_Header_t header;
+
+    if (   (fstat(fd, &st) != 0)
+        || (pread(fd, &header, sizeof(header), 0) != sizeof(header))
+        || (header.magic != LOGSTORE_MAGIC)
+        || (header.version != LOGSTORE_VERSION)
+        || (header.blockBytes != LOGSTORE_BLOCK_BYTES)
+        || (header.blockCount == 0)
+        || (header.dataOffset < LOGSTORE_INDEX_OFFSET +
+                                ((size_t)header.blockCount * sizeof(logStore_IndexEntry_t)))
+        || (st.st_size < (off_t)header.dataOffset +
+                         ((off_t)header.blockCount * LOGSTORE_BLOCK_BYTES)))
+    {
+        fprintf(stderr, "log: '%s' is not a valid log store.\n", LOGSTORE_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    const uint8_t* storePtr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (storePtr == MAP_FAILED)
+    {
+        fprintf(stderr, "log: Failed to map '%s' (%m).\n", LOGSTORE_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    const logStore_IndexEntry_t* indexPtr =
+        (const logStore_IndexEntry_t*)(storePtr + LOGSTORE_INDEX_OFFSET);
+    uint32_t newestBlock = logStore_GetNewestBlock(indexPtr, header.blockCount);
+    uint32_t i;
+
+    // Oldest block first.
+    for (i = 1; i <= header.blockCount; i++)
+    {
+        uint32_t block = (newestBlock + i) % header.blockCount;
+        logStore_IndexEntry_t entry = indexPtr[block];
+
+        if (logStore_IsBlockMatching(&entry, &filter))
+        {
+            ShowBlock(storePtr + header.dataOffset + ((size_t)block * LOGSTORE_BLOCK_BYTES),
+                      entry.generation,
+                      &filter);
+        }
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function that gets called by le_arg_Scan() when it sees the first positional argument while
@@ -529,6 +853,18 @@ static void CommandArgHandler
         // This command has only a process name (or pid) as a parameter.
         le_arg_AddPositionalCallback(ProcessIdArgHandler);
     }
+    else if (strcmp(command, "store") == 0)
+    {
+        Command = LOG_CMD_SET_STORE_SIZE;
+
+        // This command has only a size as a parameter.
+        le_arg_AddPositionalCallback(StoreSizeArgHandler);
+    }
+    else if (strcmp(command, "show") == 0)
+    {
+        // This command only has options, and is not sent to the Log Control Daemon.
+        IsShowCommand = true;
+    }
     else
     {
         char errorMsg[100];
@@ -551,8 +887,22 @@ COMPONENT_INIT
     // Print help and exit if the "-h" or "--help" options are given.
     le_arg_SetFlagCallback(PrintHelpAndExit, "h", "help");
 
+    // Options of the "show" command.
+    le_arg_SetStringVar(&SinceStr, NULL, "since");
+    le_arg_SetStringVar(&UntilStr, NULL, "until");
+    le_arg_SetStringVar(&LastStr, NULL, "last");
+    le_arg_SetStringVar(&LevelStr, NULL, "level");
+    le_arg_SetStringVar(&ProcNameStr, NULL, "proc");
+    le_arg_SetStringVar(&PidStr, NULL, "pid");
+    le_arg_SetStringVar(&CompNameStr, NULL, "comp");
+
     le_arg_Scan();
 
+    if (IsShowCommand)
+    {
+        ShowStoredLogs();
+    }
+
     // Connect to the Log Control Daemon and allocate a message buffer to hold the command.
     le_msg_SessionRef_t sessionRef = ConnectToLogControlDaemon();
     le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
@@ -583,6 +933,12 @@ COMPONENT_INIT
 
             AppendToCommand(msgRef, CommandParamPtr);
 
+            break;
+
+        case LOG_CMD_SET_STORE_SIZE:
+
+            AppendToCommand(msgRef, CommandParamPtr);
+
             break;
     }
 
@@ -0,0 +1,679 @@
+//--------------------------------------------------------------------------------------------------
+/** @file metrics.c
+ *
+ * Legato runtime metrics tool.  Reads the metrics segments that every Legato process publishes
+ * (see liblegato's metrics.h) and prints them, per process or aggregated across the system.
+ *
+ * Reading a segment is a plain memory read of a shared mapping, so the observed processes are
+ * never stopped or signalled.
+ *
+ * Must be run as root (to reach the segments of sandboxed apps through /proc/<pid>/root).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "metrics.h"
+#include "limit.h"
+
+#include <dirent.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default refresh interval (in seconds) when following.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_REFRESH_INTERVAL    3
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of distinct metric names aggregated by the "sum" command.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_AGGREGATED_METRICS      2048
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commands.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CMD_LIST,       ///< List the processes that publish metrics.
+    CMD_SHOW,       ///< Print the metrics of one or all processes.
+    CMD_SUM         ///< Print the metrics aggregated by name across all processes.
+}
+Command_t;
+
+static Command_t Command;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * PID of the process to show, or 0 for all processes.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t Pid = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Following state.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsFollowing = false;
+static int RefreshInterval = DEFAULT_REFRESH_INTERVAL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An aggregated metric (sum command).  Counters and histograms are kept in the same table.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char name[LIMIT_MAX_METRIC_NAME_BYTES]; ///< Metric name.
+    bool isHistogram;                       ///< true = histogram, false = counter or gauge.
+    uint32_t type;                          ///< Counter type (counters only).
+    size_t numProcs;                        ///< Number of processes that have this metric.
+    uint64_t value;                         ///< Sum of values (counters) or counts (histograms).
+    uint64_t max;                           ///< Max of high-water marks or of largest samples.
+    uint64_t sum;                           ///< Sum of samples (histograms only).
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS]; ///< Summed buckets (histograms only).
+}
+Aggregate_t;
+
+static Aggregate_t Aggregates[MAX_AGGREGATED_METRICS];
+static size_t NumAggregates;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints help to stdout and exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts(
+        "NAME:\n"
+        "    metrics - Prints the runtime metrics (counters and histograms) published by Legato\n"
+        "              processes.\n"
+        "\n"
+        "SYNOPSIS:\n"
+        "    metrics list [OPTIONS]\n"
+        "    metrics show [OPTIONS] [PID]\n"
+        "    metrics sum [OPTIONS]\n"
+        "\n"
+        "DESCRIPTION:\n"
+        "    metrics list               Lists the processes that publish metrics.\n"
+        "    metrics show               Prints all metrics of the specified process, or of all\n"
+        "                               processes if no PID is given.\n"
+        "    metrics sum                Prints the metrics of all processes, aggregated by name.\n"
+        "\n"
+        "    Metric names are prefixed by what they measure:\n"
+        "        ipc.<srv|cli>.<interface>.<tx|rx>   IPC messages sent and received.\n"
+        "        event.<thread>.queueDepth           Event Queue depth (current and maximum).\n"
+        "        event.<thread>.handlerTime          Event handler execution time (us).\n"
+        "        pool.<pool>                         Memory pool high-water mark (blocks).\n"
+        "\n"
+        "OPTIONS:\n"
+        "    -f\n"
+        "        Periodically prints updated information.\n"
+        "\n"
+        "    --interval=SECONDS\n"
+        "        Prints updated information every SECONDS.\n"
+        "\n"
+        "    --help\n"
+        "        Display this help and exit.\n"
+        );
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimate a percentile of a histogram from its buckets.
+ *
+ * @return Upper bound (us) of the bucket that contains the percentile.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t EstimatePercentile
+(
+    const uint64_t* bucketsPtr,     ///< [IN] Histogram buckets.
+    uint64_t count,                 ///< [IN] Total number of samples.
+    unsigned int percent            ///< [IN] Percentile (0 - 100).
+)
+{
+    uint64_t threshold = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    int i;
+
+    for (i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += bucketsPtr[i];
+
+        if ((seen >= threshold) && (seen > 0))
+        {
+            return ((uint64_t)1 << i);
+        }
+    }
+
+    return ((uint64_t)1 << (METRICS_HISTOGRAM_BUCKETS - 1));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the header line of the counter table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintCounterHeader
+(
+    void
+)
+{
+    printf("%14s %14s  %s\n", "VALUE", "MAX", "COUNTER");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print one line of the counter table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintCounter
+(
+    const char* namePtr,
+    uint32_t type,
+    uint64_t value,
+    uint64_t max
+)
+{
+    if (type == METRICS_GAUGE)
+    {
+        printf("%14" PRIu64 " %14" PRIu64 "  %s\n", value, max, namePtr);
+    }
+    else
+    {
+        printf("%14" PRIu64 " %14s  %s\n", value, "-", namePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the header line of the histogram table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHistogramHeader
+(
+    void
+)
+{
+    printf("%12s %10s %10s %10s %10s  %s\n", "COUNT", "AVG(us)", "P50(us)", "P99(us)", "MAX(us)",
+           "HISTOGRAM");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print one line of the histogram table.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHistogram
+(
+    const char* namePtr,
+    uint64_t count,
+    uint64_t sum,
+    uint64_t max,
+    const uint64_t* bucketsPtr
+)
+{
+    if (count == 0)
+    {
+        printf("%12d %10s %10s %10s %10s  %s\n", 0, "-", "-", "-", "-", namePtr);
+        return;
+    }
+
+    // A bucket's upper bound can't be more than the largest sample actually seen.
+    uint64_t p50 = EstimatePercentile(bucketsPtr, count, 50);
+    uint64_t p99 = EstimatePercentile(bucketsPtr, count, 99);
+
+    printf("%12" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "  %s\n",
+           count,
+           sum / count,
+           (p50 > max) ? max : p50,
+           (p99 > max) ? max : p99,
+           max,
+           namePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove segment files left behind in our own /tmp by processes that no longer exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveStaleSegments
+(
+    void
+)
+{
+    DIR* dirPtr = opendir("/tmp");
+    struct dirent* entryPtr;
+
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        int pid;
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        if ((sscanf(entryPtr->d_name, "legato-metrics.%d", &pid) == 1) &&
+            (kill(pid, 0) != 0) && (errno == ESRCH))
+        {
+            snprintf(path, sizeof(path), METRICS_SEGMENT_PATH_FMT, pid);
+            unlink(path);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call a function for the segment of every process that publishes one (or just for the process
+ * given on the command-line).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ForEachSegment
+(
+    void (*func)(const metrics_Segment_t* segPtr)
+)
+{
+    if (Pid != 0)
+    {
+        const metrics_Segment_t* segPtr = metrics_MapProcessSegment(Pid);
+
+        if (segPtr == NULL)
+        {
+            fprintf(stderr, "Process %d doesn't publish any metrics.\n", Pid);
+            exit(EXIT_FAILURE);
+        }
+
+        func(segPtr);
+        metrics_UnmapSegment(segPtr);
+        return;
+    }
+
+    DIR* dirPtr = opendir("/proc");
+    struct dirent* entryPtr;
+
+    LE_FATAL_IF(dirPtr == NULL, "Could not open /proc (%m).");
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        pid_t pid;
+
+        if (le_utf8_ParseInt(&pid, entryPtr->d_name) != LE_OK)
+        {
+            continue;
+        }
+
+        const metrics_Segment_t* segPtr = metrics_MapProcessSegment(pid);
+
+        if (segPtr != NULL)
+        {
+            func(segPtr);
+            metrics_UnmapSegment(segPtr);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the summary line of a process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListProcess
+(
+    const metrics_Segment_t* segPtr
+)
+{
+    uint32_t numCounters = __atomic_load_n(&segPtr->numCounters, __ATOMIC_ACQUIRE);
+    uint32_t numHistograms = __atomic_load_n(&segPtr->numHistograms, __ATOMIC_ACQUIRE);
+
+    printf("%8d %9u %11u %8u  %s\n",
+           segPtr->pid, numCounters, numHistograms, segPtr->numDropped, segPtr->procName);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print all metrics of a process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ShowProcess
+(
+    const metrics_Segment_t* segPtr
+)
+{
+    uint32_t numCounters = __atomic_load_n(&segPtr->numCounters, __ATOMIC_ACQUIRE);
+    uint32_t numHistograms = __atomic_load_n(&segPtr->numHistograms, __ATOMIC_ACQUIRE);
+    uint32_t i;
+
+    printf("\nProcess %d (%s)\n", segPtr->pid, segPtr->procName);
+
+    PrintCounterHeader();
+
+    for (i = 0; i < numCounters; i++)
+    {
+        const metrics_Counter_t* counterPtr = &segPtr->counters[i];
+
+        if (__atomic_load_n(&counterPtr->inUse, __ATOMIC_ACQUIRE))
+        {
+            PrintCounter(counterPtr->name,
+                         counterPtr->type,
+                         __atomic_load_n(&counterPtr->value, __ATOMIC_RELAXED),
+                         __atomic_load_n(&counterPtr->max, __ATOMIC_RELAXED));
+        }
+    }
+
+    PrintHistogramHeader();
+
+    for (i = 0; i < numHistograms; i++)
+    {
+        const metrics_Histogram_t* histPtr = &segPtr->histograms[i];
+
+        if (__atomic_load_n(&histPtr->inUse, __ATOMIC_ACQUIRE))
+        {
+            PrintHistogram(histPtr->name,
+                           __atomic_load_n(&histPtr->count, __ATOMIC_RELAXED),
+                           __atomic_load_n(&histPtr->sum, __ATOMIC_RELAXED),
+                           __atomic_load_n(&histPtr->max, __ATOMIC_RELAXED),
+                           histPtr->buckets);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find (or add) an aggregate by name.
+ *
+ * @return Pointer to the aggregate, or NULL if the table is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static Aggregate_t* GetAggregate
+(
+    const char* namePtr,
+    bool isHistogram
+)
+{
+    size_t i;
+
+    for (i = 0; i < NumAggregates; i++)
+    {
+        if ((Aggregates[i].isHistogram == isHistogram) &&
+            (strcmp(Aggregates[i].name, namePtr) == 0))
+        {
+            return &Aggregates[i];
+        }
+    }
+
+    if (NumAggregates >= MAX_AGGREGATED_METRICS)
+    {
+        return NULL;
+    }
+
+    Aggregate_t* aggPtr = &Aggregates[NumAggregates++];
+
+    memset(aggPtr, 0, sizeof(*aggPtr));
+    le_utf8_Copy(aggPtr->name, namePtr, sizeof(aggPtr->name), NULL);
+    aggPtr->isHistogram = isHistogram;
+
+    return aggPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add all metrics of a process to the aggregates.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AggregateProcess
+(
+    const metrics_Segment_t* segPtr
+)
+{
+    uint32_t numCounters = __atomic_load_n(&segPtr->numCounters, __ATOMIC_ACQUIRE);
+    uint32_t numHistograms = __atomic_load_n(&segPtr->numHistograms, __ATOMIC_ACQUIRE);
+    uint32_t i;
+    int b;
+
+    for (i = 0; i < numCounters; i++)
+    {
+        const metrics_Counter_t* counterPtr = &segPtr->counters[i];
+        Aggregate_t* aggPtr;
+
+        if (__atomic_load_n(&counterPtr->inUse, __ATOMIC_ACQUIRE) &&
+            ((aggPtr = GetAggregate(counterPtr->name, false)) != NULL))
+        {
+            uint64_t max = __atomic_load_n(&counterPtr->max, __ATOMIC_RELAXED);
+
+            aggPtr->type = counterPtr->type;
+            aggPtr->numProcs++;
+            aggPtr->value += __atomic_load_n(&counterPtr->value, __ATOMIC_RELAXED);
+            aggPtr->max = (max > aggPtr->max) ? max : aggPtr->max;
+        }
+    }
+
+    for (i = 0; i < numHistograms; i++)
+    {
+        const metrics_Histogram_t* histPtr = &segPtr->histograms[i];
+        Aggregate_t* aggPtr;
+
+        if (__atomic_load_n(&histPtr->inUse, __ATOMIC_ACQUIRE) &&
+            ((aggPtr = GetAggregate(histPtr->name, true)) != NULL))
+        {
+            uint64_t max = __atomic_load_n(&histPtr->max, __ATOMIC_RELAXED);
+
+            aggPtr->numProcs++;
+            aggPtr->value += __atomic_load_n(&histPtr->count, __ATOMIC_RELAXED);
+            aggPtr->sum += __atomic_load_n(&histPtr->sum, __ATOMIC_RELAXED);
+            aggPtr->max = (max > aggPtr->max) ? max : aggPtr->max;
+
+            for (b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++)
+            {
+                aggPtr->buckets[b] += __atomic_load_n(&histPtr->buckets[b], __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the command once.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunCommand
+(
+    void
+)
+{
+    size_t i;
+
+    switch (Command)
+    {
+        case CMD_LIST:
+            printf("%8s %9s %11s %8s  %s\n", "PID", "COUNTERS", "HISTOGRAMS", "DROPPED", "NAME");
+            ForEachSegment(ListProcess);
+            break;
+
+        case CMD_SHOW:
+            ForEachSegment(ShowProcess);
+            break;
+
+        case CMD_SUM:
+            NumAggregates = 0;
+            ForEachSegment(AggregateProcess);
+
+            PrintCounterHeader();
+            for (i = 0; i < NumAggregates; i++)
+            {
+                if (!Aggregates[i].isHistogram)
+                {
+                    PrintCounter(Aggregates[i].name, Aggregates[i].type,
+                                 Aggregates[i].value, Aggregates[i].max);
+                }
+            }
+
+            PrintHistogramHeader();
+            for (i = 0; i < NumAggregates; i++)
+            {
+                if (Aggregates[i].isHistogram)
+                {
+                    PrintHistogram(Aggregates[i].name, Aggregates[i].value, Aggregates[i].sum,
+                                   Aggregates[i].max, Aggregates[i].buckets);
+                }
+            }
+            break;
+    }
+
+    fflush(stdout);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer handler used when following.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RefreshTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    printf("\n");
+    RunCommand();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the command-line argument scanner when it sees the PID argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PidArgHandler
+(
+    const char* pidStr
+)
+{
+    if ((le_utf8_ParseInt(&Pid, pidStr) != LE_OK) || (Pid <= 0))
+    {
+        fprintf(stderr, "Invalid PID '%s'.\n", pidStr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the command-line argument scanner when it sees the command argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CommandArgHandler
+(
+    const char* command
+)
+{
+    if (strcmp(command, "list") == 0)
+    {
+        Command = CMD_LIST;
+    }
+    else if (strcmp(command, "show") == 0)
+    {
+        Command = CMD_SHOW;
+
+        le_arg_AddPositionalCallback(PidArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
+    else if (strcmp(command, "sum") == 0)
+    {
+        Command = CMD_SUM;
+    }
+    else
+    {
+        fprintf(stderr, "Invalid command '%s'.\n", command);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by command line argument scanner when the --interval= option is given.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void IntervalOptionCallback
+(
+    int value
+)
+{
+    if (value <= 0)
+    {
+        fprintf(stderr,
+                "Interval value must be a positive integer. "
+                    " Using the default interval %d seconds.\n",
+                DEFAULT_REFRESH_INTERVAL);
+
+        value = DEFAULT_REFRESH_INTERVAL;
+    }
+
+    RefreshInterval = value;
+    IsFollowing = true;
+}
+
+
+COMPONENT_INIT
+{
+    le_arg_AddPositionalCallback(CommandArgHandler);
+    le_arg_SetFlagCallback(PrintHelp, NULL, "help");
+    le_arg_SetFlagVar(&IsFollowing, "f", NULL);
+    le_arg_SetIntCallback(IntervalOptionCallback, NULL, "interval");
+
+    le_arg_Scan();
+
+    RemoveStaleSegments();
+
+    RunCommand();
+
+    if (!IsFollowing)
+    {
+        exit(EXIT_SUCCESS);
+    }
+
+    le_timer_Ref_t timerRef = le_timer_Create("RefreshTimer");
+    le_clk_Time_t interval = { .sec = RefreshInterval, .usec = 0 };
+
+    LE_ASSERT(le_timer_SetInterval(timerRef, interval) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(timerRef, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(timerRef, RefreshTimerHandler) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+}